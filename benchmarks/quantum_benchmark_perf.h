@@ -0,0 +1,62 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_BENCHMARK_PERF_H
+#define QUANTUM_BENCHMARK_PERF_H
+
+#include <benchmark/benchmark.h>
+#include <quantum/quantum.h>
+#include <cstdlib>
+
+//==============================================================================
+//                           HARDWARE COUNTERS
+//==============================================================================
+//Set QUANTUM_BENCHMARK_PERF_COUNTERS=1 to count hardware events on every dispatcher thread.
+//The benchmarks then report the events per processed item alongside the timings.
+inline bool perfCountersEnabled()
+{
+    static const bool enabled = (std::getenv("QUANTUM_BENCHMARK_PERF_COUNTERS") != nullptr);
+    return enabled;
+}
+
+inline void enablePerfCounters(Bloomberg::quantum::Configuration& config)
+{
+    config.setHardwareCounterStatistics(perfCountersEnabled());
+}
+
+//Sums the counters of all the coroutine and IO threads and divides them by the number of items
+inline void reportPerfCounters(benchmark::State& state,
+                               Bloomberg::quantum::Dispatcher& dispatcher,
+                               int64_t numItems)
+{
+    using namespace Bloomberg::quantum;
+    if (!perfCountersEnabled() || (numItems <= 0))
+    {
+        return;
+    }
+    QueueStatistics stats = dispatcher.stats();
+    for (int i = 0; i < PerfCounters::numEvents; ++i)
+    {
+        PerfEvent event = (PerfEvent)i;
+        state.counters[std::string(PerfCounters::name(event)) + "/item"] = (double)stats.perfCount(event) / numItems;
+    }
+    uint64_t cycles = stats.perfCount(PerfEvent::CpuCycles);
+    if (cycles > 0)
+    {
+        state.counters["ipc"] = (double)stats.perfCount(PerfEvent::Instructions) / cycles;
+    }
+}
+
+#endif //QUANTUM_BENCHMARK_PERF_H
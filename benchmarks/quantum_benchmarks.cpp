@@ -0,0 +1,351 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#include <benchmark/benchmark.h>
+#include <quantum/quantum.h>
+#include "quantum_benchmark_perf.h"
+#include <vector>
+#include <numeric>
+#include <map>
+#include <string>
+#include <thread>
+
+namespace quantum = Bloomberg::quantum;
+using namespace quantum;
+
+//==============================================================================
+//                           BENCHMARK HELPERS
+//==============================================================================
+Configuration makeConfig(int numCoroutineThreads, int numIoThreads)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(numCoroutineThreads);
+    config.setNumIoThreads(numIoThreads);
+    enablePerfCounters(config);
+    return config;
+}
+
+//Number of coroutine threads passed as the first benchmark argument
+void threadCounts(benchmark::internal::Benchmark* bench)
+{
+    for (int numThreads : {1, 2, 4, 8})
+    {
+        bench->Arg(numThreads);
+    }
+}
+
+//==============================================================================
+//                           POSTING
+//==============================================================================
+//Round trip of a single coroutine posted from a thread
+void BM_PostLatency(benchmark::State& state)
+{
+    Dispatcher dispatcher(makeConfig(1, 1));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(dispatcher.post([](CoroContext<int>::Ptr ctx)->int {
+            return ctx->set(1);
+        })->get());
+    }
+}
+BENCHMARK(BM_PostLatency)->UseRealTime();
+
+//Coroutines posted back to back then drained
+void BM_PostThroughput(benchmark::State& state)
+{
+    const int numTasks = 1000;
+    Dispatcher dispatcher(makeConfig(state.range(0), 1));
+    for (auto _ : state)
+    {
+        for (int i = 0; i < numTasks; ++i)
+        {
+            dispatcher.post([](CoroContext<int>::Ptr)->int { return 0; });
+        }
+        dispatcher.drain();
+    }
+    state.SetItemsProcessed(state.iterations() * numTasks);
+    reportPerfCounters(state, dispatcher, state.iterations() * numTasks);
+}
+BENCHMARK(BM_PostThroughput)->Apply(threadCounts)->UseRealTime();
+
+//One posting thread per coroutine queue, each feeding its own queue. Nothing is shared
+//between the pairs so any slowdown with more pairs comes from false sharing between queues.
+void BM_PostToOwnQueue(benchmark::State& state)
+{
+    const int numTasks = 1000;
+    const int numQueues = state.range(0);
+    Dispatcher dispatcher(makeConfig(numQueues, 1));
+    for (auto _ : state)
+    {
+        std::vector<std::thread> posters;
+        for (int queueId = 0; queueId < numQueues; ++queueId)
+        {
+            posters.emplace_back([&dispatcher, queueId, numTasks]() {
+                ThreadContextPtr<int> last;
+                for (int i = 0; i < numTasks; ++i)
+                {
+                    last = dispatcher.post(queueId, false, [](CoroContext<int>::Ptr ctx)->int { return ctx->set(0); });
+                }
+                last->wait();
+            });
+        }
+        for (auto&& poster : posters)
+        {
+            poster.join();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numQueues * numTasks);
+    reportPerfCounters(state, dispatcher, state.iterations() * numQueues * numTasks);
+}
+BENCHMARK(BM_PostToOwnQueue)->Apply(threadCounts)->UseRealTime();
+
+//Cost of a yield, i.e. two context switches
+void BM_Yield(benchmark::State& state)
+{
+    const int numYields = 1000;
+    Dispatcher dispatcher(makeConfig(1, 1));
+    for (auto _ : state)
+    {
+        dispatcher.post([numYields](CoroContext<int>::Ptr ctx)->int {
+            for (int i = 0; i < numYields; ++i)
+            {
+                ctx->yield();
+            }
+            return ctx->set(0);
+        })->get();
+    }
+    state.SetItemsProcessed(state.iterations() * numYields);
+    reportPerfCounters(state, dispatcher, state.iterations() * numYields);
+}
+BENCHMARK(BM_Yield)->UseRealTime();
+
+//Coroutine posting an IO task and waiting for its result
+void BM_PostAsyncIoRoundTrip(benchmark::State& state)
+{
+    Dispatcher dispatcher(makeConfig(1, 1));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(dispatcher.post([](CoroContext<int>::Ptr ctx)->int {
+            return ctx->set(ctx->postAsyncIo([](ThreadPromise<int>::Ptr promise)->int {
+                return promise->set(1);
+            })->get(ctx));
+        })->get());
+    }
+}
+BENCHMARK(BM_PostAsyncIoRoundTrip)->UseRealTime();
+
+//Continuation chain of 'n' stages, each reading the previous stage's result
+void BM_ContinuationChain(benchmark::State& state)
+{
+    Dispatcher dispatcher(makeConfig(1, 1));
+    for (auto _ : state)
+    {
+        auto ctx = dispatcher.postFirst([](CoroContext<int>::Ptr ctx)->int { return ctx->set(0); });
+        for (int i = 1; i < state.range(0); ++i)
+        {
+            ctx = ctx->then([](CoroContext<int>::Ptr ctx)->int {
+                return ctx->set(ctx->getPrevRef<int>() + 1);
+            });
+        }
+        benchmark::DoNotOptimize(ctx->end()->get());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ContinuationChain)->Arg(2)->Arg(10)->Arg(20)->UseRealTime();
+
+//==============================================================================
+//                           SYNCHRONIZATION
+//==============================================================================
+//Coroutines on all the threads incrementing a counter protected by a mutex
+void BM_MutexContention(benchmark::State& state)
+{
+    const int numCoros = 16;
+    const int numLocks = 1000;
+    Dispatcher dispatcher(makeConfig(state.range(0), 1));
+    Mutex mutex;
+    size_t counter = 0;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < numCoros; ++i)
+        {
+            dispatcher.post([&](CoroContext<int>::Ptr ctx)->int {
+                for (int j = 0; j < numLocks; ++j)
+                {
+                    Mutex::Guard guard(ctx, mutex);
+                    ++counter;
+                }
+                return 0;
+            });
+        }
+        dispatcher.drain();
+    }
+    benchmark::DoNotOptimize(counter);
+    state.SetItemsProcessed(state.iterations() * numCoros * numLocks);
+    reportPerfCounters(state, dispatcher, state.iterations() * numCoros * numLocks);
+}
+BENCHMARK(BM_MutexContention)->Apply(threadCounts)->UseRealTime();
+
+//Two coroutines handing a token back and forth through a condition variable
+void BM_ConditionVariablePingPong(benchmark::State& state)
+{
+    const int numRounds = 1000;
+    Dispatcher dispatcher(makeConfig(2, 1));
+    for (auto _ : state)
+    {
+        Mutex mutex;
+        ConditionVariable cv;
+        int turn = 0;
+        auto player = [&](int self)
+        {
+            return [&, self](CoroContext<int>::Ptr ctx)->int {
+                for (int i = 0; i < numRounds; ++i)
+                {
+                    Mutex::Guard guard(ctx, mutex);
+                    cv.wait(ctx, mutex, [&]()->bool { return turn == self; });
+                    turn = 1 - self;
+                    cv.notifyAll();
+                }
+                return 0;
+            };
+        };
+        dispatcher.post(0, false, player(0));
+        dispatcher.post(1, false, player(1));
+        dispatcher.drain();
+    }
+    state.SetItemsProcessed(state.iterations() * numRounds * 2);
+    reportPerfCounters(state, dispatcher, state.iterations() * numRounds * 2);
+}
+BENCHMARK(BM_ConditionVariablePingPong)->UseRealTime();
+
+//==============================================================================
+//                           PROMISES AND FUTURES
+//==============================================================================
+void BM_PromiseSetGet(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        Promise<int> promise;
+        ThreadFuturePtr<int> future = promise.getIThreadFuture();
+        promise.set(1);
+        benchmark::DoNotOptimize(future->get());
+    }
+}
+BENCHMARK(BM_PromiseSetGet);
+
+//Values streamed from a coroutine into a thread through a buffered future
+void BM_BufferedFutureStreaming(benchmark::State& state)
+{
+    const int numValues = 1000;
+    Dispatcher dispatcher(makeConfig(1, 1));
+    for (auto _ : state)
+    {
+        ThreadContext<Buffer<int>>::Ptr ctx = dispatcher.post<Buffer<int>>([numValues](CoroContext<Buffer<int>>::Ptr ctx)->int {
+            for (int i = 0; i < numValues; ++i)
+            {
+                ctx->push(i);
+            }
+            return ctx->closeBuffer();
+        });
+        bool isBufferClosed = false;
+        while (!isBufferClosed)
+        {
+            benchmark::DoNotOptimize(ctx->pull(isBufferClosed));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numValues);
+    reportPerfCounters(state, dispatcher, state.iterations() * numValues);
+}
+BENCHMARK(BM_BufferedFutureStreaming)->UseRealTime();
+
+//==============================================================================
+//                           ALLOCATORS
+//==============================================================================
+void BM_StackAllocator(benchmark::State& state)
+{
+    StackAllocator<std::array<char, 64>, 1024> pool;
+    for (auto _ : state)
+    {
+        auto* block = pool.allocate();
+        benchmark::DoNotOptimize(block);
+        pool.deallocate(block);
+    }
+}
+BENCHMARK(BM_StackAllocator);
+
+void BM_CoroutinePoolAllocator(benchmark::State& state)
+{
+    CoroutinePoolAllocator<StackTraitsProxy> stacks(64);
+    for (auto _ : state)
+    {
+        boost::context::stack_context ctx = stacks.allocate();
+        benchmark::DoNotOptimize(ctx.sp);
+        stacks.deallocate(ctx);
+    }
+}
+BENCHMARK(BM_CoroutinePoolAllocator);
+
+//==============================================================================
+//                           PARALLEL ALGORITHMS
+//==============================================================================
+void BM_ForEach(benchmark::State& state)
+{
+    std::vector<int> input(10000);
+    std::iota(input.begin(), input.end(), 0);
+    Dispatcher dispatcher(makeConfig(state.range(0), 1));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(dispatcher.forEach<int>(input.begin(), input.end(), [](int value)->int {
+            return value * 2;
+        })->get());
+    }
+    state.SetItemsProcessed(state.iterations() * input.size());
+    reportPerfCounters(state, dispatcher, state.iterations() * input.size());
+}
+BENCHMARK(BM_ForEach)->Apply(threadCounts)->UseRealTime();
+
+void BM_MapReduce(benchmark::State& state)
+{
+    //word count over documents of 100 words drawn from a vocabulary of 100
+    std::vector<std::vector<std::string>> input(1000);
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        for (size_t j = 0; j < 100; ++j)
+        {
+            input[i].push_back(std::to_string((i * 7 + j * 13) % 100));
+        }
+    }
+    Dispatcher dispatcher(makeConfig(state.range(0), 1));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(dispatcher.mapReduce<std::string, size_t, size_t>(input.begin(), input.end(),
+            [](const std::vector<std::string>& words)->std::vector<std::pair<std::string, size_t>>
+            {
+                std::vector<std::pair<std::string, size_t>> out;
+                for (auto&& word : words) {
+                    out.push_back({word, 1});
+                }
+                return out;
+            },
+            [](std::pair<std::string, std::vector<size_t>>&& counts)->std::pair<std::string, size_t>
+            {
+                return {std::move(counts.first), std::accumulate(counts.second.begin(), counts.second.end(), (size_t)0)};
+            })->get());
+    }
+    state.SetItemsProcessed(state.iterations() * input.size() * 100);
+    reportPerfCounters(state, dispatcher, state.iterations() * input.size() * 100);
+}
+BENCHMARK(BM_MapReduce)->Apply(threadCounts)->UseRealTime();
+
+BENCHMARK_MAIN();
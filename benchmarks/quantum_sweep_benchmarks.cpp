@@ -0,0 +1,187 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#include <benchmark/benchmark.h>
+#include <quantum/quantum.h>
+#include "quantum_benchmark_perf.h"
+#include <sys/resource.h>
+#include <chrono>
+#include <thread>
+
+namespace quantum = Bloomberg::quantum;
+using namespace quantum;
+
+//==============================================================================
+//                           CONFIGURATION SWEEP
+//==============================================================================
+//Each workload is run against every combination of the IO configuration parameters below:
+//  arg 0 : shared IO queue load balancing (0 = off, 1 = on)
+//  arg 1 : number of IO threads
+//Besides the wall time, every run reports the IO task throughput, the post-to-completion latency
+//percentiles in microseconds and the number of cores busy on average. Use --benchmark_format=csv|json
+//or --benchmark_out=<file> to produce a table for capacity planning.
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void ioSweepArgs(benchmark::internal::Benchmark* bench)
+{
+    bench->ArgNames({"loadBalance", "ioThreads"});
+    bench->ArgsProduct({{0, 1}, {1, 2, 4, 8}});
+    bench->Iterations(3);
+    bench->UseRealTime();
+}
+
+Configuration makeSweepConfig(const benchmark::State& state)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(4);
+    config.setNumIoThreads(state.range(1));
+    config.setLoadBalanceSharedIoQueues(state.range(0) != 0);
+    enablePerfCounters(config);
+    return config;
+}
+
+//User plus system time of the whole process, i.e. all the dispatcher threads
+std::chrono::microseconds processCpuTime()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return std::chrono::microseconds(
+        (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL +
+        usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+void burnCpu(std::chrono::microseconds time)
+{
+    auto end = Clock::now() + time;
+    while (Clock::now() < end);
+}
+
+//Collects the sweep results and publishes them as benchmark counters
+class SweepRecorder
+{
+public:
+    SweepRecorder(benchmark::State& state, Dispatcher& dispatcher) :
+        _state(state),
+        _dispatcher(dispatcher),
+        _cpuStart(processCpuTime()),
+        _wallStart(Clock::now())
+    {}
+    
+    ~SweepRecorder()
+    {
+        double wall = std::chrono::duration<double>(Clock::now() - _wallStart).count();
+        double cpu = std::chrono::duration<double>(processCpuTime() - _cpuStart).count();
+        _state.SetItemsProcessed(_latency.count());
+        _state.counters["p50_us"] = percentileUs(50);
+        _state.counters["p99_us"] = percentileUs(99);
+        _state.counters["p999_us"] = percentileUs(99.9);
+        _state.counters["max_us"] = std::chrono::duration<double, std::micro>(_latency.max()).count();
+        _state.counters["cpu_cores"] = (wall > 0) ? cpu / wall : 0;
+        reportPerfCounters(_state, _dispatcher, _latency.count());
+    }
+    
+    //Wraps an IO task so that its post-to-completion latency is recorded
+    template <class FUNC>
+    std::function<int(ThreadPromise<int>::Ptr)> wrap(FUNC func)
+    {
+        Clock::time_point posted = Clock::now();
+        return [this, posted, func](ThreadPromise<int>::Ptr promise)->int {
+            func();
+            _latency.add(Clock::now() - posted);
+            return promise->set(0);
+        };
+    }
+    
+private:
+    double percentileUs(double percent) const
+    {
+        return std::chrono::duration<double, std::micro>(_latency.percentile(percent)).count();
+    }
+    
+    benchmark::State&           _state;
+    Dispatcher&                 _dispatcher;
+    std::chrono::microseconds   _cpuStart;
+    Clock::time_point           _wallStart;
+    LatencyHistogram            _latency;
+};
+
+}
+
+//IO tasks with mixed blocking durations: mostly short, some 100us and a few 1ms waits
+void BM_IoSweepMixedBlocking(benchmark::State& state)
+{
+    const int numTasks = 2000;
+    Dispatcher dispatcher(makeSweepConfig(state));
+    SweepRecorder recorder(state, dispatcher);
+    for (auto _ : state)
+    {
+        for (int i = 0; i < numTasks; ++i)
+        {
+            std::chrono::microseconds blockTime((i % 20 == 0) ? 1000 : (i % 20 < 4) ? 100 : 0);
+            dispatcher.postAsyncIo(recorder.wrap([blockTime]{ std::this_thread::sleep_for(blockTime); }));
+        }
+        dispatcher.drain();
+    }
+}
+BENCHMARK(BM_IoSweepMixedBlocking)->Apply(ioSweepArgs);
+
+//IO tasks arriving in bursts separated by quiet periods
+void BM_IoSweepBurstyArrivals(benchmark::State& state)
+{
+    const int numBursts = 20;
+    const int burstSize = 100;
+    Dispatcher dispatcher(makeSweepConfig(state));
+    SweepRecorder recorder(state, dispatcher);
+    for (auto _ : state)
+    {
+        for (int i = 0; i < numBursts; ++i)
+        {
+            for (int j = 0; j < burstSize; ++j)
+            {
+                dispatcher.postAsyncIo(recorder.wrap([]{ std::this_thread::sleep_for(std::chrono::microseconds(50)); }));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        dispatcher.drain();
+    }
+}
+BENCHMARK(BM_IoSweepBurstyArrivals)->Apply(ioSweepArgs);
+
+//CPU-heavy coroutines which alternate computation with blocking IO calls
+void BM_IoSweepCpuHeavyCoroutines(benchmark::State& state)
+{
+    const int numCoros = 200;
+    const int numIoCalls = 5;
+    Dispatcher dispatcher(makeSweepConfig(state));
+    SweepRecorder recorder(state, dispatcher);
+    for (auto _ : state)
+    {
+        for (int i = 0; i < numCoros; ++i)
+        {
+            dispatcher.post([&recorder](CoroContext<int>::Ptr ctx)->int {
+                for (int j = 0; j < numIoCalls; ++j)
+                {
+                    burnCpu(std::chrono::microseconds(100));
+                    ctx->postAsyncIo(recorder.wrap([]{ std::this_thread::sleep_for(std::chrono::microseconds(200)); }))->get(ctx);
+                }
+                return ctx->set(0);
+            });
+        }
+        dispatcher.drain();
+    }
+}
+BENCHMARK(BM_IoSweepCpuHeavyCoroutines)->Apply(ioSweepArgs);
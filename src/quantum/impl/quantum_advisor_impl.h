@@ -0,0 +1,330 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                class Advisor
+//==============================================================================================
+inline
+Advisor::Advisor(Dispatcher& dispatcher, Configuration config) :
+    _dispatcher(dispatcher),
+    _config(std::move(config)),
+    _numSamples(0),
+    _sumRunnableCoroutines(0),
+    _sumBlockedCoroutines(0),
+    _sumCoroutines(0),
+    _sumIoBacklog(0),
+    _sumSharedIoBacklog(0),
+    _coroWaitTimeP99(0),
+    _ioWaitTimeP50(0)
+{}
+
+inline
+void Advisor::sample()
+{
+    MetricsSnapshot metrics = _dispatcher.metrics();
+    QueueStatistics coroStats = _dispatcher.stats(IQueue::QueueType::Coro);
+    QueueStatistics ioStats = _dispatcher.stats(IQueue::QueueType::IO);
+    
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto&& queue : metrics.coroQueues())
+    {
+        _sumCoroutines += queue._depth;
+        _sumBlockedCoroutines += queue._blocked;
+        _sumRunnableCoroutines += queue._depth - std::min(queue._blocked, queue._depth);
+    }
+    for (auto&& queue : metrics.ioQueues())
+    {
+        _sumIoBacklog += queue._depth;
+    }
+    _sumIoBacklog += metrics.sharedIoQueue()._depth;
+    _sumSharedIoBacklog += metrics.sharedIoQueue()._depth;
+    //the histograms are cumulative so the latest percentiles cover the whole run
+    _coroWaitTimeP99 = coroStats.waitTimeHistogram().percentile(99);
+    _ioWaitTimeP50 = ioStats.waitTimeHistogram().percentile(50);
+    if (_numSamples == 0)
+    {
+        _firstPools = metrics.pools();
+    }
+    _lastPools = metrics.pools();
+    ++_numSamples;
+}
+
+inline
+size_t Advisor::numSamples() const
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _numSamples;
+}
+
+inline
+void Advisor::reset()
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    _numSamples = 0;
+    _sumRunnableCoroutines = 0;
+    _sumBlockedCoroutines = 0;
+    _sumCoroutines = 0;
+    _sumIoBacklog = 0;
+    _sumSharedIoBacklog = 0;
+    _coroWaitTimeP99 = std::chrono::nanoseconds(0);
+    _ioWaitTimeP50 = std::chrono::nanoseconds(0);
+}
+
+inline
+std::vector<Advisor::Recommendation> Advisor::recommendations() const
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    return recommendationsImpl();
+}
+
+inline
+Configuration Advisor::recommendedConfiguration() const
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    Configuration config = _config;
+    for (auto&& recommendation : recommendationsImpl())
+    {
+        applyTo(config, recommendation);
+    }
+    return config;
+}
+
+inline
+size_t Advisor::apply()
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t numApplied = 0;
+    for (auto&& recommendation : recommendationsImpl())
+    {
+        if (recommendation._isLive && (recommendation._setting == "maxNumIoThreads"))
+        {
+            _dispatcher.setMaxNumIoThreads((int)recommendation._recommended);
+            applyTo(_config, recommendation);
+            ++numApplied;
+        }
+    }
+    return numApplied;
+}
+
+inline
+void Advisor::print(std::ostream& out) const
+{
+    std::vector<Recommendation> recommendations;
+    size_t numSamples;
+    {
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_mutex);
+        recommendations = recommendationsImpl();
+        numSamples = _numSamples;
+    }
+    out << "Advisor: " << numSamples << " samples, " << recommendations.size() << " recommendations" << std::endl;
+    for (auto&& recommendation : recommendations)
+    {
+        out << "  " << recommendation._setting << ": " << recommendation._current
+            << " -> " << recommendation._recommended << (recommendation._isLive ? " (live)" : "")
+            << ", " << recommendation._reason << std::endl;
+    }
+}
+
+inline
+std::vector<Advisor::Recommendation> Advisor::recommendationsImpl() const
+{
+    //Queues holding more than this many pending tasks per thread are considered short of threads
+    const double backlogPerThread = 2.0;
+    //Coroutines waiting less than this before running do not need more threads
+    const std::chrono::nanoseconds coroWaitTarget = std::chrono::milliseconds(1);
+    //Same for the IO tasks and the extra IO threads
+    const std::chrono::nanoseconds ioWaitTarget = std::chrono::milliseconds(1);
+    
+    std::vector<Recommendation> recommendations;
+    if (_numSamples == 0)
+    {
+        return recommendations;
+    }
+    double numSamples = (double)_numSamples;
+    double blockedRatio = (_sumCoroutines > 0) ? _sumBlockedCoroutines/_sumCoroutines : 0;
+    
+    //Coroutine threads. Blocked coroutines are not counted since more threads would not run them sooner.
+    size_t numCoroThreads = (size_t)_dispatcher.getNumCoroutineThreads();
+    size_t maxCoroThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    double runnable = _sumRunnableCoroutines/numSamples;
+    if ((runnable > backlogPerThread*numCoroThreads) &&
+        ((_coroWaitTimeP99.count() == 0) || (_coroWaitTimeP99 > coroWaitTarget)))
+    {
+        size_t recommended = std::min(maxCoroThreads, (size_t)std::ceil(runnable/backlogPerThread));
+        if (recommended > numCoroThreads)
+        {
+            std::ostringstream reason;
+            reason << "average of " << runnable/numCoroThreads << " runnable coroutines per thread";
+            if (_coroWaitTimeP99.count() > 0)
+            {
+                reason << ", p99 wait time " << std::chrono::duration_cast<std::chrono::microseconds>(_coroWaitTimeP99).count() << "us";
+            }
+            recommendations.push_back({"numCoroutineThreads", numCoroThreads, recommended, false, reason.str()});
+        }
+    }
+    
+    //IO threads. An IO backlog with mostly blocked coroutines means the coroutines are waiting on IO.
+    size_t numIoThreads = (size_t)_dispatcher.getNumIoThreads();
+    size_t maxIoThreads = std::max((size_t)std::max(_config.getMaxNumIoThreads(), 0), numIoThreads);
+    double ioBacklog = _sumIoBacklog/numSamples;
+    if (ioBacklog > backlogPerThread*maxIoThreads)
+    {
+        size_t recommended = (size_t)std::ceil(ioBacklog/backlogPerThread);
+        std::ostringstream reason;
+        reason << "average of " << ioBacklog/maxIoThreads << " pending IO tasks per thread, "
+               << (int)(blockedRatio*100) << "% of the coroutines blocked";
+        recommendations.push_back({"maxNumIoThreads", (size_t)std::max(_config.getMaxNumIoThreads(), 0),
+                                   recommended, true, reason.str()});
+    }
+    
+    //Elastic IO threads. Tasks waiting on a shared backlog which never reaches the growth threshold
+    //would be picked up sooner with a lower threshold.
+    size_t growthBacklog = _config.getIoThreadGrowthBacklog();
+    double sharedIoBacklog = _sumSharedIoBacklog/numSamples;
+    if ((_config.getMaxNumIoThreads() > _config.getNumIoThreads()) && (_ioWaitTimeP50 > ioWaitTarget) &&
+        (sharedIoBacklog < growthBacklog))
+    {
+        size_t recommended = std::max((size_t)1, (size_t)sharedIoBacklog);
+        if (recommended < growthBacklog)
+        {
+            std::ostringstream reason;
+            reason << "median IO wait time " << std::chrono::duration_cast<std::chrono::microseconds>(_ioWaitTimeP50).count()
+                   << "us with an average of " << sharedIoBacklog << " tasks in the shared IO queue";
+            recommendations.push_back({"ioThreadGrowthBacklog", growthBacklog, recommended, false, reason.str()});
+        }
+    }
+    
+    //Pools which had to fall back to the heap during the sampled period
+    for (int i = 0; i < (int)Configuration::PoolType::Max; ++i)
+    {
+        Configuration::PoolType pool = (Configuration::PoolType)i;
+        const PoolStatistics& first = poolStats(_firstPools, pool);
+        const PoolStatistics& last = poolStats(_lastPools, pool);
+        if (last.heapFallbackCount() <= first.heapFallbackCount())
+        {
+            continue;
+        }
+        size_t current = poolAllocSize(_config, pool);
+        size_t recommended = std::max(current + 1, last.peakInUse() + last.peakInUse()/4); //25% headroom
+        std::ostringstream reason;
+        reason << (last.heapFallbackCount() - first.heapFallbackCount()) << " heap fallbacks, peak of "
+               << last.peakInUse() << " blocks in use";
+        recommendations.push_back({std::string("poolAllocSizes.") + poolName(pool), current, recommended, false, reason.str()});
+    }
+    return recommendations;
+}
+
+inline
+void Advisor::applyTo(Configuration& config, const Recommendation& recommendation)
+{
+    if (recommendation._setting == "numCoroutineThreads")
+    {
+        config.setNumCoroutineThreads((int)recommendation._recommended);
+    }
+    else if (recommendation._setting == "maxNumIoThreads")
+    {
+        config.setMaxNumIoThreads((int)recommendation._recommended);
+    }
+    else if (recommendation._setting == "ioThreadGrowthBacklog")
+    {
+        config.setIoThreadGrowthBacklog(recommendation._recommended);
+    }
+    else
+    {
+        for (int i = 0; i < (int)Configuration::PoolType::Max; ++i)
+        {
+            Configuration::PoolType pool = (Configuration::PoolType)i;
+            if (recommendation._setting == std::string("poolAllocSizes.") + poolName(pool))
+            {
+                config.setPoolAllocSize(pool, recommendation._recommended);
+            }
+        }
+    }
+}
+
+inline
+size_t Advisor::poolAllocSize(const Configuration& config, Configuration::PoolType pool)
+{
+    if (config.getPoolAllocSize(pool) > 0)
+    {
+        return config.getPoolAllocSize(pool);
+    }
+    switch (pool)
+    {
+        case Configuration::PoolType::Task: return AllocatorTraits::taskAllocSize();
+        case Configuration::PoolType::IoTask: return AllocatorTraits::ioTaskAllocSize();
+        case Configuration::PoolType::Context: return AllocatorTraits::contextAllocSize();
+        case Configuration::PoolType::Promise: return AllocatorTraits::promiseAllocSize();
+        case Configuration::PoolType::Future: return AllocatorTraits::futureAllocSize();
+        case Configuration::PoolType::QueueList: return AllocatorTraits::queueListAllocSize();
+        default: return AllocatorTraits::defaultCoroPoolAllocSize();
+    }
+}
+
+inline
+const PoolStatistics& Advisor::poolStats(const AllocatorStatistics& stats, Configuration::PoolType pool)
+{
+    switch (pool)
+    {
+        case Configuration::PoolType::Task: return stats.task();
+        case Configuration::PoolType::IoTask: return stats.ioTask();
+        case Configuration::PoolType::Context: return stats.context();
+        case Configuration::PoolType::Promise: return stats.promise();
+        case Configuration::PoolType::Future: return stats.future();
+        case Configuration::PoolType::QueueList: return stats.queueList();
+        default: return stats.coroStack();
+    }
+}
+
+inline
+const char* Advisor::poolName(Configuration::PoolType pool)
+{
+    //same names as in the JSON schema
+    switch (pool)
+    {
+        case Configuration::PoolType::Task: return "task";
+        case Configuration::PoolType::IoTask: return "ioTask";
+        case Configuration::PoolType::Context: return "context";
+        case Configuration::PoolType::Promise: return "promise";
+        case Configuration::PoolType::Future: return "future";
+        case Configuration::PoolType::QueueList: return "queueList";
+        default: return "coroStack";
+    }
+}
+
+inline
+std::ostream& operator<<(std::ostream& out, const Advisor& advisor)
+{
+    advisor.print(out);
+    return out;
+}
+
+}}
@@ -0,0 +1,311 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                 class StackUsageHistogram
+//==============================================================================================
+inline
+StackUsageHistogram::StackUsageHistogram()
+{
+    reset();
+}
+
+inline
+StackUsageHistogram::StackUsageHistogram(const StackUsageHistogram& other)
+{
+    reset();
+    *this += other;
+}
+
+inline
+StackUsageHistogram& StackUsageHistogram::operator=(const StackUsageHistogram& other)
+{
+    if (this != &other)
+    {
+        reset();
+        *this += other;
+    }
+    return *this;
+}
+
+inline
+void StackUsageHistogram::reset()
+{
+    for (auto&& bucket : _buckets)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    _count.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+inline
+void StackUsageHistogram::add(size_t bytes)
+{
+    _buckets[bucketIndex(bytes)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    size_t maxBytes = _max.load(std::memory_order_relaxed);
+    while ((bytes > maxBytes) && !_max.compare_exchange_weak(maxBytes, bytes, std::memory_order_relaxed));
+}
+
+inline
+size_t StackUsageHistogram::count() const
+{
+    return _count.load(std::memory_order_relaxed);
+}
+
+inline
+size_t StackUsageHistogram::max() const
+{
+    return _max.load(std::memory_order_relaxed);
+}
+
+inline
+size_t StackUsageHistogram::percentile(double percent) const
+{
+    //Sum the buckets first since the total count may be updated concurrently
+    size_t num = 0;
+    for (auto&& bucket : _buckets)
+    {
+        num += bucket.load(std::memory_order_relaxed);
+    }
+    if (num == 0)
+    {
+        return 0;
+    }
+    percent = (percent < 0) ? 0 : ((percent > 100) ? 100 : percent);
+    size_t rank = (size_t)(percent * num / 100);
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+    size_t cumulative = 0;
+    for (size_t i = 0; i < numBuckets-1; ++i)
+    {
+        cumulative += _buckets[i].load(std::memory_order_relaxed);
+        if (cumulative >= rank)
+        {
+            size_t upper = ((size_t)2 << i) - 1;
+            return (upper < max()) ? upper : max();
+        }
+    }
+    return max();
+}
+
+inline
+size_t StackUsageHistogram::bucketCount(size_t bucket) const
+{
+    return (bucket < numBuckets) ? _buckets[bucket].load(std::memory_order_relaxed) : 0;
+}
+
+inline
+size_t StackUsageHistogram::bucketIndex(size_t bytes)
+{
+    size_t bucket = 0;
+    while ((bytes >>= 1) != 0)
+    {
+        ++bucket;
+    }
+    return (bucket < numBuckets) ? bucket : numBuckets-1;
+}
+
+inline
+void StackUsageHistogram::print(std::ostream& out) const
+{
+    out << "count=" << count()
+        << " p50=" << percentile(50)
+        << " p99=" << percentile(99)
+        << " max=" << max() << " (bytes)";
+}
+
+inline
+StackUsageHistogram& StackUsageHistogram::operator+=(const StackUsageHistogram& rhs)
+{
+    for (size_t i = 0; i < numBuckets; ++i)
+    {
+        _buckets[i].fetch_add(rhs._buckets[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    _count.fetch_add(rhs.count(), std::memory_order_relaxed);
+    size_t rhsMax = rhs.max();
+    size_t maxBytes = _max.load(std::memory_order_relaxed);
+    while ((rhsMax > maxBytes) && !_max.compare_exchange_weak(maxBytes, rhsMax, std::memory_order_relaxed));
+    return *this;
+}
+
+//==============================================================================================
+//                                   class PoolStatistics
+//==============================================================================================
+inline
+PoolStatistics::PoolStatistics() :
+    PoolStatistics(0, 0, 0, 0, 0, 0)
+{}
+
+inline
+PoolStatistics::PoolStatistics(size_t capacity,
+                               size_t inUse,
+                               size_t peakInUse,
+                               size_t heapFallbackCount,
+                               size_t numSlabs,
+                               size_t contentionCount,
+                               const StackUsageHistogram& stackUsage) :
+    _capacity(capacity),
+    _inUse(inUse),
+    _peakInUse(peakInUse),
+    _heapFallbackCount(heapFallbackCount),
+    _numSlabs(numSlabs),
+    _contentionCount(contentionCount),
+    _stackUsage(stackUsage)
+{}
+
+inline
+size_t PoolStatistics::capacity() const
+{
+    return _capacity;
+}
+
+inline
+size_t PoolStatistics::inUse() const
+{
+    return _inUse;
+}
+
+inline
+size_t PoolStatistics::peakInUse() const
+{
+    return _peakInUse;
+}
+
+inline
+size_t PoolStatistics::heapFallbackCount() const
+{
+    return _heapFallbackCount;
+}
+
+inline
+size_t PoolStatistics::numSlabs() const
+{
+    return _numSlabs;
+}
+
+inline
+size_t PoolStatistics::contentionCount() const
+{
+    return _contentionCount;
+}
+
+inline
+const StackUsageHistogram& PoolStatistics::stackUsage() const
+{
+    return _stackUsage;
+}
+
+inline
+void PoolStatistics::print(std::ostream& out) const
+{
+    out << "capacity: " << _capacity
+        << " in use: " << _inUse
+        << " peak: " << _peakInUse
+        << " heap fallbacks: " << _heapFallbackCount
+        << " slabs: " << _numSlabs
+        << " contentions: " << _contentionCount;
+    if (_stackUsage.count() > 0)
+    {
+        out << " stack usage: ";
+        _stackUsage.print(out);
+    }
+    out << std::endl;
+}
+
+//==============================================================================================
+//                                 class AllocatorStatistics
+//==============================================================================================
+inline
+const PoolStatistics& AllocatorStatistics::task() const
+{
+    return _task;
+}
+
+inline
+const PoolStatistics& AllocatorStatistics::ioTask() const
+{
+    return _ioTask;
+}
+
+inline
+const PoolStatistics& AllocatorStatistics::context() const
+{
+    return _context;
+}
+
+inline
+const PoolStatistics& AllocatorStatistics::promise() const
+{
+    return _promise;
+}
+
+inline
+const PoolStatistics& AllocatorStatistics::future() const
+{
+    return _future;
+}
+
+inline
+const PoolStatistics& AllocatorStatistics::queueList() const
+{
+    return _queueList;
+}
+
+inline
+const PoolStatistics& AllocatorStatistics::coroStack() const
+{
+    return _coroStack;
+}
+
+inline
+void AllocatorStatistics::print(std::ostream& out) const
+{
+    out << "Task pool: " << _task;
+    out << "IO task pool: " << _ioTask;
+    out << "Context pool: " << _context;
+    out << "Promise pool: " << _promise;
+    out << "Future pool: " << _future;
+    out << "Queue list pool: " << _queueList;
+    out << "Coroutine stack pool: " << _coroStack;
+}
+
+inline
+std::ostream& operator<<(std::ostream& out, const PoolStatistics& stats)
+{
+    stats.print(out);
+    return out;
+}
+
+inline
+std::ostream& operator<<(std::ostream& out, const AllocatorStatistics& stats)
+{
+    stats.print(out);
+    return out;
+}
+
+}}
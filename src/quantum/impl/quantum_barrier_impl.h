@@ -0,0 +1,135 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+thread_local static std::atomic_int s_barrierThreadSignal{-1}; //thread specific (non-coroutine)
+
+//==============================================================================================
+//                                class Barrier
+//==============================================================================================
+inline
+Barrier::Barrier(ptrdiff_t count) :
+    _count(count),
+    _remaining(count),
+    _phase(0)
+{}
+
+inline
+void Barrier::arriveAndWait()
+{
+    arriveAndWaitImpl(s_barrierThreadSignal, nullptr);
+}
+
+inline
+void Barrier::arriveAndWait(ICoroSync::Ptr sync)
+{
+    arriveAndWaitImpl(sync->signal(), sync);
+}
+
+inline
+void Barrier::arriveAndDrop()
+{
+    std::list<Waiter> waiters;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        --_count;
+        if (--_remaining > 0)
+        {
+            return;
+        }
+        completePhase(waiters);
+    }
+    notify(waiters);
+}
+
+inline
+size_t Barrier::phase() const
+{
+    return _phase.load(std::memory_order_acquire);
+}
+
+inline
+void Barrier::arriveAndWaitImpl(std::atomic_int& signal, ICoroSync::Ptr sync)
+{
+    std::list<Waiter> waiters;
+    bool isLast = false;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        if (--_remaining <= 0)
+        {
+            completePhase(waiters);
+            isLast = true;
+        }
+        else
+        {
+            signal = 0; //clear signal flag
+            _waiters.emplace_back(&signal, sync);
+        }
+    }
+    if (isLast)
+    {
+        notify(waiters);
+        return;
+    }
+    while (signal == 0)
+    {
+        if (sync)
+        {
+            sync->getYieldHandle()(); //parked by the queue until signalled
+        }
+        else
+        {
+            Futex::wait(signal, 0);
+        }
+    }
+    signal = -1; //reset signal flag
+}
+
+inline
+void Barrier::completePhase(std::list<Waiter>& waiters)
+{
+    _remaining = _count;
+    _phase.fetch_add(1, std::memory_order_acq_rel);
+    waiters.swap(_waiters);
+}
+
+inline
+void Barrier::notify(std::list<Waiter>& waiters)
+{
+    for (auto&& waiter : waiters)
+    {
+        (*waiter.first) = 1;
+        if (waiter.second)
+        {
+            waiter.second->wakeUp();
+        }
+        else
+        {
+            Futex::wakeOne(*waiter.first);
+        }
+    }
+}
+
+}}
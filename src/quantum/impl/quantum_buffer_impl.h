@@ -52,6 +52,30 @@ BufferStatus Buffer<T,ALLOCATOR>::pull(T& value)
     return BufferStatus::DataReceived;
 }
 
+template <class T, class ALLOCATOR>
+BufferStatus Buffer<T,ALLOCATOR>::pushMany(std::vector<T>&& values)
+{
+    if (_isClosed)
+    {
+        return BufferStatus::Closed;
+    }
+    _buffer.insert(_buffer.end(), std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+    return BufferStatus::DataPosted;
+}
+
+template <class T, class ALLOCATOR>
+BufferStatus Buffer<T,ALLOCATOR>::pullMany(std::vector<T>& values, size_t maxCount)
+{
+    if (_buffer.empty() || (maxCount == 0))
+    {
+        return _buffer.empty() && _isClosed ? BufferStatus::Closed : BufferStatus::DataPending;
+    }
+    size_t num = std::min(maxCount, _buffer.size());
+    values.insert(values.end(), std::make_move_iterator(_buffer.begin()), std::make_move_iterator(_buffer.begin() + num));
+    _buffer.erase(_buffer.begin(), _buffer.begin() + num);
+    return BufferStatus::DataReceived;
+}
+
 template <class T, class ALLOCATOR>
 void Buffer<T,ALLOCATOR>::close()
 {
@@ -59,13 +83,13 @@ void Buffer<T,ALLOCATOR>::close()
 }
 
 template <class T, class ALLOCATOR>
-size_t Buffer<T,ALLOCATOR>::size()
+size_t Buffer<T,ALLOCATOR>::size() const
 {
     return _buffer.size();
 }
 
 template <class T, class ALLOCATOR>
-bool Buffer<T,ALLOCATOR>::empty()
+bool Buffer<T,ALLOCATOR>::empty() const
 {
     return _buffer.empty();
 }
@@ -48,8 +48,8 @@ makeCapture(FUNC&& func, ARGS&& ... args)
 //                                   class Function
 //==============================================================================================
 
-template <typename RET, typename ... ARGS>
-Function<RET(ARGS...)>::Function(RET(*ptr)(ARGS...)) :
+template <typename RET, typename ... ARGS, size_t SIZE>
+Function<RET(ARGS...), SIZE>::Function(RET(*ptr)(ARGS...)) :
     _callable(reinterpret_cast<void*>(ptr)),
     _deleter(dummyDeleter)
 {
@@ -58,21 +58,21 @@ Function<RET(ARGS...)>::Function(RET(*ptr)(ARGS...)) :
     };
 }
 
-template <typename RET, typename ... ARGS>
-Function<RET(ARGS...)>::Function(const Function<RET(ARGS...)>& other)
+template <typename RET, typename ... ARGS, size_t SIZE>
+Function<RET(ARGS...), SIZE>::Function(const Function<RET(ARGS...), SIZE>& other)
 {
     *this = other;
 }
 
-template <typename RET, typename ... ARGS>
-Function<RET(ARGS...)>::Function(Function<RET(ARGS...)>&& other)
+template <typename RET, typename ... ARGS, size_t SIZE>
+Function<RET(ARGS...), SIZE>::Function(Function<RET(ARGS...), SIZE>&& other)
 {
     *this = std::move(other);
 }
 
-template <typename RET, typename ... ARGS>
-Function<RET(ARGS...)>&
-Function<RET(ARGS...)>::operator=(const Function<RET(ARGS...)>& other)
+template <typename RET, typename ... ARGS, size_t SIZE>
+Function<RET(ARGS...), SIZE>&
+Function<RET(ARGS...), SIZE>::operator=(const Function<RET(ARGS...), SIZE>& other)
 {
     if (this != &other) {
         _callback = other._callback;
@@ -88,9 +88,9 @@ Function<RET(ARGS...)>::operator=(const Function<RET(ARGS...)>& other)
     return *this;
 }
 
-template <typename RET, typename ... ARGS>
-Function<RET(ARGS...)>&
-Function<RET(ARGS...)>::operator=(Function<RET(ARGS...)>&& other)
+template <typename RET, typename ... ARGS, size_t SIZE>
+Function<RET(ARGS...), SIZE>&
+Function<RET(ARGS...), SIZE>::operator=(Function<RET(ARGS...), SIZE>&& other)
 {
     *this = other;
     if (this != &other) {
@@ -99,32 +99,32 @@ Function<RET(ARGS...)>::operator=(Function<RET(ARGS...)>&& other)
     return *this;
 }
 
-template <typename RET, typename ... ARGS>
-Function<RET(ARGS...)>::~Function()
+template <typename RET, typename ... ARGS, size_t SIZE>
+Function<RET(ARGS...), SIZE>::~Function()
 {
     _deleter(_callable);
 }
 
-template <typename RET, typename ... ARGS>
+template <typename RET, typename ... ARGS, size_t SIZE>
 template <typename FUNCTOR>
-Function<RET(ARGS...)>::Function(FUNCTOR&& functor)
+Function<RET(ARGS...), SIZE>::Function(FUNCTOR&& functor)
 {
     initFunctor(std::forward<FUNCTOR>(functor), std::is_lvalue_reference<FUNCTOR>());
 }
 
-template <typename RET, typename ... ARGS>
-RET Function<RET(ARGS...)>::operator()(ARGS...args) {
+template <typename RET, typename ... ARGS, size_t SIZE>
+RET Function<RET(ARGS...), SIZE>::operator()(ARGS...args) {
     return _callback(_callable, std::forward<ARGS>(args)...);
 }
 
-template <typename RET, typename ... ARGS>
-Function<RET(ARGS...)>::operator bool() const {
+template <typename RET, typename ... ARGS, size_t SIZE>
+Function<RET(ARGS...), SIZE>::operator bool() const {
     return !!_callable;
 }
 
-template <typename RET, typename ... ARGS>
+template <typename RET, typename ... ARGS, size_t SIZE>
 template <typename FUNCTOR>
-void Function<RET(ARGS...)>::initFunctor(FUNCTOR&& functor, std::true_type)
+void Function<RET(ARGS...), SIZE>::initFunctor(FUNCTOR&& functor, std::true_type)
 {
     _callable = std::addressof(functor);
     _deleter = dummyDeleter;
@@ -133,9 +133,9 @@ void Function<RET(ARGS...)>::initFunctor(FUNCTOR&& functor, std::true_type)
     };
 }
 
-template <typename RET, typename ... ARGS>
+template <typename RET, typename ... ARGS, size_t SIZE>
 template <typename FUNCTOR>
-void Function<RET(ARGS...)>::initFunctor(FUNCTOR&& functor, std::false_type)
+void Function<RET(ARGS...), SIZE>::initFunctor(FUNCTOR&& functor, std::false_type)
 {
     if (sizeof(FUNCTOR) <= size) {
         new (_storage.data()) FUNCTOR(std::forward<FUNCTOR>(functor));
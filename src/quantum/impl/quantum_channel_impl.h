@@ -0,0 +1,422 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+thread_local static std::atomic_int s_channelThreadSignal{-1}; //thread specific (non-coroutine)
+
+//==============================================================================================
+//                                      class Channel
+//==============================================================================================
+template <class T>
+Channel<T>::Channel(size_t capacity, Mode mode) :
+    _mode(mode),
+    _mask([capacity]()->size_t{
+        size_t size = 2; //the ring needs at least two cells to tell full from empty
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        return size - 1;
+    }()),
+    _cells(new Cell[_mask + 1]),
+    _head(0),
+    _tail(0),
+    _isClosed(false),
+    _numPushWaiters(0),
+    _numPullWaiters(0),
+    _numCallbacks(0)
+{
+    for (size_t i = 0; i <= _mask; ++i)
+    {
+        _cells[i]._sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <class T>
+template <class V>
+void Channel<T>::push(V&& value)
+{
+    pushImpl(s_channelThreadSignal, nullptr, std::forward<V>(value));
+}
+
+template <class T>
+template <class V>
+void Channel<T>::push(ICoroSync::Ptr sync, V&& value)
+{
+    pushImpl(sync->signal(), sync, std::forward<V>(value));
+}
+
+template <class T>
+template <class V>
+bool Channel<T>::tryPush(V&& value)
+{
+    if (_isClosed.load(std::memory_order_acquire))
+    {
+        ThrowFutureException(FutureState::BufferClosed);
+    }
+    if (!tryPushImpl(std::forward<V>(value)))
+    {
+        return false;
+    }
+    notifyOne(_pullWaiters, _numPullWaiters);
+    notifyCallbacks();
+    return true;
+}
+
+template <class T>
+T Channel<T>::pull(bool& isClosed)
+{
+    return pullImpl(s_channelThreadSignal, nullptr, isClosed);
+}
+
+template <class T>
+T Channel<T>::pull(ICoroSync::Ptr sync, bool& isClosed)
+{
+    return pullImpl(sync->signal(), sync, isClosed);
+}
+
+template <class T>
+bool Channel<T>::tryPull(T& value)
+{
+    if (!tryPullImpl(value))
+    {
+        return false;
+    }
+    notifyOne(_pushWaiters, _numPushWaiters);
+    return true;
+}
+
+template <class T>
+void Channel<T>::close()
+{
+    _isClosed.store(true, std::memory_order_release);
+    notifyAll(_pushWaiters, _numPushWaiters);
+    notifyAll(_pullWaiters, _numPullWaiters);
+    notifyCallbacks();
+}
+
+template <class T>
+bool Channel<T>::isClosed() const
+{
+    return _isClosed.load(std::memory_order_acquire);
+}
+
+template <class T>
+size_t Channel<T>::size() const
+{
+    size_t head = _head.load(std::memory_order_relaxed);
+    size_t tail = _tail.load(std::memory_order_relaxed);
+    return (tail > head) ? (tail - head) : 0;
+}
+
+template <class T>
+size_t Channel<T>::capacity() const
+{
+    return _mask + 1;
+}
+
+template <class T>
+void Channel<T>::addCallback(IFutureCallback::Ptr callback, size_t index)
+{
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        _callbacks.emplace_back(callback, index);
+        _numCallbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+    //pairs with the fence taken by a producer before checking for callbacks
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (canPull() || _isClosed.load(std::memory_order_acquire))
+    {
+        callback->onReady(index); //pushed before the callback was registered
+    }
+}
+
+template <class T>
+void Channel<T>::removeCallback(const IFutureCallback::Ptr& callback)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    for (auto it = _callbacks.begin(); it != _callbacks.end();)
+    {
+        if (it->first == callback)
+        {
+            it = _callbacks.erase(it);
+            _numCallbacks.fetch_sub(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+template <class T>
+template <class V>
+void Channel<T>::pushImpl(std::atomic_int& signal, ICoroSync::Ptr sync, V&& value)
+{
+    while (true)
+    {
+        if (_isClosed.load(std::memory_order_acquire))
+        {
+            ThrowFutureException(FutureState::BufferClosed);
+        }
+        if (tryPushImpl(std::forward<V>(value)))
+        {
+            break;
+        }
+        {
+            //========================= LOCKED SCOPE =========================
+            SpinLock::Guard lock(_spinlock);
+            signal = 0; //clear signal flag
+            _pushWaiters.emplace_back(&signal, sync);
+            _numPushWaiters.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (canPush() || _isClosed.load(std::memory_order_acquire))
+            {
+                //a consumer made room before it could see us
+                _pushWaiters.pop_back();
+                _numPushWaiters.fetch_sub(1, std::memory_order_relaxed);
+                signal = -1;
+                continue;
+            }
+        }
+        wait(signal, sync);
+    }
+    notifyOne(_pullWaiters, _numPullWaiters);
+    notifyCallbacks();
+}
+
+template <class T>
+T Channel<T>::pullImpl(std::atomic_int& signal, ICoroSync::Ptr sync, bool& isClosed)
+{
+    T value;
+    isClosed = false;
+    while (!tryPullImpl(value))
+    {
+        if (_isClosed.load(std::memory_order_acquire))
+        {
+            if (tryPullImpl(value))
+            {
+                break; //drain what was pushed before closing
+            }
+            isClosed = true;
+            return value;
+        }
+        {
+            //========================= LOCKED SCOPE =========================
+            SpinLock::Guard lock(_spinlock);
+            signal = 0; //clear signal flag
+            _pullWaiters.emplace_back(&signal, sync);
+            _numPullWaiters.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (canPull() || _isClosed.load(std::memory_order_acquire))
+            {
+                //a producer pushed before it could see us
+                _pullWaiters.pop_back();
+                _numPullWaiters.fetch_sub(1, std::memory_order_relaxed);
+                signal = -1;
+                continue;
+            }
+        }
+        wait(signal, sync);
+    }
+    notifyOne(_pushWaiters, _numPushWaiters);
+    return value;
+}
+
+template <class T>
+template <class V>
+bool Channel<T>::tryPushImpl(V&& value)
+{
+    size_t pos = _tail.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true)
+    {
+        cell = &_cells[pos & _mask];
+        size_t sequence = cell->_sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0)
+        {
+            if (_mode == Mode::Spsc)
+            {
+                _tail.store(pos + 1, std::memory_order_relaxed);
+                break;
+            }
+            if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false; //full
+        }
+        else
+        {
+            pos = _tail.load(std::memory_order_relaxed); //another producer claimed this cell
+        }
+    }
+    cell->_value = std::forward<V>(value);
+    cell->_sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+template <class T>
+bool Channel<T>::tryPullImpl(T& value)
+{
+    size_t pos = _head.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true)
+    {
+        cell = &_cells[pos & _mask];
+        size_t sequence = cell->_sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+        if (diff == 0)
+        {
+            if (_mode == Mode::Spsc)
+            {
+                _head.store(pos + 1, std::memory_order_relaxed);
+                break;
+            }
+            if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false; //empty
+        }
+        else
+        {
+            pos = _head.load(std::memory_order_relaxed); //another consumer claimed this cell
+        }
+    }
+    value = std::move(cell->_value);
+    cell->_sequence.store(pos + _mask + 1, std::memory_order_release);
+    return true;
+}
+
+template <class T>
+bool Channel<T>::canPush() const
+{
+    size_t pos = _tail.load(std::memory_order_relaxed);
+    return (intptr_t)_cells[pos & _mask]._sequence.load(std::memory_order_acquire) - (intptr_t)pos >= 0;
+}
+
+template <class T>
+bool Channel<T>::canPull() const
+{
+    size_t pos = _head.load(std::memory_order_relaxed);
+    return (intptr_t)_cells[pos & _mask]._sequence.load(std::memory_order_acquire) - (intptr_t)(pos + 1) >= 0;
+}
+
+template <class T>
+void Channel<T>::notifyOne(std::list<Waiter>& waiters, std::atomic_int& numWaiters)
+{
+    //pairs with the fence taken by a waiter before re-checking the ring
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (numWaiters.load(std::memory_order_relaxed) == 0)
+    {
+        return; //fast path
+    }
+    Waiter waiter;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        if (waiters.empty())
+        {
+            return;
+        }
+        waiter = std::move(waiters.front());
+        waiters.pop_front();
+        numWaiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+    notify(waiter);
+}
+
+template <class T>
+void Channel<T>::notifyAll(std::list<Waiter>& waiters, std::atomic_int& numWaiters)
+{
+    std::list<Waiter> all;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        all.swap(waiters);
+        numWaiters.store(0, std::memory_order_relaxed);
+    }
+    for (auto&& waiter : all)
+    {
+        notify(waiter);
+    }
+}
+
+template <class T>
+void Channel<T>::notify(Waiter& waiter)
+{
+    (*waiter.first) = 1;
+    if (waiter.second)
+    {
+        waiter.second->wakeUp();
+    }
+    else
+    {
+        Futex::wakeOne(*waiter.first);
+    }
+}
+
+template <class T>
+void Channel<T>::notifyCallbacks()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_numCallbacks.load(std::memory_order_relaxed) == 0)
+    {
+        return; //fast path
+    }
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    for (auto&& callback : _callbacks)
+    {
+        callback.first->onReady(callback.second);
+    }
+}
+
+template <class T>
+void Channel<T>::wait(std::atomic_int& signal, const ICoroSync::Ptr& sync)
+{
+    while (signal == 0)
+    {
+        if (sync)
+        {
+            sync->getYieldHandle()(); //parked by the queue until signalled
+        }
+        else
+        {
+            Futex::wait(signal, 0);
+        }
+    }
+    signal = -1; //reset signal flag
+}
+
+}}
@@ -0,0 +1,61 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      struct Clock
+//==============================================================================================
+inline
+Clock::TimePoint Clock::now()
+{
+    const TimePoint* time = virtualTime();
+    return time ? *time : std::chrono::steady_clock::now();
+}
+
+inline
+bool Clock::isVirtual()
+{
+    return virtualTime() != nullptr;
+}
+
+inline
+const Clock::TimePoint*& Clock::virtualTime()
+{
+    thread_local const TimePoint* time = nullptr;
+    return time;
+}
+
+inline
+Clock::Guard::Guard(const TimePoint& time) :
+    _previous(virtualTime())
+{
+    virtualTime() = &time;
+}
+
+inline
+Clock::Guard::~Guard()
+{
+    virtualTime() = _previous;
+}
+
+}}
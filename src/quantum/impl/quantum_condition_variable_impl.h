@@ -34,6 +34,26 @@ ConditionVariable::~ConditionVariable()
 {
     Mutex::Guard lock(_thisLock);
     _destroyed = true;
+    //Release all waiters so that parked coroutines get a chance to exit
+    for (auto&& waiter : _waiters)
+    {
+        notify(waiter);
+    }
+    _waiters.clear();
+}
+
+inline
+void ConditionVariable::notify(Waiter& waiter)
+{
+    (*waiter.first) = 1;
+    if (waiter.second)
+    {
+        waiter.second->wakeUp(); //reschedule the parked coroutine
+    }
+    else
+    {
+        Futex::wakeOne(*waiter.first);
+    }
 }
 
 inline
@@ -45,7 +65,7 @@ void ConditionVariable::notifyOne()
     {
         return;
     }
-    (*_waiters.front()) = 1;
+    notify(_waiters.front());
     _waiters.pop_front();
 }
 
@@ -56,7 +76,7 @@ void ConditionVariable::notifyAll()
     Mutex::Guard lock(_thisLock);
     for (auto&& waiter : _waiters)
     {
-        (*waiter) = 1;
+        notify(waiter);
     }
     _waiters.clear();
 }
@@ -64,20 +84,20 @@ void ConditionVariable::notifyAll()
 inline
 void ConditionVariable::wait(Mutex& mutex)
 {
-    waitImpl(YieldingThread(), mutex, s_threadSignal);
+    waitImpl(YieldingThread(), mutex, s_threadSignal, nullptr);
 }
 
 inline
 void ConditionVariable::wait(ICoroSync::Ptr sync, Mutex& mutex)
 {
-    waitImpl(sync->getYieldHandle(), mutex, sync->signal());
+    waitImpl(sync->getYieldHandle(), mutex, sync->signal(), sync);
 }
 
 template <class PREDICATE>
 void ConditionVariable::wait(Mutex& mutex,
                              PREDICATE predicate)
 {
-    waitImpl(YieldingThread(), mutex, predicate, s_threadSignal);
+    waitImpl(YieldingThread(), mutex, predicate, s_threadSignal, nullptr);
 }
 
 template <class PREDICATE>
@@ -85,14 +105,15 @@ void ConditionVariable::wait(ICoroSync::Ptr sync,
                              Mutex& mutex,
                              PREDICATE predicate)
 {
-    waitImpl(sync->getYieldHandle(), mutex, predicate, sync->signal());
+    waitImpl(sync->getYieldHandle(), mutex, predicate, sync->signal(), sync);
 }
 
 template <class REP, class PERIOD>
 bool ConditionVariable::waitFor(Mutex& mutex,
                                 const std::chrono::duration<REP, PERIOD>& time)
 {
-    return waitForImpl(YieldingThread(), mutex, time, s_threadSignal);
+    auto duration = time; //modified by the implementation
+    return waitForImpl(YieldingThread(), mutex, duration, s_threadSignal, nullptr);
 }
 
 template <class REP, class PERIOD>
@@ -100,7 +121,8 @@ bool ConditionVariable::waitFor(ICoroSync::Ptr sync,
                                 Mutex& mutex,
                                 const std::chrono::duration<REP, PERIOD>& time)
 {
-    return waitForImpl(sync->getYieldHandle(), mutex, time, sync->signal());
+    auto duration = time; //modified by the implementation
+    return waitForImpl(sync->getYieldHandle(), mutex, duration, sync->signal(), sync);
 }
 
 template <class REP, class PERIOD, class PREDICATE>
@@ -108,7 +130,7 @@ bool ConditionVariable::waitFor(Mutex& mutex,
                                 const std::chrono::duration<REP, PERIOD>& time,
                                 PREDICATE predicate)
 {
-    return waitForImpl(YieldingThread(), mutex, time, predicate, s_threadSignal);
+    return waitForImpl(YieldingThread(), mutex, time, predicate, s_threadSignal, nullptr);
 }
 
 template <class REP, class PERIOD, class PREDICATE>
@@ -117,13 +139,14 @@ bool ConditionVariable::waitFor(ICoroSync::Ptr sync,
                                 const std::chrono::duration<REP, PERIOD>& time,
                                 PREDICATE predicate)
 {
-    return waitForImpl(sync->getYieldHandle(), mutex, time, predicate, sync->signal());
+    return waitForImpl(sync->getYieldHandle(), mutex, time, predicate, sync->signal(), sync);
 }
 
 template <class YIELDING>
 void ConditionVariable::waitImpl(YIELDING&& yield,
                                  Mutex& mutex,
-                                 std::atomic_int& signal)
+                                 std::atomic_int& signal,
+                                 ICoroSync::Ptr sync)
 {
     {//========= LOCKED SCOPE =========
         Mutex::Guard lock(_thisLock);
@@ -132,13 +155,20 @@ void ConditionVariable::waitImpl(YIELDING&& yield,
             return; //don't release the mutex
         }
         signal = 0; //clear signal flag
-        _waiters.push_back(&signal);
+        _waiters.emplace_back(&signal, sync);
     }
     //========= UNLOCKED SCOPE =========
-    Mutex::ReverseGuard unlock(mutex);
+    Mutex::ReverseGuard unlock(sync, mutex); //relocks from the coroutine when called from one
     while ((signal == 0) && !_destroyed)
     {
-        yield();
+        if (sync)
+        {
+            yield(); //parked by the queue until signalled
+        }
+        else
+        {
+            Futex::wait(signal, 0);
+        }
     }
     signal = -1; //reset
 }
@@ -147,11 +177,12 @@ template <class YIELDING, class PREDICATE>
 void ConditionVariable::waitImpl(YIELDING&& yield,
                                  Mutex& mutex,
                                  PREDICATE predicate,
-                                 std::atomic_int& signal)
+                                 std::atomic_int& signal,
+                                 ICoroSync::Ptr sync)
 {
     while (!predicate() && !_destroyed)
     {
-        waitImpl(std::forward<YIELDING>(yield), mutex, signal);
+        waitImpl(std::forward<YIELDING>(yield), mutex, signal, sync);
     }
 }
 
@@ -159,7 +190,8 @@ template <class YIELDING, class REP, class PERIOD>
 bool ConditionVariable::waitForImpl(YIELDING&& yield,
                                     Mutex& mutex,
                                     std::chrono::duration<REP, PERIOD>& time,
-                                    std::atomic_int& signal)
+                                    std::atomic_int& signal,
+                                    ICoroSync::Ptr sync)
 {
     {//========= LOCKED SCOPE =========
         Mutex::Guard lock(_thisLock);
@@ -172,19 +204,31 @@ bool ConditionVariable::waitForImpl(YIELDING&& yield,
             return false; //timeout
         }
         signal = 0; //clear signal flag
-        _waiters.push_back(&signal);
+        _waiters.emplace_back(&signal, sync);
     }
     //========= UNLOCKED SCOPE =========
-    Mutex::ReverseGuard unlock(mutex);
-    auto start = std::chrono::high_resolution_clock::now();
+    Mutex::ReverseGuard unlock(sync, mutex); //relocks from the coroutine when called from one
+    auto start = Clock::now();
     auto elapsed = std::chrono::duration<REP, PERIOD>::zero();
     bool timeout = false;
+    if (sync)
+    {
+        //park the coroutine until signalled or until the time expires
+        sync->setWakeUpTime(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(time));
+    }
     
     //wait until signalled or times out
     while ((signal == 0) && !_destroyed)
     {
-        yield();
-        elapsed = std::chrono::duration_cast<std::chrono::duration<REP, PERIOD>>(std::chrono::high_resolution_clock::now() - start);
+        if (sync)
+        {
+            yield(); //parked by the queue until signalled or until the time expires
+        }
+        else
+        {
+            Futex::waitFor(signal, 0, std::chrono::duration_cast<std::chrono::nanoseconds>(time - elapsed));
+        }
+        elapsed = std::chrono::duration_cast<std::chrono::duration<REP, PERIOD>>(Clock::now() - start);
         if (elapsed >= time)
         {
             timeout = true;
@@ -192,6 +236,17 @@ bool ConditionVariable::waitForImpl(YIELDING&& yield,
         }
     }
     
+    if (sync)
+    {
+        sync->clearWakeUpTime();
+    }
+    if (timeout)
+    {
+        //========= LOCKED SCOPE =========
+        Mutex::Guard lock(_thisLock);
+        //remove this waiter unless it was notified in the meantime
+        _waiters.remove_if([&signal](const Waiter& waiter)->bool { return waiter.first == &signal; });
+    }
     signal = -1; //reset signal flag
     
     //adjust duration or set to zero if nothing remains
@@ -204,13 +259,14 @@ bool ConditionVariable::waitForImpl(YIELDING&& yield,
                                     Mutex& mutex,
                                     const std::chrono::duration<REP, PERIOD>& time,
                                     PREDICATE predicate,
-                                    std::atomic_int& signal)
+                                    std::atomic_int& signal,
+                                    ICoroSync::Ptr sync)
 {
     if (time > std::chrono::duration<REP, PERIOD>(0)) {
         auto duration = time;
         while (!predicate() && !_destroyed)
         {
-            if (!waitForImpl(std::forward<YIELDING>(yield), mutex, duration, signal))
+            if (!waitForImpl(std::forward<YIELDING>(yield), mutex, duration, signal, sync))
             {
                 //timeout
                 return predicate();
@@ -41,10 +41,46 @@ const std::string& Configuration::getJsonSchema()
                 "default": 5
                 
             },
+            "numManualCoroutineQueues": {
+                "type": "number",
+                "default": 0
+            },
+            "lazyThreadStart": {
+                "type": "boolean",
+                "default": false
+            },
+            "maxNumIoThreads": {
+                "type": "number",
+                "default": 0
+            },
+            "ioThreadGrowthBacklog": {
+                "type": "number",
+                "default": 16
+            },
+            "ioThreadIdleTimeoutMs": {
+                "type": "number",
+                "default": 5000
+            },
             "pinToCores": {
                 "type": "boolean",
                 "default": false
             },
+            "coroutineCpuSets": {
+                "type": "array",
+                "items": {
+                    "type": "array",
+                    "items": { "type": "number" }
+                },
+                "default": []
+            },
+            "ioCpuSets": {
+                "type": "array",
+                "items": {
+                    "type": "array",
+                    "items": { "type": "number" }
+                },
+                "default": []
+            },
             "loadBalanceSharedIoQueues": {
                 "type": "boolean",
                 "default": false
@@ -64,6 +100,140 @@ const std::string& Configuration::getJsonSchema()
             "loadBalancePollIntervalNumBackoffs": {
                 "type": "number",
                 "default": 0
+            },
+            "coroutineWorkStealing": {
+                "type": "boolean",
+                "default": false
+            },
+            "coroutineWorkStealingPollIntervalMs": {
+                "type": "number",
+                "default": 10
+            },
+            "coroutineMigration": {
+                "type": "boolean",
+                "default": false
+            },
+            "idlePolicy": {
+                "type": "string",
+                "enum": [
+                    "park",
+                    "spin",
+                    "spinThenPark"
+                ],
+                "default": "park"
+            },
+            "idleSpinTimeUs": {
+                "type": "number",
+                "default": 100
+            },
+            "coroutineQueueSelectionPolicy": {
+                "type": "string",
+                "enum": [
+                    "shortest",
+                    "roundRobin",
+                    "powerOfTwo"
+                ],
+                "default": "shortest"
+            },
+            "priorityStarvationLimit": {
+                "type": "number",
+                "default": 16
+            },
+            "resumeSignalledCoroutinesFirst": {
+                "type": "boolean",
+                "default": true
+            },
+            "coroutineSliceStatistics": {
+                "type": "boolean",
+                "default": false
+            },
+            "latencyStatistics": {
+                "type": "boolean",
+                "default": false
+            },
+            "hardwareCounterStatistics": {
+                "type": "boolean",
+                "default": false
+            },
+            "longSliceThresholdUs": {
+                "type": "number",
+                "default": 0
+            },
+            "watchdogIntervalMs": {
+                "type": "number",
+                "default": 0
+            },
+            "queueStallThresholdMs": {
+                "type": "number",
+                "default": 1000
+            },
+            "blockedCoroutineThresholdMs": {
+                "type": "number",
+                "default": 0
+            },
+            "metricsExportIntervalMs": {
+                "type": "number",
+                "default": 0
+            },
+            "samplingProfilerIntervalUs": {
+                "type": "number",
+                "default": 0
+            },
+            "poolAllocSizes": {
+                "type": "object",
+                "properties": {
+                    "task": { "type": "number" },
+                    "ioTask": { "type": "number" },
+                    "context": { "type": "number" },
+                    "promise": { "type": "number" },
+                    "future": { "type": "number" },
+                    "queueList": { "type": "number" },
+                    "coroStack": { "type": "number" }
+                },
+                "additionalProperties": false,
+                "default": {}
+            },
+            "poolWarmup": {
+                "type": "boolean",
+                "default": false
+            },
+            "poolWarmupCpuSet": {
+                "type": "array",
+                "items": { "type": "number" },
+                "default": []
+            },
+            "terminatePolicy": {
+                "type": "string",
+                "enum": [
+                    "discard",
+                    "abandon"
+                ],
+                "default": "discard"
+            },
+            "queueHighWatermark": {
+                "type": "number",
+                "default": 0
+            },
+            "queueLowWatermark": {
+                "type": "number",
+                "default": 0
+            },
+            "globalHighWatermark": {
+                "type": "number",
+                "default": 0
+            },
+            "globalLowWatermark": {
+                "type": "number",
+                "default": 0
+            },
+            "admissionPolicy": {
+                "type": "string",
+                "enum": [
+                    "unbounded",
+                    "reject",
+                    "block"
+                ],
+                "default": "unbounded"
             }
         },
         "additionalProperties": false,
@@ -81,87 +251,1000 @@ const std::string& Configuration::getJsonSchemaUri()
 }
 
 inline
-void Configuration::setNumCoroutineThreads(int num)
+Configuration Configuration::fromJson(const std::string& json)
 {
-    _numCoroutineThreads = num;
+    JsonValue document = JsonValue::parse(json);
+    if (document.type() != JsonValue::Type::Object)
+    {
+        throw std::runtime_error("Invalid configuration: the JSON document must be an object");
+    }
+    Configuration config;
+    for (auto&& setting : document.asObject())
+    {
+        try
+        {
+            config.setFromJson(setting.first, setting.second);
+        }
+        catch (const std::runtime_error& ex)
+        {
+            throw std::runtime_error("Invalid configuration setting '" + setting.first + "': " + ex.what());
+        }
+    }
+    return config;
 }
 
 inline
-void Configuration::setNumIoThreads(int num)
+std::string Configuration::toJson() const
 {
-    _numIoThreads = num;
+    std::ostringstream out;
+    out << "{\n";
+    out << "    \"numCoroutineThreads\": ";
+    out << _numCoroutineThreads;
+    out << ",\n";
+    out << "    \"numIoThreads\": ";
+    out << _numIoThreads;
+    out << ",\n";
+    out << "    \"numManualCoroutineQueues\": ";
+    out << _numManualCoroutineQueues;
+    out << ",\n";
+    out << "    \"lazyThreadStart\": ";
+    out << (_lazyThreadStart ? "true" : "false");
+    out << ",\n";
+    out << "    \"maxNumIoThreads\": ";
+    out << _maxNumIoThreads;
+    out << ",\n";
+    out << "    \"ioThreadGrowthBacklog\": ";
+    out << _ioThreadGrowthBacklog;
+    out << ",\n";
+    out << "    \"ioThreadIdleTimeoutMs\": ";
+    out << _ioThreadIdleTimeoutMs.count();
+    out << ",\n";
+    out << "    \"pinToCores\": ";
+    out << (_pinCoroutineThreadsToCores ? "true" : "false");
+    out << ",\n";
+    out << "    \"coroutineCpuSets\": ";
+    out << "[";
+    for (size_t i = 0; i < _coroutineCpuSets.size(); ++i)
+    {
+        out << (i ? ", " : "");
+        writeCpuSet(out, _coroutineCpuSets[i]);
+    }
+    out << "]";
+    out << ",\n";
+    out << "    \"ioCpuSets\": ";
+    out << "[";
+    for (size_t i = 0; i < _ioCpuSets.size(); ++i)
+    {
+        out << (i ? ", " : "");
+        writeCpuSet(out, _ioCpuSets[i]);
+    }
+    out << "]";
+    out << ",\n";
+    out << "    \"loadBalanceSharedIoQueues\": ";
+    out << (_loadBalanceSharedIoQueues ? "true" : "false");
+    out << ",\n";
+    out << "    \"loadBalancePollIntervalMs\": ";
+    out << _loadBalancePollIntervalMs.count();
+    out << ",\n";
+    out << "    \"loadBalancePollIntervalBackoffPolicy\": ";
+    out << JsonValue::quote(enumNames(_loadBalancePollIntervalBackoffPolicy)[(int)_loadBalancePollIntervalBackoffPolicy]);
+    out << ",\n";
+    out << "    \"loadBalancePollIntervalNumBackoffs\": ";
+    out << _loadBalancePollIntervalNumBackoffs;
+    out << ",\n";
+    out << "    \"coroutineWorkStealing\": ";
+    out << (_coroutineWorkStealing ? "true" : "false");
+    out << ",\n";
+    out << "    \"coroutineWorkStealingPollIntervalMs\": ";
+    out << _coroutineWorkStealingPollIntervalMs.count();
+    out << ",\n";
+    out << "    \"coroutineMigration\": ";
+    out << (_coroutineMigration ? "true" : "false");
+    out << ",\n";
+    out << "    \"idlePolicy\": ";
+    out << JsonValue::quote(enumNames(_idlePolicy)[(int)_idlePolicy]);
+    out << ",\n";
+    out << "    \"idleSpinTimeUs\": ";
+    out << _idleSpinTimeUs.count();
+    out << ",\n";
+    out << "    \"coroutineQueueSelectionPolicy\": ";
+    out << JsonValue::quote(enumNames(_coroutineQueueSelectionPolicy)[(int)_coroutineQueueSelectionPolicy]);
+    out << ",\n";
+    out << "    \"priorityStarvationLimit\": ";
+    out << _priorityStarvationLimit;
+    out << ",\n";
+    out << "    \"resumeSignalledCoroutinesFirst\": ";
+    out << (_resumeSignalledCoroutinesFirst ? "true" : "false");
+    out << ",\n";
+    out << "    \"coroutineSliceStatistics\": ";
+    out << (_coroutineSliceStatistics ? "true" : "false");
+    out << ",\n";
+    out << "    \"latencyStatistics\": ";
+    out << (_latencyStatistics ? "true" : "false");
+    out << ",\n";
+    out << "    \"hardwareCounterStatistics\": ";
+    out << (_hardwareCounterStatistics ? "true" : "false");
+    out << ",\n";
+    out << "    \"longSliceThresholdUs\": ";
+    out << _longSliceThresholdUs.count();
+    out << ",\n";
+    out << "    \"watchdogIntervalMs\": ";
+    out << _watchdogIntervalMs.count();
+    out << ",\n";
+    out << "    \"queueStallThresholdMs\": ";
+    out << _queueStallThresholdMs.count();
+    out << ",\n";
+    out << "    \"blockedCoroutineThresholdMs\": ";
+    out << _blockedCoroutineThresholdMs.count();
+    out << ",\n";
+    out << "    \"metricsExportIntervalMs\": ";
+    out << _metricsExportIntervalMs.count();
+    out << ",\n";
+    out << "    \"samplingProfilerIntervalUs\": ";
+    out << _samplingProfilerIntervalUs.count();
+    out << ",\n";
+    out << "    \"poolAllocSizes\": ";
+    out << "{";
+    for (int i = 0; i < (int)PoolType::Max; ++i)
+    {
+        out << (i ? ", " : "") << JsonValue::quote(poolNames()[i]) << ": " << _poolAllocSizes[i];
+    }
+    out << "}";
+    out << ",\n";
+    out << "    \"poolWarmup\": ";
+    out << (_poolWarmup ? "true" : "false");
+    out << ",\n";
+    out << "    \"poolWarmupCpuSet\": ";
+    writeCpuSet(out, _poolWarmupCpuSet);
+    out << ",\n";
+    out << "    \"terminatePolicy\": ";
+    out << JsonValue::quote(enumNames(_terminatePolicy)[(int)_terminatePolicy]);
+    out << ",\n";
+    out << "    \"queueHighWatermark\": ";
+    out << _queueHighWatermark;
+    out << ",\n";
+    out << "    \"queueLowWatermark\": ";
+    out << _queueLowWatermark;
+    out << ",\n";
+    out << "    \"globalHighWatermark\": ";
+    out << _globalHighWatermark;
+    out << ",\n";
+    out << "    \"globalLowWatermark\": ";
+    out << _globalLowWatermark;
+    out << ",\n";
+    out << "    \"admissionPolicy\": ";
+    out << JsonValue::quote(enumNames(_admissionPolicy)[(int)_admissionPolicy]);
+    out << "\n";
+    out << "}\n";
+    return out.str();
 }
 
 inline
-void Configuration::setPinCoroutineThreadsToCores(bool value)
+void Configuration::setFromJson(const std::string& key, const JsonValue& value)
 {
-    _pinCoroutineThreadsToCores = value;
+    if (key == "numCoroutineThreads")
+    {
+        setNumCoroutineThreads(intFromJson(value));
+    }
+    else if (key == "numIoThreads")
+    {
+        setNumIoThreads(intFromJson(value));
+    }
+    else if (key == "numManualCoroutineQueues")
+    {
+        setNumManualCoroutineQueues(intFromJson(value));
+    }
+    else if (key == "lazyThreadStart")
+    {
+        setLazyThreadStart(value.asBool());
+    }
+    else if (key == "maxNumIoThreads")
+    {
+        setMaxNumIoThreads(intFromJson(value));
+    }
+    else if (key == "ioThreadGrowthBacklog")
+    {
+        setIoThreadGrowthBacklog(sizeFromJson(value));
+    }
+    else if (key == "ioThreadIdleTimeoutMs")
+    {
+        setIoThreadIdleTimeoutMs(std::chrono::milliseconds(sizeFromJson(value)));
+    }
+    else if (key == "pinToCores")
+    {
+        setPinCoroutineThreadsToCores(value.asBool());
+    }
+    else if (key == "coroutineCpuSets")
+    {
+        std::vector<CpuSet> cpuSets;
+        for (auto&& cpuSet : value.asArray())
+        {
+            cpuSets.push_back(cpuSetFromJson(cpuSet));
+        }
+        setCoroutineCpuSets(std::move(cpuSets));
+    }
+    else if (key == "ioCpuSets")
+    {
+        std::vector<CpuSet> cpuSets;
+        for (auto&& cpuSet : value.asArray())
+        {
+            cpuSets.push_back(cpuSetFromJson(cpuSet));
+        }
+        setIoCpuSets(std::move(cpuSets));
+    }
+    else if (key == "loadBalanceSharedIoQueues")
+    {
+        setLoadBalanceSharedIoQueues(value.asBool());
+    }
+    else if (key == "loadBalancePollIntervalMs")
+    {
+        setLoadBalancePollIntervalMs(std::chrono::milliseconds(sizeFromJson(value)));
+    }
+    else if (key == "loadBalancePollIntervalBackoffPolicy")
+    {
+        setLoadBalancePollIntervalBackoffPolicy(enumFromJson<BackoffPolicy>(value));
+    }
+    else if (key == "loadBalancePollIntervalNumBackoffs")
+    {
+        setLoadBalancePollIntervalNumBackoffs(sizeFromJson(value));
+    }
+    else if (key == "coroutineWorkStealing")
+    {
+        setCoroutineWorkStealing(value.asBool());
+    }
+    else if (key == "coroutineWorkStealingPollIntervalMs")
+    {
+        setCoroutineWorkStealingPollIntervalMs(std::chrono::milliseconds(sizeFromJson(value)));
+    }
+    else if (key == "coroutineMigration")
+    {
+        setCoroutineMigration(value.asBool());
+    }
+    else if (key == "idlePolicy")
+    {
+        setIdlePolicy(enumFromJson<IdlePolicy>(value));
+    }
+    else if (key == "idleSpinTimeUs")
+    {
+        setIdleSpinTimeUs(std::chrono::microseconds(sizeFromJson(value)));
+    }
+    else if (key == "coroutineQueueSelectionPolicy")
+    {
+        setCoroutineQueueSelectionPolicy(enumFromJson<QueueSelectionPolicy>(value));
+    }
+    else if (key == "priorityStarvationLimit")
+    {
+        setPriorityStarvationLimit(sizeFromJson(value));
+    }
+    else if (key == "resumeSignalledCoroutinesFirst")
+    {
+        setResumeSignalledCoroutinesFirst(value.asBool());
+    }
+    else if (key == "coroutineSliceStatistics")
+    {
+        setCoroutineSliceStatistics(value.asBool());
+    }
+    else if (key == "latencyStatistics")
+    {
+        setLatencyStatistics(value.asBool());
+    }
+    else if (key == "hardwareCounterStatistics")
+    {
+        setHardwareCounterStatistics(value.asBool());
+    }
+    else if (key == "longSliceThresholdUs")
+    {
+        setLongSliceThresholdUs(std::chrono::microseconds(sizeFromJson(value)));
+    }
+    else if (key == "watchdogIntervalMs")
+    {
+        setWatchdogIntervalMs(std::chrono::milliseconds(sizeFromJson(value)));
+    }
+    else if (key == "queueStallThresholdMs")
+    {
+        setQueueStallThresholdMs(std::chrono::milliseconds(sizeFromJson(value)));
+    }
+    else if (key == "blockedCoroutineThresholdMs")
+    {
+        setBlockedCoroutineThresholdMs(std::chrono::milliseconds(sizeFromJson(value)));
+    }
+    else if (key == "metricsExportIntervalMs")
+    {
+        setMetricsExportIntervalMs(std::chrono::milliseconds(sizeFromJson(value)));
+    }
+    else if (key == "samplingProfilerIntervalUs")
+    {
+        setSamplingProfilerIntervalUs(std::chrono::microseconds(sizeFromJson(value)));
+    }
+    else if (key == "poolAllocSizes")
+    {
+        for (auto&& pool : value.asObject())
+        {
+            int i = 0;
+            while ((i < (int)PoolType::Max) && (pool.first != poolNames()[i]))
+            {
+                ++i;
+            }
+            if (i == (int)PoolType::Max)
+            {
+                throw std::runtime_error("unknown pool '" + pool.first + "'");
+            }
+            setPoolAllocSize((PoolType)i, sizeFromJson(pool.second));
+        }
+    }
+    else if (key == "poolWarmup")
+    {
+        setPoolWarmup(value.asBool());
+    }
+    else if (key == "poolWarmupCpuSet")
+    {
+        setPoolWarmupCpuSet(cpuSetFromJson(value));
+    }
+    else if (key == "terminatePolicy")
+    {
+        setTerminatePolicy(enumFromJson<TerminatePolicy>(value));
+    }
+    else if (key == "queueHighWatermark")
+    {
+        setQueueHighWatermark(sizeFromJson(value));
+    }
+    else if (key == "queueLowWatermark")
+    {
+        setQueueLowWatermark(sizeFromJson(value));
+    }
+    else if (key == "globalHighWatermark")
+    {
+        setGlobalHighWatermark(sizeFromJson(value));
+    }
+    else if (key == "globalLowWatermark")
+    {
+        setGlobalLowWatermark(sizeFromJson(value));
+    }
+    else if (key == "admissionPolicy")
+    {
+        setAdmissionPolicy(enumFromJson<AdmissionPolicy>(value));
+    }
+    else
+    {
+        throw std::runtime_error("unknown setting");
+    }
 }
 
 inline
-void Configuration::setLoadBalanceSharedIoQueues(bool value)
+int Configuration::intFromJson(const JsonValue& value)
 {
-    _loadBalanceSharedIoQueues = value;
+    int64_t number = value.asInteger();
+    if ((number < std::numeric_limits<int>::min()) || (number > std::numeric_limits<int>::max()))
+    {
+        throw std::runtime_error("value out of range");
+    }
+    return (int)number;
 }
 
 inline
-void Configuration::setLoadBalancePollIntervalMs(std::chrono::milliseconds interval)
+size_t Configuration::sizeFromJson(const JsonValue& value)
 {
-    _loadBalancePollIntervalMs = interval;
+    int64_t number = value.asInteger();
+    if (number < 0)
+    {
+        throw std::runtime_error("value must not be negative");
+    }
+    return (size_t)number;
 }
 
 inline
-void Configuration::setLoadBalancePollIntervalBackoffPolicy(BackoffPolicy policy)
+Configuration::CpuSet Configuration::cpuSetFromJson(const JsonValue& value)
 {
-    _loadBalancePollIntervalBackoffPolicy = policy;
+    CpuSet cpuSet;
+    for (auto&& cpu : value.asArray())
+    {
+        cpuSet.push_back(intFromJson(cpu));
+    }
+    return cpuSet;
 }
 
 inline
-void Configuration::setLoadBalancePollIntervalNumBackoffs(size_t numBackoffs)
+void Configuration::writeCpuSet(std::ostream& out, const CpuSet& cpuSet)
 {
-    _loadBalancePollIntervalNumBackoffs = numBackoffs;
+    out << "[";
+    for (size_t i = 0; i < cpuSet.size(); ++i)
+    {
+        out << (i ? ", " : "") << cpuSet[i];
+    }
+    out << "]";
+}
+
+template <class ENUM>
+ENUM Configuration::enumFromJson(const JsonValue& value)
+{
+    const std::vector<const char*>& names = enumNames(ENUM{});
+    std::string allowed;
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        if (value.asString() == names[i])
+        {
+            return (ENUM)i;
+        }
+        allowed += (i ? ", " : "") + JsonValue::quote(names[i]);
+    }
+    throw std::runtime_error("expected one of " + allowed);
 }
 
+//Names in the order of the enum values, as in the JSON schema
 inline
-int Configuration::getNumCoroutineThreads() const
+const std::vector<const char*>& Configuration::enumNames(BackoffPolicy)
 {
-    return _numCoroutineThreads;
+    static std::vector<const char*> names{"linear", "exponential"};
+    return names;
 }
 
 inline
-int Configuration::getNumIoThreads() const
+const std::vector<const char*>& Configuration::enumNames(IdlePolicy)
 {
-    return _numIoThreads;
+    static std::vector<const char*> names{"park", "spin", "spinThenPark"};
+    return names;
 }
 
 inline
-bool Configuration::getPinCoroutineThreadsToCores() const
+const std::vector<const char*>& Configuration::enumNames(QueueSelectionPolicy)
 {
-    return _pinCoroutineThreadsToCores;
+    static std::vector<const char*> names{"shortest", "roundRobin", "powerOfTwo"};
+    return names;
 }
 
 inline
-bool Configuration::getLoadBalanceSharedIoQueues() const
+const std::vector<const char*>& Configuration::enumNames(TerminatePolicy)
 {
-    return _loadBalanceSharedIoQueues;
+    static std::vector<const char*> names{"discard", "abandon"};
+    return names;
 }
 
 inline
-std::chrono::milliseconds Configuration::getLoadBalancePollIntervalMs() const
+const std::vector<const char*>& Configuration::enumNames(AdmissionPolicy)
 {
-    return _loadBalancePollIntervalMs;
+    static std::vector<const char*> names{"unbounded", "reject", "block"};
+    return names;
 }
 
 inline
-Configuration::BackoffPolicy Configuration::getLoadBalancePollIntervalBackoffPolicy() const
+const std::vector<const char*>& Configuration::poolNames()
 {
-    return _loadBalancePollIntervalBackoffPolicy;
+    static std::vector<const char*> names{"task", "ioTask", "context", "promise", "future", "queueList", "coroStack"};
+    return names;
 }
 
 inline
-size_t Configuration::getLoadBalancePollIntervalNumBackoffs() const
+void Configuration::setNumCoroutineThreads(int num)
 {
-    return _loadBalancePollIntervalNumBackoffs;
+    _numCoroutineThreads = num;
+}
+
+inline
+void Configuration::setNumIoThreads(int num)
+{
+    _numIoThreads = num;
+}
+
+inline
+void Configuration::setNumManualCoroutineQueues(int num)
+{
+    _numManualCoroutineQueues = num;
+}
+
+inline
+void Configuration::setLazyThreadStart(bool value)
+{
+    _lazyThreadStart = value;
+}
+
+inline
+void Configuration::setMaxNumIoThreads(int num)
+{
+    _maxNumIoThreads = num;
+}
+
+inline
+void Configuration::setIoThreadGrowthBacklog(size_t numTasks)
+{
+    _ioThreadGrowthBacklog = numTasks;
+}
+
+inline
+void Configuration::setIoThreadIdleTimeoutMs(std::chrono::milliseconds timeout)
+{
+    _ioThreadIdleTimeoutMs = timeout;
+}
+
+inline
+void Configuration::setPinCoroutineThreadsToCores(bool value)
+{
+    _pinCoroutineThreadsToCores = value;
+}
+
+inline
+void Configuration::setCoroutineCpuSets(std::vector<CpuSet> cpuSets)
+{
+    _coroutineCpuSets = std::move(cpuSets);
+}
+
+inline
+void Configuration::setIoCpuSets(std::vector<CpuSet> cpuSets)
+{
+    _ioCpuSets = std::move(cpuSets);
+}
+
+inline
+void Configuration::setLoadBalanceSharedIoQueues(bool value)
+{
+    _loadBalanceSharedIoQueues = value;
+}
+
+inline
+void Configuration::setLoadBalancePollIntervalMs(std::chrono::milliseconds interval)
+{
+    _loadBalancePollIntervalMs = interval;
+}
+
+inline
+void Configuration::setLoadBalancePollIntervalBackoffPolicy(BackoffPolicy policy)
+{
+    _loadBalancePollIntervalBackoffPolicy = policy;
+}
+
+inline
+void Configuration::setLoadBalancePollIntervalNumBackoffs(size_t numBackoffs)
+{
+    _loadBalancePollIntervalNumBackoffs = numBackoffs;
+}
+
+inline
+void Configuration::setCoroutineWorkStealing(bool value)
+{
+    _coroutineWorkStealing = value;
+}
+
+inline
+void Configuration::setCoroutineWorkStealingPollIntervalMs(std::chrono::milliseconds interval)
+{
+    _coroutineWorkStealingPollIntervalMs = interval;
+}
+
+inline
+void Configuration::setCoroutineMigration(bool value)
+{
+    _coroutineMigration = value;
+}
+
+inline
+void Configuration::setIdlePolicy(IdlePolicy policy)
+{
+    _idlePolicy = policy;
+}
+
+inline
+void Configuration::setIdleSpinTimeUs(std::chrono::microseconds time)
+{
+    _idleSpinTimeUs = time;
+}
+
+inline
+void Configuration::setCoroutineQueueSelectionPolicy(QueueSelectionPolicy policy)
+{
+    _coroutineQueueSelectionPolicy = policy;
+}
+
+inline
+void Configuration::setPriorityStarvationLimit(size_t numSlices)
+{
+    _priorityStarvationLimit = numSlices;
+}
+
+inline
+void Configuration::setResumeSignalledCoroutinesFirst(bool value)
+{
+    _resumeSignalledCoroutinesFirst = value;
+}
+
+inline
+void Configuration::setCoroutineSliceStatistics(bool value)
+{
+    _coroutineSliceStatistics = value;
+}
+
+inline
+void Configuration::setLatencyStatistics(bool value)
+{
+    _latencyStatistics = value;
+}
+
+inline
+void Configuration::setHardwareCounterStatistics(bool value)
+{
+    _hardwareCounterStatistics = value;
+}
+
+inline
+void Configuration::setLongSliceThresholdUs(std::chrono::microseconds threshold)
+{
+    _longSliceThresholdUs = threshold;
+}
+
+inline
+void Configuration::setLongSliceCallback(LongSliceCallback callback)
+{
+    _longSliceCallback = std::move(callback);
+}
+
+inline
+void Configuration::setWatchdogIntervalMs(std::chrono::milliseconds interval)
+{
+    _watchdogIntervalMs = interval;
+}
+
+inline
+void Configuration::setQueueStallThresholdMs(std::chrono::milliseconds threshold)
+{
+    _queueStallThresholdMs = threshold;
+}
+
+inline
+void Configuration::setBlockedCoroutineThresholdMs(std::chrono::milliseconds threshold)
+{
+    _blockedCoroutineThresholdMs = threshold;
+}
+
+inline
+void Configuration::setStallCallback(StallCallback callback)
+{
+    _stallCallback = std::move(callback);
+}
+
+inline
+void Configuration::setMetricsExportIntervalMs(std::chrono::milliseconds interval)
+{
+    _metricsExportIntervalMs = interval;
+}
+
+inline
+void Configuration::setMetricsExporter(MetricsExporter exporter)
+{
+    _metricsExporter = std::move(exporter);
+}
+
+inline
+void Configuration::setSamplingProfilerIntervalUs(std::chrono::microseconds interval)
+{
+    _samplingProfilerIntervalUs = interval;
+}
+
+inline
+void Configuration::setPoolAllocSize(PoolType pool, size_t size)
+{
+    _poolAllocSizes.at((int)pool) = size;
+}
+
+inline
+void Configuration::setPoolWarmup(bool value)
+{
+    _poolWarmup = value;
+}
+
+inline
+void Configuration::setPoolWarmupCpuSet(CpuSet cpuSet)
+{
+    _poolWarmupCpuSet = std::move(cpuSet);
+}
+
+inline
+void Configuration::setTerminatePolicy(TerminatePolicy policy)
+{
+    _terminatePolicy = policy;
+}
+
+inline
+void Configuration::setDetachedErrorCallback(ErrorCallback callback)
+{
+    _detachedErrorCallback = std::move(callback);
+}
+
+inline
+void Configuration::setQueueHighWatermark(size_t num)
+{
+    _queueHighWatermark = num;
+}
+
+inline
+void Configuration::setQueueLowWatermark(size_t num)
+{
+    _queueLowWatermark = num;
+}
+
+inline
+void Configuration::setGlobalHighWatermark(size_t num)
+{
+    _globalHighWatermark = num;
+}
+
+inline
+void Configuration::setGlobalLowWatermark(size_t num)
+{
+    _globalLowWatermark = num;
+}
+
+inline
+void Configuration::setAdmissionPolicy(AdmissionPolicy policy)
+{
+    _admissionPolicy = policy;
+}
+
+inline
+int Configuration::getNumCoroutineThreads() const
+{
+    return _numCoroutineThreads;
+}
+
+inline
+int Configuration::getNumIoThreads() const
+{
+    return _numIoThreads;
+}
+
+inline
+int Configuration::getNumManualCoroutineQueues() const
+{
+    return _numManualCoroutineQueues;
+}
+
+inline
+bool Configuration::getLazyThreadStart() const
+{
+    return _lazyThreadStart;
+}
+
+inline
+int Configuration::getMaxNumIoThreads() const
+{
+    return _maxNumIoThreads;
+}
+
+inline
+size_t Configuration::getIoThreadGrowthBacklog() const
+{
+    return _ioThreadGrowthBacklog;
+}
+
+inline
+std::chrono::milliseconds Configuration::getIoThreadIdleTimeoutMs() const
+{
+    return _ioThreadIdleTimeoutMs;
+}
+
+inline
+bool Configuration::getPinCoroutineThreadsToCores() const
+{
+    return _pinCoroutineThreadsToCores;
+}
+
+inline
+const std::vector<Configuration::CpuSet>& Configuration::getCoroutineCpuSets() const
+{
+    return _coroutineCpuSets;
+}
+
+inline
+const std::vector<Configuration::CpuSet>& Configuration::getIoCpuSets() const
+{
+    return _ioCpuSets;
+}
+
+inline
+bool Configuration::getLoadBalanceSharedIoQueues() const
+{
+    return _loadBalanceSharedIoQueues;
+}
+
+inline
+std::chrono::milliseconds Configuration::getLoadBalancePollIntervalMs() const
+{
+    return _loadBalancePollIntervalMs;
+}
+
+inline
+Configuration::BackoffPolicy Configuration::getLoadBalancePollIntervalBackoffPolicy() const
+{
+    return _loadBalancePollIntervalBackoffPolicy;
+}
+
+inline
+size_t Configuration::getLoadBalancePollIntervalNumBackoffs() const
+{
+    return _loadBalancePollIntervalNumBackoffs;
+}
+
+inline
+bool Configuration::getCoroutineWorkStealing() const
+{
+    return _coroutineWorkStealing;
+}
+
+inline
+std::chrono::milliseconds Configuration::getCoroutineWorkStealingPollIntervalMs() const
+{
+    return _coroutineWorkStealingPollIntervalMs;
+}
+
+inline
+bool Configuration::getCoroutineMigration() const
+{
+    return _coroutineMigration;
+}
+
+inline
+Configuration::IdlePolicy Configuration::getIdlePolicy() const
+{
+    return _idlePolicy;
+}
+
+inline
+std::chrono::microseconds Configuration::getIdleSpinTimeUs() const
+{
+    return _idleSpinTimeUs;
+}
+
+inline
+Configuration::QueueSelectionPolicy Configuration::getCoroutineQueueSelectionPolicy() const
+{
+    return _coroutineQueueSelectionPolicy;
+}
+
+inline
+size_t Configuration::getPriorityStarvationLimit() const
+{
+    return _priorityStarvationLimit;
+}
+
+inline
+bool Configuration::getResumeSignalledCoroutinesFirst() const
+{
+    return _resumeSignalledCoroutinesFirst;
+}
+
+inline
+bool Configuration::getCoroutineSliceStatistics() const
+{
+    return _coroutineSliceStatistics;
+}
+
+inline
+bool Configuration::getLatencyStatistics() const
+{
+    return _latencyStatistics;
+}
+
+inline
+bool Configuration::getHardwareCounterStatistics() const
+{
+    return _hardwareCounterStatistics;
+}
+
+inline
+std::chrono::microseconds Configuration::getLongSliceThresholdUs() const
+{
+    return _longSliceThresholdUs;
+}
+
+inline
+const Configuration::LongSliceCallback& Configuration::getLongSliceCallback() const
+{
+    return _longSliceCallback;
+}
+
+inline
+std::chrono::milliseconds Configuration::getWatchdogIntervalMs() const
+{
+    return _watchdogIntervalMs;
+}
+
+inline
+std::chrono::milliseconds Configuration::getQueueStallThresholdMs() const
+{
+    return _queueStallThresholdMs;
+}
+
+inline
+std::chrono::milliseconds Configuration::getBlockedCoroutineThresholdMs() const
+{
+    return _blockedCoroutineThresholdMs;
+}
+
+inline
+const Configuration::StallCallback& Configuration::getStallCallback() const
+{
+    return _stallCallback;
+}
+
+inline
+bool Configuration::isWatchdogEnabled() const
+{
+    return (_watchdogIntervalMs.count() > 0) && _stallCallback;
+}
+
+inline
+std::chrono::milliseconds Configuration::getMetricsExportIntervalMs() const
+{
+    return _metricsExportIntervalMs;
+}
+
+inline
+const Configuration::MetricsExporter& Configuration::getMetricsExporter() const
+{
+    return _metricsExporter;
+}
+
+inline
+std::chrono::microseconds Configuration::getSamplingProfilerIntervalUs() const
+{
+    return _samplingProfilerIntervalUs;
+}
+
+inline
+size_t Configuration::getPoolAllocSize(PoolType pool) const
+{
+    return _poolAllocSizes.at((int)pool);
+}
+
+inline
+bool Configuration::getPoolWarmup() const
+{
+    return _poolWarmup;
+}
+
+inline
+const Configuration::CpuSet& Configuration::getPoolWarmupCpuSet() const
+{
+    return _poolWarmupCpuSet;
+}
+
+inline
+Configuration::TerminatePolicy Configuration::getTerminatePolicy() const
+{
+    return _terminatePolicy;
+}
+
+inline
+const Configuration::ErrorCallback& Configuration::getDetachedErrorCallback() const
+{
+    return _detachedErrorCallback;
+}
+
+inline
+size_t Configuration::getQueueHighWatermark() const
+{
+    return _queueHighWatermark;
+}
+
+inline
+size_t Configuration::getQueueLowWatermark() const
+{
+    return (_queueLowWatermark == 0) ? _queueHighWatermark / 2 : _queueLowWatermark;
+}
+
+inline
+size_t Configuration::getGlobalHighWatermark() const
+{
+    return _globalHighWatermark;
+}
+
+inline
+size_t Configuration::getGlobalLowWatermark() const
+{
+    return (_globalLowWatermark == 0) ? _globalHighWatermark / 2 : _globalLowWatermark;
+}
+
+inline
+Configuration::AdmissionPolicy Configuration::getAdmissionPolicy() const
+{
+    return _admissionPolicy;
 }
 
 }
@@ -47,6 +47,12 @@ const OTHER_RET& IThreadContext<RET>::getRefAt(int num) const
     return static_cast<const Impl*>(this)->template getRefAt<OTHER_RET>(num);
 }
 
+template <class RET>
+SharedFuture<RET> IThreadContext<RET>::getSharedFuture() const
+{
+    return static_cast<const Impl*>(this)->getSharedFuture();
+}
+
 template <class RET>
 template <class BUF, class V>
 void IThreadContext<RET>::push(V &&value)
@@ -61,6 +67,20 @@ V IThreadContext<RET>::pull(bool& isBufferClosed)
     return static_cast<Impl*>(this)->template pull<BUF>(isBufferClosed);
 }
 
+template <class RET>
+template <class BUF, class V>
+void IThreadContext<RET>::pushMany(std::vector<V> values)
+{
+    static_cast<Impl*>(this)->template pushMany<BUF>(std::move(values));
+}
+
+template <class RET>
+template <class BUF, class V>
+size_t IThreadContext<RET>::pullMany(std::vector<V>& values, size_t maxCount, bool& isBufferClosed)
+{
+    return static_cast<Impl*>(this)->template pullMany<BUF>(values, maxCount, isBufferClosed);
+}
+
 template <class RET>
 template <class BUF, class>
 int IThreadContext<RET>::closeBuffer()
@@ -88,6 +108,14 @@ IThreadContext<RET>::then(FUNC&& func, ARGS&&... args)
     return static_cast<Impl*>(this)->template then<OTHER_RET>(std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+ThreadContextPtr<OTHER_RET>
+IThreadContext<RET>::then(StackSizeClass stackSize, FUNC&& func, ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template then<OTHER_RET>(stackSize, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
 template <class RET>
 template <class OTHER_RET, class FUNC, class ... ARGS>
 ThreadContextPtr<OTHER_RET>
@@ -142,14 +170,20 @@ template <class RET>
 template <class OTHER_RET>
 OTHER_RET ICoroContext<RET>::getAt(int num, ICoroSync::Ptr sync)
 {
-    return static_cast<Impl*>(this)->template getAt<OTHER_RET>(num, sync);
+    return static_cast<Impl*>(this)->template getAt<OTHER_RET>(num, std::move(sync));
 }
 
 template <class RET>
 template <class OTHER_RET>
 const OTHER_RET& ICoroContext<RET>::getRefAt(int num, ICoroSync::Ptr sync) const
 {
-    return static_cast<const Impl*>(this)->template getRefAt<OTHER_RET>(num, sync);
+    return static_cast<const Impl*>(this)->template getRefAt<OTHER_RET>(num, std::move(sync));
+}
+
+template <class RET>
+SharedFuture<RET> ICoroContext<RET>::getSharedFuture() const
+{
+    return static_cast<const Impl*>(this)->getSharedFuture();
 }
 
 template <class RET>
@@ -167,6 +201,21 @@ V ICoroContext<RET>::pull(ICoroSync::Ptr sync, bool& isBufferClosed)
     return static_cast<Impl*>(this)->template pull<BUF>(sync, isBufferClosed);
 }
 
+template <class RET>
+template <class BUF, class V>
+void ICoroContext<RET>::pushMany(std::vector<V> values)
+{
+    std::shared_ptr<Impl> ctx = static_cast<Impl*>(this)->shared_from_this();
+    ctx->template pushMany<BUF>(ctx, std::move(values));
+}
+
+template <class RET>
+template <class BUF, class V>
+size_t ICoroContext<RET>::pullMany(ICoroSync::Ptr sync, std::vector<V>& values, size_t maxCount, bool& isBufferClosed)
+{
+    return static_cast<Impl*>(this)->template pullMany<BUF>(sync, values, maxCount, isBufferClosed);
+}
+
 template <class RET>
 template <class BUF, class>
 int ICoroContext<RET>::closeBuffer()
@@ -186,6 +235,50 @@ int ICoroContext<RET>::getNumIoThreads() const
     return static_cast<const Impl*>(this)->getNumIoThreads();
 }
 
+template <class RET>
+bool ICoroContext<RET>::isCancelled() const
+{
+    return static_cast<const Impl*>(this)->isCancelled();
+}
+
+template <class RET>
+template <class T>
+T* ICoroContext<RET>::getLocal(const CoroLocal<T>& slot) const
+{
+    return static_cast<const Impl*>(this)->getLocal(slot);
+}
+
+template <class RET>
+template <class T>
+void ICoroContext<RET>::setLocal(const CoroLocal<T>& slot, std::shared_ptr<T> value)
+{
+    static_cast<Impl*>(this)->setLocal(slot, std::move(value));
+}
+
+template <class RET>
+bool ICoroContext<RET>::awaitReadable(int fd, std::chrono::milliseconds timeMs)
+{
+    return static_cast<Impl*>(this)->awaitReadable(fd, timeMs);
+}
+
+template <class RET>
+bool ICoroContext<RET>::awaitWritable(int fd, std::chrono::milliseconds timeMs)
+{
+    return static_cast<Impl*>(this)->awaitWritable(fd, timeMs);
+}
+
+template <class RET>
+ssize_t ICoroContext<RET>::read(int fd, void* buffer, size_t size)
+{
+    return static_cast<Impl*>(this)->read(fd, buffer, size);
+}
+
+template <class RET>
+ssize_t ICoroContext<RET>::write(int fd, const void* buffer, size_t size)
+{
+    return static_cast<Impl*>(this)->write(fd, buffer, size);
+}
+
 template <class RET>
 template <class OTHER_RET, class FUNC, class ... ARGS>
 CoroContextPtr<OTHER_RET>
@@ -202,6 +295,22 @@ ICoroContext<RET>::post(int queueId, bool isHighPriority, FUNC&& func, ARGS&&...
     return static_cast<Impl*>(this)->template post<OTHER_RET>(queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::post(int queueId, IQueue::Priority priority, FUNC&& func, ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template post<OTHER_RET>(queueId, priority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::post(int queueId, IQueue::Priority priority, std::chrono::steady_clock::time_point deadline, FUNC&& func, ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template post<OTHER_RET>(queueId, priority, deadline, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
 template <class RET>
 template <class OTHER_RET, class FUNC, class ... ARGS>
 CoroContextPtr<OTHER_RET>
@@ -218,6 +327,38 @@ ICoroContext<RET>::postFirst(int queueId, bool isHighPriority, FUNC&& func, ARGS
     return static_cast<Impl*>(this)->template postFirst<OTHER_RET>(queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::postFirst(int queueId, IQueue::Priority priority, FUNC&& func, ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template postFirst<OTHER_RET>(queueId, priority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::postFirst(int queueId, IQueue::Priority priority, std::chrono::steady_clock::time_point deadline, FUNC&& func, ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template postFirst<OTHER_RET>(queueId, priority, deadline, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC_IT, class>
+std::vector<CoroContextPtr<OTHER_RET>>
+ICoroContext<RET>::postBatch(FUNC_IT first, FUNC_IT last)
+{
+    return static_cast<Impl*>(this)->template postBatch<OTHER_RET>(first, last);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC_IT, class>
+std::vector<CoroContextPtr<OTHER_RET>>
+ICoroContext<RET>::postBatch(int queueId, bool isHighPriority, FUNC_IT first, FUNC_IT last)
+{
+    return static_cast<Impl*>(this)->template postBatch<OTHER_RET>(queueId, isHighPriority, first, last);
+}
+
 template <class RET>
 template <class OTHER_RET, class FUNC, class ... ARGS>
 CoroContextPtr<OTHER_RET>
@@ -226,6 +367,14 @@ ICoroContext<RET>::then(FUNC&& func, ARGS&&... args)
     return static_cast<Impl*>(this)->template then<OTHER_RET>(std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::then(StackSizeClass stackSize, FUNC&& func, ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template then<OTHER_RET>(stackSize, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
 template <class RET>
 template <class OTHER_RET, class FUNC, class ... ARGS>
 CoroContextPtr<OTHER_RET>
@@ -265,6 +414,84 @@ ICoroContext<RET>::postAsyncIo(int queueId, bool isHighPriority, FUNC&& func, AR
     return static_cast<Impl*>(this)->template postAsyncIo<OTHER_RET>(queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroFuturePtr<OTHER_RET>
+ICoroContext<RET>::postAsyncIo(int queueId, bool isHighPriority, std::chrono::steady_clock::time_point deadline, FUNC&& func, ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template postAsyncIo<OTHER_RET>(queueId, isHighPriority, deadline, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC_IT, class>
+std::vector<CoroFuturePtr<OTHER_RET>>
+ICoroContext<RET>::postAsyncIoBatch(FUNC_IT first, FUNC_IT last)
+{
+    return static_cast<Impl*>(this)->template postAsyncIoBatch<OTHER_RET>(first, last);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC_IT, class>
+std::vector<CoroFuturePtr<OTHER_RET>>
+ICoroContext<RET>::postAsyncIoBatch(int queueId, bool isHighPriority, FUNC_IT first, FUNC_IT last)
+{
+    return static_cast<Impl*>(this)->template postAsyncIoBatch<OTHER_RET>(queueId, isHighPriority, first, last);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::postAfter(std::chrono::milliseconds delay, FUNC&& func, ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template postAfter<OTHER_RET>(delay, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::postAfter(std::chrono::milliseconds delay, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template postAfter<OTHER_RET>(delay, queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::postAt(std::chrono::steady_clock::time_point time, FUNC&& func, ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template postAt<OTHER_RET>(time, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::postAt(std::chrono::steady_clock::time_point time, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template postAt<OTHER_RET>(time, queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+size_t
+ICoroContext<RET>::postEvery(std::chrono::milliseconds period, FUNC&& func, ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template postEvery<OTHER_RET>(period, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+size_t
+ICoroContext<RET>::postEvery(std::chrono::milliseconds period, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
+{
+    return static_cast<Impl*>(this)->template postEvery<OTHER_RET>(period, queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+bool ICoroContext<RET>::cancelTimer(size_t timerId)
+{
+    return static_cast<Impl*>(this)->cancelTimer(timerId);
+}
+
 template <class RET>
 template <class OTHER_RET, class INPUT_IT, class>
 CoroContextPtr<std::vector<OTHER_RET>>
@@ -285,6 +512,50 @@ ICoroContext<RET>::forEach(INPUT_IT first,
     return static_cast<Impl*>(this)->template forEach<OTHER_RET>(first, num, std::move(func));
 }
 
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+CoroContextPtr<std::vector<OTHER_RET>>
+ICoroContext<RET>::forEach(INPUT_IT first,
+                           INPUT_IT last,
+                           Functions::ForEachFunc<OTHER_RET, INPUT_IT> func,
+                           GrainSize grain)
+{
+    return static_cast<Impl*>(this)->template forEach<OTHER_RET>(first, last, std::move(func), grain);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+CoroContextPtr<std::vector<OTHER_RET>>
+ICoroContext<RET>::forEach(INPUT_IT first,
+                           size_t num,
+                           Functions::ForEachFunc<OTHER_RET, INPUT_IT> func,
+                           GrainSize grain)
+{
+    return static_cast<Impl*>(this)->template forEach<OTHER_RET>(first, num, std::move(func), grain);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class OUTPUT_IT, class>
+CoroContextPtr<int>
+ICoroContext<RET>::forEach(INPUT_IT first,
+                           INPUT_IT last,
+                           OUTPUT_IT out,
+                           Functions::ForEachFunc<OTHER_RET, INPUT_IT> func)
+{
+    return static_cast<Impl*>(this)->template forEach<OTHER_RET>(first, last, out, std::move(func));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class OUTPUT_IT>
+CoroContextPtr<int>
+ICoroContext<RET>::forEach(INPUT_IT first,
+                           size_t num,
+                           OUTPUT_IT out,
+                           Functions::ForEachFunc<OTHER_RET, INPUT_IT> func)
+{
+    return static_cast<Impl*>(this)->template forEach<OTHER_RET>(first, num, out, std::move(func));
+}
+
 template <class RET>
 template <class OTHER_RET, class INPUT_IT, class>
 CoroContextPtr<std::vector<std::vector<OTHER_RET>>>
@@ -305,6 +576,91 @@ ICoroContext<RET>::forEachBatch(INPUT_IT first,
     return static_cast<Impl*>(this)->template forEachBatch<OTHER_RET>(first, num, std::move(func));
 }
 
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+CoroContextPtr<std::vector<std::vector<OTHER_RET>>>
+ICoroContext<RET>::forEachBatch(INPUT_IT first,
+                                INPUT_IT last,
+                                Functions::ForEachFunc<OTHER_RET, INPUT_IT> func,
+                                GrainSize grain)
+{
+    return static_cast<Impl*>(this)->template forEachBatch<OTHER_RET>(first, last, std::move(func), grain);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+CoroContextPtr<std::vector<std::vector<OTHER_RET>>>
+ICoroContext<RET>::forEachBatch(INPUT_IT first,
+                                size_t num,
+                                Functions::ForEachFunc<OTHER_RET, INPUT_IT> func,
+                                GrainSize grain)
+{
+    return static_cast<Impl*>(this)->template forEachBatch<OTHER_RET>(first, num, std::move(func), grain);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class FUNC, class, class>
+CoroContextPtr<std::vector<std::vector<OTHER_RET>>>
+ICoroContext<RET>::forEachBatch(INPUT_IT first,
+                                INPUT_IT last,
+                                FUNC&& func)
+{
+    return static_cast<Impl*>(this)->template forEachBatch<OTHER_RET>(first, last, std::forward<FUNC>(func));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class FUNC, class>
+CoroContextPtr<std::vector<std::vector<OTHER_RET>>>
+ICoroContext<RET>::forEachBatch(INPUT_IT first,
+                                size_t num,
+                                FUNC&& func)
+{
+    return static_cast<Impl*>(this)->template forEachBatch<OTHER_RET>(first, num, std::forward<FUNC>(func));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class FUNC, class, class>
+CoroContextPtr<std::vector<std::vector<OTHER_RET>>>
+ICoroContext<RET>::forEachBatch(INPUT_IT first,
+                                INPUT_IT last,
+                                FUNC&& func,
+                                GrainSize grain)
+{
+    return static_cast<Impl*>(this)->template forEachBatch<OTHER_RET>(first, last, std::forward<FUNC>(func), grain);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class FUNC, class>
+CoroContextPtr<std::vector<std::vector<OTHER_RET>>>
+ICoroContext<RET>::forEachBatch(INPUT_IT first,
+                                size_t num,
+                                FUNC&& func,
+                                GrainSize grain)
+{
+    return static_cast<Impl*>(this)->template forEachBatch<OTHER_RET>(first, num, std::forward<FUNC>(func), grain);
+}
+
+template <class RET>
+template <class INPUT_TYPE, class OUTPUT_TYPE, class KERNEL>
+CoroContextPtr<int>
+ICoroContext<RET>::forEachKernel(const INPUT_TYPE* first,
+                                 size_t num,
+                                 OUTPUT_TYPE* out,
+                                 KERNEL&& kernel)
+{
+    return static_cast<Impl*>(this)->forEachKernel(first, num, out, std::forward<KERNEL>(kernel));
+}
+
+template <class RET>
+template <class OUTPUT_TYPE, class INPUT_TYPE, class KERNEL>
+CoroContextPtr<std::vector<OUTPUT_TYPE>>
+ICoroContext<RET>::forEachKernel(const INPUT_TYPE* first,
+                                 size_t num,
+                                 KERNEL&& kernel)
+{
+    return static_cast<Impl*>(this)->template forEachKernel<OUTPUT_TYPE>(first, num, std::forward<KERNEL>(kernel));
+}
+
 template <class RET>
 template <class KEY,
           class MAPPED_TYPE,
@@ -367,41 +723,292 @@ ICoroContext<RET>::mapReduceBatch(INPUT_IT first,
         (first, num, std::move(mapper), std::move(reducer));
 }
 
-//==============================================================================================
-//                                     class Context
-//==============================================================================================
-#ifndef __QUANTUM_CONTEXT_ALLOC_SIZE
-    #define __QUANTUM_CONTEXT_ALLOC_SIZE __QUANTUM_DEFAULT_POOL_ALLOC_SIZE
-#endif
-#ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
-    #ifdef __QUANTUM_ALLOCATE_POOL_FROM_HEAP
-        using ContextAllocator = HeapAllocator<Context<int>>;
-    #else
-        using ContextAllocator = StackAllocator<Context<int>, __QUANTUM_CONTEXT_ALLOC_SIZE>;
-    #endif
-#else
-    using ContextAllocator = StlAllocator<Context<int>>;
-#endif
-
-template <class RET>
-Context<RET>::Context(DispatcherCore& dispatcher) :
-    _promises(1, PromisePtr<RET>(new Promise<RET>(), Promise<RET>::deleter)),
-    _dispatcher(&dispatcher),
-    _terminated(ATOMIC_FLAG_INIT),
-    _signal(-1),
-    _yield(nullptr)
-{}
-
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class INPUT_IT,
+          class MAPPER,
+          class REDUCER,
+          class,
+          class,
+          class>
+CoroContextPtr<std::map<KEY, REDUCED_TYPE>>
+ICoroContext<RET>::mapReduceBatch(INPUT_IT first,
+                                  INPUT_IT last,
+                                  MAPPER&& mapper,
+                                  REDUCER&& reducer)
+{
+    return static_cast<Impl*>(this)->template mapReduceBatch<KEY, MAPPED_TYPE, REDUCED_TYPE>
+        (first, last, std::forward<MAPPER>(mapper), std::forward<REDUCER>(reducer));
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class INPUT_IT,
+          class MAPPER,
+          class REDUCER,
+          class,
+          class>
+CoroContextPtr<std::map<KEY, REDUCED_TYPE>>
+ICoroContext<RET>::mapReduceBatch(INPUT_IT first,
+                                  size_t num,
+                                  MAPPER&& mapper,
+                                  REDUCER&& reducer)
+{
+    return static_cast<Impl*>(this)->template mapReduceBatch<KEY, MAPPED_TYPE, REDUCED_TYPE>
+        (first, num, std::forward<MAPPER>(mapper), std::forward<REDUCER>(reducer));
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class OUTPUT,
+          class INPUT_IT,
+          class>
+CoroContextPtr<OUTPUT>
+ICoroContext<RET>::mapReducePartitioned(INPUT_IT first,
+                                        INPUT_IT last,
+                                        Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+{
+    return static_cast<Impl*>(this)->template mapReducePartitioned<KEY, MAPPED_TYPE, REDUCED_TYPE, OUTPUT>
+        (first, last, std::move(mapper), std::move(reducer));
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class OUTPUT,
+          class INPUT_IT>
+CoroContextPtr<OUTPUT>
+ICoroContext<RET>::mapReducePartitioned(INPUT_IT first,
+                                        size_t num,
+                                        Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+{
+    return static_cast<Impl*>(this)->template mapReducePartitioned<KEY, MAPPED_TYPE, REDUCED_TYPE, OUTPUT>
+        (first, num, std::move(mapper), std::move(reducer));
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class OUTPUT,
+          class INPUT_IT,
+          class>
+CoroContextPtr<OUTPUT>
+ICoroContext<RET>::mapReducePartitioned(INPUT_IT first,
+                                        INPUT_IT last,
+                                        Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                        Functions::CombineFunc<MAPPED_TYPE> combiner,
+                                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+{
+    return static_cast<Impl*>(this)->template mapReducePartitioned<KEY, MAPPED_TYPE, REDUCED_TYPE, OUTPUT>
+        (first, last, std::move(mapper), std::move(combiner), std::move(reducer));
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class OUTPUT,
+          class INPUT_IT>
+CoroContextPtr<OUTPUT>
+ICoroContext<RET>::mapReducePartitioned(INPUT_IT first,
+                                        size_t num,
+                                        Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                        Functions::CombineFunc<MAPPED_TYPE> combiner,
+                                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+{
+    return static_cast<Impl*>(this)->template mapReducePartitioned<KEY, MAPPED_TYPE, REDUCED_TYPE, OUTPUT>
+        (first, num, std::move(mapper), std::move(combiner), std::move(reducer));
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class OUTPUT,
+          class INPUT>
+CoroContextPtr<Buffer<OUTPUT>>
+ICoroContext<RET>::mapReduceStream(std::shared_ptr<ICoroFuture<Buffer<INPUT>>> input,
+                                 Functions::StreamMapFunc<KEY, MAPPED_TYPE, INPUT> mapper,
+                                 Functions::FoldFunc<REDUCED_TYPE, MAPPED_TYPE> reducer,
+                                 size_t windowSize)
+{
+    return static_cast<Impl*>(this)->template mapReduceStream<KEY, MAPPED_TYPE, REDUCED_TYPE, OUTPUT>
+        (std::move(input), std::move(mapper), std::move(reducer), windowSize);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::reduce(INPUT_IT first,
+                          INPUT_IT last,
+                          OTHER_RET init,
+                          Functions::BinaryFunc<OTHER_RET> op)
+{
+    return static_cast<Impl*>(this)->template reduce<OTHER_RET>(first, last, std::move(init), std::move(op));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::reduce(INPUT_IT first,
+                          size_t num,
+                          OTHER_RET init,
+                          Functions::BinaryFunc<OTHER_RET> op)
+{
+    return static_cast<Impl*>(this)->template reduce<OTHER_RET>(first, num, std::move(init), std::move(op));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::transformReduce(INPUT_IT first,
+                                   INPUT_IT last,
+                                   OTHER_RET init,
+                                   Functions::BinaryFunc<OTHER_RET> reduceOp,
+                                   Functions::ForEachFunc<OTHER_RET, INPUT_IT> transform)
+{
+    return static_cast<Impl*>(this)->template transformReduce<OTHER_RET>(first, last, std::move(init), std::move(reduceOp), std::move(transform));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+CoroContextPtr<OTHER_RET>
+ICoroContext<RET>::transformReduce(INPUT_IT first,
+                                   size_t num,
+                                   OTHER_RET init,
+                                   Functions::BinaryFunc<OTHER_RET> reduceOp,
+                                   Functions::ForEachFunc<OTHER_RET, INPUT_IT> transform)
+{
+    return static_cast<Impl*>(this)->template transformReduce<OTHER_RET>(first, num, std::move(init), std::move(reduceOp), std::move(transform));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+CoroContextPtr<std::vector<OTHER_RET>>
+ICoroContext<RET>::inclusiveScan(INPUT_IT first,
+                                 INPUT_IT last,
+                                 Functions::BinaryFunc<OTHER_RET> op)
+{
+    return static_cast<Impl*>(this)->template inclusiveScan<OTHER_RET>(first, last, std::move(op));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+CoroContextPtr<std::vector<OTHER_RET>>
+ICoroContext<RET>::inclusiveScan(INPUT_IT first,
+                                 size_t num,
+                                 Functions::BinaryFunc<OTHER_RET> op)
+{
+    return static_cast<Impl*>(this)->template inclusiveScan<OTHER_RET>(first, num, std::move(op));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+CoroContextPtr<std::vector<OTHER_RET>>
+ICoroContext<RET>::exclusiveScan(INPUT_IT first,
+                                 INPUT_IT last,
+                                 OTHER_RET init,
+                                 Functions::BinaryFunc<OTHER_RET> op)
+{
+    return static_cast<Impl*>(this)->template exclusiveScan<OTHER_RET>(first, last, std::move(init), std::move(op));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+CoroContextPtr<std::vector<OTHER_RET>>
+ICoroContext<RET>::exclusiveScan(INPUT_IT first,
+                                 size_t num,
+                                 OTHER_RET init,
+                                 Functions::BinaryFunc<OTHER_RET> op)
+{
+    return static_cast<Impl*>(this)->template exclusiveScan<OTHER_RET>(first, num, std::move(init), std::move(op));
+}
+
+template <class RET>
+template <class RANDOM_IT, class COMPARE>
+CoroContextPtr<int>
+ICoroContext<RET>::sort(RANDOM_IT first,
+                        RANDOM_IT last,
+                        COMPARE compare)
+{
+    return static_cast<Impl*>(this)->template sort<RANDOM_IT, COMPARE>(first, last, std::move(compare));
+}
+
+template <class RET>
+template <class RANDOM_IT, class COMPARE>
+CoroContextPtr<int>
+ICoroContext<RET>::stableSort(RANDOM_IT first,
+                              RANDOM_IT last,
+                              COMPARE compare)
+{
+    return static_cast<Impl*>(this)->template stableSort<RANDOM_IT, COMPARE>(first, last, std::move(compare));
+}
+
+//==============================================================================================
+//                                     class Context
+//==============================================================================================
+#ifndef __QUANTUM_CONTEXT_ALLOC_SIZE
+    #define __QUANTUM_CONTEXT_ALLOC_SIZE __QUANTUM_DEFAULT_POOL_ALLOC_SIZE
+#endif
+#ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
+    #ifdef __QUANTUM_ALLOCATE_POOL_FROM_HEAP
+        using ContextAllocator = HeapAllocator<SharedBlock<Context<int>>>;
+    #else
+        using ContextAllocator = StackAllocator<SharedBlock<Context<int>>, __QUANTUM_CONTEXT_ALLOC_SIZE>;
+    #endif
+#else
+    using ContextAllocator = StlAllocator<SharedBlock<Context<int>>>;
+#endif
+
+template <class RET>
+Context<RET>::Context(DispatcherCore& dispatcher) :
+    _promise(Promise<RET>::create()),
+    _position(0),
+    _dispatcher(&dispatcher),
+    _terminated(ATOMIC_FLAG_INIT),
+    _signal(-1),
+    _yield(nullptr)
+{}
+
+template <class RET>
+Context<RET>::Context(DispatcherCore& dispatcher, bool isDetached) :
+    _promise(isDetached ? nullptr : Promise<RET>::create()),
+    _position(0),
+    _dispatcher(&dispatcher),
+    _terminated(ATOMIC_FLAG_INIT),
+    _signal(-1),
+    _yield(nullptr)
+{}
+
 template <class RET>
 template <class OTHER_RET>
 Context<RET>::Context(Context<OTHER_RET>& other) :
-    _promises(other._promises),
+    _promise(Promise<RET>::create()),
+    _chain(other._chain),
+    _position(other._position + 1),
     _dispatcher(other._dispatcher),
     _terminated(ATOMIC_FLAG_INIT),
     _signal(-1),
     _yield(nullptr)
 {
-    _promises.emplace_back(PromisePtr<RET>(new Promise<RET>(), Promise<RET>::deleter)); //append a new promise
+    if (!_chain)
+    {
+        //first continuation. All the stages of the chain will share this array.
+        _chain = std::make_shared<PromiseChain>(1, other._promise);
+        other._chain = _chain;
+    }
+    _chain->resize(_position); //drop any stage previously chained after 'other'
+    _chain->push_back(_promise);
 }
 
 template <class RET>
@@ -415,7 +1022,7 @@ void Context<RET>::terminate()
 {
     if (!_terminated.test_and_set())
     {
-        _promises.back()->terminate();
+        if (_promise) _promise->terminate();
         
         //unlink task ptr
         _task.reset();
@@ -425,7 +1032,7 @@ void Context<RET>::terminate()
 template <class RET>
 bool Context<RET>::validAt(int num) const
 {
-    return _promises[index(num)]->valid();
+    return promiseAt(num)->valid();
 }
 
 template <class RET>
@@ -437,7 +1044,13 @@ bool Context<RET>::valid() const
 template <class RET>
 int Context<RET>::setException(std::exception_ptr ex)
 {
-    return _promises.back()->setException(ex);
+    if (!_promise)
+    {
+        //detached coroutine. Nobody can read the exception.
+        _dispatcher->onDetachedError(ex);
+        return (int)ITask::RetCode::Exception;
+    }
+    return _promise->setException(ex);
 }
 
 template <class RET>
@@ -449,11 +1062,45 @@ bool Context<RET>::isBlocked()
 template <class RET>
 int Context<RET>::index(int num) const
 {
-    if ((num < -1) || (num >= (int)_promises.size()))
+    if ((num < -1) || (num > _position))
+    {
+        ThrowFutureException(FutureState::NoState);
+    }
+    return (num == -1) ? _position : num;
+}
+
+template <class RET>
+const IPromiseBase::Ptr& Context<RET>::promiseAt(int num) const
+{
+    int pos = index(num);
+    if ((pos == _position) && !_promise)
+    {
+        ThrowFutureException(FutureState::NoState); //detached
+    }
+    return (pos == _position) ? _promise : (*_chain)[pos];
+}
+
+template <class RET>
+Promise<RET>& Context<RET>::promise() const
+{
+    if (!_promise)
+    {
+        ThrowFutureException(FutureState::NoState); //detached
+    }
+    return static_cast<Promise<RET>&>(*_promise);
+}
+
+template <class RET>
+template <class OTHER_RET>
+SharedState<OTHER_RET>& Context<RET>::sharedStateAt(int num) const
+{
+    //access the state directly rather than allocating a new future on every read
+    const std::shared_ptr<SharedState<OTHER_RET>>& state = static_cast<Promise<OTHER_RET>*>(promiseAt(num).get())->_sharedState;
+    if (!state)
     {
         ThrowFutureException(FutureState::NoState);
     }
-    return (num == -1) ? _promises.size() - 1 : num;
+    return *state;
 }
 
 template <class RET>
@@ -503,7 +1150,7 @@ void Context<RET>::validateTaskType(ITask::Type type) const
 }
 
 template <class RET>
-void Context<RET>::validateContext(ICoroSync::Ptr sync) const
+void Context<RET>::validateContext(const ICoroSync::Ptr& sync) const
 {
     if (static_cast<const ICoroSync*>(this) == sync.get())
     {
@@ -542,44 +1189,107 @@ void Context<RET>::yield()
     getYieldHandle()();
 }
 
+template <class RET>
+void Context<RET>::admit(IQueue::QueueType type, int queueId, bool isHighPriority)
+{
+    //Blocking the thread would also stall the coroutines draining the target so yield to them instead
+    while (!_dispatcher->tryAdmit(type, queueId, isHighPriority))
+    {
+        yield();
+    }
+}
+
+template <class RET>
+void Context<RET>::yieldTo(ICoroSync::Ptr other)
+{
+    validateContext(other);
+    ITaskAccessor::Ptr accessor = std::dynamic_pointer_cast<ITaskAccessor>(other);
+    Task::Ptr target = accessor ? std::static_pointer_cast<Task>(accessor->getTask()) : nullptr;
+    Task::Ptr current = std::static_pointer_cast<Task>(_task);
+    if (target && current && (target->getQueueId() == current->getQueueId()))
+    {
+        _dispatcher->scheduleNext(target);
+    }
+    yield();
+}
+
 template <class RET>
 std::atomic_int& Context<RET>::signal()
 {
     return _signal;
 }
 
+template <class RET>
+void Context<RET>::wakeUp()
+{
+    Task::Ptr task = std::static_pointer_cast<Task>(_task);
+    if (task && task->tryUnpark())
+    {
+        _dispatcher->unpark(task);
+    }
+}
+
+template <class RET>
+void Context<RET>::setWakeUpTime(std::chrono::steady_clock::time_point time)
+{
+    Task::Ptr task = std::static_pointer_cast<Task>(_task);
+    if (task)
+    {
+        task->setWakeUpTime(time);
+    }
+}
+
+template <class RET>
+void Context<RET>::clearWakeUpTime()
+{
+    Task::Ptr task = std::static_pointer_cast<Task>(_task);
+    if (task)
+    {
+        task->clearWakeUpTime();
+    }
+}
+
 template <class RET>
 void Context<RET>::sleep(std::chrono::milliseconds timeMs)
 {
     if (timeMs > std::chrono::milliseconds(0)) {
-        auto start = std::chrono::high_resolution_clock::now();
-        //wait until signalled or times out
-        while (1)
+        auto deadline = Clock::now() + timeMs;
+        //block until the timer expires
+        _signal = 0;
+        setWakeUpTime(deadline);
+        while (Clock::now() < deadline)
         {
             yield();
-            auto elapsed = std::chrono::high_resolution_clock::now() - start;
-            if (std::chrono::duration_cast<std::chrono::milliseconds>(elapsed) >= timeMs)
-            {
-                break; //timeout expired
-            }
         }
+        clearWakeUpTime();
+        _signal = -1; //reset
     }
 }
 
 template <class RET>
 template <class OTHER_RET, class FUNC, class ... ARGS>
 ContextPtr<OTHER_RET>
-Context<RET>::thenImpl(ITask::Type type, FUNC&& func, ARGS&&... args)
-{
-    auto ctx = ContextPtr<OTHER_RET>(new Context<OTHER_RET>(*this),
-                                     Context<OTHER_RET>::deleter);
-    auto task = Task::Ptr(new Task(ctx,
-                                   _task->getQueueId(),      //keep current queueId
-                                   _task->isHighPriority(),  //keep current priority
-                                   type,
-                                   std::forward<FUNC>(func),
-                                   std::forward<ARGS>(args)...),
-                          Task::deleter);
+Context<RET>::thenImpl(ITask::Type type, StackSizeClass stackSize, FUNC&& func, ARGS&&... args)
+{
+    auto ctx = Context<OTHER_RET>::create(*this);
+    auto task = Task::create(ctx,
+                             _task->getQueueId(),      //keep current queueId
+                             _task->isHighPriority(),  //keep current priority
+                             type,
+                             stackSize,
+                             std::forward<FUNC>(func),
+                             std::forward<ARGS>(args)...);
+    //keep current scheduling attributes
+    Task::Ptr currentTask = std::static_pointer_cast<Task>(_task);
+    task->setPriority(currentTask->getPriority());
+    task->setDeadline(currentTask->getDeadline());
+    task->setCancellationToken(currentTask->getCancellationToken());
+    if (!currentTask->getLocalStorage())
+    {
+        //create it now so that values set by any coroutine in the chain are visible to the next ones
+        currentTask->setLocalStorage(std::make_shared<CoroLocalStorage>());
+    }
+    task->setLocalStorage(currentTask->getLocalStorage());
     ctx->setTask(task);
     
     //Chain tasks
@@ -593,245 +1303,895 @@ template <class OTHER_RET, class FUNC, class ... ARGS>
 ContextPtr<OTHER_RET>
 Context<RET>::then(FUNC&& func, ARGS&&... args)
 {
-    //Previous task must either be First or Continuation types
-    validateTaskType(ITask::Type::Continuation);
-    return thenImpl<OTHER_RET, FUNC, ARGS...>(ITask::Type::Continuation, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    //Previous task must either be First or Continuation types
+    validateTaskType(ITask::Type::Continuation);
+    return thenImpl<OTHER_RET, FUNC, ARGS...>(ITask::Type::Continuation, StackSizeClass::Default, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+ContextPtr<OTHER_RET>
+Context<RET>::then(StackSizeClass stackSize, FUNC&& func, ARGS&&... args)
+{
+    //Previous task must either be First or Continuation types
+    validateTaskType(ITask::Type::Continuation);
+    return thenImpl<OTHER_RET, FUNC, ARGS...>(ITask::Type::Continuation, stackSize, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+ContextPtr<OTHER_RET>
+Context<RET>::onError(FUNC&& func, ARGS&&... args)
+{
+    validateTaskType(ITask::Type::ErrorHandler);
+    return thenImpl<OTHER_RET, FUNC, ARGS...>(ITask::Type::ErrorHandler, StackSizeClass::Default, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+ContextPtr<OTHER_RET>
+Context<RET>::finally(FUNC&& func, ARGS&&... args)
+{
+    validateTaskType(ITask::Type::Final);
+    return thenImpl<OTHER_RET, FUNC, ARGS...>(ITask::Type::Final, StackSizeClass::Default, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+typename Context<RET>::Ptr
+Context<RET>::end()
+{
+    validateTaskType(ITask::Type::Termination);
+    //Async post to next available queue since the previous task in the chain already terminated
+    auto task = std::static_pointer_cast<Task>(std::static_pointer_cast<ITaskContinuation>(getTask())->getFirstTask());
+    _dispatcher->post(task);
+    return dynamic_cast<Context<RET>*>(this)->shared_from_this();
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroFuturePtr<OTHER_RET>
+Context<RET>::postAsyncIo(FUNC&& func, ARGS&&... args)
+{
+    return postAsyncIoImpl<OTHER_RET>((int)IQueue::QueueId::Any, false, std::chrono::steady_clock::time_point::max(),
+                                      std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroFuturePtr<OTHER_RET>
+Context<RET>::postAsyncIo(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
+{
+    return postAsyncIoImpl<OTHER_RET>(queueId, isHighPriority, std::chrono::steady_clock::time_point::max(),
+                                      std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroFuturePtr<OTHER_RET>
+Context<RET>::postAsyncIo(int queueId, bool isHighPriority, std::chrono::steady_clock::time_point deadline, FUNC&& func, ARGS&&... args)
+{
+    return postAsyncIoImpl<OTHER_RET>(queueId, isHighPriority, deadline, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC_IT, class>
+std::vector<CoroFuturePtr<OTHER_RET>>
+Context<RET>::postAsyncIoBatch(FUNC_IT first, FUNC_IT last)
+{
+    return postAsyncIoBatch<OTHER_RET>((int)IQueue::QueueId::Any, false, first, last);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC_IT, class>
+std::vector<CoroFuturePtr<OTHER_RET>>
+Context<RET>::postAsyncIoBatch(int queueId, bool isHighPriority, FUNC_IT first, FUNC_IT last)
+{
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid coroutine queue id");
+    }
+    std::vector<CoroFuturePtr<OTHER_RET>> futures;
+    std::vector<IoTask::Ptr> tasks;
+    for (; first != last; ++first)
+    {
+        auto promise = Promise<OTHER_RET>::create();
+        auto task = IoTask::create(promise,
+                                   queueId,
+                                   isHighPriority,
+                                   *first);
+        task->setCancellationToken(std::static_pointer_cast<Task>(_task)->getCancellationToken());
+        tasks.emplace_back(std::move(task));
+        futures.emplace_back(promise->getICoroFuture());
+    }
+    _dispatcher->postAsyncIoBatch(tasks);
+    return futures;
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+typename Context<OTHER_RET>::Ptr
+Context<RET>::postAfter(std::chrono::milliseconds delay, FUNC&& func, ARGS&&... args)
+{
+    return postAtImpl<OTHER_RET>(std::chrono::steady_clock::now() + delay, (int)IQueue::QueueId::Any, false,
+                                 std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+typename Context<OTHER_RET>::Ptr
+Context<RET>::postAfter(std::chrono::milliseconds delay, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
+{
+    return postAtImpl<OTHER_RET>(std::chrono::steady_clock::now() + delay, queueId, isHighPriority,
+                                 std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+typename Context<OTHER_RET>::Ptr
+Context<RET>::postAt(std::chrono::steady_clock::time_point time, FUNC&& func, ARGS&&... args)
+{
+    return postAtImpl<OTHER_RET>(time, (int)IQueue::QueueId::Any, false, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+typename Context<OTHER_RET>::Ptr
+Context<RET>::postAt(std::chrono::steady_clock::time_point time, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
+{
+    return postAtImpl<OTHER_RET>(time, queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+size_t
+Context<RET>::postEvery(std::chrono::milliseconds period, FUNC&& func, ARGS&&... args)
+{
+    return postEveryImpl<OTHER_RET>(period, (int)IQueue::QueueId::Any, false, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+size_t
+Context<RET>::postEvery(std::chrono::milliseconds period, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
+{
+    return postEveryImpl<OTHER_RET>(period, queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+bool Context<RET>::cancelTimer(size_t timerId)
+{
+    return _dispatcher->getTimerQueue().cancel(timerId);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+typename Context<OTHER_RET>::Ptr
+Context<RET>::postAtImpl(std::chrono::steady_clock::time_point time, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
+{
+    if (queueId < (int)IQueue::QueueId::Same)
+    {
+        throw std::runtime_error("Invalid coroutine queue id");
+    }
+    if (queueId == (int)IQueue::QueueId::Same)
+    {
+        queueId = _task->getQueueId();
+    }
+    auto ctx = Context<OTHER_RET>::create(*_dispatcher);
+    //The task and its coroutine stack are only created once the timer is due
+    auto caller = Util::bindTimerCaller(std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    DispatcherCore& dispatcher = *_dispatcher;
+    dispatcher.getTimerQueue().add(time, TimerQueue::Duration::zero(), [&dispatcher, ctx, caller, queueId, isHighPriority]()
+    {
+        auto task = Task::create(ctx,
+                                 queueId,
+                                 isHighPriority,
+                                 ITask::Type::Standalone,
+                                 std::move(*caller));
+        ctx->setTask(task);
+        dispatcher.post(task);
+    });
+    return ctx;
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+size_t
+Context<RET>::postEveryImpl(std::chrono::milliseconds period, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
+{
+    if (queueId < (int)IQueue::QueueId::Same)
+    {
+        throw std::runtime_error("Invalid coroutine queue id");
+    }
+    if (period <= std::chrono::milliseconds::zero())
+    {
+        throw std::runtime_error("Invalid timer period");
+    }
+    if (queueId == (int)IQueue::QueueId::Same)
+    {
+        queueId = _task->getQueueId();
+    }
+    auto caller = Util::bindTimerCaller(std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    DispatcherCore& dispatcher = *_dispatcher;
+    return dispatcher.getTimerQueue().add(std::chrono::steady_clock::now() + period, period, [&dispatcher, caller, queueId, isHighPriority]()
+    {
+        auto ctx = Context<OTHER_RET>::create(dispatcher);
+        auto task = Task::create(ctx,
+                                 queueId,
+                                 isHighPriority,
+                                 ITask::Type::Standalone,
+                                 typename std::decay<decltype(*caller)>::type(*caller)); //each instance runs a copy
+        ctx->setTask(task);
+        dispatcher.post(task);
+    });
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+CoroFuturePtr<OTHER_RET>
+Context<RET>::postAsyncIoImpl(int queueId, bool isHighPriority, std::chrono::steady_clock::time_point deadline, FUNC&& func, ARGS&&... args)
+{
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid coroutine queue id");
+    }
+    admit(IQueue::QueueType::IO, queueId, isHighPriority);
+    auto promise = Promise<OTHER_RET>::create();
+    auto task = IoTask::create(promise,
+                               queueId,
+                               isHighPriority,
+                               std::forward<FUNC>(func),
+                               std::forward<ARGS>(args)...);
+    task->setCancellationToken(std::static_pointer_cast<Task>(_task)->getCancellationToken());
+    task->setDeadline(deadline);
+    _dispatcher->postAsyncIo(task);
+    return promise->getICoroFuture();
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+ContextPtr<std::vector<OTHER_RET>>
+Context<RET>::forEach(INPUT_IT first,
+                      INPUT_IT last,
+                      Functions::ForEachFunc<OTHER_RET, INPUT_IT> func)
+{
+    return forEach<OTHER_RET>(first, std::distance(first, last), std::move(func));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+ContextPtr<std::vector<OTHER_RET>>
+Context<RET>::forEach(INPUT_IT first,
+                      size_t num,
+                      Functions::ForEachFunc<OTHER_RET, INPUT_IT> func)
+{
+    return post<std::vector<OTHER_RET>>(Util::forEachCoro<OTHER_RET, INPUT_IT>,
+                                        INPUT_IT{first},
+                                        size_t{num},
+                                        Functions::ForEachFunc<OTHER_RET, INPUT_IT>{std::move(func)});
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+ContextPtr<std::vector<OTHER_RET>>
+Context<RET>::forEach(INPUT_IT first,
+                      INPUT_IT last,
+                      Functions::ForEachFunc<OTHER_RET, INPUT_IT> func,
+                      GrainSize grain)
+{
+    return forEach<OTHER_RET>(first, std::distance(first, last), std::move(func), grain);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+ContextPtr<std::vector<OTHER_RET>>
+Context<RET>::forEach(INPUT_IT first,
+                      size_t num,
+                      Functions::ForEachFunc<OTHER_RET, INPUT_IT> func,
+                      GrainSize grain)
+{
+    return post<std::vector<OTHER_RET>>(Util::forEachChunkCoro<OTHER_RET, INPUT_IT>,
+                                        INPUT_IT{first},
+                                        size_t{num},
+                                        Functions::ForEachFunc<OTHER_RET, INPUT_IT>{std::move(func)},
+                                        GrainSize{grain},
+                                        getNumCoroutineThreads());
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class OUTPUT_IT, class>
+ContextPtr<int>
+Context<RET>::forEach(INPUT_IT first,
+                      INPUT_IT last,
+                      OUTPUT_IT out,
+                      Functions::ForEachFunc<OTHER_RET, INPUT_IT> func)
+{
+    return forEach<OTHER_RET>(first, std::distance(first, last), out, std::move(func));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class OUTPUT_IT>
+ContextPtr<int>
+Context<RET>::forEach(INPUT_IT first,
+                      size_t num,
+                      OUTPUT_IT out,
+                      Functions::ForEachFunc<OTHER_RET, INPUT_IT> func)
+{
+    return post<int>(Util::forEachIntoCoro<OTHER_RET, INPUT_IT, OUTPUT_IT>,
+                     INPUT_IT{first},
+                     size_t{num},
+                     OUTPUT_IT{out},
+                     Functions::ForEachFunc<OTHER_RET, INPUT_IT>{std::move(func)},
+                     getNumCoroutineThreads());
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+ContextPtr<std::vector<std::vector<OTHER_RET>>>
+Context<RET>::forEachBatch(INPUT_IT first,
+                           INPUT_IT last,
+                           Functions::ForEachFunc<OTHER_RET, INPUT_IT> func)
+{
+    return forEachBatch<OTHER_RET>(first, std::distance(first, last), std::move(func));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+ContextPtr<std::vector<std::vector<OTHER_RET>>>
+Context<RET>::forEachBatch(INPUT_IT first,
+                           size_t num,
+                           Functions::ForEachFunc<OTHER_RET, INPUT_IT> func)
+{
+    return post<std::vector<std::vector<OTHER_RET>>>(Util::forEachBatchCoro<OTHER_RET, INPUT_IT>,
+                                                     INPUT_IT{first},
+                                                     size_t{num},
+                                                     Functions::ForEachFunc<OTHER_RET, INPUT_IT>{std::move(func)},
+                                                     getNumCoroutineThreads());
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class>
+ContextPtr<std::vector<std::vector<OTHER_RET>>>
+Context<RET>::forEachBatch(INPUT_IT first,
+                           INPUT_IT last,
+                           Functions::ForEachFunc<OTHER_RET, INPUT_IT> func,
+                           GrainSize grain)
+{
+    return forEachBatch<OTHER_RET>(first, std::distance(first, last), std::move(func), grain);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT>
+ContextPtr<std::vector<std::vector<OTHER_RET>>>
+Context<RET>::forEachBatch(INPUT_IT first,
+                           size_t num,
+                           Functions::ForEachFunc<OTHER_RET, INPUT_IT> func,
+                           GrainSize grain)
+{
+    return post<std::vector<std::vector<OTHER_RET>>>(Util::forEachBatchDynamicCoro<OTHER_RET, INPUT_IT>,
+                                                     INPUT_IT{first},
+                                                     size_t{num},
+                                                     Functions::ForEachFunc<OTHER_RET, INPUT_IT>{std::move(func)},
+                                                     GrainSize{grain},
+                                                     getNumCoroutineThreads());
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class FUNC, class, class>
+ContextPtr<std::vector<std::vector<OTHER_RET>>>
+Context<RET>::forEachBatch(INPUT_IT first,
+                           INPUT_IT last,
+                           FUNC&& func)
+{
+    return forEachBatch<OTHER_RET>(first, std::distance(first, last), std::forward<FUNC>(func));
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class FUNC, class>
+ContextPtr<std::vector<std::vector<OTHER_RET>>>
+Context<RET>::forEachBatch(INPUT_IT first,
+                           size_t num,
+                           FUNC&& func)
+{
+    return post<std::vector<std::vector<OTHER_RET>>>(Util::forEachBatchCoro<OTHER_RET, INPUT_IT, std::decay_t<FUNC>>,
+                                                     INPUT_IT{first},
+                                                     size_t{num},
+                                                     std::decay_t<FUNC>{std::forward<FUNC>(func)},
+                                                     getNumCoroutineThreads());
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class FUNC, class, class>
+ContextPtr<std::vector<std::vector<OTHER_RET>>>
+Context<RET>::forEachBatch(INPUT_IT first,
+                           INPUT_IT last,
+                           FUNC&& func,
+                           GrainSize grain)
+{
+    return forEachBatch<OTHER_RET>(first, std::distance(first, last), std::forward<FUNC>(func), grain);
+}
+
+template <class RET>
+template <class OTHER_RET, class INPUT_IT, class FUNC, class>
+ContextPtr<std::vector<std::vector<OTHER_RET>>>
+Context<RET>::forEachBatch(INPUT_IT first,
+                           size_t num,
+                           FUNC&& func,
+                           GrainSize grain)
+{
+    return post<std::vector<std::vector<OTHER_RET>>>(Util::forEachBatchDynamicCoro<OTHER_RET, INPUT_IT, std::decay_t<FUNC>>,
+                                                     INPUT_IT{first},
+                                                     size_t{num},
+                                                     std::decay_t<FUNC>{std::forward<FUNC>(func)},
+                                                     GrainSize{grain},
+                                                     getNumCoroutineThreads());
+}
+
+template <class RET>
+template <class INPUT_TYPE, class OUTPUT_TYPE, class KERNEL>
+ContextPtr<int>
+Context<RET>::forEachKernel(const INPUT_TYPE* first,
+                            size_t num,
+                            OUTPUT_TYPE* out,
+                            KERNEL&& kernel)
+{
+    return post<int>(Util::forEachKernelCoro<INPUT_TYPE, OUTPUT_TYPE, std::decay_t<KERNEL>>,
+                     static_cast<const INPUT_TYPE*>(first),
+                     size_t{num},
+                     static_cast<OUTPUT_TYPE*>(out),
+                     std::decay_t<KERNEL>{std::forward<KERNEL>(kernel)},
+                     getNumCoroutineThreads());
+}
+
+template <class RET>
+template <class OUTPUT_TYPE, class INPUT_TYPE, class KERNEL>
+ContextPtr<std::vector<OUTPUT_TYPE>>
+Context<RET>::forEachKernel(const INPUT_TYPE* first,
+                            size_t num,
+                            KERNEL&& kernel)
+{
+    return post<std::vector<OUTPUT_TYPE>>(Util::forEachKernelIntoVectorCoro<INPUT_TYPE, OUTPUT_TYPE, std::decay_t<KERNEL>>,
+                                          static_cast<const INPUT_TYPE*>(first),
+                                          size_t{num},
+                                          std::decay_t<KERNEL>{std::forward<KERNEL>(kernel)},
+                                          getNumCoroutineThreads());
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class INPUT_IT,
+          class>
+ContextPtr<std::map<KEY, REDUCED_TYPE>>
+Context<RET>::mapReduce(INPUT_IT first,
+                        INPUT_IT last,
+                        Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+{
+    return mapReduce(first, std::distance(first, last), std::move(mapper), std::move(reducer));
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class INPUT_IT>
+ContextPtr<std::map<KEY, REDUCED_TYPE>>
+Context<RET>::mapReduce(INPUT_IT first,
+                        size_t num,
+                        Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+{
+    using ReducerOutput = std::map<KEY, REDUCED_TYPE>;
+    return post<ReducerOutput>(Util::mapReduceCoro<KEY, MAPPED_TYPE, REDUCED_TYPE, INPUT_IT>,
+                               INPUT_IT{first},
+                               size_t{num},
+                               Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>{std::move(mapper)},
+                               Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>{std::move(reducer)});
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class INPUT_IT,
+          class>
+ContextPtr<std::map<KEY, REDUCED_TYPE>>
+Context<RET>::mapReduceBatch(INPUT_IT first,
+                             INPUT_IT last,
+                             Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                             Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+{
+    return mapReduceBatch(first, std::distance(first, last), std::move(mapper), std::move(reducer));
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class INPUT_IT>
+ContextPtr<std::map<KEY, REDUCED_TYPE>>
+Context<RET>::mapReduceBatch(INPUT_IT first,
+                             size_t num,
+                             Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                             Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+{
+    using ReducerOutput = std::map<KEY, REDUCED_TYPE>;
+    return post<ReducerOutput>(Util::mapReduceBatchCoro<KEY, MAPPED_TYPE, REDUCED_TYPE, INPUT_IT>,
+                               INPUT_IT{first},
+                               size_t{num},
+                               Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>{std::move(mapper)},
+                               Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>{std::move(reducer)});
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class INPUT_IT,
+          class MAPPER,
+          class REDUCER,
+          class,
+          class,
+          class>
+ContextPtr<std::map<KEY, REDUCED_TYPE>>
+Context<RET>::mapReduceBatch(INPUT_IT first,
+                             INPUT_IT last,
+                             MAPPER&& mapper,
+                             REDUCER&& reducer)
+{
+    return mapReduceBatch<KEY, MAPPED_TYPE, REDUCED_TYPE>
+        (first, std::distance(first, last), std::forward<MAPPER>(mapper), std::forward<REDUCER>(reducer));
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class INPUT_IT,
+          class MAPPER,
+          class REDUCER,
+          class,
+          class>
+ContextPtr<std::map<KEY, REDUCED_TYPE>>
+Context<RET>::mapReduceBatch(INPUT_IT first,
+                             size_t num,
+                             MAPPER&& mapper,
+                             REDUCER&& reducer)
+{
+    using ReducerOutput = std::map<KEY, REDUCED_TYPE>;
+    return post<ReducerOutput>(Util::mapReduceBatchCoro<KEY, MAPPED_TYPE, REDUCED_TYPE, INPUT_IT, std::decay_t<MAPPER>, std::decay_t<REDUCER>>,
+                               INPUT_IT{first},
+                               size_t{num},
+                               std::decay_t<MAPPER>{std::forward<MAPPER>(mapper)},
+                               std::decay_t<REDUCER>{std::forward<REDUCER>(reducer)});
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class OUTPUT,
+          class INPUT_IT,
+          class>
+ContextPtr<OUTPUT>
+Context<RET>::mapReducePartitioned(INPUT_IT first,
+                                   INPUT_IT last,
+                                   Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                   Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+{
+    return mapReducePartitioned<KEY, MAPPED_TYPE, REDUCED_TYPE, OUTPUT>
+        (first, std::distance(first, last), std::move(mapper), std::move(reducer));
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class OUTPUT,
+          class INPUT_IT>
+ContextPtr<OUTPUT>
+Context<RET>::mapReducePartitioned(INPUT_IT first,
+                                   size_t num,
+                                   Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                   Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+{
+    return post<OUTPUT>(Util::mapReducePartitionedCoro<KEY, MAPPED_TYPE, REDUCED_TYPE, OUTPUT, INPUT_IT>,
+                        INPUT_IT{first},
+                        size_t{num},
+                        Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>{std::move(mapper)},
+                        Functions::CombineFunc<MAPPED_TYPE>{},
+                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>{std::move(reducer)},
+                        getNumCoroutineThreads());
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class OUTPUT,
+          class INPUT_IT,
+          class>
+ContextPtr<OUTPUT>
+Context<RET>::mapReducePartitioned(INPUT_IT first,
+                                   INPUT_IT last,
+                                   Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                   Functions::CombineFunc<MAPPED_TYPE> combiner,
+                                   Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+{
+    return mapReducePartitioned<KEY, MAPPED_TYPE, REDUCED_TYPE, OUTPUT>
+        (first, std::distance(first, last), std::move(mapper), std::move(combiner), std::move(reducer));
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class OUTPUT,
+          class INPUT_IT>
+ContextPtr<OUTPUT>
+Context<RET>::mapReducePartitioned(INPUT_IT first,
+                                   size_t num,
+                                   Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                   Functions::CombineFunc<MAPPED_TYPE> combiner,
+                                   Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+{
+    return post<OUTPUT>(Util::mapReducePartitionedCoro<KEY, MAPPED_TYPE, REDUCED_TYPE, OUTPUT, INPUT_IT>,
+                        INPUT_IT{first},
+                        size_t{num},
+                        Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>{std::move(mapper)},
+                        Functions::CombineFunc<MAPPED_TYPE>{std::move(combiner)},
+                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>{std::move(reducer)},
+                        getNumCoroutineThreads());
+}
+
+template <class RET>
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class OUTPUT,
+          class INPUT>
+ContextPtr<Buffer<OUTPUT>>
+Context<RET>::mapReduceStream(std::shared_ptr<ICoroFuture<Buffer<INPUT>>> input,
+                            Functions::StreamMapFunc<KEY, MAPPED_TYPE, INPUT> mapper,
+                            Functions::FoldFunc<REDUCED_TYPE, MAPPED_TYPE> reducer,
+                            size_t windowSize)
+{
+    return post<Buffer<OUTPUT>>(Util::mapReduceStreamCoro<KEY, MAPPED_TYPE, REDUCED_TYPE, OUTPUT, INPUT>,
+                                CoroFuturePtr<Buffer<INPUT>>{std::move(input)},
+                                Functions::StreamMapFunc<KEY, MAPPED_TYPE, INPUT>{std::move(mapper)},
+                                Functions::FoldFunc<REDUCED_TYPE, MAPPED_TYPE>{std::move(reducer)},
+                                size_t{windowSize});
 }
 
 template <class RET>
-template <class OTHER_RET, class FUNC, class ... ARGS>
+template <class OTHER_RET, class INPUT_IT, class>
 ContextPtr<OTHER_RET>
-Context<RET>::onError(FUNC&& func, ARGS&&... args)
+Context<RET>::reduce(INPUT_IT first,
+                     INPUT_IT last,
+                     OTHER_RET init,
+                     Functions::BinaryFunc<OTHER_RET> op)
 {
-    validateTaskType(ITask::Type::ErrorHandler);
-    return thenImpl<OTHER_RET, FUNC, ARGS...>(ITask::Type::ErrorHandler, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return reduce<OTHER_RET>(first, std::distance(first, last), std::move(init), std::move(op));
 }
 
 template <class RET>
-template <class OTHER_RET, class FUNC, class ... ARGS>
+template <class OTHER_RET, class INPUT_IT>
 ContextPtr<OTHER_RET>
-Context<RET>::finally(FUNC&& func, ARGS&&... args)
+Context<RET>::reduce(INPUT_IT first,
+                     size_t num,
+                     OTHER_RET init,
+                     Functions::BinaryFunc<OTHER_RET> op)
 {
-    validateTaskType(ITask::Type::Final);
-    return thenImpl<OTHER_RET, FUNC, ARGS...>(ITask::Type::Final, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return post<OTHER_RET>(Util::transformReduceCoro<OTHER_RET, INPUT_IT, Util::IdentityTransform>,
+                           INPUT_IT{first},
+                           size_t{num},
+                           OTHER_RET{std::move(init)},
+                           Functions::BinaryFunc<OTHER_RET>{std::move(op)},
+                           Util::IdentityTransform{},
+                           getNumCoroutineThreads());
 }
 
 template <class RET>
-typename Context<RET>::Ptr
-Context<RET>::end()
+template <class OTHER_RET, class INPUT_IT, class>
+ContextPtr<OTHER_RET>
+Context<RET>::transformReduce(INPUT_IT first,
+                              INPUT_IT last,
+                              OTHER_RET init,
+                              Functions::BinaryFunc<OTHER_RET> reduceOp,
+                              Functions::ForEachFunc<OTHER_RET, INPUT_IT> transform)
 {
-    validateTaskType(ITask::Type::Termination);
-    //Async post to next available queue since the previous task in the chain already terminated
-    auto task = std::static_pointer_cast<Task>(std::static_pointer_cast<ITaskContinuation>(getTask())->getFirstTask());
-    _dispatcher->post(task);
-    return dynamic_cast<Context<RET>*>(this)->shared_from_this();
+    return transformReduce<OTHER_RET>(first, std::distance(first, last), std::move(init), std::move(reduceOp), std::move(transform));
 }
 
 template <class RET>
-template <class OTHER_RET, class FUNC, class ... ARGS>
-CoroFuturePtr<OTHER_RET>
-Context<RET>::postAsyncIo(FUNC&& func, ARGS&&... args)
+template <class OTHER_RET, class INPUT_IT>
+ContextPtr<OTHER_RET>
+Context<RET>::transformReduce(INPUT_IT first,
+                              size_t num,
+                              OTHER_RET init,
+                              Functions::BinaryFunc<OTHER_RET> reduceOp,
+                              Functions::ForEachFunc<OTHER_RET, INPUT_IT> transform)
 {
-    return postAsyncIoImpl<OTHER_RET>((int)IQueue::QueueId::Any, false, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return post<OTHER_RET>(Util::transformReduceCoro<OTHER_RET, INPUT_IT, Functions::ForEachFunc<OTHER_RET, INPUT_IT>>,
+                           INPUT_IT{first},
+                           size_t{num},
+                           OTHER_RET{std::move(init)},
+                           Functions::BinaryFunc<OTHER_RET>{std::move(reduceOp)},
+                           Functions::ForEachFunc<OTHER_RET, INPUT_IT>{std::move(transform)},
+                           getNumCoroutineThreads());
 }
 
 template <class RET>
-template <class OTHER_RET, class FUNC, class ... ARGS>
-CoroFuturePtr<OTHER_RET>
-Context<RET>::postAsyncIo(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
+template <class OTHER_RET, class INPUT_IT, class>
+ContextPtr<std::vector<OTHER_RET>>
+Context<RET>::inclusiveScan(INPUT_IT first,
+                            INPUT_IT last,
+                            Functions::BinaryFunc<OTHER_RET> op)
 {
-    return postAsyncIoImpl<OTHER_RET>(queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return inclusiveScan<OTHER_RET>(first, std::distance(first, last), std::move(op));
 }
 
 template <class RET>
-template <class OTHER_RET, class FUNC, class ... ARGS>
-CoroFuturePtr<OTHER_RET>
-Context<RET>::postAsyncIoImpl(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
+template <class OTHER_RET, class INPUT_IT>
+ContextPtr<std::vector<OTHER_RET>>
+Context<RET>::inclusiveScan(INPUT_IT first,
+                            size_t num,
+                            Functions::BinaryFunc<OTHER_RET> op)
 {
-    if (queueId < (int)IQueue::QueueId::Any)
-    {
-        throw std::runtime_error("Invalid coroutine queue id");
-    }
-    auto promise = PromisePtr<OTHER_RET>(new Promise<OTHER_RET>(), Promise<OTHER_RET>::deleter);
-    auto task = IoTask::Ptr(new IoTask(promise,
-                                       queueId,
-                                       isHighPriority,
-                                       std::forward<FUNC>(func),
-                                       std::forward<ARGS>(args)...),
-                            IoTask::deleter);
-    _dispatcher->postAsyncIo(task);
-    return promise->getICoroFuture();
+    return post<std::vector<OTHER_RET>>(Util::scanCoro<OTHER_RET, INPUT_IT>,
+                                        INPUT_IT{first},
+                                        size_t{num},
+                                        true,
+                                        OTHER_RET{},
+                                        Functions::BinaryFunc<OTHER_RET>{std::move(op)},
+                                        getNumCoroutineThreads());
 }
 
 template <class RET>
 template <class OTHER_RET, class INPUT_IT, class>
 ContextPtr<std::vector<OTHER_RET>>
-Context<RET>::forEach(INPUT_IT first,
-                      INPUT_IT last,
-                      Functions::ForEachFunc<OTHER_RET, INPUT_IT> func)
+Context<RET>::exclusiveScan(INPUT_IT first,
+                            INPUT_IT last,
+                            OTHER_RET init,
+                            Functions::BinaryFunc<OTHER_RET> op)
 {
-    return forEach<OTHER_RET>(first, std::distance(first, last), std::move(func));
+    return exclusiveScan<OTHER_RET>(first, std::distance(first, last), std::move(init), std::move(op));
 }
 
 template <class RET>
 template <class OTHER_RET, class INPUT_IT>
 ContextPtr<std::vector<OTHER_RET>>
-Context<RET>::forEach(INPUT_IT first,
-                      size_t num,
-                      Functions::ForEachFunc<OTHER_RET, INPUT_IT> func)
+Context<RET>::exclusiveScan(INPUT_IT first,
+                            size_t num,
+                            OTHER_RET init,
+                            Functions::BinaryFunc<OTHER_RET> op)
 {
-    return post<std::vector<OTHER_RET>>(Util::forEachCoro<OTHER_RET, INPUT_IT>,
+    return post<std::vector<OTHER_RET>>(Util::scanCoro<OTHER_RET, INPUT_IT>,
                                         INPUT_IT{first},
                                         size_t{num},
-                                        Functions::ForEachFunc<OTHER_RET, INPUT_IT>{std::move(func)});
+                                        false,
+                                        OTHER_RET{std::move(init)},
+                                        Functions::BinaryFunc<OTHER_RET>{std::move(op)},
+                                        getNumCoroutineThreads());
 }
 
 template <class RET>
-template <class OTHER_RET, class INPUT_IT, class>
-ContextPtr<std::vector<std::vector<OTHER_RET>>>
-Context<RET>::forEachBatch(INPUT_IT first,
-                           INPUT_IT last,
-                           Functions::ForEachFunc<OTHER_RET, INPUT_IT> func)
+template <class RANDOM_IT, class COMPARE>
+ContextPtr<int>
+Context<RET>::sort(RANDOM_IT first,
+                   RANDOM_IT last,
+                   COMPARE compare)
 {
-    return forEachBatch<OTHER_RET>(first, std::distance(first, last), std::move(func));
+    return post<int>(Util::sortCoro<RANDOM_IT, COMPARE>,
+                     RANDOM_IT{first},
+                     RANDOM_IT{last},
+                     COMPARE{std::move(compare)},
+                     false,
+                     getNumCoroutineThreads());
 }
 
 template <class RET>
-template <class OTHER_RET, class INPUT_IT>
-ContextPtr<std::vector<std::vector<OTHER_RET>>>
-Context<RET>::forEachBatch(INPUT_IT first,
-                           size_t num,
-                           Functions::ForEachFunc<OTHER_RET, INPUT_IT> func)
+template <class RANDOM_IT, class COMPARE>
+ContextPtr<int>
+Context<RET>::stableSort(RANDOM_IT first,
+                         RANDOM_IT last,
+                         COMPARE compare)
 {
-    return post<std::vector<std::vector<OTHER_RET>>>(Util::forEachBatchCoro<OTHER_RET, INPUT_IT>,
-                                                     INPUT_IT{first},
-                                                     size_t{num},
-                                                     Functions::ForEachFunc<OTHER_RET, INPUT_IT>{std::move(func)},
-                                                     getNumCoroutineThreads());
+    return post<int>(Util::sortCoro<RANDOM_IT, COMPARE>,
+                     RANDOM_IT{first},
+                     RANDOM_IT{last},
+                     COMPARE{std::move(compare)},
+                     true,
+                     getNumCoroutineThreads());
 }
 
 template <class RET>
-template <class KEY,
-          class MAPPED_TYPE,
-          class REDUCED_TYPE,
-          class INPUT_IT,
-          class>
-ContextPtr<std::map<KEY, REDUCED_TYPE>>
-Context<RET>::mapReduce(INPUT_IT first,
-                        INPUT_IT last,
-                        Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
-                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+template <class V>
+int Context<RET>::set(V&& value)
 {
-    return mapReduce(first, std::distance(first, last), std::move(mapper), std::move(reducer));
+    if (!_promise)
+    {
+        return 0; //detached. The value is dropped.
+    }
+    return static_cast<Promise<RET>&>(*_promise).set(std::forward<V>(value));
 }
 
 template <class RET>
-template <class KEY,
-          class MAPPED_TYPE,
-          class REDUCED_TYPE,
-          class INPUT_IT>
-ContextPtr<std::map<KEY, REDUCED_TYPE>>
-Context<RET>::mapReduce(INPUT_IT first,
-                        size_t num,
-                        Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
-                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+template <class BUF, class V>
+void Context<RET>::push(V &&value)
 {
-    using ReducerOutput = std::map<KEY, REDUCED_TYPE>;
-    return post<ReducerOutput>(Util::mapReduceCoro<KEY, MAPPED_TYPE, REDUCED_TYPE, INPUT_IT>,
-                               INPUT_IT{first},
-                               size_t{num},
-                               Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>{std::move(mapper)},
-                               Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>{std::move(reducer)});
+    promise().template push<BUF>(std::forward<V>(value));
 }
 
 template <class RET>
-template <class KEY,
-          class MAPPED_TYPE,
-          class REDUCED_TYPE,
-          class INPUT_IT,
-          class>
-ContextPtr<std::map<KEY, REDUCED_TYPE>>
-Context<RET>::mapReduceBatch(INPUT_IT first,
-                             INPUT_IT last,
-                             Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
-                             Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+template <class BUF, class V>
+void Context<RET>::push(ICoroSync::Ptr sync, V &&value)
 {
-    return mapReduceBatch(first, std::distance(first, last), std::move(mapper), std::move(reducer));
+    promise().template push<BUF>(sync, std::forward<V>(value));
 }
 
 template <class RET>
-template <class KEY,
-          class MAPPED_TYPE,
-          class REDUCED_TYPE,
-          class INPUT_IT>
-ContextPtr<std::map<KEY, REDUCED_TYPE>>
-Context<RET>::mapReduceBatch(INPUT_IT first,
-                             size_t num,
-                             Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
-                             Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+template <class BUF, class V>
+V Context<RET>::pull(bool& isBufferClosed)
 {
-    using ReducerOutput = std::map<KEY, REDUCED_TYPE>;
-    return post<ReducerOutput>(Util::mapReduceBatchCoro<KEY, MAPPED_TYPE, REDUCED_TYPE, INPUT_IT>,
-                               INPUT_IT{first},
-                               size_t{num},
-                               Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>{std::move(mapper)},
-                               Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>{std::move(reducer)});
+    return promise().getIThreadFuture()->template pull<BUF>(isBufferClosed);
 }
 
 template <class RET>
-template <class V>
-int Context<RET>::set(V&& value)
+template <class BUF, class V>
+V Context<RET>::pull(ICoroSync::Ptr sync, bool& isBufferClosed)
 {
-    return std::static_pointer_cast<Promise<RET>>(_promises.back())->set(std::forward<V>(value));
+    return promise().getICoroFuture()->template pull<BUF>(sync, isBufferClosed);
 }
 
 template <class RET>
 template <class BUF, class V>
-void Context<RET>::push(V &&value)
+void Context<RET>::pushMany(std::vector<V> values)
 {
-    std::static_pointer_cast<Promise<RET>>(_promises.back())->template push<BUF>(std::forward<V>(value));
+    promise().template pushMany<BUF>(std::move(values));
 }
 
 template <class RET>
 template <class BUF, class V>
-void Context<RET>::push(ICoroSync::Ptr sync, V &&value)
+void Context<RET>::pushMany(ICoroSync::Ptr sync, std::vector<V> values)
 {
-    std::static_pointer_cast<Promise<RET>>(_promises.back())->template push<BUF>(sync, std::forward<V>(value));
+    promise().template pushMany<BUF>(sync, std::move(values));
 }
 
 template <class RET>
 template <class BUF, class V>
-V Context<RET>::pull(bool& isBufferClosed)
+size_t Context<RET>::pullMany(std::vector<V>& values, size_t maxCount, bool& isBufferClosed)
 {
-    return std::static_pointer_cast<Promise<RET>>(_promises.back())->getIThreadFuture()->template pull<BUF>(isBufferClosed);
+    return promise().getIThreadFuture()->template pullMany<BUF>(values, maxCount, isBufferClosed);
 }
 
 template <class RET>
 template <class BUF, class V>
-V Context<RET>::pull(ICoroSync::Ptr sync, bool& isBufferClosed)
+size_t Context<RET>::pullMany(ICoroSync::Ptr sync, std::vector<V>& values, size_t maxCount, bool& isBufferClosed)
 {
-    return std::static_pointer_cast<Promise<RET>>(_promises.back())->getICoroFuture()->template pull<BUF>(sync, isBufferClosed);
+    return promise().getICoroFuture()->template pullMany<BUF>(sync, values, maxCount, isBufferClosed);
 }
 
 template <class RET>
 template <class BUF, class>
 int Context<RET>::closeBuffer()
 {
-    return std::static_pointer_cast<Promise<RET>>(_promises.back())->template closeBuffer<BUF>();
+    return promise().template closeBuffer<BUF>();
 }
 
 template <class RET>
 template <class OTHER_RET>
 OTHER_RET Context<RET>::getAt(int num)
 {
-    return std::static_pointer_cast<Promise<OTHER_RET>>(_promises[index(num)])->getIThreadFuture()->get();
+    return sharedStateAt<OTHER_RET>(num).get();
 }
 
 template <class RET>
 template <class OTHER_RET>
 const OTHER_RET& Context<RET>::getRefAt(int num) const
 {
-    return std::static_pointer_cast<Promise<OTHER_RET>>(_promises[index(num)])->getIThreadFuture()->getRef();
+    return sharedStateAt<OTHER_RET>(num).getRef();
 }
 
 template <class RET>
@@ -846,16 +2206,22 @@ const RET& Context<RET>::getRef() const
     return getRefAt<RET>(-1);
 }
 
+template <class RET>
+SharedFuture<RET> Context<RET>::getSharedFuture() const
+{
+    return std::static_pointer_cast<Promise<RET>>(promiseAt(-1))->getSharedFuture();
+}
+
 template <class RET>
 void Context<RET>::waitAt(int num) const
 {
-    _promises[index(num)]->getIThreadFutureBase()->wait();
+    promiseAt(num)->getIThreadFutureBase()->wait();
 }
 
 template <class RET>
 std::future_status Context<RET>::waitForAt(int num, std::chrono::milliseconds timeMs) const
 {
-    return _promises[index(num)]->getIThreadFutureBase()->waitFor(timeMs);
+    return promiseAt(num)->getIThreadFutureBase()->waitFor(timeMs);
 }
 
 template <class RET>
@@ -873,11 +2239,11 @@ std::future_status Context<RET>::waitFor(std::chrono::milliseconds timeMs) const
 template <class RET>
 void Context<RET>::waitAll() const
 {
-    for (auto&& promise : _promises)
+    for (int i = 0; i <= _position; ++i)
     {
         try
         {
-            promise->getIThreadFutureBase()->wait();
+            promiseAt(i)->getIThreadFutureBase()->wait();
         }
         catch(...) //catch all broken promises or any other exception
         {}
@@ -888,7 +2254,11 @@ template <class RET>
 template <class V>
 int Context<RET>::set(ICoroSync::Ptr sync, V&& value)
 {
-    return std::static_pointer_cast<Promise<RET>>(_promises.back())->set(sync, std::forward<V>(value));
+    if (!_promise)
+    {
+        return 0; //detached. The value is dropped.
+    }
+    return static_cast<Promise<RET>&>(*_promise).set(sync, std::forward<V>(value));
 }
 
 template <class RET>
@@ -897,7 +2267,7 @@ OTHER_RET Context<RET>::getAt(int num,
                               ICoroSync::Ptr sync)
 {
     validateContext(sync);
-    return std::static_pointer_cast<Promise<OTHER_RET>>(_promises[index(num)])->getICoroFuture()->get(sync);
+    return sharedStateAt<OTHER_RET>(num).get(std::move(sync));
 }
 
 template <class RET>
@@ -906,41 +2276,41 @@ const OTHER_RET& Context<RET>::getRefAt(int num,
                                         ICoroSync::Ptr sync) const
 {
     validateContext(sync);
-    return std::static_pointer_cast<Promise<OTHER_RET>>(_promises[index(num)])->getICoroFuture()->getRef(sync);
+    return sharedStateAt<OTHER_RET>(num).getRef(std::move(sync));
 }
 
 template <class RET>
 RET Context<RET>::get(ICoroSync::Ptr sync)
 {
-    return getAt<RET>(-1, sync);
+    return getAt<RET>(-1, std::move(sync));
 }
 
 template <class RET>
 const RET& Context<RET>::getRef(ICoroSync::Ptr sync) const
 {
-    return getRefAt<RET>(-1, sync);
+    return getRefAt<RET>(-1, std::move(sync));
 }
 
 template <class RET>
 template <class OTHER_RET>
 OTHER_RET Context<RET>::getPrev(ICoroSync::Ptr sync)
 {
-    if (_promises.size() < 2)
+    if (_position < 1)
     {
         ThrowFutureException(FutureState::NoState);
     }
-    return std::static_pointer_cast<Promise<OTHER_RET>>(_promises[index(_promises.size()-2)])->getICoroFuture()->get(sync);
+    return sharedStateAt<OTHER_RET>(_position-1).get(std::move(sync));
 }
 
 template <class RET>
 template <class OTHER_RET>
 const OTHER_RET& Context<RET>::getPrevRef(ICoroSync::Ptr sync)
 {
-    if (_promises.size() < 2)
+    if (_position < 1)
     {
         ThrowFutureException(FutureState::NoState);
     }
-    return std::static_pointer_cast<Promise<OTHER_RET>>(_promises[index(_promises.size()-2)])->getICoroFuture()->getRef(sync);
+    return sharedStateAt<OTHER_RET>(_position-1).getRef(std::move(sync));
 }
 
 template <class RET>
@@ -955,12 +2325,123 @@ int Context<RET>::getNumIoThreads() const
     return _dispatcher->getNumIoThreads();
 }
 
+template <class RET>
+bool Context<RET>::isCancelled() const
+{
+    return _task ? _task->isCancelled() : false;
+}
+
+template <class RET>
+template <class T>
+T* Context<RET>::getLocal(const CoroLocal<T>& slot) const
+{
+    const CoroLocalStorage::Ptr& storage = std::static_pointer_cast<Task>(_task)->getLocalStorage();
+    return storage ? static_cast<T*>(storage->get(slot.index())) : nullptr;
+}
+
+template <class RET>
+template <class T>
+void Context<RET>::setLocal(const CoroLocal<T>& slot, std::shared_ptr<T> value)
+{
+    Task::Ptr task = std::static_pointer_cast<Task>(_task);
+    if (!task->getLocalStorage())
+    {
+        task->setLocalStorage(std::make_shared<CoroLocalStorage>());
+    }
+    task->getLocalStorage()->set(slot.index(), std::move(value), slot.isInheritedByChildren());
+}
+
+template <class RET>
+bool Context<RET>::awaitReadable(int fd, std::chrono::milliseconds timeMs)
+{
+    return awaitEvent(fd, Reactor::Event::Read, timeMs);
+}
+
+template <class RET>
+bool Context<RET>::awaitWritable(int fd, std::chrono::milliseconds timeMs)
+{
+    return awaitEvent(fd, Reactor::Event::Write, timeMs);
+}
+
+template <class RET>
+ssize_t Context<RET>::read(int fd, void* buffer, size_t size)
+{
+    while (true)
+    {
+        ssize_t rc = ::read(fd, buffer, size);
+        if ((rc >= 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)))
+        {
+            return rc;
+        }
+        if (errno != EINTR)
+        {
+            awaitReadable(fd, std::chrono::milliseconds(-1));
+        }
+    }
+}
+
+template <class RET>
+ssize_t Context<RET>::write(int fd, const void* buffer, size_t size)
+{
+    while (true)
+    {
+        ssize_t rc = ::write(fd, buffer, size);
+        if ((rc >= 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)))
+        {
+            return rc;
+        }
+        if (errno != EINTR)
+        {
+            awaitWritable(fd, std::chrono::milliseconds(-1));
+        }
+    }
+}
+
+template <class RET>
+bool Context<RET>::awaitEvent(int fd, Reactor::Event event, std::chrono::milliseconds timeMs)
+{
+    if (timeMs == std::chrono::milliseconds::zero())
+    {
+        return false; //timeout
+    }
+    Reactor& reactor = _dispatcher->getReactor();
+    auto deadline = Clock::now() + timeMs;
+    bool hasTimeout = (timeMs > std::chrono::milliseconds::zero());
+    _signal = 0; //the coroutine gets parked until the reactor sets the signal
+    reactor.add(fd, event, _signal, std::static_pointer_cast<ICoroSync>(this->shared_from_this()));
+    if (hasTimeout)
+    {
+        setWakeUpTime(deadline);
+    }
+    bool timeout = false;
+    while (_signal == 0)
+    {
+        yield();
+        if (hasTimeout && (Clock::now() >= deadline))
+        {
+            timeout = true;
+            break; //expired time
+        }
+    }
+    if (hasTimeout)
+    {
+        clearWakeUpTime();
+    }
+    if (timeout)
+    {
+        //the descriptor may have become ready in the meantime
+        timeout = reactor.remove(fd, event, _signal);
+    }
+    _signal = -1; //reset
+    return !timeout;
+}
+
 template <class RET>
 void Context<RET>::waitAt(int num,
                           ICoroSync::Ptr sync) const
 {
     validateContext(sync);
-    _promises[index(num)]->getICoroFutureBase()->wait(sync);
+    promiseAt(num)->getICoroFutureBase()->wait(sync);
 }
 
 template <class RET>
@@ -969,7 +2450,7 @@ std::future_status Context<RET>::waitForAt(int num,
                                            std::chrono::milliseconds timeMs) const
 {
     validateContext(sync);
-    return _promises[index(num)]->getICoroFutureBase()->waitFor(sync, timeMs);
+    return promiseAt(num)->getICoroFutureBase()->waitFor(sync, timeMs);
 }
 
 template <class RET>
@@ -988,11 +2469,15 @@ std::future_status Context<RET>::waitFor(ICoroSync::Ptr sync,
 template <class RET>
 void Context<RET>::waitAll(ICoroSync::Ptr sync) const
 {
-    for (auto&& promise : _promises)
+    for (int i = 0; i <= _position; ++i)
     {
         try
         {
-            promise->getICoroFutureBase()->wait(sync);
+            promiseAt(i)->getICoroFutureBase()->wait(sync);
+        }
+        catch(boost::context::detail::forced_unwind&)
+        {
+            throw; //the coroutine is being destroyed
         }
         catch(...) //catch all broken promises or any other exception
         {
@@ -1005,7 +2490,8 @@ template <class OTHER_RET, class FUNC, class ... ARGS>
 ContextPtr<OTHER_RET>
 Context<RET>::post(FUNC&& func, ARGS&&... args)
 {
-    return postImpl<OTHER_RET>((int)IQueue::QueueId::Any, false, ITask::Type::Standalone, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postImpl<OTHER_RET>((int)IQueue::QueueId::Any, IQueue::Priority::Normal, std::chrono::steady_clock::time_point::max(),
+                               ITask::Type::Standalone, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
 template <class RET>
@@ -1013,7 +2499,27 @@ template <class OTHER_RET, class FUNC, class ... ARGS>
 ContextPtr<OTHER_RET>
 Context<RET>::post(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
 {
-    return postImpl<OTHER_RET>(queueId, isHighPriority, ITask::Type::Standalone, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postImpl<OTHER_RET>(queueId, isHighPriority ? IQueue::Priority::High : IQueue::Priority::Normal,
+                               std::chrono::steady_clock::time_point::max(),
+                               ITask::Type::Standalone, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+ContextPtr<OTHER_RET>
+Context<RET>::post(int queueId, IQueue::Priority priority, FUNC&& func, ARGS&&... args)
+{
+    return postImpl<OTHER_RET>(queueId, priority, std::chrono::steady_clock::time_point::max(),
+                               ITask::Type::Standalone, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+ContextPtr<OTHER_RET>
+Context<RET>::post(int queueId, IQueue::Priority priority, std::chrono::steady_clock::time_point deadline, FUNC&& func, ARGS&&... args)
+{
+    return postImpl<OTHER_RET>(queueId, priority, deadline,
+                               ITask::Type::Standalone, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
 template <class RET>
@@ -1021,7 +2527,8 @@ template <class OTHER_RET, class FUNC, class ... ARGS>
 ContextPtr<OTHER_RET>
 Context<RET>::postFirst(FUNC&& func, ARGS&&... args)
 {
-    return postImpl<OTHER_RET>((int)IQueue::QueueId::Any, false, ITask::Type::First, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postImpl<OTHER_RET>((int)IQueue::QueueId::Any, IQueue::Priority::Normal, std::chrono::steady_clock::time_point::max(),
+                               ITask::Type::First, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
 template <class RET>
@@ -1029,27 +2536,103 @@ template <class OTHER_RET, class FUNC, class ... ARGS>
 ContextPtr<OTHER_RET>
 Context<RET>::postFirst(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args)
 {
-    return postImpl<OTHER_RET>(queueId, isHighPriority, ITask::Type::First, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postImpl<OTHER_RET>(queueId, isHighPriority ? IQueue::Priority::High : IQueue::Priority::Normal,
+                               std::chrono::steady_clock::time_point::max(),
+                               ITask::Type::First, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+ContextPtr<OTHER_RET>
+Context<RET>::postFirst(int queueId, IQueue::Priority priority, FUNC&& func, ARGS&&... args)
+{
+    return postImpl<OTHER_RET>(queueId, priority, std::chrono::steady_clock::time_point::max(),
+                               ITask::Type::First, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC, class ... ARGS>
+ContextPtr<OTHER_RET>
+Context<RET>::postFirst(int queueId, IQueue::Priority priority, std::chrono::steady_clock::time_point deadline, FUNC&& func, ARGS&&... args)
+{
+    return postImpl<OTHER_RET>(queueId, priority, deadline,
+                               ITask::Type::First, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC_IT, class>
+std::vector<CoroContextPtr<OTHER_RET>>
+Context<RET>::postBatch(FUNC_IT first, FUNC_IT last)
+{
+    return postBatch<OTHER_RET>((int)IQueue::QueueId::Any, false, first, last);
+}
+
+template <class RET>
+template <class OTHER_RET, class FUNC_IT, class>
+std::vector<CoroContextPtr<OTHER_RET>>
+Context<RET>::postBatch(int queueId, bool isHighPriority, FUNC_IT first, FUNC_IT last)
+{
+    if (queueId < (int)IQueue::QueueId::Same)
+    {
+        throw std::runtime_error("Invalid coroutine queue id");
+    }
+    if (queueId == (int)IQueue::QueueId::Same)
+    {
+        queueId = _task->getQueueId();
+    }
+    std::vector<CoroContextPtr<OTHER_RET>> contexts;
+    std::vector<Task::Ptr> tasks;
+    for (; first != last; ++first)
+    {
+        auto ctx = Context<OTHER_RET>::create(*_dispatcher);
+        auto task = Task::create(ctx,
+                                 queueId,
+                                 isHighPriority,
+                                 ITask::Type::Standalone,
+                                 *first);
+        task->setCancellationToken(std::static_pointer_cast<Task>(_task)->getCancellationToken());
+        task->setLocalStorage(CoroLocalStorage::inherit(std::static_pointer_cast<Task>(_task)->getLocalStorage()));
+        ctx->setTask(task);
+        tasks.emplace_back(std::move(task));
+        contexts.emplace_back(ctx);
+    }
+    _dispatcher->postBatch(tasks);
+    return contexts;
 }
 
 template <class RET>
 template <class OTHER_RET, class FUNC, class ... ARGS>
 ContextPtr<OTHER_RET>
-Context<RET>::postImpl(int queueId, bool isHighPriority, ITask::Type type, FUNC&& func, ARGS&&... args)
+Context<RET>::postImpl(int queueId,
+                       IQueue::Priority priority,
+                       std::chrono::steady_clock::time_point deadline,
+                       ITask::Type type,
+                       FUNC&& func,
+                       ARGS&&... args)
 {
     if (queueId < (int)IQueue::QueueId::Same)
     {
         throw std::runtime_error("Invalid coroutine queue id");
     }
-    auto ctx = ContextPtr<OTHER_RET>(new Context<OTHER_RET>(*_dispatcher),
-                                     Context<OTHER_RET>::deleter);
-    auto task = Task::Ptr(new Task(ctx,
-                                   (queueId == (int)IQueue::QueueId::Same) ? _task->getQueueId() : queueId,
-                                   isHighPriority,
-                                   type,
-                                   std::forward<FUNC>(func),
-                                   std::forward<ARGS>(args)...),
-                          Task::deleter);
+    if (queueId == (int)IQueue::QueueId::Same)
+    {
+        queueId = _task->getQueueId();
+    }
+    if (type == ITask::Type::Standalone)
+    {
+        admit(IQueue::QueueType::Coro, queueId, priority <= IQueue::Priority::High);
+    }
+    auto ctx = Context<OTHER_RET>::create(*_dispatcher);
+    auto task = Task::create(ctx,
+                             queueId,
+                             priority <= IQueue::Priority::High,
+                             type,
+                             std::forward<FUNC>(func),
+                             std::forward<ARGS>(args)...);
+    task->setPriority(priority);
+    task->setDeadline(deadline);
+    task->setCancellationToken(std::static_pointer_cast<Task>(_task)->getCancellationToken());
+    task->setLocalStorage(CoroLocalStorage::inherit(std::static_pointer_cast<Task>(_task)->getLocalStorage()));
     ctx->setTask(task);
     if (type == ITask::Type::Standalone)
     {
@@ -1067,17 +2650,21 @@ void* Context<RET>::operator new(size_t)
 template <class RET>
 void Context<RET>::operator delete(void* p)
 {
-    Allocator<ContextAllocator>::instance(AllocatorTraits::contextAllocSize()).deallocate(static_cast<Context<int>*>(p));
+    Allocator<ContextAllocator>::instance(AllocatorTraits::contextAllocSize()).deallocate(static_cast<SharedBlock<Context<int>>*>(p));
 }
 
 template <class RET>
 void Context<RET>::deleter(Context<RET>* p)
 {
-#ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
-    Allocator<ContextAllocator>::instance(AllocatorTraits::contextAllocSize()).dispose(reinterpret_cast<Context<int>*>(p));
-#else
-    delete p;
-#endif
+    delete p; //destroys and returns the block to the pool
+}
+
+template <class RET>
+template <class ... ARGS>
+typename Context<RET>::Ptr Context<RET>::create(ARGS&&... args)
+{
+    return std::allocate_shared<Context<RET>>(SharedAllocator<Context<RET>, ContextAllocator, &AllocatorTraits::contextAllocSize>(),
+                                              std::forward<ARGS>(args)...);
 }
 
 }}
@@ -17,6 +17,8 @@
 #include <type_traits>
 #include <assert.h>
 #include <exception>
+#include <algorithm>
+#include <cstring>
 
 //##############################################################################################
 //#################################### IMPLEMENTATIONS #########################################
@@ -45,10 +47,17 @@ template <typename T>
 ContiguousPoolManager<T>& ContiguousPoolManager<T>::operator=(ContiguousPoolManager<T>&& other)
 {
     _size = other._size;
-    _buffer = other.buffer;
+    _buffer = other._buffer;
     _freeBlocks = other._freeBlocks;
     _freeBlockIndex = other._freeBlockIndex;
     _numHeapAllocatedBlocks = other._numHeapAllocatedBlocks;
+    _numHeapFallbacks = other._numHeapFallbacks;
+    _peakBlocks = other._peakBlocks;
+    _slabs = std::move(other._slabs);
+    _threadCaches = std::move(other._threadCaches);
+    for (auto&& cache : _threadCaches) {
+        cache->_owner = this;
+    }
     _spinlock = std::move(other._spinlock);
     
     // Reset other
@@ -56,12 +65,28 @@ ContiguousPoolManager<T>& ContiguousPoolManager<T>::operator=(ContiguousPoolMana
     other._freeBlocks = nullptr;
     other._freeBlockIndex = -1;
     other._numHeapAllocatedBlocks = 0;
+    other._numHeapFallbacks = 0;
+    other._peakBlocks = 0;
+    other._slabs.clear();
+    other._threadCaches.clear();
+    return *this;
 }
 
 template <typename T>
 ContiguousPoolManager<T>::~ContiguousPoolManager()
 {
+    {
+        //the cached blocks belong to the buffer going away
+        SpinLock::Guard lock(_spinlock);
+        for (auto&& cache : _threadCaches) {
+            cache->_owner = nullptr;
+            cache->_count = 0;
+        }
+    }
     delete[] _freeBlocks;
+    for (auto&& slab : _slabs) {
+        deleteSlab(slab);
+    }
 }
 
 template <typename T>
@@ -125,15 +150,34 @@ typename ContiguousPoolManager<T>::pointer
 ContiguousPoolManager<T>::allocate(size_type n, const_pointer)
 {
     assert(_buffer);
+    if (n == 1) {
+        thread_cache_type* cache = thread_cache_type::instance(this);
+        pointer p;
+        if (cache && cache->pop(p)) {
+            return p;
+        }
+    }
     {
         SpinLock::Guard lock(_spinlock);
         if (findContiguous(static_cast<index_type>(n)))
         {
             _freeBlockIndex -= (n - 1);
-            return reinterpret_cast<pointer>(&_buffer[_freeBlocks[_freeBlockIndex--]]);
+            pointer p = reinterpret_cast<pointer>(&_buffer[_freeBlocks[_freeBlockIndex--]]);
+            updatePeak();
+            return p;
+        }
+        if (n == 1)
+        {
+            pointer p = allocateFromSlab();
+            if (p) {
+                updatePeak();
+                return p;
+            }
         }
         // Use heap allocation
         ++_numHeapAllocatedBlocks;
+        ++_numHeapFallbacks;
+        updatePeak();
     }
     return (pointer)new char[sizeof(value_type)];
 }
@@ -145,12 +189,30 @@ void ContiguousPoolManager<T>::deallocate(pointer p, size_type n)
     if (p == nullptr) {
         return;
     }
+    if (isManaged(p) && (n == 1)) {
+        thread_cache_type* cache = thread_cache_type::instance(this);
+        if (cache) {
+            cache->push(p);
+            return;
+        }
+    }
     if (isManaged(p)) {
         //find index of the block and return the individual blocks to the free pool
         SpinLock::Guard lock(_spinlock);
         for (size_type i = 0; i < n; ++i) {
             _freeBlocks[++_freeBlockIndex] = blockIndex(p+i);
         }
+        return;
+    }
+    Slab released{nullptr, nullptr, 0, -1};
+    bool isSlabBlock = false;
+    {
+        SpinLock::Guard lock(_spinlock);
+        isSlabBlock = deallocateToSlab(p, n, released);
+    }
+    if (isSlabBlock) {
+        //free the slab outside of the lock
+        deleteSlab(released);
     }
     else {
         delete[] (char*)p;
@@ -179,7 +241,8 @@ void ContiguousPoolManager<T>::dispose(pointer p)
 template <typename T>
 size_t ContiguousPoolManager<T>::allocatedBlocks() const
 {
-    return _size ? _size - _freeBlockIndex - 1 : 0;
+    SpinLock::Guard lock(_spinlock);
+    return usedBlocks();
 }
 
 template <typename T>
@@ -188,16 +251,72 @@ size_t ContiguousPoolManager<T>::allocatedHeapBlocks() const
     return _numHeapAllocatedBlocks;
 }
 
+template <typename T>
+size_t ContiguousPoolManager<T>::numSlabs() const
+{
+    SpinLock::Guard lock(_spinlock);
+    return _slabs.size();
+}
+
+template <typename T>
+void ContiguousPoolManager<T>::releaseUnusedSlabs()
+{
+    std::vector<Slab> released;
+    {
+        SpinLock::Guard lock(_spinlock);
+        auto it = std::stable_partition(_slabs.begin(), _slabs.end(), [](const Slab& slab)->bool {
+            return !isUnused(slab);
+        });
+        released.assign(it, _slabs.end());
+        _slabs.erase(it, _slabs.end());
+    }
+    for (auto&& slab : released) {
+        deleteSlab(slab);
+    }
+}
+
+template <typename T>
+PoolStatistics ContiguousPoolManager<T>::stats() const
+{
+    SpinLock::Guard lock(_spinlock);
+    size_t inUse = usedBlocks() + _numHeapAllocatedBlocks;
+    return PoolStatistics(capacity(),
+                          inUse,
+                          std::max(_peakBlocks, inUse),
+                          _numHeapFallbacks,
+                          _slabs.size(),
+                          _spinlock.contentionCount());
+}
+
+template <typename T>
+void ContiguousPoolManager<T>::warmUp()
+{
+    //write to the free blocks so that their pages are committed. Blocks in use are left alone.
+    SpinLock::Guard lock(_spinlock);
+    for (ssize_t i = 0; i <= _freeBlockIndex; ++i) {
+        memset(&_buffer[_freeBlocks[i]], 0, sizeof(aligned_type));
+    }
+    for (auto&& slab : _slabs) {
+        for (ssize_t i = 0; i <= slab._freeBlockIndex; ++i) {
+            memset(&slab._buffer[slab._freeBlocks[i]], 0, sizeof(aligned_type));
+        }
+    }
+}
+
 template <typename T>
 bool ContiguousPoolManager<T>::isFull() const
 {
-    return _freeBlockIndex == _size-1;
+    SpinLock::Guard lock(_spinlock);
+    return ((_freeBlockIndex + 1 + (ssize_t)numCachedBlocks()) == _size) &&
+           std::all_of(_slabs.begin(), _slabs.end(), [](const Slab& slab)->bool { return isUnused(slab); });
 }
 
 template <typename T>
 bool ContiguousPoolManager<T>::isEmpty() const
 {
-    return _freeBlockIndex == -1;
+    SpinLock::Guard lock(_spinlock);
+    return (_freeBlockIndex == -1) && (numCachedBlocks() == 0) &&
+           std::all_of(_slabs.begin(), _slabs.end(), [](const Slab& slab)->bool { return slab._freeBlockIndex == -1; });
 }
 
 template <typename T>
@@ -241,5 +360,161 @@ bool ContiguousPoolManager<T>::findContiguous(index_type n)
     return found;
 }
 
+template <typename T>
+typename ContiguousPoolManager<T>::pointer ContiguousPoolManager<T>::allocateFromSlab()
+{
+    //called with the spinlock held. The newest slabs are the largest ones.
+    for (auto it = _slabs.rbegin(); it != _slabs.rend(); ++it) {
+        if (it->_freeBlockIndex >= 0) {
+            return reinterpret_cast<pointer>(&it->_buffer[it->_freeBlocks[it->_freeBlockIndex--]]);
+        }
+    }
+    if (_slabs.size() >= AllocatorTraits::maxPoolSlabs()) {
+        return nullptr;
+    }
+    //double the capacity so that the number of slabs stays logarithmic
+    index_type size = static_cast<index_type>(std::min<size_t>(std::max<size_t>(capacity(), 1),
+                                                               std::numeric_limits<index_type>::max()));
+    Slab slab{nullptr, nullptr, size, size-1};
+    slab._buffer = new aligned_type[size];
+    slab._freeBlocks = new (std::nothrow) index_type[size];
+    if (!slab._freeBlocks) {
+        delete[] slab._buffer;
+        throw std::bad_alloc();
+    }
+    //build the free stack
+    for (index_type i = 0; i < size; ++i) {
+        slab._freeBlocks[i] = i;
+    }
+    _slabs.push_back(slab);
+    Slab& last = _slabs.back();
+    return reinterpret_cast<pointer>(&last._buffer[last._freeBlocks[last._freeBlockIndex--]]);
+}
+
+template <typename T>
+bool ContiguousPoolManager<T>::deallocateToSlab(pointer p, size_type n, Slab& released)
+{
+    //called with the spinlock held
+    for (auto it = _slabs.begin(); it != _slabs.end(); ++it) {
+        if (!isManaged(*it, p)) {
+            continue;
+        }
+        for (size_type i = 0; i < n; ++i) {
+            it->_freeBlocks[++it->_freeBlockIndex] =
+                static_cast<index_type>(reinterpret_cast<aligned_type*>(p+i) - it->_buffer);
+        }
+        if (isUnused(*it) &&
+            ((size_t)std::count_if(_slabs.begin(), _slabs.end(), isUnused) > AllocatorTraits::poolSpareSlabs())) {
+            //give this slab back. The caller frees it outside of the lock.
+            released = *it;
+            _slabs.erase(it);
+        }
+        return true;
+    }
+    return false;
+}
+
+template <typename T>
+bool ContiguousPoolManager<T>::isManaged(const Slab& slab, pointer p)
+{
+    return (reinterpret_cast<pointer>(slab._buffer) <= p) && (p < reinterpret_cast<pointer>(slab._buffer + slab._size));
+}
+
+template <typename T>
+bool ContiguousPoolManager<T>::isUnused(const Slab& slab)
+{
+    return slab._freeBlockIndex == (ssize_t)slab._size-1;
+}
+
+template <typename T>
+void ContiguousPoolManager<T>::attachThreadCache(thread_cache_type& cache)
+{
+    SpinLock::Guard lock(_spinlock);
+    _threadCaches.push_back(&cache);
+    cache._owner = this;
+}
+
+template <typename T>
+void ContiguousPoolManager<T>::detachThreadCache(thread_cache_type& cache)
+{
+    SpinLock::Guard lock(_spinlock);
+    while (cache._count > 0) {
+        _freeBlocks[++_freeBlockIndex] = blockIndex(cache._blocks[--cache._count]);
+    }
+    _threadCaches.erase(std::find(_threadCaches.begin(), _threadCaches.end(), &cache));
+    cache._owner = nullptr;
+}
+
+template <typename T>
+size_t ContiguousPoolManager<T>::refillThreadCache(thread_cache_type& cache)
+{
+    SpinLock::Guard lock(_spinlock);
+    //the cache is empty so every block this thread handed out is accounted for
+    updatePeak();
+    size_t num = std::min<size_t>(thread_cache_type::BatchSize, _freeBlockIndex + 1);
+    for (size_t i = 0; i < num; ++i) {
+        cache._blocks[cache._count++] = reinterpret_cast<pointer>(&_buffer[_freeBlocks[_freeBlockIndex--]]);
+    }
+    return num;
+}
+
+template <typename T>
+void ContiguousPoolManager<T>::flushThreadCache(thread_cache_type& cache, size_t num)
+{
+    SpinLock::Guard lock(_spinlock);
+    for (size_t i = 0; i < num; ++i) {
+        _freeBlocks[++_freeBlockIndex] = blockIndex(cache._blocks[--cache._count]);
+    }
+}
+
+template <typename T>
+size_t ContiguousPoolManager<T>::numCachedBlocks() const
+{
+    //called with the spinlock held
+    size_t num = 0;
+    for (auto&& cache : _threadCaches) {
+        num += cache->_count;
+    }
+    return num;
+}
+
+template <typename T>
+size_t ContiguousPoolManager<T>::usedBlocks() const
+{
+    //called with the spinlock held. Cached blocks count as free.
+    size_t numBlocks = _size ? _size - _freeBlockIndex - 1 - numCachedBlocks() : 0;
+    for (auto&& slab : _slabs) {
+        numBlocks += slab._size - slab._freeBlockIndex - 1;
+    }
+    return numBlocks;
+}
+
+template <typename T>
+size_t ContiguousPoolManager<T>::capacity() const
+{
+    //called with the spinlock held
+    size_t capacity = _size;
+    for (auto&& slab : _slabs) {
+        capacity += slab._size;
+    }
+    return capacity;
+}
+
+template <typename T>
+void ContiguousPoolManager<T>::updatePeak()
+{
+    //called with the spinlock held
+    _peakBlocks = std::max(_peakBlocks, usedBlocks() + _numHeapAllocatedBlocks);
+}
+
+template <typename T>
+void ContiguousPoolManager<T>::deleteSlab(Slab& slab)
+{
+    delete[] slab._buffer;
+    delete[] slab._freeBlocks;
+    slab._buffer = nullptr;
+    slab._freeBlocks = nullptr;
+}
+
 }}
 
@@ -0,0 +1,102 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                 class CoroLocal
+//==============================================================================================
+template <class T>
+CoroLocal<T>::CoroLocal(bool isInheritedByChildren) :
+    _index(CoroLocalStorage::registerSlot()),
+    _isInheritedByChildren(isInheritedByChildren)
+{}
+
+template <class T>
+size_t CoroLocal<T>::index() const
+{
+    return _index;
+}
+
+template <class T>
+bool CoroLocal<T>::isInheritedByChildren() const
+{
+    return _isInheritedByChildren;
+}
+
+//==============================================================================================
+//                                 class CoroLocalStorage
+//==============================================================================================
+inline
+size_t CoroLocalStorage::registerSlot()
+{
+    static std::atomic_size_t nextIndex{0};
+    return nextIndex++;
+}
+
+inline
+CoroLocalStorage::Ptr CoroLocalStorage::inherit(const Ptr& parent)
+{
+    if (!parent || (parent->_numInherited == 0))
+    {
+        return nullptr;
+    }
+    Ptr storage = std::make_shared<CoroLocalStorage>();
+    storage->_slots.resize(parent->_slots.size());
+    for (size_t i = 0; i < parent->_slots.size(); ++i)
+    {
+        if (parent->_slots[i]._isInherited)
+        {
+            storage->_slots[i] = parent->_slots[i];
+        }
+    }
+    storage->_numInherited = parent->_numInherited;
+    return storage;
+}
+
+inline
+void* CoroLocalStorage::get(size_t index) const
+{
+    return (index < _slots.size()) ? _slots[index]._value.get() : nullptr;
+}
+
+inline
+void CoroLocalStorage::set(size_t index, std::shared_ptr<void> value, bool isInherited)
+{
+    if (index >= _slots.size())
+    {
+        _slots.resize(index + 1);
+    }
+    Slot& slot = _slots[index];
+    if (slot._isInherited)
+    {
+        --_numInherited;
+    }
+    slot._isInherited = (value != nullptr) && isInherited;
+    if (slot._isInherited)
+    {
+        ++_numInherited;
+    }
+    slot._value = std::move(value);
+}
+
+}}
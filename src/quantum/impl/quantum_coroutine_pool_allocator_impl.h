@@ -16,7 +16,9 @@
 //NOTE: DO NOT INCLUDE DIRECTLY
 #include <type_traits>
 #include <algorithm>
+#include <cstring>
 #include <assert.h>
+#include <sys/mman.h>
 
 #if defined(BOOST_USE_VALGRIND)
     #include <valgrind/valgrind.h>
@@ -29,13 +31,19 @@ namespace Bloomberg {
 namespace quantum {
 
 template <typename STACK_TRAITS>
-CoroutinePoolAllocator<STACK_TRAITS>::CoroutinePoolAllocator(index_type size) :
+CoroutinePoolAllocator<STACK_TRAITS>::CoroutinePoolAllocator(index_type size, size_t stackSize) :
     _size(size),
     _blocks(new Header*[size]),
     _freeBlocks(new index_type[size]),
     _freeBlockIndex(size-1),
     _numHeapAllocatedBlocks(0),
-    _stackSize(std::min(std::max(traits::default_size(), traits::minimum_size()), traits::maximum_size()))
+    _numHeapFallbacks(0),
+    _peakBlocks(0),
+    _stackSize(std::min(std::max(stackSize ? stackSize : traits::default_size(), traits::minimum_size()), traits::maximum_size())),
+    _useMmap(AllocatorTraits::useMmapCoroStacks()),
+    _pageSize(traits::page_size()),
+    _residentSize(AllocatorTraits::coroStackResidentSize()),
+    _paintStacks(AllocatorTraits::paintCoroStacks())
 {
     if (!_blocks || !_freeBlocks) {
         throw std::bad_alloc();
@@ -43,13 +51,12 @@ CoroutinePoolAllocator<STACK_TRAITS>::CoroutinePoolAllocator(index_type size) :
     if (_size == 0) {
         throw std::runtime_error("Invalid coroutine allocator pool size");
     }
+    //keep the stack pointer aligned. Mappings are made of whole pages.
+    size_t alignment = _useMmap ? _pageSize : alignof(std::max_align_t);
+    _stackSize = ((_stackSize + alignment - 1) / alignment) * alignment;
     //pre-allocate all the coroutine stack blocks
     for (index_type i = 0; i < size; ++i) {
-        _blocks[i] = reinterpret_cast<Header*>(new char[_stackSize]);
-        if (!_blocks[i]) {
-            throw std::bad_alloc();
-        }
-        _blocks[i]->_pos = i; //mark position
+        _blocks[i] = allocateStack(i, nullptr);
     }
     //initialize the free block list
     for (index_type i = 0; i < size; ++i) {
@@ -71,50 +78,87 @@ CoroutinePoolAllocator<STACK_TRAITS>& CoroutinePoolAllocator<STACK_TRAITS>::oper
     _freeBlocks = other._freeBlocks;
     _freeBlockIndex = other._freeBlockIndex;
     _numHeapAllocatedBlocks = other._numHeapAllocatedBlocks;
+    _numHeapFallbacks = other._numHeapFallbacks;
+    _peakBlocks = other._peakBlocks;
+    _stackSize = other._stackSize;
+    _useMmap = other._useMmap;
+    _pageSize = other._pageSize;
+    _residentSize = other._residentSize;
+    _paintStacks = other._paintStacks;
+    _stackUsage = other._stackUsage;
+    _slabs = std::move(other._slabs);
     
     // Reset other
     other._blocks = nullptr;
     other._freeBlocks = nullptr;
     other._freeBlockIndex = -1;
     other._numHeapAllocatedBlocks = 0;
+    other._numHeapFallbacks = 0;
+    other._peakBlocks = 0;
 }
 
 template <typename STACK_TRAITS>
 CoroutinePoolAllocator<STACK_TRAITS>::~CoroutinePoolAllocator()
 {
+    {
+        //the cached stacks are deleted below
+        SpinLock::Guard lock(_spinlock);
+        for (auto&& cache : _threadCaches) {
+            cache->_owner = nullptr;
+            cache->_count = 0;
+        }
+    }
     for (size_t i = 0; i < _size; ++i) {
-        delete[] (char*)_blocks[i];
+        deallocateStack(_blocks[i]);
     }
     delete[] _blocks;
     delete[] _freeBlocks;
+    for (auto&& slab : _slabs) {
+        deleteSlab(slab);
+    }
 }
 
 template <typename STACK_TRAITS>
 boost::context::stack_context CoroutinePoolAllocator<STACK_TRAITS>::allocate() {
     boost::context::stack_context ctx;
     Header* block = nullptr;
+    size_t growBy = 0;
+    thread_cache_type* cache = thread_cache_type::instance(this);
+    if (!cache || !cache->pop(block))
     {
         SpinLock::Guard lock(_spinlock);
-        if (!isEmpty())
+        if (_freeBlockIndex >= 0)
         {
             block = _blocks[_freeBlocks[_freeBlockIndex--]];
         }
+        else
+        {
+            block = allocateFromSlab();
+            if (!block && (_slabs.size() < AllocatorTraits::maxPoolSlabs()))
+            {
+                //double the capacity so that the number of slabs stays logarithmic
+                growBy = capacity();
+            }
+        }
+        if (block) {
+            updatePeak();
+        }
+    }
+    if (!block && growBy) {
+        block = growAndAllocate(growBy);
     }
     if (!block) {
         // Use heap allocation
-        block = (Header*)new char[_stackSize];
-        if (!block) {
-            throw std::bad_alloc();
-        }
-        block->_pos = -1; //mark position as non-managed
+        block = allocateStack(-1, nullptr); //mark position as non-managed
         SpinLock::Guard lock(_spinlock);
         ++_numHeapAllocatedBlocks;
+        ++_numHeapFallbacks;
+        updatePeak();
     }
-    char* block_start = reinterpret_cast<char*>(block) + sizeof(Header);
     ctx.size = _stackSize - sizeof(Header);
-    ctx.sp = block_start + ctx.size;
+    ctx.sp = block; //the stack grows down from its header
     #if defined(BOOST_USE_VALGRIND)
-        ctx.valgrind_stack_id = VALGRIND_STACK_REGISTER(ctx.sp, block_start);
+        ctx.valgrind_stack_id = VALGRIND_STACK_REGISTER(ctx.sp, stackBottom(block));
     #endif
     return ctx;
 }
@@ -127,13 +171,47 @@ void CoroutinePoolAllocator<STACK_TRAITS>::deallocate(const boost::context::stac
 #if defined(BOOST_USE_VALGRIND)
     VALGRIND_STACK_DEREGISTER(ctx.valgrind_stack_id);
 #endif
+    Header* header = getHeader(ctx);
+    if (_paintStacks) {
+        _stackUsage.add(measureStack(header));
+    }
     if (isManaged(ctx)) {
+        trimStack(header);
+    }
+    if (isManaged(ctx) && !header->_slab) {
+        thread_cache_type* cache = thread_cache_type::instance(this);
+        if (cache) {
+            cache->push(header);
+            return;
+        }
         //find index of the block
         SpinLock::Guard lock(_spinlock);
         _freeBlocks[++_freeBlockIndex] = blockIndex(ctx);
     }
+    else if (isManaged(ctx)) {
+        std::list<Slab> released;
+        {
+            SpinLock::Guard lock(_spinlock);
+            Slab* slab = header->_slab;
+            slab->_freeBlocks[++slab->_freeBlockIndex] = blockIndex(ctx);
+            if (isUnused(*slab) &&
+                ((size_t)std::count_if(_slabs.begin(), _slabs.end(), isUnused) > AllocatorTraits::poolSpareSlabs())) {
+                //give this slab back
+                for (auto it = _slabs.begin(); it != _slabs.end(); ++it) {
+                    if (&*it == slab) {
+                        released.splice(released.end(), _slabs, it);
+                        break;
+                    }
+                }
+            }
+        }
+        //free the stacks outside of the lock
+        for (auto&& slab : released) {
+            deleteSlab(slab);
+        }
+    }
     else {
-        delete[] (char*)getHeader(ctx);
+        deallocateStack(header);
         SpinLock::Guard lock(_spinlock);
         --_numHeapAllocatedBlocks;
         assert(_numHeapAllocatedBlocks >= 0);
@@ -143,7 +221,8 @@ void CoroutinePoolAllocator<STACK_TRAITS>::deallocate(const boost::context::stac
 template <typename STACK_TRAITS>
 size_t CoroutinePoolAllocator<STACK_TRAITS>::allocatedBlocks() const
 {
-    return _size - _freeBlockIndex - 1;
+    SpinLock::Guard lock(_spinlock);
+    return usedBlocks();
 }
 
 template <typename STACK_TRAITS>
@@ -152,23 +231,82 @@ size_t CoroutinePoolAllocator<STACK_TRAITS>::allocatedHeapBlocks() const
     return _numHeapAllocatedBlocks;
 }
 
+template <typename STACK_TRAITS>
+size_t CoroutinePoolAllocator<STACK_TRAITS>::numSlabs() const
+{
+    SpinLock::Guard lock(_spinlock);
+    return _slabs.size();
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::releaseUnusedSlabs()
+{
+    std::list<Slab> released;
+    {
+        SpinLock::Guard lock(_spinlock);
+        for (auto it = _slabs.begin(); it != _slabs.end();) {
+            auto next = std::next(it);
+            if (isUnused(*it)) {
+                released.splice(released.end(), _slabs, it);
+            }
+            it = next;
+        }
+    }
+    for (auto&& slab : released) {
+        deleteSlab(slab);
+    }
+}
+
+template <typename STACK_TRAITS>
+PoolStatistics CoroutinePoolAllocator<STACK_TRAITS>::stats() const
+{
+    SpinLock::Guard lock(_spinlock);
+    size_t inUse = usedBlocks() + _numHeapAllocatedBlocks;
+    return PoolStatistics(capacity(),
+                          inUse,
+                          std::max(_peakBlocks, inUse),
+                          _numHeapFallbacks,
+                          _slabs.size(),
+                          _spinlock.contentionCount(),
+                          _stackUsage);
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::warmUp()
+{
+    //stacks in use are left alone
+    SpinLock::Guard lock(_spinlock);
+    for (ssize_t i = 0; i <= _freeBlockIndex; ++i) {
+        warmUpStack(_blocks[_freeBlocks[i]]);
+    }
+    for (auto&& slab : _slabs) {
+        for (ssize_t i = 0; i <= slab._freeBlockIndex; ++i) {
+            warmUpStack(slab._blocks[slab._freeBlocks[i]]);
+        }
+    }
+}
+
 template <typename STACK_TRAITS>
 bool CoroutinePoolAllocator<STACK_TRAITS>::isFull() const
 {
-    return _freeBlockIndex == _size-1;
+    SpinLock::Guard lock(_spinlock);
+    return ((_freeBlockIndex + 1 + (ssize_t)numCachedBlocks()) == _size) &&
+           std::all_of(_slabs.begin(), _slabs.end(), isUnused);
 }
 
 template <typename STACK_TRAITS>
 bool CoroutinePoolAllocator<STACK_TRAITS>::isEmpty() const
 {
-    return _freeBlockIndex == -1;
+    SpinLock::Guard lock(_spinlock);
+    return (_freeBlockIndex == -1) && (numCachedBlocks() == 0) &&
+           std::all_of(_slabs.begin(), _slabs.end(), [](const Slab& slab)->bool { return slab._freeBlockIndex == -1; });
 }
 
 template <typename STACK_TRAITS>
 typename CoroutinePoolAllocator<STACK_TRAITS>::Header*
 CoroutinePoolAllocator<STACK_TRAITS>::getHeader(const boost::context::stack_context& ctx) const
 {
-    return reinterpret_cast<Header*>(reinterpret_cast<char*>(ctx.sp) - ctx.size - sizeof(Header));
+    return reinterpret_cast<Header*>(ctx.sp);
 }
 
 template <typename STACK_TRAITS>
@@ -183,4 +321,248 @@ int CoroutinePoolAllocator<STACK_TRAITS>::blockIndex(const boost::context::stack
     return getHeader(ctx)->_pos;
 }
 
+template <typename STACK_TRAITS>
+typename CoroutinePoolAllocator<STACK_TRAITS>::Header*
+CoroutinePoolAllocator<STACK_TRAITS>::allocateStack(int pos, Slab* slab)
+{
+    char* bottom = nullptr;
+    if (_useMmap) {
+        //the guard page sits below the stack. Pages are committed as the stack grows down.
+        void* base = ::mmap(nullptr, _pageSize + _stackSize, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (base == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        if (::mprotect(base, _pageSize, PROT_NONE) != 0) {
+            ::munmap(base, _pageSize + _stackSize);
+            throw std::bad_alloc();
+        }
+        bottom = static_cast<char*>(base) + _pageSize;
+#ifdef MADV_HUGEPAGE
+        if (AllocatorTraits::useHugePagesForCoroStacks()) {
+            ::madvise(bottom, _stackSize, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    else {
+        bottom = new char[_stackSize];
+    }
+    Header* header = reinterpret_cast<Header*>(bottom + _stackSize - sizeof(Header));
+    if (_paintStacks) {
+        paintStack(bottom, reinterpret_cast<char*>(header));
+    }
+    header->_pos = pos;
+    header->_slab = slab;
+    return header;
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::deallocateStack(Header* header)
+{
+    if (_useMmap) {
+        ::munmap(stackBottom(header) - _pageSize, _pageSize + _stackSize);
+    }
+    else {
+        delete[] stackBottom(header);
+    }
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::trimStack(Header* header)
+{
+    if (!_useMmap || (_residentSize == 0) || _paintStacks) {
+        //painted stacks must keep their pattern
+        return;
+    }
+    //keep the top pages, which hold the header, and give back the rest
+    size_t residentSize = std::max(_residentSize, _pageSize);
+    if (residentSize >= _stackSize) {
+        return;
+    }
+    size_t trimSize = ((_stackSize - residentSize) / _pageSize) * _pageSize;
+    if (trimSize > 0) {
+        ::madvise(stackBottom(header), trimSize, MADV_DONTNEED);
+    }
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::warmUpStack(Header* header)
+{
+    //commit the pages a coroutine is most likely to touch, i.e. the ones kept by trimStack()
+    size_t warmSize = _residentSize ? std::min(std::max(_residentSize, _pageSize), _stackSize) : _stackSize;
+    char* top = reinterpret_cast<char*>(header) + sizeof(Header);
+    if (_paintStacks) {
+        paintStack(top - warmSize, reinterpret_cast<char*>(header));
+        return;
+    }
+    memset(top - warmSize, 0, warmSize - sizeof(Header));
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::paintStack(char* from, char* to)
+{
+    memset(from, 0xCD, to - from);
+}
+
+template <typename STACK_TRAITS>
+size_t CoroutinePoolAllocator<STACK_TRAITS>::measureStack(Header* header)
+{
+    //the stack grows down from its header so the first overwritten word from the bottom is the deepest one.
+    //the stack size is aligned to the word size.
+    uint64_t pattern;
+    memset(&pattern, 0xCD, sizeof(pattern));
+    const uint64_t* word = reinterpret_cast<const uint64_t*>(stackBottom(header));
+    const uint64_t* top = reinterpret_cast<const uint64_t*>(header);
+    while ((word != top) && (*word == pattern)) {
+        ++word;
+    }
+    //repaint the used part only so that the stack is ready for its next coroutine
+    paintStack((char*)word, (char*)top);
+    return (top - word) * sizeof(uint64_t);
+}
+
+template <typename STACK_TRAITS>
+char* CoroutinePoolAllocator<STACK_TRAITS>::stackBottom(Header* header) const
+{
+    return reinterpret_cast<char*>(header) + sizeof(Header) - _stackSize;
+}
+
+template <typename STACK_TRAITS>
+typename CoroutinePoolAllocator<STACK_TRAITS>::Header*
+CoroutinePoolAllocator<STACK_TRAITS>::allocateFromSlab()
+{
+    //called with the spinlock held. The newest slabs are the largest ones.
+    for (auto it = _slabs.rbegin(); it != _slabs.rend(); ++it) {
+        if (it->_freeBlockIndex >= 0) {
+            return it->_blocks[it->_freeBlocks[it->_freeBlockIndex--]];
+        }
+    }
+    return nullptr;
+}
+
+template <typename STACK_TRAITS>
+typename CoroutinePoolAllocator<STACK_TRAITS>::Header*
+CoroutinePoolAllocator<STACK_TRAITS>::growAndAllocate(size_t size)
+{
+    //allocate the stacks outside of the lock then publish the slab
+    std::list<Slab> grown(1);
+    makeSlab(grown.front(), size);
+    Slab& slab = grown.front();
+    SpinLock::Guard lock(_spinlock);
+    Header* block = slab._blocks[slab._freeBlocks[slab._freeBlockIndex--]];
+    _slabs.splice(_slabs.end(), grown);
+    updatePeak();
+    return block;
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::makeSlab(Slab& slab, size_t size)
+{
+    slab._size = static_cast<index_type>(std::min<size_t>(size, std::numeric_limits<int>::max()));
+    slab._blocks = new Header*[slab._size];
+    slab._freeBlocks = new index_type[slab._size];
+    slab._freeBlockIndex = slab._size-1;
+    for (index_type i = 0; i < slab._size; ++i) {
+        slab._blocks[i] = allocateStack(i, &slab);
+        slab._freeBlocks[i] = i;
+    }
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::deleteSlab(Slab& slab)
+{
+    for (index_type i = 0; i < slab._size; ++i) {
+        deallocateStack(slab._blocks[i]);
+    }
+    delete[] slab._blocks;
+    delete[] slab._freeBlocks;
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::attachThreadCache(thread_cache_type& cache)
+{
+    SpinLock::Guard lock(_spinlock);
+    _threadCaches.push_back(&cache);
+    cache._owner = this;
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::detachThreadCache(thread_cache_type& cache)
+{
+    SpinLock::Guard lock(_spinlock);
+    while (cache._count > 0) {
+        _freeBlocks[++_freeBlockIndex] = cache._blocks[--cache._count]->_pos;
+    }
+    _threadCaches.erase(std::find(_threadCaches.begin(), _threadCaches.end(), &cache));
+    cache._owner = nullptr;
+}
+
+template <typename STACK_TRAITS>
+size_t CoroutinePoolAllocator<STACK_TRAITS>::refillThreadCache(thread_cache_type& cache)
+{
+    SpinLock::Guard lock(_spinlock);
+    //the cache is empty so every stack this thread handed out is accounted for
+    updatePeak();
+    size_t num = std::min<size_t>(thread_cache_type::BatchSize, _freeBlockIndex + 1);
+    for (size_t i = 0; i < num; ++i) {
+        cache._blocks[cache._count++] = _blocks[_freeBlocks[_freeBlockIndex--]];
+    }
+    return num;
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::flushThreadCache(thread_cache_type& cache, size_t num)
+{
+    SpinLock::Guard lock(_spinlock);
+    for (size_t i = 0; i < num; ++i) {
+        _freeBlocks[++_freeBlockIndex] = cache._blocks[--cache._count]->_pos;
+    }
+}
+
+template <typename STACK_TRAITS>
+size_t CoroutinePoolAllocator<STACK_TRAITS>::numCachedBlocks() const
+{
+    //called with the spinlock held
+    size_t num = 0;
+    for (auto&& cache : _threadCaches) {
+        num += cache->_count;
+    }
+    return num;
+}
+
+template <typename STACK_TRAITS>
+size_t CoroutinePoolAllocator<STACK_TRAITS>::usedBlocks() const
+{
+    //called with the spinlock held. Cached stacks count as free.
+    size_t numBlocks = _size - _freeBlockIndex - 1 - numCachedBlocks();
+    for (auto&& slab : _slabs) {
+        numBlocks += slab._size - slab._freeBlockIndex - 1;
+    }
+    return numBlocks;
+}
+
+template <typename STACK_TRAITS>
+size_t CoroutinePoolAllocator<STACK_TRAITS>::capacity() const
+{
+    //called with the spinlock held
+    size_t capacity = _size;
+    for (auto&& slab : _slabs) {
+        capacity += slab._size;
+    }
+    return capacity;
+}
+
+template <typename STACK_TRAITS>
+void CoroutinePoolAllocator<STACK_TRAITS>::updatePeak()
+{
+    //called with the spinlock held
+    _peakBlocks = std::max(_peakBlocks, usedBlocks() + _numHeapAllocatedBlocks);
+}
+
+template <typename STACK_TRAITS>
+bool CoroutinePoolAllocator<STACK_TRAITS>::isUnused(const Slab& slab)
+{
+    return slab._freeBlockIndex == (ssize_t)slab._size-1;
+}
+
 }}
@@ -27,12 +27,39 @@ DispatcherCore::DispatcherCore(int numCoroutineThreads,
                                int numIoThreads,
                                bool pinCoroutineThreadsToCores) :
     _coroQueues((numCoroutineThreads == -1) ? std::thread::hardware_concurrency() :
-                (numCoroutineThreads == 0) ? 1 : numCoroutineThreads),
-    _sharedIoQueues((numIoThreads <= 0) ? 1 : numIoThreads),
-    _ioQueues((numIoThreads <= 0) ? 1 : numIoThreads, IoQueue(Configuration(), &_sharedIoQueues)),
+                (numCoroutineThreads == 0) ? 1 : numCoroutineThreads, TaskQueue(Configuration(), &_taskCounter, false)),
+    _sharedIoQueues((numIoThreads <= 0) ? 1 : numIoThreads, IoQueue(Configuration(), nullptr, false, &_taskCounter)),
+    _ioQueues((numIoThreads <= 0) ? 1 : numIoThreads, IoQueue(Configuration(), &_sharedIoQueues, false, &_taskCounter, false)),
     _loadBalanceSharedIoQueues(false),
+    _queueSelectionPolicy(Configuration::QueueSelectionPolicy::Shortest),
+    _nextQueueIndex(0),
+    _numManualCoroQueues(0),
+    _numAnyCoroQueues(_coroQueues.size()),
+    _isLazyThreadStart(false),
+    _areIoQueuesStarted(true),
+    _maxNumElasticIoQueues(0),
+    _ioGrowthBacklog(0),
+    _queueStallThresholdMs(0),
+    _blockedCoroutineThresholdMs(0),
+    _admissionPolicy(Configuration::AdmissionPolicy::Unbounded),
+    _hasQueueWatermarks(false),
+    _globalHighWatermark(0),
+    _globalLowWatermark(0),
+    _isGloballySaturated(false),
+    _pumpingThreadId(std::thread::id()),
+    _samplingProfilerIntervalUs(0),
+    _numProfileSamples(0),
     _terminated(ATOMIC_FLAG_INIT)
 {
+    //The queues are created in place without threads
+    for (auto&& queue : _coroQueues)
+    {
+        queue.start();
+    }
+    for (auto&& queue : _ioQueues)
+    {
+        queue.start();
+    }
     if (pinCoroutineThreadsToCores)
     {
         unsigned int cores = std::thread::hardware_concurrency();
@@ -46,13 +73,60 @@ DispatcherCore::DispatcherCore(int numCoroutineThreads,
 inline
 DispatcherCore::DispatcherCore(const Configuration& config) :
     _coroQueues((config.getNumCoroutineThreads() == -1) ? std::thread::hardware_concurrency() :
-                (config.getNumCoroutineThreads() == 0) ? 1 : config.getNumCoroutineThreads(), TaskQueue(config)),
-    _sharedIoQueues((config.getNumIoThreads() <= 0) ? 1 : config.getNumIoThreads(), IoQueue(config, nullptr)),
-    _ioQueues((config.getNumIoThreads() <= 0) ? 1 : config.getNumIoThreads(), IoQueue(config, &_sharedIoQueues)),
-    _loadBalanceSharedIoQueues(false),
+                (config.getNumCoroutineThreads() == 0) ? 1 : config.getNumCoroutineThreads(), TaskQueue(config, &_taskCounter, false)),
+    _sharedIoQueues((config.getNumIoThreads() <= 0) ? 1 : config.getNumIoThreads(), IoQueue(config, nullptr, false, &_taskCounter)),
+    _ioQueues((config.getNumIoThreads() <= 0) ? 1 : config.getNumIoThreads(), IoQueue(config, &_sharedIoQueues, false, &_taskCounter, false)),
+    _loadBalanceSharedIoQueues(config.getLoadBalanceSharedIoQueues()),
+    _queueSelectionPolicy(config.getCoroutineQueueSelectionPolicy()),
+    _nextQueueIndex(0),
+    _numManualCoroQueues(std::min(_coroQueues.size(), (size_t)std::max(config.getNumManualCoroutineQueues(), 0))),
+    _numAnyCoroQueues(_coroQueues.size() - _numManualCoroQueues),
+    _isLazyThreadStart(config.getLazyThreadStart()),
+    _areIoQueuesStarted(!_isLazyThreadStart),
+    _ioConfig(config),
+    _maxNumElasticIoQueues((config.getMaxNumIoThreads() > (int)_ioQueues.size()) ?
+                           config.getMaxNumIoThreads() - _ioQueues.size() : 0),
+    _ioGrowthBacklog(config.getIoThreadGrowthBacklog()),
+    _queueStallThresholdMs(config.getQueueStallThresholdMs()),
+    _blockedCoroutineThresholdMs(config.getBlockedCoroutineThresholdMs()),
+    _stallCallback(config.getStallCallback()),
+    _detachedErrorCallback(config.getDetachedErrorCallback()),
+    _admissionPolicy(config.getAdmissionPolicy()),
+    _hasQueueWatermarks(config.getQueueHighWatermark() > 0),
+    _globalHighWatermark(config.getGlobalHighWatermark()),
+    _globalLowWatermark(config.getGlobalLowWatermark()),
+    _isGloballySaturated(false),
+    _pumpingThreadId(std::thread::id()),
+    _samplingProfilerIntervalUs(config.getSamplingProfilerIntervalUs()),
+    _numProfileSamples(0),
     _terminated(ATOMIC_FLAG_INIT)
 {
-    if (config.getPinCoroutineThreadsToCores())
+    //The queues are created in place without threads. The manual ones are left as is and the others
+    //are started here unless they are started on demand.
+    if (!_isLazyThreadStart)
+    {
+        for (size_t i = 0; i < _numAnyCoroQueues; ++i)
+        {
+            _coroQueues[i].start();
+        }
+        for (auto&& queue : _ioQueues)
+        {
+            queue.start();
+        }
+    }
+    if (_numAnyCoroQueues == 0)
+    {
+        _numAnyCoroQueues = _coroQueues.size(); //all the queues are manual
+    }
+    if (_globalHighWatermark > 0)
+    {
+        _taskCounter.setLowWatermark(_globalLowWatermark);
+    }
+    if (!config.getCoroutineCpuSets().empty())
+    {
+        setCoroutineCpuSets(config.getCoroutineCpuSets());
+    }
+    else if (config.getPinCoroutineThreadsToCores())
     {
         unsigned int cores = std::thread::hardware_concurrency();
         for (size_t i = 0; i < _coroQueues.size(); ++i)
@@ -60,6 +134,31 @@ DispatcherCore::DispatcherCore(const Configuration& config) :
             _coroQueues[i].pinToCore(i%cores);
         }
     }
+    if (!config.getIoCpuSets().empty())
+    {
+        pinToCpuSets(_ioQueues, config.getIoCpuSets());
+    }
+    if (config.getCoroutineWorkStealing() || config.getCoroutineMigration())
+    {
+        //Siblings are only made visible once all the queues have been constructed
+        for (auto&& queue : _coroQueues)
+        {
+            queue.setSiblingQueues(&_coroQueues);
+        }
+    }
+    if (config.isWatchdogEnabled())
+    {
+        _lastStallCheck = std::chrono::steady_clock::now();
+        _timerQueue.add(_lastStallCheck + config.getWatchdogIntervalMs(),
+                        config.getWatchdogIntervalMs(),
+                        [this]() { checkStalls(); });
+    }
+    if (_samplingProfilerIntervalUs.count() > 0)
+    {
+        _timerQueue.add(std::chrono::steady_clock::now() + _samplingProfilerIntervalUs,
+                        _samplingProfilerIntervalUs,
+                        [this]() { sampleProfile(); });
+    }
 }
 
 inline
@@ -73,6 +172,25 @@ void DispatcherCore::terminate()
 {
     if (!_terminated.test_and_set())
     {
+        _timerQueue.terminate();
+        _reactor.terminate();
+        //Signal all the threads first so that they exit in parallel, then join them
+        for (auto&& queue : _coroQueues)
+        {
+            queue.interrupt();
+        }
+        for (auto&& queue : _ioQueues)
+        {
+            queue.interrupt();
+        }
+        {
+            //========================= LOCKED SCOPE =========================
+            std::lock_guard<std::mutex> lock(_elasticIoMutex);
+            for (auto&& queue : _elasticIoQueues)
+            {
+                queue.interrupt();
+            }
+        }
         for (auto&& queue : _coroQueues)
         {
             queue.terminate();
@@ -85,6 +203,16 @@ void DispatcherCore::terminate()
         {
             queue.terminate();
         }
+        {
+            //========================= LOCKED SCOPE =========================
+            std::lock_guard<std::mutex> lock(_elasticIoMutex);
+            for (auto&& queue : _elasticIoQueues)
+            {
+                queue.terminate();
+            }
+        }
+        //the tasks left in the queues have been discarded
+        _taskCounter.reset();
     }
 }
 
@@ -169,6 +297,12 @@ size_t DispatcherCore::ioSize(int queueId) const
         {
             size += queue.size();
         }
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_elasticIoMutex);
+        for (auto&& queue : _elasticIoQueues)
+        {
+            size += queue.size();
+        }
         return size;
     }
     else if (queueId == (int)IQueue::QueueId::Any)
@@ -178,6 +312,12 @@ size_t DispatcherCore::ioSize(int queueId) const
         {
             size += queue.size();
         }
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_elasticIoMutex);
+        for (auto&& queue : _elasticIoQueues)
+        {
+            size += queue.size();
+        }
         return size;
     }
     return _ioQueues.at(queueId).size();
@@ -202,7 +342,6 @@ bool DispatcherCore::ioEmpty(int queueId) const
                 return false;
             }
         }
-        return true;
     }
     else if (queueId == (int)IQueue::QueueId::Any)
     {
@@ -213,9 +352,21 @@ bool DispatcherCore::ioEmpty(int queueId) const
                 return false;
             }
         }
-        return true;
     }
-    return _ioQueues.at(queueId).empty();
+    else
+    {
+        return _ioQueues.at(queueId).empty();
+    }
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_elasticIoMutex);
+    for (auto&& queue : _elasticIoQueues)
+    {
+        if (!queue.empty())
+        {
+            return false; //still running a shared task
+        }
+    }
+    return true;
 }
 
 inline
@@ -272,6 +423,13 @@ QueueStatistics DispatcherCore::ioStats(int queueId)
         {
             stats += queue.stats();
         }
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_elasticIoMutex);
+        for (auto&& queue : _elasticIoQueues)
+        {
+            stats += queue.stats();
+        }
+        stats += _retiredIoStats;
         return stats;
     }
     else if (queueId == (int)IQueue::QueueId::Any)
@@ -308,6 +466,62 @@ void DispatcherCore::resetStats()
     {
         queue.stats().reset();
     }
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_elasticIoMutex);
+    for (auto&& queue : _elasticIoQueues)
+    {
+        queue.stats().reset();
+    }
+    _retiredIoStats.reset();
+    resetProfile();
+}
+
+inline
+MetricsSnapshot DispatcherCore::metrics()
+{
+    //Only relaxed counters are read so that the workers are never contended
+    MetricsSnapshot snapshot;
+    snapshot._time = std::chrono::steady_clock::now();
+    snapshot._coroQueues.reserve(_coroQueues.size());
+    for (size_t i = 0; i < _coroQueues.size(); ++i)
+    {
+        TaskQueue& queue = _coroQueues[i];
+        const IQueueStatistics& stats = queue.stats();
+        snapshot._coroQueues.push_back({(int)i, queue.size(), queue.getNumBlocked(), stats.postedCount(),
+                                        stats.completedCount() + stats.errorCount(), stats.errorCount(), 0, 0});
+    }
+    //Shared tasks are counted as posted on the shared queues and as completed on the queues which ran them
+    MetricsSnapshot::QueueMetrics& shared = snapshot._sharedIoQueue;
+    auto addShared = [&shared](const IQueueStatistics& stats)
+    {
+        shared._completed += stats.sharedQueueCompletedCount() + stats.sharedQueueErrorCount();
+        shared._errors += stats.sharedQueueErrorCount();
+    };
+    snapshot._ioQueues.reserve(_ioQueues.size());
+    for (size_t i = 0; i < _ioQueues.size(); ++i)
+    {
+        IoQueue& queue = _ioQueues[i];
+        const IQueueStatistics& stats = queue.stats();
+        snapshot._ioQueues.push_back({(int)i, queue.size(), 0, stats.postedCount(),
+                                      stats.completedCount() + stats.errorCount(), stats.errorCount(), 0, 0});
+        addShared(stats);
+    }
+    for (auto&& queue : _sharedIoQueues)
+    {
+        shared._depth += queue.size();
+        shared._posted += queue.stats().postedCount();
+    }
+    {
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_elasticIoMutex);
+        for (auto&& queue : _elasticIoQueues)
+        {
+            shared._depth += queue.size();
+            addShared(queue.stats());
+        }
+        addShared(_retiredIoStats);
+    }
+    return snapshot;
 }
 
 inline
@@ -320,36 +534,215 @@ void DispatcherCore::post(Task::Ptr task)
     
     if (task->getQueueId() == (int)IQueue::QueueId::Any)
     {
-        size_t index = 0;
-        
-        //Insert into the shortest queue or the first empty queue found
-        size_t numTasks = std::numeric_limits<size_t>::max();
-        for (size_t i = 0; i < _coroQueues.size(); ++i)
+        task->setQueueId(selectCoroQueue(getLocalCoroQueueRange())); //overwrite the queueId with the selected one
+    }
+    else
+    {
+        if (task->getQueueId() >= (int)_coroQueues.size())
         {
-            size_t queueSize = _coroQueues[i].size();
-            if (queueSize < numTasks)
+            throw std::runtime_error("Queue id out of bounds");
+        }
+    }
+    
+    if (_isLazyThreadStart)
+    {
+        startCoroQueue(task->getQueueId());
+    }
+    _coroQueues.at(task->getQueueId()).enqueue(task);
+    
+}
+
+inline
+void DispatcherCore::postBatch(std::vector<Task::Ptr>& tasks)
+{
+    size_t numQueues = _coroQueues.size();
+    std::vector<std::vector<Task::Ptr>> queueTasks(numQueues);
+    QueueRange range(0, 0); //selected lazily for the first task posted on the 'Any' queue
+    size_t index = numQueues;
+    
+    for (auto&& task : tasks)
+    {
+        if (!task)
+        {
+            continue;
+        }
+        if (task->getQueueId() == (int)IQueue::QueueId::Any)
+        {
+            //Spread the batch evenly starting with the queue picked by the selection policy
+            if (index == numQueues)
             {
-                numTasks = queueSize;
-                index = i;
+                range = getLocalCoroQueueRange();
+                index = selectCoroQueue(range);
             }
-            if (numTasks == 0)
+            else
             {
-                break; //reached an empty queue
+                index = range.first + (index + 1 - range.first) % (range.second - range.first);
             }
+            task->setQueueId(index); //overwrite the queueId with the selected one
         }
-        
-        task->setQueueId(index); //overwrite the queueId with the selected one
-    }
-    else
-    {
-        if (task->getQueueId() >= (int)_coroQueues.size())
+        else if (task->getQueueId() >= (int)numQueues)
         {
             throw std::runtime_error("Queue id out of bounds");
         }
+        queueTasks[task->getQueueId()].push_back(task);
     }
     
-    _coroQueues.at(task->getQueueId()).enqueue(task);
+    for (size_t i = 0; i < numQueues; ++i)
+    {
+        if (_isLazyThreadStart && !queueTasks[i].empty())
+        {
+            startCoroQueue(i);
+        }
+        _coroQueues[i].enqueueBatch(queueTasks[i]);
+    }
+}
+
+inline
+size_t DispatcherCore::selectCoroQueue(const QueueRange& range)
+{
+    size_t numQueues = range.second - range.first;
+    if (numQueues == 1)
+    {
+        return range.first;
+    }
+    switch (_queueSelectionPolicy)
+    {
+        case Configuration::QueueSelectionPolicy::RoundRobin:
+            return range.first + _nextQueueIndex.fetch_add(1, std::memory_order_relaxed) % numQueues;
+        case Configuration::QueueSelectionPolicy::PowerOfTwo:
+        {
+            //Per-thread xorshift generator seeded from the shared cursor so that
+            //concurrent posters sample different queues.
+            static thread_local uint64_t seed = 0;
+            if (seed == 0)
+            {
+                seed = (_nextQueueIndex.fetch_add(1, std::memory_order_relaxed) + 1) * 0x9E3779B97F4A7C15ULL;
+            }
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            size_t first = range.first + static_cast<size_t>(seed % numQueues);
+            size_t second = range.first + (first - range.first + 1 + static_cast<size_t>((seed >> 32) % (numQueues - 1))) % numQueues; //distinct from first
+            return (_coroQueues[second].size() < _coroQueues[first].size()) ? second : first;
+        }
+        case Configuration::QueueSelectionPolicy::Shortest:
+        default:
+        {
+            //Insert into the shortest queue or the first empty queue found
+            size_t index = range.first;
+            size_t numTasks = std::numeric_limits<size_t>::max();
+            for (size_t i = range.first; i < range.second; ++i)
+            {
+                size_t queueSize = _coroQueues[i].size();
+                if (queueSize < numTasks)
+                {
+                    numTasks = queueSize;
+                    index = i;
+                }
+                if (numTasks == 0)
+                {
+                    break; //reached an empty queue
+                }
+            }
+            return index;
+        }
+    }
+}
+
+inline
+DispatcherCore::QueueRange DispatcherCore::getLocalCoroQueueRange() const
+{
+    if (!_cpuToNode.empty())
+    {
+        //Restrict the selection to the NUMA node of the posting thread if it runs on a configured CPU
+        int cpu = getCurrentCpu();
+        if ((cpu >= 0) && (cpu < (int)_cpuToNode.size()) && (_cpuToNode[cpu] != -1))
+        {
+            const QueueRange& range = _nodeQueueRanges[_cpuToNode[cpu]];
+            size_t end = std::min(range.second, _numAnyCoroQueues); //skip the manual queues
+            if (end > range.first)
+            {
+                return QueueRange(range.first, end);
+            }
+        }
+    }
+    return QueueRange(0, _numAnyCoroQueues);
+}
+
+inline
+void DispatcherCore::setCoroutineCpuSets(const std::vector<Configuration::CpuSet>& cpuSets)
+{
+    pinToCpuSets(_coroQueues, cpuSets);
     
+    //Build the node to queue and CPU to node mappings
+    size_t numNodes = cpuSets.size();
+    _nodeQueueRanges.assign(numNodes, QueueRange(0, 0));
+    for (size_t i = 0; i < _coroQueues.size(); ++i)
+    {
+        size_t node = i * numNodes / _coroQueues.size();
+        QueueRange& range = _nodeQueueRanges[node];
+        if (range.first == range.second)
+        {
+            range.first = i;
+        }
+        range.second = i + 1;
+        _coroQueues[i].setNumaNode(static_cast<int>(node));
+    }
+    for (size_t node = 0; node < numNodes; ++node)
+    {
+        for (int cpu : cpuSets[node])
+        {
+            if (cpu < 0)
+            {
+                continue;
+            }
+            if (cpu >= (int)_cpuToNode.size())
+            {
+                _cpuToNode.resize(cpu + 1, -1);
+            }
+            _cpuToNode[cpu] = static_cast<int>(node);
+        }
+    }
+}
+
+template <class QUEUE>
+void DispatcherCore::pinToCpuSets(std::vector<QUEUE>& queues,
+                                  const std::vector<Configuration::CpuSet>& cpuSets)
+{
+    //Queues are split into contiguous groups, one per node, and assigned the CPUs of their node in turn
+    size_t numNodes = cpuSets.size();
+    for (size_t i = 0; i < queues.size(); ++i)
+    {
+        size_t node = i * numNodes / queues.size();
+        size_t first = (node * queues.size() + numNodes - 1) / numNodes; //first queue of this node
+        const Configuration::CpuSet& cpus = cpuSets[node];
+        if (!cpus.empty())
+        {
+            queues[i].pinToCore(cpus[(i - first) % cpus.size()]);
+        }
+    }
+}
+
+inline
+int DispatcherCore::getCurrentCpu()
+{
+#ifdef _WIN32
+    return static_cast<int>(GetCurrentProcessorNumber());
+#else
+    return sched_getcpu();
+#endif
+}
+
+inline
+void DispatcherCore::unpark(const Task::Ptr& task)
+{
+    _coroQueues.at(task->getQueueId()).unpark(*task);
+}
+
+inline
+bool DispatcherCore::scheduleNext(const Task::Ptr& task)
+{
+    return _coroQueues.at(task->getQueueId()).scheduleNext(task);
 }
 
 inline
@@ -362,26 +755,16 @@ void DispatcherCore::postAsyncIo(IoTask::Ptr task)
     
     if (task->getQueueId() == (int)IQueue::QueueId::Any)
     {
-        if (_loadBalanceSharedIoQueues)
+        if (!_areIoQueuesStarted)
         {
-            static size_t index = 0;
-            //loop until we can find an queue that won't block
-            while (1) {
-                if (_sharedIoQueues.at(++index % _sharedIoQueues.size()).tryEnqueue(task)) {
-                    break;
-                }
-            }
+            startIoQueues();
         }
-        else
+        getSharedIoQueue().enqueue(task);
+        //Wake up a single idle IO thread. The registry lives in the first shared queue.
+        _sharedIoQueues[0].wakeIdleQueue();
+        if (_maxNumElasticIoQueues.load(std::memory_order_relaxed) > 0)
         {
-            //insert the task into the shared queue
-            _sharedIoQueues[0].enqueue(task);
-        
-            //Signal all threads there is work to do
-            for (auto&& queue : _ioQueues)
-            {
-                queue.signalEmptyCondition(false);
-            }
+            updateElasticIoQueues();
         }
     }
     else
@@ -392,7 +775,63 @@ void DispatcherCore::postAsyncIo(IoTask::Ptr task)
         }
         
         //Run on specific queue
-        _ioQueues.at(task->getQueueId()).enqueue(task);
+        IoQueue& queue = _ioQueues.at(task->getQueueId());
+        if (_isLazyThreadStart)
+        {
+            queue.start();
+        }
+        queue.enqueue(task);
+    }
+}
+
+inline
+void DispatcherCore::postAsyncIoBatch(std::vector<IoTask::Ptr>& tasks)
+{
+    std::vector<IoTask::Ptr> sharedTasks;
+    std::vector<std::vector<IoTask::Ptr>> queueTasks(_ioQueues.size());
+    
+    for (auto&& task : tasks)
+    {
+        if (!task)
+        {
+            continue;
+        }
+        if (task->getQueueId() == (int)IQueue::QueueId::Any)
+        {
+            sharedTasks.push_back(task);
+        }
+        else if (task->getQueueId() >= (int)_ioQueues.size())
+        {
+            throw std::runtime_error("Queue id out of bounds");
+        }
+        else
+        {
+            queueTasks[task->getQueueId()].push_back(task);
+        }
+    }
+    
+    if (!sharedTasks.empty())
+    {
+        if (!_areIoQueuesStarted)
+        {
+            startIoQueues();
+        }
+        getSharedIoQueue().enqueueBatch(sharedTasks);
+        //Wake up as many idle IO threads as there are new tasks
+        _sharedIoQueues[0].wakeIdleQueues(sharedTasks.size());
+        if (_maxNumElasticIoQueues.load(std::memory_order_relaxed) > 0)
+        {
+            updateElasticIoQueues();
+        }
+    }
+    
+    for (size_t i = 0; i < _ioQueues.size(); ++i)
+    {
+        if (_isLazyThreadStart && !queueTasks[i].empty())
+        {
+            _ioQueues[i].start();
+        }
+        _ioQueues[i].enqueueBatch(queueTasks[i]);
     }
 }
 
@@ -402,10 +841,428 @@ int DispatcherCore::getNumCoroutineThreads() const
     return _coroQueues.size();
 }
 
+inline
+int DispatcherCore::getNumManualCoroutineQueues() const
+{
+    return _numManualCoroQueues;
+}
+
+inline
+size_t DispatcherCore::runOnce(int queueId, size_t budget)
+{
+    if ((queueId < 0) || (queueId >= (int)_coroQueues.size()))
+    {
+        throw std::runtime_error("Queue id out of bounds");
+    }
+    if (queueId < (int)(_coroQueues.size() - _numManualCoroQueues))
+    {
+        throw std::runtime_error("Queue is not manual");
+    }
+    _pumpingThreadId = std::this_thread::get_id();
+    return _coroQueues[queueId].runOnce(budget);
+}
+
+inline
+size_t DispatcherCore::runUntilIdle()
+{
+    //Coroutines may signal each other across the manual queues so keep going until a full pass runs nothing
+    _pumpingThreadId = std::this_thread::get_id();
+    size_t numSlices = 0;
+    size_t numPassSlices;
+    do
+    {
+        numPassSlices = 0;
+        for (size_t i = _coroQueues.size() - _numManualCoroQueues; i < _coroQueues.size(); ++i)
+        {
+            numPassSlices += _coroQueues[i].runOnce(std::numeric_limits<size_t>::max());
+        }
+        numSlices += numPassSlices;
+    }
+    while (numPassSlices > 0);
+    return numSlices;
+}
+
+inline
+void DispatcherCore::setSchedulerCounters(SchedulerCounters* counters)
+{
+    for (auto&& queue : _coroQueues)
+    {
+        queue.setSchedulerCounters(counters);
+    }
+}
+
+inline
+bool DispatcherCore::getNextTimerTime(Task::TimePoint& time) const
+{
+    bool hasTimer = false;
+    Task::TimePoint queueTime;
+    for (size_t i = _coroQueues.size() - _numManualCoroQueues; i < _coroQueues.size(); ++i)
+    {
+        if (_coroQueues[i].getNextTimerTime(queueTime) && (!hasTimer || (queueTime < time)))
+        {
+            time = queueTime;
+            hasTimer = true;
+        }
+    }
+    return hasTimer;
+}
+
 inline
 int DispatcherCore::getNumIoThreads() const
 {
     return _ioQueues.size();
 }
 
+inline
+int DispatcherCore::getNumElasticIoThreads() const
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_elasticIoMutex);
+    return std::count_if(_elasticIoQueues.begin(), _elasticIoQueues.end(),
+                         [](const IoQueue& queue)->bool { return !queue.isRetired(); });
+}
+
+inline
+void DispatcherCore::setMaxNumIoThreads(int num)
+{
+    //Extra threads above the new limit are not stopped. They retire once idle and are not replaced.
+    _maxNumElasticIoQueues = (num > (int)_ioQueues.size()) ? num - _ioQueues.size() : 0;
+}
+
+inline
+Reactor& DispatcherCore::getReactor()
+{
+    return _reactor;
+}
+
+inline
+TimerQueue& DispatcherCore::getTimerQueue()
+{
+    return _timerQueue;
+}
+
+inline
+size_t DispatcherCore::getNumOutstandingTasks() const
+{
+    return _taskCounter.count();
+}
+
+inline
+TaskCounter& DispatcherCore::getTaskCounter()
+{
+    return _taskCounter;
+}
+
+inline
+void DispatcherCore::onDetachedError(std::exception_ptr ex)
+{
+    if (!_detachedErrorCallback)
+    {
+        return;
+    }
+    try
+    {
+        _detachedErrorCallback(ex);
+    }
+    catch (...)
+    {
+        //the failed task has nobody else to report to
+    }
+}
+
+inline
+bool DispatcherCore::isSaturated(IQueue::QueueType type, int queueId, bool isHighPriority)
+{
+    if (isHighPriority)
+    {
+        return false; //normal priority work is shed first
+    }
+    if (_globalHighWatermark > 0)
+    {
+        size_t numTasks = _taskCounter.count();
+        if (numTasks >= _globalHighWatermark)
+        {
+            _isGloballySaturated = true;
+        }
+        else if (_isGloballySaturated && (numTasks <= _globalLowWatermark))
+        {
+            _isGloballySaturated = false;
+        }
+        if (_isGloballySaturated)
+        {
+            return true;
+        }
+    }
+    if (!_hasQueueWatermarks)
+    {
+        return false;
+    }
+    if (type == IQueue::QueueType::Coro)
+    {
+        if (queueId == (int)IQueue::QueueId::Any)
+        {
+            QueueRange range = getLocalCoroQueueRange();
+            for (size_t i = range.first; i < range.second; ++i)
+            {
+                if (!_coroQueues[i].isSaturated())
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        return (queueId < (int)_coroQueues.size()) && _coroQueues[queueId].isSaturated();
+    }
+    if (queueId == (int)IQueue::QueueId::Any)
+    {
+        if (!_loadBalanceSharedIoQueues)
+        {
+            return _sharedIoQueues[0].isSaturated();
+        }
+        for (auto&& queue : _sharedIoQueues)
+        {
+            if (!queue.isSaturated())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    return (queueId < (int)_ioQueues.size()) && _ioQueues[queueId].isSaturated();
+}
+
+inline
+void DispatcherCore::admit(IQueue::QueueType type, int queueId, bool isHighPriority)
+{
+    if (tryAdmit(type, queueId, isHighPriority))
+    {
+        return;
+    }
+    //The manual queues only drain when driven so the thread driving them must not wait on them
+    size_t firstManualQueue = _coroQueues.size() - _numManualCoroQueues;
+    bool isManualTarget = (type == IQueue::QueueType::Coro) &&
+                          (_numManualCoroQueues > 0) &&
+                          ((queueId >= (int)firstManualQueue) ||
+                           ((queueId == (int)IQueue::QueueId::Any) && (_numAnyCoroQueues > firstManualQueue)));
+    if (isManualTarget && (_pumpingThreadId == std::this_thread::get_id()))
+    {
+        incRejectedCount(type, queueId);
+        throw std::runtime_error("Queue is saturated");
+    }
+    //Block until the queues have drained down to their low watermark
+    _taskCounter.waitForAdmission([this, type, queueId, isHighPriority]() -> bool {
+        return !isSaturated(type, queueId, isHighPriority);
+    });
+}
+
+inline
+bool DispatcherCore::tryAdmit(IQueue::QueueType type, int queueId, bool isHighPriority)
+{
+    if (!isSaturated(type, queueId, isHighPriority) || (_admissionPolicy == Configuration::AdmissionPolicy::Unbounded))
+    {
+        return true; //the watermarks are still tracked with the unbounded policy
+    }
+    if (_admissionPolicy == Configuration::AdmissionPolicy::Reject)
+    {
+        incRejectedCount(type, queueId);
+        throw std::runtime_error("Queue is saturated");
+    }
+    return false;
+}
+
+inline
+void DispatcherCore::incRejectedCount(IQueue::QueueType type, int queueId)
+{
+    if (type == IQueue::QueueType::Coro)
+    {
+        if (queueId == (int)IQueue::QueueId::Any)
+        {
+            queueId = (int)getLocalCoroQueueRange().first;
+        }
+        if (queueId < (int)_coroQueues.size())
+        {
+            _coroQueues[queueId].stats().incRejectedCount();
+        }
+    }
+    else if (queueId == (int)IQueue::QueueId::Any)
+    {
+        _sharedIoQueues[0].stats().incRejectedCount();
+    }
+    else if (queueId < (int)_ioQueues.size())
+    {
+        _ioQueues[queueId].stats().incRejectedCount();
+    }
+}
+
+inline
+void DispatcherCore::startCoroQueue(size_t index)
+{
+    if (index < _coroQueues.size() - _numManualCoroQueues) //manual queues never get a thread
+    {
+        _coroQueues[index].start();
+    }
+}
+
+inline
+void DispatcherCore::startIoQueues()
+{
+    for (auto&& queue : _ioQueues)
+    {
+        queue.start();
+    }
+    _areIoQueuesStarted = true;
+}
+
+inline
+IoQueue& DispatcherCore::getSharedIoQueue()
+{
+    if (!_loadBalanceSharedIoQueues)
+    {
+        return _sharedIoQueues[0];
+    }
+    //Each posting thread sticks to one shared queue of this dispatcher so that concurrent posters rarely contend.
+    //The thread ids are often aligned addresses so the hash is mixed before taking the modulo.
+    uint64_t hash = std::hash<std::thread::id>()(std::this_thread::get_id()) * 0x9E3779B97F4A7C15ULL;
+    return _sharedIoQueues[(hash >> 32) % _sharedIoQueues.size()];
+}
+
+inline
+void DispatcherCore::updateElasticIoQueues()
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_elasticIoMutex);
+    
+    //Reclaim the threads which retired after being idle
+    for (auto it = _elasticIoQueues.begin(); it != _elasticIoQueues.end();)
+    {
+        if (it->isRetired())
+        {
+            _retiredIoStats += it->stats();
+            it = _elasticIoQueues.erase(it); //joins the exited thread
+            continue;
+        }
+        ++it;
+    }
+    
+    //Add a thread if the shared backlog is too large for the current pool
+    if (_elasticIoQueues.size() < _maxNumElasticIoQueues)
+    {
+        size_t backlog = 0;
+        for (auto&& queue : _sharedIoQueues)
+        {
+            backlog += queue.size();
+        }
+        if (backlog > _ioGrowthBacklog * (_elasticIoQueues.size() + 1))
+        {
+            _elasticIoQueues.emplace_back(_ioConfig, &_sharedIoQueues, true, &_taskCounter);
+        }
+    }
+}
+
+inline
+void DispatcherCore::checkStalls()
+{
+    //Report each stall once, when it crosses its threshold between two samples
+    using StallType = Configuration::StallType;
+    TimerQueue::TimePoint now = std::chrono::steady_clock::now();
+    std::vector<Configuration::StallInfo> stalls;
+    auto checkQueue = [&](TimerQueue::TimePoint start, StallType type, int queueId)
+    {
+        if ((start != TimerQueue::TimePoint()) &&
+            (start <= now - _queueStallThresholdMs) &&
+            (start > _lastStallCheck - _queueStallThresholdMs))
+        {
+            stalls.push_back({type, queueId, std::chrono::duration_cast<std::chrono::milliseconds>(now - start), nullptr});
+        }
+    };
+    for (size_t i = 0; i < _coroQueues.size(); ++i)
+    {
+        checkQueue(_coroQueues[i].getSliceStartTime(), StallType::CoroutineQueue, (int)i);
+    }
+    for (size_t i = 0; i < _ioQueues.size(); ++i)
+    {
+        checkQueue(_ioQueues[i].getRunStartTime(), StallType::IoQueue, (int)i);
+    }
+    {
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_elasticIoMutex);
+        for (auto&& queue : _elasticIoQueues)
+        {
+            checkQueue(queue.getRunStartTime(), StallType::IoQueue, (int)IQueue::QueueId::Any);
+        }
+    }
+    if (_blockedCoroutineThresholdMs.count() > 0)
+    {
+        std::vector<std::pair<const Task*, Task::TimePoint>> blocked;
+        for (size_t i = 0; i < _coroQueues.size(); ++i)
+        {
+            _coroQueues[i].getBlockedTasks(_lastStallCheck - _blockedCoroutineThresholdMs,
+                                           now - _blockedCoroutineThresholdMs,
+                                           blocked);
+            for (auto&& task : blocked)
+            {
+                stalls.push_back({StallType::BlockedCoroutine, (int)i,
+                                  std::chrono::duration_cast<std::chrono::milliseconds>(now - task.second), task.first});
+            }
+            blocked.clear();
+        }
+    }
+    _lastStallCheck = now;
+    for (auto&& stall : stalls)
+    {
+        try
+        {
+            _stallCallback(stall);
+        }
+        catch (...)
+        {
+            //keep the watchdog and the other timers running
+        }
+    }
+}
+
+inline
+void DispatcherCore::sampleProfile()
+{
+    //The labels are only read here. Idle queues are counted in the total but not recorded.
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_profileMutex);
+    ++_numProfileSamples;
+    for (size_t i = 0; i < _coroQueues.size(); ++i)
+    {
+        const char* label = _coroQueues[i].getRunningLabel();
+        if (label)
+        {
+            ++_profileSamples[std::make_pair((int)i, label)];
+        }
+    }
+}
+
+inline
+void DispatcherCore::resetProfile()
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_profileMutex);
+    _numProfileSamples = 0;
+    _profileSamples.clear();
+}
+
+inline
+Profile DispatcherCore::profile()
+{
+    Profile profile;
+    profile._interval = _samplingProfilerIntervalUs;
+    {
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_profileMutex);
+        profile._numSamples = _numProfileSamples;
+        for (auto&& sample : _profileSamples)
+        {
+            profile.add(sample.first.first, sample.first.second, sample.second);
+        }
+    }
+    profile.sort();
+    return profile;
+}
+
 }}
@@ -35,10 +35,35 @@ Dispatcher::Dispatcher(int numCoroutineThreads,
 
 inline
 Dispatcher::Dispatcher(const Configuration& config) :
-    _dispatcher(config),
+    _dispatcher(applyPoolSettings(config)),
     _drain(false),
     _terminated(ATOMIC_FLAG_INIT)
-{}
+{
+    if (config.getPoolWarmup())
+    {
+        warmUpPools(config.getPoolWarmupCpuSet());
+    }
+    if ((config.getMetricsExportIntervalMs().count() > 0) && config.getMetricsExporter())
+    {
+        //the exporter computes its rates over its own interval
+        auto previous = std::make_shared<MetricsSnapshot>();
+        Configuration::MetricsExporter exporter = config.getMetricsExporter();
+        _dispatcher.getTimerQueue().add(std::chrono::steady_clock::now() + config.getMetricsExportIntervalMs(),
+                                        config.getMetricsExportIntervalMs(),
+                                        [this, previous, exporter]()
+        {
+            *previous = collectMetrics(*previous);
+            try
+            {
+                exporter(*previous);
+            }
+            catch (...)
+            {
+                //keep the exporter and the other timers running
+            }
+        });
+    }
+}
 
 inline
 Dispatcher::~Dispatcher()
@@ -52,17 +77,174 @@ ThreadContextPtr<RET>
 Dispatcher::post(FUNC&& func,
                  ARGS&&... args)
 {
-    return postImpl<RET>((int)IQueue::QueueId::Any, false, ITask::Type::Standalone, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postImpl<RET>(nullptr, (int)IQueue::QueueId::Any, IQueue::Priority::Normal, std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::Standalone, StackSizeClass::Default, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::post(int queueId,
+                 bool isHighPriority,
+                 FUNC&& func,
+                 ARGS&&... args)
+{
+    return postImpl<RET>(nullptr, queueId, isHighPriority ? IQueue::Priority::High : IQueue::Priority::Normal,
+                         std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::Standalone, StackSizeClass::Default, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
 template <class RET, class FUNC, class ... ARGS>
 ThreadContextPtr<RET>
 Dispatcher::post(int queueId,
+                 IQueue::Priority priority,
+                 FUNC&& func,
+                 ARGS&&... args)
+{
+    return postImpl<RET>(nullptr, queueId, priority, std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::Standalone, StackSizeClass::Default, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::post(int queueId,
+                 IQueue::Priority priority,
+                 std::chrono::steady_clock::time_point deadline,
+                 FUNC&& func,
+                 ARGS&&... args)
+{
+    return postImpl<RET>(nullptr, queueId, priority, deadline,
+                         ITask::Type::Standalone, StackSizeClass::Default, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::post(CancellationToken::Ptr token,
+                 FUNC&& func,
+                 ARGS&&... args)
+{
+    return postImpl<RET>(std::move(token), (int)IQueue::QueueId::Any, IQueue::Priority::Normal, std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::Standalone, StackSizeClass::Default, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::post(CancellationToken::Ptr token,
+                 int queueId,
+                 bool isHighPriority,
+                 FUNC&& func,
+                 ARGS&&... args)
+{
+    return postImpl<RET>(std::move(token), queueId, isHighPriority ? IQueue::Priority::High : IQueue::Priority::Normal,
+                         std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::Standalone, StackSizeClass::Default, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::post(StackSizeClass stackSize,
+                 FUNC&& func,
+                 ARGS&&... args)
+{
+    return postImpl<RET>(nullptr, (int)IQueue::QueueId::Any, IQueue::Priority::Normal, std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::Standalone, stackSize, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::post(StackSizeClass stackSize,
+                 int queueId,
+                 bool isHighPriority,
+                 FUNC&& func,
+                 ARGS&&... args)
+{
+    return postImpl<RET>(nullptr, queueId, isHighPriority ? IQueue::Priority::High : IQueue::Priority::Normal,
+                         std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::Standalone, stackSize, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::post(TaskLabel label,
+                 FUNC&& func,
+                 ARGS&&... args)
+{
+    return postImpl<RET>(nullptr, (int)IQueue::QueueId::Any, IQueue::Priority::Normal, std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::Standalone, StackSizeClass::Default, label._name, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::post(TaskLabel label,
+                 int queueId,
                  bool isHighPriority,
                  FUNC&& func,
                  ARGS&&... args)
 {
-    return postImpl<RET>(queueId, isHighPriority, ITask::Type::Standalone, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postImpl<RET>(nullptr, queueId, isHighPriority ? IQueue::Priority::High : IQueue::Priority::Normal,
+                         std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::Standalone, StackSizeClass::Default, label._name, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postAfter(std::chrono::milliseconds delay,
+                      FUNC&& func,
+                      ARGS&&... args)
+{
+    return postAtImpl<RET>(std::chrono::steady_clock::now() + delay, (int)IQueue::QueueId::Any, false,
+                           std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postAfter(std::chrono::milliseconds delay,
+                      int queueId,
+                      bool isHighPriority,
+                      FUNC&& func,
+                      ARGS&&... args)
+{
+    return postAtImpl<RET>(std::chrono::steady_clock::now() + delay, queueId, isHighPriority,
+                           std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postAt(std::chrono::steady_clock::time_point time,
+                   FUNC&& func,
+                   ARGS&&... args)
+{
+    return postAtImpl<RET>(time, (int)IQueue::QueueId::Any, false, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postAt(std::chrono::steady_clock::time_point time,
+                   int queueId,
+                   bool isHighPriority,
+                   FUNC&& func,
+                   ARGS&&... args)
+{
+    return postAtImpl<RET>(time, queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+size_t
+Dispatcher::postEvery(std::chrono::milliseconds period,
+                      FUNC&& func,
+                      ARGS&&... args)
+{
+    return postEveryImpl<RET>(period, (int)IQueue::QueueId::Any, false, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+size_t
+Dispatcher::postEvery(std::chrono::milliseconds period,
+                      int queueId,
+                      bool isHighPriority,
+                      FUNC&& func,
+                      ARGS&&... args)
+{
+    return postEveryImpl<RET>(period, queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
 template <class RET, class FUNC, class ... ARGS>
@@ -70,7 +252,8 @@ ThreadContextPtr<RET>
 Dispatcher::postFirst(FUNC&& func,
                       ARGS&&... args)
 {
-    return postImpl<RET>((int)IQueue::QueueId::Any, false, ITask::Type::First, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postImpl<RET>(nullptr, (int)IQueue::QueueId::Any, IQueue::Priority::Normal, std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::First, StackSizeClass::Default, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
 template <class RET, class FUNC, class ... ARGS>
@@ -80,7 +263,250 @@ Dispatcher::postFirst(int queueId,
                       FUNC&& func,
                       ARGS&&... args)
 {
-    return postImpl<RET>(queueId, isHighPriority, ITask::Type::First, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postImpl<RET>(nullptr, queueId, isHighPriority ? IQueue::Priority::High : IQueue::Priority::Normal,
+                         std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::First, StackSizeClass::Default, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postFirst(int queueId,
+                      IQueue::Priority priority,
+                      FUNC&& func,
+                      ARGS&&... args)
+{
+    return postImpl<RET>(nullptr, queueId, priority, std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::First, StackSizeClass::Default, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postFirst(int queueId,
+                      IQueue::Priority priority,
+                      std::chrono::steady_clock::time_point deadline,
+                      FUNC&& func,
+                      ARGS&&... args)
+{
+    return postImpl<RET>(nullptr, queueId, priority, deadline,
+                         ITask::Type::First, StackSizeClass::Default, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postFirst(CancellationToken::Ptr token,
+                      FUNC&& func,
+                      ARGS&&... args)
+{
+    return postImpl<RET>(std::move(token), (int)IQueue::QueueId::Any, IQueue::Priority::Normal, std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::First, StackSizeClass::Default, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postFirst(CancellationToken::Ptr token,
+                      int queueId,
+                      bool isHighPriority,
+                      FUNC&& func,
+                      ARGS&&... args)
+{
+    return postImpl<RET>(std::move(token), queueId, isHighPriority ? IQueue::Priority::High : IQueue::Priority::Normal,
+                         std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::First, StackSizeClass::Default, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postFirst(StackSizeClass stackSize,
+                      FUNC&& func,
+                      ARGS&&... args)
+{
+    return postImpl<RET>(nullptr, (int)IQueue::QueueId::Any, IQueue::Priority::Normal, std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::First, stackSize, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postFirst(StackSizeClass stackSize,
+                      int queueId,
+                      bool isHighPriority,
+                      FUNC&& func,
+                      ARGS&&... args)
+{
+    return postImpl<RET>(nullptr, queueId, isHighPriority ? IQueue::Priority::High : IQueue::Priority::Normal,
+                         std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::First, stackSize, nullptr, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postFirst(TaskLabel label,
+                      FUNC&& func,
+                      ARGS&&... args)
+{
+    return postImpl<RET>(nullptr, (int)IQueue::QueueId::Any, IQueue::Priority::Normal, std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::First, StackSizeClass::Default, label._name, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postFirst(TaskLabel label,
+                      int queueId,
+                      bool isHighPriority,
+                      FUNC&& func,
+                      ARGS&&... args)
+{
+    return postImpl<RET>(nullptr, queueId, isHighPriority ? IQueue::Priority::High : IQueue::Priority::Normal,
+                         std::chrono::steady_clock::time_point::max(),
+                         ITask::Type::First, StackSizeClass::Default, label._name, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC_IT, class>
+std::vector<ThreadContextPtr<RET>>
+Dispatcher::postBatch(FUNC_IT first,
+                      FUNC_IT last)
+{
+    return postBatch<RET>((int)IQueue::QueueId::Any, false, first, last);
+}
+
+template <class RET, class FUNC_IT, class>
+std::vector<ThreadContextPtr<RET>>
+Dispatcher::postBatch(int queueId,
+                      bool isHighPriority,
+                      FUNC_IT first,
+                      FUNC_IT last)
+{
+    if (_drain)
+    {
+        throw std::runtime_error("Posting is disabled");
+    }
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid coroutine queue id");
+    }
+    std::vector<ThreadContextPtr<RET>> contexts;
+    std::vector<Task::Ptr> tasks;
+    for (; first != last; ++first)
+    {
+        auto ctx = Context<RET>::create(_dispatcher);
+        auto task = Task::create(ctx,
+                                 queueId,
+                                 isHighPriority,
+                                 ITask::Type::Standalone,
+                                 *first);
+        ctx->setTask(task);
+        tasks.emplace_back(std::move(task));
+        contexts.emplace_back(std::static_pointer_cast<IThreadContext<RET>>(ctx));
+    }
+    _dispatcher.postBatch(tasks);
+    return contexts;
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadFuturePtr<RET>
+Dispatcher::postTask(FUNC&& func,
+                     ARGS&&... args)
+{
+    return postTask<RET>((int)IQueue::QueueId::Any, false, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadFuturePtr<RET>
+Dispatcher::postTask(int queueId,
+                     bool isHighPriority,
+                     FUNC&& func,
+                     ARGS&&... args)
+{
+    if (_drain)
+    {
+        throw std::runtime_error("Posting is disabled");
+    }
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid coroutine queue id");
+    }
+    _dispatcher.admit(IQueue::QueueType::Coro, queueId, isHighPriority);
+    auto promise = Promise<RET>::create();
+    auto task = Task::create(promise,
+                             queueId,
+                             isHighPriority,
+                             std::forward<FUNC>(func),
+                             std::forward<ARGS>(args)...);
+    _dispatcher.post(task);
+    return promise->getIThreadFuture();
+}
+
+template <class RET, class FUNC, class ... ARGS>
+void
+Dispatcher::postDetached(FUNC&& func,
+                         ARGS&&... args)
+{
+    postDetached<RET>((int)IQueue::QueueId::Any, false, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+void
+Dispatcher::postDetached(int queueId,
+                         bool isHighPriority,
+                         FUNC&& func,
+                         ARGS&&... args)
+{
+    if (_drain)
+    {
+        throw std::runtime_error("Posting is disabled");
+    }
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid coroutine queue id");
+    }
+    _dispatcher.admit(IQueue::QueueType::Coro, queueId, isHighPriority);
+    auto ctx = Context<RET>::create(_dispatcher, true);
+    auto task = Task::create(ctx,
+                             queueId,
+                             isHighPriority,
+                             ITask::Type::Standalone,
+                             std::forward<FUNC>(func),
+                             std::forward<ARGS>(args)...);
+    ctx->setTask(task);
+    _dispatcher.post(task);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::tryPost(FUNC&& func,
+                    ARGS&&... args)
+{
+    return tryPost<RET>((int)IQueue::QueueId::Any, false, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::tryPost(int queueId,
+                    bool isHighPriority,
+                    FUNC&& func,
+                    ARGS&&... args)
+{
+    if (_drain)
+    {
+        throw std::runtime_error("Posting is disabled");
+    }
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid coroutine queue id");
+    }
+    if (_dispatcher.isSaturated(IQueue::QueueType::Coro, queueId, isHighPriority))
+    {
+        _dispatcher.incRejectedCount(IQueue::QueueType::Coro, queueId);
+        return nullptr;
+    }
+    return postAdmittedImpl<RET>(nullptr,
+                                 queueId,
+                                 isHighPriority ? IQueue::Priority::High : IQueue::Priority::Normal,
+                                 std::chrono::steady_clock::time_point::max(),
+                                 ITask::Type::Standalone,
+                                 StackSizeClass::Default,
+                                 nullptr,
+                                 std::forward<FUNC>(func),
+                                 std::forward<ARGS>(args)...);
 }
 
 template <class RET, class FUNC, class ... ARGS>
@@ -88,17 +514,170 @@ ThreadFuturePtr<RET>
 Dispatcher::postAsyncIo(FUNC&& func,
                         ARGS&&... args)
 {
-    return postAsyncIoImpl<RET>((int)IQueue::QueueId::Any, false, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postAsyncIoImpl<RET>(nullptr, (int)IQueue::QueueId::Any, false,
+                                std::chrono::steady_clock::time_point::max(), std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadFuturePtr<RET>
+Dispatcher::postAsyncIo(int queueId,
+                        bool isHighPriority,
+                        FUNC&& func,
+                        ARGS&&... args)
+{
+    return postAsyncIoImpl<RET>(nullptr, queueId, isHighPriority,
+                                std::chrono::steady_clock::time_point::max(), std::forward<FUNC>(func), std::forward<ARGS>(args)...);
 }
 
 template <class RET, class FUNC, class ... ARGS>
 ThreadFuturePtr<RET>
 Dispatcher::postAsyncIo(int queueId,
                         bool isHighPriority,
+                        std::chrono::steady_clock::time_point deadline,
                         FUNC&& func,
                         ARGS&&... args)
 {
-    return postAsyncIoImpl<RET>(queueId, isHighPriority, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return postAsyncIoImpl<RET>(nullptr, queueId, isHighPriority, deadline, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class FUNC, class ... ARGS>
+void
+Dispatcher::postAsyncIoDetached(FUNC&& func,
+                                ARGS&&... args)
+{
+    postAsyncIoDetached((int)IQueue::QueueId::Any, false, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class FUNC, class ... ARGS>
+void
+Dispatcher::postAsyncIoDetached(int queueId,
+                                bool isHighPriority,
+                                FUNC&& func,
+                                ARGS&&... args)
+{
+    if (_drain)
+    {
+        throw std::runtime_error("Posting is disabled");
+    }
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid IO queue id");
+    }
+    _dispatcher.admit(IQueue::QueueType::IO, queueId, isHighPriority);
+    _dispatcher.postAsyncIo(IoTask::create(Util::bindDetachedIoCaller(_dispatcher,
+                                                                      std::forward<FUNC>(func),
+                                                                      std::forward<ARGS>(args)...),
+                                           queueId,
+                                           isHighPriority));
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadFuturePtr<RET>
+Dispatcher::tryPostAsyncIo(FUNC&& func,
+                           ARGS&&... args)
+{
+    return tryPostAsyncIo<RET>((int)IQueue::QueueId::Any, false, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadFuturePtr<RET>
+Dispatcher::tryPostAsyncIo(int queueId,
+                           bool isHighPriority,
+                           FUNC&& func,
+                           ARGS&&... args)
+{
+    if (_drain)
+    {
+        throw std::runtime_error("Posting is disabled");
+    }
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid IO queue id");
+    }
+    if (_dispatcher.isSaturated(IQueue::QueueType::IO, queueId, isHighPriority))
+    {
+        _dispatcher.incRejectedCount(IQueue::QueueType::IO, queueId);
+        return nullptr;
+    }
+    return postAsyncIoAdmittedImpl<RET>(nullptr, queueId, isHighPriority,
+                                        std::chrono::steady_clock::time_point::max(), std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC_IT, class>
+std::vector<ThreadFuturePtr<RET>>
+Dispatcher::postAsyncIoBatch(FUNC_IT first,
+                             FUNC_IT last)
+{
+    return postAsyncIoBatch<RET>((int)IQueue::QueueId::Any, false, first, last);
+}
+
+template <class RET, class FUNC_IT, class>
+std::vector<ThreadFuturePtr<RET>>
+Dispatcher::postAsyncIoBatch(int queueId,
+                             bool isHighPriority,
+                             FUNC_IT first,
+                             FUNC_IT last)
+{
+    if (_drain)
+    {
+        throw std::runtime_error("Posting is disabled");
+    }
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid IO queue id");
+    }
+    std::vector<ThreadFuturePtr<RET>> futures;
+    std::vector<IoTask::Ptr> tasks;
+    for (; first != last; ++first)
+    {
+        auto promise = Promise<RET>::create();
+        tasks.emplace_back(IoTask::create(promise,
+                                          queueId,
+                                          isHighPriority,
+                                          *first));
+        futures.emplace_back(promise->getIThreadFuture());
+    }
+    _dispatcher.postAsyncIoBatch(tasks);
+    return futures;
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadFuturePtr<RET>
+Dispatcher::postAsyncIo(CancellationToken::Ptr token,
+                        FUNC&& func,
+                        ARGS&&... args)
+{
+    return postAsyncIoImpl<RET>(std::move(token), (int)IQueue::QueueId::Any, false,
+                                std::chrono::steady_clock::time_point::max(), std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadFuturePtr<RET>
+Dispatcher::postAsyncIo(CancellationToken::Ptr token,
+                        int queueId,
+                        bool isHighPriority,
+                        FUNC&& func,
+                        ARGS&&... args)
+{
+    return postAsyncIoImpl<RET>(std::move(token), queueId, isHighPriority,
+                                std::chrono::steady_clock::time_point::max(), std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class FUTURE, class FUNC>
+void
+Dispatcher::postOnReady(FUTURE future,
+                        int queueId,
+                        bool isHighPriority,
+                        FUNC&& func)
+{
+    future->onReady([this, queueId, isHighPriority, func = std::forward<FUNC>(func)]() mutable
+    {
+        postAsyncIo(queueId, isHighPriority, [](ThreadPromise<int>::Ptr promise, std::decay_t<FUNC> f)->int
+        {
+            f();
+            return promise->set(0);
+        }, std::move(func));
+    });
 }
 
 template <class RET, class INPUT_IT, class>
@@ -122,28 +701,178 @@ Dispatcher::forEach(INPUT_IT first,
                                   Functions::ForEachFunc<RET, INPUT_IT>{std::move(func)});
 }
 
-template <class RET, class INPUT_IT, class>
+template <class RET, class INPUT_IT, class>
+ThreadContextPtr<std::vector<RET>>
+Dispatcher::forEach(INPUT_IT first,
+                    INPUT_IT last,
+                    Functions::ForEachFunc<RET, INPUT_IT> func,
+                    GrainSize grain)
+{
+    return forEach<RET>(first, std::distance(first, last), std::move(func), grain);
+}
+
+template <class RET, class INPUT_IT>
+ThreadContextPtr<std::vector<RET>>
+Dispatcher::forEach(INPUT_IT first,
+                    size_t num,
+                    Functions::ForEachFunc<RET, INPUT_IT> func,
+                    GrainSize grain)
+{
+    return post<std::vector<RET>>(Util::forEachChunkCoro<RET, INPUT_IT>,
+                                  INPUT_IT{first},
+                                  size_t{num},
+                                  Functions::ForEachFunc<RET, INPUT_IT>{std::move(func)},
+                                  GrainSize{grain},
+                                  getNumCoroutineThreads());
+}
+
+template <class RET, class INPUT_IT, class OUTPUT_IT, class>
+ThreadContextPtr<int>
+Dispatcher::forEach(INPUT_IT first,
+                    INPUT_IT last,
+                    OUTPUT_IT out,
+                    Functions::ForEachFunc<RET, INPUT_IT> func)
+{
+    return forEach<RET>(first, std::distance(first, last), out, std::move(func));
+}
+
+template <class RET, class INPUT_IT, class OUTPUT_IT>
+ThreadContextPtr<int>
+Dispatcher::forEach(INPUT_IT first,
+                    size_t num,
+                    OUTPUT_IT out,
+                    Functions::ForEachFunc<RET, INPUT_IT> func)
+{
+    return post<int>(Util::forEachIntoCoro<RET, INPUT_IT, OUTPUT_IT>,
+                     INPUT_IT{first},
+                     size_t{num},
+                     OUTPUT_IT{out},
+                     Functions::ForEachFunc<RET, INPUT_IT>{std::move(func)},
+                     getNumCoroutineThreads());
+}
+
+template <class RET, class INPUT_IT, class>
+ThreadContextPtr<std::vector<std::vector<RET>>>
+Dispatcher::forEachBatch(INPUT_IT first,
+                         INPUT_IT last,
+                         Functions::ForEachFunc<RET, INPUT_IT> func)
+{
+    return forEachBatch<RET>(first, std::distance(first, last), std::move(func));
+}
+
+template <class RET, class INPUT_IT>
+ThreadContextPtr<std::vector<std::vector<RET>>>
+Dispatcher::forEachBatch(INPUT_IT first,
+                         size_t num,
+                         Functions::ForEachFunc<RET, INPUT_IT> func)
+{
+    return post<std::vector<std::vector<RET>>>(Util::forEachBatchCoro<RET, INPUT_IT>,
+                                               INPUT_IT{first},
+                                               size_t{num},
+                                               Functions::ForEachFunc<RET, INPUT_IT>{std::move(func)},
+                                               getNumCoroutineThreads());
+}
+
+template <class RET, class INPUT_IT, class>
+ThreadContextPtr<std::vector<std::vector<RET>>>
+Dispatcher::forEachBatch(INPUT_IT first,
+                         INPUT_IT last,
+                         Functions::ForEachFunc<RET, INPUT_IT> func,
+                         GrainSize grain)
+{
+    return forEachBatch<RET>(first, std::distance(first, last), std::move(func), grain);
+}
+
+template <class RET, class INPUT_IT>
+ThreadContextPtr<std::vector<std::vector<RET>>>
+Dispatcher::forEachBatch(INPUT_IT first,
+                         size_t num,
+                         Functions::ForEachFunc<RET, INPUT_IT> func,
+                         GrainSize grain)
+{
+    return post<std::vector<std::vector<RET>>>(Util::forEachBatchDynamicCoro<RET, INPUT_IT>,
+                                               INPUT_IT{first},
+                                               size_t{num},
+                                               Functions::ForEachFunc<RET, INPUT_IT>{std::move(func)},
+                                               GrainSize{grain},
+                                               getNumCoroutineThreads());
+}
+
+template <class RET, class INPUT_IT, class FUNC, class, class>
+ThreadContextPtr<std::vector<std::vector<RET>>>
+Dispatcher::forEachBatch(INPUT_IT first,
+                         INPUT_IT last,
+                         FUNC&& func)
+{
+    return forEachBatch<RET>(first, std::distance(first, last), std::forward<FUNC>(func));
+}
+
+template <class RET, class INPUT_IT, class FUNC, class>
+ThreadContextPtr<std::vector<std::vector<RET>>>
+Dispatcher::forEachBatch(INPUT_IT first,
+                         size_t num,
+                         FUNC&& func)
+{
+    return post<std::vector<std::vector<RET>>>(Util::forEachBatchCoro<RET, INPUT_IT, std::decay_t<FUNC>>,
+                                               INPUT_IT{first},
+                                               size_t{num},
+                                               std::decay_t<FUNC>{std::forward<FUNC>(func)},
+                                               getNumCoroutineThreads());
+}
+
+template <class RET, class INPUT_IT, class FUNC, class, class>
 ThreadContextPtr<std::vector<std::vector<RET>>>
 Dispatcher::forEachBatch(INPUT_IT first,
                          INPUT_IT last,
-                         Functions::ForEachFunc<RET, INPUT_IT> func)
+                         FUNC&& func,
+                         GrainSize grain)
 {
-    return forEachBatch<RET>(first, std::distance(first, last), std::move(func));
+    return forEachBatch<RET>(first, std::distance(first, last), std::forward<FUNC>(func), grain);
 }
 
-template <class RET, class INPUT_IT>
+template <class RET, class INPUT_IT, class FUNC, class>
 ThreadContextPtr<std::vector<std::vector<RET>>>
 Dispatcher::forEachBatch(INPUT_IT first,
                          size_t num,
-                         Functions::ForEachFunc<RET, INPUT_IT> func)
+                         FUNC&& func,
+                         GrainSize grain)
 {
-    return post<std::vector<std::vector<RET>>>(Util::forEachBatchCoro<RET, INPUT_IT>,
+    return post<std::vector<std::vector<RET>>>(Util::forEachBatchDynamicCoro<RET, INPUT_IT, std::decay_t<FUNC>>,
                                                INPUT_IT{first},
                                                size_t{num},
-                                               Functions::ForEachFunc<RET, INPUT_IT>{std::move(func)},
+                                               std::decay_t<FUNC>{std::forward<FUNC>(func)},
+                                               GrainSize{grain},
                                                getNumCoroutineThreads());
 }
 
+template <class INPUT_TYPE, class OUTPUT_TYPE, class KERNEL>
+ThreadContextPtr<int>
+Dispatcher::forEachKernel(const INPUT_TYPE* first,
+                          size_t num,
+                          OUTPUT_TYPE* out,
+                          KERNEL&& kernel)
+{
+    return post<int>(Util::forEachKernelCoro<INPUT_TYPE, OUTPUT_TYPE, std::decay_t<KERNEL>>,
+                     static_cast<const INPUT_TYPE*>(first),
+                     size_t{num},
+                     static_cast<OUTPUT_TYPE*>(out),
+                     std::decay_t<KERNEL>{std::forward<KERNEL>(kernel)},
+                     getNumCoroutineThreads());
+}
+
+template <class OUTPUT_TYPE, class INPUT_TYPE, class KERNEL>
+ThreadContextPtr<std::vector<OUTPUT_TYPE>>
+Dispatcher::forEachKernel(const INPUT_TYPE* first,
+                          size_t num,
+                          KERNEL&& kernel)
+{
+    return post<std::vector<OUTPUT_TYPE>>(Util::forEachKernelIntoVectorCoro<INPUT_TYPE, OUTPUT_TYPE, std::decay_t<KERNEL>>,
+                                          static_cast<const INPUT_TYPE*>(first),
+                                          size_t{num},
+                                          std::decay_t<KERNEL>{std::forward<KERNEL>(kernel)},
+                                          getNumCoroutineThreads());
+}
+
 template <class KEY,
           class MAPPED_TYPE,
           class REDUCED_TYPE,
@@ -208,6 +937,271 @@ Dispatcher::mapReduceBatch(INPUT_IT first,
                                Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>{std::move(reducer)});
 }
 
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class INPUT_IT,
+          class MAPPER,
+          class REDUCER,
+          class,
+          class,
+          class>
+ThreadContextPtr<std::map<KEY, REDUCED_TYPE>>
+Dispatcher::mapReduceBatch(INPUT_IT first,
+                           INPUT_IT last,
+                           MAPPER&& mapper,
+                           REDUCER&& reducer)
+{
+    return mapReduceBatch<KEY, MAPPED_TYPE, REDUCED_TYPE>
+        (first, std::distance(first, last), std::forward<MAPPER>(mapper), std::forward<REDUCER>(reducer));
+}
+
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class INPUT_IT,
+          class MAPPER,
+          class REDUCER,
+          class,
+          class>
+ThreadContextPtr<std::map<KEY, REDUCED_TYPE>>
+Dispatcher::mapReduceBatch(INPUT_IT first,
+                           size_t num,
+                           MAPPER&& mapper,
+                           REDUCER&& reducer)
+{
+    using ReducerOutput = std::map<KEY, REDUCED_TYPE>;
+    return post<ReducerOutput>(Util::mapReduceBatchCoro<KEY, MAPPED_TYPE, REDUCED_TYPE, INPUT_IT, std::decay_t<MAPPER>, std::decay_t<REDUCER>>,
+                               INPUT_IT{first},
+                               size_t{num},
+                               std::decay_t<MAPPER>{std::forward<MAPPER>(mapper)},
+                               std::decay_t<REDUCER>{std::forward<REDUCER>(reducer)});
+}
+
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class OUTPUT,
+          class INPUT_IT,
+          class>
+ThreadContextPtr<OUTPUT>
+Dispatcher::mapReducePartitioned(INPUT_IT first,
+                                 INPUT_IT last,
+                                 Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                 Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+{
+    return mapReducePartitioned<KEY, MAPPED_TYPE, REDUCED_TYPE, OUTPUT>
+        (first, std::distance(first, last), std::move(mapper), std::move(reducer));
+}
+
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class OUTPUT,
+          class INPUT_IT>
+ThreadContextPtr<OUTPUT>
+Dispatcher::mapReducePartitioned(INPUT_IT first,
+                                 size_t num,
+                                 Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                 Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+{
+    return post<OUTPUT>(Util::mapReducePartitionedCoro<KEY, MAPPED_TYPE, REDUCED_TYPE, OUTPUT, INPUT_IT>,
+                        INPUT_IT{first},
+                        size_t{num},
+                        Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>{std::move(mapper)},
+                        Functions::CombineFunc<MAPPED_TYPE>{},
+                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>{std::move(reducer)},
+                        getNumCoroutineThreads());
+}
+
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class OUTPUT,
+          class INPUT_IT,
+          class>
+ThreadContextPtr<OUTPUT>
+Dispatcher::mapReducePartitioned(INPUT_IT first,
+                                 INPUT_IT last,
+                                 Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                 Functions::CombineFunc<MAPPED_TYPE> combiner,
+                                 Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+{
+    return mapReducePartitioned<KEY, MAPPED_TYPE, REDUCED_TYPE, OUTPUT>
+        (first, std::distance(first, last), std::move(mapper), std::move(combiner), std::move(reducer));
+}
+
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class OUTPUT,
+          class INPUT_IT>
+ThreadContextPtr<OUTPUT>
+Dispatcher::mapReducePartitioned(INPUT_IT first,
+                                 size_t num,
+                                 Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                                 Functions::CombineFunc<MAPPED_TYPE> combiner,
+                                 Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer)
+{
+    return post<OUTPUT>(Util::mapReducePartitionedCoro<KEY, MAPPED_TYPE, REDUCED_TYPE, OUTPUT, INPUT_IT>,
+                        INPUT_IT{first},
+                        size_t{num},
+                        Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>{std::move(mapper)},
+                        Functions::CombineFunc<MAPPED_TYPE>{std::move(combiner)},
+                        Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>{std::move(reducer)},
+                        getNumCoroutineThreads());
+}
+
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class OUTPUT,
+          class INPUT>
+ThreadContextPtr<Buffer<OUTPUT>>
+Dispatcher::mapReduceStream(std::shared_ptr<ICoroFuture<Buffer<INPUT>>> input,
+                          Functions::StreamMapFunc<KEY, MAPPED_TYPE, INPUT> mapper,
+                          Functions::FoldFunc<REDUCED_TYPE, MAPPED_TYPE> reducer,
+                          size_t windowSize)
+{
+    return post<Buffer<OUTPUT>>(Util::mapReduceStreamCoro<KEY, MAPPED_TYPE, REDUCED_TYPE, OUTPUT, INPUT>,
+                                CoroFuturePtr<Buffer<INPUT>>{std::move(input)},
+                                Functions::StreamMapFunc<KEY, MAPPED_TYPE, INPUT>{std::move(mapper)},
+                                Functions::FoldFunc<REDUCED_TYPE, MAPPED_TYPE>{std::move(reducer)},
+                                size_t{windowSize});
+}
+
+template <class RET, class INPUT_IT, class>
+ThreadContextPtr<RET>
+Dispatcher::reduce(INPUT_IT first,
+                   INPUT_IT last,
+                   RET init,
+                   Functions::BinaryFunc<RET> op)
+{
+    return reduce<RET>(first, std::distance(first, last), std::move(init), std::move(op));
+}
+
+template <class RET, class INPUT_IT>
+ThreadContextPtr<RET>
+Dispatcher::reduce(INPUT_IT first,
+                   size_t num,
+                   RET init,
+                   Functions::BinaryFunc<RET> op)
+{
+    return post<RET>(Util::transformReduceCoro<RET, INPUT_IT, Util::IdentityTransform>,
+                     INPUT_IT{first},
+                     size_t{num},
+                     RET{std::move(init)},
+                     Functions::BinaryFunc<RET>{std::move(op)},
+                     Util::IdentityTransform{},
+                     getNumCoroutineThreads());
+}
+
+template <class RET, class INPUT_IT, class>
+ThreadContextPtr<RET>
+Dispatcher::transformReduce(INPUT_IT first,
+                            INPUT_IT last,
+                            RET init,
+                            Functions::BinaryFunc<RET> reduceOp,
+                            Functions::ForEachFunc<RET, INPUT_IT> transform)
+{
+    return transformReduce<RET>(first, std::distance(first, last), std::move(init), std::move(reduceOp), std::move(transform));
+}
+
+template <class RET, class INPUT_IT>
+ThreadContextPtr<RET>
+Dispatcher::transformReduce(INPUT_IT first,
+                            size_t num,
+                            RET init,
+                            Functions::BinaryFunc<RET> reduceOp,
+                            Functions::ForEachFunc<RET, INPUT_IT> transform)
+{
+    return post<RET>(Util::transformReduceCoro<RET, INPUT_IT, Functions::ForEachFunc<RET, INPUT_IT>>,
+                     INPUT_IT{first},
+                     size_t{num},
+                     RET{std::move(init)},
+                     Functions::BinaryFunc<RET>{std::move(reduceOp)},
+                     Functions::ForEachFunc<RET, INPUT_IT>{std::move(transform)},
+                     getNumCoroutineThreads());
+}
+
+template <class RET, class INPUT_IT, class>
+ThreadContextPtr<std::vector<RET>>
+Dispatcher::inclusiveScan(INPUT_IT first,
+                          INPUT_IT last,
+                          Functions::BinaryFunc<RET> op)
+{
+    return inclusiveScan<RET>(first, std::distance(first, last), std::move(op));
+}
+
+template <class RET, class INPUT_IT>
+ThreadContextPtr<std::vector<RET>>
+Dispatcher::inclusiveScan(INPUT_IT first,
+                          size_t num,
+                          Functions::BinaryFunc<RET> op)
+{
+    return post<std::vector<RET>>(Util::scanCoro<RET, INPUT_IT>,
+                                  INPUT_IT{first},
+                                  size_t{num},
+                                  true,
+                                  RET{},
+                                  Functions::BinaryFunc<RET>{std::move(op)},
+                                  getNumCoroutineThreads());
+}
+
+template <class RET, class INPUT_IT, class>
+ThreadContextPtr<std::vector<RET>>
+Dispatcher::exclusiveScan(INPUT_IT first,
+                          INPUT_IT last,
+                          RET init,
+                          Functions::BinaryFunc<RET> op)
+{
+    return exclusiveScan<RET>(first, std::distance(first, last), std::move(init), std::move(op));
+}
+
+template <class RET, class INPUT_IT>
+ThreadContextPtr<std::vector<RET>>
+Dispatcher::exclusiveScan(INPUT_IT first,
+                          size_t num,
+                          RET init,
+                          Functions::BinaryFunc<RET> op)
+{
+    return post<std::vector<RET>>(Util::scanCoro<RET, INPUT_IT>,
+                                  INPUT_IT{first},
+                                  size_t{num},
+                                  false,
+                                  RET{std::move(init)},
+                                  Functions::BinaryFunc<RET>{std::move(op)},
+                                  getNumCoroutineThreads());
+}
+
+template <class RANDOM_IT, class COMPARE>
+ThreadContextPtr<int>
+Dispatcher::sort(RANDOM_IT first,
+                 RANDOM_IT last,
+                 COMPARE compare)
+{
+    return post<int>(Util::sortCoro<RANDOM_IT, COMPARE>,
+                     RANDOM_IT{first},
+                     RANDOM_IT{last},
+                     COMPARE{std::move(compare)},
+                     false,
+                     getNumCoroutineThreads());
+}
+
+template <class RANDOM_IT, class COMPARE>
+ThreadContextPtr<int>
+Dispatcher::stableSort(RANDOM_IT first,
+                       RANDOM_IT last,
+                       COMPARE compare)
+{
+    return post<int>(Util::sortCoro<RANDOM_IT, COMPARE>,
+                     RANDOM_IT{first},
+                     RANDOM_IT{last},
+                     COMPARE{std::move(compare)},
+                     true,
+                     getNumCoroutineThreads());
+}
+
 inline
 void Dispatcher::terminate()
 {
@@ -236,21 +1230,31 @@ void Dispatcher::drain(std::chrono::milliseconds timeout)
 {
     _drain = true;
     
-    auto start = std::chrono::high_resolution_clock::now();
-    
-    //wait until all queues have completed their work
-    YieldingThread yield;
-    while (!empty())
-    {
-        yield();
-        
-        //check remaining time
-        if (timeout != std::chrono::milliseconds::zero())
+    if (_dispatcher.getNumManualCoroutineQueues() == 0)
+    {
+        //sleep until the last outstanding task completes or until the timeout expires
+        _dispatcher.getTaskCounter().wait(timeout);
+    }
+    else
+    {
+        //nobody else runs the manual queues. Poll for the coroutines signalled in the meantime.
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (true)
         {
-            auto present = std::chrono::high_resolution_clock::now();
-            if (std::chrono::duration_cast<std::chrono::milliseconds>(present-start) > timeout)
+            _dispatcher.runUntilIdle();
+            std::chrono::milliseconds waitTime(1);
+            if (timeout.count() > 0)
+            {
+                auto now = std::chrono::steady_clock::now();
+                if (now >= deadline)
+                {
+                    break;
+                }
+                waitTime = std::max(std::chrono::milliseconds(1),
+                                    std::min(waitTime, std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now)));
+            }
+            if (_dispatcher.getTaskCounter().wait(waitTime))
             {
-                //timeout reached
                 break;
             }
         }
@@ -263,18 +1267,72 @@ void Dispatcher::drain(std::chrono::milliseconds timeout)
     _drain = false;
 }
 
+inline
+size_t Dispatcher::getNumOutstandingTasks() const
+{
+    return _dispatcher.getNumOutstandingTasks();
+}
+
+inline
+void Dispatcher::onQuiescence(std::function<void()> callback)
+{
+    _dispatcher.getTaskCounter().onQuiescence(std::move(callback));
+}
+
+inline
+std::future<void> Dispatcher::whenQuiescent()
+{
+    return _dispatcher.getTaskCounter().whenQuiescent();
+}
+
 inline
 int Dispatcher::getNumCoroutineThreads() const
 {
     return _dispatcher.getNumCoroutineThreads();
 }
 
+inline
+int Dispatcher::getNumManualCoroutineQueues() const
+{
+    return _dispatcher.getNumManualCoroutineQueues();
+}
+
+inline
+size_t Dispatcher::runOnce(int queueId, size_t budget)
+{
+    return _dispatcher.runOnce(queueId, budget);
+}
+
+inline
+size_t Dispatcher::runUntilIdle()
+{
+    return _dispatcher.runUntilIdle();
+}
+
 inline
 int Dispatcher::getNumIoThreads() const
 {
     return _dispatcher.getNumIoThreads();
 }
 
+inline
+int Dispatcher::getNumElasticIoThreads() const
+{
+    return _dispatcher.getNumElasticIoThreads();
+}
+
+inline
+void Dispatcher::setMaxNumIoThreads(int num)
+{
+    _dispatcher.setMaxNumIoThreads(num);
+}
+
+inline
+bool Dispatcher::cancelTimer(size_t timerId)
+{
+    return _dispatcher.getTimerQueue().cancel(timerId);
+}
+
 inline
 QueueStatistics Dispatcher::stats(IQueue::QueueType type,
                                   int queueId)
@@ -288,11 +1346,118 @@ void Dispatcher::resetStats()
     _dispatcher.resetStats();
 }
 
+inline
+AllocatorStatistics Dispatcher::allocatorStats() const
+{
+    AllocatorStatistics stats;
+    stats._task = poolStatistics(Allocator<TaskAllocator>::instance(AllocatorTraits::taskAllocSize()), 0);
+    stats._ioTask = poolStatistics(Allocator<IoTaskAllocator>::instance(AllocatorTraits::ioTaskAllocSize()), 0);
+    stats._context = poolStatistics(Allocator<ContextAllocator>::instance(AllocatorTraits::contextAllocSize()), 0);
+    stats._promise = poolStatistics(Allocator<PromiseAllocator>::instance(AllocatorTraits::promiseAllocSize()), 0);
+    stats._future = poolStatistics(Allocator<FutureAllocator>::instance(AllocatorTraits::futureAllocSize()), 0);
+    stats._queueList = poolStatistics(Allocator<QueueListAllocator>::instance(AllocatorTraits::queueListAllocSize()), 0);
+    stats._coroStack = poolStatistics(Allocator<CoroStackAllocator>::instance(AllocatorTraits::defaultCoroPoolAllocSize()), 0);
+    return stats;
+}
+
+inline
+MetricsSnapshot Dispatcher::metrics()
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_metricsMutex);
+    _lastMetrics = collectMetrics(_lastMetrics);
+    return _lastMetrics;
+}
+
+inline
+Profile Dispatcher::profile()
+{
+    return _dispatcher.profile();
+}
+
+inline
+MetricsSnapshot Dispatcher::collectMetrics(const MetricsSnapshot& previous)
+{
+    MetricsSnapshot snapshot = _dispatcher.metrics();
+    snapshot._pools = allocatorStats();
+    snapshot.computeRates(previous);
+    return snapshot;
+}
+
+inline
+const Configuration& Dispatcher::applyPoolSettings(const Configuration& config)
+{
+    using PoolType = Configuration::PoolType;
+    auto apply = [&config](PoolType pool, AllocatorTraits::size_type& size)
+    {
+        if (config.getPoolAllocSize(pool) > 0)
+        {
+            size = static_cast<AllocatorTraits::size_type>(config.getPoolAllocSize(pool));
+        }
+    };
+    apply(PoolType::Task, AllocatorTraits::taskAllocSize());
+    apply(PoolType::IoTask, AllocatorTraits::ioTaskAllocSize());
+    apply(PoolType::Context, AllocatorTraits::contextAllocSize());
+    apply(PoolType::Promise, AllocatorTraits::promiseAllocSize());
+    apply(PoolType::Future, AllocatorTraits::futureAllocSize());
+    apply(PoolType::QueueList, AllocatorTraits::queueListAllocSize());
+    apply(PoolType::CoroStack, AllocatorTraits::defaultCoroPoolAllocSize());
+    return config;
+}
+
+inline
+void Dispatcher::warmUpPools(const Configuration::CpuSet& cpuSet)
+{
+    auto warmUp = []()
+    {
+        poolWarmUp(Allocator<TaskAllocator>::instance(AllocatorTraits::taskAllocSize()), 0);
+        poolWarmUp(Allocator<IoTaskAllocator>::instance(AllocatorTraits::ioTaskAllocSize()), 0);
+        poolWarmUp(Allocator<ContextAllocator>::instance(AllocatorTraits::contextAllocSize()), 0);
+        poolWarmUp(Allocator<PromiseAllocator>::instance(AllocatorTraits::promiseAllocSize()), 0);
+        poolWarmUp(Allocator<FutureAllocator>::instance(AllocatorTraits::futureAllocSize()), 0);
+        poolWarmUp(Allocator<QueueListAllocator>::instance(AllocatorTraits::queueListAllocSize()), 0);
+        poolWarmUp(Allocator<CoroStackAllocator>::instance(AllocatorTraits::defaultCoroPoolAllocSize()), 0);
+    };
+    if (cpuSet.empty())
+    {
+        warmUp();
+        return;
+    }
+    //first touch from the requested node so that the pages are placed on it
+    std::thread([&cpuSet, &warmUp]()
+    {
+#ifdef _WIN32
+        DWORD_PTR mask = 0;
+        for (int cpu : cpuSet)
+        {
+            mask |= (DWORD_PTR)1 << cpu;
+        }
+        SetThreadAffinityMask(GetCurrentThread(), mask);
+#else
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        for (int cpu : cpuSet)
+        {
+            if ((cpu >= 0) && (cpu < CPU_SETSIZE))
+            {
+                CPU_SET(cpu, &mask);
+            }
+        }
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &mask);
+#endif
+        warmUp();
+    }).join();
+}
+
 template <class RET, class FUNC, class ... ARGS>
 ThreadContextPtr<RET>
-Dispatcher::postImpl(int queueId,
-                     bool isHighPriority,
+Dispatcher::postImpl(CancellationToken::Ptr token,
+                     int queueId,
+                     IQueue::Priority priority,
+                     std::chrono::steady_clock::time_point deadline,
                      ITask::Type type,
+                     StackSizeClass stackSize,
+                     const char* label,
                      FUNC&& func,
                      ARGS&&... args)
 {
@@ -304,15 +1469,49 @@ Dispatcher::postImpl(int queueId,
     {
         throw std::runtime_error("Invalid coroutine queue id");
     }
-    auto ctx = ContextPtr<RET>(new Context<RET>(_dispatcher),
-                               Context<RET>::deleter);
-    auto task = Task::Ptr(new Task(ctx,
-                                   queueId,
-                                   isHighPriority,
-                                   type,
-                                   std::forward<FUNC>(func),
-                                   std::forward<ARGS>(args)...),
-                          Task::deleter);
+    if (type == ITask::Type::Standalone)
+    {
+        //continuation chains are only posted by end() and are not subject to admission
+        _dispatcher.admit(IQueue::QueueType::Coro, queueId, priority <= IQueue::Priority::High);
+    }
+    return postAdmittedImpl<RET>(std::move(token),
+                                 queueId,
+                                 priority,
+                                 deadline,
+                                 type,
+                                 stackSize,
+                                 label,
+                                 std::forward<FUNC>(func),
+                                 std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postAdmittedImpl(CancellationToken::Ptr token,
+                             int queueId,
+                             IQueue::Priority priority,
+                             std::chrono::steady_clock::time_point deadline,
+                             ITask::Type type,
+                             StackSizeClass stackSize,
+                             const char* label,
+                             FUNC&& func,
+                             ARGS&&... args)
+{
+    auto ctx = Context<RET>::create(_dispatcher);
+    auto task = Task::create(ctx,
+                             queueId,
+                             priority <= IQueue::Priority::High,
+                             type,
+                             stackSize,
+                             std::forward<FUNC>(func),
+                             std::forward<ARGS>(args)...);
+    task->setPriority(priority);
+    task->setDeadline(deadline);
+    task->setCancellationToken(std::move(token));
+    if (label)
+    {
+        task->setLabel(label);
+    }
     ctx->setTask(task);
     if (type == ITask::Type::Standalone)
     {
@@ -323,8 +1522,10 @@ Dispatcher::postImpl(int queueId,
 
 template <class RET, class FUNC, class ... ARGS>
 ThreadFuturePtr<RET>
-Dispatcher::postAsyncIoImpl(int queueId,
+Dispatcher::postAsyncIoImpl(CancellationToken::Ptr token,
+                            int queueId,
                             bool isHighPriority,
+                            std::chrono::steady_clock::time_point deadline,
                             FUNC&& func,
                             ARGS&&... args)
 {
@@ -336,15 +1537,102 @@ Dispatcher::postAsyncIoImpl(int queueId,
     {
         throw std::runtime_error("Invalid IO queue id");
     }
-    auto promise = PromisePtr<RET>(new Promise<RET>(), Promise<RET>::deleter);
-    auto task = IoTask::Ptr(new IoTask(promise,
-                                       queueId,
-                                       isHighPriority,
-                                       std::forward<FUNC>(func),
-                                       std::forward<ARGS>(args)...),
-                            IoTask::deleter);
+    _dispatcher.admit(IQueue::QueueType::IO, queueId, isHighPriority);
+    return postAsyncIoAdmittedImpl<RET>(std::move(token),
+                                        queueId,
+                                        isHighPriority,
+                                        deadline,
+                                        std::forward<FUNC>(func),
+                                        std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+ThreadFuturePtr<RET>
+Dispatcher::postAsyncIoAdmittedImpl(CancellationToken::Ptr token,
+                                    int queueId,
+                                    bool isHighPriority,
+                                    std::chrono::steady_clock::time_point deadline,
+                                    FUNC&& func,
+                                    ARGS&&... args)
+{
+    auto promise = Promise<RET>::create();
+    auto task = IoTask::create(promise,
+                               queueId,
+                               isHighPriority,
+                               std::forward<FUNC>(func),
+                               std::forward<ARGS>(args)...);
+    task->setCancellationToken(std::move(token));
+    task->setDeadline(deadline);
     _dispatcher.postAsyncIo(task);
     return promise->getIThreadFuture();
 }
 
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Dispatcher::postAtImpl(std::chrono::steady_clock::time_point time,
+                       int queueId,
+                       bool isHighPriority,
+                       FUNC&& func,
+                       ARGS&&... args)
+{
+    if (_drain)
+    {
+        throw std::runtime_error("Posting is disabled");
+    }
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid coroutine queue id");
+    }
+    auto ctx = Context<RET>::create(_dispatcher);
+    //The task and its coroutine stack are only created once the timer is due
+    auto caller = Util::bindTimerCaller(std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    DispatcherCore& dispatcher = _dispatcher;
+    dispatcher.getTimerQueue().add(time, TimerQueue::Duration::zero(), [&dispatcher, ctx, caller, queueId, isHighPriority]()
+    {
+        auto task = Task::create(ctx,
+                                 queueId,
+                                 isHighPriority,
+                                 ITask::Type::Standalone,
+                                 std::move(*caller));
+        ctx->setTask(task);
+        dispatcher.post(task);
+    });
+    return std::static_pointer_cast<IThreadContext<RET>>(ctx);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+size_t
+Dispatcher::postEveryImpl(std::chrono::milliseconds period,
+                          int queueId,
+                          bool isHighPriority,
+                          FUNC&& func,
+                          ARGS&&... args)
+{
+    if (_drain)
+    {
+        throw std::runtime_error("Posting is disabled");
+    }
+    if (queueId < (int)IQueue::QueueId::Any)
+    {
+        throw std::runtime_error("Invalid coroutine queue id");
+    }
+    if (period <= std::chrono::milliseconds::zero())
+    {
+        throw std::runtime_error("Invalid timer period");
+    }
+    auto caller = Util::bindTimerCaller(std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    DispatcherCore& dispatcher = _dispatcher;
+    return dispatcher.getTimerQueue().add(std::chrono::steady_clock::now() + period, period, [&dispatcher, caller, queueId, isHighPriority]()
+    {
+        auto ctx = Context<RET>::create(dispatcher);
+        auto task = Task::create(ctx,
+                                 queueId,
+                                 isHighPriority,
+                                 ITask::Type::Standalone,
+                                 typename std::decay<decltype(*caller)>::type(*caller)); //each instance runs a copy
+        ctx->setTask(task);
+        dispatcher.post(task);
+    });
+}
+
 }}
@@ -0,0 +1,110 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#ifdef __linux__
+#include <unistd.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#else
+#include <quantum/quantum_yielding_thread.h>
+#endif
+#include <climits>
+#include <quantum/quantum_traits.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+#ifdef __linux__
+static_assert(sizeof(std::atomic_int) == sizeof(int), "Cannot use an atomic as a futex word");
+#endif
+
+inline
+bool Futex::spin(const std::atomic_int& word, int value)
+{
+    for (unsigned i = ThreadTraits::blockingSpinCount(); i > 0; --i)
+    {
+        if (word.load(std::memory_order_acquire) != value)
+        {
+            return true;
+        }
+        SpinBackoff::cpuRelax();
+    }
+    return word.load(std::memory_order_acquire) != value;
+}
+
+inline
+void Futex::wait(std::atomic_int& word, int value)
+{
+    if (spin(word, value))
+    {
+        return;
+    }
+#ifdef __linux__
+    ::syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAIT_PRIVATE, value, nullptr, nullptr, 0);
+#else
+    if (word == value)
+    {
+        YieldingThread()();
+    }
+#endif
+}
+
+inline
+void Futex::waitFor(std::atomic_int& word, int value, std::chrono::nanoseconds time)
+{
+    if ((time <= std::chrono::nanoseconds::zero()) || spin(word, value))
+    {
+        return;
+    }
+#ifdef __linux__
+    struct timespec timeout;
+    timeout.tv_sec = std::chrono::duration_cast<std::chrono::seconds>(time).count();
+    timeout.tv_nsec = (time - std::chrono::seconds(timeout.tv_sec)).count();
+    ::syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAIT_PRIVATE, value, &timeout, nullptr, 0);
+#else
+    if (word == value)
+    {
+        YieldingThread()();
+    }
+#endif
+}
+
+inline
+void Futex::wakeOne(std::atomic_int& word)
+{
+#ifdef __linux__
+    ::syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+    UNUSED(word);
+#endif
+}
+
+inline
+void Futex::wakeAll(std::atomic_int& word)
+{
+#ifdef __linux__
+    ::syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+    UNUSED(word);
+#endif
+}
+
+}}
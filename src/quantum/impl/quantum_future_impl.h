@@ -28,12 +28,12 @@ namespace quantum {
 #endif
 #ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
     #ifdef __QUANTUM_ALLOCATE_POOL_FROM_HEAP
-        using FutureAllocator = HeapAllocator<Future<int>>;
+        using FutureAllocator = HeapAllocator<SharedBlock<Future<int>>>;
     #else
-        using FutureAllocator = StackAllocator<Future<int>, __QUANTUM_FUTURE_ALLOC_SIZE>;
+        using FutureAllocator = StackAllocator<SharedBlock<Future<int>>, __QUANTUM_FUTURE_ALLOC_SIZE>;
     #endif
 #else
-    using FutureAllocator = StlAllocator<Future<int>>;
+    using FutureAllocator = StlAllocator<SharedBlock<Future<int>>>;
 #endif
 
 //==============================================================================================
@@ -46,6 +46,20 @@ V IThreadFuture<T>::pull(bool& isBufferClosed)
     return static_cast<Impl*>(this)->template pull<BUF>(isBufferClosed);
 }
 
+template <class T>
+template <class FUNC>
+void IThreadFuture<T>::onReady(FUNC&& func)
+{
+    addCallback(std::make_shared<FutureCallback<std::decay_t<FUNC>>>(std::forward<FUNC>(func)), 0);
+}
+
+template <class T>
+template <class BUF, class V>
+size_t IThreadFuture<T>::pullMany(std::vector<V>& values, size_t maxCount, bool& isBufferClosed)
+{
+    return static_cast<Impl*>(this)->template pullMany<BUF>(values, maxCount, isBufferClosed);
+}
+
 //==============================================================================================
 //                                class ICoroFuture
 //==============================================================================================
@@ -56,6 +70,20 @@ V ICoroFuture<T>::pull(ICoroSync::Ptr sync, bool& isBufferClosed)
     return static_cast<Impl*>(this)->template pull<BUF>(sync, isBufferClosed);
 }
 
+template <class T>
+template <class FUNC>
+void ICoroFuture<T>::onReady(FUNC&& func)
+{
+    addCallback(std::make_shared<FutureCallback<std::decay_t<FUNC>>>(std::forward<FUNC>(func)), 0);
+}
+
+template <class T>
+template <class BUF, class V>
+size_t ICoroFuture<T>::pullMany(ICoroSync::Ptr sync, std::vector<V>& values, size_t maxCount, bool& isBufferClosed)
+{
+    return static_cast<Impl*>(this)->template pullMany<BUF>(sync, values, maxCount, isBufferClosed);
+}
+
 //==============================================================================================
 //                                class Future
 //==============================================================================================
@@ -70,6 +98,27 @@ bool Future<T>::valid() const
     return _sharedState != nullptr;
 }
 
+template <class T>
+void Future<T>::addCallback(IFutureCallback::Ptr callback, size_t index) const
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    _sharedState->addCallback(std::move(callback), index);
+}
+
+template <class T>
+void Future<T>::removeCallback(const IFutureCallback::Ptr& callback) const
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    _sharedState->removeCallback(callback);
+}
+
+template <class T>
+template <class FUNC>
+void Future<T>::onReady(FUNC&& func)
+{
+    addCallback(std::make_shared<FutureCallback<std::decay_t<FUNC>>>(std::forward<FUNC>(func)), 0);
+}
+
 template <class T>
 T Future<T>::get()
 {
@@ -143,6 +192,22 @@ V Future<T>::pull(ICoroSync::Ptr sync, bool& isBufferClosed)
     return _sharedState->template pull<BUF>(sync, isBufferClosed);
 }
 
+template <class T>
+template <class BUF, class V>
+size_t Future<T>::pullMany(std::vector<V>& values, size_t maxCount, bool& isBufferClosed)
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    return _sharedState->template pullMany<BUF>(values, maxCount, isBufferClosed);
+}
+
+template <class T>
+template <class BUF, class V>
+size_t Future<T>::pullMany(ICoroSync::Ptr sync, std::vector<V>& values, size_t maxCount, bool& isBufferClosed)
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    return _sharedState->template pullMany<BUF>(sync, values, maxCount, isBufferClosed);
+}
+
 template <class T>
 void* Future<T>::operator new(size_t)
 {
@@ -152,17 +217,21 @@ void* Future<T>::operator new(size_t)
 template <class T>
 void Future<T>::operator delete(void* p)
 {
-    Allocator<FutureAllocator>::instance(AllocatorTraits::futureAllocSize()).deallocate(static_cast<Future<int>*>(p));
+    Allocator<FutureAllocator>::instance(AllocatorTraits::futureAllocSize()).deallocate(static_cast<SharedBlock<Future<int>>*>(p));
 }
 
 template <class T>
 void Future<T>::deleter(Future<T>* p)
 {
-#ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
-    Allocator<FutureAllocator>::instance(AllocatorTraits::futureAllocSize()).dispose(reinterpret_cast<Future<int>*>(p));
-#else
-    delete p;
-#endif
+    delete p; //destroys and returns the block to the pool
+}
+
+template <class T>
+template <class ... ARGS>
+typename Future<T>::Ptr Future<T>::create(ARGS&&... args)
+{
+    return std::allocate_shared<Future<T>>(SharedAllocator<Future<T>, FutureAllocator, &AllocatorTraits::futureAllocSize>(),
+                                           std::forward<ARGS>(args)...);
 }
 
 }}
@@ -0,0 +1,139 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                class Generator
+//==============================================================================================
+template <class T>
+template <class FUNC, class ... ARGS>
+Generator<T>::Generator(FUNC&& func, ARGS&&... args) :
+    _func(makeCapture(std::forward<FUNC>(func), std::forward<ARGS>(args)...))
+{}
+
+template <class T>
+bool Generator<T>::next()
+{
+    if (!_source)
+    {
+        if (!_func)
+        {
+            return false; //moved from
+        }
+        //runs the function until it produces its first value
+        Function<int(Sink&)> func = std::move(*_func);
+        _func = boost::none;
+        _source.emplace(Allocator<CoroStackAllocator>::instance(AllocatorTraits::defaultCoroPoolAllocSize()),
+                        [func = std::move(func)](Sink& sink) mutable
+        {
+            func(sink);
+        });
+    }
+    else if (*_source)
+    {
+        (*_source)();
+    }
+    return !done();
+}
+
+template <class T>
+T& Generator<T>::value()
+{
+    if (!_source || !*_source)
+    {
+        throw std::runtime_error("Generator has no value");
+    }
+    return *typename Source::iterator(&*_source);
+}
+
+template <class T>
+bool Generator<T>::done() const
+{
+    return _source ? !*_source : !_func;
+}
+
+template <class T>
+typename Generator<T>::Iterator Generator<T>::begin()
+{
+    if (!_source)
+    {
+        next();
+    }
+    return done() ? end() : Iterator(this);
+}
+
+template <class T>
+typename Generator<T>::Iterator Generator<T>::end()
+{
+    return Iterator();
+}
+
+//==============================================================================================
+//                                class Generator::Iterator
+//==============================================================================================
+template <class T>
+Generator<T>::Iterator::Iterator(Generator* generator) :
+    _generator(generator)
+{}
+
+template <class T>
+typename Generator<T>::Iterator& Generator<T>::Iterator::operator++()
+{
+    if (!_generator->next())
+    {
+        _generator = nullptr;
+    }
+    return *this;
+}
+
+template <class T>
+void Generator<T>::Iterator::operator++(int)
+{
+    ++(*this);
+}
+
+template <class T>
+typename Generator<T>::Iterator::reference Generator<T>::Iterator::operator*() const
+{
+    return _generator->value();
+}
+
+template <class T>
+typename Generator<T>::Iterator::pointer Generator<T>::Iterator::operator->() const
+{
+    return &_generator->value();
+}
+
+template <class T>
+bool Generator<T>::Iterator::operator==(const Iterator& other) const
+{
+    return _generator == other._generator;
+}
+
+template <class T>
+bool Generator<T>::Iterator::operator!=(const Iterator& other) const
+{
+    return _generator != other._generator;
+}
+
+}}
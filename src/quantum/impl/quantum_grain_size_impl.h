@@ -0,0 +1,61 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+GrainSize::GrainSize(size_t numElements, std::chrono::microseconds target) :
+    _numElements(numElements),
+    _target(target)
+{}
+
+inline
+GrainSize GrainSize::fixed(size_t numElements)
+{
+    return GrainSize(numElements ? numElements : 1, std::chrono::microseconds::zero());
+}
+
+inline
+GrainSize GrainSize::adaptive(std::chrono::microseconds target)
+{
+    return GrainSize(0, target);
+}
+
+inline
+bool GrainSize::isAdaptive() const
+{
+    return _numElements == 0;
+}
+
+inline
+size_t GrainSize::numElements() const
+{
+    return _numElements;
+}
+
+inline
+std::chrono::microseconds GrainSize::target() const
+{
+    return _target;
+}
+
+}}
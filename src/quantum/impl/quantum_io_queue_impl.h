@@ -18,7 +18,6 @@
 //##############################################################################################
 //#################################### IMPLEMENTATIONS #########################################
 //##############################################################################################
-#include <cmath>
 
 namespace Bloomberg {
 namespace quantum {
@@ -31,22 +30,40 @@ IoQueue::IoQueue() :
 
 inline
 IoQueue::IoQueue(const Configuration& config,
-                 std::vector<IoQueue>* sharedIoQueues) :
+                 std::vector<IoQueue>* sharedIoQueues,
+                 bool isElastic,
+                 TaskCounter* taskCounter,
+                 bool startThread) :
     _sharedIoQueues(sharedIoQueues),
     _loadBalanceSharedIoQueues(config.getLoadBalanceSharedIoQueues()),
-    _loadBalancePollIntervalMs(config.getLoadBalancePollIntervalMs()),
-    _loadBalancePollIntervalBackoffPolicy(config.getLoadBalancePollIntervalBackoffPolicy()),
-    _loadBalancePollIntervalNumBackoffs(config.getLoadBalancePollIntervalNumBackoffs()),
-    _loadBalanceBackoffNum(0),
+    _idlePolicy(config.getIdlePolicy()),
+    _idleSpinTimeUs(config.getIdleSpinTimeUs()),
+    _idleTimeoutMs(isElastic ? config.getIoThreadIdleTimeoutMs() : std::chrono::milliseconds::zero()),
+    _isLatencyTimingEnabled(config.getLatencyStatistics()),
+    _isWatchdogEnabled(config.isWatchdogEnabled()),
+    _isPerfCountingEnabled(config.getHardwareCounterStatistics()),
+    _isAbandonOnTerminate(config.getTerminatePolicy() == Configuration::TerminatePolicy::Abandon),
+    _taskCounter(taskCounter),
+    _coreId(-1),
+    _highWatermark(config.getQueueHighWatermark()),
+    _lowWatermark(config.getQueueLowWatermark()),
     _queue(Allocator<QueueListAllocator>::instance(AllocatorTraits::queueListAllocSize())),
     _isEmpty(true),
+    _isSleeping(false),
+    _isSaturated(false),
+    _isStarted(false),
     _isInterrupted(false),
+    _terminated(ATOMIC_FLAG_INIT),
+    _numIdleQueues(0),
+    _runStartTime(0),
     _isIdle(true),
-    _terminated(ATOMIC_FLAG_INIT)
+    _isRetired(false),
+    _isIdleRegistered(false),
+    _sharedQueueIndex(0),
+    _grabFromShared(false)
 {
-    if (_sharedIoQueues) {
-        //The shared queue doesn't have its own thread
-        _thread = std::make_shared<std::thread>(std::bind(&IoQueue::run, this));
+    if (startThread) {
+        start();
     }
 }
 
@@ -54,19 +71,34 @@ inline
 IoQueue::IoQueue(const IoQueue& other) :
     _sharedIoQueues(other._sharedIoQueues),
     _loadBalanceSharedIoQueues(other._loadBalanceSharedIoQueues),
-    _loadBalancePollIntervalMs(other._loadBalancePollIntervalMs),
-    _loadBalancePollIntervalBackoffPolicy(other._loadBalancePollIntervalBackoffPolicy),
-    _loadBalancePollIntervalNumBackoffs(other._loadBalancePollIntervalNumBackoffs),
-    _loadBalanceBackoffNum(0),
+    _idlePolicy(other._idlePolicy),
+    _idleSpinTimeUs(other._idleSpinTimeUs),
+    _idleTimeoutMs(other._idleTimeoutMs),
+    _isLatencyTimingEnabled(other._isLatencyTimingEnabled),
+    _isWatchdogEnabled(other._isWatchdogEnabled),
+    _isPerfCountingEnabled(other._isPerfCountingEnabled),
+    _isAbandonOnTerminate(other._isAbandonOnTerminate),
+    _taskCounter(other._taskCounter),
+    _coreId(-1),
+    _highWatermark(other._highWatermark),
+    _lowWatermark(other._lowWatermark),
     _queue(Allocator<QueueListAllocator>::instance(AllocatorTraits::queueListAllocSize())),
     _isEmpty(true),
+    _isSleeping(false),
+    _isSaturated(false),
+    _isStarted(false),
     _isInterrupted(false),
+    _terminated(ATOMIC_FLAG_INIT),
+    _numIdleQueues(0),
+    _runStartTime(0),
     _isIdle(true),
-    _terminated(ATOMIC_FLAG_INIT)
+    _isRetired(false),
+    _isIdleRegistered(false),
+    _sharedQueueIndex(0),
+    _grabFromShared(false)
 {
-    if (_sharedIoQueues) {
-        //The shared queue doesn't have its own thread
-        _thread = std::make_shared<std::thread>(std::bind(&IoQueue::run, this));
+    if (other._isStarted) {
+        start();
     }
 }
 
@@ -77,58 +109,150 @@ IoQueue::~IoQueue()
 }
 
 inline
-void IoQueue::pinToCore(int)
+void IoQueue::pinToCore(int coreId)
 {
-    //Not used
+    _coreId = coreId;
+    if (!_thread)
+    {
+        return; //applied once the thread is started. Shared queues never have one.
+    }
+#ifdef _WIN32
+    SetThreadAffinityMask(_thread->native_handle(), 1 << coreId);
+#else
+    int cpuSetSize = sizeof(cpu_set_t);
+    if (coreId >= 0 && (coreId <= cpuSetSize*8))
+    {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(coreId, &cpuSet);
+        pthread_setaffinity_np(_thread->native_handle(), cpuSetSize, &cpuSet);
+    }
+#endif
 }
 
 inline
 void IoQueue::run()
 {
+    if (_isPerfCountingEnabled)
+    {
+        //counters must be opened by the thread being measured
+        _perfCounters.open();
+    }
+    //Look for work once before sleeping so that this thread registers itself with the shared queue
+    _isEmpty = false;
+    _sharedQueueIndex = std::hash<std::thread::id>()(std::this_thread::get_id()); //spread the shared queue polls
     while (true)
     {
+        ITask::Ptr task;
         try
         {
-            ITask::Ptr task;
-            if (_loadBalanceSharedIoQueues)
+            task = _loadBalanceSharedIoQueues ? grabWorkItemFromAll() : grabWorkItem();
+            if (!task)
             {
-                do
+                bool isEmpty;
+                {
+                    //========================= LOCKED SCOPE =========================
+                    SpinLock::Guard lock(_spinlock);
+                    isEmpty = markEmpty();
+                }
+                if (isEmpty)
                 {
-                    task = grabWorkItemFromAll();
+                    //Catch any shared post which raced with the registration
+                    task = dequeueFromShared();
                     if (task)
                     {
-                        _loadBalanceBackoffNum = 0; //reset
-                        break;
+                        (*_sharedIoQueues)[0].removeIdleQueue(this);
+                        _isEmpty = false;
                     }
-                    YieldingThread()(getBackoffInterval());
-                } while (!_isInterrupted);
+                }
             }
-            else if (_isEmpty)
+            
+            if (!task && _isEmpty && ((_idlePolicy == Configuration::IdlePolicy::Park) || !spinForWork()))
             {
                 std::unique_lock<std::mutex> lock(_notEmptyMutex);
+                _isSleeping = true; //producers will notify from now on
                 //========================= BLOCK WHEN EMPTY =========================
                 //Wait for the queue to have at least one element
-                _notEmptyCond.wait(lock, [this]() -> bool { return !_isEmpty || _isInterrupted; });
+                auto predicate = [this]() -> bool { return !_isEmpty || _isInterrupted; };
+                if (_idleTimeoutMs.count() > 0)
+                {
+                    //elastic thread retires if nothing arrives in time
+                    bool isSignalled = _notEmptyCond.wait_for(lock, _idleTimeoutMs, predicate);
+                    _isSleeping = false;
+                    lock.unlock(); //posters signal while holding the idle registry lock
+                    if (!isSignalled)
+                    {
+                        //still registered means no poster has picked this thread in the meantime
+                        _isRetired = (*_sharedIoQueues)[0].removeIdleQueue(this);
+                    }
+                }
+                else
+                {
+                    _notEmptyCond.wait(lock, predicate);
+                    _isSleeping = false;
+                }
             }
             
-            if (_isInterrupted)
+            if (_isInterrupted || _isRetired)
             {
                 break;
             }
 
-            if (!_loadBalanceSharedIoQueues)
+            if (!task)
+            {
+                continue;
+            }
+            
+            if (task->isCancelled())
+            {
+                _stats.incCancelledCount();
+                task->terminate(); //break the promise
+                markDone(task);
+                continue;
+            }
+            
             {
-                //Iterate to the next runnable task
-                task = grabWorkItem();
-                if (!task)
+                IoTask* ioTask = static_cast<IoTask*>(task.get());
+                if (ioTask->hasDeadline() && (std::chrono::steady_clock::now() >= ioTask->getDeadline()))
                 {
+                    //nobody is waiting for the result anymore
+                    _stats.incExpiredCount();
+                    ioTask->expire();
+                    markDone(task);
                     continue;
                 }
             }
             
+            std::chrono::steady_clock::time_point start;
+            if (_isLatencyTimingEnabled || _isWatchdogEnabled)
+            {
+                start = std::chrono::steady_clock::now();
+                if (_isLatencyTimingEnabled)
+                {
+                    _stats.addWaitTime(start - std::static_pointer_cast<IoTask>(task)->getPostTime());
+                }
+                if (_isWatchdogEnabled)
+                {
+                    _runStartTime.store(start.time_since_epoch().count(), std::memory_order_relaxed);
+                }
+            }
+            
             //========================= START TASK =========================
+            Tracer::record(Tracer::EventType::IoStart, task->getQueueId(), static_cast<IoTask*>(task.get()));
             int rc = task->run();
+            Tracer::record(Tracer::EventType::IoEnd, task->getQueueId(), static_cast<IoTask*>(task.get()));
             //========================== END TASK ==========================
+            
+            if (_isWatchdogEnabled)
+            {
+                _runStartTime.store(0, std::memory_order_relaxed);
+            }
+            if (_isLatencyTimingEnabled)
+            {
+                auto end = std::chrono::steady_clock::now();
+                _stats.addRunTime(end - start);
+                _stats.addEndToEndTime(end - std::static_pointer_cast<IoTask>(task)->getPostTime());
+            }
 
             if (rc == (int)ITask::RetCode::Success)
             {
@@ -165,10 +289,15 @@ void IoQueue::run()
                 }
 #endif
             }
+            markDone(task);
         }
         catch (std::exception& ex)
         {
             UNUSED(ex);
+            if (task)
+            {
+                markDone(task);
+            }
 #ifdef __QUANTUM_PRINT_DEBUG
             std::lock_guard<std::mutex> guard(Util::LogMutex());
             std::cerr << "Caught exception: " << ex.what() << std::endl;
@@ -176,12 +305,21 @@ void IoQueue::run()
         }
         catch (...)
         {
+            if (task)
+            {
+                markDone(task);
+            }
 #ifdef __QUANTUM_PRINT_DEBUG
             std::lock_guard<std::mutex> guard(Util::LogMutex());
             std::cerr << "Caught unknown exception." << std::endl;
 #endif
         }
     } //while
+    
+    if (_isInterrupted && _isAbandonOnTerminate)
+    {
+        releaseTasks(); //in parallel with the other exiting threads
+    }
 }
 
 inline
@@ -191,6 +329,7 @@ void IoQueue::enqueue(ITask::Ptr task)
     {
         return; //nothing to do
     }
+    markPosted(task);
     //========================= LOCKED SCOPE =========================
     SpinLock::Guard lock(_spinlock);
     doEnqueue(task);
@@ -203,6 +342,7 @@ bool IoQueue::tryEnqueue(ITask::Ptr task)
     {
         return false; //nothing to do
     }
+    markPosted(task);
     //========================= LOCKED SCOPE =========================
     SpinLock::Guard lock(_spinlock, SpinLock::TryToLock{});
     if (lock.ownsLock())
@@ -212,24 +352,122 @@ bool IoQueue::tryEnqueue(ITask::Ptr task)
     return lock.ownsLock();
 }
 
+inline
+void IoQueue::enqueueBatch(const std::vector<IoTask::Ptr>& tasks)
+{
+    if (tasks.empty())
+    {
+        return; //nothing to do
+    }
+    if (_isLatencyTimingEnabled)
+    {
+        auto now = std::chrono::steady_clock::now();
+        for (auto&& task : tasks)
+        {
+            task->setPostTime(now);
+        }
+    }
+    for (auto&& task : tasks)
+    {
+        Tracer::record(Tracer::EventType::IoPost, task->getQueueId(), task.get());
+    }
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    for (auto&& task : tasks)
+    {
+        doEnqueueNoSignal(task);
+    }
+    if (_sharedIoQueues)
+    {
+        signalEmptyCondition(false);
+    }
+}
+
+inline
+void IoQueue::markPosted(ITask::Ptr& task)
+{
+    if (_isLatencyTimingEnabled)
+    {
+        std::static_pointer_cast<IoTask>(task)->setPostTime(std::chrono::steady_clock::now());
+    }
+    Tracer::record(Tracer::EventType::IoPost, task->getQueueId(), static_cast<IoTask*>(task.get()));
+}
+
+inline
+void IoQueue::markDone(ITask::Ptr& task)
+{
+    //Release the task and report the queue as idle ahead of its next poll so that nothing
+    //is left running on this thread once the dispatcher has drained
+    task.reset();
+    _isIdle = true;
+    if (_taskCounter)
+    {
+        _taskCounter->decrement();
+    }
+    notifyIfDrained();
+}
+
 inline
 void IoQueue::doEnqueue(ITask::Ptr task)
 {
-    if (task->isHighPriority())
+    doEnqueueNoSignal(task);
+    if (_sharedIoQueues)
+    {
+        signalEmptyCondition(false); //shared queues are signalled by the dispatcher via wakeIdleQueue()
+    }
+}
+
+inline
+void IoQueue::doEnqueueNoSignal(ITask::Ptr task)
+{
+    IoTask::Ptr ioTask = std::static_pointer_cast<IoTask>(task);
+    if (ioTask->isHighPriority())
     {
         _stats.incHighPriorityCount();
-        _queue.emplace_front(std::static_pointer_cast<IoTask>(task));
+    }
+    if (ioTask->hasDeadline())
+    {
+        insertByDeadline(std::move(ioTask));
+    }
+    else if (ioTask->isHighPriority())
+    {
+        _queue.emplace_front(std::move(ioTask));
     }
     else
     {
-        _queue.emplace_back(std::static_pointer_cast<IoTask>(task));
+        _queue.emplace_back(std::move(ioTask));
     }
     _stats.incPostedCount();
     _stats.incNumElements();
-    if (!_loadBalanceSharedIoQueues)
+    if (_taskCounter)
     {
-        signalEmptyCondition(false);
+        _taskCounter->increment();
+    }
+}
+
+inline
+void IoQueue::insertByDeadline(IoTask::Ptr task)
+{
+    //Run ahead of any task of the same priority which has no deadline or a later one.
+    //High priority tasks are all at the front of the queue.
+    TaskListIter it = _queue.begin();
+    if (!task->isHighPriority())
+    {
+        while ((it != _queue.end()) && (*it)->isHighPriority())
+        {
+            ++it;
+        }
+    }
+    for (; it != _queue.end(); ++it)
+    {
+        if (!(*it)->hasDeadline() ||
+            (task->getDeadline() < (*it)->getDeadline()) ||
+            (task->isHighPriority() && !(*it)->isHighPriority()))
+        {
+            break;
+        }
     }
+    _queue.insert(it, std::move(task));
 }
 
 inline
@@ -265,21 +503,37 @@ ITask::Ptr IoQueue::doDequeue(std::atomic_bool& hint)
         ITask::Ptr task = _queue.front();
         _queue.pop_front();
         _stats.decNumElements();
+        notifyIfDrained();
         return task;
     }
     return nullptr;
 }
 
+inline
+void IoQueue::notifyIfDrained()
+{
+    if (_highWatermark == 0)
+    {
+        return;
+    }
+    //Pairs with the fence of TaskCounter::waitForAdmission() so that either the poster sees the drained
+    //queue or this thread sees the saturated flag
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_isSaturated && (size() <= _lowWatermark) && _isSaturated.exchange(false) && _taskCounter)
+    {
+        _taskCounter->notifyAdmission();
+    }
+}
+
 inline
 ITask::Ptr IoQueue::tryDequeueFromShared()
 {
-    static size_t index = 0;
     ITask::Ptr task;
     size_t size = 0;
     
     for (size_t i = 0; i < (*_sharedIoQueues).size(); ++i)
     {
-        IoQueue& queue = (*_sharedIoQueues)[++index % (*_sharedIoQueues).size()];
+        IoQueue& queue = (*_sharedIoQueues)[++_sharedQueueIndex % (*_sharedIoQueues).size()];
         size += queue.size();
         task = queue.tryDequeue(_isIdle);
         if (task)
@@ -296,19 +550,21 @@ ITask::Ptr IoQueue::tryDequeueFromShared()
 }
 
 inline
-std::chrono::milliseconds IoQueue::getBackoffInterval()
+ITask::Ptr IoQueue::dequeueFromShared()
 {
-    if (_loadBalanceBackoffNum < _loadBalancePollIntervalNumBackoffs) {
-        ++_loadBalanceBackoffNum;
-    }
-    if (_loadBalancePollIntervalBackoffPolicy == Configuration::BackoffPolicy::Linear)
-    {
-        return _loadBalancePollIntervalMs + (_loadBalancePollIntervalMs * _loadBalanceBackoffNum);
-    }
-    else
+    //Unlike tryDequeueFromShared() this waits on every lock so that a post still holding one is not missed
+    for (size_t i = 0; i < (*_sharedIoQueues).size(); ++i)
     {
-        return _loadBalancePollIntervalMs * static_cast<size_t>(std::exp2(_loadBalanceBackoffNum));
+        IoQueue& queue = (*_sharedIoQueues)[++_sharedQueueIndex % (*_sharedIoQueues).size()];
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(queue.getLock());
+        ITask::Ptr task = queue.doDequeue(_isIdle);
+        if (task)
+        {
+            return task;
+        }
     }
+    return nullptr;
 }
 
 inline
@@ -340,20 +596,111 @@ bool IoQueue::empty() const
 inline
 void IoQueue::terminate()
 {
-    if (!_terminated.test_and_set() && _sharedIoQueues)
+    if (!_terminated.test_and_set())
     {
+        if (_sharedIoQueues)
+        {
+            interrupt();
+            if (_thread)
+            {
+                _thread->join();
+            }
+            (*_sharedIoQueues)[0].removeIdleQueue(this);
+        }
+        releaseTasks(); //empty already if the thread has abandoned its tasks
+    }
+}
+
+inline
+void IoQueue::start()
+{
+    if (_isStarted || !_sharedIoQueues)
+    {
+        return; //the shared queue doesn't have its own thread
+    }
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_notEmptyMutex); //serializes with concurrent posters and with interrupt()
+    if (_thread || _isInterrupted)
+    {
+        return;
+    }
+    _thread = std::make_shared<std::thread>(std::bind(&IoQueue::run, this));
+    if (_coreId != -1)
+    {
+        pinToCore(_coreId);
+    }
+    _isStarted = true;
+}
+
+inline
+bool IoQueue::isStarted() const
+{
+    return _isStarted;
+}
+
+inline
+bool IoQueue::isSaturated()
+{
+    if (_highWatermark == 0)
+    {
+        return false;
+    }
+    size_t numTasks = size();
+    if (numTasks >= _highWatermark)
+    {
+        if (!_isSaturated.exchange(true))
+        {
+            _stats.incHighWatermarkCount();
+        }
+        return true;
+    }
+    if (_isSaturated && (numTasks <= _lowWatermark))
+    {
+        _isSaturated = false;
+    }
+    return _isSaturated;
+}
+
+inline
+void IoQueue::interrupt()
+{
+    if (!_sharedIoQueues)
+    {
+        return; //the shared queue doesn't have its own thread
+    }
+    {
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_notEmptyMutex);
         _isInterrupted = true;
-        if (!_loadBalanceSharedIoQueues) {
-            _notEmptyCond.notify_all();
+    }
+    _notEmptyCond.notify_all();
+}
+
+inline
+void IoQueue::releaseTasks()
+{
+    std::vector<IoTask::Ptr> tasks;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        tasks.reserve(_queue.size());
+        for (auto&& task : _queue)
+        {
+            tasks.push_back(std::move(task));
         }
-        _thread->join();
         _queue.clear();
     }
+    //destroying the tasks breaks their promises
+    tasks.clear();
 }
 
 inline
 IQueueStatistics& IoQueue::stats()
 {
+    if (_perfCounters.isOpen())
+    {
+        _stats.updatePerfCounts(_perfCounters);
+    }
     return _stats;
 }
 
@@ -366,65 +713,163 @@ SpinLock& IoQueue::getLock()
 inline
 void IoQueue::signalEmptyCondition(bool value)
 {
+    //Transitions to 'empty' are made by the running thread under the queue spinlock(s)
+    //so they cannot overwrite a concurrent 'not empty' signal.
+    _isEmpty = value;
+    if (!value && _isSleeping)
     {
-        //========================= LOCKED SCOPE =========================
-        std::lock_guard<std::mutex> lock(_notEmptyMutex);
-        _isEmpty = value;
+        {
+            //========================= LOCKED SCOPE =========================
+            //Ensures the thread is either inside wait() or has yet to evaluate its wait condition
+            std::lock_guard<std::mutex> lock(_notEmptyMutex);
+        }
+        _notEmptyCond.notify_all();
     }
-    if (!value)
+}
+
+inline
+bool IoQueue::isRetired() const
+{
+    return _isRetired;
+}
+
+inline
+bool IoQueue::spinForWork()
+{
+    auto start = std::chrono::steady_clock::now();
+    while (_isEmpty && !_isInterrupted)
     {
-        _notEmptyCond.notify_all();
+        if ((_idlePolicy == Configuration::IdlePolicy::SpinThenPark) &&
+            ((std::chrono::steady_clock::now() - start) >= _idleSpinTimeUs))
+        {
+            return false; //park
+        }
+        std::this_thread::yield();
     }
+    return true;
 }
 
 inline
 ITask::Ptr IoQueue::grabWorkItem()
 {
-    static bool grabFromShared = false;
     ITask::Ptr task = nullptr;
-    grabFromShared = !grabFromShared;
+    _grabFromShared = !_grabFromShared;
     
-    if (grabFromShared) {
-        //========================= LOCKED SCOPE (SHARED QUEUE) =========================
-        SpinLock::Guard lock((*_sharedIoQueues)[0].getLock());
-        task = (*_sharedIoQueues)[0].dequeue(_isIdle);
+    if (_grabFromShared) {
+        {
+            //========================= LOCKED SCOPE (SHARED QUEUE) =========================
+            SpinLock::Guard lock((*_sharedIoQueues)[0].getLock());
+            task = (*_sharedIoQueues)[0].dequeue(_isIdle);
+        }
         if (!task)
         {
             //========================= LOCKED SCOPE =========================
             SpinLock::Guard lock(_spinlock);
             task = dequeue(_isIdle);
-            if (!task)
-            {
-                signalEmptyCondition(true);
-            }
         }
     }
     else {
-        //========================= LOCKED SCOPE =========================
-        SpinLock::Guard lock(_spinlock);
-        task = dequeue(_isIdle);
+        {
+            //========================= LOCKED SCOPE =========================
+            SpinLock::Guard lock(_spinlock);
+            task = dequeue(_isIdle);
+        }
         if (!task)
         {
             //========================= LOCKED SCOPE (SHARED QUEUE) =========================
             SpinLock::Guard lock((*_sharedIoQueues)[0].getLock());
             task = (*_sharedIoQueues)[0].dequeue(_isIdle);
-            if (!task)
-            {
-                signalEmptyCondition(true);
-            }
         }
     }
     return task;
 }
 
+inline
+bool IoQueue::markEmpty()
+{
+    //Called with this queue's lock held so that a concurrent post to this queue cannot be overwritten.
+    //Posts to the shared queue are caught by rescanning it after the registration.
+    if (!_queue.empty())
+    {
+        return false;
+    }
+    signalEmptyCondition(true);
+    (*_sharedIoQueues)[0].addIdleQueue(this);
+    return true;
+}
+
+inline
+void IoQueue::addIdleQueue(IoQueue* queue)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_idleLock);
+    if (!queue->_isIdleRegistered)
+    {
+        queue->_isIdleRegistered = true;
+        _idleQueues.push_back(queue);
+        ++_numIdleQueues;
+    }
+}
+
+inline
+bool IoQueue::removeIdleQueue(IoQueue* queue)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_idleLock);
+    if (!queue->_isIdleRegistered)
+    {
+        return false;
+    }
+    _idleQueues.erase(std::find(_idleQueues.begin(), _idleQueues.end(), queue));
+    queue->_isIdleRegistered = false;
+    --_numIdleQueues;
+    return true;
+}
+
+inline
+void IoQueue::wakeIdleQueue()
+{
+    wakeIdleQueues(1);
+}
+
+inline
+void IoQueue::wakeIdleQueues(size_t num)
+{
+    if ((num == 0) || (_numIdleQueues == 0))
+    {
+        return; //all workers are busy and will check the shared queues before going idle
+    }
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_idleLock);
+    //Wake the most recently idled workers. Workers which found other work since they registered
+    //are dropped as they will check the shared queues again before going idle.
+    while ((num > 0) && !_idleQueues.empty())
+    {
+        IoQueue* queue = _idleQueues.back();
+        _idleQueues.pop_back();
+        queue->_isIdleRegistered = false;
+        --_numIdleQueues;
+        if (queue->_isEmpty)
+        {
+            queue->signalEmptyCondition(false);
+            --num;
+        }
+    }
+}
+
+inline
+std::chrono::steady_clock::time_point IoQueue::getRunStartTime() const
+{
+    return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(_runStartTime.load(std::memory_order_relaxed)));
+}
+
 inline
 ITask::Ptr IoQueue::grabWorkItemFromAll()
 {
-    static bool grabFromShared = false;
     ITask::Ptr task = nullptr;
-    grabFromShared = !grabFromShared;
+    _grabFromShared = !_grabFromShared;
     
-    if (grabFromShared)
+    if (_grabFromShared)
     {
         task = tryDequeueFromShared();
         if (!task)
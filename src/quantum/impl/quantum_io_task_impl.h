@@ -28,12 +28,12 @@ namespace quantum {
 #endif
 #ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
     #ifdef __QUANTUM_ALLOCATE_POOL_FROM_HEAP
-        using IoTaskAllocator = HeapAllocator<IoTask>;
+        using IoTaskAllocator = HeapAllocator<SharedBlock<IoTask>>;
     #else
-        using IoTaskAllocator = StackAllocator<IoTask, __QUANTUM_IO_TASK_ALLOC_SIZE>;
+        using IoTaskAllocator = StackAllocator<SharedBlock<IoTask>, __QUANTUM_IO_TASK_ALLOC_SIZE>;
     #endif
 #else
-    using IoTaskAllocator = StlAllocator<IoTask>;
+    using IoTaskAllocator = StlAllocator<SharedBlock<IoTask>>;
 #endif
 
 template <class RET, class FUNC, class ... ARGS>
@@ -45,7 +45,9 @@ IoTask::IoTask(std::shared_ptr<Promise<RET>> promise,
                              std::forward<ARGS>(args)...)),
     _terminated(ATOMIC_FLAG_INIT),
     _queueId((int)IQueue::QueueId::Any),
-    _isHighPriority(false)
+    _isHighPriority(false),
+    _promise(promise),
+    _deadline(std::chrono::steady_clock::time_point::max())
 {
 }
 
@@ -60,7 +62,21 @@ IoTask::IoTask(std::shared_ptr<Promise<RET>> promise,
                              std::forward<ARGS>(args)...)),
     _terminated(ATOMIC_FLAG_INIT),
     _queueId(queueId),
-    _isHighPriority(isHighPriority)
+    _isHighPriority(isHighPriority),
+    _promise(promise),
+    _deadline(std::chrono::steady_clock::time_point::max())
+{
+}
+
+inline
+IoTask::IoTask(Function<int()> func,
+               int queueId,
+               bool isHighPriority) :
+    _func(std::move(func)),
+    _terminated(ATOMIC_FLAG_INIT),
+    _queueId(queueId),
+    _isHighPriority(isHighPriority),
+    _deadline(std::chrono::steady_clock::time_point::max())
 {
 }
 
@@ -75,7 +91,7 @@ void IoTask::terminate()
 {
     if (!_terminated.test_and_set())
     {
-        //not used
+        if (_promise) _promise->terminate();
     }
 }
 
@@ -115,6 +131,67 @@ bool IoTask::isHighPriority() const
     return _isHighPriority;
 }
 
+inline
+bool IoTask::isCancelled() const
+{
+    return _cancellationToken && _cancellationToken->isCancelled();
+}
+
+inline
+void IoTask::setCancellationToken(CancellationToken::Ptr token)
+{
+    _cancellationToken = std::move(token);
+}
+
+inline
+void IoTask::setDeadline(std::chrono::steady_clock::time_point deadline)
+{
+    _deadline = deadline;
+}
+
+inline
+bool IoTask::hasDeadline() const
+{
+    return _deadline != std::chrono::steady_clock::time_point::max();
+}
+
+inline
+std::chrono::steady_clock::time_point IoTask::getDeadline() const
+{
+    return _deadline;
+}
+
+inline
+void IoTask::expire()
+{
+    if (!_terminated.test_and_set())
+    {
+        if (_promise)
+        {
+            try
+            {
+                _promise->setException(std::make_exception_ptr(DeadlineExceededException()));
+            }
+            catch (...)
+            {
+                //promise has already been satisfied
+            }
+        }
+    }
+}
+
+inline
+void IoTask::setPostTime(std::chrono::steady_clock::time_point time)
+{
+    _postTime = time;
+}
+
+inline
+std::chrono::steady_clock::time_point IoTask::getPostTime() const
+{
+    return _postTime;
+}
+
 inline
 void* IoTask::operator new(size_t)
 {
@@ -124,17 +201,20 @@ void* IoTask::operator new(size_t)
 inline
 void IoTask::operator delete(void* p)
 {
-    Allocator<IoTaskAllocator>::instance(AllocatorTraits::ioTaskAllocSize()).deallocate(static_cast<IoTask*>(p));
+    Allocator<IoTaskAllocator>::instance(AllocatorTraits::ioTaskAllocSize()).deallocate(static_cast<SharedBlock<IoTask>*>(p));
 }
 
 inline
 void IoTask::deleter(IoTask* p)
 {
-#ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
-    Allocator<IoTaskAllocator>::instance(AllocatorTraits::ioTaskAllocSize()).dispose(p);
-#else
-    delete p;
-#endif
+    delete p; //destroys and returns the block to the pool
+}
+
+template <class ... ARGS>
+IoTask::Ptr IoTask::create(ARGS&&... args)
+{
+    return std::allocate_shared<IoTask>(SharedAllocator<IoTask, IoTaskAllocator, &AllocatorTraits::ioTaskAllocSize>(),
+                                        std::forward<ARGS>(args)...);
 }
 
 }}
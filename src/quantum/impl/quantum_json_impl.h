@@ -0,0 +1,450 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                class JsonValue::Parser
+//==============================================================================================
+class JsonValue::Parser
+{
+public:
+    explicit Parser(const std::string& text) :
+        _text(text),
+        _pos(0)
+    {}
+    
+    JsonValue parseDocument()
+    {
+        JsonValue value = parseValue(0);
+        skipWhitespace();
+        if (_pos != _text.size())
+        {
+            fail("unexpected trailing characters");
+        }
+        return value;
+    }
+    
+private:
+    static constexpr size_t MaxDepth = 64;
+    
+    [[noreturn]] void fail(const char* what) const
+    {
+        throw std::runtime_error(std::string("JSON parse error at offset ") + std::to_string(_pos) + ": " + what);
+    }
+    
+    void skipWhitespace()
+    {
+        while ((_pos < _text.size()) &&
+               ((_text[_pos] == ' ') || (_text[_pos] == '\t') || (_text[_pos] == '\n') || (_text[_pos] == '\r')))
+        {
+            ++_pos;
+        }
+    }
+    
+    bool consume(char c)
+    {
+        skipWhitespace();
+        if ((_pos < _text.size()) && (_text[_pos] == c))
+        {
+            ++_pos;
+            return true;
+        }
+        return false;
+    }
+    
+    void expect(char c)
+    {
+        if (!consume(c))
+        {
+            fail((std::string("expected '") + c + "'").c_str());
+        }
+    }
+    
+    bool consumeLiteral(const char* literal)
+    {
+        size_t length = std::char_traits<char>::length(literal);
+        if (_text.compare(_pos, length, literal) == 0)
+        {
+            _pos += length;
+            return true;
+        }
+        return false;
+    }
+    
+    JsonValue parseValue(size_t depth)
+    {
+        if (depth > MaxDepth)
+        {
+            fail("document nested too deeply");
+        }
+        skipWhitespace();
+        if (_pos == _text.size())
+        {
+            fail("unexpected end of document");
+        }
+        JsonValue value;
+        char c = _text[_pos];
+        if (c == '{')
+        {
+            ++_pos;
+            value._type = Type::Object;
+            if (consume('}'))
+            {
+                return value;
+            }
+            do
+            {
+                skipWhitespace();
+                if ((_pos == _text.size()) || (_text[_pos] != '"'))
+                {
+                    fail("expected a string key");
+                }
+                std::string key = parseString();
+                expect(':');
+                value._object.emplace_back(std::move(key), parseValue(depth + 1));
+            }
+            while (consume(','));
+            expect('}');
+        }
+        else if (c == '[')
+        {
+            ++_pos;
+            value._type = Type::Array;
+            if (consume(']'))
+            {
+                return value;
+            }
+            do
+            {
+                value._array.emplace_back(parseValue(depth + 1));
+            }
+            while (consume(','));
+            expect(']');
+        }
+        else if (c == '"')
+        {
+            value._type = Type::String;
+            value._string = parseString();
+        }
+        else if (consumeLiteral("true"))
+        {
+            value._type = Type::Boolean;
+            value._bool = true;
+        }
+        else if (consumeLiteral("false"))
+        {
+            value._type = Type::Boolean;
+            value._bool = false;
+        }
+        else if (consumeLiteral("null"))
+        {
+            value._type = Type::Null;
+        }
+        else
+        {
+            value._type = Type::Number;
+            value._number = parseNumber();
+        }
+        return value;
+    }
+    
+    double parseNumber()
+    {
+        //validate the JSON grammar first since strtod accepts more (hex, inf, leading '+', ...)
+        size_t start = _pos;
+        auto digits = [this]()->size_t
+        {
+            size_t begin = _pos;
+            while ((_pos < _text.size()) && (_text[_pos] >= '0') && (_text[_pos] <= '9'))
+            {
+                ++_pos;
+            }
+            return _pos - begin;
+        };
+        if ((_pos < _text.size()) && (_text[_pos] == '-'))
+        {
+            ++_pos;
+        }
+        if ((_pos < _text.size()) && (_text[_pos] == '0'))
+        {
+            ++_pos;
+        }
+        else if (digits() == 0)
+        {
+            fail("invalid value");
+        }
+        if ((_pos < _text.size()) && (_text[_pos] == '.'))
+        {
+            ++_pos;
+            if (digits() == 0)
+            {
+                fail("invalid number");
+            }
+        }
+        if ((_pos < _text.size()) && ((_text[_pos] == 'e') || (_text[_pos] == 'E')))
+        {
+            ++_pos;
+            if ((_pos < _text.size()) && ((_text[_pos] == '+') || (_text[_pos] == '-')))
+            {
+                ++_pos;
+            }
+            if (digits() == 0)
+            {
+                fail("invalid number");
+            }
+        }
+        return std::strtod(_text.substr(start, _pos - start).c_str(), nullptr);
+    }
+    
+    unsigned parseHex4()
+    {
+        if (_pos + 4 > _text.size())
+        {
+            fail("invalid unicode escape");
+        }
+        unsigned code = 0;
+        for (size_t i = 0; i < 4; ++i, ++_pos)
+        {
+            char c = _text[_pos];
+            code <<= 4;
+            if ((c >= '0') && (c <= '9')) code |= (unsigned)(c - '0');
+            else if ((c >= 'a') && (c <= 'f')) code |= (unsigned)(c - 'a' + 10);
+            else if ((c >= 'A') && (c <= 'F')) code |= (unsigned)(c - 'A' + 10);
+            else fail("invalid unicode escape");
+        }
+        return code;
+    }
+    
+    static void appendUtf8(std::string& out, unsigned code)
+    {
+        if (code < 0x80)
+        {
+            out += (char)code;
+        }
+        else if (code < 0x800)
+        {
+            out += (char)(0xC0 | (code >> 6));
+            out += (char)(0x80 | (code & 0x3F));
+        }
+        else if (code < 0x10000)
+        {
+            out += (char)(0xE0 | (code >> 12));
+            out += (char)(0x80 | ((code >> 6) & 0x3F));
+            out += (char)(0x80 | (code & 0x3F));
+        }
+        else
+        {
+            out += (char)(0xF0 | (code >> 18));
+            out += (char)(0x80 | ((code >> 12) & 0x3F));
+            out += (char)(0x80 | ((code >> 6) & 0x3F));
+            out += (char)(0x80 | (code & 0x3F));
+        }
+    }
+    
+    std::string parseString()
+    {
+        ++_pos; //opening quote
+        std::string out;
+        while (true)
+        {
+            if (_pos == _text.size())
+            {
+                fail("unterminated string");
+            }
+            char c = _text[_pos++];
+            if (c == '"')
+            {
+                return out;
+            }
+            if ((unsigned char)c < 0x20)
+            {
+                fail("control character in string");
+            }
+            if (c != '\\')
+            {
+                out += c;
+                continue;
+            }
+            if (_pos == _text.size())
+            {
+                fail("unterminated string");
+            }
+            switch (_text[_pos++])
+            {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u':
+                {
+                    unsigned code = parseHex4();
+                    if ((code >= 0xD800) && (code < 0xDC00) && consumeLiteral("\\u"))
+                    {
+                        unsigned low = parseHex4();
+                        if ((low < 0xDC00) || (low >= 0xE000))
+                        {
+                            fail("invalid surrogate pair");
+                        }
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, code);
+                    break;
+                }
+                default: fail("invalid escape sequence");
+            }
+        }
+    }
+    
+    //Members
+    const std::string&  _text;
+    size_t              _pos;
+};
+
+//==============================================================================================
+//                                class JsonValue
+//==============================================================================================
+inline
+JsonValue::JsonValue() :
+    _type(Type::Null),
+    _bool(false),
+    _number(0)
+{}
+
+inline
+JsonValue JsonValue::parse(const std::string& text)
+{
+    return Parser(text).parseDocument();
+}
+
+inline
+std::string JsonValue::quote(const std::string& value)
+{
+    static const char* hex = "0123456789abcdef";
+    std::string out("\"");
+    for (char c : value)
+    {
+        switch (c)
+        {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20)
+                {
+                    out += "\\u00";
+                    out += hex[(c >> 4) & 0xF];
+                    out += hex[c & 0xF];
+                }
+                else
+                {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+    return out;
+}
+
+inline
+JsonValue::Type JsonValue::type() const
+{
+    return _type;
+}
+
+inline
+bool JsonValue::asBool() const
+{
+    checkType(Type::Boolean);
+    return _bool;
+}
+
+inline
+double JsonValue::asNumber() const
+{
+    checkType(Type::Number);
+    return _number;
+}
+
+inline
+int64_t JsonValue::asInteger() const
+{
+    checkType(Type::Number);
+    //the bounds are exact powers of two, hence representable as doubles
+    if ((_number < -9223372036854775808.0) || (_number >= 9223372036854775808.0) || (_number != std::floor(_number)))
+    {
+        throw std::runtime_error("expected an integer");
+    }
+    return (int64_t)_number;
+}
+
+inline
+const std::string& JsonValue::asString() const
+{
+    checkType(Type::String);
+    return _string;
+}
+
+inline
+const JsonValue::Array& JsonValue::asArray() const
+{
+    checkType(Type::Array);
+    return _array;
+}
+
+inline
+const JsonValue::Object& JsonValue::asObject() const
+{
+    checkType(Type::Object);
+    return _object;
+}
+
+inline
+const char* JsonValue::typeName(Type type)
+{
+    switch (type)
+    {
+        case Type::Null: return "null";
+        case Type::Boolean: return "a boolean";
+        case Type::Number: return "a number";
+        case Type::String: return "a string";
+        case Type::Array: return "an array";
+        default: return "an object";
+    }
+}
+
+inline
+void JsonValue::checkType(Type type) const
+{
+    if (_type != type)
+    {
+        throw std::runtime_error(std::string("expected ") + typeName(type) + " but got " + typeName(_type));
+    }
+}
+
+}}
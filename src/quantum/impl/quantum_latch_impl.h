@@ -0,0 +1,125 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+thread_local static std::atomic_int s_latchThreadSignal{-1}; //thread specific (non-coroutine)
+
+//==============================================================================================
+//                                class Latch
+//==============================================================================================
+inline
+Latch::Latch(ptrdiff_t count) :
+    _count(count)
+{}
+
+inline
+void Latch::countDown(ptrdiff_t num)
+{
+    if (_count.fetch_sub(num, std::memory_order_acq_rel) != num)
+    {
+        return; //not the last arrival
+    }
+    std::list<Waiter> waiters;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        waiters.swap(_waiters);
+    }
+    for (auto&& waiter : waiters)
+    {
+        (*waiter.first) = 1;
+        if (waiter.second)
+        {
+            waiter.second->wakeUp();
+        }
+        else
+        {
+            Futex::wakeOne(*waiter.first);
+        }
+    }
+}
+
+inline
+bool Latch::tryWait() const
+{
+    return _count.load(std::memory_order_acquire) <= 0;
+}
+
+inline
+void Latch::wait()
+{
+    waitImpl(s_latchThreadSignal, nullptr);
+}
+
+inline
+void Latch::wait(ICoroSync::Ptr sync)
+{
+    waitImpl(sync->signal(), sync);
+}
+
+inline
+void Latch::arriveAndWait(ptrdiff_t num)
+{
+    countDown(num);
+    wait();
+}
+
+inline
+void Latch::arriveAndWait(ICoroSync::Ptr sync, ptrdiff_t num)
+{
+    countDown(num);
+    wait(sync);
+}
+
+inline
+void Latch::waitImpl(std::atomic_int& signal, ICoroSync::Ptr sync)
+{
+    if (tryWait())
+    {
+        return;
+    }
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        if (tryWait())
+        {
+            return; //the last arrival already drained the waiters
+        }
+        signal = 0; //clear signal flag
+        _waiters.emplace_back(&signal, sync);
+    }
+    while (signal == 0)
+    {
+        if (sync)
+        {
+            sync->getYieldHandle()(); //parked by the queue until signalled
+        }
+        else
+        {
+            Futex::wait(signal, 0);
+        }
+    }
+    signal = -1; //reset signal flag
+}
+
+}}
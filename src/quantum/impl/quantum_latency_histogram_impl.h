@@ -0,0 +1,198 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+inline
+LatencyHistogram::LatencyHistogram(const LatencyHistogram& other)
+{
+    reset();
+    *this += other;
+}
+
+inline
+LatencyHistogram& LatencyHistogram::operator=(const LatencyHistogram& other)
+{
+    if (this != &other)
+    {
+        reset();
+        *this += other;
+    }
+    return *this;
+}
+
+inline
+void LatencyHistogram::reset()
+{
+    for (auto&& bucket : _buckets)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    _count.store(0, std::memory_order_relaxed);
+    _totalNs.store(0, std::memory_order_relaxed);
+    _maxNs.store(0, std::memory_order_relaxed);
+}
+
+inline
+void LatencyHistogram::add(std::chrono::nanoseconds time)
+{
+    int64_t ns = (time.count() > 0) ? time.count() : 0;
+    _buckets[bucketIndex(std::chrono::nanoseconds(ns))].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _totalNs.fetch_add(ns, std::memory_order_relaxed);
+    int64_t maxNs = _maxNs.load(std::memory_order_relaxed);
+    while ((ns > maxNs) && !_maxNs.compare_exchange_weak(maxNs, ns, std::memory_order_relaxed));
+}
+
+inline
+size_t LatencyHistogram::count() const
+{
+    return _count.load(std::memory_order_relaxed);
+}
+
+inline
+std::chrono::nanoseconds LatencyHistogram::total() const
+{
+    return std::chrono::nanoseconds(_totalNs.load(std::memory_order_relaxed));
+}
+
+inline
+std::chrono::nanoseconds LatencyHistogram::max() const
+{
+    return std::chrono::nanoseconds(_maxNs.load(std::memory_order_relaxed));
+}
+
+inline
+std::chrono::nanoseconds LatencyHistogram::mean() const
+{
+    size_t num = count();
+    return (num == 0) ? std::chrono::nanoseconds::zero() : total() / (int64_t)num;
+}
+
+inline
+std::chrono::nanoseconds LatencyHistogram::percentile(double percent) const
+{
+    //Sum the buckets first since the total count may be updated concurrently
+    size_t num = 0;
+    for (auto&& bucket : _buckets)
+    {
+        num += bucket.load(std::memory_order_relaxed);
+    }
+    if (num == 0)
+    {
+        return std::chrono::nanoseconds::zero();
+    }
+    percent = (percent < 0) ? 0 : ((percent > 100) ? 100 : percent);
+    size_t rank = (size_t)(percent * num / 100);
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+    size_t cumulative = 0;
+    for (size_t i = 0; i < numBuckets; ++i)
+    {
+        cumulative += _buckets[i].load(std::memory_order_relaxed);
+        if (cumulative >= rank)
+        {
+            if (i == numBuckets-1)
+            {
+                return max();
+            }
+            //upper bound of the bucket
+            std::chrono::nanoseconds upper = bucketLowerBound(i+1) - std::chrono::nanoseconds(1);
+            return (upper < max()) ? upper : max();
+        }
+    }
+    return max();
+}
+
+inline
+size_t LatencyHistogram::bucketCount(size_t bucket) const
+{
+    return (bucket < numBuckets) ? _buckets[bucket].load(std::memory_order_relaxed) : 0;
+}
+
+inline
+std::chrono::nanoseconds LatencyHistogram::bucketLowerBound(size_t bucket)
+{
+    //the first two groups of sub-buckets are one nanosecond wide
+    if (bucket < 2*numSubBuckets)
+    {
+        return std::chrono::nanoseconds(bucket);
+    }
+    size_t shift = bucket / numSubBuckets - 1;
+    size_t subBucket = bucket % numSubBuckets;
+    return std::chrono::nanoseconds((int64_t)((numSubBuckets + subBucket) << shift));
+}
+
+inline
+size_t LatencyHistogram::bucketIndex(std::chrono::nanoseconds time)
+{
+    uint64_t ns = (time.count() > 0) ? (uint64_t)time.count() : 0;
+    if (ns < 2*numSubBuckets)
+    {
+        return (size_t)ns;
+    }
+    //position of the highest bit above the sub-bucket bits
+    size_t shift = 0;
+    while ((ns >> shift) >= 2*numSubBuckets)
+    {
+        ++shift;
+    }
+    size_t bucket = (shift + 1) * numSubBuckets + (size_t)((ns >> shift) - numSubBuckets);
+    return (bucket < numBuckets) ? bucket : numBuckets-1;
+}
+
+inline
+void LatencyHistogram::print(std::ostream& out) const
+{
+    auto us = [](std::chrono::nanoseconds time)->double { return time.count() / 1000.0; };
+    out << "count=" << count()
+        << " mean=" << us(mean())
+        << " p50=" << us(percentile(50))
+        << " p90=" << us(percentile(90))
+        << " p99=" << us(percentile(99))
+        << " max=" << us(max()) << " (us)";
+}
+
+inline
+LatencyHistogram& LatencyHistogram::operator+=(const LatencyHistogram& rhs)
+{
+    for (size_t i = 0; i < numBuckets; ++i)
+    {
+        _buckets[i].fetch_add(rhs._buckets[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    _count.fetch_add(rhs.count(), std::memory_order_relaxed);
+    _totalNs.fetch_add(rhs.total().count(), std::memory_order_relaxed);
+    int64_t rhsMaxNs = rhs.max().count();
+    int64_t maxNs = _maxNs.load(std::memory_order_relaxed);
+    while ((rhsMaxNs > maxNs) && !_maxNs.compare_exchange_weak(maxNs, rhsMaxNs, std::memory_order_relaxed));
+    return *this;
+}
+
+}}
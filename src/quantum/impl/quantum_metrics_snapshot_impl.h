@@ -0,0 +1,139 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                    class MetricsSnapshot
+//==============================================================================================
+inline
+MetricsSnapshot::MetricsSnapshot() :
+    _interval(0),
+    _sharedIoQueue{-1, 0, 0, 0, 0, 0, 0, 0}
+{}
+
+inline
+MetricsSnapshot::TimePoint MetricsSnapshot::time() const
+{
+    return _time;
+}
+
+inline
+std::chrono::nanoseconds MetricsSnapshot::interval() const
+{
+    return _interval;
+}
+
+inline
+const std::vector<MetricsSnapshot::QueueMetrics>& MetricsSnapshot::coroQueues() const
+{
+    return _coroQueues;
+}
+
+inline
+const std::vector<MetricsSnapshot::QueueMetrics>& MetricsSnapshot::ioQueues() const
+{
+    return _ioQueues;
+}
+
+inline
+const MetricsSnapshot::QueueMetrics& MetricsSnapshot::sharedIoQueue() const
+{
+    return _sharedIoQueue;
+}
+
+inline
+const AllocatorStatistics& MetricsSnapshot::pools() const
+{
+    return _pools;
+}
+
+inline
+void MetricsSnapshot::computeRates(const MetricsSnapshot& previous)
+{
+    if (previous._time == TimePoint())
+    {
+        return; //first snapshot
+    }
+    _interval = std::chrono::duration_cast<std::chrono::nanoseconds>(_time - previous._time);
+    double seconds = std::chrono::duration<double>(_interval).count();
+    if (seconds <= 0)
+    {
+        return;
+    }
+    for (size_t i = 0; i < _coroQueues.size() && i < previous._coroQueues.size(); ++i)
+    {
+        computeRates(_coroQueues[i], previous._coroQueues[i], seconds);
+    }
+    for (size_t i = 0; i < _ioQueues.size() && i < previous._ioQueues.size(); ++i)
+    {
+        computeRates(_ioQueues[i], previous._ioQueues[i], seconds);
+    }
+    computeRates(_sharedIoQueue, previous._sharedIoQueue, seconds);
+}
+
+inline
+void MetricsSnapshot::computeRates(QueueMetrics& metrics, const QueueMetrics& previous, double seconds)
+{
+    //counters going backwards have been reset in the meantime
+    metrics._postedPerSec = (metrics._posted >= previous._posted) ? (metrics._posted - previous._posted) / seconds : 0;
+    metrics._completedPerSec = (metrics._completed >= previous._completed) ? (metrics._completed - previous._completed) / seconds : 0;
+}
+
+inline
+void MetricsSnapshot::print(std::ostream& out, const QueueMetrics& metrics)
+{
+    out << "depth: " << metrics._depth
+        << " blocked: " << metrics._blocked
+        << " posted: " << metrics._posted
+        << " completed: " << metrics._completed
+        << " errors: " << metrics._errors
+        << " posted/s: " << metrics._postedPerSec
+        << " completed/s: " << metrics._completedPerSec << std::endl;
+}
+
+inline
+void MetricsSnapshot::print(std::ostream& out) const
+{
+    for (auto&& metrics : _coroQueues)
+    {
+        out << "Coroutine queue " << metrics._queueId << ": ";
+        print(out, metrics);
+    }
+    for (auto&& metrics : _ioQueues)
+    {
+        out << "IO queue " << metrics._queueId << ": ";
+        print(out, metrics);
+    }
+    out << "Shared IO queue: ";
+    print(out, _sharedIoQueue);
+    out << _pools;
+}
+
+inline
+std::ostream& operator<<(std::ostream& out, const MetricsSnapshot& snapshot)
+{
+    snapshot.print(out);
+    return out;
+}
+
+}}
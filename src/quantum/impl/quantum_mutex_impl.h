@@ -22,22 +22,36 @@
 namespace Bloomberg {
 namespace quantum {
 
+thread_local static std::atomic_int s_mutexThreadSignal{-1}; //thread specific (non-coroutine)
+
 //==============================================================================================
 //                                class Mutex
 //==============================================================================================
 inline
-Mutex::Mutex()
+Mutex::Mutex(Mode mode) :
+    _mode(mode),
+    _isLocked(false)
 {}
 
 inline
 void Mutex::lock()
 {
+    if (_mode == Mode::Fifo)
+    {
+        lockFifo(s_mutexThreadSignal, nullptr);
+        return;
+    }
     lockImpl(YieldingThread());
 }
 
 inline
 void Mutex::lock(ICoroSync::Ptr sync)
 {
+    if (_mode == Mode::Fifo)
+    {
+        lockFifo(sync->signal(), sync);
+        return;
+    }
     lockImpl(sync->getYieldHandle());
 }
 
@@ -50,15 +64,90 @@ void Mutex::lockImpl(YIELDING&& yield)
     }
 }
 
+inline
+void Mutex::lockFifo(std::atomic_int& signal, ICoroSync::Ptr sync)
+{
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        if (!_isLocked)
+        {
+            _isLocked = true;
+            return;
+        }
+        signal = 0; //clear signal flag
+        _waiters.emplace_back(&signal, sync);
+    }
+    if (sync)
+    {
+        //the queue parks the coroutine until it gets signalled
+        while (signal == 0)
+        {
+            sync->getYieldHandle()();
+        }
+    }
+    else
+    {
+        while (signal == 0)
+        {
+            Futex::wait(signal, 0);
+        }
+    }
+    signal = -1; //reset. Ownership has been handed over.
+}
+
+inline
+void Mutex::notify(Waiter& waiter)
+{
+    (*waiter.first) = 1;
+    if (waiter.second)
+    {
+        waiter.second->wakeUp();
+    }
+    else
+    {
+        Futex::wakeOne(*waiter.first);
+    }
+}
+
 inline
 bool Mutex::tryLock()
 {
+    if (_mode == Mode::Fifo)
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        if (_isLocked)
+        {
+            return false;
+        }
+        _isLocked = true;
+        return true;
+    }
     return _spinlock.tryLock();
 }
 
 inline
 void Mutex::unlock()
 {
+    if (_mode == Mode::Fifo)
+    {
+        Waiter waiter;
+        {
+            //========================= LOCKED SCOPE =========================
+            SpinLock::Guard lock(_spinlock);
+            if (_waiters.empty())
+            {
+                _isLocked = false;
+                return;
+            }
+            //the mutex stays locked and the oldest waiter becomes its owner
+            waiter = std::move(_waiters.front());
+            _waiters.pop_front();
+        }
+        notify(waiter);
+        return;
+    }
     _spinlock.unlock();
 }
 
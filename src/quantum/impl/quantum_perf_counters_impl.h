@@ -0,0 +1,129 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class PerfCounters
+//==============================================================================================
+inline
+PerfCounters::PerfCounters() :
+    _isOpen(false)
+{
+    _fds.fill(-1);
+}
+
+inline
+PerfCounters::~PerfCounters()
+{
+    close();
+}
+
+inline
+bool PerfCounters::open()
+{
+    close();
+#ifdef __linux__
+    static const std::array<std::pair<uint32_t, uint64_t>, numEvents> events = {{
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES}
+    }};
+    bool isOpen = false;
+    for (int i = 0; i < numEvents; ++i)
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = events[i].first;
+        attr.config = events[i].second;
+        //user space only so that unprivileged processes can count. Context switches happen in the kernel.
+        attr.exclude_kernel = (events[i].first == PERF_TYPE_HARDWARE) ? 1 : 0;
+        attr.exclude_hv = 1;
+        //pid 0 and cpu -1 count the calling thread on any cpu
+        _fds[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        isOpen = isOpen || (_fds[i] >= 0);
+    }
+    _isOpen = isOpen;
+#endif
+    return _isOpen;
+}
+
+inline
+void PerfCounters::close()
+{
+    _isOpen = false;
+    for (auto&& fd : _fds)
+    {
+#ifdef __linux__
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+#endif
+        fd = -1;
+    }
+}
+
+inline
+bool PerfCounters::isOpen() const
+{
+    return _isOpen;
+}
+
+inline
+uint64_t PerfCounters::read(PerfEvent event) const
+{
+    uint64_t value = 0;
+#ifdef __linux__
+    int fd = _fds[(int)event];
+    if (!_isOpen || (fd < 0) || (::read(fd, &value, sizeof(value)) != sizeof(value)))
+    {
+        return 0;
+    }
+#endif
+    return value;
+}
+
+inline
+const char* PerfCounters::name(PerfEvent event)
+{
+    switch (event)
+    {
+        case PerfEvent::CpuCycles: return "cycles";
+        case PerfEvent::Instructions: return "instructions";
+        case PerfEvent::CacheMisses: return "cache-misses";
+        case PerfEvent::BranchMisses: return "branch-misses";
+        case PerfEvent::ContextSwitches: return "context-switches";
+        default: return "unknown";
+    }
+}
+
+}}
@@ -0,0 +1,361 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                class PipelineStage
+//==============================================================================================
+inline
+PipelineStage::PipelineStage(size_t capacity, size_t parallelism) :
+    _capacity(std::max<size_t>(1, capacity)),
+    _parallelism(std::max<size_t>(1, parallelism)),
+    _order(Order::InOrder),
+    _execution(Execution::Coroutine)
+{}
+
+inline
+void PipelineStage::setCapacity(size_t capacity)
+{
+    _capacity = std::max<size_t>(1, capacity);
+}
+
+inline
+void PipelineStage::setParallelism(size_t parallelism)
+{
+    _parallelism = std::max<size_t>(1, parallelism);
+}
+
+inline
+void PipelineStage::setOrder(Order order)
+{
+    _order = order;
+}
+
+inline
+void PipelineStage::setExecution(Execution execution)
+{
+    _execution = execution;
+}
+
+inline
+size_t PipelineStage::getCapacity() const
+{
+    return _capacity;
+}
+
+inline
+size_t PipelineStage::getParallelism() const
+{
+    return _parallelism;
+}
+
+inline
+PipelineStage::Order PipelineStage::getOrder() const
+{
+    return _order;
+}
+
+inline
+PipelineStage::Execution PipelineStage::getExecution() const
+{
+    return _execution;
+}
+
+//==============================================================================================
+//                                struct PipelineErrors
+//==============================================================================================
+inline
+void PipelineErrors::set(std::exception_ptr exception)
+{
+    if (!_hasException.exchange(true))
+    {
+        _exception = std::move(exception); //keep the first one
+    }
+}
+
+//==============================================================================================
+//                                class Pipeline
+//==============================================================================================
+template <class IN, class OUT>
+Pipeline<IN, OUT>::Pipeline(Dispatcher& dispatcher) :
+    _dispatcher(&dispatcher),
+    _errors(std::make_shared<PipelineErrors>())
+{
+    static_assert(std::is_same<IN, OUT>::value, "A pipeline without stages must have the same input and output types");
+}
+
+template <class IN, class OUT>
+Pipeline<IN, OUT>::Pipeline(Dispatcher& dispatcher,
+                            std::shared_ptr<Channel<IN>> input,
+                            Connector connect,
+                            std::shared_ptr<PipelineErrors> errors) :
+    _dispatcher(&dispatcher),
+    _input(std::move(input)),
+    _connect(std::move(connect)),
+    _errors(std::move(errors))
+{}
+
+template <class IN, class OUT>
+template <class RET>
+Pipeline<IN, RET> Pipeline<IN, OUT>::stage(Functions::StageFunc<RET, OUT> func, const PipelineStage& config)
+{
+    auto stage = std::make_shared<Stage<OUT, RET>>(connect(config.getCapacity()), std::move(func), config, _errors);
+    Dispatcher* dispatcher = _dispatcher;
+    return Pipeline<IN, RET>(*_dispatcher, _input, [dispatcher, stage](std::shared_ptr<Channel<RET>> output)
+    {
+        start(*dispatcher, stage, std::move(output));
+    }, _errors);
+}
+
+template <class IN, class OUT>
+ThreadFuturePtr<int> Pipeline<IN, OUT>::sink(Functions::SinkFunc<OUT> func, const PipelineStage& config)
+{
+    auto stage = std::make_shared<Stage<OUT, int>>(connect(config.getCapacity()), [func](OUT&& value)->int
+    {
+        func(std::move(value));
+        return 0;
+    }, config, _errors);
+    stage->_done = Promise<int>::create();
+    ThreadFuturePtr<int> future = stage->_done->getIThreadFuture();
+    start(*_dispatcher, std::move(stage), std::shared_ptr<Channel<int>>());
+    return future;
+}
+
+template <class IN, class OUT>
+template <class V>
+void Pipeline<IN, OUT>::push(V&& value)
+{
+    if (!_input) throw std::runtime_error("Pipeline has no stage");
+    _input->push(std::forward<V>(value));
+}
+
+template <class IN, class OUT>
+template <class V>
+void Pipeline<IN, OUT>::push(ICoroSync::Ptr sync, V&& value)
+{
+    if (!_input) throw std::runtime_error("Pipeline has no stage");
+    _input->push(std::move(sync), std::forward<V>(value));
+}
+
+template <class IN, class OUT>
+void Pipeline<IN, OUT>::close()
+{
+    if (!_input) throw std::runtime_error("Pipeline has no stage");
+    _input->close();
+}
+
+template <class IN, class OUT>
+std::shared_ptr<Channel<OUT>> Pipeline<IN, OUT>::connect(size_t capacity)
+{
+    auto channel = std::make_shared<Channel<OUT>>(capacity);
+    if (_connect)
+    {
+        Connector connect = std::move(_connect);
+        _connect = [](std::shared_ptr<Channel<OUT>>)
+        {
+            throw std::runtime_error("Pipeline stage is already connected");
+        };
+        connect(channel);
+    }
+    else
+    {
+        if (_input) throw std::runtime_error("Pipeline stage is already connected");
+        setInput(_input, channel);
+    }
+    return channel;
+}
+
+template <class IN, class OUT>
+void Pipeline<IN, OUT>::setInput(std::shared_ptr<Channel<IN>>& input, std::shared_ptr<Channel<IN>> channel)
+{
+    input = std::move(channel);
+}
+
+template <class IN, class OUT>
+template <class T>
+void Pipeline<IN, OUT>::setInput(std::shared_ptr<Channel<IN>>&, std::shared_ptr<Channel<T>>)
+{
+    throw std::runtime_error("Pipeline stage is already connected");
+}
+
+template <class IN, class OUT>
+template <class T, class RET>
+Pipeline<IN, OUT>::Stage<T, RET>::Stage(std::shared_ptr<Channel<T>> input,
+                                        Functions::StageFunc<RET, T> func,
+                                        const PipelineStage& config,
+                                        std::shared_ptr<PipelineErrors> errors) :
+    _input(std::move(input)),
+    _func(std::move(func)),
+    _config(config),
+    _isOrdered(false),
+    _errors(std::move(errors)),
+    _numRunning(config.getParallelism()),
+    _inputMutex(Mutex::Mode::Fifo),
+    _outputMutex(Mutex::Mode::Fifo)
+{}
+
+template <class IN, class OUT>
+template <class T, class RET>
+void Pipeline<IN, OUT>::start(Dispatcher& dispatcher, std::shared_ptr<Stage<T, RET>> stage, std::shared_ptr<Channel<RET>> output)
+{
+    const PipelineStage& config = stage->_config;
+    stage->_output = std::move(output);
+    stage->_isOrdered = stage->_output &&
+                        (config.getOrder() == PipelineStage::Order::InOrder) &&
+                        (config.getParallelism() > 1);
+    for (size_t i = 0; i < config.getParallelism(); ++i)
+    {
+        if (config.getExecution() == PipelineStage::Execution::Io)
+        {
+            dispatcher.postAsyncIo([stage](ThreadPromisePtr<int> promise)->int
+            {
+                run(*stage, nullptr);
+                return promise->set(0);
+            });
+        }
+        else
+        {
+            dispatcher.post([stage](CoroContextPtr<int> ctx)->int
+            {
+                run(*stage, ctx);
+                return ctx->set(0);
+            });
+        }
+    }
+}
+
+template <class IN, class OUT>
+template <class T, class RET>
+void Pipeline<IN, OUT>::run(Stage<T, RET>& stage, const ICoroSync::Ptr& sync)
+{
+    while (true)
+    {
+        bool isClosed = false;
+        size_t sequence = 0;
+        T value;
+        if (stage._isOrdered)
+        {
+            //Number the elements in the order they leave the input ring
+            lockImpl(stage._inputMutex, sync);
+            value = pullImpl(*stage._input, sync, isClosed);
+            sequence = stage._nextInput++;
+            stage._inputMutex.unlock();
+        }
+        else
+        {
+            value = pullImpl(*stage._input, sync, isClosed);
+        }
+        if (isClosed)
+        {
+            break;
+        }
+        bool isValid = true;
+        RET result{};
+        try
+        {
+            result = stage._func(std::move(value));
+        }
+        catch (...)
+        {
+            stage._errors->set(std::current_exception());
+            isValid = false; //drop the element
+        }
+        if (stage._isOrdered)
+        {
+            //Wait for the workers handling earlier elements. A dropped element still takes its turn.
+            lockImpl(stage._outputMutex, sync);
+            auto isTurn = [&stage, sequence]()->bool { return stage._nextOutput == sequence; };
+            if (sync)
+            {
+                stage._turn.wait(sync, stage._outputMutex, isTurn);
+            }
+            else
+            {
+                stage._turn.wait(stage._outputMutex, isTurn);
+            }
+            if (isValid)
+            {
+                pushImpl(*stage._output, sync, std::move(result));
+            }
+            ++stage._nextOutput;
+            stage._outputMutex.unlock();
+            stage._turn.notifyAll();
+        }
+        else if (isValid && stage._output)
+        {
+            pushImpl(*stage._output, sync, std::move(result));
+        }
+    }
+    if (--stage._numRunning == 0)
+    {
+        //Last worker of the stage
+        if (stage._output)
+        {
+            stage._output->close();
+        }
+        else if (stage._errors->_hasException)
+        {
+            stage._done->setException(stage._errors->_exception);
+        }
+        else
+        {
+            stage._done->set(0);
+        }
+    }
+}
+
+template <class IN, class OUT>
+template <class T>
+T Pipeline<IN, OUT>::pullImpl(Channel<T>& channel, const ICoroSync::Ptr& sync, bool& isClosed)
+{
+    return sync ? channel.pull(sync, isClosed) : channel.pull(isClosed);
+}
+
+template <class IN, class OUT>
+template <class T>
+void Pipeline<IN, OUT>::pushImpl(Channel<T>& channel, const ICoroSync::Ptr& sync, T&& value)
+{
+    if (sync)
+    {
+        channel.push(sync, std::move(value));
+    }
+    else
+    {
+        channel.push(std::move(value));
+    }
+}
+
+template <class IN, class OUT>
+void Pipeline<IN, OUT>::lockImpl(Mutex& mutex, const ICoroSync::Ptr& sync)
+{
+    if (sync)
+    {
+        mutex.lock(sync);
+    }
+    else
+    {
+        mutex.lock();
+    }
+}
+
+}}
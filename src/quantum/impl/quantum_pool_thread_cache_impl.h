@@ -0,0 +1,76 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+namespace Bloomberg {
+namespace quantum {
+
+template <typename POOL, typename BLOCK>
+constexpr size_t PoolThreadCache<POOL, BLOCK>::Capacity;
+
+template <typename POOL, typename BLOCK>
+constexpr size_t PoolThreadCache<POOL, BLOCK>::BatchSize;
+
+template <typename POOL, typename BLOCK>
+PoolThreadCache<POOL, BLOCK>::~PoolThreadCache()
+{
+    POOL* owner = _owner;
+    if (owner) {
+        owner->detachThreadCache(*this);
+    }
+}
+
+template <typename POOL, typename BLOCK>
+PoolThreadCache<POOL, BLOCK>* PoolThreadCache<POOL, BLOCK>::instance(POOL* pool)
+{
+    if (Capacity == 0) {
+        return nullptr;
+    }
+    thread_local PoolThreadCache cache;
+    POOL* owner = cache._owner;
+    if (owner == pool) {
+        return &cache;
+    }
+    if (owner) {
+        return nullptr; //serves another pool of the same type
+    }
+    pool->attachThreadCache(cache);
+    return &cache;
+}
+
+template <typename POOL, typename BLOCK>
+bool PoolThreadCache<POOL, BLOCK>::pop(BLOCK& block)
+{
+    if ((_count == 0) && (_owner.load()->refillThreadCache(*this) == 0)) {
+        return false;
+    }
+    block = _blocks[--_count];
+    return true;
+}
+
+template <typename POOL, typename BLOCK>
+void PoolThreadCache<POOL, BLOCK>::push(BLOCK block)
+{
+    if (_count == Capacity) {
+        _owner.load()->flushThreadCache(*this, BatchSize);
+    }
+    _blocks[_count++] = block;
+}
+
+}}
@@ -0,0 +1,243 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class Profile
+//==============================================================================================
+inline
+Profile::Profile() :
+    _interval(0),
+    _numSamples(0)
+{}
+
+inline
+std::chrono::microseconds Profile::interval() const
+{
+    return _interval;
+}
+
+inline
+size_t Profile::numSamples() const
+{
+    return _numSamples;
+}
+
+inline
+const std::vector<Profile::Entry>& Profile::entries() const
+{
+    return _entries;
+}
+
+inline
+void Profile::print(std::ostream& out) const
+{
+    out << "Samples per queue: " << _numSamples << " every " << _interval.count() << "us" << std::endl;
+    for (auto&& entry : _entries)
+    {
+        out << "Coroutine queue " << entry._queueId << ": "
+            << (_numSamples ? (100.0 * entry._numSamples / _numSamples) : 0) << "% "
+            << entry._numSamples << " samples " << entry._label << std::endl;
+    }
+}
+
+inline
+void Profile::writePprof(std::ostream& out) const
+{
+    //string indexes of the sample types. Function names follow.
+    enum : int64_t { Empty, Samples, Count, Cpu, Nanoseconds, NumFixedStrings };
+    std::vector<const std::string*> names;
+    std::map<std::string, uint64_t> ids; //function and location id of each name, starting at 1
+    auto getId = [&](const std::string& name) -> uint64_t
+    {
+        auto it = ids.emplace(name, names.size() + 1).first;
+        if (it->second > names.size())
+        {
+            names.push_back(&it->first);
+        }
+        return it->second;
+    };
+    int64_t periodNs = std::chrono::duration_cast<std::chrono::nanoseconds>(_interval).count();
+    std::string buf;
+    writeBytes(buf, 1, valueType(Samples, Count)); //sample_type
+    writeBytes(buf, 1, valueType(Cpu, Nanoseconds));
+    for (auto&& entry : _entries)
+    {
+        std::string locations;
+        writeVarint(locations, getId(entry._label)); //leaf first
+        writeVarint(locations, getId("coroutine queue " + std::to_string(entry._queueId)));
+        std::string values;
+        writeVarint(values, entry._numSamples);
+        writeVarint(values, entry._numSamples * periodNs);
+        std::string sample;
+        writeBytes(sample, 1, locations); //packed location_id
+        writeBytes(sample, 2, values); //packed value
+        writeBytes(buf, 2, sample);
+    }
+    for (uint64_t id = 1; id <= names.size(); ++id)
+    {
+        std::string line;
+        writeVarint(line, 1, id); //function_id
+        std::string location;
+        writeVarint(location, 1, id);
+        writeBytes(location, 4, line);
+        writeBytes(buf, 4, location);
+        std::string function;
+        writeVarint(function, 1, id);
+        writeVarint(function, 2, NumFixedStrings + id - 1); //name
+        writeVarint(function, 3, NumFixedStrings + id - 1); //system_name
+        writeBytes(buf, 5, function);
+    }
+    for (const char* str : {"", "samples", "count", "cpu", "nanoseconds"})
+    {
+        writeBytes(buf, 6, str); //string_table
+    }
+    for (auto&& name : names)
+    {
+        writeBytes(buf, 6, *name);
+    }
+    writeVarint(buf, 10, _numSamples * periodNs); //duration_nanos
+    writeBytes(buf, 11, valueType(Cpu, Nanoseconds)); //period_type
+    writeVarint(buf, 12, periodNs); //period
+    out.write(buf.data(), buf.size());
+}
+
+inline
+std::string Profile::demangle(const char* name)
+{
+#if defined(__GNUG__)
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (demangled)
+    {
+        std::string result(demangled);
+        std::free(demangled);
+        return result;
+    }
+#endif
+    return name;
+}
+
+inline
+const char* Profile::registerTypeName(const char* name)
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(typeNamesMutex());
+    typeNames().insert(name);
+    return name;
+}
+
+inline
+std::mutex& Profile::typeNamesMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+inline
+std::set<const char*>& Profile::typeNames()
+{
+    static std::set<const char*>* names = new std::set<const char*>(); //never destroyed since tasks may outlive it
+    return *names;
+}
+
+inline
+bool Profile::isTypeName(const char* label)
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(typeNamesMutex());
+    return typeNames().count(label) > 0;
+}
+
+inline
+void Profile::add(int queueId, const char* label, size_t numSamples)
+{
+    //user labels which look like mangled names are left as is
+    std::string name = isTypeName(label) ? demangle(label) : label;
+    for (auto&& entry : _entries)
+    {
+        if ((entry._queueId == queueId) && (entry._label == name))
+        {
+            entry._numSamples += numSamples;
+            return;
+        }
+    }
+    _entries.emplace_back(Entry{queueId, std::move(name), numSamples});
+}
+
+inline
+void Profile::sort()
+{
+    std::sort(_entries.begin(), _entries.end(), [](const Entry& lhs, const Entry& rhs)
+    {
+        if (lhs._numSamples != rhs._numSamples)
+        {
+            return lhs._numSamples > rhs._numSamples;
+        }
+        return (lhs._queueId != rhs._queueId) ? (lhs._queueId < rhs._queueId) : (lhs._label < rhs._label);
+    });
+}
+
+inline
+void Profile::writeVarint(std::string& buf, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        buf.push_back((char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    buf.push_back((char)value);
+}
+
+inline
+void Profile::writeVarint(std::string& buf, int field, uint64_t value)
+{
+    writeVarint(buf, ((uint64_t)field << 3) | 0); //wire type varint
+    writeVarint(buf, value);
+}
+
+inline
+void Profile::writeBytes(std::string& buf, int field, const std::string& bytes)
+{
+    writeVarint(buf, ((uint64_t)field << 3) | 2); //wire type length-delimited
+    writeVarint(buf, bytes.size());
+    buf.append(bytes);
+}
+
+inline
+std::string Profile::valueType(int64_t type, int64_t unit)
+{
+    std::string buf;
+    writeVarint(buf, 1, type);
+    writeVarint(buf, 2, unit);
+    return buf;
+}
+
+inline
+std::ostream& operator<<(std::ostream& out, const Profile& profile)
+{
+    profile.print(out);
+    return out;
+}
+
+}}
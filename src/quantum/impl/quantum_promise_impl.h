@@ -40,6 +40,13 @@ void IThreadPromise<PROMISE, T>::push(V &&value)
     static_cast<Impl*>(this)->template push<BUF>(std::forward<V>(value));
 }
 
+template <template<class> class PROMISE, class T>
+template <class BUF, class V>
+void IThreadPromise<PROMISE, T>::pushMany(std::vector<V> values)
+{
+    static_cast<Impl*>(this)->template pushMany<BUF>(std::move(values));
+}
+
 template <template<class> class PROMISE, class T>
 template <class BUF, class>
 int IThreadPromise<PROMISE, T>::closeBuffer()
@@ -64,6 +71,13 @@ void ICoroPromise<PROMISE, T>::push(ICoroSync::Ptr sync, V &&value)
     static_cast<Impl*>(this)->template push<BUF>(sync, std::forward<V>(value));
 }
 
+template <template<class> class PROMISE, class T>
+template <class BUF, class V>
+void ICoroPromise<PROMISE, T>::pushMany(ICoroSync::Ptr sync, std::vector<V> values)
+{
+    static_cast<Impl*>(this)->template pushMany<BUF>(sync, std::move(values));
+}
+
 template <template<class> class PROMISE, class T>
 template <class BUF, class>
 int ICoroPromise<PROMISE, T>::closeBuffer()
@@ -79,19 +93,19 @@ int ICoroPromise<PROMISE, T>::closeBuffer()
 #endif
 #ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
     #ifdef __QUANTUM_ALLOCATE_POOL_FROM_HEAP
-        using PromiseAllocator = HeapAllocator<Promise<int>>;
+        using PromiseAllocator = HeapAllocator<SharedBlock<Promise<int>>>;
     #else
-        using PromiseAllocator = StackAllocator<Promise<int>, __QUANTUM_PROMISE_ALLOC_SIZE>;
+        using PromiseAllocator = StackAllocator<SharedBlock<Promise<int>>, __QUANTUM_PROMISE_ALLOC_SIZE>;
     #endif
 #else
-    using PromiseAllocator = StlAllocator<Promise<int>>;
+    using PromiseAllocator = StlAllocator<SharedBlock<Promise<int>>>;
 #endif
 
 template <class T>
 Promise<T>::Promise() :
     IThreadPromise<Promise, T>(this),
     ICoroPromise<Promise, T>(this),
-    _sharedState(new SharedState<T>()),
+    _sharedState(std::allocate_shared<SharedState<T>>(SharedAllocator<SharedState<T>>())),
     _terminated(ATOMIC_FLAG_INIT)
 {}
 
@@ -127,14 +141,14 @@ template <class T>
 IThreadFutureBase::Ptr Promise<T>::getIThreadFutureBase() const
 {
     if (!_sharedState) ThrowFutureException(FutureState::NoState);
-    return FuturePtr<T>(new Future<T>(_sharedState), Future<T>::deleter);
+    return Future<T>::create(_sharedState);
 }
 
 template <class T>
 ICoroFutureBase::Ptr Promise<T>::getICoroFutureBase() const
 {
     if (!_sharedState) ThrowFutureException(FutureState::NoState);
-    return FuturePtr<T>(new Future<T>(_sharedState), Future<T>::deleter);
+    return Future<T>::create(_sharedState);
 }
 
 template <class T>
@@ -149,7 +163,7 @@ template <class T>
 ThreadFuturePtr<T> Promise<T>::getIThreadFuture() const
 {
     if (!_sharedState) ThrowFutureException(FutureState::NoState);
-    return FuturePtr<T>(new Future<T>(_sharedState), Future<T>::deleter);
+    return Future<T>::create(_sharedState);
 }
 
 template <class T>
@@ -164,7 +178,14 @@ template <class T>
 CoroFuturePtr<T> Promise<T>::getICoroFuture() const
 {
     if (!_sharedState) ThrowFutureException(FutureState::NoState);
-    return FuturePtr<T>(new Future<T>(_sharedState), Future<T>::deleter);
+    return Future<T>::create(_sharedState);
+}
+
+template <class T>
+SharedFuture<T> Promise<T>::getSharedFuture() const
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    return SharedFuture<T>(_sharedState);
 }
 
 template <class T>
@@ -183,6 +204,22 @@ void Promise<T>::push(ICoroSync::Ptr sync, V &&value)
     _sharedState->template push<BUF>(sync, std::forward<V>(value));
 }
 
+template <class T>
+template <class BUF, class V>
+void Promise<T>::pushMany(std::vector<V> values)
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    _sharedState->template pushMany<BUF>(std::move(values));
+}
+
+template <class T>
+template <class BUF, class V>
+void Promise<T>::pushMany(ICoroSync::Ptr sync, std::vector<V> values)
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    _sharedState->template pushMany<BUF>(sync, std::move(values));
+}
+
 template <class T>
 template <class BUF, class>
 int Promise<T>::closeBuffer()
@@ -200,17 +237,21 @@ void* Promise<T>::operator new(size_t)
 template <class T>
 void Promise<T>::operator delete(void* p)
 {
-    Allocator<PromiseAllocator>::instance(AllocatorTraits::promiseAllocSize()).deallocate(static_cast<Promise<int>*>(p));
+    Allocator<PromiseAllocator>::instance(AllocatorTraits::promiseAllocSize()).deallocate(static_cast<SharedBlock<Promise<int>>*>(p));
 }
 
 template <class T>
 void Promise<T>::deleter(Promise<T>* p)
 {
-#ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
-    Allocator<PromiseAllocator>::instance(AllocatorTraits::promiseAllocSize()).dispose(reinterpret_cast<Promise<int>*>(p));
-#else
-    delete p;
-#endif
+    delete p; //destroys and returns the block to the pool
+}
+
+template <class T>
+template <class ... ARGS>
+typename Promise<T>::Ptr Promise<T>::create(ARGS&&... args)
+{
+    return std::allocate_shared<Promise<T>>(SharedAllocator<Promise<T>, PromiseAllocator, &AllocatorTraits::promiseAllocSize>(),
+                                            std::forward<ARGS>(args)...);
 }
 
 }}
@@ -28,6 +28,30 @@ QueueStatistics::QueueStatistics()
     reset();
 }
 
+inline
+QueueStatistics::QueueStatistics(const QueueStatistics& other)
+{
+    reset();
+    *this += other;
+}
+
+inline
+QueueStatistics& QueueStatistics::operator=(const QueueStatistics& other)
+{
+    if (this != &other)
+    {
+        reset();
+        *this += other;
+    }
+    return *this;
+}
+
+inline
+void QueueStatistics::increment(Counter& counter)
+{
+    counter.fetch_add(1, std::memory_order_relaxed);
+}
+
 inline
 void QueueStatistics::reset()
 {
@@ -38,108 +62,344 @@ void QueueStatistics::reset()
     _sharedQueueCompletedCount = 0;
     _postedCount = 0;
     _highPriorityCount = 0;
+    _stolenCount = 0;
+    _migratedCount = 0;
+    _cancelledCount = 0;
+    _expiredCount = 0;
+    _highWatermarkCount = 0;
+    _rejectedCount = 0;
+    _sliceCount = 0;
+    _longSliceCount = 0;
+    _totalSliceTimeNs = 0;
+    _maxSliceTimeNs = 0;
+    for (auto&& bucket : _sliceHistogram)
+    {
+        bucket = 0;
+    }
+    _waitTimeHistogram.reset();
+    _runTimeHistogram.reset();
+    _endToEndTimeHistogram.reset();
+    for (auto&& count : _perfCounts)
+    {
+        count = 0;
+    }
 }
 
 inline
 size_t QueueStatistics::numElements() const
 {
-    return _numElements;
+    return _numElements.load(std::memory_order_relaxed);
 }
 
 inline
 void QueueStatistics::incNumElements()
 {
-    ++_numElements;
+    increment(_numElements);
 }
 
 inline
 void QueueStatistics::decNumElements()
 {
-    --_numElements;
+    _numElements.fetch_sub(1, std::memory_order_relaxed);
 }
 
 inline
 size_t QueueStatistics::errorCount() const
 {
-    return _errorCount;
+    return _errorCount.load(std::memory_order_relaxed);
 }
 
 inline
 void QueueStatistics::incErrorCount()
 {
-    ++_errorCount;
+    increment(_errorCount);
 }
 
 inline
 size_t QueueStatistics::sharedQueueErrorCount() const
 {
-    return _sharedQueueErrorCount;
+    return _sharedQueueErrorCount.load(std::memory_order_relaxed);
 }
 
 inline
 void QueueStatistics::incSharedQueueErrorCount()
 {
-    ++_sharedQueueErrorCount;
+    increment(_sharedQueueErrorCount);
 }
 
 inline
 size_t QueueStatistics::completedCount() const
 {
-    return _completedCount;
+    return _completedCount.load(std::memory_order_relaxed);
 }
 
 inline
 void QueueStatistics::incCompletedCount()
 {
-    ++_completedCount;
+    increment(_completedCount);
 }
 
 inline
 size_t QueueStatistics::sharedQueueCompletedCount() const
 {
-    return _sharedQueueCompletedCount;
+    return _sharedQueueCompletedCount.load(std::memory_order_relaxed);
 }
 
 inline
 void QueueStatistics::incSharedQueueCompletedCount()
 {
-    ++_sharedQueueCompletedCount;
+    increment(_sharedQueueCompletedCount);
 }
 
 inline
 size_t QueueStatistics::postedCount() const
 {
-    return _postedCount;
+    return _postedCount.load(std::memory_order_relaxed);
 }
 
 inline
 void QueueStatistics::incPostedCount()
 {
-    ++_postedCount;
+    increment(_postedCount);
 }
 
 inline
 size_t QueueStatistics::highPriorityCount() const
 {
-    return _highPriorityCount;
+    return _highPriorityCount.load(std::memory_order_relaxed);
 }
 
 inline
 void QueueStatistics::incHighPriorityCount()
 {
-    ++_highPriorityCount;
+    increment(_highPriorityCount);
+}
+
+inline
+size_t QueueStatistics::stolenCount() const
+{
+    return _stolenCount.load(std::memory_order_relaxed);
+}
+
+inline
+void QueueStatistics::incStolenCount()
+{
+    increment(_stolenCount);
+}
+
+inline
+size_t QueueStatistics::migratedCount() const
+{
+    return _migratedCount.load(std::memory_order_relaxed);
+}
+
+inline
+void QueueStatistics::incMigratedCount()
+{
+    increment(_migratedCount);
+}
+
+inline
+size_t QueueStatistics::cancelledCount() const
+{
+    return _cancelledCount.load(std::memory_order_relaxed);
+}
+
+inline
+void QueueStatistics::incCancelledCount()
+{
+    increment(_cancelledCount);
+}
+
+inline
+size_t QueueStatistics::expiredCount() const
+{
+    return _expiredCount.load(std::memory_order_relaxed);
+}
+
+inline
+void QueueStatistics::incExpiredCount()
+{
+    increment(_expiredCount);
+}
+
+inline
+size_t QueueStatistics::highWatermarkCount() const
+{
+    return _highWatermarkCount.load(std::memory_order_relaxed);
+}
+
+inline
+void QueueStatistics::incHighWatermarkCount()
+{
+    increment(_highWatermarkCount);
+}
+
+inline
+size_t QueueStatistics::rejectedCount() const
+{
+    return _rejectedCount.load(std::memory_order_relaxed);
+}
+
+inline
+void QueueStatistics::incRejectedCount()
+{
+    increment(_rejectedCount);
+}
+
+inline
+size_t QueueStatistics::sliceCount() const
+{
+    return _sliceCount.load(std::memory_order_relaxed);
+}
+
+inline
+std::chrono::nanoseconds QueueStatistics::totalSliceTime() const
+{
+    return std::chrono::nanoseconds(_totalSliceTimeNs.load(std::memory_order_relaxed));
+}
+
+inline
+std::chrono::nanoseconds QueueStatistics::maxSliceTime() const
+{
+    return std::chrono::nanoseconds(_maxSliceTimeNs.load(std::memory_order_relaxed));
+}
+
+inline
+size_t QueueStatistics::sliceHistogram(size_t bucket) const
+{
+    return (bucket < numSliceBuckets) ? _sliceHistogram[bucket].load(std::memory_order_relaxed) : 0;
+}
+
+inline
+void QueueStatistics::addSliceTime(std::chrono::nanoseconds sliceTime)
+{
+    increment(_sliceCount);
+    _totalSliceTimeNs.fetch_add(sliceTime.count(), std::memory_order_relaxed);
+    int64_t maxNs = _maxSliceTimeNs.load(std::memory_order_relaxed);
+    while ((sliceTime.count() > maxNs) &&
+           !_maxSliceTimeNs.compare_exchange_weak(maxNs, sliceTime.count(), std::memory_order_relaxed));
+    //bucket index is the bit width of the slice time in microseconds
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(sliceTime).count();
+    size_t bucket = 0;
+    while ((us > 0) && (bucket < numSliceBuckets-1))
+    {
+        us >>= 1;
+        ++bucket;
+    }
+    increment(_sliceHistogram[bucket]);
+}
+
+inline
+size_t QueueStatistics::longSliceCount() const
+{
+    return _longSliceCount.load(std::memory_order_relaxed);
+}
+
+inline
+void QueueStatistics::incLongSliceCount()
+{
+    increment(_longSliceCount);
+}
+
+inline
+const LatencyHistogram& QueueStatistics::waitTimeHistogram() const
+{
+    return _waitTimeHistogram;
+}
+
+inline
+void QueueStatistics::addWaitTime(std::chrono::nanoseconds waitTime)
+{
+    _waitTimeHistogram.add(waitTime);
+}
+
+inline
+const LatencyHistogram& QueueStatistics::runTimeHistogram() const
+{
+    return _runTimeHistogram;
+}
+
+inline
+void QueueStatistics::addRunTime(std::chrono::nanoseconds runTime)
+{
+    _runTimeHistogram.add(runTime);
+}
+
+inline
+const LatencyHistogram& QueueStatistics::endToEndTimeHistogram() const
+{
+    return _endToEndTimeHistogram;
+}
+
+inline
+void QueueStatistics::addEndToEndTime(std::chrono::nanoseconds endToEndTime)
+{
+    _endToEndTimeHistogram.add(endToEndTime);
+}
+
+inline
+uint64_t QueueStatistics::perfCount(PerfEvent event) const
+{
+    return _perfCounts[(int)event].load(std::memory_order_relaxed);
+}
+
+inline
+void QueueStatistics::setPerfCount(PerfEvent event, uint64_t count)
+{
+    _perfCounts[(int)event].store(count, std::memory_order_relaxed);
+}
+
+inline
+void QueueStatistics::updatePerfCounts(const PerfCounters& counters)
+{
+    for (int i = 0; i < PerfCounters::numEvents; ++i)
+    {
+        setPerfCount((PerfEvent)i, counters.read((PerfEvent)i));
+    }
 }
 
 inline
 void QueueStatistics::print(std::ostream& out) const
 {
-    out << "Num elemetns: " << _numElements << std::endl;
-    out << "Num queued: " << _errorCount << std::endl;
-    out << "Num completed: " << _completedCount << std::endl;
-    out << "Num shared completed: " << _sharedQueueCompletedCount << std::endl;
-    out << "Num errors: " << _errorCount << std::endl;
-    out << "Num shared errors: " << _sharedQueueErrorCount << std::endl;
-    out << "Num high priority count: " << _highPriorityCount << std::endl;
+    out << "Num elemetns: " << numElements() << std::endl;
+    out << "Num queued: " << errorCount() << std::endl;
+    out << "Num completed: " << completedCount() << std::endl;
+    out << "Num shared completed: " << sharedQueueCompletedCount() << std::endl;
+    out << "Num errors: " << errorCount() << std::endl;
+    out << "Num shared errors: " << sharedQueueErrorCount() << std::endl;
+    out << "Num high priority count: " << highPriorityCount() << std::endl;
+    out << "Num stolen: " << stolenCount() << std::endl;
+    out << "Num migrated: " << migratedCount() << std::endl;
+    out << "Num cancelled: " << cancelledCount() << std::endl;
+    out << "Num expired: " << expiredCount() << std::endl;
+    out << "Num high watermarks: " << highWatermarkCount() << std::endl;
+    out << "Num rejected: " << rejectedCount() << std::endl;
+    out << "Num slices: " << sliceCount() << std::endl;
+    out << "Num long slices: " << longSliceCount() << std::endl;
+    out << "Total slice time (us): " << std::chrono::duration_cast<std::chrono::microseconds>(totalSliceTime()).count() << std::endl;
+    out << "Max slice time (us): " << std::chrono::duration_cast<std::chrono::microseconds>(maxSliceTime()).count() << std::endl;
+    out << "Slice histogram (us):";
+    for (size_t i = 0; i < numSliceBuckets; ++i)
+    {
+        out << " " << ((i == 0) ? 0 : (1 << (i-1))) << ":" << sliceHistogram(i);
+    }
+    out << std::endl;
+    out << "Wait time: ";
+    _waitTimeHistogram.print(out);
+    out << std::endl;
+    out << "Run time: ";
+    _runTimeHistogram.print(out);
+    out << std::endl;
+    out << "End-to-end time: ";
+    _endToEndTimeHistogram.print(out);
+    out << std::endl;
+    out << "Perf counters:";
+    for (int i = 0; i < PerfCounters::numEvents; ++i)
+    {
+        out << " " << PerfCounters::name((PerfEvent)i) << ":" << perfCount((PerfEvent)i);
+    }
+    out << std::endl;
 }
 
 inline
@@ -152,6 +412,30 @@ QueueStatistics& QueueStatistics::operator+=(const IQueueStatistics& rhs)
     _sharedQueueCompletedCount += rhs.sharedQueueCompletedCount();
     _postedCount += rhs.postedCount();
     _highPriorityCount += rhs.highPriorityCount();
+    _stolenCount += rhs.stolenCount();
+    _migratedCount += rhs.migratedCount();
+    _cancelledCount += rhs.cancelledCount();
+    _expiredCount += rhs.expiredCount();
+    _highWatermarkCount += rhs.highWatermarkCount();
+    _rejectedCount += rhs.rejectedCount();
+    _sliceCount += rhs.sliceCount();
+    _longSliceCount += rhs.longSliceCount();
+    _totalSliceTimeNs += rhs.totalSliceTime().count();
+    if (rhs.maxSliceTime() > maxSliceTime())
+    {
+        _maxSliceTimeNs = rhs.maxSliceTime().count();
+    }
+    for (size_t i = 0; i < numSliceBuckets; ++i)
+    {
+        _sliceHistogram[i] += rhs.sliceHistogram(i);
+    }
+    _waitTimeHistogram += rhs.waitTimeHistogram();
+    _runTimeHistogram += rhs.runTimeHistogram();
+    _endToEndTimeHistogram += rhs.endToEndTimeHistogram();
+    for (int i = 0; i < PerfCounters::numEvents; ++i)
+    {
+        _perfCounts[i] += rhs.perfCount((PerfEvent)i);
+    }
     return *this;
 }
 
@@ -0,0 +1,252 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#ifndef _WIN32
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+Reactor::Reactor() :
+    _pollFd(-1),
+    _wakeFd(-1),
+    _isInterrupted(false),
+    _terminated(ATOMIC_FLAG_INIT)
+{
+}
+
+inline
+Reactor::~Reactor()
+{
+    terminate();
+}
+
+inline
+void Reactor::terminate()
+{
+    if (!_terminated.test_and_set())
+    {
+        {
+            //========================= LOCKED SCOPE =========================
+            std::lock_guard<std::mutex> lock(_mutex);
+            _isInterrupted = true;
+        }
+#ifndef _WIN32
+        if (_thread)
+        {
+            uint64_t value = 1;
+            ssize_t rc = ::write(_wakeFd, &value, sizeof(value));
+            UNUSED(rc);
+            _thread->join();
+        }
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_mutex);
+        //Release all waiters so that parked coroutines get a chance to exit
+        for (auto&& registration : _registrations)
+        {
+            notify(registration.second._read);
+            notify(registration.second._write);
+        }
+        _registrations.clear();
+        if (_pollFd != -1)
+        {
+            ::close(_pollFd);
+            ::close(_wakeFd);
+        }
+#endif
+    }
+}
+
+inline
+void Reactor::start()
+{
+#ifdef _WIN32
+    throw std::runtime_error("Reactor not supported on this platform");
+#else
+    //called with the mutex held
+    _pollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (_pollFd == -1)
+    {
+        throw std::runtime_error("Cannot create reactor poller");
+    }
+    _wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_wakeFd == -1)
+    {
+        ::close(_pollFd);
+        _pollFd = -1;
+        throw std::runtime_error("Cannot create reactor wake-up descriptor");
+    }
+    struct epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = _wakeFd;
+    ::epoll_ctl(_pollFd, EPOLL_CTL_ADD, _wakeFd, &event);
+    _thread = std::make_shared<std::thread>(std::bind(&Reactor::run, this));
+#endif
+}
+
+inline
+void Reactor::add(int fd, Event event, std::atomic_int& signal, ICoroSync::Ptr sync)
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_isInterrupted)
+    {
+        throw std::runtime_error("Reactor is terminated");
+    }
+    if (!_thread)
+    {
+        start();
+    }
+    auto it = _registrations.emplace(fd, Registration{}).first;
+    Waiter& waiter = (event == Event::Read) ? it->second._read : it->second._write;
+    if (waiter.isSet())
+    {
+        throw std::runtime_error("File descriptor is already awaited");
+    }
+    waiter._signal = &signal;
+    waiter._sync = std::move(sync);
+    try
+    {
+        update(it);
+    }
+    catch (...)
+    {
+        waiter = Waiter{};
+        if (!it->second._read.isSet() && !it->second._write.isSet())
+        {
+            _registrations.erase(it);
+        }
+        throw;
+    }
+}
+
+inline
+bool Reactor::remove(int fd, Event event, std::atomic_int& signal)
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _registrations.find(fd);
+    if (it == _registrations.end())
+    {
+        return false;
+    }
+    Waiter& waiter = (event == Event::Read) ? it->second._read : it->second._write;
+    if (waiter._signal != &signal)
+    {
+        return false;
+    }
+    waiter = Waiter{};
+    update(it);
+    return true;
+}
+
+inline
+void Reactor::update(RegistrationMap::iterator it)
+{
+#ifndef _WIN32
+    //called with the mutex held
+    Registration& registration = it->second;
+    int events = (registration._read.isSet() ? (int)EPOLLIN : 0) | (registration._write.isSet() ? (int)EPOLLOUT : 0);
+    if (events == registration._events)
+    {
+        return;
+    }
+    struct epoll_event event{};
+    event.events = events;
+    event.data.fd = it->first;
+    if (events == 0)
+    {
+        ::epoll_ctl(_pollFd, EPOLL_CTL_DEL, it->first, &event);
+        _registrations.erase(it);
+        return;
+    }
+    if (::epoll_ctl(_pollFd, (registration._events == 0) ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, it->first, &event) == -1)
+    {
+        throw std::runtime_error("Cannot poll file descriptor");
+    }
+    registration._events = events;
+#else
+    UNUSED(it);
+#endif
+}
+
+inline
+void Reactor::notify(Waiter& waiter)
+{
+    if (waiter.isSet())
+    {
+        *waiter._signal = 1;
+        waiter._sync->wakeUp();
+        waiter = Waiter{};
+    }
+}
+
+inline
+void Reactor::run()
+{
+#ifndef _WIN32
+    const int maxEvents = 64;
+    struct epoll_event events[maxEvents];
+    while (true)
+    {
+        int num = ::epoll_wait(_pollFd, events, maxEvents, -1);
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_isInterrupted)
+        {
+            break;
+        }
+        for (int i = 0; i < num; ++i)
+        {
+            auto it = _registrations.find(events[i].data.fd);
+            if (it == _registrations.end())
+            {
+                continue; //wake-up descriptor or a cancelled registration
+            }
+            //Errors and hang-ups are reported to both waiters which will see them on their next read or write
+            if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+            {
+                notify(it->second._read);
+            }
+            if (events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP))
+            {
+                notify(it->second._write);
+            }
+            try
+            {
+                update(it);
+            }
+            catch (...)
+            {
+                //cannot poll the remaining event anymore so let its waiter find out
+                notify(it->second._read);
+                notify(it->second._write);
+                update(it);
+            }
+        }
+    }
+#endif
+}
+
+}}
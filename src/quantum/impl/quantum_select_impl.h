@@ -0,0 +1,232 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+thread_local static std::atomic_int s_selectThreadSignal{-1}; //thread specific (non-coroutine)
+thread_local static size_t s_selectOffset{0}; //rotates the first source looked at
+
+//==============================================================================================
+//                                      class Selectable
+//==============================================================================================
+template <class T>
+Selectable::Selectable(const std::shared_ptr<Future<Buffer<T>>>& future) :
+    _source(future),
+    _addCallback(&addCallbackImpl<Future<Buffer<T>>>),
+    _removeCallback(&removeCallbackImpl<Future<Buffer<T>>>)
+{}
+
+template <class T>
+Selectable::Selectable(const std::shared_ptr<ICoroFuture<Buffer<T>>>& future) :
+    _source(future),
+    _addCallback(&addCallbackImpl<ICoroFuture<Buffer<T>>>),
+    _removeCallback(&removeCallbackImpl<ICoroFuture<Buffer<T>>>)
+{}
+
+template <class T>
+Selectable::Selectable(const std::shared_ptr<IThreadFuture<Buffer<T>>>& future) :
+    _source(future),
+    _addCallback(&addCallbackImpl<IThreadFuture<Buffer<T>>>),
+    _removeCallback(&removeCallbackImpl<IThreadFuture<Buffer<T>>>)
+{}
+
+template <class T>
+Selectable::Selectable(const std::shared_ptr<Channel<T>>& channel) :
+    _source(channel),
+    _addCallback(&addCallbackImpl<Channel<T>>),
+    _removeCallback(&removeCallbackImpl<Channel<T>>)
+{}
+
+template <class T>
+Selectable::Selectable(Channel<T>& channel) :
+    _source(std::shared_ptr<void>(), &channel), //not owned
+    _addCallback(&addCallbackImpl<Channel<T>>),
+    _removeCallback(&removeCallbackImpl<Channel<T>>)
+{}
+
+inline
+void Selectable::addCallback(IFutureCallback::Ptr callback, size_t index) const
+{
+    _addCallback(_source.get(), std::move(callback), index);
+}
+
+inline
+void Selectable::removeCallback(const IFutureCallback::Ptr& callback) const
+{
+    _removeCallback(_source.get(), callback);
+}
+
+template <class SOURCE>
+void Selectable::addCallbackImpl(void* source, IFutureCallback::Ptr callback, size_t index)
+{
+    static_cast<SOURCE*>(source)->addCallback(std::move(callback), index);
+}
+
+template <class SOURCE>
+void Selectable::removeCallbackImpl(void* source, const IFutureCallback::Ptr& callback)
+{
+    static_cast<SOURCE*>(source)->removeCallback(callback);
+}
+
+//==============================================================================================
+//                                    class SelectCallback
+//==============================================================================================
+inline
+SelectCallback::SelectCallback(std::atomic_int& signal, ICoroSync::Ptr sync, size_t numSources) :
+    _isArmed(true),
+    _index(numSources),
+    _signal(&signal),
+    _sync(std::move(sync))
+{}
+
+inline
+void SelectCallback::onReady(size_t index)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    if (!_isArmed)
+    {
+        return; //another source was first or the caller stopped waiting
+    }
+    _isArmed = false;
+    _index = index;
+    (*_signal) = 1;
+    if (_sync)
+    {
+        _sync->wakeUp();
+    }
+    else
+    {
+        Futex::wakeOne(*_signal);
+    }
+}
+
+inline
+size_t SelectCallback::disarm()
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    _isArmed = false;
+    return _index;
+}
+
+//==============================================================================================
+//                                      select
+//==============================================================================================
+inline
+size_t selectImpl(std::atomic_int& signal,
+                  ICoroSync::Ptr sync,
+                  const std::vector<Selectable>& sources,
+                  const std::chrono::nanoseconds* time)
+{
+    if (sources.empty())
+    {
+        throw std::runtime_error("No sources to select from");
+    }
+    signal = 0; //clear signal flag
+    auto callback = std::make_shared<SelectCallback>(signal, sync, sources.size());
+    size_t first = (s_selectOffset++) % sources.size();
+    size_t numRegistered = 0;
+    while ((numRegistered < sources.size()) && (signal == 0))
+    {
+        size_t index = (first + numRegistered++) % sources.size();
+        sources[index].addCallback(callback, index); //stop as soon as a source is ready
+    }
+    if (time)
+    {
+        auto deadline = Clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(*time);
+        if (sync)
+        {
+            //park the coroutine until signalled or until the time expires
+            sync->setWakeUpTime(deadline);
+        }
+        while (signal == 0)
+        {
+            auto now = Clock::now();
+            if (now >= deadline)
+            {
+                break;
+            }
+            if (sync)
+            {
+                sync->getYieldHandle()();
+            }
+            else
+            {
+                Futex::waitFor(signal, 0, deadline - now);
+            }
+        }
+        if (sync)
+        {
+            sync->clearWakeUpTime();
+        }
+    }
+    else
+    {
+        while (signal == 0)
+        {
+            if (sync)
+            {
+                sync->getYieldHandle()(); //parked by the queue until signalled
+            }
+            else
+            {
+                Futex::wait(signal, 0);
+            }
+        }
+    }
+    size_t index = callback->disarm();
+    for (size_t i = 0; i < numRegistered; ++i)
+    {
+        sources[(first + i) % sources.size()].removeCallback(callback);
+    }
+    signal = -1; //reset signal flag
+    return index;
+}
+
+inline
+size_t select(const std::vector<Selectable>& sources)
+{
+    return selectImpl(s_selectThreadSignal, nullptr, sources, nullptr);
+}
+
+template <class REP, class PERIOD>
+size_t select(const std::vector<Selectable>& sources, const std::chrono::duration<REP, PERIOD>& time)
+{
+    std::chrono::nanoseconds timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(time);
+    return selectImpl(s_selectThreadSignal, nullptr, sources, &timeout);
+}
+
+inline
+size_t select(ICoroSync::Ptr sync, const std::vector<Selectable>& sources)
+{
+    return selectImpl(sync->signal(), sync, sources, nullptr);
+}
+
+template <class REP, class PERIOD>
+size_t select(ICoroSync::Ptr sync, const std::vector<Selectable>& sources, const std::chrono::duration<REP, PERIOD>& time)
+{
+    std::chrono::nanoseconds timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(time);
+    return selectImpl(sync->signal(), sync, sources, &timeout);
+}
+
+}}
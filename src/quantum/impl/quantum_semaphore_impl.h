@@ -0,0 +1,242 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+thread_local static std::atomic_int s_semaphoreThreadSignal{-1}; //thread specific (non-coroutine)
+
+//==============================================================================================
+//                                class Semaphore
+//==============================================================================================
+inline
+Semaphore::Semaphore(size_t count) :
+    _count(count)
+{}
+
+inline
+void Semaphore::acquire(size_t num)
+{
+    acquireImpl(s_semaphoreThreadSignal, nullptr, num);
+}
+
+inline
+void Semaphore::acquire(ICoroSync::Ptr sync, size_t num)
+{
+    acquireImpl(sync->signal(), sync, num);
+}
+
+inline
+bool Semaphore::tryAcquire(size_t num)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    if (!_waiters.empty() || (_count < num))
+    {
+        return false;
+    }
+    _count -= num;
+    return true;
+}
+
+template <class REP, class PERIOD>
+bool Semaphore::tryAcquireFor(const std::chrono::duration<REP, PERIOD>& time, size_t num)
+{
+    return acquireForImpl(s_semaphoreThreadSignal, nullptr, std::chrono::duration_cast<std::chrono::nanoseconds>(time), num);
+}
+
+template <class REP, class PERIOD>
+bool Semaphore::tryAcquireFor(ICoroSync::Ptr sync, const std::chrono::duration<REP, PERIOD>& time, size_t num)
+{
+    return acquireForImpl(sync->signal(), sync, std::chrono::duration_cast<std::chrono::nanoseconds>(time), num);
+}
+
+inline
+void Semaphore::release(size_t num)
+{
+    std::list<Waiter> granted;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        _count += num;
+        grant(granted);
+    }
+    for (auto&& waiter : granted)
+    {
+        notify(waiter);
+    }
+}
+
+inline
+size_t Semaphore::count() const
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    return _count;
+}
+
+inline
+bool Semaphore::acquireOrWait(std::atomic_int& signal, ICoroSync::Ptr sync, size_t num)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    if (_waiters.empty() && (_count >= num))
+    {
+        _count -= num;
+        return true;
+    }
+    signal = 0; //clear signal flag
+    _waiters.emplace_back(Waiter{&signal, std::move(sync), num});
+    return false;
+}
+
+inline
+void Semaphore::acquireImpl(std::atomic_int& signal, ICoroSync::Ptr sync, size_t num)
+{
+    if (acquireOrWait(signal, sync, num))
+    {
+        return;
+    }
+    while (signal == 0)
+    {
+        if (sync)
+        {
+            sync->getYieldHandle()(); //parked by the queue until signalled
+        }
+        else
+        {
+            Futex::wait(signal, 0);
+        }
+    }
+    signal = -1; //reset. The permits have been handed over.
+}
+
+inline
+bool Semaphore::acquireForImpl(std::atomic_int& signal, ICoroSync::Ptr sync, std::chrono::nanoseconds time, size_t num)
+{
+    if (acquireOrWait(signal, sync, num))
+    {
+        return true;
+    }
+    auto deadline = Clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(time);
+    if (sync)
+    {
+        //park the coroutine until signalled or until the time expires
+        sync->setWakeUpTime(deadline);
+    }
+    while (signal == 0)
+    {
+        auto now = Clock::now();
+        if (now >= deadline)
+        {
+            break;
+        }
+        if (sync)
+        {
+            sync->getYieldHandle()();
+        }
+        else
+        {
+            Futex::waitFor(signal, 0, deadline - now);
+        }
+    }
+    if (sync)
+    {
+        sync->clearWakeUpTime();
+    }
+    bool isAcquired = true;
+    if (signal == 0)
+    {
+        std::list<Waiter> granted;
+        {
+            //========================= LOCKED SCOPE =========================
+            SpinLock::Guard lock(_spinlock);
+            for (auto it = _waiters.begin(); it != _waiters.end(); ++it)
+            {
+                if (it->_signal == &signal)
+                {
+                    //timed out. The waiters behind may be satisfied now.
+                    _waiters.erase(it);
+                    isAcquired = false;
+                    grant(granted);
+                    break;
+                }
+            }
+        }
+        for (auto&& waiter : granted)
+        {
+            notify(waiter);
+        }
+    }
+    signal = -1; //reset signal flag
+    return isAcquired;
+}
+
+inline
+void Semaphore::grant(std::list<Waiter>& granted)
+{
+    while (!_waiters.empty() && (_count >= _waiters.front()._num))
+    {
+        _count -= _waiters.front()._num;
+        granted.splice(granted.end(), _waiters, _waiters.begin());
+    }
+}
+
+inline
+void Semaphore::notify(Waiter& waiter)
+{
+    (*waiter._signal) = 1;
+    if (waiter._sync)
+    {
+        waiter._sync->wakeUp();
+    }
+    else
+    {
+        Futex::wakeOne(*waiter._signal);
+    }
+}
+
+//==============================================================================================
+//                                class Semaphore::Guard
+//==============================================================================================
+inline
+Semaphore::Guard::Guard(Semaphore& semaphore, size_t num) :
+    _semaphore(semaphore),
+    _num(num)
+{
+    _semaphore.acquire(_num);
+}
+
+inline
+Semaphore::Guard::Guard(ICoroSync::Ptr sync, Semaphore& semaphore, size_t num) :
+    _semaphore(semaphore),
+    _num(num)
+{
+    _semaphore.acquire(sync, _num);
+}
+
+inline
+Semaphore::Guard::~Guard()
+{
+    _semaphore.release(_num);
+}
+
+}}
@@ -0,0 +1,120 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+template <class KEY, class HASH, class KEY_EQUAL>
+Sequencer<KEY, HASH, KEY_EQUAL>::Sequencer(Dispatcher& dispatcher) :
+    _dispatcher(dispatcher)
+{
+}
+
+template <class KEY, class HASH, class KEY_EQUAL>
+template <class RET, class FUNC, class ... ARGS>
+ThreadContextPtr<RET>
+Sequencer<KEY, HASH, KEY_EQUAL>::enqueue(const KEY& key, FUNC&& func, ARGS&&... args)
+{
+    //Create the coroutine without posting it. All arguments are passed as temporaries so that they are
+    //captured by value.
+    ThreadContextPtr<RET> ctx = _dispatcher.postFirst<RET>((int)IQueue::QueueId::Any, false,
+        &Sequencer::run<RET, typename std::decay<FUNC>::type, typename std::decay<ARGS>::type...>,
+        this,
+        KEY(key),
+        typename std::decay<FUNC>::type(std::forward<FUNC>(func)),
+        typename std::decay<ARGS>::type(std::forward<ARGS>(args))...);
+    bool isIdle = false;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        auto it = _keys.find(key);
+        if (it == _keys.end())
+        {
+            isIdle = true;
+            _keys.emplace(key, PendingQueue{});
+        }
+        else
+        {
+            it->second.emplace_back([ctx]() { ctx->end(); });
+        }
+    }
+    if (isIdle)
+    {
+        ctx->end(); //post on the least busy queue
+    }
+    return ctx;
+}
+
+template <class KEY, class HASH, class KEY_EQUAL>
+size_t Sequencer<KEY, HASH, KEY_EQUAL>::size() const
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    return _keys.size();
+}
+
+template <class KEY, class HASH, class KEY_EQUAL>
+size_t Sequencer<KEY, HASH, KEY_EQUAL>::size(const KEY& key) const
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    auto it = _keys.find(key);
+    return (it == _keys.end()) ? 0 : it->second.size();
+}
+
+template <class KEY, class HASH, class KEY_EQUAL>
+template <class RET, class FUNC, class ... ARGS>
+int Sequencer<KEY, HASH, KEY_EQUAL>::run(CoroContextPtr<RET> ctx, Sequencer* sequencer, KEY key, FUNC func, ARGS... args)
+{
+    int rc;
+    try
+    {
+        rc = func(ctx, std::move(args)...);
+    }
+    catch (...)
+    {
+        sequencer->next(key);
+        throw;
+    }
+    sequencer->next(key);
+    return rc;
+}
+
+template <class KEY, class HASH, class KEY_EQUAL>
+void Sequencer<KEY, HASH, KEY_EQUAL>::next(const KEY& key)
+{
+    std::function<void()> post;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        auto it = _keys.find(key);
+        if (it->second.empty())
+        {
+            _keys.erase(it); //key becomes idle and its next coroutine may run on any queue
+            return;
+        }
+        post = std::move(it->second.front());
+        it->second.pop_front();
+    }
+    post();
+}
+
+}}
@@ -0,0 +1,89 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                class SharedFuture
+//==============================================================================================
+template <class T>
+SharedFuture<T>::SharedFuture(std::shared_ptr<SharedState<T>> sharedState) :
+    _sharedState(std::move(sharedState))
+{}
+
+template <class T>
+bool SharedFuture<T>::valid() const
+{
+    return _sharedState != nullptr;
+}
+
+template <class T>
+void SharedFuture<T>::wait() const
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    _sharedState->wait();
+}
+
+template <class T>
+std::future_status SharedFuture<T>::waitFor(std::chrono::milliseconds timeMs) const
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    return _sharedState->waitFor(timeMs);
+}
+
+template <class T>
+const T& SharedFuture<T>::get() const
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    return _sharedState->getRef();
+}
+
+template <class T>
+void SharedFuture<T>::wait(ICoroSync::Ptr sync) const
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    _sharedState->wait(sync);
+}
+
+template <class T>
+std::future_status SharedFuture<T>::waitFor(ICoroSync::Ptr sync, std::chrono::milliseconds timeMs) const
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    return _sharedState->waitFor(sync, timeMs);
+}
+
+template <class T>
+const T& SharedFuture<T>::get(ICoroSync::Ptr sync) const
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    return _sharedState->getRef(sync);
+}
+
+template <class T>
+template <class FUNC>
+void SharedFuture<T>::onReady(FUNC&& func) const
+{
+    if (!_sharedState) ThrowFutureException(FutureState::NoState);
+    _sharedState->addCallback(std::make_shared<FutureCallback<std::decay_t<FUNC>>>(std::forward<FUNC>(func)), 0);
+}
+
+}}
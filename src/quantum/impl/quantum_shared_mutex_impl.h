@@ -0,0 +1,310 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+thread_local static std::atomic_int s_sharedMutexThreadSignal{-1}; //thread specific (non-coroutine)
+
+//==============================================================================================
+//                                class SharedMutex
+//==============================================================================================
+inline
+SharedMutex::SharedMutex() :
+    _numReaders(0),
+    _isWriting(false)
+{}
+
+inline
+void SharedMutex::lock()
+{
+    lockImpl(s_sharedMutexThreadSignal, nullptr);
+}
+
+inline
+void SharedMutex::lock(ICoroSync::Ptr sync)
+{
+    lockImpl(sync->signal(), sync);
+}
+
+inline
+bool SharedMutex::tryLock()
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    return tryLockImpl();
+}
+
+inline
+void SharedMutex::unlock()
+{
+    std::list<Waiter> waiters;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        if (!_writers.empty())
+        {
+            //hand over to the next writer. The mutex stays locked.
+            waiters.splice(waiters.end(), _writers, _writers.begin());
+        }
+        else
+        {
+            //release all the waiting readers at once
+            _isWriting = false;
+            _numReaders = (int)_readers.size();
+            waiters.swap(_readers);
+        }
+    }
+    for (auto&& waiter : waiters)
+    {
+        notify(waiter);
+    }
+}
+
+inline
+void SharedMutex::lockShared()
+{
+    lockSharedImpl(s_sharedMutexThreadSignal, nullptr);
+}
+
+inline
+void SharedMutex::lockShared(ICoroSync::Ptr sync)
+{
+    lockSharedImpl(sync->signal(), sync);
+}
+
+inline
+bool SharedMutex::tryLockShared()
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    return tryLockSharedImpl();
+}
+
+inline
+void SharedMutex::unlockShared()
+{
+    Waiter waiter;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        if ((--_numReaders > 0) || _writers.empty())
+        {
+            return;
+        }
+        //last reader hands over to the next writer
+        _isWriting = true;
+        waiter = std::move(_writers.front());
+        _writers.pop_front();
+    }
+    notify(waiter);
+}
+
+inline
+bool SharedMutex::tryLockImpl()
+{
+    //called with the spinlock held
+    if (_isWriting || (_numReaders > 0))
+    {
+        return false;
+    }
+    _isWriting = true;
+    return true;
+}
+
+inline
+bool SharedMutex::tryLockSharedImpl()
+{
+    //called with the spinlock held. Readers queue behind waiting writers.
+    if (_isWriting || !_writers.empty())
+    {
+        return false;
+    }
+    ++_numReaders;
+    return true;
+}
+
+inline
+void SharedMutex::lockImpl(std::atomic_int& signal, ICoroSync::Ptr sync)
+{
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        if (tryLockImpl())
+        {
+            return;
+        }
+        signal = 0; //clear signal flag
+        _writers.emplace_back(&signal, sync);
+    }
+    wait(signal, sync);
+}
+
+inline
+void SharedMutex::lockSharedImpl(std::atomic_int& signal, ICoroSync::Ptr sync)
+{
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        if (tryLockSharedImpl())
+        {
+            return;
+        }
+        signal = 0; //clear signal flag
+        _readers.emplace_back(&signal, sync);
+    }
+    wait(signal, sync);
+}
+
+inline
+void SharedMutex::wait(std::atomic_int& signal, const ICoroSync::Ptr& sync)
+{
+    while (signal == 0)
+    {
+        if (sync)
+        {
+            sync->getYieldHandle()(); //parked by the queue until signalled
+        }
+        else
+        {
+            Futex::wait(signal, 0);
+        }
+    }
+    signal = -1; //reset. Ownership has been handed over.
+}
+
+inline
+void SharedMutex::notify(Waiter& waiter)
+{
+    (*waiter.first) = 1;
+    if (waiter.second)
+    {
+        waiter.second->wakeUp();
+    }
+    else
+    {
+        Futex::wakeOne(*waiter.first);
+    }
+}
+
+//==============================================================================================
+//                                class SharedMutex::Guard
+//==============================================================================================
+inline
+SharedMutex::Guard::Guard(SharedMutex& mutex,
+                          bool tryLock) :
+    _mutex(mutex)
+{
+    if (tryLock)
+    {
+        _ownsLock = _mutex.tryLock();
+    }
+    else
+    {
+        _mutex.lock();
+        _ownsLock = true;
+    }
+}
+
+inline
+SharedMutex::Guard::Guard(ICoroSync::Ptr sync,
+                          SharedMutex& mutex,
+                          bool tryLock) :
+    _mutex(mutex)
+{
+    if (tryLock)
+    {
+        _ownsLock = _mutex.tryLock();
+    }
+    else
+    {
+        _mutex.lock(sync);
+        _ownsLock = true;
+    }
+}
+
+inline
+bool SharedMutex::Guard::ownsLock() const
+{
+    return _ownsLock;
+}
+
+inline
+SharedMutex::Guard::~Guard()
+{
+    if (_ownsLock)
+    {
+        _mutex.unlock();
+    }
+}
+
+//==============================================================================================
+//                                class SharedMutex::SharedGuard
+//==============================================================================================
+inline
+SharedMutex::SharedGuard::SharedGuard(SharedMutex& mutex,
+                                      bool tryLock) :
+    _mutex(mutex)
+{
+    if (tryLock)
+    {
+        _ownsLock = _mutex.tryLockShared();
+    }
+    else
+    {
+        _mutex.lockShared();
+        _ownsLock = true;
+    }
+}
+
+inline
+SharedMutex::SharedGuard::SharedGuard(ICoroSync::Ptr sync,
+                                      SharedMutex& mutex,
+                                      bool tryLock) :
+    _mutex(mutex)
+{
+    if (tryLock)
+    {
+        _ownsLock = _mutex.tryLockShared();
+    }
+    else
+    {
+        _mutex.lockShared(sync);
+        _ownsLock = true;
+    }
+}
+
+inline
+bool SharedMutex::SharedGuard::ownsLock() const
+{
+    return _ownsLock;
+}
+
+inline
+SharedMutex::SharedGuard::~SharedGuard()
+{
+    if (_ownsLock)
+    {
+        _mutex.unlockShared();
+    }
+}
+
+}}
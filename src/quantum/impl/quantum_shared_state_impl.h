@@ -22,9 +22,14 @@
 namespace Bloomberg {
 namespace quantum {
 
+thread_local static std::atomic_int s_sharedStateThreadSignal{-1}; //thread specific (non-coroutine)
+
+//==============================================================================================
+//                                 class SharedState
+//==============================================================================================
 template <class T>
 SharedState<T>::SharedState() :
-    _state(FutureState::PromiseNotSatisfied),
+    _word((int)FutureState::PromiseNotSatisfied),
     _value(T())
 {
 }
@@ -33,21 +38,21 @@ template <class T>
 template <class V>
 int SharedState<T>::set(V&& value)
 {
-    if (Traits::IsBuffer<T>::value)
+    if (!beginSet())
     {
-        ThrowFutureException(FutureState::BufferingData);
+        int state = _word.load(std::memory_order_acquire) & StateMask;
+        ThrowFutureException((state == Setting) ? FutureState::PromiseAlreadySatisfied : FutureState(state));
     }
+    try
     {
-        //========= LOCKED SCOPE =========
-        Mutex::Guard lock(_mutex);
-        if (_state != FutureState::PromiseNotSatisfied)
-        {
-            ThrowFutureException(_state);
-        }
         _value = std::forward<V>(value);
-        _state = FutureState::PromiseAlreadySatisfied;
     }
-    _cond.notifyAll();
+    catch (...)
+    {
+        abortSet();
+        throw;
+    }
+    endSet(FutureState::PromiseAlreadySatisfied);
     return 0;
 }
 
@@ -55,80 +60,409 @@ template <class T>
 template <class V>
 int SharedState<T>::set(ICoroSync::Ptr sync, V&& value)
 {
-    if (Traits::IsBuffer<T>::value)
+    UNUSED(sync); //setting never blocks
+    return set(std::forward<V>(value));
+}
+
+template <class T>
+T SharedState<T>::get()
+{
+    if (tryRetrieve())
     {
-        ThrowFutureException(FutureState::BufferingData);
+        return std::move(_value); //fast path
     }
+    return getImpl(s_sharedStateThreadSignal, nullptr);
+}
+
+template <class T>
+const T& SharedState<T>::getRef() const
+{
+    if (isFulfilled())
     {
-        //========= LOCKED SCOPE =========
-        Mutex::Guard lock(sync, _mutex);
-        if (_state != FutureState::PromiseNotSatisfied)
+        return _value; //fast path
+    }
+    return getRefImpl(s_sharedStateThreadSignal, nullptr);
+}
+
+template <class T>
+T SharedState<T>::get(ICoroSync::Ptr sync)
+{
+    if (tryRetrieve())
+    {
+        return std::move(_value); //fast path
+    }
+    return getImpl(sync->signal(), sync);
+}
+
+template <class T>
+const T& SharedState<T>::getRef(ICoroSync::Ptr sync) const
+{
+    if (isFulfilled())
+    {
+        return _value; //fast path
+    }
+    return getRefImpl(sync->signal(), sync);
+}
+
+template <class T>
+void SharedState<T>::breakPromise()
+{
+    if (beginSet())
+    {
+        endSet(FutureState::BrokenPromise);
+    }
+}
+
+template <class T>
+void SharedState<T>::wait() const
+{
+    waitImpl(s_sharedStateThreadSignal, nullptr);
+}
+
+template <class T>
+void SharedState<T>::wait(ICoroSync::Ptr sync) const
+{
+    waitImpl(sync->signal(), sync);
+}
+
+template <class T>
+template<class REP, class PERIOD>
+std::future_status SharedState<T>::waitFor(const std::chrono::duration<REP, PERIOD> &time) const
+{
+    return waitForImpl(s_sharedStateThreadSignal, nullptr, std::chrono::duration_cast<std::chrono::nanoseconds>(time));
+}
+
+template <class T>
+template<class REP, class PERIOD>
+std::future_status SharedState<T>::waitFor(ICoroSync::Ptr sync,
+                                           const std::chrono::duration<REP, PERIOD> &time) const
+{
+    return waitForImpl(sync->signal(), sync, std::chrono::duration_cast<std::chrono::nanoseconds>(time));
+}
+
+template <class T>
+int SharedState<T>::setException(std::exception_ptr ex)
+{
+    if (beginSet())
+    {
+        _exception = ex;
+        endSet(FutureState::PromiseAlreadySatisfied);
+    }
+    return -1;
+}
+
+template <class T>
+int SharedState<T>::setException(ICoroSync::Ptr sync,
+                                 std::exception_ptr ex)
+{
+    UNUSED(sync); //setting never blocks
+    return setException(ex);
+}
+
+template <class T>
+void SharedState<T>::addCallback(IFutureCallback::Ptr callback, size_t index) const
+{
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        int word = _word.load(std::memory_order_acquire);
+        while (!isReady(word))
         {
-            ThrowFutureException(_state);
+            if (_word.compare_exchange_weak(word, word | WaitersBit,
+                                            std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                _callbacks.emplace_back(std::move(callback), index);
+                return;
+            }
         }
-        _value = std::forward<V>(value);
-        _state = FutureState::PromiseAlreadySatisfied;
     }
-    _cond.notifyAll();
-    return 0;
+    callback->onReady(index); //already ready
 }
 
 template <class T>
-T SharedState<T>::get()
+void SharedState<T>::removeCallback(const IFutureCallback::Ptr& callback) const
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    _callbacks.remove_if([&callback](const Callback& entry)->bool { return entry.first == callback; });
+}
+
+template <class T>
+bool SharedState<T>::isReady(int word)
+{
+    int state = word & StateMask;
+    return (state != Setting) && (state != (int)FutureState::PromiseNotSatisfied);
+}
+
+template <class T>
+bool SharedState<T>::isFulfilled() const
+{
+    //the waiters bit is cleared when the value is published, so a fulfilled state is an exact match
+    return (_word.load(std::memory_order_acquire) == (int)FutureState::PromiseAlreadySatisfied) && !_exception;
+}
+
+template <class T>
+bool SharedState<T>::tryRetrieve()
+{
+    int word = (int)FutureState::PromiseAlreadySatisfied;
+    return isFulfilled() && _word.compare_exchange_strong(word, (int)FutureState::FutureAlreadyRetrieved,
+                                                          std::memory_order_acq_rel, std::memory_order_relaxed);
+}
+
+template <class T>
+bool SharedState<T>::beginSet()
 {
-    if (Traits::IsBuffer<T>::value)
+    //only one producer may move the state out of PromiseNotSatisfied
+    int word = _word.load(std::memory_order_relaxed);
+    do
     {
-        ThrowFutureException(FutureState::BufferingData);
+        if ((word & StateMask) != (int)FutureState::PromiseNotSatisfied)
+        {
+            return false;
+        }
     }
-    //========= LOCKED SCOPE =========
-    Mutex::Guard lock(_mutex);
-    conditionWait();
-    _state = FutureState::FutureAlreadyRetrieved;
-    return std::move(_value);
+    while (!_word.compare_exchange_weak(word, Setting | (word & WaitersBit),
+                                        std::memory_order_acquire, std::memory_order_relaxed));
+    return true;
 }
 
 template <class T>
-const T& SharedState<T>::getRef() const
+void SharedState<T>::endSet(FutureState state)
 {
-    if (Traits::IsBuffer<T>::value)
+    //publish the value and wake up the waiters, if any
+    if ((_word.exchange((int)state, std::memory_order_acq_rel) & WaitersBit) == 0)
     {
-        ThrowFutureException(FutureState::BufferingData);
+        return;
+    }
+    std::list<Waiter> waiters;
+    std::list<Callback> callbacks;
+    {
+        //========================= LOCKED SCOPE =========================
+        //The waiters are signalled with the lock held. A wait which times out removes itself under
+        //the lock, so it can never receive the signal after it has returned and started another wait.
+        SpinLock::Guard lock(_spinlock);
+        waiters.swap(_waiters);
+        callbacks.swap(_callbacks);
+        for (auto&& waiter : waiters)
+        {
+            (*waiter.first) = 1;
+            if (waiter.second)
+            {
+                waiter.second->wakeUp();
+            }
+            else
+            {
+                Futex::wakeOne(*waiter.first);
+            }
+        }
+    }
+    for (auto&& callback : callbacks)
+    {
+        callback.first->onReady(callback.second);
     }
-    //========= LOCKED SCOPE =========
-    Mutex::Guard lock(_mutex);
-    conditionWait();
-    return _value;
 }
 
 template <class T>
-T SharedState<T>::get(ICoroSync::Ptr sync)
+void SharedState<T>::abortSet()
 {
-    if (Traits::IsBuffer<T>::value)
+    //return to PromiseNotSatisfied, preserving the waiters
+    int word = _word.load(std::memory_order_relaxed);
+    while (!_word.compare_exchange_weak(word, (int)FutureState::PromiseNotSatisfied | (word & WaitersBit),
+                                        std::memory_order_release, std::memory_order_relaxed));
+}
+
+template <class T>
+T SharedState<T>::getImpl(std::atomic_int& signal, const ICoroSync::Ptr& sync)
+{
+    waitImpl(signal, sync);
+    checkPromiseState();
+    int word = (int)FutureState::PromiseAlreadySatisfied;
+    if (!_word.compare_exchange_strong(word, (int)FutureState::FutureAlreadyRetrieved,
+                                       std::memory_order_acq_rel, std::memory_order_relaxed))
     {
-        ThrowFutureException(FutureState::BufferingData);
+        ThrowFutureException(FutureState(word & StateMask));
     }
-    //========= LOCKED SCOPE =========
-    Mutex::Guard lock(sync, _mutex);
-    conditionWait(sync);
-    _state = FutureState::FutureAlreadyRetrieved;
     return std::move(_value);
 }
 
 template <class T>
-const T& SharedState<T>::getRef(ICoroSync::Ptr sync) const
+const T& SharedState<T>::getRefImpl(std::atomic_int& signal, const ICoroSync::Ptr& sync) const
+{
+    waitImpl(signal, sync);
+    checkPromiseState();
+    return _value;
+}
+
+template <class T>
+void SharedState<T>::waitImpl(std::atomic_int& signal, const ICoroSync::Ptr& sync) const
 {
-    if (Traits::IsBuffer<T>::value)
+    if (isReady(_word.load(std::memory_order_acquire)) || !addWaiter(signal, sync))
     {
-        ThrowFutureException(FutureState::BufferingData);
+        return; //fast path
     }
-    //========= LOCKED SCOPE =========
-    Mutex::Guard lock(sync, _mutex);
-    conditionWait(sync);
+    while (signal == 0)
+    {
+        if (sync)
+        {
+            sync->getYieldHandle()(); //parked by the queue until signalled
+        }
+        else
+        {
+            Futex::wait(signal, 0);
+        }
+    }
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock); //wait for endSet() to be done with this waiter
+    }
+    signal = -1; //reset signal flag
+}
+
+template <class T>
+std::future_status SharedState<T>::waitForImpl(std::atomic_int& signal,
+                                               const ICoroSync::Ptr& sync,
+                                               std::chrono::nanoseconds time) const
+{
+    if (isReady(_word.load(std::memory_order_acquire)))
+    {
+        return std::future_status::ready;
+    }
+    if ((time <= std::chrono::nanoseconds::zero()) || !addWaiter(signal, sync))
+    {
+        return isReady(_word.load(std::memory_order_acquire)) ? std::future_status::ready : std::future_status::timeout;
+    }
+    auto deadline = Clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(time);
+    if (sync)
+    {
+        //park the coroutine until signalled or until the time expires
+        sync->setWakeUpTime(deadline);
+    }
+    while (signal == 0)
+    {
+        auto now = Clock::now();
+        if (now >= deadline)
+        {
+            break;
+        }
+        if (sync)
+        {
+            sync->getYieldHandle()();
+        }
+        else
+        {
+            Futex::waitFor(signal, 0, deadline - now);
+        }
+    }
+    if (sync)
+    {
+        sync->clearWakeUpTime();
+    }
+    {
+        //========================= LOCKED SCOPE =========================
+        //Either endSet() has signalled this waiter already or it never will once removed
+        SpinLock::Guard lock(_spinlock);
+        if (signal == 0)
+        {
+            _waiters.remove_if([&signal](const Waiter& waiter)->bool
+            {
+                return waiter.first == &signal;
+            });
+        }
+    }
+    signal = -1; //reset signal flag
+    return isReady(_word.load(std::memory_order_acquire)) ? std::future_status::ready : std::future_status::timeout;
+}
+
+template <class T>
+bool SharedState<T>::addWaiter(std::atomic_int& signal, const ICoroSync::Ptr& sync) const
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    int word = _word.load(std::memory_order_acquire);
+    do
+    {
+        if (isReady(word))
+        {
+            return false;
+        }
+    }
+    while (!_word.compare_exchange_weak(word, word | WaitersBit,
+                                        std::memory_order_acq_rel, std::memory_order_acquire));
+    signal = 0; //clear signal flag
+    _waiters.emplace_back(&signal, sync);
+    return true;
+}
+
+template <class T>
+void SharedState<T>::checkPromiseState() const
+{
+    if (_exception)
+    {
+        std::rethrow_exception(_exception);
+    }
+    FutureState state = FutureState(_word.load(std::memory_order_acquire) & StateMask);
+    if ((state == FutureState::BrokenPromise) || (state == FutureState::FutureAlreadyRetrieved))
+    {
+        ThrowFutureException(state);
+    }
+}
+
+//==============================================================================================
+//                                 class SharedState<Buffer>
+//==============================================================================================
+template <class T>
+SharedState<Buffer<T>>::SharedState() :
+    _state(FutureState::PromiseNotSatisfied),
+    _numCallbacks(0)
+{
+}
+
+template <class T>
+template <class V>
+int SharedState<Buffer<T>>::set(V&&)
+{
+    ThrowFutureException(FutureState::BufferingData);
+    return 0;
+}
+
+template <class T>
+template <class V>
+int SharedState<Buffer<T>>::set(ICoroSync::Ptr, V&&)
+{
+    ThrowFutureException(FutureState::BufferingData);
+    return 0;
+}
+
+template <class T>
+Buffer<T> SharedState<Buffer<T>>::get()
+{
+    ThrowFutureException(FutureState::BufferingData);
+    return Buffer<T>();
+}
+
+template <class T>
+Buffer<T> SharedState<Buffer<T>>::get(ICoroSync::Ptr)
+{
+    ThrowFutureException(FutureState::BufferingData);
+    return Buffer<T>();
+}
+
+template <class T>
+const Buffer<T>& SharedState<Buffer<T>>::getRef() const
+{
+    ThrowFutureException(FutureState::BufferingData);
     return _value;
 }
 
 template <class T>
-void SharedState<T>::breakPromise()
+const Buffer<T>& SharedState<Buffer<T>>::getRef(ICoroSync::Ptr) const
+{
+    ThrowFutureException(FutureState::BufferingData);
+    return _value;
+}
+
+template <class T>
+void SharedState<Buffer<T>>::breakPromise()
 {
     {//========= LOCKED SCOPE =========
         Mutex::Guard lock(_mutex);
@@ -138,99 +472,106 @@ void SharedState<T>::breakPromise()
         }
     }
     _cond.notifyAll();
+    notifyCallbacks();
 }
 
 template <class T>
-void SharedState<T>::wait() const
+void SharedState<Buffer<T>>::wait() const
 {
-    if (Traits::IsBuffer<T>::value)
-    {
-        ThrowFutureException(FutureState::BufferingData);
-    }
-    //========= LOCKED SCOPE =========
-    Mutex::Guard lock(_mutex);
-    _cond.wait(_mutex, [this]()->bool
-    {
-        return stateHasChanged();
-    });
+    ThrowFutureException(FutureState::BufferingData);
 }
 
 template <class T>
-void SharedState<T>::wait(ICoroSync::Ptr sync) const
+void SharedState<Buffer<T>>::wait(ICoroSync::Ptr) const
 {
-    if (Traits::IsBuffer<T>::value)
-    {
-        ThrowFutureException(FutureState::BufferingData);
-    }
-    //========= LOCKED SCOPE =========
-    Mutex::Guard lock(sync, _mutex);
-    _cond.wait(sync, _mutex, [this]()->bool
-    {
-        return stateHasChanged();
-    });
+    ThrowFutureException(FutureState::BufferingData);
 }
 
 template <class T>
 template<class REP, class PERIOD>
-std::future_status SharedState<T>::waitFor(const std::chrono::duration<REP, PERIOD> &time) const
+std::future_status SharedState<Buffer<T>>::waitFor(const std::chrono::duration<REP, PERIOD>&) const
+{
+    ThrowFutureException(FutureState::BufferingData);
+    return std::future_status::ready;
+}
+
+template <class T>
+template<class REP, class PERIOD>
+std::future_status SharedState<Buffer<T>>::waitFor(ICoroSync::Ptr,
+                                                   const std::chrono::duration<REP, PERIOD>&) const
+{
+    ThrowFutureException(FutureState::BufferingData);
+    return std::future_status::ready;
+}
+
+template <class T>
+void SharedState<Buffer<T>>::addCallback(IFutureCallback::Ptr callback, size_t index) const
 {
-    if (Traits::IsBuffer<T>::value)
     {
-        ThrowFutureException(FutureState::BufferingData);
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_callbackLock);
+        _callbacks.emplace_back(callback, index);
+        ++_numCallbacks;
     }
-    //========= LOCKED SCOPE =========
-    Mutex::Guard lock(_mutex);
-    _cond.waitFor(_mutex, time, [this]()->bool
+    bool isReady;
     {
-        return stateHasChanged();
-    });
-    return _state == FutureState::PromiseNotSatisfied ? std::future_status::timeout : std::future_status::ready;
+        //========================= LOCKED SCOPE =========================
+        Mutex::Guard lock(_mutex);
+        isReady = isPullable();
+    }
+    if (isReady)
+    {
+        callback->onReady(index); //data was pushed before the callback was registered
+    }
 }
 
 template <class T>
-template<class REP, class PERIOD>
-std::future_status SharedState<T>::waitFor(ICoroSync::Ptr sync,
-                                           const std::chrono::duration<REP, PERIOD> &time) const
+void SharedState<Buffer<T>>::removeCallback(const IFutureCallback::Ptr& callback) const
 {
-    if (Traits::IsBuffer<T>::value)
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_callbackLock);
+    for (auto it = _callbacks.begin(); it != _callbacks.end();)
     {
-        ThrowFutureException(FutureState::BufferingData);
+        if (it->first == callback)
+        {
+            it = _callbacks.erase(it);
+            --_numCallbacks;
+        }
+        else
+        {
+            ++it;
+        }
     }
-    //========= LOCKED SCOPE =========
-    Mutex::Guard lock(sync, _mutex);
-    _cond.waitFor(sync, _mutex, time, [this]()->bool
-    {
-        return stateHasChanged();
-    });
-    return _state == FutureState::PromiseNotSatisfied ? std::future_status::timeout : std::future_status::ready;
 }
 
 template <class T>
-int SharedState<T>::setException(std::exception_ptr ex)
+int SharedState<Buffer<T>>::setException(std::exception_ptr ex)
 {
     {//========= LOCKED SCOPE =========
         Mutex::Guard lock(_mutex);
         _exception = ex;
     }
     _cond.notifyAll();
+    notifyCallbacks();
     return -1;
 }
 
 template <class T>
-int SharedState<T>::setException(ICoroSync::Ptr sync,
-                                 std::exception_ptr ex)
+int SharedState<Buffer<T>>::setException(ICoroSync::Ptr sync,
+                                         std::exception_ptr ex)
 {
     {//========= LOCKED SCOPE =========
         Mutex::Guard lock(sync, _mutex);
         _exception = ex;
     }
     _cond.notifyAll();
+    notifyCallbacks();
     return -1;
 }
 
 template <class T>
 template <class BUF, class V>
-void SharedState<T>::push(V&& value)
+void SharedState<Buffer<T>>::push(V&& value)
 {
     {//========= LOCKED SCOPE =========
         Mutex::Guard lock(_mutex);
@@ -246,11 +587,12 @@ void SharedState<T>::push(V&& value)
         _state = FutureState::BufferingData;
     }
     _cond.notifyAll();
+    notifyCallbacks();
 }
 
 template <class T>
 template <class BUF, class V>
-void SharedState<T>::push(ICoroSync::Ptr sync, V&& value)
+void SharedState<Buffer<T>>::push(ICoroSync::Ptr sync, V&& value)
 {
     {//========= LOCKED SCOPE =========
         Mutex::Guard lock(sync, _mutex);
@@ -266,16 +608,17 @@ void SharedState<T>::push(ICoroSync::Ptr sync, V&& value)
         _state = FutureState::BufferingData;
     }
     _cond.notifyAll();
+    notifyCallbacks();
 }
 
 template <class T>
 template <class BUF, class V>
-V SharedState<T>::pull(bool& isBufferClosed)
+V SharedState<Buffer<T>>::pull(bool& isBufferClosed)
 {
     //========= LOCKED SCOPE =========
     Mutex::Guard lock(_mutex);
     BufferStatus status;
-    V out;
+    V out{}; //returned as is once the buffer is closed
     isBufferClosed = true;
     _cond.wait(_mutex, [&status, &out, this]()->bool
     {
@@ -294,12 +637,12 @@ V SharedState<T>::pull(bool& isBufferClosed)
 
 template <class T>
 template <class BUF, class V>
-V SharedState<T>::pull(ICoroSync::Ptr sync, bool& isBufferClosed)
+V SharedState<Buffer<T>>::pull(ICoroSync::Ptr sync, bool& isBufferClosed)
 {
     //========= LOCKED SCOPE =========
     Mutex::Guard lock(sync, _mutex);
     BufferStatus status;
-    V out;
+    V out{}; //returned as is once the buffer is closed
     isBufferClosed = true;
     _cond.wait(sync, _mutex, [&status, &out, this]()->bool
     {
@@ -318,41 +661,112 @@ V SharedState<T>::pull(ICoroSync::Ptr sync, bool& isBufferClosed)
 
 template <class T>
 template <class BUF, class V>
-int SharedState<T>::closeBuffer()
+void SharedState<Buffer<T>>::pushMany(std::vector<V>&& values)
 {
-    //========= LOCKED SCOPE =========
-    Mutex::Guard lock(_mutex);
-    if ((_state == FutureState::PromiseNotSatisfied) || (_state == FutureState::BufferingData))
-    {
-        _state = FutureState::BufferClosed;
+    {//========= LOCKED SCOPE =========
+        Mutex::Guard lock(_mutex);
+        if ((_state != FutureState::PromiseNotSatisfied) && (_state != FutureState::BufferingData))
+        {
+            ThrowFutureException(_state);
+        }
+        BufferStatus status = _value.pushMany(std::move(values));
+        if (status == BufferStatus::Closed)
+        {
+            ThrowFutureException(FutureState::BufferClosed);
+        }
+        _state = FutureState::BufferingData;
     }
-    _value.close();
     _cond.notifyAll();
-    return 0;
+    notifyCallbacks();
 }
 
 template <class T>
-void SharedState<T>::conditionWait() const
+template <class BUF, class V>
+void SharedState<Buffer<T>>::pushMany(ICoroSync::Ptr sync, std::vector<V>&& values)
+{
+    {//========= LOCKED SCOPE =========
+        Mutex::Guard lock(sync, _mutex);
+        if ((_state != FutureState::PromiseNotSatisfied) && (_state != FutureState::BufferingData))
+        {
+            ThrowFutureException(_state);
+        }
+        BufferStatus status = _value.pushMany(std::move(values));
+        if (status == BufferStatus::Closed)
+        {
+            ThrowFutureException(FutureState::BufferClosed);
+        }
+        _state = FutureState::BufferingData;
+    }
+    _cond.notifyAll();
+    notifyCallbacks();
+}
+
+template <class T>
+template <class BUF, class V>
+size_t SharedState<Buffer<T>>::pullMany(std::vector<V>& values, size_t maxCount, bool& isBufferClosed)
 {
-    _cond.wait(_mutex, [this]()->bool
+    //========= LOCKED SCOPE =========
+    Mutex::Guard lock(_mutex);
+    BufferStatus status;
+    size_t size = values.size();
+    isBufferClosed = true;
+    _cond.wait(_mutex, [&status, &values, maxCount, this]()->bool
     {
-        return stateHasChanged();
+        status = _value.pullMany(values, maxCount);
+        return bufferStateHasChanged(status);
     });
     checkPromiseState();
+    isBufferClosed = (status == BufferStatus::Closed); //set output
+    if (isBufferClosed)
+    {
+        //Mark the future as fully retrieved
+        _state = FutureState::FutureAlreadyRetrieved;
+    }
+    return values.size() - size;
 }
 
 template <class T>
-void SharedState<T>::conditionWait(ICoroSync::Ptr sync) const
+template <class BUF, class V>
+size_t SharedState<Buffer<T>>::pullMany(ICoroSync::Ptr sync, std::vector<V>& values, size_t maxCount, bool& isBufferClosed)
 {
-    _cond.wait(sync, _mutex, [this]()->bool
+    //========= LOCKED SCOPE =========
+    Mutex::Guard lock(sync, _mutex);
+    BufferStatus status;
+    size_t size = values.size();
+    isBufferClosed = true;
+    _cond.wait(sync, _mutex, [&status, &values, maxCount, this]()->bool
     {
-        return stateHasChanged();
+        status = _value.pullMany(values, maxCount);
+        return bufferStateHasChanged(status);
     });
     checkPromiseState();
+    isBufferClosed = (status == BufferStatus::Closed);
+    if (isBufferClosed)
+    {
+        //Mark the future as fully retrieved
+        _state = FutureState::FutureAlreadyRetrieved;
+    }
+    return values.size() - size;
 }
 
 template <class T>
-void SharedState<T>::checkPromiseState() const
+template <class BUF, class V>
+int SharedState<Buffer<T>>::closeBuffer()
+{
+    //========= LOCKED SCOPE =========
+    Mutex::Guard lock(_mutex);
+    if ((_state == FutureState::PromiseNotSatisfied) || (_state == FutureState::BufferingData))
+    {
+        _state = FutureState::BufferClosed;
+    }
+    _value.close();
+    _cond.notifyAll();
+    notifyCallbacks();
+    return 0;
+}
+
+template <class T>
+void SharedState<Buffer<T>>::checkPromiseState() const
 {
     if (_exception)
     {
@@ -365,14 +779,31 @@ void SharedState<T>::checkPromiseState() const
 }
 
 template <class T>
-bool SharedState<T>::stateHasChanged() const
+bool SharedState<Buffer<T>>::isPullable() const
 {
-    return (_state != FutureState::PromiseNotSatisfied) || (_exception != nullptr);
+    //a pull would return right away
+    return !_value.empty() ||
+           ((_state != FutureState::PromiseNotSatisfied) && (_state != FutureState::BufferingData)) ||
+           (_exception != nullptr);
+}
+
+template <class T>
+void SharedState<Buffer<T>>::notifyCallbacks() const
+{
+    if (_numCallbacks == 0)
+    {
+        return; //fast path
+    }
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_callbackLock);
+    for (auto&& callback : _callbacks)
+    {
+        callback.first->onReady(callback.second);
+    }
 }
 
 template <class T>
-template <class BUF, typename>
-bool SharedState<T>::bufferStateHasChanged(BufferStatus status) const
+bool SharedState<Buffer<T>>::bufferStateHasChanged(BufferStatus status) const
 {
     return ((status == BufferStatus::DataReceived) || (status == BufferStatus::Closed)) ||
            ((_state == FutureState::BrokenPromise) || (_state == FutureState::FutureAlreadyRetrieved)) ||
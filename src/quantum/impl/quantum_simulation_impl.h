@@ -0,0 +1,177 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class Simulation
+//==============================================================================================
+inline
+Simulation::Simulation(Dispatcher& dispatcher, uint64_t seed) :
+    _dispatcher(dispatcher),
+    _seed(seed),
+    _random(seed),
+    _start(std::chrono::steady_clock::now()),
+    _now(_start),
+    _numSteps(0),
+    _numClockAdvances(0),
+    _firstLockAcquisitions(SpinLock::threadAcquisitionCount()),
+    _scheduleHash(14695981039346656037ULL) //FNV-1a offset basis
+{
+    if (_dispatcher.getNumManualCoroutineQueues() != _dispatcher.getNumCoroutineThreads())
+    {
+        throw std::runtime_error("All the coroutine queues must be manual");
+    }
+    _dispatcher._dispatcher.setSchedulerCounters(&_counters);
+}
+
+inline
+Simulation::~Simulation()
+{
+    _dispatcher._dispatcher.setSchedulerCounters(nullptr);
+}
+
+inline
+bool Simulation::step()
+{
+    size_t numQueues = _dispatcher.getNumCoroutineThreads();
+    Clock::Guard guard(_now); //the coroutines and the queue timers read the virtual time
+    while (true)
+    {
+        size_t first = (size_t)(_random() % numQueues);
+        for (size_t i = 0; i < numQueues; ++i)
+        {
+            int queueId = (int)((first + i) % numQueues);
+            size_t numYields = _counters._numYields.load(std::memory_order_relaxed);
+            size_t numBlocks = _counters._numBlocks.load(std::memory_order_relaxed);
+            if (_dispatcher.runOnce(queueId, 1) > 0)
+            {
+                //record where the slice ran and how it ended
+                uint64_t outcome = (_counters._numYields.load(std::memory_order_relaxed) != numYields) ? 1 :
+                                   (_counters._numBlocks.load(std::memory_order_relaxed) != numBlocks) ? 2 : 3;
+                hash(((uint64_t)queueId << 2) | outcome);
+                ++_numSteps;
+                return true;
+            }
+        }
+        Task::TimePoint time;
+        if (_dispatcher._dispatcher.getNextTimerTime(time))
+        {
+            if (time > _now)
+            {
+                _now = time; //nothing can run before the next timer expires
+                ++_numClockAdvances;
+            }
+            continue; //the expired waits are resumed by the next pass
+        }
+        if (_dispatcher.size(IQueue::QueueType::IO) == 0)
+        {
+            return false;
+        }
+        std::this_thread::yield(); //IO tasks complete in real time
+    }
+}
+
+inline
+size_t Simulation::run(size_t maxSteps)
+{
+    size_t numSteps = 0;
+    while ((numSteps < maxSteps) && step())
+    {
+        ++numSteps;
+    }
+    return numSteps;
+}
+
+inline
+Clock::TimePoint Simulation::now() const
+{
+    return _now;
+}
+
+inline
+void Simulation::advance(std::chrono::nanoseconds time)
+{
+    _now += std::chrono::duration_cast<Clock::TimePoint::duration>(time);
+}
+
+inline
+uint64_t Simulation::getSeed() const
+{
+    return _seed;
+}
+
+inline
+Simulation::Statistics Simulation::statistics() const
+{
+    Statistics stats;
+    stats._numSteps = _numSteps;
+    stats._numScans = _counters._numScans.load(std::memory_order_relaxed);
+    stats._numSlices = _counters._numSlices.load(std::memory_order_relaxed);
+    stats._numYields = _counters._numYields.load(std::memory_order_relaxed);
+    stats._numBlocks = _counters._numBlocks.load(std::memory_order_relaxed);
+    stats._numWakeUps = _counters._numWakeUps.load(std::memory_order_relaxed);
+    stats._numTimerExpirations = _counters._numTimerExpirations.load(std::memory_order_relaxed);
+    stats._numCompletions = _counters._numCompletions.load(std::memory_order_relaxed);
+    stats._numClockAdvances = _numClockAdvances;
+    stats._numLockAcquisitions = SpinLock::threadAcquisitionCount() - _firstLockAcquisitions;
+    stats._virtualTime = std::chrono::duration_cast<std::chrono::nanoseconds>(_now - _start);
+    stats._scheduleHash = _scheduleHash;
+    return stats;
+}
+
+inline
+void Simulation::print(std::ostream& out) const
+{
+    Statistics stats = statistics();
+    out << "Simulation: seed " << _seed << ", " << stats._numSteps << " steps, "
+        << std::chrono::duration_cast<std::chrono::microseconds>(stats._virtualTime).count() << "us virtual time, "
+        << "schedule " << std::hex << stats._scheduleHash << std::dec << std::endl;
+    out << "  scans: " << stats._numScans << std::endl;
+    out << "  slices: " << stats._numSlices << std::endl;
+    out << "  yields: " << stats._numYields << std::endl;
+    out << "  blocks: " << stats._numBlocks << std::endl;
+    out << "  wakeUps: " << stats._numWakeUps << std::endl;
+    out << "  timerExpirations: " << stats._numTimerExpirations << std::endl;
+    out << "  completions: " << stats._numCompletions << std::endl;
+    out << "  clockAdvances: " << stats._numClockAdvances << std::endl;
+    out << "  lockAcquisitions: " << stats._numLockAcquisitions << std::endl;
+}
+
+inline
+void Simulation::hash(uint64_t value)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        _scheduleHash ^= (value >> (8 * i)) & 0xFF;
+        _scheduleHash *= 1099511628211ULL; //FNV-1a prime
+    }
+}
+
+inline
+std::ostream& operator<<(std::ostream& out, const Simulation& simulation)
+{
+    simulation.print(out);
+    return out;
+}
+
+}}
@@ -0,0 +1,67 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+template <class T>
+Span<T>::Span(T* data, size_t size) :
+    _data(data),
+    _size(size)
+{}
+
+template <class T>
+T* Span<T>::data() const
+{
+    return _data;
+}
+
+template <class T>
+size_t Span<T>::size() const
+{
+    return _size;
+}
+
+template <class T>
+bool Span<T>::empty() const
+{
+    return _size == 0;
+}
+
+template <class T>
+T& Span<T>::operator[](size_t i) const
+{
+    return _data[i];
+}
+
+template <class T>
+T* Span<T>::begin() const
+{
+    return _data;
+}
+
+template <class T>
+T* Span<T>::end() const
+{
+    return _data + _size;
+}
+
+}}
@@ -19,31 +19,121 @@
 //#################################### IMPLEMENTATIONS #########################################
 //##############################################################################################
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+#endif
+
 namespace Bloomberg {
 namespace quantum {
 
+inline
+void SpinBackoff::cpuRelax()
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_ia32_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__aarch64__) || defined(__arm__))
+    asm volatile("yield" ::: "memory");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#endif
+}
+
+inline
+void SpinBackoff::backoff()
+{
+    for (int i = 0; i < _numSpins; ++i)
+    {
+        cpuRelax();
+    }
+    if (_numSpins < MaxSpins)
+    {
+        _numSpins <<= 1;
+    }
+    else
+    {
+        //the lock is held for long, give up the time slice
+        std::this_thread::yield();
+    }
+}
+
 inline
 SpinLock::SpinLock() :
-    _flag(ATOMIC_FLAG_INIT)
+    _locked(false)
+#ifdef __QUANTUM_SPINLOCK_STATS
+    ,_contentionCount(0)
+#endif
 {}
 
 inline
 void SpinLock::lock()
 {
-    while (_flag.test_and_set(std::memory_order_acquire)); //spin
+#ifdef __QUANTUM_SPINLOCK_STATS
+    ++threadAcquisitions();
+#endif
+    if (!_locked.exchange(true, std::memory_order_acquire))
+    {
+        return; //uncontended
+    }
+#ifdef __QUANTUM_SPINLOCK_STATS
+    _contentionCount.fetch_add(1, std::memory_order_relaxed);
+#endif
+    SpinBackoff backoff;
+    do
+    {
+        //spin on a read so that the cache line is shared until the lock is released
+        while (_locked.load(std::memory_order_relaxed))
+        {
+            backoff.backoff();
+        }
+    }
+    while (_locked.exchange(true, std::memory_order_acquire));
 }
 
 inline
 bool SpinLock::tryLock()
 {
-    return !_flag.test_and_set(std::memory_order_acquire);
+    bool isLocked = !_locked.load(std::memory_order_relaxed) &&
+                    !_locked.exchange(true, std::memory_order_acquire);
+#ifdef __QUANTUM_SPINLOCK_STATS
+    threadAcquisitions() += isLocked ? 1 : 0;
+#endif
+    return isLocked;
 }
 
 inline
 void SpinLock::unlock()
 {
-    _flag.clear(std::memory_order_release);
+    _locked.store(false, std::memory_order_release);
+}
+
+inline
+size_t SpinLock::contentionCount() const
+{
+#ifdef __QUANTUM_SPINLOCK_STATS
+    return _contentionCount.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+inline
+size_t SpinLock::threadAcquisitionCount()
+{
+#ifdef __QUANTUM_SPINLOCK_STATS
+    return threadAcquisitions();
+#else
+    return 0;
+#endif
+}
+
+#ifdef __QUANTUM_SPINLOCK_STATS
+inline
+size_t& SpinLock::threadAcquisitions()
+{
+    thread_local size_t count = 0;
+    return count;
 }
+#endif
 
 inline
 SpinLock::Guard::Guard(SpinLock& lock) :
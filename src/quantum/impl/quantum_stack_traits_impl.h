@@ -57,4 +57,19 @@ size_t& StackTraits::maximumSize()
     return maximumSize;
 }
 
+inline
+size_t& StackTraits::classSize(StackSizeClass sizeClass)
+{
+    static size_t smallSize = 16*1024;
+    static size_t mediumSize = 64*1024;
+    static size_t largeSize = 256*1024;
+    switch (sizeClass)
+    {
+        case StackSizeClass::Small: return smallSize;
+        case StackSizeClass::Medium: return mediumSize;
+        case StackSizeClass::Large: return largeSize;
+        default: return defaultSize();
+    }
+}
+
 }}
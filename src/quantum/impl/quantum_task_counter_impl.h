@@ -0,0 +1,189 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                class TaskCounter
+//==============================================================================================
+inline
+TaskCounter::TaskCounter() :
+    _count(0),
+    _numWaiters(0),
+    _lowWatermark(0),
+    _numAdmissionWaiters(0)
+{}
+
+inline
+void TaskCounter::increment(size_t num)
+{
+    _count.fetch_add(num);
+}
+
+inline
+void TaskCounter::decrement(size_t num)
+{
+    //Both atomics are sequentially consistent so that either the waiter sees the count at zero
+    //or this thread sees the waiter.
+    size_t count = _count.fetch_sub(num);
+    if ((count == num) && (_numWaiters > 0))
+    {
+        notify();
+    }
+    if ((count > _lowWatermark) && (count - num <= _lowWatermark))
+    {
+        notifyAdmission();
+    }
+}
+
+inline
+size_t TaskCounter::count() const
+{
+    return _count;
+}
+
+inline
+bool TaskCounter::wait(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    ++_numWaiters;
+    auto predicate = [this]() -> bool { return _count == 0; };
+    bool isQuiescent = true;
+    if (timeout == std::chrono::milliseconds::zero())
+    {
+        _cond.wait(lock, predicate);
+    }
+    else
+    {
+        isQuiescent = _cond.wait_for(lock, timeout, predicate);
+    }
+    --_numWaiters;
+    return isQuiescent;
+}
+
+inline
+void TaskCounter::onQuiescence(Callback callback)
+{
+    if (!callback)
+    {
+        return;
+    }
+    {
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_numWaiters;
+        if (_count != 0)
+        {
+            _callbacks.emplace_back(std::move(callback));
+            return;
+        }
+        --_numWaiters;
+    }
+    try
+    {
+        callback();
+    }
+    catch (...)
+    {
+        //user callbacks must not propagate
+    }
+}
+
+inline
+std::future<void> TaskCounter::whenQuiescent()
+{
+    auto promise = std::make_shared<std::promise<void>>();
+    std::future<void> future = promise->get_future();
+    onQuiescence([promise]() { promise->set_value(); });
+    return future;
+}
+
+inline
+void TaskCounter::reset()
+{
+    _count = 0;
+    notify();
+    notifyAdmission();
+}
+
+inline
+void TaskCounter::setLowWatermark(size_t num)
+{
+    _lowWatermark = num;
+}
+
+inline
+void TaskCounter::waitForAdmission(const std::function<bool()>& isAdmitted)
+{
+    std::unique_lock<std::mutex> lock(_admissionMutex);
+    ++_numAdmissionWaiters;
+    //Pairs with the fence of the queues so that either the predicate sees the drained queue or the
+    //queue sees this waiter
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    _admissionCond.wait(lock, isAdmitted);
+    --_numAdmissionWaiters;
+}
+
+inline
+void TaskCounter::notifyAdmission()
+{
+    if (_numAdmissionWaiters == 0)
+    {
+        return;
+    }
+    {
+        //========================= LOCKED SCOPE =========================
+        //A waiter is either blocked or has yet to evaluate its predicate
+        std::lock_guard<std::mutex> lock(_admissionMutex);
+    }
+    _admissionCond.notify_all();
+}
+
+inline
+void TaskCounter::notify()
+{
+    std::vector<Callback> callbacks;
+    {
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_count != 0)
+        {
+            return; //a new task was posted in the meantime
+        }
+        _numWaiters -= _callbacks.size();
+        callbacks.swap(_callbacks);
+    }
+    _cond.notify_all();
+    for (auto&& callback : callbacks)
+    {
+        try
+        {
+            callback();
+        }
+        catch (...)
+        {
+            //keep notifying the other callbacks
+        }
+    }
+}
+
+}}
@@ -29,12 +29,12 @@ namespace quantum {
 #endif
 #ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
     #ifdef __QUANTUM_ALLOCATE_POOL_FROM_HEAP
-        using TaskAllocator = HeapAllocator<Task>;
+        using TaskAllocator = HeapAllocator<SharedBlock<Task>>;
     #else
-        using TaskAllocator = StackAllocator<Task, __QUANTUM_TASK_ALLOC_SIZE>;
+        using TaskAllocator = StackAllocator<SharedBlock<Task>, __QUANTUM_TASK_ALLOC_SIZE>;
     #endif
 #else
-    using TaskAllocator = StlAllocator<Task>;
+    using TaskAllocator = StlAllocator<SharedBlock<Task>>;
 #endif
 
 template <class RET, class FUNC, class ... ARGS>
@@ -43,13 +43,35 @@ Task::Task(std::shared_ptr<Context<RET>> ctx,
            FUNC&& func,
            ARGS&&... args) :
     _ctx(ctx),
-    _coro(Allocator<CoroStackAllocator>::instance(AllocatorTraits::defaultCoroPoolAllocSize()),
-          Util::bindCaller(ctx, std::forward<FUNC>(func), std::forward<ARGS>(args)...)),
+    _stackSize(StackSizeClass::Default),
     _queueId((int)IQueue::QueueId::Any),
     _isHighPriority(false),
+    _priority(IQueue::Priority::Normal),
+    _deadline(TimePoint::max()),
     _rc((int)ITask::RetCode::Running),
     _type(type),
-    _terminated(ATOMIC_FLAG_INIT)
+    _terminated(ATOMIC_FLAG_INIT),
+    _isPinned(false),
+    _isStarted(false),
+    _isParked(false),
+    _timerId(0),
+    _hasWakeUpTime(false),
+    _isTimerScheduled(false),
+    _isTimerExpired(false),
+    _queueHook(),
+    _label(typeLabel<typename std::decay<FUNC>::type>())
+{
+    initCoroutine(ctx, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+Task::Task(std::shared_ptr<Context<RET>> ctx,
+           int queueId,
+           bool isHighPriority,
+           ITask::Type type,
+           FUNC&& func,
+           ARGS&&... args) :
+    Task(ctx, queueId, isHighPriority, type, StackSizeClass::Default, std::forward<FUNC>(func), std::forward<ARGS>(args)...)
 {}
 
 template <class RET, class FUNC, class ... ARGS>
@@ -57,17 +79,119 @@ Task::Task(std::shared_ptr<Context<RET>> ctx,
            int queueId,
            bool isHighPriority,
            ITask::Type type,
+           StackSizeClass stackSize,
            FUNC&& func,
            ARGS&&... args) :
     _ctx(ctx),
-    _coro(Allocator<CoroStackAllocator>::instance(AllocatorTraits::defaultCoroPoolAllocSize()),
-          Util::bindCaller(ctx, std::forward<FUNC>(func), std::forward<ARGS>(args)...)),
+    _stackSize(stackSize),
     _queueId(queueId),
     _isHighPriority(isHighPriority),
+    _priority(isHighPriority ? IQueue::Priority::High : IQueue::Priority::Normal),
+    _deadline(TimePoint::max()),
     _rc((int)ITask::RetCode::Running),
     _type(type),
-    _terminated(ATOMIC_FLAG_INIT)
-{}
+    _terminated(ATOMIC_FLAG_INIT),
+    _isPinned(queueId != (int)IQueue::QueueId::Any),
+    _isStarted(false),
+    _isParked(false),
+    _timerId(0),
+    _hasWakeUpTime(false),
+    _isTimerScheduled(false),
+    _isTimerExpired(false),
+    _queueHook(),
+    _label(typeLabel<typename std::decay<FUNC>::type>())
+{
+    initCoroutine(ctx, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+}
+
+template <class RET, class FUNC, class ... ARGS>
+Task::Task(std::shared_ptr<Promise<RET>> promise,
+           int queueId,
+           bool isHighPriority,
+           FUNC&& func,
+           ARGS&&... args) :
+    _stackSize(StackSizeClass::Default),
+    _func(Util::bindIoCaller(promise,
+                             std::forward<FUNC>(func),
+                             std::forward<ARGS>(args)...)),
+    _promise(promise),
+    _queueId(queueId),
+    _isHighPriority(isHighPriority),
+    _priority(isHighPriority ? IQueue::Priority::High : IQueue::Priority::Normal),
+    _deadline(TimePoint::max()),
+    _rc((int)ITask::RetCode::Running),
+    _type(ITask::Type::Standalone),
+    _terminated(ATOMIC_FLAG_INIT),
+    _isPinned(queueId != (int)IQueue::QueueId::Any),
+    _isStarted(false),
+    _isParked(false),
+    _timerId(0),
+    _hasWakeUpTime(false),
+    _isTimerScheduled(false),
+    _isTimerExpired(false),
+    _queueHook(),
+    _label(typeLabel<typename std::decay<FUNC>::type>())
+{
+}
+
+template <class FUNC>
+const char* Task::typeLabel()
+{
+    static const char* label = Profile::registerTypeName(typeid(FUNC).name());
+    return label;
+}
+
+template <class RET, class FUNC, class ... ARGS>
+void Task::initCoroutine(std::shared_ptr<Context<RET>> ctx, FUNC&& func, ARGS&&... args)
+{
+    auto caller = Util::bindCaller(ctx, std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    if ((_type == Type::Continuation) || (_type == Type::ErrorHandler) || (_type == Type::Final))
+    {
+        _coroFactory.reset(new CoroutineFactoryImpl<decltype(caller)>(std::move(caller)));
+    }
+    else
+    {
+        _coro.emplace(stackAllocator(_stackSize), std::move(caller));
+    }
+}
+
+template <class A = CoroStackAllocator>
+A makeCoroStackAllocator(std::enable_if_t<!A::default_constructor::value, size_t> stackSize)
+{
+    return A(AllocatorTraits::defaultCoroPoolAllocSize(), stackSize);
+}
+
+template <class A = CoroStackAllocator>
+A makeCoroStackAllocator(std::enable_if_t<A::default_constructor::value, size_t> stackSize)
+{
+    return A(stackSize);
+}
+
+inline
+CoroStackAllocator& Task::stackAllocator(StackSizeClass stackSize)
+{
+    //each pool is only created once a coroutine of its class is posted
+    switch (stackSize)
+    {
+        case StackSizeClass::Small:
+        {
+            static CoroStackAllocator allocator = makeCoroStackAllocator(StackTraits::classSize(StackSizeClass::Small));
+            return allocator;
+        }
+        case StackSizeClass::Medium:
+        {
+            static CoroStackAllocator allocator = makeCoroStackAllocator(StackTraits::classSize(StackSizeClass::Medium));
+            return allocator;
+        }
+        case StackSizeClass::Large:
+        {
+            static CoroStackAllocator allocator = makeCoroStackAllocator(StackTraits::classSize(StackSizeClass::Large));
+            return allocator;
+        }
+        default:
+            return Allocator<CoroStackAllocator>::instance(AllocatorTraits::defaultCoroPoolAllocSize());
+    }
+}
 
 inline
 Task::~Task()
@@ -80,16 +204,33 @@ void Task::terminate()
 {
     if (!_terminated.test_and_set())
     {
+        _isParked = false; //a late signal must not reschedule this task
         if (_ctx) _ctx->terminate();
+        if (_promise) _promise->terminate();
     }
 }
 
 inline
 int Task::run()
 {
-    if (_coro)
+    if (_func)
+    {
+        //stackless task. Runs to completion in a single slice.
+        _isStarted = true;
+        _rc = (*_func)();
+        _func.reset();
+        return (_rc == (int)ITask::RetCode::Running) ? (int)ITask::RetCode::Success : _rc;
+    }
+    if (_coroFactory)
+    {
+        //the stack of a continuation is only allocated once the continuation runs
+        _coro = _coroFactory->create(stackAllocator(_stackSize));
+        _coroFactory.reset();
+    }
+    if (_coro && *_coro)
     {
-        _coro(_rc);
+        _isStarted = true;
+        (*_coro)(_rc);
         return _rc;
     }
     return (int)ITask::RetCode::Success;
@@ -120,12 +261,16 @@ inline
 ITaskContinuation::Ptr Task::getPrevTask() { return _prev.lock(); }
 
 inline
-void Task::setPrevTask(ITaskContinuation::Ptr prevTask) { _prev = prevTask; }
+void Task::setPrevTask(ITaskContinuation::Ptr prevTask)
+{
+    _prev = prevTask;
+    _first = prevTask ? prevTask->getFirstTask() : ITaskContinuation::Ptr(); //O(1) since the previous task knows the head too
+}
 
 inline
 ITaskContinuation::Ptr Task::getFirstTask()
 {
-    return (_type == Type::First) ? shared_from_this() : getPrevTask()->getFirstTask();
+    return (_type == Type::First) ? shared_from_this() : _first.lock();
 }
 
 inline
@@ -151,7 +296,8 @@ ITaskContinuation::Ptr Task::getErrorHandlerOrFinalTask()
 inline
 bool Task::isBlocked() const
 {
-    return _ctx ? _ctx->isBlocked() : false; //context is waiting on some signal
+    //context is waiting on some signal and has not timed out
+    return _ctx ? (_ctx->isBlocked() && !_isTimerExpired) : false;
 }
 
 inline
@@ -160,6 +306,207 @@ bool Task::isHighPriority() const
     return _isHighPriority;
 }
 
+inline
+void Task::setPriority(IQueue::Priority priority)
+{
+    _priority = priority;
+}
+
+inline
+IQueue::Priority Task::getPriority() const
+{
+    return _priority;
+}
+
+inline
+void Task::setDeadline(TimePoint deadline)
+{
+    _deadline = deadline;
+}
+
+inline
+bool Task::hasDeadline() const
+{
+    return _deadline != TimePoint::max();
+}
+
+inline
+Task::TimePoint Task::getDeadline() const
+{
+    return _deadline;
+}
+
+inline
+bool Task::isStealable() const
+{
+    return !_isPinned && !_isStarted &&
+           ((_type == Type::Standalone) || (_type == Type::First));
+}
+
+inline
+bool Task::isMigratable() const
+{
+    return !_isPinned;
+}
+
+inline
+void Task::inheritPinning(const Task& previous)
+{
+    _isPinned = previous._isPinned;
+}
+
+inline
+bool Task::isCancelled() const
+{
+    return _cancellationToken && _cancellationToken->isCancelled();
+}
+
+inline
+void Task::setCancellationToken(CancellationToken::Ptr token)
+{
+    _cancellationToken = std::move(token);
+}
+
+inline
+const CancellationToken::Ptr& Task::getCancellationToken() const
+{
+    return _cancellationToken;
+}
+
+inline
+bool Task::isStarted() const
+{
+    return _isStarted;
+}
+
+inline
+void Task::setPostTime(TimePoint time)
+{
+    _postTime = time;
+}
+
+inline
+Task::TimePoint Task::getPostTime() const
+{
+    return _postTime;
+}
+
+inline
+void Task::setStartTime(TimePoint time)
+{
+    _startTime = time;
+}
+
+inline
+Task::TimePoint Task::getStartTime() const
+{
+    return _startTime;
+}
+
+inline
+void Task::setParkTime(TimePoint time)
+{
+    _parkTime = time;
+}
+
+inline
+Task::TimePoint Task::getParkTime() const
+{
+    return _parkTime;
+}
+
+inline
+void Task::setLabel(const char* label)
+{
+    _label = label;
+}
+
+inline
+const char* Task::getLabel() const
+{
+    return _label;
+}
+
+inline
+Task::QueueHook& Task::getQueueHook()
+{
+    return _queueHook;
+}
+
+inline
+void Task::setLocalStorage(CoroLocalStorage::Ptr storage)
+{
+    _localStorage = std::move(storage);
+}
+
+inline
+const CoroLocalStorage::Ptr& Task::getLocalStorage() const
+{
+    return _localStorage;
+}
+
+inline
+void Task::park()
+{
+    _isParked = true;
+}
+
+inline
+bool Task::tryUnpark()
+{
+    return _isParked.exchange(false);
+}
+
+inline
+void Task::setWakeUpTime(TimePoint time)
+{
+    ++_timerId;
+    _wakeUpTime = time;
+    _hasWakeUpTime = true;
+    _isTimerScheduled = false;
+    _isTimerExpired = false;
+}
+
+inline
+void Task::clearWakeUpTime()
+{
+    ++_timerId; //invalidate any scheduled timer
+    _hasWakeUpTime = false;
+    _isTimerScheduled = false;
+    _isTimerExpired = false;
+}
+
+inline
+bool Task::getUnscheduledTimer(TimePoint& time, size_t& timerId)
+{
+    if (!_hasWakeUpTime || _isTimerScheduled)
+    {
+        return false;
+    }
+    _isTimerScheduled = true;
+    time = _wakeUpTime;
+    timerId = _timerId;
+    return true;
+}
+
+inline
+bool Task::expireTimer(size_t timerId)
+{
+    if ((timerId != _timerId) || !_hasWakeUpTime)
+    {
+        return false; //stale timer. The id is checked first since the task may have migrated.
+    }
+    _isTimerExpired = true;
+    return true;
+}
+
+inline
+void Task::migrateTimer()
+{
+    ++_timerId; //the timer held by the current queue is now stale
+    _isTimerScheduled = false;
+}
+
 inline
 void* Task::operator new(size_t)
 {
@@ -169,17 +516,20 @@ void* Task::operator new(size_t)
 inline
 void Task::operator delete(void* p)
 {
-    Allocator<TaskAllocator>::instance(AllocatorTraits::taskAllocSize()).deallocate(static_cast<Task*>(p));
+    Allocator<TaskAllocator>::instance(AllocatorTraits::taskAllocSize()).deallocate(static_cast<SharedBlock<Task>*>(p));
 }
 
 inline
 void Task::deleter(Task* p)
 {
-#ifndef __QUANTUM_USE_DEFAULT_ALLOCATOR
-    Allocator<TaskAllocator>::instance(AllocatorTraits::taskAllocSize()).dispose(p);
-#else
-    delete p;
-#endif
+    delete p; //destroys and returns the block to the pool
+}
+
+template <class ... ARGS>
+Task::Ptr Task::create(ARGS&&... args)
+{
+    return std::allocate_shared<Task>(SharedAllocator<Task, TaskAllocator, &AllocatorTraits::taskAllocSize>(),
+                                      std::forward<ARGS>(args)...);
 }
 
 }}
@@ -0,0 +1,200 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                class TaskList::iterator
+//==============================================================================================
+inline
+TaskList::iterator::iterator() :
+    _list(nullptr),
+    _task(nullptr)
+{}
+
+inline
+TaskList::iterator::iterator(const TaskList* list, Task* task) :
+    _list(list),
+    _task(task)
+{}
+
+inline
+Task& TaskList::iterator::operator*() const
+{
+    return *_task;
+}
+
+inline
+Task* TaskList::iterator::operator->() const
+{
+    return _task;
+}
+
+inline
+TaskList::iterator& TaskList::iterator::operator++()
+{
+    _task = _task->getQueueHook()._next;
+    return *this;
+}
+
+inline
+TaskList::iterator TaskList::iterator::operator++(int)
+{
+    iterator it = *this;
+    ++(*this);
+    return it;
+}
+
+inline
+TaskList::iterator& TaskList::iterator::operator--()
+{
+    _task = _task ? _task->getQueueHook()._prev : _list->_tail;
+    return *this;
+}
+
+inline
+bool TaskList::iterator::operator==(const iterator& other) const
+{
+    return _task == other._task;
+}
+
+inline
+bool TaskList::iterator::operator!=(const iterator& other) const
+{
+    return _task != other._task;
+}
+
+//==============================================================================================
+//                                      class TaskList
+//==============================================================================================
+inline
+TaskList::TaskList() :
+    _head(nullptr),
+    _tail(nullptr),
+    _size(0)
+{}
+
+inline
+TaskList::iterator TaskList::begin() const
+{
+    return iterator(this, _head);
+}
+
+inline
+TaskList::iterator TaskList::end() const
+{
+    return iterator(this, nullptr);
+}
+
+inline
+TaskList::iterator TaskList::iteratorTo(Task& task) const
+{
+    return iterator(this, &task);
+}
+
+inline
+bool TaskList::empty() const
+{
+    return _size == 0;
+}
+
+inline
+size_t TaskList::size() const
+{
+    return _size;
+}
+
+inline
+TaskList::iterator TaskList::insert(iterator pos, Task& task)
+{
+    Task::QueueHook& hook = task.getQueueHook();
+    hook._next = pos._task;
+    hook._prev = pos._task ? pos._task->getQueueHook()._prev : _tail;
+    if (hook._prev)
+    {
+        hook._prev->getQueueHook()._next = &task;
+    }
+    else
+    {
+        _head = &task;
+    }
+    if (hook._next)
+    {
+        hook._next->getQueueHook()._prev = &task;
+    }
+    else
+    {
+        _tail = &task;
+    }
+    ++_size;
+    return iterator(this, &task);
+}
+
+inline
+TaskList::iterator TaskList::erase(iterator pos)
+{
+    Task::QueueHook& hook = pos._task->getQueueHook();
+    Task* next = hook._next;
+    if (hook._prev)
+    {
+        hook._prev->getQueueHook()._next = next;
+    }
+    else
+    {
+        _head = next;
+    }
+    if (next)
+    {
+        next->getQueueHook()._prev = hook._prev;
+    }
+    else
+    {
+        _tail = hook._prev;
+    }
+    hook._prev = nullptr;
+    hook._next = nullptr;
+    --_size;
+    return iterator(this, next);
+}
+
+inline
+void TaskList::splice(iterator pos, iterator it)
+{
+    if (pos == it)
+    {
+        return;
+    }
+    erase(it);
+    insert(pos, *it);
+}
+
+inline
+void TaskList::clear()
+{
+    while (_head)
+    {
+        erase(begin());
+    }
+}
+
+}}
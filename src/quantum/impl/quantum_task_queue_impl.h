@@ -29,34 +29,123 @@ TaskQueue::TaskQueue() :
 }
 
 inline
-TaskQueue::TaskQueue(const Configuration&) :
-    _queue(Allocator<QueueListAllocator>::instance(AllocatorTraits::queueListAllocSize())),
-    _queueIt(_queue.end()),
+TaskQueue::TaskQueue(const Configuration& config, TaskCounter* taskCounter, bool startThread) :
+    _starvationLimit(config.getPriorityStarvationLimit()),
+    _isResumeSignalledFirst(config.getResumeSignalledCoroutinesFirst()),
+    _isWorkStealingEnabled(config.getCoroutineWorkStealing()),
+    _workStealingPollIntervalMs(config.getCoroutineWorkStealingPollIntervalMs()),
+    _isMigrationEnabled(config.getCoroutineMigration()),
+    _idlePolicy(config.getIdlePolicy()),
+    _idleSpinTimeUs(config.getIdleSpinTimeUs()),
+    _isSliceTimingEnabled(config.getCoroutineSliceStatistics() || (config.getLongSliceThresholdUs().count() > 0)),
+    _isLatencyTimingEnabled(config.getLatencyStatistics()),
+    _isWatchdogEnabled(config.isWatchdogEnabled()),
+    _isProfilingEnabled(config.getSamplingProfilerIntervalUs().count() > 0),
+    _isPerfCountingEnabled(config.getHardwareCounterStatistics()),
+    _isAbandonOnTerminate(config.getTerminatePolicy() == Configuration::TerminatePolicy::Abandon),
+    _longSliceThresholdUs(config.getLongSliceThresholdUs()),
+    _longSliceCallback(config.getLongSliceCallback()),
+    _siblingQueues(nullptr),
+    _numaNode(-1),
+    _taskCounter(taskCounter),
+    _coreId(-1),
+    _highWatermark(config.getQueueHighWatermark()),
+    _lowWatermark(config.getQueueLowWatermark()),
+    _inbox(nullptr),
+    _inboxSize(0),
+    _wakeInbox(nullptr),
+    _migrationInbox(nullptr),
     _isEmpty(true),
-    _isInterrupted(false),
+    _isSleeping(false),
     _isIdle(true),
+    _isSaturated(false),
+    _isStarted(false),
+    _isInterrupted(false),
     _terminated(ATOMIC_FLAG_INIT),
-    _isAdvanced(false)
+    _level(0),
+    _hasCurrent(false),
+    _numBlocked(0),
+    _isNewRound(false),
+    _sliceStartTime(0),
+    _runningLabel(nullptr),
+    _schedulerCounters(nullptr)
 {
-    _thread = std::make_shared<std::thread>(std::bind(&TaskQueue::run, this));
+    if (_workStealingPollIntervalMs.count() <= 0)
+    {
+        _workStealingPollIntervalMs = std::chrono::milliseconds(1);
+    }
+    if (startThread)
+    {
+        start();
+    }
 }
 
 inline
-TaskQueue::TaskQueue(const TaskQueue&) :
-    TaskQueue()
+TaskQueue::TaskQueue(const TaskQueue& other) :
+    _starvationLimit(other._starvationLimit),
+    _isResumeSignalledFirst(other._isResumeSignalledFirst),
+    _isWorkStealingEnabled(other._isWorkStealingEnabled),
+    _workStealingPollIntervalMs(other._workStealingPollIntervalMs),
+    _isMigrationEnabled(other._isMigrationEnabled),
+    _idlePolicy(other._idlePolicy),
+    _idleSpinTimeUs(other._idleSpinTimeUs),
+    _isSliceTimingEnabled(other._isSliceTimingEnabled),
+    _isLatencyTimingEnabled(other._isLatencyTimingEnabled),
+    _isWatchdogEnabled(other._isWatchdogEnabled),
+    _isProfilingEnabled(other._isProfilingEnabled),
+    _isPerfCountingEnabled(other._isPerfCountingEnabled),
+    _isAbandonOnTerminate(other._isAbandonOnTerminate),
+    _longSliceThresholdUs(other._longSliceThresholdUs),
+    _longSliceCallback(other._longSliceCallback),
+    _siblingQueues(nullptr),
+    _numaNode(-1),
+    _taskCounter(other._taskCounter),
+    _coreId(-1),
+    _highWatermark(other._highWatermark),
+    _lowWatermark(other._lowWatermark),
+    _inbox(nullptr),
+    _inboxSize(0),
+    _wakeInbox(nullptr),
+    _migrationInbox(nullptr),
+    _isEmpty(true),
+    _isSleeping(false),
+    _isIdle(true),
+    _isSaturated(false),
+    _isStarted(false),
+    _isInterrupted(false),
+    _terminated(ATOMIC_FLAG_INIT),
+    _level(0),
+    _hasCurrent(false),
+    _numBlocked(0),
+    _isNewRound(false),
+    _sliceStartTime(0),
+    _runningLabel(nullptr),
+    _schedulerCounters(nullptr)
 {
-
+    if (other._isStarted)
+    {
+        start();
+    }
 }
 
 inline
 TaskQueue::~TaskQueue()
 {
     terminate();
+    //Release any late pushes which happened after termination
+    clearInbox(_inbox);
+    clearInbox(_wakeInbox); //only tasks woken after the wait set was released
+    clearInbox(_migrationInbox);
 }
 
 inline
 void TaskQueue::pinToCore(int coreId)
 {
+    _coreId = coreId;
+    if (!_thread)
+    {
+        return; //applied once the thread is started
+    }
 #ifdef _WIN32
     SetThreadAffinityMask(_thread->native_handle(), 1 << coreId);
 #else
@@ -74,100 +163,257 @@ void TaskQueue::pinToCore(int coreId)
 inline
 void TaskQueue::run()
 {
+    if (_isPerfCountingEnabled)
+    {
+        //counters must be opened by the thread being measured
+        _perfCounters.open();
+    }
     while (true)
     {
-        try
+        if (_isEmpty)
+        {
+            waitForWork();
+        }
+        
+        if (_isInterrupted)
+        {
+            break;
+        }
+        
+        runSlice();
+    }
+    
+    if (_isAbandonOnTerminate)
+    {
+        releaseTasks(); //in parallel with the other exiting threads
+    }
+}
+
+inline
+void TaskQueue::start()
+{
+    if (_isStarted)
+    {
+        return;
+    }
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_notEmptyMutex); //serializes with concurrent posters and with interrupt()
+    if (_thread || _isInterrupted)
+    {
+        return;
+    }
+    _thread = std::make_shared<std::thread>(std::bind(&TaskQueue::run, this));
+    if (_coreId != -1)
+    {
+        pinToCore(_coreId);
+    }
+    _isStarted = true;
+}
+
+inline
+bool TaskQueue::isStarted() const
+{
+    return _isStarted;
+}
+
+inline
+bool TaskQueue::isSaturated()
+{
+    if (_highWatermark == 0)
+    {
+        return false;
+    }
+    size_t numTasks = size();
+    if (numTasks >= _highWatermark)
+    {
+        if (!_isSaturated.exchange(true))
+        {
+            _stats.incHighWatermarkCount();
+        }
+        return true;
+    }
+    if (_isSaturated && (numTasks <= _lowWatermark))
+    {
+        _isSaturated = false;
+    }
+    return _isSaturated;
+}
+
+inline
+size_t TaskQueue::runOnce(size_t budget)
+{
+    size_t numSlices = 0;
+    while ((numSlices < budget) && !_isInterrupted)
+    {
+        if (runSlice())
+        {
+            ++numSlices;
+        }
+        else if (_isEmpty)
+        {
+            break; //nothing left to run. Parked tasks are resumed by a later call once signalled.
+        }
+    }
+    return numSlices;
+}
+
+inline
+bool TaskQueue::runSlice()
+{
+    try
+    {
+        //Resume parked tasks whose wait has timed out. This is checked once per round.
+        if (!_timers.empty() && (_isNewRound || _isEmpty))
+        {
+            processTimers();
+        }
+        
+        //Iterate to the next runnable task
+        if (!advance())
+        {
+            return false;
+        }
+        
+        //Process current task. It stays alive in the run list until dequeue() removes it.
+        Task& current = *_runLists[_level]._it;
+        if (current.isCancelled() && !current.isStarted())
         {
-            if (_isEmpty)
+            //Discard the task along with its continuations. Running tasks are expected to
+            //poll their context and exit on their own.
+            for (ITaskContinuation::Ptr nextTask = current.getNextTask(); nextTask; nextTask = nextTask->getNextTask())
             {
-                std::unique_lock<std::mutex> lock(_notEmptyMutex);
-                //========================= BLOCK WHEN EMPTY =========================
-                //Wait for the queue to have at least one element
-                _notEmptyCond.wait(lock, [this]()->bool { return !_isEmpty || _isInterrupted; });
+                nextTask->terminate();
             }
-            
-            if (_isInterrupted)
+            _stats.incCancelledCount();
+            current.terminate();
+            dequeue(_isIdle);
+            return true;
+        }
+        if (current.isBlocked())
+        {
+            park(); //move out of the run list until signalled
+            return false;
+        }
+        
+        std::chrono::steady_clock::time_point sliceStart;
+        if (_isSliceTimingEnabled || _isWatchdogEnabled)
+        {
+            sliceStart = std::chrono::steady_clock::now();
+            if (_isWatchdogEnabled)
             {
-                break;
+                _sliceStartTime.store(sliceStart.time_since_epoch().count(), std::memory_order_relaxed);
             }
-            
-            //Iterate to the next runnable task
-            if (advance() == _queue.end())
+        }
+        if (_isLatencyTimingEnabled && !current.isStarted())
+        {
+            recordStart(current);
+        }
+        
+        if (_isProfilingEnabled)
+        {
+            _runningLabel.store(current.getLabel(), std::memory_order_relaxed);
+        }
+        
+        //========================= START/RESUME COROUTINE =========================
+        Tracer::record(current.isStarted() ? Tracer::EventType::Resume : Tracer::EventType::FirstRun,
+                       current.getQueueId(), &current);
+        int rc = current.run();
+        Tracer::record((rc != (int)ITask::RetCode::Running) ? Tracer::EventType::Complete :
+                       (current.isBlocked() ? Tracer::EventType::Block : Tracer::EventType::Yield),
+                       current.getQueueId(), &current);
+        //=========================== END/YIELD COROUTINE ==========================
+        count(&SchedulerCounters::_numSlices);
+        count((rc != (int)ITask::RetCode::Running) ? &SchedulerCounters::_numCompletions :
+              (current.isBlocked() ? &SchedulerCounters::_numBlocks : &SchedulerCounters::_numYields));
+        
+        if (_isProfilingEnabled)
+        {
+            _runningLabel.store(nullptr, std::memory_order_relaxed);
+        }
+        if (_isWatchdogEnabled)
+        {
+            _sliceStartTime.store(0, std::memory_order_relaxed);
+        }
+        if (_isSliceTimingEnabled)
+        {
+            recordSlice(std::chrono::steady_clock::now() - sliceStart, current.getQueueId());
+        }
+        
+        if ((rc == (int)ITask::RetCode::Running) && current.isBlocked())
+        {
+            park(); //coroutine is waiting on a signal
+        }
+        else if (rc != (int)ITask::RetCode::Running) //Coroutine ended
+        {
+            if (_isLatencyTimingEnabled)
             {
-                continue;
+                recordCompletion(current);
             }
-            
-            //Process current task
-            ITaskContinuation::Ptr task = *_queueIt;
-            if (task->isBlocked())
+            ITaskContinuation::Ptr nextTask;
+            if (rc == (int)ITask::RetCode::Success)
             {
-                continue;
+                //Coroutine ended normally with "return 0" statement
+                _stats.incCompletedCount();
+                
+                //check if there's another task scheduled to run after this one
+                nextTask = current.getNextTask();
+                if (nextTask && (nextTask->getType() == ITask::Type::ErrorHandler))
+                {
+                    //skip error handler since we don't have any errors
+                    nextTask->terminate(); //invalidate the error handler
+                    nextTask = nextTask->getNextTask();
+                }
             }
-            
-            //========================= START/RESUME COROUTINE =========================
-            int rc = task->run();
-            //=========================== END/YIELD COROUTINE ==========================
-            
-            if (rc != (int)ITask::RetCode::Running) //Coroutine ended
+            else
             {
-                ITaskContinuation::Ptr nextTask;
-                if (rc == (int)ITask::RetCode::Success)
+                //Coroutine ended with explicit user error
+                _stats.incErrorCount();
+                
+#ifdef __QUANTUM_PRINT_DEBUG
+                std::lock_guard<std::mutex> guard(Util::LogMutex());
+                if (rc == (int)ITask::RetCode::Exception)
                 {
-                    //Coroutine ended normally with "return 0" statement
-                    _stats.incCompletedCount();
-                    
-                    //check if there's another task scheduled to run after this one
-                    nextTask = task->getNextTask();
-                    if (nextTask && (nextTask->getType() == ITask::Type::ErrorHandler))
-                    {
-                        //skip error handler since we don't have any errors
-                        nextTask->terminate(); //invalidate the error handler
-                        nextTask = nextTask->getNextTask();
-                    }
+                    std::cerr << "Coroutine exited with user exception." << std::endl;
                 }
                 else
                 {
-                    //Coroutine ended with explicit user error
-                    _stats.incErrorCount();
-                    
-#ifdef __QUANTUM_PRINT_DEBUG
-                    std::lock_guard<std::mutex> guard(Util::LogMutex());
-                    if (rc == (int)ITask::RetCode::Exception)
-                    {
-                        std::cerr << "Coroutine exited with user exception." << std::endl;
-                    }
-                    else
-                    {
-                        std::cerr << "Coroutine exited with error : " << rc << std::endl;
-                    }
-#endif
-                    //Check if we have a final task to run
-                    nextTask = task->getErrorHandlerOrFinalTask();
+                    std::cerr << "Coroutine exited with error : " << rc << std::endl;
                 }
-                
-                //queue next task and de-queue current one
-                enqueue(nextTask);
-                dequeue(_isIdle);
+#endif
+                //Check if we have a final task to run
+                nextTask = current.getErrorHandlerOrFinalTask();
+            }
+            
+            //queue next task and de-queue current one
+            if (nextTask && (nextTask->getQueueId() == (int)IQueue::QueueId::Any))
+            {
+                //the continuation runs on this queue so it must be woken up here if it blocks
+                nextTask->setQueueId(current.getQueueId());
+                std::static_pointer_cast<Task>(nextTask)->inheritPinning(current);
             }
+            enqueue(std::move(nextTask));
+            dequeue(_isIdle); //destroys the task ahead of it being accounted for
         }
-        catch (std::exception& ex)
-        {
-            UNUSED(ex);
-            dequeue(_isIdle); //remove error task
+        return true;
+    }
+    catch (std::exception& ex)
+    {
+        UNUSED(ex);
+        dequeue(_isIdle); //remove error task
 #ifdef __QUANTUM_PRINT_DEBUG
-            std::lock_guard<std::mutex> guard(Util::LogMutex());
-            std::cerr << "Caught exception: " << ex.what() << std::endl;
+        std::lock_guard<std::mutex> guard(Util::LogMutex());
+        std::cerr << "Caught exception: " << ex.what() << std::endl;
 #endif
-        }
-        catch (...)
-        {
-            dequeue(_isIdle); //remove error task
+    }
+    catch (...)
+    {
+        dequeue(_isIdle); //remove error task
 #ifdef __QUANTUM_PRINT_DEBUG
-            std::lock_guard<std::mutex> guard(Util::LogMutex());
-            std::cerr << "Caught unknown exception." << std::endl;
+        std::lock_guard<std::mutex> guard(Util::LogMutex());
+        std::cerr << "Caught unknown exception." << std::endl;
 #endif
-        }
-    } //while(true)
+    }
+    return true;
 }
 
 inline
@@ -177,171 +423,1022 @@ void TaskQueue::enqueue(ITask::Ptr task)
     {
         return; //nothing to do
     }
-    //========================= LOCKED SCOPE =========================
-    SpinLock::Guard lock(_spinlock);
-    doEnqueue(task);
-}
-
-inline
-bool TaskQueue::tryEnqueue(ITask::Ptr task)
-{
-    if (!task)
+    if (_isLatencyTimingEnabled)
     {
-        return false; //nothing to do
+        std::static_pointer_cast<Task>(task)->setPostTime(std::chrono::steady_clock::now());
     }
-    //========================= LOCKED SCOPE =========================
-    SpinLock::Guard lock(_spinlock, SpinLock::TryToLock{});
-    if (lock.ownsLock())
+    Tracer::record(Tracer::EventType::Post, task->getQueueId(), static_cast<Task*>(task.get()));
+    if (_taskCounter)
     {
-        doEnqueue(task);
+        _taskCounter->increment();
     }
-    return lock.ownsLock();
+    //Push onto the inbox without contending with the running thread which will
+    //drain it into the run list on its next iteration.
+    ++_inboxSize;
+    Task& posted = static_cast<Task&>(*task);
+    hold(std::static_pointer_cast<Task>(std::move(task)));
+    pushInbox(_inbox, posted);
+    //Wake up the thread if it's parked. Should it park concurrently, it will find the
+    //inbox non-empty when evaluating the wait condition.
+    notifyIfSleeping();
 }
 
 inline
-void TaskQueue::doEnqueue(ITask::Ptr task)
+void TaskQueue::enqueueBatch(const std::vector<Task::Ptr>& tasks)
 {
-    //NOTE: _queueIt remains unchanged following this operation
-    if (_queue.empty() || !task->isHighPriority())
+    if (tasks.empty())
     {
-        //insert before the current position. If _queueIt == begin(), then the new
-        //task will be at the head of the queue.
-        _queue.insert(_queueIt, std::static_pointer_cast<Task>(task));
+        return; //nothing to do
     }
-    else
+    std::chrono::steady_clock::time_point now;
+    if (_isLatencyTimingEnabled)
     {
-        //insert after the current position. If next(_queueIt) == end()
-        //then the new task will be the last element in the queue
-        _queue.insert(std::next(_queueIt), std::static_pointer_cast<Task>(task));
+        now = std::chrono::steady_clock::now();
     }
-    if (task->isHighPriority())
+    //Link the tasks in reverse order since the inbox is LIFO
+    Task* head = nullptr;
+    Task* tail = nullptr;
+    for (auto&& task : tasks)
     {
-        _stats.incHighPriorityCount();
+        if (_isLatencyTimingEnabled)
+        {
+            task->setPostTime(now);
+        }
+        Tracer::record(Tracer::EventType::Post, task->getQueueId(), task.get());
+        Task* node = task.get();
+        hold(task);
+        node->getQueueHook()._inboxNext = head;
+        head = node;
+        if (!tail)
+        {
+            tail = head;
+        }
     }
-    _stats.incPostedCount();
-    _stats.incNumElements();
-    signalEmptyCondition(false);
+    _inboxSize += tasks.size();
+    if (_taskCounter)
+    {
+        _taskCounter->increment(tasks.size());
+    }
+    Task*& tailNext = tail->getQueueHook()._inboxNext;
+    tailNext = _inbox.load(std::memory_order_relaxed);
+    while (!_inbox.compare_exchange_weak(tailNext, head))
+    {
+        //tailNext was refreshed with the current head
+    }
+    notifyIfSleeping();
 }
 
 inline
-ITask::Ptr TaskQueue::dequeue(std::atomic_bool& hint)
+bool TaskQueue::tryEnqueue(ITask::Ptr task)
 {
-    //========================= LOCKED SCOPE =========================
-    SpinLock::Guard lock(_spinlock);
-    return doDequeue(hint);
+    if (!task)
+    {
+        return false; //nothing to do
+    }
+    enqueue(task); //never blocks
+    return true;
 }
 
 inline
-ITask::Ptr TaskQueue::tryDequeue(std::atomic_bool& hint)
+void TaskQueue::pushInbox(std::atomic<Task*>& inbox, Task& task)
 {
-    //========================= LOCKED SCOPE =========================
-    SpinLock::Guard lock(_spinlock, SpinLock::TryToLock{});
-    if (lock.ownsLock())
+    Task*& next = task.getQueueHook()._inboxNext; //embedded in the task, no allocation
+    next = inbox.load(std::memory_order_relaxed);
+    while (!inbox.compare_exchange_weak(next, &task))
     {
-        return doDequeue(hint);
+        //next was refreshed with the current head
     }
-    return nullptr;
 }
 
 inline
-ITask::Ptr TaskQueue::doDequeue(std::atomic_bool& hint)
+Task* TaskQueue::popInbox(std::atomic<Task*>& inbox)
 {
-    hint = (_queueIt == _queue.end());
-    if (!hint)
+    Task* head = inbox.exchange(nullptr);
+    //Restore posting order since the inbox is LIFO
+    Task* ordered = nullptr;
+    while (head)
     {
-        (*_queueIt)->terminate();
-        //Remove error task from the queue
-        _queueIt = _queue.erase(_queueIt);
-        _stats.decNumElements();
-        _isAdvanced = true; //_queueIt now points to the next element in the list or to _queue.end()
+        Task* next = head->getQueueHook()._inboxNext;
+        head->getQueueHook()._inboxNext = ordered;
+        ordered = head;
+        head = next;
     }
-    return nullptr; //not used!
+    return ordered;
 }
 
 inline
-size_t TaskQueue::size() const
+void TaskQueue::clearInbox(std::atomic<Task*>& inbox)
 {
-#if (__cplusplus >= 201703L)
-    return _queue.size();
-#else
-    //Avoid linear time implementation
-    return _stats.numElements();
-#endif
+    Task* node = inbox.exchange(nullptr);
+    while (node)
+    {
+        Task* next = node->getQueueHook()._inboxNext;
+        release(*node)->terminate();
+        node = next;
+    }
 }
 
 inline
-bool TaskQueue::empty() const
+void TaskQueue::hold(Task::Ptr task)
 {
-    return _queue.empty();
+    Task& owned = *task;
+    owned.getQueueHook()._owner = std::move(task);
 }
 
 inline
-void TaskQueue::terminate()
+Task::Ptr TaskQueue::release(Task& task)
 {
-    if (!_terminated.test_and_set())
+    return std::move(task.getQueueHook()._owner);
+}
+
+inline
+void TaskQueue::drainInbox()
+{
+    //NOTE: must be called while holding the spinlock
+    Task* ordered = popInbox(_inbox);
+    if (!ordered)
     {
-        _isInterrupted = true;
-        _notEmptyCond.notify_all();
-        _thread->join();
-        
-        //clear the queue
-        while (!_queue.empty())
+        return;
+    }
+    size_t load = 0;
+    size_t targetLoad = 0;
+    TaskQueue* target = selectMigrationTarget(load, targetLoad);
+    size_t numTasks = 0;
+    while (ordered)
+    {
+        Task* next = ordered->getQueueHook()._inboxNext;
+        if (target && (load >= targetLoad + 2) && ordered->isMigratable())
+        {
+            //Hand the task over before it starts. It was still posted here.
+            if (ordered->isHighPriority())
+            {
+                _stats.incHighPriorityCount();
+            }
+            _stats.incPostedCount();
+            migrate(*ordered, *target);
+            --load;
+            ++targetLoad;
+        }
+        else
         {
-            _queue.front()->terminate();
-            _queue.pop_front();
+            doEnqueue(*ordered);
         }
+        ordered = next;
+        ++numTasks;
     }
+    _inboxSize -= numTasks;
+    _isEmpty = false;
 }
 
 inline
-IQueueStatistics& TaskQueue::stats()
+void TaskQueue::drainWakeInbox()
 {
-    return _stats;
+    //NOTE: must be called while holding the spinlock
+    Task* ordered = popInbox(_wakeInbox);
+    if (!ordered)
+    {
+        return;
+    }
+    std::array<bool, numPriorityLevels> isInserted{}; //a signalled task was placed ahead on this level
+    std::array<TaskListIter, numPriorityLevels> nextTasks; //the task which was due to run next on each level
+    size_t load = 0;
+    size_t targetLoad = 0;
+    TaskQueue* target = selectMigrationTarget(load, targetLoad);
+    while (ordered)
+    {
+        Task* next = ordered->getQueueHook()._inboxNext;
+        Task& task = *ordered;
+        if (target && (load >= targetLoad + 2) && task.isMigratable())
+        {
+            //Resume the task on the less loaded sibling instead
+            _waitSet.erase(_waitSet.iteratorTo(task));
+            _numBlocked.fetch_sub(1, std::memory_order_relaxed);
+            _stats.decNumElements();
+            task.migrateTimer();
+            migrate(task, *target);
+            --load;
+            ++targetLoad;
+            ordered = next;
+            continue; //the task is now linked into the sibling's inbox
+        }
+        if (_isResumeSignalledFirst)
+        {
+            //Insert in signal order ahead of the task due to run next. The current task has already been moved past.
+            size_t level = (size_t)task.getPriority();
+            RunList& list = _runLists[level];
+            _waitSet.erase(_waitSet.iteratorTo(task));
+            if (!isInserted[level])
+            {
+                nextTasks[level] = list._it;
+                list._it = list._tasks.insert(list._it, task); //runs next
+                isInserted[level] = true;
+            }
+            else
+            {
+                list._tasks.insert(nextTasks[level], task);
+            }
+            _numBlocked.fetch_sub(1, std::memory_order_relaxed);
+            count(&SchedulerCounters::_numWakeUps);
+        }
+        else
+        {
+            doUnpark(task);
+        }
+        ordered = next;
+    }
+    _isEmpty = false;
 }
 
 inline
-SpinLock& TaskQueue::getLock()
+void TaskQueue::drainMigrationInbox()
 {
-    return _spinlock;
+    //NOTE: must be called while holding the spinlock
+    Task* ordered = popInbox(_migrationInbox);
+    if (!ordered)
+    {
+        return;
+    }
+    size_t numTasks = 0;
+    while (ordered)
+    {
+        Task* next = ordered->getQueueHook()._inboxNext;
+        insertTask(*ordered);
+        _stats.incMigratedCount();
+        _stats.incNumElements();
+        ordered = next;
+        ++numTasks;
+    }
+    _inboxSize -= numTasks;
+    _isEmpty = false;
 }
 
 inline
-void TaskQueue::signalEmptyCondition(bool value)
+bool TaskQueue::isInboxEmpty() const
+{
+    return (_inbox.load() == nullptr) && (_wakeInbox.load() == nullptr) && (_migrationInbox.load() == nullptr);
+}
+
+inline
+void TaskQueue::park()
 {
+    Task* task;
+    Task::TimePoint parkTime;
+    if (_isWatchdogEnabled)
+    {
+        parkTime = std::chrono::steady_clock::now();
+    }
     {
         //========================= LOCKED SCOPE =========================
-        std::lock_guard<std::mutex> lock(_notEmptyMutex);
-        _isEmpty = value;
+        SpinLock::Guard lock(_spinlock);
+        RunList& list = _runLists[_level];
+        task = &*list._it;
+        task->setParkTime(parkTime);
+        list._it = list._tasks.erase(list._it);
+        _hasCurrent = false; //the iterator now points to the next element in the list or to end()
+        _waitSet.insert(_waitSet.end(), *task);
+        task->park();
+        _numBlocked.fetch_add(1, std::memory_order_relaxed);
     }
-    if (!value)
+    //Only this thread removes tasks from the wait set so the task is still alive
+    Task::TimePoint time;
+    size_t timerId;
+    if (task->getUnscheduledTimer(time, timerId))
     {
-        _notEmptyCond.notify_all();
+        _timers.push(Timer{time, task->getQueueHook()._owner, timerId});
+    }
+    //The signal may have been set before the task was marked as parked in which
+    //case the waker did not see it and we must put it back ourselves.
+    if (!task->isBlocked() && task->tryUnpark())
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        doUnpark(*task);
     }
 }
 
 inline
-TaskQueue::TaskListIter TaskQueue::advance()
+void TaskQueue::unpark(Task& task)
+{
+    pushInbox(_wakeInbox, task);
+    notifyIfSleeping();
+}
+
+inline
+void TaskQueue::adopt(Task& task)
+{
+    ++_inboxSize;
+    pushInbox(_migrationInbox, task);
+    notifyIfSleeping();
+}
+
+inline
+bool TaskQueue::scheduleNext(const Task::Ptr& task)
 {
     //========================= LOCKED SCOPE =========================
     SpinLock::Guard lock(_spinlock);
-    //Iterate to the next element
-    if ((_queueIt == _queue.end()) || (!_isAdvanced && (++_queueIt == _queue.end())))
+    drainInbox(); //the task may have just been posted
+    RunList& list = _runLists[(size_t)task->getPriority()];
+    bool isCurrentList = _hasCurrent && (&list == &_runLists[_level]);
+    TaskListIter next = list._it;
+    if (isCurrentList)
     {
-        _queueIt = _queue.begin();
+        ++next; //the running task is moved past when it yields
     }
-    _isAdvanced = false; //reset flag
-    if (_queueIt == _queue.end())
+    for (TaskListIter it = list._tasks.begin(); it != list._tasks.end(); ++it)
     {
-        signalEmptyCondition(true);
+        if (&*it != task.get())
+        {
+            continue;
+        }
+        if (isCurrentList && (it == list._it))
+        {
+            return false; //the caller itself
+        }
+        if (it != next)
+        {
+            list._tasks.splice(next, it); //iterators remain valid
+        }
+        if (!isCurrentList)
+        {
+            list._it = it;
+        }
+        return true;
     }
-    return _queueIt;
+    return false;
 }
 
 inline
-bool TaskQueue::isIdle() const
+bool TaskQueue::spinForWork()
 {
-    return _isIdle;
-}
-
-}}
-
+    auto start = std::chrono::steady_clock::now();
+    while (true)
+    {
+        if (hasWork() || (_isWorkStealingEnabled && trySteal()))
+        {
+            return true;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (!_timers.empty() && (_timers.top()._time <= now))
+        {
+            return true; //timers must be processed
+        }
+        if ((_idlePolicy == Configuration::IdlePolicy::SpinThenPark) && ((now - start) >= _idleSpinTimeUs))
+        {
+            return false; //park
+        }
+        std::this_thread::yield();
+    }
+}
+
+inline
+void TaskQueue::waitForWork()
+{
+    if (_isWorkStealingEnabled && isInboxEmpty() && trySteal()) //own tasks come first
+    {
+        return;
+    }
+    if ((_idlePolicy != Configuration::IdlePolicy::Park) && spinForWork())
+    {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(_notEmptyMutex);
+    auto hasWork = [this]()->bool { return this->hasWork(); };
+    _isSleeping = true; //producers will notify from now on
+    //========================= BLOCK WHEN EMPTY =========================
+    if (!_timers.empty() || _isWorkStealingEnabled)
+    {
+        //Wait for the queue to have at least one element, for the next timer to expire
+        //or until it's time to poll the siblings again
+        Task::TimePoint deadline = _timers.empty() ? Task::TimePoint::max() : _timers.top()._time;
+        if (_isWorkStealingEnabled)
+        {
+            deadline = std::min(deadline, std::chrono::steady_clock::now() + _workStealingPollIntervalMs);
+        }
+        _notEmptyCond.wait_until(lock, deadline, hasWork);
+    }
+    else
+    {
+        //Wait for the queue to have at least one element
+        _notEmptyCond.wait(lock, hasWork);
+    }
+    _isSleeping = false;
+}
+
+inline
+void TaskQueue::processTimers()
+{
+    _isNewRound = false;
+    Task::TimePoint now = Clock::now(); //virtual when simulated
+    while (!_timers.empty() && (_timers.top()._time <= now))
+    {
+        Task::Ptr task = _timers.top()._task.lock();
+        size_t timerId = _timers.top()._timerId;
+        _timers.pop();
+        if (task && task->expireTimer(timerId) && task->tryUnpark())
+        {
+            count(&SchedulerCounters::_numTimerExpirations);
+            //========================= LOCKED SCOPE =========================
+            SpinLock::Guard lock(_spinlock);
+            doUnpark(*task);
+            _isEmpty = false;
+        }
+    }
+}
+
+inline
+void TaskQueue::doUnpark(Task& task)
+{
+    //NOTE: must be called while holding the spinlock
+    count(&SchedulerCounters::_numWakeUps);
+    _waitSet.erase(_waitSet.iteratorTo(task));
+    insertTask(task);
+    _numBlocked.fetch_sub(1, std::memory_order_relaxed);
+}
+
+inline
+void TaskQueue::insertTask(Task& task)
+{
+    //NOTE: must be called while holding the spinlock
+    RunList& list = _runLists[(size_t)task.getPriority()];
+    if (task.hasDeadline())
+    {
+        //Run ahead of any task in this round which has no deadline or a later one.
+        //The running task, if it belongs to this list, is left in place.
+        bool isCurrent = _hasCurrent && (&list == &_runLists[_level]);
+        TaskListIter it = list._it;
+        size_t num = list._tasks.size();
+        if (isCurrent)
+        {
+            ++it;
+            --num;
+        }
+        for (; num > 0; --num, ++it)
+        {
+            if (it == list._tasks.end())
+            {
+                it = list._tasks.begin(); //wrap around
+            }
+            if (!it->hasDeadline() || (task.getDeadline() < it->getDeadline()))
+            {
+                TaskListIter pos = list._tasks.insert(it, task);
+                if (it == list._it)
+                {
+                    list._it = pos; //the new task runs next
+                }
+                return;
+            }
+        }
+    }
+    //Insert before the next task to run, i.e. at the end of the current round.
+    //If the list iterator points to end() the task is appended.
+    list._tasks.insert(list._it, task);
+}
+
+inline
+void TaskQueue::doEnqueue(Task& task)
+{
+    insertTask(task);
+    if (task.isHighPriority())
+    {
+        _stats.incHighPriorityCount();
+    }
+    _stats.incPostedCount();
+    _stats.incNumElements();
+}
+
+inline
+ITask::Ptr TaskQueue::dequeue(std::atomic_bool& hint)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    return doDequeue(hint);
+}
+
+inline
+ITask::Ptr TaskQueue::tryDequeue(std::atomic_bool& hint)
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock, SpinLock::TryToLock{});
+    if (lock.ownsLock())
+    {
+        return doDequeue(hint);
+    }
+    return nullptr;
+}
+
+inline
+ITask::Ptr TaskQueue::doDequeue(std::atomic_bool& hint)
+{
+    hint = !_hasCurrent;
+    if (!hint)
+    {
+        RunList& list = _runLists[_level];
+        Task& task = *list._it;
+        task.terminate();
+        //Remove error task from the queue
+        list._it = list._tasks.erase(list._it);
+        release(task); //destroys the task unless it is referenced elsewhere
+        _stats.decNumElements();
+        _hasCurrent = false; //the iterator now points to the next element in the list or to end()
+        if (_taskCounter)
+        {
+            _taskCounter->decrement(); //any continuation has been enqueued already
+        }
+        notifyIfDrained();
+    }
+    return nullptr; //not used!
+}
+
+inline
+void TaskQueue::notifyIfDrained()
+{
+    if (_highWatermark == 0)
+    {
+        return;
+    }
+    //Pairs with the fence of TaskCounter::waitForAdmission() so that either the poster sees the drained
+    //queue or this thread sees the saturated flag
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_isSaturated && (size() <= _lowWatermark) && _isSaturated.exchange(false) && _taskCounter)
+    {
+        _taskCounter->notifyAdmission();
+    }
+}
+
+inline
+size_t TaskQueue::size() const
+{
+#if (__cplusplus >= 201703L)
+    size_t numTasks = _waitSet.size() + _inboxSize;
+    for (auto&& list : _runLists)
+    {
+        numTasks += list._tasks.size();
+    }
+    return numTasks;
+#else
+    //Avoid linear time implementation
+    return _stats.numElements() + _inboxSize;
+#endif
+}
+
+inline
+bool TaskQueue::empty() const
+{
+    for (auto&& list : _runLists)
+    {
+        if (!list._tasks.empty())
+        {
+            return false;
+        }
+    }
+    return _waitSet.empty() && isInboxEmpty();
+}
+
+inline
+void TaskQueue::terminate()
+{
+    if (!_terminated.test_and_set())
+    {
+        interrupt();
+        if (_thread)
+        {
+            _thread->join();
+        }
+        
+        //clear the queue. Empty already if the thread has abandoned its tasks.
+        releaseTasks();
+    }
+}
+
+inline
+void TaskQueue::interrupt()
+{
+    {
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_notEmptyMutex);
+        _isInterrupted = true;
+    }
+    _notEmptyCond.notify_all();
+}
+
+inline
+void TaskQueue::releaseTasks()
+{
+    std::vector<Task::Ptr> tasks;
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock); //siblings may still be trying to steal
+        drainMigrationInbox();
+        drainInbox();
+        drainWakeInbox(); //never migrates once interrupted
+        for (auto&& list : _runLists)
+        {
+            while (!list._tasks.empty())
+            {
+                Task& task = *list._tasks.begin();
+                list._tasks.erase(list._tasks.begin());
+                tasks.push_back(release(task));
+            }
+            list._it = list._tasks.end();
+        }
+        _hasCurrent = false;
+        while (!_waitSet.empty())
+        {
+            Task& task = *_waitSet.begin();
+            _waitSet.erase(_waitSet.begin());
+            if (task.tryUnpark())
+            {
+                tasks.push_back(release(task));
+            }
+            //else a waker is about to push the task onto the wake-up inbox which then holds it until cleared
+        }
+        _numBlocked = 0;
+    }
+    //Terminating a task breaks its promise which may wake up coroutines on other queues,
+    //so this is done outside of the lock.
+    for (auto&& task : tasks)
+    {
+        task->terminate();
+    }
+    tasks.clear();
+}
+
+inline
+Task::TimePoint TaskQueue::getSliceStartTime() const
+{
+    return Task::TimePoint(Task::TimePoint::duration(_sliceStartTime.load(std::memory_order_relaxed)));
+}
+
+inline
+const char* TaskQueue::getRunningLabel() const
+{
+    return _runningLabel.load(std::memory_order_relaxed);
+}
+
+inline
+size_t TaskQueue::getNumBlocked() const
+{
+    return _numBlocked.load(std::memory_order_relaxed);
+}
+
+inline
+void TaskQueue::getBlockedTasks(Task::TimePoint from,
+                                Task::TimePoint to,
+                                std::vector<std::pair<const Task*, Task::TimePoint>>& blocked) const
+{
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    for (auto&& task : _waitSet)
+    {
+        Task::TimePoint parkTime = task.getParkTime();
+        if ((parkTime > from) && (parkTime <= to))
+        {
+            blocked.emplace_back(&task, parkTime);
+        }
+    }
+}
+
+inline
+void TaskQueue::setSchedulerCounters(SchedulerCounters* counters)
+{
+    _schedulerCounters.store(counters, std::memory_order_release);
+}
+
+inline
+bool TaskQueue::getNextTimerTime(Task::TimePoint& time) const
+{
+    if (_timers.empty())
+    {
+        return false;
+    }
+    time = _timers.top()._time; //may belong to a task which has been signalled since
+    return true;
+}
+
+inline
+void TaskQueue::count(std::atomic<size_t> SchedulerCounters::* counter)
+{
+    SchedulerCounters* counters = _schedulerCounters.load(std::memory_order_acquire);
+    if (counters)
+    {
+        (counters->*counter).fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+inline
+IQueueStatistics& TaskQueue::stats()
+{
+    if (_perfCounters.isOpen())
+    {
+        _stats.updatePerfCounts(_perfCounters);
+    }
+    return _stats;
+}
+
+inline
+SpinLock& TaskQueue::getLock()
+{
+    return _spinlock;
+}
+
+inline
+void TaskQueue::signalEmptyCondition(bool value)
+{
+    _isEmpty = value;
+    if (!value)
+    {
+        notifyIfSleeping();
+    }
+}
+
+inline
+void TaskQueue::notifyIfSleeping()
+{
+    if (_isSleeping)
+    {
+        {
+            //========================= LOCKED SCOPE =========================
+            //Ensures the thread is either inside wait() or has yet to evaluate its wait condition
+            std::lock_guard<std::mutex> lock(_notEmptyMutex);
+        }
+        _notEmptyCond.notify_all();
+    }
+}
+
+inline
+bool TaskQueue::hasWork() const
+{
+    return !_isEmpty || _isInterrupted || !isInboxEmpty();
+}
+
+inline
+bool TaskQueue::advance()
+{
+    count(&SchedulerCounters::_numScans);
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock);
+    //Move past the task which ran last so that all list iterators point to their next task
+    if (_hasCurrent)
+    {
+        ++_runLists[_level]._it;
+        _hasCurrent = false;
+    }
+    //Move newly posted and signalled tasks into the run lists
+    if (!isInboxEmpty())
+    {
+        drainWakeInbox();
+        drainMigrationInbox();
+        drainInbox();
+    }
+    size_t level = selectLevel();
+    if (level == numPriorityLevels)
+    {
+        _isEmpty = true; //only the running thread waits on this flag
+        return false;
+    }
+    RunList& list = _runLists[level];
+    if (list._it == list._tasks.end())
+    {
+        list._it = list._tasks.begin();
+        _isNewRound = true;
+    }
+    _level = level;
+    _hasCurrent = true;
+    return true;
+}
+
+inline
+size_t TaskQueue::selectLevel()
+{
+    //NOTE: must be called while holding the spinlock
+    //Serve the highest non-empty level unless a lower one has been skipped for too long
+    size_t highest = numPriorityLevels;
+    size_t starved = numPriorityLevels;
+    for (size_t level = 0; level < numPriorityLevels; ++level)
+    {
+        RunList& list = _runLists[level];
+        if (list._tasks.empty())
+        {
+            list._numSkipped = 0;
+        }
+        else if (highest == numPriorityLevels)
+        {
+            highest = level;
+        }
+        else if ((starved == numPriorityLevels) && (_starvationLimit > 0) && (list._numSkipped >= _starvationLimit))
+        {
+            starved = level;
+        }
+    }
+    size_t selected = (starved != numPriorityLevels) ? starved : highest;
+    for (size_t level = highest; level < numPriorityLevels; ++level)
+    {
+        RunList& list = _runLists[level];
+        if (!list._tasks.empty())
+        {
+            list._numSkipped = (level == selected) ? 0 : list._numSkipped + 1;
+        }
+    }
+    return selected;
+}
+
+inline
+bool TaskQueue::isIdle() const
+{
+    return _isIdle;
+}
+
+inline
+void TaskQueue::setSiblingQueues(std::vector<TaskQueue>* queues)
+{
+    _siblingQueues = queues;
+}
+
+inline
+void TaskQueue::setNumaNode(int node)
+{
+    _numaNode = node;
+}
+
+inline
+int TaskQueue::getNumaNode() const
+{
+    return _numaNode;
+}
+
+inline
+bool TaskQueue::trySteal()
+{
+    std::vector<TaskQueue>* queues = _siblingQueues;
+    if (!queues)
+    {
+        return false;
+    }
+    //Find the busiest sibling. The task currently running on a queue cannot be stolen
+    //so only queues holding at least two tasks are considered. Siblings on the same
+    //NUMA node are preferred over remote ones.
+    TaskQueue* victim = nullptr;
+    TaskQueue* localVictim = nullptr;
+    size_t numTasks = 1;
+    size_t numLocalTasks = 1;
+    for (auto&& queue : *queues)
+    {
+        if (&queue == this)
+        {
+            continue;
+        }
+        size_t queueSize = queue.size();
+        if (queueSize > numTasks)
+        {
+            numTasks = queueSize;
+            victim = &queue;
+        }
+        if ((_numaNode != -1) && (queue._numaNode == _numaNode) && (queueSize > numLocalTasks))
+        {
+            numLocalTasks = queueSize;
+            localVictim = &queue;
+        }
+    }
+    if (localVictim)
+    {
+        victim = localVictim;
+    }
+    if (!victim)
+    {
+        return false;
+    }
+    Task* task = victim->releaseStealableTask();
+    if (!task)
+    {
+        return false;
+    }
+    task->setQueueId(static_cast<int>(this - queues->data()));
+    {
+        //========================= LOCKED SCOPE =========================
+        SpinLock::Guard lock(_spinlock);
+        insertTask(*task);
+        _stats.incStolenCount();
+        _stats.incNumElements();
+        _isEmpty = false;
+    }
+    return true;
+}
+
+inline
+Task* TaskQueue::releaseStealableTask()
+{
+    if (!_isStarted)
+    {
+        return nullptr; //a manual queue must run its tasks on the thread driving it
+    }
+    //========================= LOCKED SCOPE =========================
+    SpinLock::Guard lock(_spinlock, SpinLock::TryToLock{});
+    if (!lock.ownsLock())
+    {
+        return nullptr; //don't contend with the owning thread
+    }
+    //Tasks still in the inbox are also candidates
+    drainInbox();
+    //Search the lowest priorities first and from the back since these tasks are the furthest
+    //away from running. The task pointed to by a list iterator may be running or about to run
+    //and must never be released.
+    for (size_t level = numPriorityLevels; level-- > 0;)
+    {
+        RunList& list = _runLists[level];
+        for (TaskListIter pos = list._tasks.end(); pos != list._tasks.begin();)
+        {
+            --pos;
+            if ((pos != list._it) && pos->isStealable())
+            {
+                Task* task = &*pos;
+                list._tasks.erase(pos);
+                _stats.decNumElements();
+                notifyIfDrained();
+                return task;
+            }
+        }
+    }
+    return nullptr;
+}
+
+inline
+TaskQueue* TaskQueue::selectMigrationTarget(size_t& load, size_t& targetLoad) const
+{
+    //NOTE: must be called while holding the spinlock
+    std::vector<TaskQueue>* queues = _siblingQueues;
+    if (!_isMigrationEnabled || !queues || !_isStarted || _isInterrupted)
+    {
+        return nullptr; //a manual queue must run its tasks on the thread driving it
+    }
+    //Find the least loaded sibling. Siblings on other NUMA nodes are only
+    //considered if this queue is not assigned to a node.
+    TaskQueue* target = nullptr;
+    for (auto&& queue : *queues)
+    {
+        if ((&queue == this) || !queue._isStarted || queue._isInterrupted ||
+            ((_numaNode != -1) && (queue._numaNode != _numaNode)))
+        {
+            continue;
+        }
+        size_t queueSize = queue.size();
+        if (!target || (queueSize < targetLoad))
+        {
+            target = &queue;
+            targetLoad = queueSize;
+        }
+    }
+    load = size();
+    if (!target || (load < targetLoad + 2))
+    {
+        return nullptr; //moving a task would not improve the balance
+    }
+    return target;
+}
+
+inline
+void TaskQueue::migrate(Task& task, TaskQueue& target)
+{
+    //Wake-ups are routed via the queue id so it must be updated before the sibling can run the task
+    task.setQueueId(static_cast<int>(&target - _siblingQueues.load()->data()));
+    target.adopt(task);
+}
+
+inline
+void TaskQueue::recordStart(Task& task)
+{
+    Task::TimePoint now = std::chrono::steady_clock::now();
+    task.setStartTime(now);
+    _stats.addWaitTime(now - task.getPostTime());
+}
+
+inline
+void TaskQueue::recordCompletion(Task& task)
+{
+    Task::TimePoint now = std::chrono::steady_clock::now();
+    _stats.addRunTime(now - task.getStartTime());
+    _stats.addEndToEndTime(now - task.getPostTime());
+}
+
+inline
+void TaskQueue::recordSlice(std::chrono::nanoseconds sliceTime, int queueId)
+{
+    _stats.addSliceTime(sliceTime);
+    if ((_longSliceThresholdUs.count() <= 0) || (sliceTime < _longSliceThresholdUs))
+    {
+        return;
+    }
+    _stats.incLongSliceCount();
+    if (_longSliceCallback)
+    {
+        try
+        {
+            _longSliceCallback(queueId, std::chrono::duration_cast<std::chrono::microseconds>(sliceTime));
+        }
+        catch (...)
+        {
+            //never let a user callback interfere with the running coroutine
+        }
+    }
+}
+
+}}
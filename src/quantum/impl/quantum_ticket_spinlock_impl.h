@@ -0,0 +1,70 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+TicketSpinLock::TicketSpinLock() :
+    _next(0),
+    _serving(0)
+{}
+
+inline
+void TicketSpinLock::lock()
+{
+    const uint32_t ticket = _next.fetch_add(1, std::memory_order_relaxed);
+    SpinBackoff backoff;
+    while (_serving.load(std::memory_order_acquire) != ticket)
+    {
+        backoff.backoff();
+    }
+}
+
+inline
+bool TicketSpinLock::tryLock()
+{
+    uint32_t serving = _serving.load(std::memory_order_acquire);
+    uint32_t ticket = serving;
+    return _next.compare_exchange_strong(ticket, serving + 1, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+inline
+void TicketSpinLock::unlock()
+{
+    //only the owner writes this value
+    _serving.store(_serving.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+inline
+TicketSpinLock::Guard::Guard(TicketSpinLock& lock) :
+    _spinlock(lock)
+{
+    _spinlock.lock();
+}
+
+inline
+TicketSpinLock::Guard::~Guard()
+{
+    _spinlock.unlock();
+}
+
+}}
@@ -0,0 +1,147 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+inline
+TimerQueue::TimerQueue() :
+    _nextTimerId(0),
+    _isInterrupted(false),
+    _terminated(ATOMIC_FLAG_INIT)
+{
+}
+
+inline
+TimerQueue::~TimerQueue()
+{
+    terminate();
+}
+
+inline
+void TimerQueue::terminate()
+{
+    if (!_terminated.test_and_set())
+    {
+        {
+            //========================= LOCKED SCOPE =========================
+            std::lock_guard<std::mutex> lock(_mutex);
+            _isInterrupted = true;
+        }
+        _cond.notify_all();
+        if (_thread)
+        {
+            _thread->join();
+        }
+        //pending timers are discarded
+        _entries.clear();
+        _timers = decltype(_timers)();
+    }
+}
+
+inline
+size_t TimerQueue::add(TimePoint time, Duration period, Callback callback)
+{
+    size_t timerId;
+    {
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_isInterrupted)
+        {
+            throw std::runtime_error("Timer queue is terminated");
+        }
+        if (!_thread)
+        {
+            _thread = std::make_shared<std::thread>(std::bind(&TimerQueue::run, this));
+        }
+        timerId = ++_nextTimerId;
+        _entries.emplace(timerId, Entry{std::make_shared<Callback>(std::move(callback)), period});
+        _timers.push(Timer{time, timerId});
+    }
+    _cond.notify_one();
+    return timerId;
+}
+
+inline
+bool TimerQueue::cancel(size_t timerId)
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.erase(timerId) > 0; //the heap entry is skipped when it becomes due
+}
+
+inline
+size_t TimerQueue::size() const
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+inline
+void TimerQueue::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_isInterrupted)
+    {
+        if (_timers.empty())
+        {
+            _cond.wait(lock);
+            continue;
+        }
+        Timer timer = _timers.top();
+        if (std::chrono::steady_clock::now() < timer._time)
+        {
+            //========================= BLOCK UNTIL DUE =========================
+            _cond.wait_until(lock, timer._time);
+            continue; //an earlier timer may have been added in the meantime
+        }
+        _timers.pop();
+        auto it = _entries.find(timer._timerId);
+        if (it == _entries.end())
+        {
+            continue; //cancelled
+        }
+        std::shared_ptr<Callback> callback = it->second._callback;
+        if (it->second._period > Duration::zero())
+        {
+            //fixed rate
+            _timers.push(Timer{timer._time + it->second._period, timer._timerId});
+        }
+        else
+        {
+            _entries.erase(it);
+        }
+        //========================= UNLOCKED SCOPE =========================
+        lock.unlock();
+        try
+        {
+            (*callback)();
+        }
+        catch (...)
+        {
+            //a failing callback must not stop the other timers
+        }
+        lock.lock();
+    }
+}
+
+}}
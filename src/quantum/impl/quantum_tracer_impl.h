@@ -0,0 +1,246 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+#include <algorithm>
+#include <cstdio>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class Tracer
+//==============================================================================================
+inline
+Tracer::Buffer::Buffer(size_t capacity, size_t generation, uint32_t threadId) :
+    _events(capacity),
+    _head(0),
+    _generation(generation),
+    _threadId(threadId)
+{}
+
+inline
+Tracer::Tracer() :
+    _isStarted(false),
+    _generation(0),
+    _epochNs(0),
+    _capacity(0)
+{}
+
+inline
+Tracer& Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+inline
+void Tracer::start(size_t eventsPerThread)
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    _isStarted = false;
+    _buffers.clear(); //the threads drop their buffers on their next event
+    _capacity = (eventsPerThread == 0) ? 1 : eventsPerThread;
+    _epochNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    ++_generation;
+    _isStarted = true;
+}
+
+inline
+void Tracer::stop()
+{
+    _isStarted = false;
+}
+
+inline
+bool Tracer::isStarted() const
+{
+    return _isStarted;
+}
+
+inline
+void Tracer::record(EventType type, int queueId, const void* task)
+{
+#ifndef __QUANTUM_DISABLE_TRACING
+    Tracer& tracer = instance();
+    if (tracer._isStarted.load(std::memory_order_relaxed))
+    {
+        tracer.append(type, queueId, task);
+    }
+#else
+    (void)type;
+    (void)queueId;
+    (void)task;
+#endif
+}
+
+inline
+void Tracer::append(EventType type, int queueId, const void* task)
+{
+    thread_local BufferPtr buffer; //only accessed from the recording thread
+    size_t generation = _generation.load(std::memory_order_acquire);
+    if (!buffer || (buffer->_generation != generation))
+    {
+        buffer = addBuffer(generation);
+        if (!buffer)
+        {
+            return; //restarted concurrently
+        }
+    }
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch()).count();
+    size_t head = buffer->_head.load(std::memory_order_relaxed);
+    buffer->_events[head % buffer->_events.size()] = Event{std::chrono::nanoseconds(now - _epochNs.load(std::memory_order_relaxed)),
+                                                           task, queueId, buffer->_threadId, type};
+    buffer->_head.store(head + 1, std::memory_order_release);
+}
+
+inline
+Tracer::BufferPtr Tracer::addBuffer(size_t generation)
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (generation != _generation)
+    {
+        return nullptr;
+    }
+    _buffers.emplace_back(std::make_shared<Buffer>(_capacity, generation, (uint32_t)_buffers.size()));
+    return _buffers.back();
+}
+
+inline
+std::vector<Tracer::Event> Tracer::events() const
+{
+    std::vector<Event> events;
+    {
+        //========================= LOCKED SCOPE =========================
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto&& buffer : _buffers)
+        {
+            size_t head = buffer->_head.load(std::memory_order_acquire);
+            size_t capacity = buffer->_events.size();
+            for (size_t i = (head > capacity) ? head - capacity : 0; i < head; ++i)
+            {
+                events.push_back(buffer->_events[i % capacity]);
+            }
+        }
+    }
+    std::stable_sort(events.begin(), events.end(), [](const Event& lhs, const Event& rhs)->bool {
+        return lhs._time < rhs._time;
+    });
+    return events;
+}
+
+inline
+size_t Tracer::numDroppedEvents() const
+{
+    //========================= LOCKED SCOPE =========================
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t numDropped = 0;
+    for (auto&& buffer : _buffers)
+    {
+        size_t head = buffer->_head.load(std::memory_order_acquire);
+        if (head > buffer->_events.size())
+        {
+            numDropped += head - buffer->_events.size();
+        }
+    }
+    return numDropped;
+}
+
+inline
+void Tracer::exportChromeTrace(std::ostream& out) const
+{
+    std::vector<Event> events = this->events();
+    //Name each track after the kind of task it runs
+    std::vector<const char*> threadNames;
+    for (auto&& event : events)
+    {
+        if (event._threadId >= threadNames.size())
+        {
+            threadNames.resize(event._threadId + 1, nullptr);
+        }
+        const char*& name = threadNames[event._threadId];
+        if (!name && (event._type != EventType::Post) && (event._type != EventType::IoPost))
+        {
+            name = ((event._type == EventType::IoStart) || (event._type == EventType::IoEnd)) ? "IO thread" : "Coroutine thread";
+        }
+    }
+    char buf[64];
+    const char* separator = "";
+    out << "{\"traceEvents\":[";
+    for (size_t i = 0; i < threadNames.size(); ++i)
+    {
+        out << separator << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i
+            << ",\"args\":{\"name\":\"" << (threadNames[i] ? threadNames[i] : "Thread") << " " << i << "\"}}";
+        separator = ",";
+    }
+    for (auto&& event : events)
+    {
+        const char* name;
+        const char* phase;
+        switch (event._type)
+        {
+            case EventType::Post: name = "post"; phase = "i"; break;
+            case EventType::IoPost: name = "io post"; phase = "i"; break;
+            case EventType::FirstRun:
+            case EventType::Resume: name = "coroutine"; phase = "B"; break;
+            case EventType::Yield:
+            case EventType::Block:
+            case EventType::Complete: name = "coroutine"; phase = "E"; break;
+            case EventType::IoStart: name = "io task"; phase = "B"; break;
+            default: name = "io task"; phase = "E"; break;
+        }
+        long long ns = (long long)event._time.count();
+        snprintf(buf, sizeof(buf), "%lld.%03lld", ns / 1000, ns % 1000);
+        out << separator << "\n{\"name\":\"" << name << "\",\"ph\":\"" << phase << "\",\"pid\":1,\"tid\":" << event._threadId
+            << ",\"ts\":" << buf;
+        if (phase[0] == 'i')
+        {
+            out << ",\"s\":\"t\"";
+        }
+        snprintf(buf, sizeof(buf), "%p", event._task);
+        out << ",\"args\":{\"event\":\"" << toString(event._type) << "\",\"task\":\"" << buf
+            << "\",\"queue\":" << event._queueId << "}}";
+        separator = ",";
+    }
+    out << "\n],\"displayTimeUnit\":\"ns\"}" << std::endl;
+}
+
+inline
+const char* Tracer::toString(EventType type)
+{
+    switch (type)
+    {
+        case EventType::Post: return "post";
+        case EventType::FirstRun: return "first run";
+        case EventType::Resume: return "resume";
+        case EventType::Yield: return "yield";
+        case EventType::Block: return "block";
+        case EventType::Complete: return "complete";
+        case EventType::IoPost: return "io post";
+        case EventType::IoStart: return "io start";
+        case EventType::IoEnd: return "io end";
+    }
+    return "unknown";
+}
+
+}}
@@ -34,6 +34,11 @@ int bindCoro(Traits::Yield& yield,
         yield.get() = std::forward<CAPTURE>(capture)();
         return 0;
     }
+    catch(boost::context::detail::forced_unwind&)
+    {
+        //the coroutine is destroyed while suspended (e.g. on terminate). Let boost unwind its stack.
+        throw;
+    }
     catch(std::exception& ex)
     {
         UNUSED(ex);
@@ -83,6 +88,34 @@ int bindIo(std::shared_ptr<Promise<RET>> promise,
     return (int)ITask::RetCode::Exception;
 }
 
+template <typename DISPATCHER, typename CAPTURE>
+int bindDetachedIo(DISPATCHER* dispatcher,
+                   CAPTURE&& capture)
+{
+    try
+    {
+        return std::forward<CAPTURE>(capture)();
+    }
+    catch(std::exception& ex)
+    {
+        UNUSED(ex);
+#ifdef __QUANTUM_PRINT_DEBUG
+        std::lock_guard<std::mutex> guard(Util::LogMutex());
+        std::cerr << "Caught exception : " << ex.what() << std::endl;
+#endif
+        dispatcher->onDetachedError(std::current_exception());
+    }
+    catch(...)
+    {
+#ifdef __QUANTUM_PRINT_DEBUG
+        std::lock_guard<std::mutex> guard(Util::LogMutex());
+        std::cerr << "Caught unknown exception." << std::endl;
+#endif
+        dispatcher->onDetachedError(std::current_exception());
+    }
+    return (int)ITask::RetCode::Exception;
+}
+
 template<class RET, class FUNC, class ...ARGS>
 Function<int(Traits::Yield&)>
 Util::bindCaller(std::shared_ptr<Context<RET>> context, FUNC&& func, ARGS&& ...args)
@@ -99,6 +132,23 @@ Util::bindIoCaller(std::shared_ptr<Promise<RET>> promise, FUNC&& func, ARGS&& ..
     return makeCapture(bindIo<RET, decltype(capture)>, std::shared_ptr<Promise<RET>>(promise), std::move(capture));
 }
 
+template<class DISPATCHER, class FUNC, class ...ARGS>
+Function<int()>
+Util::bindDetachedIoCaller(DISPATCHER& dispatcher, FUNC&& func, ARGS&& ...args)
+{
+    auto capture = makeCapture(std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+    return makeCapture(bindDetachedIo<DISPATCHER, decltype(capture)>, &dispatcher, std::move(capture));
+}
+
+template<class FUNC, class ...ARGS>
+std::shared_ptr<Util::TimerCaller<FUNC, ARGS...>>
+Util::bindTimerCaller(FUNC&& func, ARGS&& ...args)
+{
+    return std::make_shared<TimerCaller<FUNC, ARGS...>>(std::bind(std::forward<FUNC>(func),
+                                                                  std::placeholders::_1,
+                                                                  std::forward<ARGS>(args)...));
+}
+
 template <class RET, class INPUT_IT>
 int Util::forEachCoro(CoroContextPtr<std::vector<RET>> ctx,
                       INPUT_IT inputIt,
@@ -118,11 +168,11 @@ int Util::forEachCoro(CoroContextPtr<std::vector<RET>> ctx,
     return ctx->set(FutureJoiner<RET>()(*ctx, std::move(asyncResults))->get(ctx));
 }
 
-template <class RET, class INPUT_IT>
+template <class RET, class INPUT_IT, class FUNC>
 int Util::forEachBatchCoro(CoroContextPtr<std::vector<std::vector<RET>>> ctx,
                            INPUT_IT inputIt,
                            size_t num,
-                           const Functions::ForEachFunc<RET, INPUT_IT>& func,
+                           const FUNC& func,
                            size_t numCoroutineThreads)
 {
     size_t numPerBatch = num/numCoroutineThreads;
@@ -155,6 +205,266 @@ int Util::forEachBatchCoro(CoroContextPtr<std::vector<std::vector<RET>>> ctx,
     return ctx->set(FutureJoiner<std::vector<RET>>()(*ctx, std::move(asyncResults))->get(ctx));
 }
 
+template <class RET, class INPUT_IT, class FUNC>
+size_t Util::probeGrainSize(std::vector<RET>& probed,
+                            INPUT_IT& inputIt,
+                            size_t num,
+                            const FUNC& func,
+                            GrainSize grain,
+                            size_t minNumChunks)
+{
+    if (!grain.isAdaptive())
+    {
+        return grain.numElements();
+    }
+    //Run the first elements inline to measure their cost. The probe stops once the target
+    //time has elapsed or after an even share of the range, whichever comes first.
+    size_t maxProbe = std::max<size_t>(1, num/minNumChunks);
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::nanoseconds elapsed(0);
+    while ((probed.size() < num) && (probed.size() < maxProbe) && (elapsed < grain.target()))
+    {
+        probed.emplace_back(func(*inputIt));
+        ++inputIt;
+        elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    }
+    size_t remaining = num - probed.size();
+    size_t grainSize = (remaining + minNumChunks - 1)/minNumChunks; //even share
+    if (elapsed.count() > 0)
+    {
+        double perElement = (double)elapsed.count()/probed.size();
+        double target = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(grain.target()).count();
+        grainSize = std::min(grainSize, (size_t)(target/perElement));
+    }
+    return std::max<size_t>(1, grainSize);
+}
+
+template <class RET, class INPUT_IT, class FUNC>
+int Util::forEachChunkCoro(CoroContextPtr<std::vector<RET>> ctx,
+                           INPUT_IT inputIt,
+                           size_t num,
+                           const FUNC& func,
+                           GrainSize grain,
+                           size_t numCoroutineThreads)
+{
+    std::vector<RET> result;
+    result.reserve(num);
+    size_t grainSize = probeGrainSize(result, inputIt, num, func, grain, numCoroutineThreads);
+    size_t remaining = num - result.size();
+    std::vector<CoroContextPtr<std::vector<RET>>> asyncResults;
+    asyncResults.reserve((remaining + grainSize - 1)/grainSize);
+    while (remaining)
+    {
+        size_t chunkSize = std::min(grainSize, remaining);
+        asyncResults.emplace_back(ctx->template post<std::vector<RET>>([inputIt, chunkSize, &func](CoroContextPtr<std::vector<RET>> ctx)->int
+        {
+            std::vector<RET> chunk;
+            chunk.reserve(chunkSize);
+            auto it = inputIt;
+            for (size_t j = 0; j < chunkSize; ++j, ++it)
+            {
+                chunk.emplace_back(func(*it));
+            }
+            return ctx->set(std::move(chunk));
+        }));
+        std::advance(inputIt, chunkSize);
+        remaining -= chunkSize;
+    }
+    //Flatten the chunks in input order
+    for (auto&& asyncResult : asyncResults)
+    {
+        std::vector<RET> chunk = asyncResult->get(ctx);
+        result.insert(result.end(), std::make_move_iterator(chunk.begin()), std::make_move_iterator(chunk.end()));
+    }
+    return ctx->set(std::move(result));
+}
+
+template <class RET, class INPUT_IT, class OUTPUT_IT, class FUNC>
+int Util::forEachIntoCoro(CoroContextPtr<int> ctx,
+                          INPUT_IT inputIt,
+                          size_t num,
+                          OUTPUT_IT outputIt,
+                          const FUNC& func,
+                          size_t numCoroutineThreads)
+{
+    std::vector<std::pair<INPUT_IT, size_t>> slices = sliceRange(inputIt, num, numCoroutineThreads*BatchChunksPerThread);
+    //The latch is shared since the last slice may still be inside countDown() once this coroutine resumes
+    auto latch = std::make_shared<Latch>(slices.size());
+    std::atomic_bool hasException{false};
+    std::exception_ptr exception;
+    for (auto&& slice : slices)
+    {
+        ctx->template post<int>([slice, outputIt, latch, &func, &hasException, &exception](CoroContextPtr<int> ctx)->int
+        {
+            try
+            {
+                auto it = slice.first;
+                auto out = outputIt;
+                for (size_t j = 0; j < slice.second; ++j, ++it, ++out)
+                {
+                    *out = func(*it);
+                }
+            }
+            catch (...)
+            {
+                if (!hasException.exchange(true))
+                {
+                    exception = std::current_exception(); //keep the first one
+                }
+            }
+            latch->countDown();
+            return ctx->set(0);
+        });
+        std::advance(outputIt, slice.second);
+    }
+    latch->wait(ctx);
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+    return ctx->set(0);
+}
+
+template <class INPUT_TYPE, class OUTPUT_TYPE, class KERNEL>
+int Util::forEachKernelCoro(CoroContextPtr<int> ctx,
+                            const INPUT_TYPE* input,
+                            size_t num,
+                            OUTPUT_TYPE* output,
+                            const KERNEL& kernel,
+                            size_t numCoroutineThreads)
+{
+    runKernelChunks(ctx, input, num, output, kernel, numCoroutineThreads);
+    return ctx->set(0);
+}
+
+template <class INPUT_TYPE, class OUTPUT_TYPE, class KERNEL>
+int Util::forEachKernelIntoVectorCoro(CoroContextPtr<std::vector<OUTPUT_TYPE>> ctx,
+                                      const INPUT_TYPE* input,
+                                      size_t num,
+                                      const KERNEL& kernel,
+                                      size_t numCoroutineThreads)
+{
+    std::vector<OUTPUT_TYPE> output(num);
+    runKernelChunks(ctx, input, num, output.data(), kernel, numCoroutineThreads);
+    return ctx->set(std::move(output));
+}
+
+template <class CTX, class INPUT_TYPE, class OUTPUT_TYPE, class KERNEL>
+void Util::runKernelChunks(const CTX& ctx,
+                           const INPUT_TYPE* input,
+                           size_t num,
+                           OUTPUT_TYPE* output,
+                           const KERNEL& kernel,
+                           size_t numCoroutineThreads)
+{
+    if (num == 0)
+    {
+        return;
+    }
+    //Chunk sizes are rounded up to whole vectors so that only the last chunk has a scalar tail
+    size_t step = std::max(kernelStep<INPUT_TYPE>(), kernelStep<OUTPUT_TYPE>());
+    size_t numChunks = numCoroutineThreads*BatchChunksPerThread;
+    size_t chunkSize = (num + numChunks - 1)/numChunks;
+    chunkSize = ((chunkSize + step - 1)/step)*step;
+    numChunks = (num + chunkSize - 1)/chunkSize;
+    //The latch is shared since the last chunk may still be inside countDown() once the caller resumes
+    auto latch = std::make_shared<Latch>(numChunks);
+    std::atomic_bool hasException{false};
+    std::exception_ptr exception;
+    for (size_t start = 0; start < num; start += chunkSize)
+    {
+        size_t size = std::min(chunkSize, num - start);
+        ctx->template post<int>([input, output, start, size, latch, &kernel, &hasException, &exception](CoroContextPtr<int> ctx)->int
+        {
+            try
+            {
+                kernel(Span<const INPUT_TYPE>(input + start, size), Span<OUTPUT_TYPE>(output + start, size));
+            }
+            catch (...)
+            {
+                if (!hasException.exchange(true))
+                {
+                    exception = std::current_exception(); //keep the first one
+                }
+            }
+            latch->countDown();
+            return ctx->set(0);
+        });
+    }
+    latch->wait(ctx);
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+template <class T>
+constexpr size_t Util::kernelStep()
+{
+    //KernelAlignment is a power of two so only the lowest set bit of sizeof(T) matters
+    return (sizeof(T) & (~sizeof(T) + 1)) >= KernelAlignment ? 1 : KernelAlignment/(sizeof(T) & (~sizeof(T) + 1));
+}
+
+template <class RET, class INPUT_IT, class FUNC>
+int Util::forEachBatchDynamicCoro(CoroContextPtr<std::vector<std::vector<RET>>> ctx,
+                                  INPUT_IT inputIt,
+                                  size_t num,
+                                  const FUNC& func,
+                                  GrainSize grain,
+                                  size_t numCoroutineThreads)
+{
+    //Several chunks per thread leave room for balancing when element costs are skewed
+    std::vector<RET> probed;
+    size_t grainSize = probeGrainSize(probed, inputIt, num, func, grain, numCoroutineThreads*BatchChunksPerThread);
+    size_t remaining = num - probed.size();
+    size_t numChunks = (remaining + grainSize - 1)/grainSize;
+    size_t offset = probed.empty() ? 0 : 1;
+    std::vector<std::vector<RET>> chunks(offset + numChunks);
+    if (offset)
+    {
+        chunks.front() = std::move(probed);
+    }
+    std::vector<INPUT_IT> chunkStarts;
+    chunkStarts.reserve(numChunks);
+    for (size_t i = 0; i < numChunks; ++i)
+    {
+        chunkStarts.push_back(inputIt);
+        if (i + 1 < numChunks)
+        {
+            std::advance(inputIt, grainSize);
+        }
+    }
+    //Each worker claims the next unprocessed chunk until the range is exhausted. Workers write
+    //to distinct chunks so the output keeps the input order.
+    std::atomic<size_t> cursor{0};
+    std::vector<CoroContextPtr<int>> asyncResults;
+    size_t numWorkers = std::min(numCoroutineThreads, numChunks);
+    asyncResults.reserve(numWorkers);
+    for (size_t i = 0; i < numWorkers; ++i)
+    {
+        asyncResults.emplace_back(ctx->template post<int>([&, grainSize, remaining, numChunks, offset](CoroContextPtr<int> ctx)->int
+        {
+            for (size_t k = cursor.fetch_add(1); k < numChunks; k = cursor.fetch_add(1))
+            {
+                size_t chunkSize = (k + 1 < numChunks) ? grainSize : remaining - k*grainSize;
+                std::vector<RET>& chunk = chunks[offset + k];
+                chunk.reserve(chunkSize);
+                auto it = chunkStarts[k];
+                for (size_t j = 0; j < chunkSize; ++j, ++it)
+                {
+                    chunk.emplace_back(func(*it));
+                }
+            }
+            return ctx->set(0);
+        }));
+    }
+    for (auto&& asyncResult : asyncResults)
+    {
+        asyncResult->wait(ctx);
+    }
+    return ctx->set(std::move(chunks));
+}
+
 template <class KEY,
           class MAPPED_TYPE,
           class REDUCED_TYPE,
@@ -202,12 +512,14 @@ int Util::mapReduceCoro(CoroContextPtr<std::map<KEY, REDUCED_TYPE>> ctx,
 template <class KEY,
           class MAPPED_TYPE,
           class REDUCED_TYPE,
-          class INPUT_IT>
+          class INPUT_IT,
+          class MAPPER,
+          class REDUCER>
 int Util::mapReduceBatchCoro(CoroContextPtr<std::map<KEY, REDUCED_TYPE>> ctx,
                              INPUT_IT inputIt,
                              size_t num,
-                             const Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>& mapper,
-                             const Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>& reducer)
+                             const MAPPER& mapper,
+                             const REDUCER& reducer)
 {
     // Typedefs
     using MappedResult = std::pair<KEY, MAPPED_TYPE>;
@@ -249,6 +561,419 @@ int Util::mapReduceBatchCoro(CoroContextPtr<std::map<KEY, REDUCED_TYPE>> ctx,
     return ctx->set(std::move(reducerOutput));
 }
 
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class OUTPUT,
+          class INPUT_IT>
+int Util::mapReducePartitionedCoro(CoroContextPtr<OUTPUT> ctx,
+                                   INPUT_IT inputIt,
+                                   size_t num,
+                                   const Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>& mapper,
+                                   const Functions::CombineFunc<MAPPED_TYPE>& combiner,
+                                   const Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>& reducer,
+                                   size_t numPartitions)
+{
+    // Typedefs
+    using Partition = std::unordered_map<KEY, std::vector<MAPPED_TYPE>>;
+    using ReducedResult = std::pair<KEY, REDUCED_TYPE>;
+    using ReducedResults = std::vector<ReducedResult>;
+    
+    size_t numMappers = std::min(numPartitions, num);
+    size_t numPerMapper = numMappers ? num/numMappers : 0;
+    size_t remainder = numMappers ? num%numMappers : 0;
+    std::vector<std::vector<Partition>> mapped(numMappers, std::vector<Partition>(numPartitions)); //[mapper][partition]
+    std::vector<ReducedResults> reduced(numPartitions);
+    std::vector<CoroContextPtr<int>> asyncResults;
+    asyncResults.reserve(numPartitions);
+    
+    // Map stage. Each mapper scatters its pairs by key hash into partitions it owns. With a combiner
+    // the values of a key are folded as they are produced so each key holds a single value.
+    for (size_t i = 0; i < numMappers; ++i)
+    {
+        size_t sliceSize = (i < remainder) ? numPerMapper + 1 : numPerMapper;
+        asyncResults.emplace_back(ctx->template post<int>([&mapped, &mapper, &combiner, i, inputIt, sliceSize, numPartitions](CoroContextPtr<int> ctx)->int
+        {
+            std::vector<Partition>& partitions = mapped[i];
+            std::hash<KEY> hasher;
+            auto it = inputIt;
+            for (size_t j = 0; j < sliceSize; ++j, ++it)
+            {
+                for (auto&& mapperResult : mapper(*it))
+                {
+                    Partition& partition = partitions[hasher(mapperResult.first) % numPartitions];
+                    std::vector<MAPPED_TYPE>& values = partition[std::move(mapperResult.first)];
+                    if (combiner && !values.empty())
+                    {
+                        values.front() = combiner(std::move(values.front()), std::move(mapperResult.second));
+                    }
+                    else
+                    {
+                        values.emplace_back(std::move(mapperResult.second));
+                    }
+                }
+            }
+            return ctx->set(0);
+        }));
+        std::advance(inputIt, sliceSize);
+    }
+    for (auto&& asyncResult : asyncResults)
+    {
+        asyncResult->wait(ctx);
+    }
+    asyncResults.clear();
+    
+    // Shuffle and reduce stage. Each reducer merges the same partition from all mappers.
+    for (size_t p = 0; numMappers && (p < numPartitions); ++p)
+    {
+        asyncResults.emplace_back(ctx->template post<int>([&mapped, &reduced, &reducer, p, numMappers](CoroContextPtr<int> ctx)->int
+        {
+            Partition partition = std::move(mapped[0][p]);
+            for (size_t i = 1; i < numMappers; ++i)
+            {
+                for (auto&& entry : mapped[i][p])
+                {
+                    std::vector<MAPPED_TYPE>& values = partition[entry.first];
+                    if (values.empty())
+                    {
+                        values = std::move(entry.second);
+                    }
+                    else
+                    {
+                        values.insert(values.end(),
+                                      std::make_move_iterator(entry.second.begin()),
+                                      std::make_move_iterator(entry.second.end()));
+                    }
+                }
+                Partition().swap(mapped[i][p]); //release the memory early
+            }
+            ReducedResults& results = reduced[p];
+            results.reserve(partition.size());
+            for (auto&& entry : partition)
+            {
+                results.emplace_back(reducer(std::pair<KEY, std::vector<MAPPED_TYPE>>(entry.first, std::move(entry.second))));
+            }
+            return ctx->set(0);
+        }));
+    }
+    for (auto&& asyncResult : asyncResults)
+    {
+        asyncResult->wait(ctx);
+    }
+    
+    OUTPUT reducerOutput;
+    for (auto&& results : reduced)
+    {
+        for (auto&& reducedResult : results)
+        {
+            emplaceReduced(reducerOutput, std::move(reducedResult));
+        }
+    }
+    return ctx->set(std::move(reducerOutput));
+}
+
+template <class KEY,
+          class MAPPED_TYPE,
+          class REDUCED_TYPE,
+          class OUTPUT,
+          class INPUT>
+int Util::mapReduceStreamCoro(CoroContextPtr<Buffer<OUTPUT>> ctx,
+                              CoroFuturePtr<Buffer<INPUT>> input,
+                              const Functions::StreamMapFunc<KEY, MAPPED_TYPE, INPUT>& mapper,
+                              const Functions::FoldFunc<REDUCED_TYPE, MAPPED_TYPE>& reducer,
+                              size_t windowSize)
+{
+    // Each mapped value is folded into its key as soon as it is produced so only one reduced
+    // value per key is held, alongside at most StreamPullSize pulled input values.
+    const size_t pullSize = StreamPullSize;
+    OUTPUT reduced;
+    std::vector<INPUT> values;
+    values.reserve(windowSize ? std::min(windowSize, pullSize) : pullSize);
+    size_t numInWindow = 0;
+    bool isBufferClosed = false;
+    while (!isBufferClosed)
+    {
+        values.clear();
+        size_t maxCount = windowSize ? std::min(windowSize - numInWindow, pullSize) : pullSize;
+        input->pullMany(ctx, values, maxCount, isBufferClosed);
+        for (auto it = values.cbegin(); it != values.cend(); ++it)
+        {
+            for (auto&& mapperResult : mapper(*it))
+            {
+                reducer(reduced[std::move(mapperResult.first)], std::move(mapperResult.second));
+            }
+        }
+        numInWindow += values.size();
+        if (windowSize && (numInWindow == windowSize))
+        {
+            ctx->push(std::move(reduced));
+            reduced = OUTPUT();
+            numInWindow = 0;
+        }
+    }
+    if (!windowSize || (numInWindow > 0))
+    {
+        ctx->push(std::move(reduced)); //last partial window or the whole stream
+    }
+    return ctx->closeBuffer();
+}
+
+template <class OUTPUT, class KEY, class REDUCED_TYPE>
+void Util::emplaceReduced(OUTPUT& output, std::pair<KEY, REDUCED_TYPE>&& reduced)
+{
+    output.emplace(std::move(reduced.first), std::move(reduced.second));
+}
+
+template <class KEY, class REDUCED_TYPE, class ALLOC>
+void Util::emplaceReduced(std::vector<std::pair<KEY, REDUCED_TYPE>, ALLOC>& output, std::pair<KEY, REDUCED_TYPE>&& reduced)
+{
+    output.emplace_back(std::move(reduced));
+}
+
+template <class RET, class INPUT_IT, class TRANSFORM>
+int Util::transformReduceCoro(CoroContextPtr<RET> ctx,
+                              INPUT_IT inputIt,
+                              size_t num,
+                              RET init,
+                              const Functions::BinaryFunc<RET>& reduceOp,
+                              const TRANSFORM& transform,
+                              size_t numCoroutineThreads)
+{
+    std::vector<CoroContextPtr<RET>> asyncResults;
+    asyncResults.reserve(numCoroutineThreads);
+    
+    // Each coroutine accumulates a partial result for its slice
+    for (auto&& slice : sliceRange(inputIt, num, numCoroutineThreads))
+    {
+        asyncResults.emplace_back(ctx->template post<RET>([slice, &reduceOp, &transform](CoroContextPtr<RET> ctx)->int
+        {
+            return ctx->set(reduceSlice<RET>(slice.first, slice.second, reduceOp, transform));
+        }));
+    }
+    if (asyncResults.empty())
+    {
+        return ctx->set(std::move(init));
+    }
+    std::vector<RET> partials;
+    partials.reserve(asyncResults.size());
+    for (auto&& asyncResult : asyncResults)
+    {
+        partials.emplace_back(asyncResult->get(ctx));
+    }
+    return ctx->set(reduceOp(init, treeCombine(std::move(partials), reduceOp)));
+}
+
+template <class RET, class INPUT_IT>
+int Util::scanCoro(CoroContextPtr<std::vector<RET>> ctx,
+                   INPUT_IT inputIt,
+                   size_t num,
+                   bool isInclusive,
+                   RET init,
+                   const Functions::BinaryFunc<RET>& op,
+                   size_t numCoroutineThreads)
+{
+    std::vector<std::pair<INPUT_IT, size_t>> slices = sliceRange(inputIt, num, numCoroutineThreads);
+    std::vector<CoroContextPtr<int>> asyncResults;
+    asyncResults.reserve(slices.size());
+    
+    // First pass: the total of each slice except the last one
+    std::vector<RET> totals(slices.empty() ? 0 : slices.size()-1);
+    for (size_t i = 0; i < totals.size(); ++i)
+    {
+        asyncResults.emplace_back(ctx->template post<int>([&slices, &totals, &op, i](CoroContextPtr<int> ctx)->int
+        {
+            totals[i] = reduceSlice<RET>(slices[i].first, slices[i].second, op, IdentityTransform());
+            return ctx->set(0);
+        }));
+    }
+    for (auto&& asyncResult : asyncResults)
+    {
+        asyncResult->wait(ctx);
+    }
+    asyncResults.clear();
+    
+    // The value carried into each slice. Slice 0 of an inclusive scan starts with its first element.
+    std::vector<RET> carries(slices.size());
+    for (size_t i = 0; i < slices.size(); ++i)
+    {
+        if (i == 0)
+        {
+            carries[i] = init;
+        }
+        else if ((i == 1) && isInclusive)
+        {
+            carries[i] = std::move(totals[0]);
+        }
+        else
+        {
+            carries[i] = op(carries[i-1], totals[i-1]);
+        }
+    }
+    
+    // Second pass: each slice writes its own part of the output
+    std::vector<RET> output(num);
+    size_t offset = 0;
+    for (size_t i = 0; i < slices.size(); ++i)
+    {
+        asyncResults.emplace_back(ctx->template post<int>([&slices, &carries, &output, &op, i, offset, isInclusive](CoroContextPtr<int> ctx)->int
+        {
+            auto it = slices[i].first;
+            RET acc = std::move(carries[i]);
+            size_t j = 0;
+            if (isInclusive && (i == 0))
+            {
+                acc = *it;
+                output[offset] = acc;
+                ++j;
+                ++it;
+            }
+            for (; j < slices[i].second; ++j, ++it)
+            {
+                if (isInclusive)
+                {
+                    acc = op(acc, *it);
+                    output[offset+j] = acc;
+                }
+                else
+                {
+                    output[offset+j] = acc;
+                    acc = op(acc, *it);
+                }
+            }
+            return ctx->set(0);
+        }));
+        offset += slices[i].second;
+    }
+    for (auto&& asyncResult : asyncResults)
+    {
+        asyncResult->wait(ctx);
+    }
+    return ctx->set(std::move(output));
+}
+
+template <class RANDOM_IT, class COMPARE>
+int Util::sortCoro(CoroContextPtr<int> ctx,
+                   RANDOM_IT first,
+                   RANDOM_IT last,
+                   const COMPARE& compare,
+                   bool isStable,
+                   size_t numCoroutineThreads)
+{
+    size_t num = std::distance(first, last);
+    size_t numSlices = std::max<size_t>(1, std::min(numCoroutineThreads, num/MinSortSliceSize));
+    
+    // Slice boundaries. Slice i is [bounds[i], bounds[i+1]).
+    std::vector<RANDOM_IT> bounds;
+    bounds.reserve(numSlices + 1);
+    for (auto&& slice : sliceRange(first, num, numSlices))
+    {
+        bounds.push_back(slice.first);
+    }
+    bounds.push_back(last);
+    
+    // Sort each slice in parallel
+    std::vector<CoroContextPtr<int>> asyncResults;
+    asyncResults.reserve(numSlices);
+    for (size_t i = 0; i + 1 < bounds.size(); ++i)
+    {
+        asyncResults.emplace_back(ctx->template post<int>([&bounds, &compare, i, isStable](CoroContextPtr<int> ctx)->int
+        {
+            if (isStable)
+            {
+                std::stable_sort(bounds[i], bounds[i+1], compare);
+            }
+            else
+            {
+                std::sort(bounds[i], bounds[i+1], compare);
+            }
+            return ctx->set(0);
+        }));
+    }
+    for (auto&& asyncResult : asyncResults)
+    {
+        asyncResult->wait(ctx);
+    }
+    
+    // Merge adjacent runs pairwise, in parallel, until a single run is left. Merging is stable.
+    for (size_t width = 1; width < numSlices; width *= 2)
+    {
+        asyncResults.clear();
+        for (size_t i = 0; i + width < numSlices; i += 2*width)
+        {
+            RANDOM_IT begin = bounds[i];
+            RANDOM_IT middle = bounds[i+width];
+            RANDOM_IT end = bounds[std::min(i+2*width, numSlices)];
+            asyncResults.emplace_back(ctx->template post<int>([begin, middle, end, &compare](CoroContextPtr<int> ctx)->int
+            {
+                std::inplace_merge(begin, middle, end, compare);
+                return ctx->set(0);
+            }));
+        }
+        for (auto&& asyncResult : asyncResults)
+        {
+            asyncResult->wait(ctx);
+        }
+    }
+    return ctx->set(0);
+}
+
+template <class INPUT_IT>
+std::vector<std::pair<INPUT_IT, size_t>> Util::sliceRange(INPUT_IT inputIt, size_t num, size_t numSlices)
+{
+    std::vector<std::pair<INPUT_IT, size_t>> slices;
+    numSlices = std::min(numSlices, num);
+    if (numSlices == 0)
+    {
+        return slices;
+    }
+    slices.reserve(numSlices);
+    size_t numPerSlice = num/numSlices;
+    size_t remainder = num%numSlices;
+    for (size_t i = 0; i < numSlices; ++i)
+    {
+        size_t sliceSize = (i < remainder) ? numPerSlice + 1 : numPerSlice;
+        slices.emplace_back(inputIt, sliceSize);
+        if (i + 1 < numSlices)
+        {
+            std::advance(inputIt, sliceSize);
+        }
+    }
+    return slices;
+}
+
+template <class RET, class INPUT_IT, class TRANSFORM>
+RET Util::reduceSlice(INPUT_IT inputIt,
+                      size_t num,
+                      const Functions::BinaryFunc<RET>& reduceOp,
+                      const TRANSFORM& transform)
+{
+    RET acc = transform(*inputIt);
+    for (size_t i = 1; i < num; ++i)
+    {
+        acc = reduceOp(acc, transform(*(++inputIt)));
+    }
+    return acc;
+}
+
+template <class RET>
+RET Util::treeCombine(std::vector<RET>&& values, const Functions::BinaryFunc<RET>& op)
+{
+    while (values.size() > 1)
+    {
+        size_t half = (values.size() + 1)/2;
+        for (size_t i = 0; i < values.size()/2; ++i)
+        {
+            values[i] = op(values[2*i], values[2*i+1]);
+        }
+        if (values.size() % 2)
+        {
+            values[half-1] = std::move(values.back()); //odd one out moves up a level
+        }
+        values.erase(values.begin() + half, values.end());
+    }
+    return std::move(values.front());
+}
+
 #ifdef __QUANTUM_PRINT_DEBUG
 std::mutex& Util::LogMutex()
 {
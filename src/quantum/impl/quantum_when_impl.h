@@ -0,0 +1,130 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+//NOTE: DO NOT INCLUDE DIRECTLY
+
+//##############################################################################################
+//#################################### IMPLEMENTATIONS #########################################
+//##############################################################################################
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                    class WhenCallback
+//==============================================================================================
+template <class RET>
+WhenCallback<RET>::WhenCallback(size_t numRequired, bool recordIndexes) :
+    _numRequired(numRequired),
+    _numReady(0),
+    _numRecorded(0),
+    _indexes(recordIndexes ? numRequired : 0)
+{
+    if (_numRequired == 0)
+    {
+        setResult();
+    }
+}
+
+template <class RET>
+FuturePtr<RET> WhenCallback<RET>::getFuture() const
+{
+    return std::static_pointer_cast<Future<RET>>(_promise.getIThreadFuture());
+}
+
+template <class RET>
+void WhenCallback<RET>::onReady(size_t index)
+{
+    size_t pos = _numReady.fetch_add(1, std::memory_order_relaxed);
+    if (pos >= _numRequired)
+    {
+        return; //result already determined
+    }
+    if (!_indexes.empty())
+    {
+        _indexes[pos] = index;
+    }
+    //the last one to record its index sets the result
+    if (_numRecorded.fetch_add(1, std::memory_order_acq_rel) + 1 == _numRequired)
+    {
+        setResult();
+    }
+}
+
+template <>
+inline
+void WhenCallback<int>::setResult()
+{
+    _promise.set(0);
+}
+
+template <>
+inline
+void WhenCallback<size_t>::setResult()
+{
+    _promise.set(_indexes.front());
+}
+
+template <>
+inline
+void WhenCallback<std::vector<size_t>>::setResult()
+{
+    _promise.set(std::move(_indexes));
+}
+
+template <class FUTURE>
+FuturePtr<int> whenAll(const std::vector<FUTURE>& futures)
+{
+    auto callback = std::make_shared<WhenCallback<int>>(futures.size(), false);
+    for (size_t i = 0; i < futures.size(); ++i)
+    {
+        futures[i]->addCallback(callback, i);
+    }
+    return callback->getFuture();
+}
+
+template <class FUTURE>
+FuturePtr<size_t> whenAny(const std::vector<FUTURE>& futures)
+{
+    if (futures.empty())
+    {
+        //nothing will ever be ready
+        Promise<size_t> promise;
+        return std::static_pointer_cast<Future<size_t>>(promise.getIThreadFuture());
+    }
+    auto callback = std::make_shared<WhenCallback<size_t>>(1, true);
+    for (size_t i = 0; i < futures.size(); ++i)
+    {
+        futures[i]->addCallback(callback, i);
+    }
+    return callback->getFuture();
+}
+
+template <class FUTURE>
+FuturePtr<std::vector<size_t>> whenN(const std::vector<FUTURE>& futures, size_t num)
+{
+    if (num > futures.size())
+    {
+        throw std::runtime_error("Not enough futures");
+    }
+    auto callback = std::make_shared<WhenCallback<std::vector<size_t>>>(num, true);
+    for (size_t i = 0; i < futures.size(); ++i)
+    {
+        futures[i]->addCallback(callback, i);
+    }
+    return callback->getFuture();
+}
+
+}}
@@ -19,8 +19,14 @@
 #include <quantum/quantum_functions.h>
 #include <quantum/interface/quantum_icoro_context_base.h>
 #include <quantum/interface/quantum_icoro_future.h>
+#include <quantum/interface/quantum_iqueue.h>
+#include <quantum/quantum_coro_local.h>
+#include <quantum/quantum_stack_traits.h>
+#include <quantum/quantum_grain_size.h>
 #include <map>
+#include <unordered_map>
 #include <vector>
+#include <sys/types.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -28,6 +34,9 @@ namespace quantum {
 template <class RET>
 class Context;
 
+template <class T>
+class SharedFuture;
+
 //==============================================================================================
 //                                  interface ICoroContext
 //==============================================================================================
@@ -55,6 +64,11 @@ struct ICoroContext : public ICoroContextBase
     ///       not invalidate the future and as such may be read again.
     virtual const RET& getRef(ICoroSync::Ptr sync) const = 0;
     
+    /// @brief Get a shared future for the value associated with this context.
+    /// @return A copyable handle which gives any number of threads or coroutines a reference to the value.
+    /// @note Does not block. See SharedFuture for details.
+    SharedFuture<RET> getSharedFuture() const;
+    
     /// @brief Get the future value associated with the previous coroutine context in the continuation chain.
     /// @tparam OTHER_RET The type of the future value of the previous context.
     /// @return The previous future value.
@@ -117,6 +131,15 @@ struct ICoroContext : public ICoroContextBase
     template <class BUF = RET, class V = BufferValue<BUF>>
     void push(V &&value);
     
+    /// @brief Push several values into the promise buffer at once.
+    /// @tparam BUF Represents a class of type Buffer.
+    /// @tparam V The type of value contained in Buffer.
+    /// @param[in] values Values to push at the end of the buffer. They are moved from.
+    /// @note Method available for buffered futures only. Never blocks. Once the buffer is closed, no more Push
+    ///       operations are allowed.
+    template <class BUF = RET, class V = BufferValue<BUF>>
+    void pushMany(std::vector<V> values);
+    
     /// @brief Pull a single value from the future buffer.
     /// @tparam BUF Represents a class of type Buffer.
     /// @tparam V The type of value contained in Buffer.
@@ -127,6 +150,19 @@ struct ICoroContext : public ICoroContextBase
     template <class BUF = RET, class V = BufferValue<BUF>>
     V pull(ICoroSync::Ptr sync, bool& isBufferClosed);
     
+    /// @brief Pull several values from the future buffer at once.
+    /// @tparam BUF Represents a class of type Buffer.
+    /// @tparam V The type of value contained in Buffer.
+    /// @param[in] sync Pointer to the coroutine synchronization object.
+    /// @param[out] values Container to which the pulled values are appended.
+    /// @param[in] maxCount Maximum number of values to pull.
+    /// @param[out] isBufferClosed Indicates if this buffer is closed and no more Pull operations are allowed on it.
+    /// @return The number of values pulled.
+    /// @note Method available for buffered futures only. Blocks until at least one value is retrieved from the buffer
+    ///       or until the buffer is closed.
+    template <class BUF = RET, class V = BufferValue<BUF>>
+    size_t pullMany(ICoroSync::Ptr sync, std::vector<V>& values, size_t maxCount, bool& isBufferClosed);
+    
     /// @brief Close a promise buffer.
     /// @tparam BUF Represents a class of type Buffer.
     /// @note Once closed no more Pushes can be made into the buffer. The corresponding future can still Pull values until
@@ -148,6 +184,55 @@ struct ICoroContext : public ICoroContextBase
     ///       to a specific queue.
     int getNumIoThreads() const;
     
+    /// @brief Check if this coroutine has been cancelled via the token it was posted with.
+    /// @return True if cancelled.
+    /// @note Cancellation is cooperative. A running coroutine should check this at its yield points and
+    ///       return early. The token is inherited by continuations as well as by coroutines and IO tasks
+    ///       posted from within this coroutine.
+    bool isCancelled() const;
+    
+    /// @brief Get the value of a coroutine-local slot.
+    /// @tparam T The type of the value.
+    /// @param[in] slot The slot, usually declared once as a static object.
+    /// @return A pointer to the value or null if it was never set.
+    /// @note Access is a constant-time array lookup. Values are shared by all the coroutines in a continuation
+    ///       chain, and with child coroutines if the slot is inherited by children.
+    template <class T>
+    T* getLocal(const CoroLocal<T>& slot) const;
+    
+    /// @brief Set the value of a coroutine-local slot.
+    /// @param[in] slot The slot.
+    /// @param[in] value The value. Passing null clears the slot.
+    /// @note Child coroutines inherit the values which are set before they are posted.
+    template <class T>
+    void setLocal(const CoroLocal<T>& slot, std::shared_ptr<T> value);
+    
+    /// @brief Suspend this coroutine until a file descriptor becomes readable.
+    /// @param[in] fd The file descriptor. Must support polling (e.g. a socket, a pipe or an eventfd).
+    /// @param[in] timeMs Maximum time to wait. A negative value waits indefinitely.
+    /// @return True if the descriptor is ready or false if the time expired.
+    /// @note The coroutine is parked and does not occupy an IO thread while waiting. It is resumed
+    ///       on its own queue. Only one coroutine can wait to read from a given descriptor at a time.
+    bool awaitReadable(int fd, std::chrono::milliseconds timeMs = std::chrono::milliseconds(-1));
+    
+    /// @brief Suspend this coroutine until a file descriptor becomes writable.
+    /// @note See awaitReadable() for details.
+    bool awaitWritable(int fd, std::chrono::milliseconds timeMs = std::chrono::milliseconds(-1));
+    
+    /// @brief Read from a non-blocking file descriptor, suspending this coroutine until data is available.
+    /// @param[in] fd The file descriptor.
+    /// @param[out] buffer Buffer receiving the data.
+    /// @param[in] size The size of the buffer.
+    /// @return Same as ::read(). Never fails with EAGAIN or EWOULDBLOCK.
+    ssize_t read(int fd, void* buffer, size_t size);
+    
+    /// @brief Write to a non-blocking file descriptor, suspending this coroutine until it can accept data.
+    /// @param[in] fd The file descriptor.
+    /// @param[in] buffer Data to write.
+    /// @param[in] size The number of bytes to write.
+    /// @return Same as ::write(). Never fails with EAGAIN or EWOULDBLOCK.
+    ssize_t write(int fd, const void* buffer, size_t size);
+    
     //-----------------------------------------------------------------------------------------
     //                         TASK CONTINUATIONS (NON-VIRTUAL)
     //-----------------------------------------------------------------------------------------
@@ -203,6 +288,24 @@ struct ICoroContext : public ICoroContextBase
     typename ICoroContext<OTHER_RET>::Ptr
     post(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    /// @brief Post a coroutine to run asynchronously with the given priority level.
+    /// @param[in] queueId Id of the queue where this coroutine should run. Valid range is [0, numCoroutineThreads),
+    ///                    IQueue::QueueId::Any or IQueue::QueueId::Same.
+    /// @param[in] priority Priority level. Higher levels always run first, subject to the configured starvation limit.
+    /// @param[in] func Callable object.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A pointer to a coroutine context object.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    typename ICoroContext<OTHER_RET>::Ptr
+    post(int queueId, IQueue::Priority priority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but with a deadline.
+    /// @param[in] deadline Coroutines having a deadline run ahead of the others of the same priority level,
+    ///                     in earliest-deadline-first order.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    typename ICoroContext<OTHER_RET>::Ptr
+    post(int queueId, IQueue::Priority priority, std::chrono::steady_clock::time_point deadline, FUNC&& func, ARGS&&... args);
+    
     /// @brief Posts a coroutine to run asynchronously.
     /// @details This function is the head of a coroutine continuation chain and must be called only once in the chain.
     /// @tparam OTHER_RET Type of future returned by this coroutine.
@@ -242,6 +345,44 @@ struct ICoroContext : public ICoroContextBase
     typename ICoroContext<OTHER_RET>::Ptr
     postFirst(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    /// @brief Posts the first coroutine of a continuation chain with the given priority level.
+    /// @note See post() for the meaning of 'priority'. Continuations keep the priority of the first coroutine.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    typename ICoroContext<OTHER_RET>::Ptr
+    postFirst(int queueId, IQueue::Priority priority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Posts the first coroutine of a continuation chain with the given priority level and deadline.
+    /// @note See post() for the meaning of 'priority' and 'deadline'.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    typename ICoroContext<OTHER_RET>::Ptr
+    postFirst(int queueId, IQueue::Priority priority, std::chrono::steady_clock::time_point deadline, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a batch of coroutines to run asynchronously.
+    /// @details The coroutines are spread evenly across all the queues and each queue is signalled only once per batch.
+    /// @tparam OTHER_RET Type of future returned by each coroutine.
+    /// @tparam FUNC_IT Iterator type over callable objects. The signature of each callable object must strictly
+    ///                 be 'int f(CoroContext<OTHER_RET>::Ptr)'.
+    /// @param[in] first The first callable in the range.
+    /// @param[in] last The last callable in the range (exclusive).
+    /// @return A vector of coroutine context objects, one per callable and in the same order.
+    /// @note This function is non-blocking and returns immediately. The callables are copied and the returned
+    ///       contexts cannot be used to chain further coroutines.
+    template <class OTHER_RET = int, class FUNC_IT, class = Traits::IsInputIterator<FUNC_IT>>
+    std::vector<typename ICoroContext<OTHER_RET>::Ptr>
+    postBatch(FUNC_IT first, FUNC_IT last);
+    
+    /// @brief Post a batch of coroutines to run asynchronously on a specific queue (thread).
+    /// @param[in] queueId Id of the queue where the coroutines should run. Valid range is [0, numCoroutineThreads),
+    ///                    IQueue::QueueId::Any or IQueue::QueueId::Same.
+    /// @param[in] isHighPriority If set to true, the coroutines will be scheduled to run immediately after the currently
+    ///                           executing coroutine on 'queueId' has completed or has yielded.
+    /// @param[in] first The first callable in the range.
+    /// @param[in] last The last callable in the range (exclusive).
+    /// @return A vector of coroutine context objects, one per callable and in the same order.
+    template <class OTHER_RET = int, class FUNC_IT, class = Traits::IsInputIterator<FUNC_IT>>
+    std::vector<typename ICoroContext<OTHER_RET>::Ptr>
+    postBatch(int queueId, bool isHighPriority, FUNC_IT first, FUNC_IT last);
+    
     /// @brief Posts a coroutine to run asynchronously.
     /// @details This function is optional for the continuation chain and may be called 0 or more times. If called,
     ///          it must follow postFirst() or another then() method.
@@ -260,6 +401,12 @@ struct ICoroContext : public ICoroContextBase
     typename ICoroContext<OTHER_RET>::Ptr
     then(FUNC&& func, ARGS&&... args);
     
+    /// @brief Same as above but the coroutine stack is taken from a specific size class.
+    /// @param[in] stackSize Size class of the coroutine stack. See StackSizeClass.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    typename ICoroContext<OTHER_RET>::Ptr
+    then(StackSizeClass stackSize, FUNC&& func, ARGS&&... args);
+    
     /// @brief Posts a coroutine to run asynchronously. This is the error handler for a continuation chain and acts as
     ///        as a 'catch' clause.
     /// @details This function is optional for the continuation chain and may be called at most once. If called,
@@ -339,6 +486,76 @@ struct ICoroContext : public ICoroContextBase
     CoroFuturePtr<OTHER_RET>
     postAsyncIo(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    /// @brief Same as above but with a deadline.
+    /// @param[in] deadline Functions having a deadline run ahead of the others of the same priority in earliest-deadline-first
+    ///                     order. A function which has not started by its deadline is discarded and its future throws a
+    ///                     DeadlineExceededException.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    CoroFuturePtr<OTHER_RET>
+    postAsyncIo(int queueId, bool isHighPriority, std::chrono::steady_clock::time_point deadline, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Posts a batch of IO functions to run asynchronously on the IO thread pool.
+    /// @details All the functions are inserted into the IO queue under a single lock and as many idle IO threads
+    ///          are woken up as there are functions.
+    /// @tparam OTHER_RET Type of future returned by each function.
+    /// @tparam FUNC_IT Iterator type over callable objects. The signature of each callable object must strictly
+    ///                 be 'int f(ThreadPromise<OTHER_RET>::Ptr)'.
+    /// @param[in] first The first callable in the range.
+    /// @param[in] last The last callable in the range (exclusive).
+    /// @return A vector of coroutine future objects, one per callable and in the same order.
+    /// @note This method does not block. The callables are copied.
+    template <class OTHER_RET = int, class FUNC_IT, class = Traits::IsInputIterator<FUNC_IT>>
+    std::vector<CoroFuturePtr<OTHER_RET>>
+    postAsyncIoBatch(FUNC_IT first, FUNC_IT last);
+    
+    /// @brief Same as above but on a specific queue (thread). See postAsyncIo() for the meaning of 'queueId' and 'isHighPriority'.
+    template <class OTHER_RET = int, class FUNC_IT, class = Traits::IsInputIterator<FUNC_IT>>
+    std::vector<CoroFuturePtr<OTHER_RET>>
+    postAsyncIoBatch(int queueId, bool isHighPriority, FUNC_IT first, FUNC_IT last);
+    
+    /// @brief Post a coroutine to run asynchronously once the specified delay has elapsed.
+    /// @param[in] delay Time to wait before the coroutine is posted.
+    /// @param[in] func Callable object.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A pointer to a coroutine context object.
+    /// @note Unlike calling sleep() at the beginning of a coroutine, the coroutine is not created until it is due.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    typename ICoroContext<OTHER_RET>::Ptr
+    postAfter(std::chrono::milliseconds delay, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread). See post() for the meaning of 'queueId' and 'isHighPriority'.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    typename ICoroContext<OTHER_RET>::Ptr
+    postAfter(std::chrono::milliseconds delay, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a coroutine to run asynchronously at the specified time.
+    /// @note See postAfter() for details.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    typename ICoroContext<OTHER_RET>::Ptr
+    postAt(std::chrono::steady_clock::time_point time, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread). See post() for the meaning of 'queueId' and 'isHighPriority'.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    typename ICoroContext<OTHER_RET>::Ptr
+    postAt(std::chrono::steady_clock::time_point time, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a new instance of a coroutine at a fixed rate until cancelled.
+    /// @return A timer id to be passed to cancelTimer().
+    /// @note See Dispatcher::postEvery() for details.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    size_t
+    postEvery(std::chrono::milliseconds period, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread). See post() for the meaning of 'queueId' and 'isHighPriority'.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    size_t
+    postEvery(std::chrono::milliseconds period, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Cancel a delayed or periodic post.
+    /// @param[in] timerId The id returned by postEvery().
+    /// @return True if the timer was pending, false otherwise.
+    bool cancelTimer(size_t timerId);
+    
     /// @brief Applies the given unary function to all the elements in the range [first,last).
     ///        This function runs in parallel.
     /// @tparam OTHER_RET The return value of the unary function.
@@ -369,6 +586,39 @@ struct ICoroContext : public ICoroContextBase
     typename ICoroContext<std::vector<OTHER_RET>>::Ptr
     forEach(INPUT_IT first, size_t num, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func);
     
+    /// @brief Same as forEach() but consecutive elements are grouped into chunks and each coroutine
+    ///        processes a whole chunk. The result still holds one value per element, in input order.
+    /// @param[in] grain The chunk size or GrainSize::adaptive() to derive it from the measured cost of
+    ///            the first elements, which are run inline by this coroutine.
+    /// @note Use this function when func() is cheap compared to the cost of posting a coroutine.
+    template <class OTHER_RET = int, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename ICoroContext<std::vector<OTHER_RET>>::Ptr
+    forEach(INPUT_IT first, INPUT_IT last, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func, GrainSize grain);
+    
+    /// @brief Same as above but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class OTHER_RET = int, class INPUT_IT>
+    typename ICoroContext<std::vector<OTHER_RET>>::Ptr
+    forEach(INPUT_IT first, size_t num, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func, GrainSize grain);
+    
+    /// @brief Same as forEach() but each result is written in place into the output range instead of
+    ///        being gathered in a vector. The input is split into a few slices per coroutine thread and
+    ///        completion is signalled once, after the last slice has been written.
+    /// @tparam OUTPUT_IT A random access iterator (or pointer) to the output range.
+    /// @oaram[in] out The first element of the output range, which must hold at least as many elements
+    ///            as the input range. The result for the i-th input element is assigned to out[i].
+    /// @return A context which completes once all the results are written.
+    /// @note The output range must stay valid until the returned context completes.
+    template <class OTHER_RET, class INPUT_IT, class OUTPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    std::shared_ptr<ICoroContext<int>>
+    forEach(INPUT_IT first, INPUT_IT last, OUTPUT_IT out, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func);
+    
+    /// @brief Same as above but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class OTHER_RET, class INPUT_IT, class OUTPUT_IT>
+    std::shared_ptr<ICoroContext<int>>
+    forEach(INPUT_IT first, size_t num, OUTPUT_IT out, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func);
+    
     /// @brief Applies the given unary function to all the elements in the range [first,last).
     ///        This function runs serially with respect to other functions in the same batch.
     /// @tparam OTHER_RET The return value of the unary function.
@@ -401,6 +651,77 @@ struct ICoroContext : public ICoroContextBase
     typename ICoroContext<std::vector<std::vector<OTHER_RET>>>::Ptr
     forEachBatch(INPUT_IT first, size_t num, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func);
     
+    /// @brief Self-balancing version of forEachBatch(). The range is cut into chunks which are claimed
+    ///        one at a time by a worker coroutine per thread, so that threads finishing early take over
+    ///        the remaining work when the cost of func() varies across elements.
+    /// @param[in] grain The chunk size or GrainSize::adaptive() to derive it from the measured cost of
+    ///            the first elements. Adaptive chunks are capped to leave several chunks per thread.
+    /// @return A vector of value vectors (i.e. one per chunk, in input order).
+    template <class OTHER_RET = int, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename ICoroContext<std::vector<std::vector<OTHER_RET>>>::Ptr
+    forEachBatch(INPUT_IT first, INPUT_IT last, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func, GrainSize grain);
+    
+    /// @brief Same as above but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class OTHER_RET = int, class INPUT_IT>
+    typename ICoroContext<std::vector<std::vector<OTHER_RET>>>::Ptr
+    forEachBatch(INPUT_IT first, size_t num, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func, GrainSize grain);
+    
+    /// @brief Same as forEachBatch() but 'func' is taken by its own type instead of being wrapped in a
+    ///        std::function, so that it can be inlined into the loop running each batch.
+    /// @tparam FUNC A callable of signature 'OTHER_RET(const INPUT_IT::value_type&)'. It is copied once and shared by
+    ///         all the batches.
+    /// @note Use this function when func() is too cheap to amortize an indirect call per element.
+    template <class OTHER_RET = int, class INPUT_IT, class FUNC,
+              class = Traits::IsInputIterator<INPUT_IT>,
+              class = Traits::IsNotStdFunction<FUNC, Functions::ForEachFunc<OTHER_RET, INPUT_IT>>>
+    typename ICoroContext<std::vector<std::vector<OTHER_RET>>>::Ptr
+    forEachBatch(INPUT_IT first, INPUT_IT last, FUNC&& func);
+    
+    /// @brief Same as above but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class OTHER_RET = int, class INPUT_IT, class FUNC,
+              class = Traits::IsNotStdFunction<FUNC, Functions::ForEachFunc<OTHER_RET, INPUT_IT>>>
+    typename ICoroContext<std::vector<std::vector<OTHER_RET>>>::Ptr
+    forEachBatch(INPUT_IT first, size_t num, FUNC&& func);
+    
+    /// @brief Same as the self-balancing forEachBatch() but 'func' is taken by its own type.
+    template <class OTHER_RET = int, class INPUT_IT, class FUNC,
+              class = Traits::IsInputIterator<INPUT_IT>,
+              class = Traits::IsNotStdFunction<FUNC, Functions::ForEachFunc<OTHER_RET, INPUT_IT>>>
+    typename ICoroContext<std::vector<std::vector<OTHER_RET>>>::Ptr
+    forEachBatch(INPUT_IT first, INPUT_IT last, FUNC&& func, GrainSize grain);
+    
+    /// @brief Same as above but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class OTHER_RET = int, class INPUT_IT, class FUNC,
+              class = Traits::IsNotStdFunction<FUNC, Functions::ForEachFunc<OTHER_RET, INPUT_IT>>>
+    typename ICoroContext<std::vector<std::vector<OTHER_RET>>>::Ptr
+    forEachBatch(INPUT_IT first, size_t num, FUNC&& func, GrainSize grain);
+    
+    /// @brief Data-parallel version of forEachBatch() for contiguous ranges. The input is cut into a few
+    ///        chunks per coroutine thread and 'kernel' is called once per chunk with a view of its input
+    ///        elements and a view of the matching output elements, so that its inner loop can be vectorized.
+    /// @tparam KERNEL A callable of signature 'void(Span<const INPUT_TYPE>, Span<OUTPUT_TYPE>)' which sets
+    ///         output[i] for each input[i]. It is copied once and shared by all the chunks.
+    /// @oaram[in] first Pointer to the first input element.
+    /// @oaram[in] num Number of input elements.
+    /// @oaram[in] out Pointer to the preallocated output range, which must hold at least 'num' elements.
+    /// @return A context which completes once all the chunks are done. If 'kernel' throws, the first
+    ///         exception is rethrown by get() after all the chunks have stopped.
+    /// @note Chunk boundaries fall on multiples of 64 bytes from 'first' and from 'out', so every chunk
+    ///       starts on a vector boundary when both ranges are aligned. Only the last chunk may end
+    ///       with a partial vector. Both ranges must stay valid until the returned context completes.
+    template <class INPUT_TYPE, class OUTPUT_TYPE, class KERNEL>
+    std::shared_ptr<ICoroContext<int>>
+    forEachKernel(const INPUT_TYPE* first, size_t num, OUTPUT_TYPE* out, KERNEL&& kernel);
+    
+    /// @brief Same as above but the output is allocated up front and returned.
+    /// @tparam OUTPUT_TYPE The output element type, which must be default constructible.
+    template <class OUTPUT_TYPE, class INPUT_TYPE, class KERNEL>
+    typename ICoroContext<std::vector<OUTPUT_TYPE>>::Ptr
+    forEachKernel(const INPUT_TYPE* first, size_t num, KERNEL&& kernel);
+    
     /// @brief Implementation of map-reduce functionality.
     /// @tparam KEY The KEY type used for mapping and reducing.
     /// @tparam MAPPED_TYPE The output type after a map operation.
@@ -465,6 +786,236 @@ struct ICoroContext : public ICoroContextBase
                    size_t num,
                    Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
                    Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
+    
+    /// @brief Same as mapReduceBatch() but the mapper and the reducer are taken by their own type instead of
+    ///        being wrapped in a std::function, so that they can be inlined into the loop running each batch.
+    /// @note Selected when neither function is already the std::function taken by the overloads above.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class INPUT_IT,
+              class MAPPER,
+              class REDUCER,
+              class = Traits::IsInputIterator<INPUT_IT>,
+              class = Traits::IsNotStdFunction<MAPPER, Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>>,
+              class = Traits::IsNotStdFunction<REDUCER, Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>>>
+    typename ICoroContext<std::map<KEY, REDUCED_TYPE>>::Ptr
+    mapReduceBatch(INPUT_IT first,
+                   INPUT_IT last,
+                   MAPPER&& mapper,
+                   REDUCER&& reducer);
+    
+    /// @brief Same as above but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class INPUT_IT,
+              class MAPPER,
+              class REDUCER,
+              class = Traits::IsNotStdFunction<MAPPER, Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>>,
+              class = Traits::IsNotStdFunction<REDUCER, Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>>>
+    typename ICoroContext<std::map<KEY, REDUCED_TYPE>>::Ptr
+    mapReduceBatch(INPUT_IT first,
+                   size_t num,
+                   MAPPER&& mapper,
+                   REDUCER&& reducer);
+    
+    /// @brief This version of mapReduce() shuffles the mapped values in parallel. The input is split
+    ///        among the coroutine threads and each mapper coroutine scatters its pairs into one hash
+    ///        partition per thread. Each reducer coroutine then merges and reduces a single partition.
+    /// @tparam OUTPUT The container holding the reduced values. Any associative container of
+    ///         'std::pair<const KEY, REDUCED_TYPE>' (e.g. std::map for ordered keys) or a flat
+    ///         'std::vector<std::pair<KEY, REDUCED_TYPE>>' in no particular order.
+    /// @note KEY must be hashable with std::hash. Use this function when the number of mapped
+    ///       pairs is large since it avoids gathering them in a single ordered map.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class OUTPUT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT_IT,
+              class = Traits::IsInputIterator<INPUT_IT>>
+    typename ICoroContext<OUTPUT>::Ptr
+    mapReducePartitioned(INPUT_IT first,
+                         INPUT_IT last,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
+    
+    /// @brief Same as mapReducePartitioned() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class OUTPUT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT_IT>
+    typename ICoroContext<OUTPUT>::Ptr
+    mapReducePartitioned(INPUT_IT first,
+                         size_t num,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
+    
+    /// @brief Same as mapReducePartitioned() with a combiner which pre-aggregates the values of a key
+    ///        inside each mapper coroutine, before the shuffle. The reducer then receives at most one
+    ///        value per mapper coroutine for each key.
+    /// @param[in] combiner Associative function merging two mapped values of the same key.
+    /// @note Use a combiner when the reduction is associative, e.g. counts or sums.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class OUTPUT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT_IT,
+              class = Traits::IsInputIterator<INPUT_IT>>
+    typename ICoroContext<OUTPUT>::Ptr
+    mapReducePartitioned(INPUT_IT first,
+                         INPUT_IT last,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::CombineFunc<MAPPED_TYPE> combiner,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
+    
+    /// @brief Same as mapReducePartitioned() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class OUTPUT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT_IT>
+    typename ICoroContext<OUTPUT>::Ptr
+    mapReducePartitioned(INPUT_IT first,
+                         size_t num,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::CombineFunc<MAPPED_TYPE> combiner,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
+    
+    /// @brief Streaming version of mapReduce() which consumes a buffered future instead of a range.
+    ///        Values are pulled as they are produced, mapped and folded into their key right away
+    ///        so memory is bounded by the number of distinct keys rather than by the input volume.
+    /// @tparam OUTPUT The map holding the reduced values. Must provide operator[], e.g. std::map.
+    /// @param[in] input Buffered future to pull the input values from, typically obtained from a
+    ///            Promise<Buffer<INPUT>>. The stream ends when the producer closes the buffer.
+    /// @param[in] mapper The mapper function having the signature
+    ///            'std::vector<std::pair<KEY,MAPPED_TYPE>>(const INPUT&)'.
+    /// @param[in] reducer Folds a mapped value into the reduced value of its key. The reduced value
+    ///            is default-constructed the first time a key is seen in a window.
+    /// @param[in] windowSize Number of input values per window. A reduced map is pushed into the
+    ///            returned buffer for every full window and for the last partial one. If zero, a
+    ///            single map is pushed once the input buffer is closed.
+    /// @return A buffered future to the reduced maps. The buffer is closed after the last one.
+    /// @note The input future must not be pulled from elsewhere while the stream is consumed.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class OUTPUT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT>
+    typename ICoroContext<Buffer<OUTPUT>>::Ptr
+    mapReduceStream(std::shared_ptr<ICoroFuture<Buffer<INPUT>>> input,
+                    Functions::StreamMapFunc<KEY, MAPPED_TYPE, INPUT> mapper,
+                    Functions::FoldFunc<REDUCED_TYPE, MAPPED_TYPE> reducer,
+                    size_t windowSize = 0);
+    
+    /// @brief Reduces the range [first,last) in parallel. Each coroutine thread folds a slice of the range
+    ///        into a partial result and the partial results are then combined pairwise.
+    /// @tparam RET The type of the result.
+    /// @param[in] first The first element in the range.
+    /// @param[in] last The last element in the range (exclusive).
+    /// @param[in] init The initial value, combined once with the reduced range.
+    /// @param[in] op Associative binary operation. Operands are combined in range order so 'op'
+    ///            does not need to be commutative.
+    /// @return The reduced value.
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename ICoroContext<OTHER_RET>::Ptr
+    reduce(INPUT_IT first,
+           INPUT_IT last,
+           OTHER_RET init,
+           Functions::BinaryFunc<OTHER_RET> op);
+    
+    /// @brief Same as reduce() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class OTHER_RET, class INPUT_IT>
+    typename ICoroContext<OTHER_RET>::Ptr
+    reduce(INPUT_IT first,
+           size_t num,
+           OTHER_RET init,
+           Functions::BinaryFunc<OTHER_RET> op);
+    
+    /// @brief Same as reduce() but applies 'transform' to every element before reducing it. The transformed
+    ///        values are folded on the fly and never materialized.
+    /// @param[in] reduceOp Associative binary operation.
+    /// @param[in] transform Unary function applied to every element.
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename ICoroContext<OTHER_RET>::Ptr
+    transformReduce(INPUT_IT first,
+                    INPUT_IT last,
+                    OTHER_RET init,
+                    Functions::BinaryFunc<OTHER_RET> reduceOp,
+                    Functions::ForEachFunc<OTHER_RET, INPUT_IT> transform);
+    
+    /// @brief Same as transformReduce() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class OTHER_RET, class INPUT_IT>
+    typename ICoroContext<OTHER_RET>::Ptr
+    transformReduce(INPUT_IT first,
+                    size_t num,
+                    OTHER_RET init,
+                    Functions::BinaryFunc<OTHER_RET> reduceOp,
+                    Functions::ForEachFunc<OTHER_RET, INPUT_IT> transform);
+    
+    /// @brief Computes the inclusive prefix scan of the range [first,last) in parallel. The i-th output is the
+    ///        combination of the elements 0 to i.
+    /// @param[in] op Associative binary operation.
+    /// @return A vector with one value per element, in input order.
+    /// @note The range is read twice: once to compute the total of each slice and once to write the output.
+    ///       RET must be default constructible.
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename ICoroContext<std::vector<OTHER_RET>>::Ptr
+    inclusiveScan(INPUT_IT first,
+                  INPUT_IT last,
+                  Functions::BinaryFunc<OTHER_RET> op);
+    
+    /// @brief Same as inclusiveScan() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class OTHER_RET, class INPUT_IT>
+    typename ICoroContext<std::vector<OTHER_RET>>::Ptr
+    inclusiveScan(INPUT_IT first,
+                  size_t num,
+                  Functions::BinaryFunc<OTHER_RET> op);
+    
+    /// @brief Same as inclusiveScan() except that the i-th output is the combination of 'init' with the
+    ///        elements 0 to i-1 (i.e. the i-th element is excluded).
+    /// @param[in] init The first output value.
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename ICoroContext<std::vector<OTHER_RET>>::Ptr
+    exclusiveScan(INPUT_IT first,
+                  INPUT_IT last,
+                  OTHER_RET init,
+                  Functions::BinaryFunc<OTHER_RET> op);
+    
+    /// @brief Same as exclusiveScan() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class OTHER_RET, class INPUT_IT>
+    typename ICoroContext<std::vector<OTHER_RET>>::Ptr
+    exclusiveScan(INPUT_IT first,
+                  size_t num,
+                  OTHER_RET init,
+                  Functions::BinaryFunc<OTHER_RET> op);
+    
+    /// @brief Sorts the range [first,last) in parallel. Each coroutine thread sorts a slice of the range
+    ///        and the sorted slices are then merged pairwise, in parallel, until one run is left.
+    /// @tparam RANDOM_IT A random access iterator.
+    /// @tparam COMPARE A strict weak ordering of signature 'bool(const T&, const T&)'.
+    /// @param[in] first The first element in the range.
+    /// @param[in] last The last element in the range (exclusive).
+    /// @param[in] compare The comparison function object.
+    /// @return A context which completes once the range is sorted. The range is sorted in place
+    ///         and must not be accessed until then.
+    /// @note Ranges shorter than a few thousand elements are sorted by a single coroutine.
+    template <class RANDOM_IT, class COMPARE = std::less<typename std::iterator_traits<RANDOM_IT>::value_type>>
+    std::shared_ptr<ICoroContext<int>>
+    sort(RANDOM_IT first, RANDOM_IT last, COMPARE compare = COMPARE());
+    
+    /// @brief Same as sort() but the order of equivalent elements is preserved.
+    template <class RANDOM_IT, class COMPARE = std::less<typename std::iterator_traits<RANDOM_IT>::value_type>>
+    std::shared_ptr<ICoroContext<int>>
+    stableSort(RANDOM_IT first, RANDOM_IT last, COMPARE compare = COMPARE());
 };
 
 template <class RET>
@@ -19,6 +19,7 @@
 #include <quantum/interface/quantum_icontext_base.h>
 #include <quantum/interface/quantum_icoro_future_base.h>
 #include <quantum/quantum_traits.h>
+#include <vector>
 
 namespace Bloomberg {
 namespace quantum {
@@ -61,6 +62,29 @@ struct ICoroFuture : public ICoroFutureBase
     /// @note Method available for buffered futures only. Blocks until one value is retrieved from the buffer.
     template <class BUF = T, class V = BufferValue<BUF>>
     V pull(ICoroSync::Ptr sync, bool& isBufferClosed);
+    
+    /// @brief Pull several values from the future buffer at once.
+    /// @tparam BUF Represents a class of type Buffer.
+    /// @tparam V The type of value contained in Buffer.
+    /// @param[in] sync Pointer to the coroutine synchronization object.
+    /// @param[out] values Container to which the pulled values are appended.
+    /// @param[in] maxCount Maximum number of values to pull.
+    /// @param[out] isBufferClosed Indicates if this buffer is closed and no more Pull operations are allowed on it.
+    /// @return The number of values pulled.
+    /// @note Method available for buffered futures only. Blocks until at least one value is retrieved from the buffer
+    ///       or until the buffer is closed.
+    template <class BUF = T, class V = BufferValue<BUF>>
+    size_t pullMany(ICoroSync::Ptr sync, std::vector<V>& values, size_t maxCount, bool& isBufferClosed);
+    
+    /// @brief Run a callback once the future is ready.
+    /// @tparam FUNC Callable object type with signature 'void f()'.
+    /// @param[in] func Callable object. It is invoked inline by the producer which makes the future ready
+    ///                 (i.e. sets its value or exception, or breaks its promise), or immediately if the future is
+    ///                 already ready. The callback must be short and must neither block nor throw.
+    /// @note No coroutine or thread is used to wait. Use Dispatcher::postOnReady() to run the callback on an IO queue.
+    ///       Not available for buffered futures.
+    template <class FUNC>
+    void onReady(FUNC&& func);
 };
 
 template <class T>
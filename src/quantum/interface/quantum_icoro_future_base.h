@@ -20,6 +20,7 @@
 #include <future>
 #include <chrono>
 #include <quantum/interface/quantum_icoro_sync.h>
+#include <quantum/interface/quantum_ifuture_callback.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -52,6 +53,19 @@ struct ICoroFutureBase
     /// @note Blocks until the value is ready, until 'timeMs' duration expires or until an exception is thrown.
     virtual std::future_status waitFor(ICoroSync::Ptr sync,
                                        std::chrono::milliseconds timeMs) const = 0;
+    
+    /// @brief Register a callback invoked once the future is ready.
+    /// @param[in] callback The callback object.
+    /// @param[in] index Value passed back to IFutureCallback::onReady().
+    /// @note The callback is invoked immediately if the future is already ready. For buffered futures the callback
+    ///       is invoked each time data is pushed, when the buffer is closed and when the promise fails, until it is
+    ///       removed. It is also invoked immediately if data can already be pulled.
+    virtual void addCallback(IFutureCallback::Ptr callback, size_t index) const = 0;
+    
+    /// @brief Unregister a callback.
+    /// @param[in] callback The callback object passed to addCallback().
+    /// @note The callback may still be running in another thread when this returns.
+    virtual void removeCallback(const IFutureCallback::Ptr& callback) const = 0;
 };
 
 using ICoroFutureBasePtr = ICoroFutureBase::Ptr;
@@ -50,13 +50,33 @@ struct ICoroSync
     /// @brief Explicitly yields this coroutine context.
     virtual void yield() = 0;
     
+    /// @brief Yields this coroutine context and hands control directly to another coroutine.
+    /// @param[in] other Context of the coroutine which should run next.
+    /// @note The other coroutine runs next only if it is runnable and belongs to the same queue, otherwise
+    ///       this is equivalent to yield(). Coroutines signalled while this one was running still resume
+    ///       first if Configuration::setResumeSignalledCoroutinesFirst() is set.
+    virtual void yieldTo(Ptr other) = 0;
+    
     /// @brief Accessor to the underlying synchronization variable.
     /// @return An atomic integer used to synchronize with other primitive types.
     virtual std::atomic_int& signal() = 0;
     
+    /// @brief Reschedules the coroutine associated with this context once its signal has been set.
+    /// @note Blocked coroutines are parked by their queue and do not run until woken up.
+    virtual void wakeUp() = 0;
+    
+    /// @brief Resume the coroutine associated with this context at the specified time even if its signal
+    ///        has not been set.
+    /// @param[in] time Absolute point in time.
+    /// @note Used by timed waits so that a blocked coroutine does not have to poll the clock.
+    virtual void setWakeUpTime(std::chrono::steady_clock::time_point time) = 0;
+    
+    /// @brief Cancel a wake-up time previously set via setWakeUpTime().
+    virtual void clearWakeUpTime() = 0;
+    
     /// @brief Sleeps the coroutine associated with this context for 'timeMs' milliseconds.
     /// @param[in] timeMs Time to sleep.
-    /// @note This method repeatedly yields the coroutine until the timer has expired.
+    /// @note The coroutine is parked by its queue until the timer has expired.
     virtual void sleep(std::chrono::milliseconds timeMs) = 0;
 };
 
@@ -0,0 +1,49 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_IFUTURE_CALLBACK_H
+#define QUANTUM_IFUTURE_CALLBACK_H
+
+#include <memory>
+#include <cstddef>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                 interface IFutureCallback
+//==============================================================================================
+/// @interface IFutureCallback
+/// @brief Receives a notification when a future becomes ready.
+/// @note A future is ready once a value or an exception has been set, or when its promise is broken.
+struct IFutureCallback
+{
+    using Ptr = std::shared_ptr<IFutureCallback>;
+    
+    /// @brief Virtual destructor.
+    virtual ~IFutureCallback() = default;
+    
+    /// @brief Called once the future is ready.
+    /// @param[in] index The index passed when the callback was registered.
+    /// @note Runs in the context of the producer which made the future ready, or in the context
+    ///       of the caller registering the callback if the future is already ready. Must not block.
+    virtual void onReady(size_t index) = 0;
+};
+
+using IFutureCallbackPtr = IFutureCallback::Ptr;
+
+}}
+
+#endif //QUANTUM_IFUTURE_CALLBACK_H
@@ -36,6 +36,13 @@ struct IQueue : public ITerminate
     using Ptr = std::shared_ptr<IQueue>;
     enum class QueueType : int { Coro, IO, All };
     enum class QueueId : int { Any = -1, Same = -2, All = -3 };
+    enum class Priority : int { Critical,   ///< Always served first
+                                High,       ///< Same as posting with 'isHighPriority' set to true
+                                Normal,     ///< Default priority
+                                Low };      ///< Background work
+    
+    //Members written by different threads are kept at least this far apart to avoid false sharing
+    static constexpr size_t cacheLineSize = 64;
     
     //Interface methods
     virtual void pinToCore(int coreId) = 0;
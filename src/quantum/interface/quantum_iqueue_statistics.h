@@ -17,6 +17,9 @@
 #define QUANTUM_IQUEUE_STATISTICS_H
 
 #include <ostream>
+#include <chrono>
+#include <quantum/quantum_latency_histogram.h>
+#include <quantum/quantum_perf_counters.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -85,6 +88,116 @@ struct IQueueStatistics
     /// @brief Increment this counter.
     virtual void incHighPriorityCount() = 0;
     
+    /// @brief Count of all coroutines which were stolen by this queue from a sibling queue.
+    /// @return Counter value.
+    /// @note Only applicable when coroutine work stealing is enabled.
+    virtual size_t stolenCount() const = 0;
+    
+    /// @brief Increment this counter.
+    virtual void incStolenCount() = 0;
+    
+    /// @brief Count of all coroutines which were migrated to this queue by an overloaded sibling queue.
+    /// @return Counter value.
+    /// @note Only applicable when coroutine migration is enabled.
+    virtual size_t migratedCount() const = 0;
+    
+    /// @brief Increment this counter.
+    virtual void incMigratedCount() = 0;
+    
+    /// @brief Count of all tasks which were discarded by this queue before running because they were cancelled.
+    /// @return Counter value.
+    virtual size_t cancelledCount() const = 0;
+    
+    /// @brief Increment this counter.
+    virtual void incCancelledCount() = 0;
+    
+    /// @brief Count of all the IO tasks which were discarded because their deadline had passed before they could run.
+    /// @return Counter value.
+    virtual size_t expiredCount() const = 0;
+    
+    /// @brief Increment this counter.
+    virtual void incExpiredCount() = 0;
+    
+    /// @brief Count of all the times this queue reached its high watermark.
+    /// @return Counter value.
+    /// @note Only applicable when a queue high watermark is configured. See Configuration::setQueueHighWatermark().
+    virtual size_t highWatermarkCount() const = 0;
+    
+    /// @brief Increment this counter.
+    virtual void incHighWatermarkCount() = 0;
+    
+    /// @brief Count of all the posts which were rejected by the admission control of this queue.
+    /// @return Counter value.
+    /// @note Rejected posts to the 'Any' queue are counted by the first queue they could have been sent to.
+    virtual size_t rejectedCount() const = 0;
+    
+    /// @brief Increment this counter.
+    virtual void incRejectedCount() = 0;
+    
+    /// @brief Number of buckets in the coroutine slice time histogram.
+    static constexpr size_t numSliceBuckets = 16;
+    
+    /// @brief Count of all coroutine time slices (resumes) which were timed on this queue.
+    /// @return Counter value.
+    /// @note Only applicable when slice statistics are enabled or a long slice threshold is set.
+    virtual size_t sliceCount() const = 0;
+    
+    /// @brief Total time spent running coroutines on this queue.
+    /// @return Accumulated time.
+    virtual std::chrono::nanoseconds totalSliceTime() const = 0;
+    
+    /// @brief Longest single coroutine time slice observed on this queue.
+    /// @return Slice duration.
+    virtual std::chrono::nanoseconds maxSliceTime() const = 0;
+    
+    /// @brief Count of coroutine time slices falling in a histogram bucket.
+    /// @param[in] bucket Bucket index in the range [0, numSliceBuckets). Bucket 0 counts slices shorter than 1us,
+    ///                   bucket 'i' counts slices in the range [2^(i-1), 2^i) us and the last bucket counts all
+    ///                   longer slices.
+    /// @return Counter value or 0 if the bucket is out of range.
+    virtual size_t sliceHistogram(size_t bucket) const = 0;
+    
+    /// @brief Record the duration of a single coroutine time slice.
+    /// @param[in] sliceTime Time the coroutine ran before yielding or completing.
+    virtual void addSliceTime(std::chrono::nanoseconds sliceTime) = 0;
+    
+    /// @brief Count of all coroutine time slices which exceeded the configured long slice threshold.
+    /// @return Counter value.
+    virtual size_t longSliceCount() const = 0;
+    
+    /// @brief Increment this counter.
+    virtual void incLongSliceCount() = 0;
+    
+    /// @brief Histogram of the time tasks waited in this queue between being posted and starting to run.
+    /// @note Only applicable when latency statistics are enabled. Times are recorded by the queue which runs the task.
+    virtual const LatencyHistogram& waitTimeHistogram() const = 0;
+    
+    /// @brief Record the time a task waited before starting to run.
+    virtual void addWaitTime(std::chrono::nanoseconds waitTime) = 0;
+    
+    /// @brief Histogram of the time between a task starting to run and completing.
+    /// @note Only applicable when latency statistics are enabled. For coroutines this includes the
+    ///       time spent yielded or waiting. See the slice statistics for the actual run time.
+    virtual const LatencyHistogram& runTimeHistogram() const = 0;
+    
+    /// @brief Record the time a task took to complete once started.
+    virtual void addRunTime(std::chrono::nanoseconds runTime) = 0;
+    
+    /// @brief Histogram of the time between a task being posted and completing.
+    /// @note Only applicable when latency statistics are enabled.
+    virtual const LatencyHistogram& endToEndTimeHistogram() const = 0;
+    
+    /// @brief Record the time a task took to complete once posted.
+    virtual void addEndToEndTime(std::chrono::nanoseconds endToEndTime) = 0;
+    
+    /// @brief Hardware event count of the thread running this queue.
+    /// @return Counter value since the thread started or 0 if the event is not available.
+    /// @note Only applicable when hardware counter statistics are enabled.
+    virtual uint64_t perfCount(PerfEvent event) const = 0;
+    
+    /// @brief Set this counter.
+    virtual void setPerfCount(PerfEvent event, uint64_t count) = 0;
+    
     /// @brief Print to std::cout the value of all internal counters.
     /// @param[in,out] out Output stream.
     virtual void print(std::ostream& out) const = 0;
@@ -60,6 +60,8 @@ struct ITask : public ITerminate
     virtual bool isBlocked() const = 0;
     
     virtual bool isHighPriority() const = 0;
+    
+    virtual bool isCancelled() const = 0;
 };
 
 using ITaskPtr = ITask::Ptr;
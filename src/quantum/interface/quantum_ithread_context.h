@@ -19,6 +19,7 @@
 #include <future>
 #include <chrono>
 #include <quantum/quantum_traits.h>
+#include <quantum/quantum_stack_traits.h>
 #include <quantum/interface/quantum_ithread_context_base.h>
 
 namespace Bloomberg {
@@ -27,6 +28,9 @@ namespace quantum {
 template <class RET>
 class Context;
 
+template <class T>
+class SharedFuture;
+
 //==============================================================================================
 //                                      interface IThreadContext
 //==============================================================================================
@@ -83,6 +87,11 @@ struct IThreadContext : public IThreadContextBase
     ///       not invalidate the future and as such may be read again.
     virtual const RET& getRef() const = 0;
     
+    /// @brief Get a shared future for the value associated with this context.
+    /// @return A copyable handle which gives any number of threads or coroutines a reference to the value.
+    /// @note Does not block. See SharedFuture for details.
+    SharedFuture<RET> getSharedFuture() const;
+    
     /// @brief Get the future value from the 'num-th' continuation context.
     /// @details Allowed range for num is [-1, total_continuations). -1 is equivalent of calling get() or
     ///          getAt(total_continuations-1) on the last context in the chain (i.e. the context which is returned
@@ -124,6 +133,15 @@ struct IThreadContext : public IThreadContextBase
     template <class BUF = RET, class V = BufferValue<BUF>>
     void push(V &&value);
     
+    /// @brief Push several values into the promise buffer at once.
+    /// @tparam BUF Represents a class of type Buffer.
+    /// @tparam V The type of value contained in Buffer.
+    /// @param[in] values Values to push at the end of the buffer. They are moved from.
+    /// @note Method available for buffered futures only. Never blocks. Once the buffer is closed, no more Push
+    ///       operations are allowed.
+    template <class BUF = RET, class V = BufferValue<BUF>>
+    void pushMany(std::vector<V> values);
+    
     /// @brief Pull a single value from the future buffer.
     /// @tparam BUF Represents a class of type Buffer.
     /// @tparam V The type of value contained in Buffer.
@@ -133,6 +151,18 @@ struct IThreadContext : public IThreadContextBase
     template <class BUF = RET, class V = BufferValue<BUF>>
     V pull(bool& isBufferClosed);
     
+    /// @brief Pull several values from the future buffer at once.
+    /// @tparam BUF Represents a class of type Buffer.
+    /// @tparam V The type of value contained in Buffer.
+    /// @param[out] values Container to which the pulled values are appended.
+    /// @param[in] maxCount Maximum number of values to pull.
+    /// @param[out] isBufferClosed Indicates if this buffer is closed and no more Pull operations are allowed on it.
+    /// @return The number of values pulled.
+    /// @note Method available for buffered futures only. Blocks until at least one value is retrieved from the buffer
+    ///       or until the buffer is closed.
+    template <class BUF = RET, class V = BufferValue<BUF>>
+    size_t pullMany(std::vector<V>& values, size_t maxCount, bool& isBufferClosed);
+    
     /// @brief Close a promise buffer.
     /// @tparam BUF Represents a class of type Buffer.
     /// @note Once closed no more Pushes can be made into the buffer. The corresponding future can still Pull values until
@@ -184,6 +214,12 @@ struct IThreadContext : public IThreadContextBase
     typename IThreadContext<OTHER_RET>::Ptr
     then(FUNC&& func, ARGS&&... args);
     
+    /// @brief Same as above but the coroutine stack is taken from a specific size class.
+    /// @param[in] stackSize Size class of the coroutine stack. See StackSizeClass.
+    template <class OTHER_RET = int, class FUNC, class ... ARGS>
+    typename IThreadContext<OTHER_RET>::Ptr
+    then(StackSizeClass stackSize, FUNC&& func, ARGS&&... args);
+    
     /// @brief Posts a function to run asynchronously. This is the error handler for a continuation chain and acts as
     ///        as a 'catch' clause.
     /// @details This function is optional for the continuation chain and may be called at most once. If called,
@@ -18,6 +18,7 @@
 
 #include <quantum/interface/quantum_icontext_base.h>
 #include <quantum/interface/quantum_ipromise_base.h>
+#include <vector>
 #include <quantum/interface/quantum_ifuture.h>
 
 namespace Bloomberg {
@@ -64,6 +65,15 @@ struct IThreadPromise : public Traits::DerivedFrom<PROMISE<T>,
     template <class BUF = T, class V = BufferValue<BUF>>
     void push(V &&value);
     
+    /// @brief Push several values into the promise buffer at once.
+    /// @tparam BUF Represents a class of type Buffer.
+    /// @tparam V The type of value contained in Buffer.
+    /// @param[in] values Values to push at the end of the buffer. They are moved from.
+    /// @note Method available for buffered futures only. Once the buffer is closed, no more Push
+    ///       operations are allowed.
+    template <class BUF = T, class V = BufferValue<BUF>>
+    void pushMany(std::vector<V> values);
+    
     /// @brief Close a promise buffer.
     /// @tparam BUF Represents a class of type Buffer.
     /// @note Once closed no more Pushes can be made into the buffer. The corresponding future can still Pull values until
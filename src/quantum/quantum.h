@@ -26,6 +26,7 @@
 #include <quantum/interface/quantum_icoro_promise.h>
 #include <quantum/interface/quantum_icoro_sync.h>
 #include <quantum/interface/quantum_ifuture.h>
+#include <quantum/interface/quantum_ifuture_callback.h>
 #include <quantum/interface/quantum_ipromise.h>
 #include <quantum/interface/quantum_ipromise_base.h>
 #include <quantum/interface/quantum_iqueue.h>
@@ -39,36 +40,70 @@
 #include <quantum/interface/quantum_ithread_future.h>
 #include <quantum/interface/quantum_ithread_future_base.h>
 #include <quantum/interface/quantum_ithread_promise.h>
+#include <quantum/quantum_advisor.h>
 #include <quantum/quantum_allocator.h>
+#include <quantum/quantum_allocator_statistics.h>
 #include <quantum/quantum_allocator_traits.h>
+#include <quantum/quantum_barrier.h>
 #include <quantum/quantum_buffer.h>
+#include <quantum/quantum_cancellation_token.h>
 #include <quantum/quantum_capture.h>
+#include <quantum/quantum_channel.h>
+#include <quantum/quantum_clock.h>
 #include <quantum/quantum_condition_variable.h>
 #include <quantum/quantum_configuration.h>
 #include <quantum/quantum_context.h>
 #include <quantum/quantum_contiguous_pool_manager.h>
+#include <quantum/quantum_coro_local.h>
 #include <quantum/quantum_coroutine_pool_allocator.h>
 #include <quantum/quantum_dispatcher.h>
 #include <quantum/quantum_dispatcher_core.h>
 #include <quantum/quantum_functions.h>
+#include <quantum/quantum_futex.h>
 #include <quantum/quantum_future.h>
+#include <quantum/quantum_future_callback.h>
 #include <quantum/quantum_future_joiner.h>
 #include <quantum/quantum_future_state.h>
+#include <quantum/quantum_generator.h>
+#include <quantum/quantum_grain_size.h>
 #include <quantum/quantum_io_queue.h>
 #include <quantum/quantum_io_task.h>
+#include <quantum/quantum_json.h>
+#include <quantum/quantum_latch.h>
+#include <quantum/quantum_latency_histogram.h>
 #include <quantum/quantum_macros.h>
+#include <quantum/quantum_metrics_snapshot.h>
 #include <quantum/quantum_mutex.h>
+#include <quantum/quantum_perf_counters.h>
+#include <quantum/quantum_pipeline.h>
+#include <quantum/quantum_pool_thread_cache.h>
+#include <quantum/quantum_profile.h>
 #include <quantum/quantum_promise.h>
 #include <quantum/quantum_queue_statistics.h>
+#include <quantum/quantum_reactor.h>
+#include <quantum/quantum_scheduler_counters.h>
+#include <quantum/quantum_select.h>
+#include <quantum/quantum_semaphore.h>
+#include <quantum/quantum_sequencer.h>
+#include <quantum/quantum_shared_future.h>
+#include <quantum/quantum_shared_mutex.h>
 #include <quantum/quantum_shared_state.h>
+#include <quantum/quantum_simulation.h>
+#include <quantum/quantum_span.h>
 #include <quantum/quantum_spinlock.h>
 #include <quantum/quantum_stack_allocator.h>
 #include <quantum/quantum_stack_traits.h>
 #include <quantum/quantum_task.h>
+#include <quantum/quantum_task_counter.h>
+#include <quantum/quantum_task_list.h>
 #include <quantum/quantum_task_queue.h>
 #include <quantum/quantum_thread_traits.h>
+#include <quantum/quantum_ticket_spinlock.h>
+#include <quantum/quantum_timer_queue.h>
+#include <quantum/quantum_tracer.h>
 #include <quantum/quantum_traits.h>
 #include <quantum/quantum_util.h>
+#include <quantum/quantum_when.h>
 #include <quantum/quantum_yielding_thread.h>
 
 #endif //QUANTUM_H
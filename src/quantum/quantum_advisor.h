@@ -0,0 +1,123 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_ADVISOR_H
+#define QUANTUM_ADVISOR_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <quantum/quantum_allocator_statistics.h>
+#include <quantum/quantum_configuration.h>
+#include <quantum/quantum_dispatcher.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class Advisor
+//==============================================================================================
+/// @class Advisor.
+/// @brief Opt-in tuning advisor which watches the statistics of a running dispatcher and recommends
+///        configuration values.
+/// @details Each call to sample() records the runnable and blocked coroutines, the IO backlog, the queue
+///          wait times and the pool usage. The recommendations are derived from the averages over all the
+///          samples:
+///          - numCoroutineThreads when the coroutine queues hold more than 2 runnable coroutines per thread
+///            and tasks wait more than 1ms (p99) before running, up to the number of cores.
+///          - maxNumIoThreads when the IO queues hold more than 2 pending tasks per IO thread. This one
+///            can be applied to the running dispatcher with apply().
+///          - ioThreadGrowthBacklog when the IO pool is elastic and IO tasks wait more than 1ms (p50) while
+///            the shared IO queue stays below the backlog which adds an extra thread.
+///          - poolAllocSizes when a pool fell back to the heap, from the peak number of blocks in use.
+/// @note Wait times are only known if Configuration::setLatencyStatistics() is set. Pool sizes are
+///       process-wide and only take effect in a new process.
+class Advisor
+{
+public:
+    /// @brief A recommended configuration value.
+    struct Recommendation
+    {
+        std::string _setting; //key in the Configuration JSON schema, e.g. "maxNumIoThreads" or "poolAllocSizes.task"
+        size_t      _current; //value in use. Durations are in the unit of the setting.
+        size_t      _recommended;
+        bool        _isLive; //can be applied to the running dispatcher with apply()
+        std::string _reason;
+    };
+    
+    /// @brief Constructor.
+    /// @param[in] dispatcher The dispatcher to watch. Must outlive this object.
+    /// @param[in] config The configuration the dispatcher was created with.
+    Advisor(Dispatcher& dispatcher, Configuration config);
+    
+    /// @brief Record the current statistics of the dispatcher.
+    /// @note Call periodically, e.g. every second from a timer or from the metrics exporter. Thread safe.
+    void sample();
+    
+    /// @brief Number of samples recorded since construction or since the last call to reset().
+    size_t numSamples() const;
+    
+    /// @brief Discard all the samples, e.g. after applying recommendations to observe their effect.
+    void reset();
+    
+    /// @brief Recommendations derived from the samples recorded so far.
+    /// @return The settings worth changing, or an empty vector if the current values look adequate.
+    std::vector<Recommendation> recommendations() const;
+    
+    /// @brief The configuration given to the constructor with all the recommendations applied.
+    Configuration recommendedConfiguration() const;
+    
+    /// @brief Apply the live recommendations to the running dispatcher.
+    /// @return The number of settings changed.
+    size_t apply();
+    
+    void print(std::ostream& out) const;
+    
+private:
+    std::vector<Recommendation> recommendationsImpl() const; //called with the mutex held
+    static void applyTo(Configuration& config, const Recommendation& recommendation);
+    static size_t poolAllocSize(const Configuration& config, Configuration::PoolType pool);
+    static const PoolStatistics& poolStats(const AllocatorStatistics& stats, Configuration::PoolType pool);
+    static const char* poolName(Configuration::PoolType pool);
+    
+    //Members
+    Dispatcher&                 _dispatcher;
+    Configuration               _config; //updated by apply()
+    mutable std::mutex          _mutex; //protects all the members below
+    size_t                      _numSamples;
+    double                      _sumRunnableCoroutines;
+    double                      _sumBlockedCoroutines;
+    double                      _sumCoroutines;
+    double                      _sumIoBacklog;
+    double                      _sumSharedIoBacklog;
+    std::chrono::nanoseconds    _coroWaitTimeP99;
+    std::chrono::nanoseconds    _ioWaitTimeP50;
+    AllocatorStatistics         _firstPools;
+    AllocatorStatistics         _lastPools;
+};
+
+std::ostream& operator<<(std::ostream& out, const Advisor& advisor);
+
+}}
+
+#include <quantum/impl/quantum_advisor_impl.h>
+
+#endif //QUANTUM_ADVISOR_H
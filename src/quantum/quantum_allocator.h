@@ -18,6 +18,7 @@
 
 #include <quantum/impl/quantum_stl_impl.h>
 #include <quantum/quantum_allocator_traits.h>
+#include <quantum/quantum_allocator_statistics.h>
 #include <quantum/quantum_stack_allocator.h>
 #include <quantum/quantum_heap_allocator.h>
 #include <quantum/quantum_coroutine_pool_allocator.h>
@@ -25,6 +26,8 @@
 #include <boost/coroutine2/pooled_fixedsize_stack.hpp>
 #include <boost/coroutine2/fixedsize_stack.hpp>
 #include <memory>
+#include <new>
+#include <type_traits>
 
 namespace Bloomberg {
 namespace quantum {
@@ -44,6 +47,7 @@ struct StlAllocator : public std::allocator<T>
 template <typename Traits>
 struct BoostAllocator : public boost::context::basic_fixedsize_stack<Traits>
 {
+    using boost::context::basic_fixedsize_stack<Traits>::basic_fixedsize_stack;
     typedef std::true_type default_constructor;
 };
 
@@ -53,17 +57,130 @@ struct BoostAllocator : public boost::context::basic_fixedsize_stack<Traits>
 template <typename AllocType>
 struct Allocator {
     template <typename A = AllocType>
-    static AllocType& instance(std::enable_if_t<!A::default_constructor::value, uint16_t> size) {
+    static AllocType& instance(std::enable_if_t<!A::default_constructor::value, AllocatorTraits::size_type> size) {
        static AllocType allocator(size);
        return allocator;
     }
     template <typename A = AllocType>
-    static AllocType& instance(std::enable_if_t<A::default_constructor::value, uint16_t> = 0) {
+    static AllocType& instance(std::enable_if_t<A::default_constructor::value, AllocatorTraits::size_type> = 0) {
        static AllocType allocator;
        return allocator;
     }
 };
 
+//==============================================================================================
+//                                 struct SharedBlock
+//==============================================================================================
+/// @struct SharedBlock.
+/// @brief Pool block large enough to hold an object of type T along with the std::shared_ptr control
+///        block (vtable pointer and reference counts) which std::allocate_shared places in front of it.
+/// @note The room reserved for the control block is checked at compile time by SharedAllocator.
+template <typename T>
+struct SharedBlock
+{
+    alignas(T) alignas(void*) char _storage[sizeof(T) + 4*sizeof(void*)];
+};
+
+//==============================================================================================
+//                                 struct SharedAllocator
+//==============================================================================================
+/// @struct SharedAllocator.
+/// @brief Allocator for std::allocate_shared. The object and its reference counts share a single
+///        block taken from POOL instead of an object block plus a separate heap-allocated control block.
+/// @tparam T The type to allocate.
+/// @tparam POOL Pool allocator whose blocks are SharedBlock<>, or void to allocate from the heap.
+/// @tparam SIZE Function returning a modifiable reference to the pool size (see AllocatorTraits).
+/// @note For internal use only. Classes with non-public constructors must befriend this allocator.
+template <typename T, typename POOL = void, AllocatorTraits::size_type&(*SIZE)() = nullptr>
+struct SharedAllocator
+{
+    typedef T value_type;
+    
+    template <typename U>
+    struct rebind
+    {
+        typedef SharedAllocator<U, POOL, SIZE> other;
+    };
+    
+    SharedAllocator() = default;
+    template <typename U>
+    SharedAllocator(const SharedAllocator<U, POOL, SIZE>&) {}
+    
+    T* allocate(size_t n) {
+        return allocateImpl(n, std::is_void<POOL>());
+    }
+    void deallocate(T* p, size_t n) {
+        deallocateImpl(p, n, std::is_void<POOL>());
+    }
+    template <typename U, typename... ARGS>
+    void construct(U* p, ARGS&&... args) {
+        ::new((void*)p) U(std::forward<ARGS>(args)...); //bypass class-specific operator new
+    }
+    template <typename U>
+    void destroy(U* p) {
+        p->~U();
+    }
+    template <typename U>
+    bool operator==(const SharedAllocator<U, POOL, SIZE>&) const { return true; }
+    template <typename U>
+    bool operator!=(const SharedAllocator<U, POOL, SIZE>&) const { return false; }
+    
+private:
+    T* allocateImpl(size_t n, std::true_type) {
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    T* allocateImpl(size_t n, std::false_type) {
+        using BlockType = typename POOL::value_type;
+        static_assert(sizeof(T) <= sizeof(BlockType), "Pool block cannot hold the object and its control block");
+        static_assert(alignof(T) <= alignof(BlockType), "Pool block is not sufficiently aligned");
+        if (n != 1) {
+            return allocateImpl(n, std::true_type());
+        }
+        return reinterpret_cast<T*>(Allocator<POOL>::instance(SIZE()).allocate(1));
+    }
+    void deallocateImpl(T* p, size_t, std::true_type) {
+        ::operator delete(p);
+    }
+    void deallocateImpl(T* p, size_t n, std::false_type) {
+        if (n != 1) {
+            return deallocateImpl(p, n, std::true_type());
+        }
+        Allocator<POOL>::instance(SIZE()).deallocate(reinterpret_cast<typename POOL::value_type*>(p), 1);
+    }
+};
+
+//==============================================================================================
+//                                 function poolStatistics
+//==============================================================================================
+/// @brief Returns the counters of a pool allocator or empty statistics for allocators which
+///        do not keep any (i.e. StlAllocator and BoostAllocator).
+template <typename AllocType>
+auto poolStatistics(const AllocType& allocator, int)->decltype(allocator.stats())
+{
+    return allocator.stats();
+}
+
+template <typename AllocType>
+PoolStatistics poolStatistics(const AllocType&, long)
+{
+    return PoolStatistics();
+}
+
+//==============================================================================================
+//                                   function poolWarmUp
+//==============================================================================================
+/// @brief Pre-faults the memory of a pool allocator. Does nothing for allocators without a pool.
+template <typename AllocType>
+auto poolWarmUp(AllocType& allocator, int)->decltype(allocator.warmUp())
+{
+    allocator.warmUp();
+}
+
+template <typename AllocType>
+void poolWarmUp(AllocType&, long)
+{
+}
+
 }
 }
 
@@ -0,0 +1,191 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_ALLOCATOR_STATISTICS_H
+#define QUANTUM_ALLOCATOR_STATISTICS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                 class StackUsageHistogram
+//==============================================================================================
+/// @class StackUsageHistogram.
+/// @brief Power-of-two histogram of the number of bytes used by coroutine stacks.
+/// @details Bucket 0 holds sizes below 2 bytes and bucket i holds sizes in [2^i, 2^(i+1)). Buckets are
+///          relaxed atomics so that the histogram can be read while stacks are being returned.
+class StackUsageHistogram
+{
+public:
+    /// @brief Total number of buckets.
+    static constexpr size_t numBuckets = 48;
+    
+    StackUsageHistogram();
+    
+    StackUsageHistogram(const StackUsageHistogram& other);
+    
+    StackUsageHistogram& operator=(const StackUsageHistogram& other);
+    
+    /// @brief Reset all the buckets to 0.
+    void reset();
+    
+    /// @brief Record the high-water mark of a stack.
+    /// @param[in] bytes Number of bytes used.
+    void add(size_t bytes);
+    
+    /// @brief Number of stacks measured.
+    size_t count() const;
+    
+    /// @brief Largest high-water mark recorded.
+    size_t max() const;
+    
+    /// @brief Get the size below which a percentage of the high-water marks fall.
+    /// @param[in] percent Percentage in the range [0, 100].
+    /// @return The upper bound of the bucket holding the percentile, capped to max(), or 0 if the histogram is empty.
+    size_t percentile(double percent) const;
+    
+    /// @brief Count of high-water marks falling in a bucket.
+    /// @param[in] bucket Bucket index in the range [0, numBuckets).
+    /// @return Counter value or 0 if the bucket is out of range.
+    size_t bucketCount(size_t bucket) const;
+    
+    /// @brief Index of the bucket in which a size falls.
+    static size_t bucketIndex(size_t bytes);
+    
+    /// @brief Print the count, p50, p99 and max values in bytes.
+    /// @param[in,out] out Output stream.
+    void print(std::ostream& out) const;
+    
+    StackUsageHistogram& operator+=(const StackUsageHistogram& rhs);
+    
+private:
+    std::array<std::atomic<size_t>, numBuckets> _buckets;
+    std::atomic<size_t>                         _count;
+    std::atomic<size_t>                         _max;
+};
+
+//==============================================================================================
+//                                   class PoolStatistics
+//==============================================================================================
+/// @class PoolStatistics.
+/// @brief Snapshot of the counters of a single object or coroutine stack pool.
+/// @note All the counters are 0 when the pool is replaced by the default (STL or boost) allocator.
+class PoolStatistics
+{
+public:
+    PoolStatistics();
+    
+    PoolStatistics(size_t capacity,
+                   size_t inUse,
+                   size_t peakInUse,
+                   size_t heapFallbackCount,
+                   size_t numSlabs,
+                   size_t contentionCount,
+                   const StackUsageHistogram& stackUsage = StackUsageHistogram());
+    
+    /// @brief Number of blocks in the initial buffer and in the grown slabs.
+    size_t capacity() const;
+    
+    /// @brief Number of blocks currently handed out, including the ones allocated from the heap.
+    size_t inUse() const;
+    
+    /// @brief Highest value of inUse() observed so far.
+    /// @note Sampled whenever a thread goes to the shared pool, so it may lag behind by up to the
+    ///       per-thread cache size (see PoolThreadCache) for each thread.
+    size_t peakInUse() const;
+    
+    /// @brief Total number of allocations which fell back to the heap because the pool was exhausted.
+    size_t heapFallbackCount() const;
+    
+    /// @brief Number of slabs the pool has grown by.
+    size_t numSlabs() const;
+    
+    /// @brief Number of times the pool spinlock was found taken.
+    /// @note Only counted if __QUANTUM_SPINLOCK_STATS is defined.
+    size_t contentionCount() const;
+    
+    /// @brief High-water marks of the coroutine stacks returned to the pool.
+    /// @note Only measured if AllocatorTraits::paintCoroStacks() is set. Empty for object pools.
+    const StackUsageHistogram& stackUsage() const;
+    
+    void print(std::ostream& out) const;
+    
+private:
+    size_t      _capacity;
+    size_t      _inUse;
+    size_t      _peakInUse;
+    size_t      _heapFallbackCount;
+    size_t      _numSlabs;
+    size_t      _contentionCount;
+    StackUsageHistogram _stackUsage;
+};
+
+//==============================================================================================
+//                                 class AllocatorStatistics
+//==============================================================================================
+/// @class AllocatorStatistics.
+/// @brief Snapshot of all the pools used by the dispatcher. Can be used to size the pools
+///        via the __QUANTUM_*_ALLOC_SIZE macros or the AllocatorTraits.
+class AllocatorStatistics
+{
+    friend class Dispatcher;
+    
+public:
+    /// @brief Pool of coroutine tasks.
+    const PoolStatistics& task() const;
+    
+    /// @brief Pool of IO tasks.
+    const PoolStatistics& ioTask() const;
+    
+    /// @brief Pool of contexts.
+    const PoolStatistics& context() const;
+    
+    /// @brief Pool of promises.
+    const PoolStatistics& promise() const;
+    
+    /// @brief Pool of futures.
+    const PoolStatistics& future() const;
+    
+    /// @brief Pool of queue list nodes shared by all the queues.
+    const PoolStatistics& queueList() const;
+    
+    /// @brief Pool of coroutine stacks of the default size class.
+    const PoolStatistics& coroStack() const;
+    
+    void print(std::ostream& out) const;
+    
+private:
+    PoolStatistics  _task;
+    PoolStatistics  _ioTask;
+    PoolStatistics  _context;
+    PoolStatistics  _promise;
+    PoolStatistics  _future;
+    PoolStatistics  _queueList;
+    PoolStatistics  _coroStack;
+};
+
+std::ostream& operator<<(std::ostream& out, const PoolStatistics& stats);
+std::ostream& operator<<(std::ostream& out, const AllocatorStatistics& stats);
+
+}}
+
+#include <quantum/impl/quantum_allocator_statistics_impl.h>
+
+#endif //QUANTUM_ALLOCATOR_STATISTICS_H
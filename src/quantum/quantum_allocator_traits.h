@@ -17,6 +17,7 @@
 #define QUANTUM_ALLOCATOR_TRAITS_H
 
 #include <cstdint>
+#include <cstddef>
 
 namespace Bloomberg {
 namespace quantum {
@@ -34,6 +35,22 @@ namespace quantum {
     #define __QUANTUM_DEFAULT_CORO_POOL_ALLOC_SIZE 200
 #endif
 
+#ifndef __QUANTUM_POOL_MAX_SLABS
+    #define __QUANTUM_POOL_MAX_SLABS 16
+#endif
+
+#ifndef __QUANTUM_POOL_SPARE_SLABS
+    #define __QUANTUM_POOL_SPARE_SLABS 1
+#endif
+
+#ifndef __QUANTUM_POOL_THREAD_CACHE_SIZE
+    #define __QUANTUM_POOL_THREAD_CACHE_SIZE 32
+#endif
+
+#ifndef __QUANTUM_CORO_STACK_RESIDENT_SIZE
+    #define __QUANTUM_CORO_STACK_RESIDENT_SIZE 65536
+#endif
+
 #ifndef __QUANTUM_FUNCTION_ALLOC_SIZE
     #define __QUANTUM_FUNCTION_ALLOC_SIZE 128
 #endif
@@ -44,7 +61,7 @@ namespace quantum {
 /// @struct AllocatorTraits.
 /// @brief Allows application-wide settings for the various allocators used by Quantum.
 struct AllocatorTraits {
-    using size_type = uint16_t;
+    using size_type = uint32_t;
     
     /**
      * @brief Get/set if the system allocator should be used for internal objects (other than coroutine stacks).
@@ -74,6 +91,67 @@ struct AllocatorTraits {
         return value;
     }
     
+    /**
+     * @brief Get/set if coroutine stacks should be mapped from the operating system instead of the heap.
+     * @return A modifiable reference to the value.
+     * @remark Each mapped stack is preceded by a PROT_NONE guard page so that an overflow faults instead
+     *         of corrupting a neighbouring stack, and memory is only committed as the stack grows. Takes
+     *         effect for coroutine pools created after the change.
+     */
+    static bool& useMmapCoroStacks() {
+#ifdef __QUANTUM_USE_MMAP_CORO_STACKS
+        static bool value = true;
+#else
+        static bool value = false;
+#endif
+        return value;
+    }
+    
+    /**
+     * @brief Get/set if mapped coroutine stacks should be backed by transparent huge pages.
+     * @return A modifiable reference to the value.
+     * @remark Only applies when useMmapCoroStacks() is set and the platform supports MADV_HUGEPAGE.
+     */
+    static bool& useHugePagesForCoroStacks() {
+#ifdef __QUANTUM_USE_HUGE_PAGES_FOR_CORO_STACKS
+        static bool value = true;
+#else
+        static bool value = false;
+#endif
+        return value;
+    }
+    
+    /**
+     * @brief Get/set how many bytes at the top of a mapped coroutine stack stay committed once the stack
+     *        is returned to its pool.
+     * @return A modifiable reference to the value.
+     * @remark The rest of the stack is given back to the operating system with madvise(MADV_DONTNEED),
+     *         so stacks which grew large during one coroutine do not keep their memory. Set to 0 to
+     *         never give memory back. Only applies when useMmapCoroStacks() is set.
+     */
+    static size_t& coroStackResidentSize() {
+        static size_t value = __QUANTUM_CORO_STACK_RESIDENT_SIZE;
+        return value;
+    }
+    
+    /**
+     * @brief Get/set if coroutine stacks should be painted so that their high-water mark can be measured.
+     * @return A modifiable reference to the value.
+     * @remark Stacks are filled with a known pattern when they are created and scanned for the deepest
+     *         overwritten byte when they are returned to their pool. The results are reported by
+     *         PoolStatistics::stackUsage(). This is a diagnostic mode: returning a stack costs a scan of
+     *         its unused part and mapped stacks are no longer trimmed. Takes effect for coroutine pools
+     *         created after the change.
+     */
+    static bool& paintCoroStacks() {
+#ifdef __QUANTUM_PAINT_CORO_STACKS
+        static bool value = true;
+#else
+        static bool value = false;
+#endif
+        return value;
+    }
+    
     /**
      * @brief Get/set if the allocator pool for internal objects should use the heap or the application stack.
      * @return A modifiable reference to the value.
@@ -165,6 +243,29 @@ struct AllocatorTraits {
         static size_type size = defaultPoolAllocSize();
         return size;
     }
+    
+    /**
+     * @brief Get/set the maximum number of slabs by which each object or coroutine stack pool may grow.
+     * @return A modifiable reference to the value.
+     * @remark Each slab is as large as the pool capacity at the time it is added, so the capacity doubles
+     *         with every slab. Once the limit is reached, allocations fall back to the heap. Set to 0 to
+     *         disable growth.
+     */
+    static size_t& maxPoolSlabs() {
+        static size_t value = __QUANTUM_POOL_MAX_SLABS;
+        return value;
+    }
+    
+    /**
+     * @brief Get/set the number of unused slabs each pool keeps in reserve.
+     * @return A modifiable reference to the value.
+     * @remark Any other slab is given back to the heap as soon as all its blocks are freed. Keeping
+     *         spare slabs avoids repeatedly growing and shrinking a pool around a usage boundary.
+     */
+    static size_t& poolSpareSlabs() {
+        static size_t value = __QUANTUM_POOL_SPARE_SLABS;
+        return value;
+    }
 };
 
 }}
@@ -0,0 +1,83 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_BARRIER_H
+#define QUANTUM_BARRIER_H
+
+#include <atomic>
+#include <list>
+#include <utility>
+#include <cstddef>
+#include <quantum/quantum_spinlock.h>
+#include <quantum/quantum_futex.h>
+#include <quantum/interface/quantum_icontext.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class Barrier
+//==============================================================================================
+/// @class Barrier.
+/// @brief Coroutine-compatible reusable barrier.
+/// @details A fixed number of participants meet at the barrier. Each one waits until all have
+///          arrived, then the barrier resets for the next phase. The last arrival wakes the others
+///          directly. Waiting coroutines are parked by their queue and waiting threads sleep until then.
+class Barrier
+{
+public:
+    /// @brief Constructor.
+    /// @param[in] count The number of participants in each phase.
+    explicit Barrier(ptrdiff_t count);
+
+    Barrier(const Barrier& other) = delete;
+    Barrier& operator=(const Barrier& other) = delete;
+
+    /// @brief Arrive at the barrier and wait for the other participants.
+    /// @note Must be called in a non-coroutine context.
+    void arriveAndWait();
+
+    /// @brief Arrive at the barrier and wait for the other participants.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @note Must be called from a coroutine.
+    void arriveAndWait(ICoroSync::Ptr sync);
+
+    /// @brief Arrive at the barrier and leave it. The following phases expect one participant less.
+    /// @note Never blocks.
+    void arriveAndDrop();
+
+    /// @brief Number of phases completed so far.
+    size_t phase() const;
+
+private:
+    using Waiter = std::pair<std::atomic_int*, ICoroSync::Ptr>;
+
+    void arriveAndWaitImpl(std::atomic_int& signal, ICoroSync::Ptr sync);
+    void completePhase(std::list<Waiter>& waiters); //called with the spinlock held
+    static void notify(std::list<Waiter>& waiters);
+
+    //Members
+    SpinLock                _spinlock; //protects all the members below
+    ptrdiff_t               _count; //participants in each phase
+    ptrdiff_t               _remaining; //participants yet to arrive in the current phase
+    std::atomic<size_t>     _phase;
+    std::list<Waiter>       _waiters;
+};
+
+}}
+
+#include <quantum/impl/quantum_barrier_impl.h>
+
+#endif //QUANTUM_BARRIER_H
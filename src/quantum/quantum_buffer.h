@@ -18,6 +18,9 @@
 
 #include <iostream>
 #include <deque>
+#include <vector>
+#include <algorithm>
+#include <iterator>
 #include <quantum/quantum_future_state.h>
 #include <quantum/quantum_traits.h>
 
@@ -66,17 +69,28 @@ public:
     /// @return Result of the operation. See BufferStatus above for more details.
     BufferStatus pull(T& value);
     
+    /// @brief Pushes several values at the end of the buffer.
+    /// @param[in] values Values pushed into the buffer. They are moved from.
+    /// @return Result of the operation. See BufferStatus above for more details.
+    BufferStatus pushMany(std::vector<T>&& values);
+    
+    /// @brief Pulls up to 'maxCount' values from the buffer.
+    /// @param[out] values Container to which the pulled values are appended.
+    /// @param[in] maxCount Maximum number of values to pull.
+    /// @return 'DataReceived' if at least one value was pulled. See BufferStatus above for more details.
+    BufferStatus pullMany(std::vector<T>& values, size_t maxCount);
+    
     /// @brief Close the buffer. Once this method is called, push operations are no longer permitted. Pull operations
     ///        are permitted until the buffer empties.
     void close();
     
     /// @brief Indicates the number of values stored in the buffer.
     /// @return Number of values in the buffer.
-    size_t size();
+    size_t size() const;
     
     /// @brief Helper function equivalent to size() == 0;
     /// @return True if empty, false otherwise.
-    bool empty();
+    bool empty() const;
     
 private:
     std::deque<T,ALLOCATOR>     _buffer;
@@ -0,0 +1,59 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_CANCELLATION_TOKEN_H
+#define QUANTUM_CANCELLATION_TOKEN_H
+
+#include <memory>
+#include <atomic>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                 class CancellationToken
+//==============================================================================================
+/// @class CancellationToken
+/// @brief Allows cooperative cancellation of coroutines and IO tasks. The same token can be passed to
+///        any number of posts and is inherited by continuations and by coroutines posted from within
+///        a coroutine holding a token.
+/// @note Once cancelled, tasks which have not started running are discarded by their queue and their
+///       futures throw a BrokenPromise exception. Running coroutines must check ICoroContext::isCancelled().
+class CancellationToken
+{
+public:
+    using Ptr = std::shared_ptr<CancellationToken>;
+    
+    /// @brief Constructor.
+    CancellationToken();
+    
+    /// @brief Cancel all the tasks holding this token. Can be called from any thread.
+    void cancel();
+    
+    /// @brief Check if the token was cancelled.
+    /// @return True or False.
+    bool isCancelled() const;
+    
+private:
+    std::atomic_bool    _isCancelled;
+};
+
+using CancellationTokenPtr = CancellationToken::Ptr;
+
+}}
+
+#include <quantum/impl/quantum_cancellation_token_impl.h>
+
+#endif //QUANTUM_CANCELLATION_TOKEN_H
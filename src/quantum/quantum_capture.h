@@ -57,14 +57,15 @@ makeCapture(FUNC&& func, ARGS&& ... args);
 //==============================================================================================
 /// @class Function
 /// @brief Similar implementation to std::function except that it allows capture of non-copyable types.
+/// @tparam SIZE Size of the inline buffer holding the functor. Larger functors are allocated on the heap.
 /// @note For internal use only.
-template <typename RET, typename ... ARGS>
+template <typename SIGNATURE, size_t SIZE = __QUANTUM_FUNCTION_ALLOC_SIZE>
 class Function;
 
-template <typename RET, typename ... ARGS>
-class Function<RET(ARGS...)>
+template <typename RET, typename ... ARGS, size_t SIZE>
+class Function<RET(ARGS...), SIZE>
 {
-    static constexpr size_t size{__QUANTUM_FUNCTION_ALLOC_SIZE};
+    static constexpr size_t size{SIZE};
     using Func = RET(*)(ARGS...);
     using Callback = RET(*)(void*, ARGS...);
     using Deleter = void(*)(void*);
@@ -74,10 +75,10 @@ public:
     Function(RET(*ptr)(ARGS...)); //construct with function pointer
     template <typename FUNCTOR>
     Function(FUNCTOR&& functor); //construct with functor
-    Function(const Function<RET(ARGS...)>& other);
-    Function(Function<RET(ARGS...)>&& other);
-    Function& operator=(const Function<RET(ARGS...)>& other);
-    Function& operator=(Function<RET(ARGS...)>&& other);
+    Function(const Function<RET(ARGS...), SIZE>& other);
+    Function(Function<RET(ARGS...), SIZE>&& other);
+    Function& operator=(const Function<RET(ARGS...), SIZE>& other);
+    Function& operator=(Function<RET(ARGS...), SIZE>&& other);
     ~Function();
     
     // Methods
@@ -0,0 +1,168 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_CHANNEL_H
+#define QUANTUM_CHANNEL_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <utility>
+#include <quantum/quantum_spinlock.h>
+#include <quantum/quantum_futex.h>
+#include <quantum/quantum_future_state.h>
+#include <quantum/interface/quantum_ifuture_callback.h>
+#include <quantum/interface/quantum_icontext.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class Channel
+//==============================================================================================
+/// @class Channel.
+/// @brief Coroutine-compatible bounded channel backed by a power-of-two ring buffer.
+/// @details Unlike buffered futures, a channel applies backpressure: producers wait while the
+///          channel is full and consumers wait while it is empty. Waiting coroutines are parked by
+///          their queue and waiting threads sleep. Pushing and pulling do not take any lock unless
+///          the caller has to wait. The Spsc mode can be used when there is exactly one producer
+///          and one consumer at any time and saves a CAS on each operation.
+/// @tparam T Type of the elements. Must be default constructible.
+template <class T>
+class Channel
+{
+public:
+    using Ptr = std::shared_ptr<Channel<T>>;
+    
+    enum class Mode
+    {
+        Spsc,   ///< Single producer, single consumer.
+        Mpmc    ///< Any number of producers and consumers.
+    };
+    
+    /// @brief Constructor.
+    /// @param[in] capacity Maximum number of elements. Rounded up to the next power of two.
+    /// @param[in] mode Concurrency mode.
+    explicit Channel(size_t capacity, Mode mode = Mode::Mpmc);
+    
+    Channel(const Channel& other) = delete;
+    Channel& operator=(const Channel& other) = delete;
+    
+    /// @brief Push a value, waiting while the channel is full.
+    /// @param[in] value Value to push.
+    /// @note Must be called in a non-coroutine context. Throws BufferClosedException if the channel is closed.
+    template <class V = T>
+    void push(V&& value);
+    
+    /// @brief Push a value, waiting while the channel is full.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @param[in] value Value to push.
+    /// @note Must be called from a coroutine. Throws BufferClosedException if the channel is closed.
+    template <class V = T>
+    void push(ICoroSync::Ptr sync, V&& value);
+    
+    /// @brief Push a value if there is room.
+    /// @return True if the value was pushed, false if the channel is full.
+    /// @note Never blocks. Throws BufferClosedException if the channel is closed.
+    template <class V = T>
+    bool tryPush(V&& value);
+    
+    /// @brief Pull a value, waiting while the channel is empty.
+    /// @param[out] isClosed Set to true when the channel is closed and fully drained.
+    /// @return The pulled value or a default-constructed one if isClosed is true.
+    /// @note Must be called in a non-coroutine context.
+    T pull(bool& isClosed);
+    
+    /// @brief Pull a value, waiting while the channel is empty.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @param[out] isClosed Set to true when the channel is closed and fully drained.
+    /// @return The pulled value or a default-constructed one if isClosed is true.
+    /// @note Must be called from a coroutine.
+    T pull(ICoroSync::Ptr sync, bool& isClosed);
+    
+    /// @brief Pull a value if one is available.
+    /// @param[out] value The pulled value.
+    /// @return True if a value was pulled, false if the channel is empty.
+    /// @note Never blocks.
+    bool tryPull(T& value);
+    
+    /// @brief Close the channel for pushing. Remaining values can still be pulled.
+    void close();
+    
+    /// @brief Determines if the channel is closed.
+    bool isClosed() const;
+    
+    /// @brief Approximate number of elements in the channel.
+    size_t size() const;
+    
+    /// @brief Maximum number of elements.
+    size_t capacity() const;
+    
+    /// @brief Register a callback invoked each time a value is pushed and when the channel is closed.
+    /// @param[in] callback The callback. It is also invoked right away if a value can already be pulled.
+    /// @param[in] index Index passed back to the callback.
+    /// @note The callback stays registered until removeCallback() is called. It must not block.
+    void addCallback(IFutureCallback::Ptr callback, size_t index);
+    
+    /// @brief Unregister a callback added with addCallback().
+    /// @param[in] callback The callback.
+    void removeCallback(const IFutureCallback::Ptr& callback);
+    
+private:
+    using Waiter = std::pair<std::atomic_int*, ICoroSync::Ptr>;
+    
+    struct Cell
+    {
+        std::atomic_size_t      _sequence;
+        T                       _value;
+    };
+    
+    template <class V>
+    void pushImpl(std::atomic_int& signal, ICoroSync::Ptr sync, V&& value);
+    T pullImpl(std::atomic_int& signal, ICoroSync::Ptr sync, bool& isClosed);
+    //Lock-free ring buffer operations. The value is only consumed on success.
+    template <class V>
+    bool tryPushImpl(V&& value);
+    bool tryPullImpl(T& value);
+    bool canPush() const;
+    bool canPull() const;
+    void notifyOne(std::list<Waiter>& waiters, std::atomic_int& numWaiters);
+    void notifyAll(std::list<Waiter>& waiters, std::atomic_int& numWaiters);
+    static void notify(Waiter& waiter);
+    static void wait(std::atomic_int& signal, const ICoroSync::Ptr& sync);
+    void notifyCallbacks();
+    
+    //Members
+    const Mode                  _mode;
+    const size_t                _mask;
+    std::unique_ptr<Cell[]>     _cells;
+    std::atomic_size_t          _head; //next position to pull
+    std::atomic_size_t          _tail; //next position to push
+    std::atomic_bool            _isClosed;
+    SpinLock                    _spinlock; //protects the waiter and callback lists
+    std::list<Waiter>           _pushWaiters;
+    std::list<Waiter>           _pullWaiters;
+    std::atomic_int             _numPushWaiters;
+    std::atomic_int             _numPullWaiters;
+    std::list<std::pair<IFutureCallback::Ptr, size_t>> _callbacks;
+    std::atomic_int             _numCallbacks;
+};
+
+}}
+
+#include <quantum/impl/quantum_channel_impl.h>
+
+#endif //QUANTUM_CHANNEL_H
@@ -0,0 +1,71 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_CLOCK_H
+#define QUANTUM_CLOCK_H
+
+#include <chrono>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      struct Clock
+//==============================================================================================
+/// @struct Clock.
+/// @brief Steady clock read by the coroutine queue timers and by the timed waits of coroutines.
+/// @details Returns std::chrono::steady_clock::now() unless the calling thread is running the coroutines
+///          of a Simulation, in which case the virtual time of the simulation is returned.
+/// @note For internal use only.
+struct Clock
+{
+    using TimePoint = std::chrono::steady_clock::time_point;
+    
+    /// @brief Get the current time of the calling thread.
+    static TimePoint now();
+    
+    /// @brief Check if the calling thread reads a virtual time.
+    static bool isVirtual();
+    
+    //==============================================================================================
+    //                                      class Clock::Guard
+    //==============================================================================================
+    /// @class Clock::Guard
+    /// @brief Makes the calling thread read a virtual time for the lifetime of this object.
+    class Guard
+    {
+    public:
+        /// @brief Constructor.
+        /// @param[in] time The virtual time. Must outlive this object and may be advanced in the meantime.
+        explicit Guard(const TimePoint& time);
+        
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        
+        /// @brief Destructor. Restores the time read before.
+        ~Guard();
+    private:
+        const TimePoint*   _previous;
+    };
+    
+private:
+    static const TimePoint*& virtualTime();
+};
+
+}}
+
+#include <quantum/impl/quantum_clock_impl.h>
+
+#endif //QUANTUM_CLOCK_H
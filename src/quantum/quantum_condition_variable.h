@@ -18,8 +18,11 @@
 
 #include <list>
 #include <atomic>
+#include <utility>
 #include <quantum/quantum_mutex.h>
 #include <quantum/quantum_yielding_thread.h>
+#include <quantum/quantum_futex.h>
+#include <quantum/quantum_clock.h>
 #include <quantum/interface/quantum_icontext.h>
 #include <quantum/quantum_traits.h>
 
@@ -195,33 +198,42 @@ public:
                  PREDICATE predicate);
     
 private:
+    //Signal to set along with the coroutine to wake up (null for regular threads)
+    using Waiter = std::pair<std::atomic_int*, ICoroSync::Ptr>;
+    
     template <class YIELDING>
     void waitImpl(YIELDING&& yield,
                   Mutex& mutex,
-                  std::atomic_int& signal);
+                  std::atomic_int& signal,
+                  ICoroSync::Ptr sync);
     
     template <class YIELDING, class PREDICATE = bool()>
     void waitImpl(YIELDING&& yield,
                   Mutex& mutex,
                   PREDICATE predicate,
-                  std::atomic_int& signal);
+                  std::atomic_int& signal,
+                  ICoroSync::Ptr sync);
     
     template <class YIELDING, class REP, class PERIOD>
     bool waitForImpl(YIELDING&& yield,
                      Mutex& mutex,
                      std::chrono::duration<REP, PERIOD>& time,
-                     std::atomic_int& signal);
+                     std::atomic_int& signal,
+                     ICoroSync::Ptr sync);
     
     template <class YIELDING, class REP, class PERIOD, class PREDICATE = bool()>
     bool waitForImpl(YIELDING&& yield,
                      Mutex& mutex,
                      const std::chrono::duration<REP, PERIOD>& time,
                      PREDICATE predicate,
-                     std::atomic_int& signal);
+                     std::atomic_int& signal,
+                     ICoroSync::Ptr sync);
+    
+    static void notify(Waiter& waiter);
     
     //MEMBERS
     Mutex                           _thisLock; //sync access to this object
-    std::list<std::atomic_int*>     _waiters;
+    std::list<Waiter>               _waiters;
     std::atomic_bool                _destroyed;
 };
 
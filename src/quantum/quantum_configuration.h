@@ -17,11 +17,22 @@
 #define QUANTUM_CONFIGURATION_H
 
 #include <quantum/quantum_thread_traits.h>
+#include <quantum/quantum_json.h>
+#include <array>
 #include <chrono>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 namespace Bloomberg {
 namespace quantum {
 
+class MetricsSnapshot;
+
 //==============================================================================================
 //                                 class Configuration
 //==============================================================================================
@@ -32,6 +43,60 @@ class Configuration
 public:
      enum class BackoffPolicy : int { Linear,        ///< Linear backoff
                                       Exponential }; ///< Exponential backoff (doubles every time)
+     
+     enum class IdlePolicy : int { Park,           ///< Block on a condition variable as soon as the queue is empty
+                                   Spin,           ///< Busy-spin until work arrives (never blocks)
+                                   SpinThenPark }; ///< Spin for a limited time then block
+     
+     enum class QueueSelectionPolicy : int { Shortest,      ///< Scan all queues and pick the shortest one
+                                             RoundRobin,    ///< Cycle through the queues
+                                             PowerOfTwo };  ///< Pick the shorter of two randomly chosen queues
+     
+     enum class TerminatePolicy : int { Discard,    ///< Threads exit right away and their pending tasks are discarded by the terminating thread
+                                        Abandon };  ///< Each thread releases its own pending tasks in bulk before exiting
+     
+     enum class AdmissionPolicy : int { Unbounded,  ///< Posts always succeed. Watermarks are only reported in the statistics.
+                                        Reject,     ///< Posts to a saturated queue throw
+                                        Block };    ///< Posts to a saturated queue wait until it drains below its low watermark
+     
+     /// @brief List of CPU ids belonging to the same NUMA node.
+     using CpuSet = std::vector<int>;
+     
+     enum class PoolType : int { Task,          ///< Coroutine tasks
+                                 IoTask,        ///< IO tasks
+                                 Context,       ///< Coroutine and thread contexts
+                                 Promise,       ///< Promises
+                                 Future,        ///< Futures
+                                 QueueList,     ///< Queue list nodes
+                                 CoroStack,     ///< Coroutine stacks (default size class)
+                                 Max };         ///< Number of pool types. Not a pool.
+     
+     /// @brief Callback invoked on the coroutine thread when a single time slice exceeds the long slice threshold.
+     /// @param[in] queueId The id of the queue which ran the coroutine.
+     /// @param[in] sliceTime The time the coroutine ran before yielding or completing.
+     using LongSliceCallback = std::function<void(int queueId, std::chrono::microseconds sliceTime)>;
+     
+     enum class StallType : int { CoroutineQueue,    ///< A coroutine has been running without yielding
+                                  IoQueue,           ///< An IO task has been running
+                                  BlockedCoroutine };///< A coroutine has been waiting for a signal
+     
+     /// @brief Stall reported by the watchdog.
+     struct StallInfo
+     {
+         StallType                   _type;
+         int                         _queueId; //IQueue::QueueId::Any for elastic IO threads
+         std::chrono::milliseconds   _stallTime; //time spent running or waiting so far
+         const void*                 _task; //blocked coroutine as identified by the Tracer, null for queue stalls
+     };
+     
+     /// @brief Callback invoked by the watchdog once per stall, when it crosses its threshold.
+     using StallCallback = std::function<void(const StallInfo& info)>;
+     
+     /// @brief Callback receiving the dispatcher metrics at a fixed interval.
+     using MetricsExporter = std::function<void(const MetricsSnapshot& snapshot)>;
+     
+     /// @brief Callback receiving the exceptions thrown by detached tasks.
+     using ErrorCallback = std::function<void(std::exception_ptr ex)>;
                            
     /// @brief Get the JSON schema corresponding to this configuration object.
     /// @return The draft-04 compatible schema.
@@ -41,6 +106,18 @@ public:
     /// @return The URI.
     static const std::string& getJsonSchemaUri();
     
+    /// @brief Create a configuration from a JSON document matching getJsonSchema().
+    /// @oaram[in] json The document. Settings which are not present keep their default value.
+    /// @return The configuration.
+    /// @note Throws std::runtime_error naming the offending setting if the document is malformed, holds an
+    ///       unknown setting or a value of the wrong type. Durations are integers in the unit of the setting
+    ///       name. The callbacks cannot be set from JSON.
+    static Configuration fromJson(const std::string& json);
+    
+    /// @brief Serialize all the settings except the callbacks into a JSON document matching getJsonSchema().
+    /// @return The document, which fromJson() turns back into an identical configuration.
+    std::string toJson() const;
+    
     /// @brief Set the number of threads running coroutines.
     /// @oaram[in] num The number of threads. Set to -1 to have one coroutine thread per core.
     ///            Default is -1.
@@ -50,35 +127,253 @@ public:
     /// @oaram[in] num The number of threads. Default is 5.
     void setNumIoThreads(int num);
     
+    /// @brief Set the number of coroutine queues which have no thread of their own.
+    /// @oaram[in] num The number of queues, taken from the last coroutine queues. These queues are driven from the
+    ///            application's thread via Dispatcher::runOnce() or Dispatcher::runUntilIdle() and tasks posted to the
+    ///            'Any' queue are never placed on them unless all the coroutine queues are manual. Default is 0.
+    /// @note Useful to run coroutines on an existing event loop without handing them over to another thread.
+    void setNumManualCoroutineQueues(int num);
+    
+    /// @brief Start the coroutine and IO threads on demand.
+    /// @oaram[in] value If set to true, the thread of a queue is only started when a task is first posted to it and
+    ///                  the IO threads are all started by the first post to the 'Any' IO queue. Default is false.
+    /// @note Shortens the construction and the shutdown of dispatchers which only use a few of their threads,
+    ///       e.g. in short-lived tools and tests.
+    void setLazyThreadStart(bool value);
+    
+    /// @brief Set the maximum number of IO threads when the IO thread pool is elastic.
+    /// @oaram[in] num The maximum number of threads. When larger than the number of IO threads, extra threads
+    ///            servicing only the shared ('any') IO queue are added on demand and retired when idle.
+    ///            Default is 0 (elastic pool disabled).
+    /// @note Threads servicing a specific IO queue id are never added or removed.
+    void setMaxNumIoThreads(int num);
+    
+    /// @brief Set the shared IO queue backlog above which an extra IO thread is added.
+    /// @oaram[in] numTasks The number of pending tasks per extra thread. Each extra thread added raises the backlog
+    ///                 required to add the next one by the same amount. Default is 16.
+    void setIoThreadGrowthBacklog(size_t numTasks);
+    
+    /// @brief Set the time an extra IO thread can remain idle before being retired.
+    /// @oaram[in] timeout The number of milliseconds. Default is 5000.
+    void setIoThreadIdleTimeoutMs(std::chrono::milliseconds timeout);
+    
     /// @brief Indicate if coroutine threads should be pinned to a core.
     /// @oaram[in] value True or False. Default is False.
     /// @note For best performance, the number of coroutine threads should
     ///       be <= the number of cores in the system.
     void setPinCoroutineThreadsToCores(bool value);
     
+    /// @brief Set explicit CPUs for the coroutine threads, grouped by NUMA node.
+    /// @oaram[in] cpuSets One set of CPU ids per NUMA node. Coroutine threads are split into contiguous groups,
+    ///                    one per node, and each thread is pinned to a CPU of its node in round-robin fashion.
+    ///                    Default is empty.
+    /// @note When set, posting to the 'any' queue from a thread running on one of these CPUs only selects
+    ///       coroutine queues of the same node, and work stealing prefers siblings of the same node.
+    ///       Overrides setPinCoroutineThreadsToCores().
+    void setCoroutineCpuSets(std::vector<CpuSet> cpuSets);
+    
+    /// @brief Set explicit CPUs for the IO threads, grouped by NUMA node.
+    /// @oaram[in] cpuSets One set of CPU ids per NUMA node. IO threads are split into contiguous groups,
+    ///                    one per node, and pinned the same way as coroutine threads.
+    ///                    Default is empty.
+    void setIoCpuSets(std::vector<CpuSet> cpuSets);
+    
     /// @brief Load balancee the shared IO queues.
     /// @oaram[in] value If set to true, posting to the 'any' IO queue will result in
     ///              the load being spread among N queues. This mode can provide higher
     ///              throughput if dealing with high task loads. Default is false.
-    /// @note To achieve higher performance, the threads run in polling mode which
-    ///       increases CPU usage even when idle.
+    /// @note Each posting thread is assigned one of the N shared queues so that concurrent posters rarely
+    ///       contend. Idle IO threads wait to be signalled just like in the default mode.
     void setLoadBalanceSharedIoQueues(bool value);
     
     /// @brief Set the interval between IO thread polls.
     /// @oaram[in] interval Interval in milliseconds. Default is 100ms.
-    /// @note Setting this to a higher value means it may take longer to react to the first
-    ///       IO task posted, and vice-versa if the interval is lower.
+    /// @note Deprecated. Idle IO threads are now signalled when work is posted and no longer poll.
     void setLoadBalancePollIntervalMs(std::chrono::milliseconds interval);
     
     /// @brief Set a backoff policy for the shared queue polling interval.
     /// @oaram[in] policy The backoff policy to use. Default is 'Linear'.
+    /// @note Deprecated. See setLoadBalancePollIntervalMs().
     void setLoadBalancePollIntervalBackoffPolicy(BackoffPolicy policy);
     
     /// @brief Set the number of backoffs.
     /// @oaram[in] numBackoffs The number of backoff increments. Default is 0.
     ///                    When the number of backoffs is reached, the poll interval remains unchanged thereafter.
+    /// @note Deprecated. See setLoadBalancePollIntervalMs().
     void setLoadBalancePollIntervalNumBackoffs(size_t numBackoffs);
     
+    /// @brief Allow idle coroutine threads to steal work from their siblings.
+    /// @oaram[in] value If set to true, a coroutine queue which runs out of tasks will take
+    ///              a runnable coroutine which has not yet started from the busiest sibling queue.
+    ///              Only coroutines posted on the 'any' queue can be stolen. Default is false.
+    /// @note Idle threads poll their siblings at the interval set via setCoroutineWorkStealingPollIntervalMs().
+    void setCoroutineWorkStealing(bool value);
+    
+    /// @brief Set the interval at which idle coroutine threads look for work to steal.
+    /// @oaram[in] interval Interval in milliseconds. Default is 10ms.
+    void setCoroutineWorkStealingPollIntervalMs(std::chrono::milliseconds interval);
+    
+    /// @brief Allow overloaded coroutine queues to hand coroutines over to less loaded siblings.
+    /// @oaram[in] value If set to true, a coroutine queue holding at least two more tasks than its least loaded
+    ///              sibling moves coroutines over to it at safe points, i.e. when a posted coroutine is picked up
+    ///              before its first run or when a parked coroutine is woken up. Only coroutines posted on the 'any'
+    ///              queue and their continuations are migrated. Default is false.
+    /// @note A migrated coroutine resumes on another thread, so it must not keep pointers or references to
+    ///       thread-local data across calls which may block. Combine with setCoroutineWorkStealing() to also
+    ///       let idle queues pull work.
+    void setCoroutineMigration(bool value);
+    
+    /// @brief Set the behavior of coroutine and IO threads when their queue is empty.
+    /// @oaram[in] policy The idle policy to use. Default is 'Park'.
+    /// @note Posting a task only notifies the thread if it is actually parked. Spinning lowers the wake-up
+    ///       latency at the expense of CPU usage and is best used with threads pinned to cores.
+    void setIdlePolicy(IdlePolicy policy);
+    
+    /// @brief Set the time an idle thread spins before parking when using the 'SpinThenPark' policy.
+    /// @oaram[in] time Spin time in microseconds. Default is 100us.
+    void setIdleSpinTimeUs(std::chrono::microseconds time);
+    
+    /// @brief Set the policy used to pick a coroutine queue when posting to the 'any' queue.
+    /// @oaram[in] policy The selection policy to use. Default is 'Shortest'.
+    /// @note 'Shortest' reads the size of every queue on each post which becomes costly with many threads.
+    ///       'PowerOfTwo' only samples two queues and still avoids most imbalances.
+    void setCoroutineQueueSelectionPolicy(QueueSelectionPolicy policy);
+    
+    /// @brief Set the starvation protection limit for coroutine priority levels.
+    /// @oaram[in] numSlices The number of consecutive time slices a runnable priority level can be skipped
+    ///                      in favor of higher ones before one of its coroutines gets to run. Set to 0 to
+    ///                      disable starvation protection. Default is 16.
+    void setPriorityStarvationLimit(size_t numSlices);
+    
+    /// @brief Resume signalled coroutines ahead of the other runnable coroutines of their priority level.
+    /// @oaram[in] value If set to true, a coroutine parked on a future, mutex or other signal (e.g. waiting for the
+    ///                  result of postAsyncIo()) runs next once signalled instead of at the end of the current round,
+    ///                  so that its wake-up latency does not depend on the depth of its queue. Default is true.
+    void setResumeSignalledCoroutinesFirst(bool value);
+    
+    /// @brief Enable per-slice run time statistics for coroutines.
+    /// @oaram[in] value If set to true, every coroutine resume is timed and recorded in the queue statistics
+    ///                  (slice count, total and max slice time and a log2 histogram). Default is false.
+    void setCoroutineSliceStatistics(bool value);
+    
+    /// @brief Enable latency statistics for coroutine and IO tasks.
+    /// @oaram[in] value If set to true, every task is timestamped when posted, when it starts running and
+    ///                  when it completes. The wait, run and end-to-end times are recorded in the queue statistics
+    ///                  histograms from which percentiles can be read. Default is false.
+    void setLatencyStatistics(bool value);
+    
+    /// @brief Enable hardware counter statistics for the coroutine and IO threads.
+    /// @oaram[in] value If set to true, every queue thread counts its cpu cycles, instructions, cache misses,
+    ///                  branch misses and context switches via perf_event_open(). The counts are refreshed
+    ///                  in the queue statistics each time they are read. Default is false.
+    /// @note Linux only. Events which are not available are reported as 0.
+    void setHardwareCounterStatistics(bool value);
+    
+    /// @brief Set the threshold above which a single coroutine time slice is considered too long.
+    /// @oaram[in] threshold Threshold in microseconds. Set to 0 to disable long slice detection. Default is 0.
+    /// @note Setting a threshold implicitly times every coroutine resume.
+    void setLongSliceThresholdUs(std::chrono::microseconds threshold);
+    
+    /// @brief Set the callback invoked when a coroutine time slice exceeds the long slice threshold.
+    /// @oaram[in] callback The callback. Runs on the coroutine thread and must not block. Exceptions are ignored.
+    void setLongSliceCallback(LongSliceCallback callback);
+    
+    /// @brief Set how often the watchdog samples the queues.
+    /// @oaram[in] interval Interval in milliseconds. Set to 0 to disable the watchdog. Default is 0.
+    /// @note The watchdog only runs if a stall callback is also set. Enabling it implicitly timestamps every
+    ///       coroutine resume, every IO task run and every coroutine which blocks.
+    void setWatchdogIntervalMs(std::chrono::milliseconds interval);
+    
+    /// @brief Set the time after which a queue running the same coroutine or IO task is reported as stuck.
+    /// @oaram[in] threshold Threshold in milliseconds. Default is 1000.
+    /// @note Typically catches a coroutine making a blocking call instead of posting it with postAsyncIo().
+    void setQueueStallThresholdMs(std::chrono::milliseconds threshold);
+    
+    /// @brief Set the time after which a coroutine waiting for a signal is reported as blocked.
+    /// @oaram[in] threshold Threshold in milliseconds. Set to 0 to not report blocked coroutines. Default is 0.
+    void setBlockedCoroutineThresholdMs(std::chrono::milliseconds threshold);
+    
+    /// @brief Set the callback invoked by the watchdog.
+    /// @oaram[in] callback The callback. Runs on the dispatcher timer thread and must not block. Exceptions are ignored.
+    void setStallCallback(StallCallback callback);
+    
+    /// @brief Set how often the metrics are pushed to the exporter.
+    /// @oaram[in] interval Interval in milliseconds. Set to 0 to disable the exporter. Default is 0.
+    /// @note The rates of each snapshot are computed over the interval.
+    void setMetricsExportIntervalMs(std::chrono::milliseconds interval);
+    
+    /// @brief Set the callback receiving the metrics.
+    /// @oaram[in] exporter The callback. Runs on the dispatcher timer thread and must not block. Exceptions are ignored.
+    void setMetricsExporter(MetricsExporter exporter);
+    
+    /// @brief Set how often the sampling profiler records the coroutine running on each coroutine queue.
+    /// @oaram[in] interval Interval in microseconds. Set to 0 to disable the profiler. Default is 0.
+    /// @note Enabling it implicitly publishes the label of every coroutine resumed. See Dispatcher::profile().
+    void setSamplingProfilerIntervalUs(std::chrono::microseconds interval);
+    
+    /// @brief Set the initial number of blocks of an allocator pool.
+    /// @oaram[in] pool The pool.
+    /// @oaram[in] size The number of blocks. Set to 0 to keep the AllocatorTraits value, which defaults to the
+    ///                 __QUANTUM_*_ALLOC_SIZE macros. Default is 0.
+    /// @note Pools are shared by all dispatchers and created once, so this only applies if the pool has not been
+    ///       used before the dispatcher is constructed. Pools allocated on the application stack (i.e. when
+    ///       __QUANTUM_ALLOCATE_POOL_FROM_HEAP is not defined) have a compile-time size and are not affected,
+    ///       except for the coroutine stack pool.
+    void setPoolAllocSize(PoolType pool, size_t size);
+    
+    /// @brief Pre-fault the allocator pools when the dispatcher is constructed.
+    /// @oaram[in] value If set to true, the free blocks of every pool and the top pages of the pooled coroutine
+    ///                  stacks (see AllocatorTraits::coroStackResidentSize()) are written to so that the first
+    ///                  requests do not pay for the page faults. Default is false.
+    void setPoolWarmup(bool value);
+    
+    /// @brief Set the CPUs on which the pool warmup runs.
+    /// @oaram[in] cpuSet The CPU ids, typically all the CPUs of a NUMA node. The warmup runs on a thread pinned to
+    ///                   these CPUs so that the operating system's first-touch policy places the pool memory on
+    ///                   their node. Default is empty, in which case the warmup runs on the constructing thread.
+    void setPoolWarmupCpuSet(CpuSet cpuSet);
+    
+    /// @brief Set how the pending tasks are released when the dispatcher terminates.
+    /// @oaram[in] policy The terminate policy to use. Default is 'Discard'.
+    /// @note All the threads are signalled before any of them is joined with either policy. With 'Abandon' the
+    ///       queues are emptied in parallel and the coroutine stacks go back to the pool through the thread caches
+    ///       of the exiting threads, which shortens the shutdown of dispatchers holding many pending coroutines.
+    ///       The pending tasks don't run in either case and their promises are broken.
+    void setTerminatePolicy(TerminatePolicy policy);
+    
+    /// @brief Set the number of pending tasks at which a coroutine or IO queue becomes saturated.
+    /// @oaram[in] num The number of tasks. Set to 0 to disable the queue watermarks. Default is 0.
+    /// @note A saturated queue stays saturated until it drains down to its low watermark. See setAdmissionPolicy().
+    void setQueueHighWatermark(size_t num);
+    
+    /// @brief Set the number of pending tasks at which a saturated queue admits posts again.
+    /// @oaram[in] num The number of tasks. Set to 0 to use half of the high watermark. Default is 0.
+    void setQueueLowWatermark(size_t num);
+    
+    /// @brief Same as setQueueHighWatermark() but for the total number of tasks posted to the dispatcher and
+    ///        not yet completed.
+    /// @oaram[in] num The number of tasks. Set to 0 to disable the global watermarks. Default is 0.
+    void setGlobalHighWatermark(size_t num);
+    
+    /// @brief Same as setQueueLowWatermark() but for the total number of outstanding tasks.
+    /// @oaram[in] num The number of tasks. Set to 0 to use half of the high watermark. Default is 0.
+    void setGlobalLowWatermark(size_t num);
+    
+    /// @brief Set how the dispatcher handles posts when the target queue or the dispatcher is saturated.
+    /// @oaram[in] policy The admission policy to use. Default is 'Unbounded'.
+    /// @note The policy applies to the non-batch posts. With the 'Block' policy a thread waits until the queues
+    ///       signal that they have drained while a coroutine yields to the other coroutines of its queue. The
+    ///       thread running the manual queues is rejected instead of waiting on them. High priority posts are always
+    ///       admitted, hence normal priority work is shed first. Dispatcher::tryPost() and Dispatcher::tryPostAsyncIo()
+    ///       never wait or throw regardless of the policy.
+    void setAdmissionPolicy(AdmissionPolicy policy);
+    
+    /// @brief Set the callback receiving the exceptions of the detached coroutines and IO tasks.
+    /// @oaram[in] callback The callback. Runs on the thread of the failed task and must not block. Exceptions are ignored.
+    ///                     Default is empty, in which case the exceptions are dropped.
+    /// @note See Dispatcher::postDetached().
+    void setDetachedErrorCallback(ErrorCallback callback);
+    
     /// @brief Get the number of coroutine threads.
     /// @return The number of threads.
     int getNumCoroutineThreads() const;
@@ -87,10 +382,38 @@ public:
     /// @return The number of threads.
     int getNumIoThreads() const;
     
+    /// @brief Get the number of coroutine queues which have no thread of their own.
+    /// @return The number of queues.
+    int getNumManualCoroutineQueues() const;
+    
+    /// @brief Check if the threads are started on demand.
+    /// @return True or False.
+    bool getLazyThreadStart() const;
+    
+    /// @brief Get the maximum number of IO threads when the IO thread pool is elastic.
+    /// @return The number of threads.
+    int getMaxNumIoThreads() const;
+    
+    /// @brief Get the shared IO queue backlog above which an extra IO thread is added.
+    /// @return The number of tasks.
+    size_t getIoThreadGrowthBacklog() const;
+    
+    /// @brief Get the time an extra IO thread can remain idle before being retired.
+    /// @return The number of milliseconds.
+    std::chrono::milliseconds getIoThreadIdleTimeoutMs() const;
+    
     /// @brief Check to see if coroutine threads are pinned to cores or not.
     /// @return True or False.
     bool getPinCoroutineThreadsToCores() const;
     
+    /// @brief Get the explicit CPU sets of the coroutine threads.
+    /// @return One CPU set per NUMA node.
+    const std::vector<CpuSet>& getCoroutineCpuSets() const;
+    
+    /// @brief Get the explicit CPU sets of the IO threads.
+    /// @return One CPU set per NUMA node.
+    const std::vector<CpuSet>& getIoCpuSets() const;
+    
     /// @brief Check if IO shared queues are load balanced or not.
     /// @return True or False.
     bool getLoadBalanceSharedIoQueues() const;
@@ -107,14 +430,189 @@ public:
     /// @return The number of backoffs.
     size_t getLoadBalancePollIntervalNumBackoffs() const;
     
+    /// @brief Check if coroutine work stealing is enabled.
+    /// @return True or False.
+    bool getCoroutineWorkStealing() const;
+    
+    /// @brief Get the work stealing poll interval.
+    /// @return The number of milliseconds.
+    std::chrono::milliseconds getCoroutineWorkStealingPollIntervalMs() const;
+    
+    /// @brief Check if coroutine migration is enabled.
+    /// @return True or False.
+    bool getCoroutineMigration() const;
+    
+    /// @brief Get the idle policy of the coroutine and IO threads.
+    /// @return The idle policy used.
+    IdlePolicy getIdlePolicy() const;
+    
+    /// @brief Get the spin time used by the 'SpinThenPark' idle policy.
+    /// @return The number of microseconds.
+    std::chrono::microseconds getIdleSpinTimeUs() const;
+    
+    /// @brief Get the policy used to pick a coroutine queue when posting to the 'any' queue.
+    /// @return The selection policy used.
+    QueueSelectionPolicy getCoroutineQueueSelectionPolicy() const;
+    
+    /// @brief Get the starvation protection limit for coroutine priority levels.
+    /// @return The number of time slices.
+    size_t getPriorityStarvationLimit() const;
+    
+    /// @brief Check if signalled coroutines are resumed ahead of the other runnable coroutines.
+    /// @return True or False.
+    bool getResumeSignalledCoroutinesFirst() const;
+    
+    /// @brief Check if per-slice run time statistics are enabled for coroutines.
+    /// @return True or False.
+    bool getCoroutineSliceStatistics() const;
+    
+    /// @brief Check if latency statistics are enabled.
+    /// @return True or False.
+    bool getLatencyStatistics() const;
+    
+    /// @brief Check if hardware counter statistics are enabled.
+    /// @return True or False.
+    bool getHardwareCounterStatistics() const;
+    
+    /// @brief Get the long slice detection threshold.
+    /// @return The number of microseconds.
+    std::chrono::microseconds getLongSliceThresholdUs() const;
+    
+    /// @brief Get the long slice callback.
+    /// @return The callback.
+    const LongSliceCallback& getLongSliceCallback() const;
+    
+    /// @brief Get the watchdog sampling interval.
+    /// @return The number of milliseconds.
+    std::chrono::milliseconds getWatchdogIntervalMs() const;
+    
+    /// @brief Get the stuck queue threshold.
+    /// @return The number of milliseconds.
+    std::chrono::milliseconds getQueueStallThresholdMs() const;
+    
+    /// @brief Get the blocked coroutine threshold.
+    /// @return The number of milliseconds.
+    std::chrono::milliseconds getBlockedCoroutineThresholdMs() const;
+    
+    /// @brief Get the stall callback.
+    /// @return The callback.
+    const StallCallback& getStallCallback() const;
+    
+    /// @brief Check if the watchdog is enabled i.e. if it has an interval and a callback.
+    /// @return True or False.
+    bool isWatchdogEnabled() const;
+    
+    /// @brief Get the metrics export interval.
+    /// @return The number of milliseconds.
+    std::chrono::milliseconds getMetricsExportIntervalMs() const;
+    
+    /// @brief Get the metrics exporter.
+    /// @return The callback.
+    const MetricsExporter& getMetricsExporter() const;
+    
+    /// @brief Get the sampling profiler interval.
+    /// @return The number of microseconds.
+    std::chrono::microseconds getSamplingProfilerIntervalUs() const;
+    
+    /// @brief Get the initial number of blocks of an allocator pool.
+    /// @return The number of blocks or 0 if the AllocatorTraits value is used.
+    size_t getPoolAllocSize(PoolType pool) const;
+    
+    /// @brief Check if the allocator pools are pre-faulted.
+    /// @return True or False.
+    bool getPoolWarmup() const;
+    
+    /// @brief Get the CPUs on which the pool warmup runs.
+    /// @return The CPU ids.
+    const CpuSet& getPoolWarmupCpuSet() const;
+    
+    /// @brief Get the terminate policy.
+    /// @return The policy.
+    TerminatePolicy getTerminatePolicy() const;
+    
+    /// @brief Get the detached error callback.
+    /// @return The callback.
+    const ErrorCallback& getDetachedErrorCallback() const;
+    
+    /// @brief Get the queue high watermark.
+    /// @return The number of tasks.
+    size_t getQueueHighWatermark() const;
+    
+    /// @brief Get the queue low watermark.
+    /// @return The number of tasks. Resolves to half of the high watermark if not set.
+    size_t getQueueLowWatermark() const;
+    
+    /// @brief Get the global high watermark.
+    /// @return The number of tasks.
+    size_t getGlobalHighWatermark() const;
+    
+    /// @brief Get the global low watermark.
+    /// @return The number of tasks. Resolves to half of the high watermark if not set.
+    size_t getGlobalLowWatermark() const;
+    
+    /// @brief Get the admission policy.
+    /// @return The policy.
+    AdmissionPolicy getAdmissionPolicy() const;
+    
 private:
+    void setFromJson(const std::string& key, const JsonValue& value);
+    static int intFromJson(const JsonValue& value);
+    static size_t sizeFromJson(const JsonValue& value);
+    static CpuSet cpuSetFromJson(const JsonValue& value);
+    static void writeCpuSet(std::ostream& out, const CpuSet& cpuSet);
+    template <class ENUM>
+    static ENUM enumFromJson(const JsonValue& value);
+    static const std::vector<const char*>& enumNames(BackoffPolicy);
+    static const std::vector<const char*>& enumNames(IdlePolicy);
+    static const std::vector<const char*>& enumNames(QueueSelectionPolicy);
+    static const std::vector<const char*>& enumNames(TerminatePolicy);
+    static const std::vector<const char*>& enumNames(AdmissionPolicy);
+    static const std::vector<const char*>& poolNames(); //in the order of PoolType
+    
     int                         _numCoroutineThreads{-1};
     int                         _numIoThreads{5};
+    int                         _numManualCoroutineQueues{0};
+    bool                        _lazyThreadStart{false};
+    int                         _maxNumIoThreads{0};
+    size_t                      _ioThreadGrowthBacklog{16};
+    std::chrono::milliseconds   _ioThreadIdleTimeoutMs{5000};
     bool                        _pinCoroutineThreadsToCores{false};
+    std::vector<CpuSet>         _coroutineCpuSets;
+    std::vector<CpuSet>         _ioCpuSets;
     bool                        _loadBalanceSharedIoQueues{false};
     std::chrono::milliseconds   _loadBalancePollIntervalMs{100};
     BackoffPolicy               _loadBalancePollIntervalBackoffPolicy{BackoffPolicy::Linear};
     size_t                      _loadBalancePollIntervalNumBackoffs{0};
+    bool                        _coroutineWorkStealing{false};
+    std::chrono::milliseconds   _coroutineWorkStealingPollIntervalMs{10};
+    bool                        _coroutineMigration{false};
+    IdlePolicy                  _idlePolicy{IdlePolicy::Park};
+    std::chrono::microseconds   _idleSpinTimeUs{100};
+    QueueSelectionPolicy        _coroutineQueueSelectionPolicy{QueueSelectionPolicy::Shortest};
+    size_t                      _priorityStarvationLimit{16};
+    bool                        _resumeSignalledCoroutinesFirst{true};
+    bool                        _coroutineSliceStatistics{false};
+    bool                        _latencyStatistics{false};
+    bool                        _hardwareCounterStatistics{false};
+    std::chrono::microseconds   _longSliceThresholdUs{0};
+    LongSliceCallback           _longSliceCallback;
+    std::chrono::milliseconds   _watchdogIntervalMs{0};
+    std::chrono::milliseconds   _queueStallThresholdMs{1000};
+    std::chrono::milliseconds   _blockedCoroutineThresholdMs{0};
+    StallCallback               _stallCallback;
+    std::chrono::milliseconds   _metricsExportIntervalMs{0};
+    MetricsExporter             _metricsExporter;
+    std::chrono::microseconds   _samplingProfilerIntervalUs{0};
+    std::array<size_t, (int)PoolType::Max> _poolAllocSizes{};
+    bool                        _poolWarmup{false};
+    CpuSet                      _poolWarmupCpuSet;
+    TerminatePolicy             _terminatePolicy{TerminatePolicy::Discard};
+    ErrorCallback               _detachedErrorCallback;
+    size_t                      _queueHighWatermark{0};
+    size_t                      _queueLowWatermark{0};
+    size_t                      _globalHighWatermark{0};
+    size_t                      _globalLowWatermark{0};
+    AdmissionPolicy             _admissionPolicy{AdmissionPolicy::Unbounded};
 };
 
 }}
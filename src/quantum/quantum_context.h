@@ -21,7 +21,10 @@
 #include <quantum/quantum_io_task.h>
 #include <quantum/quantum_dispatcher_core.h>
 #include <quantum/quantum_traits.h>
+#include <quantum/quantum_clock.h>
 #include <iterator>
+#include <cerrno>
+#include <unistd.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -42,6 +45,7 @@ class Context : public IThreadContext<RET>,
     friend class Task;
     friend class Dispatcher;
     template <class OTHER_RET> friend class Context;
+    template <typename, typename, AllocatorTraits::size_type&(*)()> friend struct SharedAllocator;
     
 public:
     using Ptr = std::shared_ptr<Context<RET>>;
@@ -86,6 +90,7 @@ public:
     //===================================
     RET get() final;
     const RET& getRef() const final;
+    SharedFuture<RET> getSharedFuture() const;
     
     //===================================
     //        ICOROCONTEXTBASE
@@ -108,7 +113,12 @@ public:
     void setYieldHandle(Traits::Yield& yield) final;
     Traits::Yield& getYieldHandle() final;
     void yield() final;
+    
+    void yieldTo(ICoroSync::Ptr other) final;
     std::atomic_int& signal() final;
+    void wakeUp() final;
+    void setWakeUpTime(std::chrono::steady_clock::time_point time) final;
+    void clearWakeUpTime() final;
     void sleep(std::chrono::milliseconds timeMs) final;
     
     //===================================
@@ -126,12 +136,24 @@ public:
     template <class BUF = RET, class V = BufferValue<BUF>>
     void push(ICoroSync::Ptr sync, V &&value);
     
+    template <class BUF = RET, class V = BufferValue<BUF>>
+    void pushMany(std::vector<V> values);
+    
+    template <class BUF = RET, class V = BufferValue<BUF>>
+    void pushMany(ICoroSync::Ptr sync, std::vector<V> values);
+    
     template <class BUF = RET, class V = BufferValue<BUF>>
     V pull(bool& isBufferClosed);
     
     template <class BUF = RET, class V = BufferValue<BUF>>
     V pull(ICoroSync::Ptr sync, bool& isBufferClosed);
     
+    template <class BUF = RET, class V = BufferValue<BUF>>
+    size_t pullMany(std::vector<V>& values, size_t maxCount, bool& isBufferClosed);
+    
+    template <class BUF = RET, class V = BufferValue<BUF>>
+    size_t pullMany(ICoroSync::Ptr sync, std::vector<V>& values, size_t maxCount, bool& isBufferClosed);
+    
     template <class BUF = RET, class V = BufferValue<BUF>>
     int closeBuffer();
     
@@ -157,6 +179,22 @@ public:
     
     int getNumIoThreads() const;
     
+    bool isCancelled() const;
+    
+    template <class T>
+    T* getLocal(const CoroLocal<T>& slot) const;
+    
+    template <class T>
+    void setLocal(const CoroLocal<T>& slot, std::shared_ptr<T> value);
+    
+    bool awaitReadable(int fd, std::chrono::milliseconds timeMs);
+    
+    bool awaitWritable(int fd, std::chrono::milliseconds timeMs);
+    
+    ssize_t read(int fd, void* buffer, size_t size);
+    
+    ssize_t write(int fd, const void* buffer, size_t size);
+    
     //===================================
     //        TASK CONTINUATIONS
     //===================================
@@ -168,6 +206,14 @@ public:
     typename Context<OTHER_RET>::Ptr
     post(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    typename Context<OTHER_RET>::Ptr
+    post(int queueId, IQueue::Priority priority, FUNC&& func, ARGS&&... args);
+    
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    typename Context<OTHER_RET>::Ptr
+    post(int queueId, IQueue::Priority priority, std::chrono::steady_clock::time_point deadline, FUNC&& func, ARGS&&... args);
+    
     template <class OTHER_RET, class FUNC, class ... ARGS>
     typename Context<OTHER_RET>::Ptr
     postFirst(FUNC&& func, ARGS&&... args);
@@ -176,10 +222,30 @@ public:
     typename Context<OTHER_RET>::Ptr
     postFirst(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    typename Context<OTHER_RET>::Ptr
+    postFirst(int queueId, IQueue::Priority priority, FUNC&& func, ARGS&&... args);
+    
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    typename Context<OTHER_RET>::Ptr
+    postFirst(int queueId, IQueue::Priority priority, std::chrono::steady_clock::time_point deadline, FUNC&& func, ARGS&&... args);
+    
+    template <class OTHER_RET, class FUNC_IT, class = Traits::IsInputIterator<FUNC_IT>>
+    std::vector<CoroContextPtr<OTHER_RET>>
+    postBatch(FUNC_IT first, FUNC_IT last);
+    
+    template <class OTHER_RET, class FUNC_IT, class = Traits::IsInputIterator<FUNC_IT>>
+    std::vector<CoroContextPtr<OTHER_RET>>
+    postBatch(int queueId, bool isHighPriority, FUNC_IT first, FUNC_IT last);
+    
     template <class OTHER_RET, class FUNC, class ... ARGS>
     typename Context<OTHER_RET>::Ptr
     then(FUNC&& func, ARGS&&... args);
     
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    typename Context<OTHER_RET>::Ptr
+    then(StackSizeClass stackSize, FUNC&& func, ARGS&&... args);
+    
     template <class OTHER_RET, class FUNC, class ... ARGS>
     typename Context<OTHER_RET>::Ptr
     onError(FUNC&& func, ARGS&&... args);
@@ -201,6 +267,44 @@ public:
     CoroFuturePtr<OTHER_RET>
     postAsyncIo(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    CoroFuturePtr<OTHER_RET>
+    postAsyncIo(int queueId, bool isHighPriority, std::chrono::steady_clock::time_point deadline, FUNC&& func, ARGS&&... args);
+    
+    template <class OTHER_RET, class FUNC_IT, class = Traits::IsInputIterator<FUNC_IT>>
+    std::vector<CoroFuturePtr<OTHER_RET>>
+    postAsyncIoBatch(FUNC_IT first, FUNC_IT last);
+    
+    template <class OTHER_RET, class FUNC_IT, class = Traits::IsInputIterator<FUNC_IT>>
+    std::vector<CoroFuturePtr<OTHER_RET>>
+    postAsyncIoBatch(int queueId, bool isHighPriority, FUNC_IT first, FUNC_IT last);
+    
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    typename Context<OTHER_RET>::Ptr
+    postAfter(std::chrono::milliseconds delay, FUNC&& func, ARGS&&... args);
+    
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    typename Context<OTHER_RET>::Ptr
+    postAfter(std::chrono::milliseconds delay, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    typename Context<OTHER_RET>::Ptr
+    postAt(std::chrono::steady_clock::time_point time, FUNC&& func, ARGS&&... args);
+    
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    typename Context<OTHER_RET>::Ptr
+    postAt(std::chrono::steady_clock::time_point time, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    size_t
+    postEvery(std::chrono::milliseconds period, FUNC&& func, ARGS&&... args);
+    
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    size_t
+    postEvery(std::chrono::milliseconds period, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    bool cancelTimer(size_t timerId);
+    
     //===================================
     //           FOR EACH
     //===================================
@@ -212,6 +316,22 @@ public:
     typename Context<std::vector<OTHER_RET>>::Ptr
     forEach(INPUT_IT first, size_t num, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func);
     
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename Context<std::vector<OTHER_RET>>::Ptr
+    forEach(INPUT_IT first, INPUT_IT last, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func, GrainSize grain);
+    
+    template <class OTHER_RET, class INPUT_IT>
+    typename Context<std::vector<OTHER_RET>>::Ptr
+    forEach(INPUT_IT first, size_t num, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func, GrainSize grain);
+    
+    template <class OTHER_RET, class INPUT_IT, class OUTPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    std::shared_ptr<Context<int>>
+    forEach(INPUT_IT first, INPUT_IT last, OUTPUT_IT out, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func);
+    
+    template <class OTHER_RET, class INPUT_IT, class OUTPUT_IT>
+    std::shared_ptr<Context<int>>
+    forEach(INPUT_IT first, size_t num, OUTPUT_IT out, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func);
+    
     template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
     typename Context<std::vector<std::vector<OTHER_RET>>>::Ptr
     forEachBatch(INPUT_IT first, INPUT_IT last, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func);
@@ -220,6 +340,44 @@ public:
     typename Context<std::vector<std::vector<OTHER_RET>>>::Ptr
     forEachBatch(INPUT_IT first, size_t num, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func);
     
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename Context<std::vector<std::vector<OTHER_RET>>>::Ptr
+    forEachBatch(INPUT_IT first, INPUT_IT last, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func, GrainSize grain);
+    
+    template <class OTHER_RET, class INPUT_IT>
+    typename Context<std::vector<std::vector<OTHER_RET>>>::Ptr
+    forEachBatch(INPUT_IT first, size_t num, Functions::ForEachFunc<OTHER_RET, INPUT_IT> func, GrainSize grain);
+    
+    template <class OTHER_RET, class INPUT_IT, class FUNC,
+              class = Traits::IsInputIterator<INPUT_IT>,
+              class = Traits::IsNotStdFunction<FUNC, Functions::ForEachFunc<OTHER_RET, INPUT_IT>>>
+    typename Context<std::vector<std::vector<OTHER_RET>>>::Ptr
+    forEachBatch(INPUT_IT first, INPUT_IT last, FUNC&& func);
+    
+    template <class OTHER_RET, class INPUT_IT, class FUNC,
+              class = Traits::IsNotStdFunction<FUNC, Functions::ForEachFunc<OTHER_RET, INPUT_IT>>>
+    typename Context<std::vector<std::vector<OTHER_RET>>>::Ptr
+    forEachBatch(INPUT_IT first, size_t num, FUNC&& func);
+    
+    template <class OTHER_RET, class INPUT_IT, class FUNC,
+              class = Traits::IsInputIterator<INPUT_IT>,
+              class = Traits::IsNotStdFunction<FUNC, Functions::ForEachFunc<OTHER_RET, INPUT_IT>>>
+    typename Context<std::vector<std::vector<OTHER_RET>>>::Ptr
+    forEachBatch(INPUT_IT first, INPUT_IT last, FUNC&& func, GrainSize grain);
+    
+    template <class OTHER_RET, class INPUT_IT, class FUNC,
+              class = Traits::IsNotStdFunction<FUNC, Functions::ForEachFunc<OTHER_RET, INPUT_IT>>>
+    typename Context<std::vector<std::vector<OTHER_RET>>>::Ptr
+    forEachBatch(INPUT_IT first, size_t num, FUNC&& func, GrainSize grain);
+    
+    template <class INPUT_TYPE, class OUTPUT_TYPE, class KERNEL>
+    std::shared_ptr<Context<int>>
+    forEachKernel(const INPUT_TYPE* first, size_t num, OUTPUT_TYPE* out, KERNEL&& kernel);
+    
+    template <class OUTPUT_TYPE, class INPUT_TYPE, class KERNEL>
+    typename Context<std::vector<OUTPUT_TYPE>>::Ptr
+    forEachKernel(const INPUT_TYPE* first, size_t num, KERNEL&& kernel);
+    
     //===================================
     //           MAP REDUCE
     //===================================
@@ -265,16 +423,177 @@ public:
                    Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
                    Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
     
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class INPUT_IT,
+              class MAPPER,
+              class REDUCER,
+              class = Traits::IsInputIterator<INPUT_IT>,
+              class = Traits::IsNotStdFunction<MAPPER, Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>>,
+              class = Traits::IsNotStdFunction<REDUCER, Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>>>
+    typename Context<std::map<KEY, REDUCED_TYPE>>::Ptr
+    mapReduceBatch(INPUT_IT first,
+                   INPUT_IT last,
+                   MAPPER&& mapper,
+                   REDUCER&& reducer);
+    
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class INPUT_IT,
+              class MAPPER,
+              class REDUCER,
+              class = Traits::IsNotStdFunction<MAPPER, Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>>,
+              class = Traits::IsNotStdFunction<REDUCER, Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>>>
+    typename Context<std::map<KEY, REDUCED_TYPE>>::Ptr
+    mapReduceBatch(INPUT_IT first,
+                   size_t num,
+                   MAPPER&& mapper,
+                   REDUCER&& reducer);
+    
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class OUTPUT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT_IT,
+              class = Traits::IsInputIterator<INPUT_IT>>
+    typename Context<OUTPUT>::Ptr
+    mapReducePartitioned(INPUT_IT first,
+                         INPUT_IT last,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
+    
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class OUTPUT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT_IT>
+    typename Context<OUTPUT>::Ptr
+    mapReducePartitioned(INPUT_IT first,
+                         size_t num,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
+    
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class OUTPUT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT_IT,
+              class = Traits::IsInputIterator<INPUT_IT>>
+    typename Context<OUTPUT>::Ptr
+    mapReducePartitioned(INPUT_IT first,
+                         INPUT_IT last,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::CombineFunc<MAPPED_TYPE> combiner,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
+    
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class OUTPUT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT_IT>
+    typename Context<OUTPUT>::Ptr
+    mapReducePartitioned(INPUT_IT first,
+                         size_t num,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::CombineFunc<MAPPED_TYPE> combiner,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
+    
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class OUTPUT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT>
+    typename Context<Buffer<OUTPUT>>::Ptr
+    mapReduceStream(std::shared_ptr<ICoroFuture<Buffer<INPUT>>> input,
+                    Functions::StreamMapFunc<KEY, MAPPED_TYPE, INPUT> mapper,
+                    Functions::FoldFunc<REDUCED_TYPE, MAPPED_TYPE> reducer,
+                    size_t windowSize = 0);
+    
+    //===================================
+    //         REDUCE AND SCAN
+    //===================================
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename Context<OTHER_RET>::Ptr
+    reduce(INPUT_IT first,
+           INPUT_IT last,
+           OTHER_RET init,
+           Functions::BinaryFunc<OTHER_RET> op);
+    
+    template <class OTHER_RET, class INPUT_IT>
+    typename Context<OTHER_RET>::Ptr
+    reduce(INPUT_IT first,
+           size_t num,
+           OTHER_RET init,
+           Functions::BinaryFunc<OTHER_RET> op);
+    
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename Context<OTHER_RET>::Ptr
+    transformReduce(INPUT_IT first,
+                    INPUT_IT last,
+                    OTHER_RET init,
+                    Functions::BinaryFunc<OTHER_RET> reduceOp,
+                    Functions::ForEachFunc<OTHER_RET, INPUT_IT> transform);
+    
+    template <class OTHER_RET, class INPUT_IT>
+    typename Context<OTHER_RET>::Ptr
+    transformReduce(INPUT_IT first,
+                    size_t num,
+                    OTHER_RET init,
+                    Functions::BinaryFunc<OTHER_RET> reduceOp,
+                    Functions::ForEachFunc<OTHER_RET, INPUT_IT> transform);
+    
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename Context<std::vector<OTHER_RET>>::Ptr
+    inclusiveScan(INPUT_IT first,
+                  INPUT_IT last,
+                  Functions::BinaryFunc<OTHER_RET> op);
+    
+    template <class OTHER_RET, class INPUT_IT>
+    typename Context<std::vector<OTHER_RET>>::Ptr
+    inclusiveScan(INPUT_IT first,
+                  size_t num,
+                  Functions::BinaryFunc<OTHER_RET> op);
+    
+    template <class OTHER_RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    typename Context<std::vector<OTHER_RET>>::Ptr
+    exclusiveScan(INPUT_IT first,
+                  INPUT_IT last,
+                  OTHER_RET init,
+                  Functions::BinaryFunc<OTHER_RET> op);
+    
+    template <class OTHER_RET, class INPUT_IT>
+    typename Context<std::vector<OTHER_RET>>::Ptr
+    exclusiveScan(INPUT_IT first,
+                  size_t num,
+                  OTHER_RET init,
+                  Functions::BinaryFunc<OTHER_RET> op);
+    
+    template <class RANDOM_IT, class COMPARE = std::less<typename std::iterator_traits<RANDOM_IT>::value_type>>
+    std::shared_ptr<Context<int>>
+    sort(RANDOM_IT first, RANDOM_IT last, COMPARE compare = COMPARE());
+    
+    template <class RANDOM_IT, class COMPARE = std::less<typename std::iterator_traits<RANDOM_IT>::value_type>>
+    std::shared_ptr<Context<int>>
+    stableSort(RANDOM_IT first, RANDOM_IT last, COMPARE compare = COMPARE());
+    
     //===================================
     //           NEW / DELETE
     //===================================
     static void* operator new(size_t size);
     static void operator delete(void* p);
     static void deleter(Context<RET>* p);
+    /// @brief Creates an object whose reference counts share its pool block (see SharedAllocator).
+    template <class ... ARGS>
+    static Ptr create(ARGS&&... args);
     
 private:
     explicit Context(DispatcherCore& dispatcher);
     
+    //A detached context has no promise. Values set are dropped and exceptions go to the dispatcher error callback.
+    Context(DispatcherCore& dispatcher, bool isDetached);
+    
     template <class OTHER_RET>
     Context(Context<OTHER_RET>& other);
     
@@ -282,25 +601,53 @@ private:
     
     template <class OTHER_RET, class FUNC, class ... ARGS>
     typename Context<OTHER_RET>::Ptr
-    thenImpl(ITask::Type type, FUNC&& func, ARGS&&... args);
+    thenImpl(ITask::Type type, StackSizeClass stackSize, FUNC&& func, ARGS&&... args);
 
     template <class OTHER_RET, class FUNC, class ... ARGS>
     typename Context<OTHER_RET>::Ptr
-    postImpl(int queueId, bool isHighPriority, ITask::Type type, FUNC&& func, ARGS&&... args);
+    postImpl(int queueId,
+             IQueue::Priority priority,
+             std::chrono::steady_clock::time_point deadline,
+             ITask::Type type,
+             FUNC&& func,
+             ARGS&&... args);
     
     template <class OTHER_RET, class FUNC, class ... ARGS>
     CoroFuturePtr<OTHER_RET>
-    postAsyncIoImpl(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    postAsyncIoImpl(int queueId, bool isHighPriority, std::chrono::steady_clock::time_point deadline, FUNC&& func, ARGS&&... args);
+    
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    typename Context<OTHER_RET>::Ptr
+    postAtImpl(std::chrono::steady_clock::time_point time, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    template <class OTHER_RET, class FUNC, class ... ARGS>
+    size_t
+    postEveryImpl(std::chrono::milliseconds period, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    bool awaitEvent(int fd, Reactor::Event event, std::chrono::milliseconds timeMs);
+    
+    void admit(IQueue::QueueType type, int queueId, bool isHighPriority); //yields while the target is saturated
     
     int index(int num) const;
     
+    const IPromiseBase::Ptr& promiseAt(int num) const; //throws
+    
+    Promise<RET>& promise() const; //throws if detached
+    
+    template <class OTHER_RET>
+    SharedState<OTHER_RET>& sharedStateAt(int num) const; //throws
+    
     void validateTaskType(ITask::Type type) const; //throws
     
-    void validateContext(ICoroSync::Ptr sync) const; //throws
+    void validateContext(const ICoroSync::Ptr& sync) const; //throws
+    
+    using PromiseChain = std::vector<IPromiseBase::Ptr>;
     
     //Members
     ITask::Ptr                          _task;
-    std::vector<IPromiseBase::Ptr>      _promises;
+    IPromiseBase::Ptr                   _promise; //promise set by this context. Null if detached.
+    std::shared_ptr<PromiseChain>       _chain; //promises of all the stages, shared along a continuation chain. Null until chained.
+    int                                 _position; //index of this stage in the chain
     DispatcherCore*                     _dispatcher;
     std::atomic_flag                    _terminated;
     std::atomic_int                     _signal;
@@ -21,7 +21,11 @@
 #include <limits>
 #include <type_traits>
 #include <utility>
+#include <vector>
 #include <quantum/quantum_spinlock.h>
+#include <quantum/quantum_allocator_traits.h>
+#include <quantum/quantum_allocator_statistics.h>
+#include <quantum/quantum_pool_thread_cache.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -32,8 +36,13 @@ namespace quantum {
 /// @struct ContiguousPoolManager.
 /// @brief Provides fast (quasi zero-time) in-place allocation for STL containers.
 ///        Objects are allocated from a contiguous buffer (aka object pool). When the
-///        buffer is exhausted, allocation is delegated to the heap. The default
-///        buffer size is 1000.
+///        buffer is exhausted, the pool grows by adding heap-allocated slabs, each one
+///        as large as the current pool capacity, up to AllocatorTraits::maxPoolSlabs().
+///        Past that limit (or for multi-block allocations) allocation is delegated to
+///        the heap. Slabs which become unused are given back to the heap, keeping
+///        AllocatorTraits::poolSpareSlabs() of them in reserve. The default buffer size is 1000.
+///        Single blocks of the initial buffer are served from per-thread caches which
+///        are refilled and flushed in batches (see PoolThreadCache).
 /// @tparam T The type to allocate.
 /// @note This allocator is thread safe. For internal use only.
 template <typename T>
@@ -47,7 +56,7 @@ struct ContiguousPoolManager
     typedef value_type&                     reference;
     typedef const value_type&               const_reference;
     typedef size_t                          size_type;
-    typedef uint16_t                        index_type;
+    typedef uint32_t                        index_type;
     typedef std::aligned_storage<sizeof(T), alignof(T)> storage_type;
     typedef typename storage_type::type     aligned_type;
     
@@ -75,15 +84,43 @@ struct ContiguousPoolManager
     void dispose(pointer p);
     size_t allocatedBlocks() const;
     size_t allocatedHeapBlocks() const;
+    size_t numSlabs() const;
+    void releaseUnusedSlabs();
     bool isFull() const;
     bool isEmpty() const;
+    PoolStatistics stats() const;
+    void warmUp();
     
 private:
+    typedef PoolThreadCache<this_type, pointer> thread_cache_type;
+    friend struct PoolThreadCache<this_type, pointer>;
+    
+    struct Slab
+    {
+        aligned_type*   _buffer;
+        index_type*     _freeBlocks;
+        index_type      _size;
+        ssize_t         _freeBlockIndex;
+    };
+    
     pointer bufferStart();
     pointer bufferEnd();
     bool isManaged(pointer p);
     index_type blockIndex(pointer p);
     bool findContiguous(index_type n);
+    pointer allocateFromSlab();
+    bool deallocateToSlab(pointer p, size_type n, Slab& released);
+    static bool isManaged(const Slab& slab, pointer p);
+    static bool isUnused(const Slab& slab);
+    static void deleteSlab(Slab& slab);
+    void attachThreadCache(thread_cache_type& cache);
+    void detachThreadCache(thread_cache_type& cache);
+    size_t refillThreadCache(thread_cache_type& cache);
+    void flushThreadCache(thread_cache_type& cache, size_t num);
+    size_t numCachedBlocks() const;
+    size_t usedBlocks() const;
+    size_t capacity() const;
+    void updatePeak();
 
     //------------------------------- Members ----------------------------------
     index_type          _size{0};
@@ -91,6 +128,10 @@ private:
     index_type*         _freeBlocks{nullptr};
     ssize_t             _freeBlockIndex{-1};
     size_t              _numHeapAllocatedBlocks{0};
+    size_t              _numHeapFallbacks{0}; //cumulative
+    size_t              _peakBlocks{0}; //sampled on the slow paths
+    std::vector<Slab>   _slabs; //grown slabs, owned
+    std::vector<thread_cache_type*> _threadCaches; //caches holding blocks of the initial buffer
     mutable SpinLock    _spinlock;
 };
 
@@ -0,0 +1,93 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_CORO_LOCAL_H
+#define QUANTUM_CORO_LOCAL_H
+
+#include <memory>
+#include <vector>
+#include <atomic>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                 class CoroLocal
+//==============================================================================================
+/// @class CoroLocal
+/// @brief Identifies a coroutine-local storage slot holding a value of type T. Slots are typically declared
+///        as static objects at startup and each one is assigned a unique index, so that accessing
+///        the slot from a coroutine is a plain array access.
+/// @note Use ICoroContext::getLocal() and ICoroContext::setLocal() to access the slot. Values are shared
+///       along a continuation chain. If 'isInheritedByChildren' is set, coroutines posted from within
+///       a coroutine also see the value, which is shared with their parent.
+template <class T>
+class CoroLocal
+{
+public:
+    /// @brief Constructor.
+    /// @param[in] isInheritedByChildren If true, coroutines posted from within a coroutine inherit this slot.
+    explicit CoroLocal(bool isInheritedByChildren = false);
+
+    /// @brief Get the index of this slot.
+    size_t index() const;
+
+    /// @brief Check if this slot is inherited by child coroutines.
+    bool isInheritedByChildren() const;
+
+private:
+    size_t  _index;
+    bool    _isInheritedByChildren;
+};
+
+//==============================================================================================
+//                                 class CoroLocalStorage
+//==============================================================================================
+/// @class CoroLocalStorage
+/// @brief Holds the coroutine-local values of a coroutine and its continuations.
+/// @note For internal use only. A storage object is accessed by one coroutine at a time.
+class CoroLocalStorage
+{
+public:
+    using Ptr = std::shared_ptr<CoroLocalStorage>;
+
+    /// @brief Assign a new slot index.
+    static size_t registerSlot();
+
+    /// @brief Create the storage of a child coroutine.
+    /// @return A copy holding only the inherited slots or null if there are none.
+    static Ptr inherit(const Ptr& parent);
+
+    void* get(size_t index) const;
+
+    void set(size_t index, std::shared_ptr<void> value, bool isInherited);
+
+private:
+    struct Slot
+    {
+        std::shared_ptr<void>   _value;
+        bool                    _isInherited{false};
+    };
+
+    //Members
+    std::vector<Slot>   _slots; //indexed by slot index
+    size_t              _numInherited{0};
+};
+
+}}
+
+#include <quantum/impl/quantum_coro_local_impl.h>
+
+#endif //QUANTUM_CORO_LOCAL_H
@@ -21,7 +21,12 @@
 #include <limits>
 #include <type_traits>
 #include <utility>
+#include <list>
+#include <vector>
 #include <quantum/quantum_spinlock.h>
+#include <quantum/quantum_allocator_traits.h>
+#include <quantum/quantum_allocator_statistics.h>
+#include <quantum/quantum_pool_thread_cache.h>
 #include <boost/context/stack_context.hpp>
 
 namespace Bloomberg {
@@ -33,7 +38,14 @@ namespace quantum {
 /// @struct CoroutinePoolAllocator.
 /// @brief Provides fast (quasi zero-time) in-place allocation for coroutines.
 ///        Coroutine stacks are pre-allocated from separate (i.e. non-contiguous)
-///        heap blocks and maintained in a reusable list.
+///        heap blocks and maintained in a reusable list. When all the stacks are in use,
+///        the pool grows by slabs of stacks, each one as large as the current pool capacity,
+///        up to AllocatorTraits::maxPoolSlabs(). Past that limit stacks are allocated from the
+///        heap. Slabs which become unused are given back, keeping AllocatorTraits::poolSpareSlabs().
+///        Stacks of the initial pool are served from per-thread caches (see PoolThreadCache).
+///        Stacks are carved from the heap or, if AllocatorTraits::useMmapCoroStacks() is set,
+///        mapped individually with a guard page below them. If AllocatorTraits::paintCoroStacks()
+///        is set, the high-water mark of each stack is measured when it is returned.
 /// @note This allocator is thread safe. For internal use only and is meant to
 ///       replace the boost fixed size pool allocator which crashes.
 template <typename STACK_TRAITS>
@@ -42,11 +54,11 @@ struct CoroutinePoolAllocator
     //------------------------------ Typedefs ----------------------------------
     typedef CoroutinePoolAllocator<STACK_TRAITS>  this_type;
     typedef size_t                                size_type;
-    typedef uint16_t                              index_type;
+    typedef uint32_t                              index_type;
     typedef STACK_TRAITS                          traits;
     
     //------------------------------- Methods ----------------------------------
-    CoroutinePoolAllocator(index_type size);
+    CoroutinePoolAllocator(index_type size, size_t stackSize = 0); //0 uses the traits default size
     CoroutinePoolAllocator(const this_type&) = delete;
     CoroutinePoolAllocator(this_type&&);
     CoroutinePoolAllocator& operator=(const this_type&) = delete;
@@ -58,17 +70,55 @@ struct CoroutinePoolAllocator
     void deallocate(const boost::context::stack_context& ctx);
     size_t allocatedBlocks() const;
     size_t allocatedHeapBlocks() const;
+    size_t numSlabs() const;
+    void releaseUnusedSlabs();
     bool isFull() const;
     bool isEmpty() const;
+    PoolStatistics stats() const;
+    void warmUp();
     
 private:
+    struct Slab;
+    
+    //Located at the top of each stack block, above the stack pointer
     struct Header {
-        int _pos;
+        int     _pos;
+        Slab*   _slab; //null for the blocks of the initial pool
+    };
+    
+    struct Slab {
+        Header**        _blocks;
+        index_type*     _freeBlocks;
+        index_type      _size;
+        ssize_t         _freeBlockIndex;
     };
     
+    typedef PoolThreadCache<this_type, Header*> thread_cache_type;
+    friend struct PoolThreadCache<this_type, Header*>;
+    
     int blockIndex(const boost::context::stack_context& ctx) const;
     bool isManaged(const boost::context::stack_context& ctx) const;
     Header* getHeader(const boost::context::stack_context& ctx) const;
+    Header* allocateStack(int pos, Slab* slab);
+    void deallocateStack(Header* header);
+    void trimStack(Header* header);
+    void warmUpStack(Header* header);
+    char* stackBottom(Header* header) const;
+    void paintStack(char* from, char* to);
+    size_t measureStack(Header* header);
+    Header* allocateFromSlab();
+    Header* growAndAllocate(size_t size);
+    void makeSlab(Slab& slab, size_t size);
+    void deleteSlab(Slab& slab);
+    static bool isUnused(const Slab& slab);
+    void attachThreadCache(thread_cache_type& cache);
+    void detachThreadCache(thread_cache_type& cache);
+    size_t refillThreadCache(thread_cache_type& cache);
+    void flushThreadCache(thread_cache_type& cache, size_t num);
+    size_t numCachedBlocks() const;
+    size_t usedBlocks() const;
+    size_t capacity() const;
+    void updatePeak();
     
     //------------------------------- Members ----------------------------------
     index_type          _size;
@@ -76,7 +126,16 @@ private:
     index_type*         _freeBlocks;
     ssize_t             _freeBlockIndex;
     size_t              _numHeapAllocatedBlocks;
+    size_t              _numHeapFallbacks; //cumulative
+    size_t              _peakBlocks; //sampled on the slow paths
     size_t              _stackSize;
+    bool                _useMmap;
+    size_t              _pageSize;
+    size_t              _residentSize;
+    bool                _paintStacks;
+    StackUsageHistogram _stackUsage;
+    std::list<Slab>     _slabs; //grown slabs, owned
+    std::vector<thread_cache_type*> _threadCaches; //caches holding stacks of the initial pool
     mutable SpinLock    _spinlock;
 };
 
@@ -85,7 +144,8 @@ struct CoroutinePoolAllocatorProxy
 {
     typedef std::false_type default_constructor;
     
-    CoroutinePoolAllocatorProxy(uint16_t size) : _alloc(new CoroutinePoolAllocator<STACK_TRAITS>(size))
+    CoroutinePoolAllocatorProxy(AllocatorTraits::size_type size, size_t stackSize = 0) :
+        _alloc(new CoroutinePoolAllocator<STACK_TRAITS>(size, stackSize))
     {
         if (!_alloc) {
             throw std::bad_alloc();
@@ -96,8 +156,12 @@ struct CoroutinePoolAllocatorProxy
     void deallocate(const boost::context::stack_context& ctx) { return _alloc->deallocate(ctx); }
     size_t allocatedBlocks() const { return _alloc->allocatedBlocks(); }
     size_t allocatedHeapBlocks() const { return _alloc->allocatedHeapBlocks(); }
+    size_t numSlabs() const { return _alloc->numSlabs(); }
+    void releaseUnusedSlabs() { _alloc->releaseUnusedSlabs(); }
     bool isFull() const { return _alloc->isFull(); }
     bool isEmpty() const { return _alloc->isEmpty(); }
+    PoolStatistics stats() const { return _alloc->stats(); }
+    void warmUp() { _alloc->warmUp(); }
 private:
     std::shared_ptr<CoroutinePoolAllocator<STACK_TRAITS>> _alloc;
 };
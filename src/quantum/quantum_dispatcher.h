@@ -34,6 +34,8 @@ namespace quantum {
 class Dispatcher : public ITerminate
 {
 public:
+    friend class Simulation;
+    
     using ContextTag = ThreadContextTag;
     
     /// @brief Constructor.
@@ -95,6 +97,122 @@ public:
     ThreadContextPtr<RET>
     post(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    /// @brief Post a coroutine to run asynchronously on a specific queue (thread) with the given priority level.
+    /// @param[in] queueId Id of the queue where this coroutine should run. Valid range is [0, numCoroutineThreads)
+    ///                    or IQueue::QueueId::Any.
+    /// @param[in] priority Priority level. Higher levels always run first, subject to the starvation limit set via
+    ///                     Configuration::setPriorityStarvationLimit(). Coroutines of the same level run round-robin.
+    /// @param[in] func Callable object.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A pointer to a thread context object.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    post(int queueId, IQueue::Priority priority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but with a deadline.
+    /// @param[in] deadline Coroutines having a deadline run ahead of the others of the same priority level,
+    ///                     in earliest-deadline-first order. The deadline is inherited by continuations.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    post(int queueId, IQueue::Priority priority, std::chrono::steady_clock::time_point deadline, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a cancellable coroutine to run asynchronously.
+    /// @param[in] token Cancellation token shared by all the work which should be stopped together.
+    /// @param[in] func Callable object.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A pointer to a thread context object.
+    /// @note Once the token is cancelled, the coroutine is discarded by its queue if it has not started yet and
+    ///       its future is broken. A running coroutine can check CoroContext::isCancelled() at its yield points.
+    ///       The token is inherited by continuations as well as by coroutines and IO tasks posted from within.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    post(CancellationToken::Ptr token, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread). See post() for the meaning of 'queueId' and 'isHighPriority'.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    post(CancellationToken::Ptr token, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a coroutine to run asynchronously with a stack taken from a specific size class.
+    /// @param[in] stackSize Size class of the coroutine stack. Each class is served by its own pool so that
+    ///                      shallow coroutines do not pay for the stack size needed by the deepest ones.
+    ///                      See StackTraits::classSize().
+    /// @param[in] func Callable object.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A pointer to a thread context object.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    post(StackSizeClass stackSize, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread). See post() for the meaning of 'queueId' and 'isHighPriority'.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    post(StackSizeClass stackSize, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a coroutine to run asynchronously under a profiler label.
+    /// @param[in] label Name under which the sampling profiler reports the time spent in this coroutine instead
+    ///                  of the type of the callable object. See Configuration::setSamplingProfilerIntervalUs().
+    /// @param[in] func Callable object.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A pointer to a thread context object.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    post(TaskLabel label, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread). See post() for the meaning of 'queueId' and 'isHighPriority'.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    post(TaskLabel label, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a coroutine to run asynchronously once the specified delay has elapsed.
+    /// @param[in] delay Time to wait before the coroutine is posted.
+    /// @param[in] func Callable object.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A pointer to a thread context object.
+    /// @note Until it is due the coroutine is held by the dispatcher's timer queue and does not use a coroutine
+    ///       stack or a slot in the run queues. Pending timers are discarded when the dispatcher terminates.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postAfter(std::chrono::milliseconds delay, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread). See post() for the meaning of 'queueId' and 'isHighPriority'.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postAfter(std::chrono::milliseconds delay, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a coroutine to run asynchronously at the specified time.
+    /// @param[in] time Time when the coroutine is posted.
+    /// @note See postAfter() for details.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postAt(std::chrono::steady_clock::time_point time, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread). See post() for the meaning of 'queueId' and 'isHighPriority'.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postAt(std::chrono::steady_clock::time_point time, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a new instance of a coroutine at a fixed rate until cancelled.
+    /// @param[in] period Interval between posts. The first post happens one period from now.
+    /// @param[in] func Callable object. Must be copyable along with the arguments since every post invokes a copy.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A timer id to be passed to cancelTimer().
+    /// @note The returned value of each instance is discarded. Instances run independently of each other
+    ///       so a slow instance does not delay the next post.
+    template <class RET = int, class FUNC, class ... ARGS>
+    size_t
+    postEvery(std::chrono::milliseconds period, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread). See post() for the meaning of 'queueId' and 'isHighPriority'.
+    template <class RET = int, class FUNC, class ... ARGS>
+    size_t
+    postEvery(std::chrono::milliseconds period, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Cancel a delayed or periodic post.
+    /// @param[in] timerId The id returned by postEvery().
+    /// @return True if the timer was pending, false otherwise.
+    bool cancelTimer(size_t timerId);
+    
     /// @brief Post the first coroutine in a continuation chain to run asynchronously.
     /// @tparam RET Type of future returned by this coroutine.
     /// @tparam FUNC Callable object type which will be wrapped in a coroutine. Can be a standalone function, a method,
@@ -130,6 +248,137 @@ public:
     ThreadContextPtr<RET>
     postFirst(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    /// @brief Post the first coroutine in a continuation chain with the given priority level.
+    /// @note See post() for the meaning of 'priority'. Continuations keep the priority of the first coroutine.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postFirst(int queueId, IQueue::Priority priority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post the first coroutine in a continuation chain with the given priority level and deadline.
+    /// @note See post() for the meaning of 'priority' and 'deadline'.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postFirst(int queueId, IQueue::Priority priority, std::chrono::steady_clock::time_point deadline, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post the first coroutine in a cancellable continuation chain.
+    /// @note See post() for the meaning of 'token'. Once cancelled, the remaining stages of the chain are skipped.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postFirst(CancellationToken::Ptr token, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread). See post() for the meaning of 'queueId' and 'isHighPriority'.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postFirst(CancellationToken::Ptr token, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as postFirst() but the coroutine stack is taken from a specific size class.
+    /// @note See post() for the meaning of 'stackSize'. Continuations use the default size class unless
+    ///       specified in then().
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postFirst(StackSizeClass stackSize, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread). See post() for the meaning of 'queueId' and 'isHighPriority'.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postFirst(StackSizeClass stackSize, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as postFirst() but under a profiler label.
+    /// @note See post() for the meaning of 'label'. Continuations are reported under the type of their callable object.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postFirst(TaskLabel label, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread). See post() for the meaning of 'queueId' and 'isHighPriority'.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postFirst(TaskLabel label, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a batch of coroutines to run asynchronously.
+    /// @details The coroutines are spread evenly across all the queues, starting with the one picked by the
+    ///          configured queue selection policy. Each queue is published to and signalled only once per batch.
+    /// @tparam RET Type of future returned by each coroutine.
+    /// @tparam FUNC_IT Iterator type over callable objects. The signature of each callable object must strictly
+    ///                 be 'int f(CoroContext<RET>::Ptr)'.
+    /// @param[in] first The first callable in the range.
+    /// @param[in] last The last callable in the range (exclusive).
+    /// @return A vector of thread context objects, one per callable and in the same order.
+    /// @note This function is non-blocking and returns immediately. The callables are copied.
+    template <class RET = int, class FUNC_IT, class = Traits::IsInputIterator<FUNC_IT>>
+    std::vector<ThreadContextPtr<RET>>
+    postBatch(FUNC_IT first, FUNC_IT last);
+    
+    /// @brief Post a batch of coroutines to run asynchronously on a specific queue (thread).
+    /// @param[in] queueId Id of the queue where the coroutines should run. Valid range is [0, numCoroutineThreads)
+    ///                    or IQueue::QueueId::Any which is equivalent to the simpler version of postBatch() above.
+    /// @param[in] isHighPriority If set to true, the coroutines will be scheduled to run immediately after the currently
+    ///                           executing coroutine on 'queueId' has completed or has yielded.
+    /// @param[in] first The first callable in the range.
+    /// @param[in] last The last callable in the range (exclusive).
+    /// @return A vector of thread context objects, one per callable and in the same order.
+    template <class RET = int, class FUNC_IT, class = Traits::IsInputIterator<FUNC_IT>>
+    std::vector<ThreadContextPtr<RET>>
+    postBatch(int queueId, bool isHighPriority, FUNC_IT first, FUNC_IT last);
+    
+    /// @brief Post a stackless task to run asynchronously on the coroutine thread pool.
+    /// @details The task is scheduled like a coroutine but runs to completion directly on the queue thread,
+    ///          without a coroutine stack or a context switch. This is best suited for short functions which
+    ///          never yield or wait on coroutine futures.
+    /// @tparam RET Type of future returned by this task.
+    /// @tparam FUNC Callable object type. The signature of the callable object must strictly be
+    ///              'int f(ThreadPromise<RET>::Ptr, ...)', the same as for postAsyncIo().
+    /// @tparam ARGS Argument types passed to FUNC.
+    /// @param[in] func Callable object.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @return A pointer to a thread future object.
+    /// @note This function is non-blocking and returns immediately. The task blocks its queue thread until
+    ///       it returns, hence it must not block (e.g. by waiting on a future) for long.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadFuturePtr<RET>
+    postTask(FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread).
+    /// @param[in] queueId Id of the queue where the task should run. Valid range is [0, numCoroutineThreads)
+    ///                    or IQueue::QueueId::Any.
+    /// @param[in] isHighPriority If set to true, the task will be scheduled to run immediately after the currently
+    ///                           executing coroutine on 'queueId' has completed or has yielded.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadFuturePtr<RET>
+    postTask(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a coroutine whose result is not needed.
+    /// @details Same as post() but no promise or future is allocated. Values set by the coroutine via its
+    ///          context are dropped and exceptions are passed to Configuration::setDetachedErrorCallback().
+    ///          The coroutine can use its context as usual otherwise, e.g. to yield or to post other coroutines.
+    /// @tparam RET Type of value the coroutine would set. Can be omitted.
+    /// @param[in] func Callable object with the signature 'int f(CoroContext<RET>::Ptr, ...)'.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    /// @note Reading the result of its own context (e.g. via get() or pull()) throws inside a detached coroutine.
+    template <class RET = int, class FUNC, class ... ARGS>
+    void
+    postDetached(FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread). See post() for the meaning of 'queueId' and 'isHighPriority'.
+    template <class RET = int, class FUNC, class ... ARGS>
+    void
+    postDetached(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a coroutine unless the dispatcher is saturated.
+    /// @details Same as post() but the post is rejected instead of being handled by the admission policy when the
+    ///          global watermark or the watermark of every queue the coroutine could go to has been reached.
+    ///          See Configuration::setAdmissionPolicy().
+    /// @return A pointer to a thread context object or null if the post was rejected.
+    /// @note Never waits and never throws because of saturation.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    tryPost(FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread). See post() for the meaning of 'queueId' and 'isHighPriority'.
+    /// @note High priority posts are always admitted.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    tryPost(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
     /// @brief Post a blocking IO (or long running) task to run asynchronously on the IO thread pool.
     /// @tparam RET Type of future returned by this task.
     /// @tparam FUNC Callable object type. Can be a standalone function, a method, an std::function,
@@ -162,6 +411,84 @@ public:
     ThreadFuturePtr<RET>
     postAsyncIo(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
+    /// @brief Same as above but with a deadline.
+    /// @param[in] deadline Tasks having a deadline run ahead of the others of the same priority in earliest-deadline-first
+    ///                     order. A task which has not started by its deadline is discarded and its future throws a
+    ///                     DeadlineExceededException.
+    /// @note A task which has started is never interrupted.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadFuturePtr<RET>
+    postAsyncIo(int queueId, bool isHighPriority, std::chrono::steady_clock::time_point deadline, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a cancellable IO task.
+    /// @note See post() for the meaning of 'token'. A cancelled task which has not started yet is discarded
+    ///       by its IO queue and its future is broken.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadFuturePtr<RET>
+    postAsyncIo(CancellationToken::Ptr token, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread). See postAsyncIo() for the meaning of 'queueId' and 'isHighPriority'.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadFuturePtr<RET>
+    postAsyncIo(CancellationToken::Ptr token, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post an IO task whose result is not needed.
+    /// @details No promise or future is allocated. Exceptions are passed to Configuration::setDetachedErrorCallback().
+    /// @param[in] func Callable object with the signature 'int f(...)'. The return value is ignored.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    template <class FUNC, class ... ARGS>
+    void
+    postAsyncIoDetached(FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread). See postAsyncIo() for the meaning of 'queueId' and 'isHighPriority'.
+    template <class FUNC, class ... ARGS>
+    void
+    postAsyncIoDetached(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post an IO task unless the dispatcher is saturated. See tryPost().
+    /// @return A pointer to a thread future object or null if the post was rejected.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadFuturePtr<RET>
+    tryPostAsyncIo(FUNC&& func, ARGS&&... args);
+    
+    /// @brief Same as above but on a specific queue (thread). See postAsyncIo() for the meaning of 'queueId' and 'isHighPriority'.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadFuturePtr<RET>
+    tryPostAsyncIo(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    /// @brief Post a batch of blocking IO (or long running) tasks to run asynchronously on the IO thread pool.
+    /// @details All the tasks are inserted into the shared IO queue under a single lock and as many idle IO
+    ///          threads are woken up as there are tasks.
+    /// @tparam RET Type of future returned by each task.
+    /// @tparam FUNC_IT Iterator type over callable objects. The signature of each callable object must strictly
+    ///                 be 'int f(ThreadPromise<RET>::Ptr)'.
+    /// @param[in] first The first callable in the range.
+    /// @param[in] last The last callable in the range (exclusive).
+    /// @return A vector of thread future objects, one per callable and in the same order.
+    /// @note This function is non-blocking and returns immediately. The callables are copied. Use FutureJoiner
+    ///       to wait on all the results with a single future.
+    template <class RET = int, class FUNC_IT, class = Traits::IsInputIterator<FUNC_IT>>
+    std::vector<ThreadFuturePtr<RET>>
+    postAsyncIoBatch(FUNC_IT first, FUNC_IT last);
+    
+    /// @brief Same as above but on a specific queue (thread). See postAsyncIo() for the meaning of 'queueId' and 'isHighPriority'.
+    /// @note The targeted queue is locked and signalled only once per batch.
+    template <class RET = int, class FUNC_IT, class = Traits::IsInputIterator<FUNC_IT>>
+    std::vector<ThreadFuturePtr<RET>>
+    postAsyncIoBatch(int queueId, bool isHighPriority, FUNC_IT first, FUNC_IT last);
+    
+    /// @brief Run a callback on the IO thread pool once a future is ready.
+    /// @tparam FUTURE Pointer to a thread or coroutine future.
+    /// @tparam FUNC Callable object type with signature 'void f()'.
+    /// @param[in] future The future to watch.
+    /// @param[in] queueId Id of the IO queue where the callback should run. See postAsyncIo().
+    /// @param[in] isHighPriority If set to true, the callback will be scheduled to run immediately.
+    /// @param[in] func Callable object.
+    /// @note Contrary to posting a coroutine waiting on the future, nothing runs until the future is ready
+    ///       and the callback does not need a coroutine stack. See IThreadFuture::onReady() to run it inline.
+    template <class FUTURE, class FUNC>
+    void postOnReady(FUTURE future, int queueId, bool isHighPriority, FUNC&& func);
+    
     /// @brief Applies the given unary function to all the elements in the range [first,last).
     ///        This function runs in parallel.
     /// @tparam RET The return value of the unary function.
@@ -183,6 +510,40 @@ public:
     ThreadContextPtr<std::vector<RET>>
     forEach(INPUT_IT first, size_t num, Functions::ForEachFunc<RET, INPUT_IT> func);
     
+    /// @brief Same as forEach() but consecutive elements are grouped into chunks and each coroutine
+    ///        processes a whole chunk. The result still holds one value per element, in input order.
+    /// @param[in] grain The chunk size or GrainSize::adaptive() to derive it from the measured cost of
+    ///            the first elements.
+    /// @note Use this function when func() is cheap compared to the cost of posting a coroutine.
+    template <class RET = int, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    ThreadContextPtr<std::vector<RET>>
+    forEach(INPUT_IT first, INPUT_IT last, Functions::ForEachFunc<RET, INPUT_IT> func, GrainSize grain);
+    
+    /// @brief Same as above but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class RET = int, class INPUT_IT>
+    ThreadContextPtr<std::vector<RET>>
+    forEach(INPUT_IT first, size_t num, Functions::ForEachFunc<RET, INPUT_IT> func, GrainSize grain);
+    
+    /// @brief Same as forEach() but each result is written in place into the output range instead of
+    ///        being gathered in a vector. The input is split into a few slices per coroutine thread and
+    ///        completion is signalled once, after the last slice has been written.
+    /// @tparam OUTPUT_IT A random access iterator (or pointer) to the output range.
+    /// @oaram[in] out The first element of the output range, which must hold at least as many elements
+    ///            as the input range. The result for the i-th input element is assigned to out[i].
+    /// @return A context which completes once all the results are written. If 'func' throws, the first
+    ///         exception is rethrown by get() after all the slices have stopped.
+    /// @note The output range must stay valid until the returned context completes.
+    template <class RET, class INPUT_IT, class OUTPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    ThreadContextPtr<int>
+    forEach(INPUT_IT first, INPUT_IT last, OUTPUT_IT out, Functions::ForEachFunc<RET, INPUT_IT> func);
+    
+    /// @brief Same as above but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class RET, class INPUT_IT, class OUTPUT_IT>
+    ThreadContextPtr<int>
+    forEach(INPUT_IT first, size_t num, OUTPUT_IT out, Functions::ForEachFunc<RET, INPUT_IT> func);
+    
     /// @brief The batched version of forEach(). This function applies the given unary function
     ///        to all the elements in the range [first,last). This function runs serially with respect
     ///        to other functions in the same batch.
@@ -200,6 +561,77 @@ public:
     ThreadContextPtr<std::vector<std::vector<RET>>>
     forEachBatch(INPUT_IT first, size_t num, Functions::ForEachFunc<RET, INPUT_IT> func);
     
+    /// @brief Self-balancing version of forEachBatch(). The range is cut into chunks which are claimed
+    ///        one at a time by a worker coroutine per thread, so that threads finishing early take over
+    ///        the remaining work when the cost of func() varies across elements.
+    /// @param[in] grain The chunk size or GrainSize::adaptive() to derive it from the measured cost of
+    ///            the first elements. Adaptive chunks are capped to leave several chunks per thread.
+    /// @return A vector of value vectors (i.e. one per chunk, in input order).
+    template <class RET = int, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    ThreadContextPtr<std::vector<std::vector<RET>>>
+    forEachBatch(INPUT_IT first, INPUT_IT last, Functions::ForEachFunc<RET, INPUT_IT> func, GrainSize grain);
+    
+    /// @brief Same as above but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class RET = int, class INPUT_IT>
+    ThreadContextPtr<std::vector<std::vector<RET>>>
+    forEachBatch(INPUT_IT first, size_t num, Functions::ForEachFunc<RET, INPUT_IT> func, GrainSize grain);
+    
+    /// @brief Same as forEachBatch() but 'func' is taken by its own type instead of being wrapped in a
+    ///        std::function, so that it can be inlined into the loop running each batch.
+    /// @tparam FUNC A callable of signature 'RET(const INPUT_IT::value_type&)'. It is copied once and shared by
+    ///         all the batches.
+    /// @note Use this function when func() is too cheap to amortize an indirect call per element.
+    template <class RET = int, class INPUT_IT, class FUNC,
+              class = Traits::IsInputIterator<INPUT_IT>,
+              class = Traits::IsNotStdFunction<FUNC, Functions::ForEachFunc<RET, INPUT_IT>>>
+    ThreadContextPtr<std::vector<std::vector<RET>>>
+    forEachBatch(INPUT_IT first, INPUT_IT last, FUNC&& func);
+    
+    /// @brief Same as above but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class RET = int, class INPUT_IT, class FUNC,
+              class = Traits::IsNotStdFunction<FUNC, Functions::ForEachFunc<RET, INPUT_IT>>>
+    ThreadContextPtr<std::vector<std::vector<RET>>>
+    forEachBatch(INPUT_IT first, size_t num, FUNC&& func);
+    
+    /// @brief Same as the self-balancing forEachBatch() but 'func' is taken by its own type.
+    template <class RET = int, class INPUT_IT, class FUNC,
+              class = Traits::IsInputIterator<INPUT_IT>,
+              class = Traits::IsNotStdFunction<FUNC, Functions::ForEachFunc<RET, INPUT_IT>>>
+    ThreadContextPtr<std::vector<std::vector<RET>>>
+    forEachBatch(INPUT_IT first, INPUT_IT last, FUNC&& func, GrainSize grain);
+    
+    /// @brief Same as above but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class RET = int, class INPUT_IT, class FUNC,
+              class = Traits::IsNotStdFunction<FUNC, Functions::ForEachFunc<RET, INPUT_IT>>>
+    ThreadContextPtr<std::vector<std::vector<RET>>>
+    forEachBatch(INPUT_IT first, size_t num, FUNC&& func, GrainSize grain);
+    
+    /// @brief Data-parallel version of forEachBatch() for contiguous ranges. The input is cut into a few
+    ///        chunks per coroutine thread and 'kernel' is called once per chunk with a view of its input
+    ///        elements and a view of the matching output elements, so that its inner loop can be vectorized.
+    /// @tparam KERNEL A callable of signature 'void(Span<const INPUT_TYPE>, Span<OUTPUT_TYPE>)' which sets
+    ///         output[i] for each input[i]. It is copied once and shared by all the chunks.
+    /// @oaram[in] first Pointer to the first input element.
+    /// @oaram[in] num Number of input elements.
+    /// @oaram[in] out Pointer to the preallocated output range, which must hold at least 'num' elements.
+    /// @return A context which completes once all the chunks are done. If 'kernel' throws, the first
+    ///         exception is rethrown by get() after all the chunks have stopped.
+    /// @note Chunk boundaries fall on multiples of 64 bytes from 'first' and from 'out', so every chunk
+    ///       starts on a vector boundary when both ranges are aligned. Only the last chunk may end
+    ///       with a partial vector. Both ranges must stay valid until the returned context completes.
+    template <class INPUT_TYPE, class OUTPUT_TYPE, class KERNEL>
+    ThreadContextPtr<int>
+    forEachKernel(const INPUT_TYPE* first, size_t num, OUTPUT_TYPE* out, KERNEL&& kernel);
+    
+    /// @brief Same as above but the output is allocated up front and returned.
+    /// @tparam OUTPUT_TYPE The output element type, which must be default constructible.
+    template <class OUTPUT_TYPE, class INPUT_TYPE, class KERNEL>
+    ThreadContextPtr<std::vector<OUTPUT_TYPE>>
+    forEachKernel(const INPUT_TYPE* first, size_t num, KERNEL&& kernel);
+    
     /// @brief Implementation of map-reduce functionality.
     /// @tparam KEY The KEY type used for mapping and reducing.
     /// @tparam MAPPED_TYPE The output type after a map operation.
@@ -264,10 +696,241 @@ public:
                    size_t num,
                    Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
                    Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
+    
+    /// @brief Same as mapReduceBatch() but the mapper and the reducer are taken by their own type instead of
+    ///        being wrapped in a std::function, so that they can be inlined into the loop running each batch.
+    /// @note Selected when neither function is already the std::function taken by the overloads above.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class INPUT_IT,
+              class MAPPER,
+              class REDUCER,
+              class = Traits::IsInputIterator<INPUT_IT>,
+              class = Traits::IsNotStdFunction<MAPPER, Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>>,
+              class = Traits::IsNotStdFunction<REDUCER, Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>>>
+    ThreadContextPtr<std::map<KEY, REDUCED_TYPE>>
+    mapReduceBatch(INPUT_IT first,
+                   INPUT_IT last,
+                   MAPPER&& mapper,
+                   REDUCER&& reducer);
+    
+    /// @brief Same as above but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class INPUT_IT,
+              class MAPPER,
+              class REDUCER,
+              class = Traits::IsNotStdFunction<MAPPER, Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>>,
+              class = Traits::IsNotStdFunction<REDUCER, Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>>>
+    ThreadContextPtr<std::map<KEY, REDUCED_TYPE>>
+    mapReduceBatch(INPUT_IT first,
+                   size_t num,
+                   MAPPER&& mapper,
+                   REDUCER&& reducer);
+    
+    /// @brief This version of mapReduce() shuffles the mapped values in parallel. The input is split
+    ///        among the coroutine threads and each mapper coroutine scatters its pairs into one hash
+    ///        partition per thread. Each reducer coroutine then merges and reduces a single partition.
+    /// @tparam OUTPUT The container holding the reduced values. Any associative container of
+    ///         'std::pair<const KEY, REDUCED_TYPE>' (e.g. std::map for ordered keys) or a flat
+    ///         'std::vector<std::pair<KEY, REDUCED_TYPE>>' in no particular order.
+    /// @note KEY must be hashable with std::hash. Use this function when the number of mapped
+    ///       pairs is large since it avoids gathering them in a single ordered map.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class OUTPUT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT_IT,
+              class = Traits::IsInputIterator<INPUT_IT>>
+    ThreadContextPtr<OUTPUT>
+    mapReducePartitioned(INPUT_IT first,
+                         INPUT_IT last,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
+    
+    /// @brief Same as mapReducePartitioned() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class OUTPUT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT_IT>
+    ThreadContextPtr<OUTPUT>
+    mapReducePartitioned(INPUT_IT first,
+                         size_t num,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
+    
+    /// @brief Same as mapReducePartitioned() with a combiner which pre-aggregates the values of a key
+    ///        inside each mapper coroutine, before the shuffle. The reducer then receives at most one
+    ///        value per mapper coroutine for each key.
+    /// @param[in] combiner Associative function merging two mapped values of the same key.
+    /// @note Use a combiner when the reduction is associative, e.g. counts or sums.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class OUTPUT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT_IT,
+              class = Traits::IsInputIterator<INPUT_IT>>
+    ThreadContextPtr<OUTPUT>
+    mapReducePartitioned(INPUT_IT first,
+                         INPUT_IT last,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::CombineFunc<MAPPED_TYPE> combiner,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
+    
+    /// @brief Same as mapReducePartitioned() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class OUTPUT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT_IT>
+    ThreadContextPtr<OUTPUT>
+    mapReducePartitioned(INPUT_IT first,
+                         size_t num,
+                         Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT> mapper,
+                         Functions::CombineFunc<MAPPED_TYPE> combiner,
+                         Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE> reducer);
+    
+    /// @brief Streaming version of mapReduce() which consumes a buffered future instead of a range.
+    ///        Values are pulled as they are produced, mapped and folded into their key right away
+    ///        so memory is bounded by the number of distinct keys rather than by the input volume.
+    /// @tparam OUTPUT The map holding the reduced values. Must provide operator[], e.g. std::map.
+    /// @param[in] input Buffered future to pull the input values from, typically obtained from a
+    ///            Promise<Buffer<INPUT>>. The stream ends when the producer closes the buffer.
+    /// @param[in] mapper The mapper function having the signature
+    ///            'std::vector<std::pair<KEY,MAPPED_TYPE>>(const INPUT&)'.
+    /// @param[in] reducer Folds a mapped value into the reduced value of its key. The reduced value
+    ///            is default-constructed the first time a key is seen in a window.
+    /// @param[in] windowSize Number of input values per window. A reduced map is pushed into the
+    ///            returned buffer for every full window and for the last partial one. If zero, a
+    ///            single map is pushed once the input buffer is closed.
+    /// @return A buffered future to the reduced maps. The buffer is closed after the last one.
+    /// @note The input future must not be pulled from elsewhere while the stream is consumed.
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class OUTPUT = std::unordered_map<KEY, REDUCED_TYPE>,
+              class INPUT>
+    ThreadContextPtr<Buffer<OUTPUT>>
+    mapReduceStream(std::shared_ptr<ICoroFuture<Buffer<INPUT>>> input,
+                    Functions::StreamMapFunc<KEY, MAPPED_TYPE, INPUT> mapper,
+                    Functions::FoldFunc<REDUCED_TYPE, MAPPED_TYPE> reducer,
+                    size_t windowSize = 0);
+    
+    /// @brief Reduces the range [first,last) in parallel. Each coroutine thread folds a slice of the range
+    ///        into a partial result and the partial results are then combined pairwise.
+    /// @tparam RET The type of the result.
+    /// @param[in] first The first element in the range.
+    /// @param[in] last The last element in the range (exclusive).
+    /// @param[in] init The initial value, combined once with the reduced range.
+    /// @param[in] op Associative binary operation. Operands are combined in range order so 'op'
+    ///            does not need to be commutative.
+    /// @return The reduced value.
+    template <class RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    ThreadContextPtr<RET>
+    reduce(INPUT_IT first,
+           INPUT_IT last,
+           RET init,
+           Functions::BinaryFunc<RET> op);
+    
+    /// @brief Same as reduce() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class RET, class INPUT_IT>
+    ThreadContextPtr<RET>
+    reduce(INPUT_IT first,
+           size_t num,
+           RET init,
+           Functions::BinaryFunc<RET> op);
+    
+    /// @brief Same as reduce() but applies 'transform' to every element before reducing it. The transformed
+    ///        values are folded on the fly and never materialized.
+    /// @param[in] reduceOp Associative binary operation.
+    /// @param[in] transform Unary function applied to every element.
+    template <class RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    ThreadContextPtr<RET>
+    transformReduce(INPUT_IT first,
+                    INPUT_IT last,
+                    RET init,
+                    Functions::BinaryFunc<RET> reduceOp,
+                    Functions::ForEachFunc<RET, INPUT_IT> transform);
+    
+    /// @brief Same as transformReduce() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class RET, class INPUT_IT>
+    ThreadContextPtr<RET>
+    transformReduce(INPUT_IT first,
+                    size_t num,
+                    RET init,
+                    Functions::BinaryFunc<RET> reduceOp,
+                    Functions::ForEachFunc<RET, INPUT_IT> transform);
+    
+    /// @brief Computes the inclusive prefix scan of the range [first,last) in parallel. The i-th output is the
+    ///        combination of the elements 0 to i.
+    /// @param[in] op Associative binary operation.
+    /// @return A vector with one value per element, in input order.
+    /// @note The range is read twice: once to compute the total of each slice and once to write the output.
+    ///       RET must be default constructible.
+    template <class RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    ThreadContextPtr<std::vector<RET>>
+    inclusiveScan(INPUT_IT first,
+                  INPUT_IT last,
+                  Functions::BinaryFunc<RET> op);
+    
+    /// @brief Same as inclusiveScan() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class RET, class INPUT_IT>
+    ThreadContextPtr<std::vector<RET>>
+    inclusiveScan(INPUT_IT first,
+                  size_t num,
+                  Functions::BinaryFunc<RET> op);
+    
+    /// @brief Same as inclusiveScan() except that the i-th output is the combination of 'init' with the
+    ///        elements 0 to i-1 (i.e. the i-th element is excluded).
+    /// @param[in] init The first output value.
+    template <class RET, class INPUT_IT, class = Traits::IsInputIterator<INPUT_IT>>
+    ThreadContextPtr<std::vector<RET>>
+    exclusiveScan(INPUT_IT first,
+                  INPUT_IT last,
+                  RET init,
+                  Functions::BinaryFunc<RET> op);
+    
+    /// @brief Same as exclusiveScan() but takes a length as second argument in case INPUT_IT
+    ///        is not a random access iterator.
+    template <class RET, class INPUT_IT>
+    ThreadContextPtr<std::vector<RET>>
+    exclusiveScan(INPUT_IT first,
+                  size_t num,
+                  RET init,
+                  Functions::BinaryFunc<RET> op);
+    
+    /// @brief Sorts the range [first,last) in parallel. Each coroutine thread sorts a slice of the range
+    ///        and the sorted slices are then merged pairwise, in parallel, until one run is left.
+    /// @tparam RANDOM_IT A random access iterator.
+    /// @tparam COMPARE A strict weak ordering of signature 'bool(const T&, const T&)'.
+    /// @param[in] first The first element in the range.
+    /// @param[in] last The last element in the range (exclusive).
+    /// @param[in] compare The comparison function object.
+    /// @return A context which completes once the range is sorted. The range is sorted in place
+    ///         and must not be accessed until then.
+    /// @note Ranges shorter than a few thousand elements are sorted by a single coroutine.
+    template <class RANDOM_IT, class COMPARE = std::less<typename std::iterator_traits<RANDOM_IT>::value_type>>
+    ThreadContextPtr<int>
+    sort(RANDOM_IT first, RANDOM_IT last, COMPARE compare = COMPARE());
+    
+    /// @brief Same as sort() but the order of equivalent elements is preserved.
+    template <class RANDOM_IT, class COMPARE = std::less<typename std::iterator_traits<RANDOM_IT>::value_type>>
+    ThreadContextPtr<int>
+    stableSort(RANDOM_IT first, RANDOM_IT last, COMPARE compare = COMPARE());
 
     /// @brief Signal all threads to immediately terminate and exit. All other pending coroutines and IO tasks will not complete.
     ///        Call this function for a fast shutdown of the dispatcher.
-    /// @note This function blocks.
+    /// @note This function blocks. All the threads are signalled before any of them is joined. See
+    ///       Configuration::setTerminatePolicy() for how the pending tasks are released.
     void terminate() final;
     
     /// @brief Returns the total number of queued tasks for the specified type and queue id.
@@ -294,8 +957,24 @@ public:
     /// @param[in] timeout Maximum time for this function to wait. Set to 0 to wait indefinitely until all queues drain.
     /// @note This function blocks until all coroutines and IO tasks have completed. During this time, posting
     ///       of new tasks is disabled unless they are posted from within an already executing coroutine.
+    ///       The manual coroutine queues, if any, are run by the calling thread while it waits.
     void drain(std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
     
+    /// @brief Get the number of coroutines and IO tasks which have been posted but have not yet completed.
+    /// @return The number of outstanding tasks.
+    /// @note Unlike size(), continuations being handed over between queues are always accounted for.
+    size_t getNumOutstandingTasks() const;
+    
+    /// @brief Invoke a callback the next time all the posted coroutines and IO tasks have completed.
+    /// @param[in] callback The callback. Runs right away on this thread if nothing is outstanding, otherwise
+    ///                     on the worker thread which completes the last task.
+    /// @note The callback runs once. It should be short and must not block on this dispatcher.
+    void onQuiescence(std::function<void()> callback);
+    
+    /// @brief Same as above but returns a future which becomes ready instead of invoking a callback.
+    /// @return The future.
+    std::future<void> whenQuiescent();
+    
     /// @brief Returns the number of underlying coroutine threads as specified in the constructor. If -1 was passed
     ///        than this number essentially indicates the number of cores.
     /// @return The number of threads.
@@ -303,12 +982,40 @@ public:
     ///       to a specific queue.
     int getNumCoroutineThreads() const;
     
+    /// @brief Returns the number of coroutine queues which have no thread of their own.
+    /// @return The number of queues. See Configuration::setNumManualCoroutineQueues().
+    int getNumManualCoroutineQueues() const;
+    
+    /// @brief Run the coroutines of a manual queue on the calling thread.
+    /// @param[in] queueId The id of a manual coroutine queue.
+    /// @param[in] budget Maximum number of time slices, i.e. coroutine resumes, to run.
+    /// @return The number of time slices run. Less than 'budget' if no coroutine of this queue is runnable anymore.
+    /// @note Throws if the queue is not manual. A queue must only be driven by one thread at a time and never from
+    ///       a coroutine. Coroutines parked on this queue are resumed by a later call once they have been signalled.
+    size_t runOnce(int queueId, size_t budget);
+    
+    /// @brief Run the coroutines of all the manual queues on the calling thread until none of them is runnable.
+    /// @return The number of time slices run.
+    /// @note Coroutines which keep yielding never let this function return.
+    size_t runUntilIdle();
+    
     /// @brief Returns the number of underlying IO threads as specified in the constructor.
     /// @return The number of threads.
     /// @note Each thread services its own queueId, therefore this number can be used when assigning IO tasks
     ///       to a specific queue.
     int getNumIoThreads() const;
     
+    /// @brief Returns the number of extra IO threads currently running when the IO thread pool is elastic.
+    /// @return The number of threads.
+    /// @note These threads only service the shared ('any') IO queue and are not part of getNumIoThreads().
+    int getNumElasticIoThreads() const;
+    
+    /// @brief Changes the maximum number of IO threads of the elastic IO thread pool while running.
+    /// @oaram[in] num The maximum number of threads, as in Configuration::setMaxNumIoThreads(). A value not larger
+    ///            than getNumIoThreads() disables the growth of the pool.
+    /// @note Lowering the limit does not stop the extra threads already running. They are retired once idle.
+    void setMaxNumIoThreads(int num);
+    
     /// @brief Returns a statistics object for the specified type and queue id.
     /// @param[in] type The type of queue.
     /// @param[in] queueId The queue number to query. Valid range is [0, numCoroutineThreads) for IQueue::QueueType::Coro,
@@ -319,22 +1026,92 @@ public:
     QueueStatistics stats(IQueue::QueueType type = IQueue::QueueType::All,
                           int queueId = (int)IQueue::QueueId::All);
     
-    /// @brief Resets all coroutine and IO queue counters.
+    /// @brief Resets all coroutine and IO queue counters and the profiler samples.
     void resetStats();
     
+    /// @brief Returns a snapshot of the counters of all the object and coroutine stack pools.
+    /// @return The allocator stats.
+    /// @note The pools are shared by all the dispatchers in the process. See also Configuration::setPoolAllocSize()
+    ///       and Configuration::setPoolWarmup(). Pools which are replaced by the default
+    ///       allocators (see __QUANTUM_USE_DEFAULT_ALLOCATOR and __QUANTUM_USE_DEFAULT_CORO_ALLOCATOR) report no counters.
+    AllocatorStatistics allocatorStats() const;
+    
+    /// @brief Returns a lightweight snapshot of the queue depths, the posted and completed rates and the
+    ///        pool usage.
+    /// @return The snapshot. Rates are computed since the previous call to this method.
+    /// @note Meant to be polled frequently: unlike stats(), no queue lock is taken and no histogram is copied.
+    ///       See also Configuration::setMetricsExporter() to receive the snapshots at a fixed interval.
+    MetricsSnapshot metrics();
+    
+    /// @brief Returns the samples taken by the sampling profiler since the dispatcher started or since the
+    ///        last call to resetStats().
+    /// @return The profile, which can be printed or written in the pprof format.
+    /// @note Empty unless Configuration::setSamplingProfilerIntervalUs() is set.
+    Profile profile();
+    
 private:
+    //Applies the pool sizes before any pool is used by the dispatcher core
+    static const Configuration& applyPoolSettings(const Configuration& config);
+    static void warmUpPools(const Configuration::CpuSet& cpuSet);
+    MetricsSnapshot collectMetrics(const MetricsSnapshot& previous);
+    
     template <class RET, class FUNC, class ... ARGS>
     ThreadContextPtr<RET>
-    postImpl(int queueId, bool isHighPriority, ITask::Type type, FUNC&& func, ARGS&&... args);
+    postImpl(CancellationToken::Ptr token,
+             int queueId,
+             IQueue::Priority priority,
+             std::chrono::steady_clock::time_point deadline,
+             ITask::Type type,
+             StackSizeClass stackSize,
+             const char* label, //null to keep the default label
+             FUNC&& func,
+             ARGS&&... args);
     
     template <class RET, class FUNC, class ... ARGS>
     ThreadFuturePtr<RET>
-    postAsyncIoImpl(int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    postAsyncIoImpl(CancellationToken::Ptr token,
+                    int queueId,
+                    bool isHighPriority,
+                    std::chrono::steady_clock::time_point deadline,
+                    FUNC&& func,
+                    ARGS&&... args);
+    
+    //Same as above once the post has been admitted
+    template <class RET, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postAdmittedImpl(CancellationToken::Ptr token,
+                     int queueId,
+                     IQueue::Priority priority,
+                     std::chrono::steady_clock::time_point deadline,
+                     ITask::Type type,
+                     StackSizeClass stackSize,
+                     const char* label, //null to keep the default label
+                     FUNC&& func,
+                     ARGS&&... args);
+    
+    template <class RET, class FUNC, class ... ARGS>
+    ThreadFuturePtr<RET>
+    postAsyncIoAdmittedImpl(CancellationToken::Ptr token,
+                            int queueId,
+                            bool isHighPriority,
+                            std::chrono::steady_clock::time_point deadline,
+                            FUNC&& func,
+                            ARGS&&... args);
+    
+    template <class RET, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    postAtImpl(std::chrono::steady_clock::time_point time, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
+    
+    template <class RET, class FUNC, class ... ARGS>
+    size_t
+    postEveryImpl(std::chrono::milliseconds period, int queueId, bool isHighPriority, FUNC&& func, ARGS&&... args);
     
     //Members
     DispatcherCore              _dispatcher;
     bool                        _drain;
     std::atomic_flag            _terminated;
+    std::mutex                  _metricsMutex;
+    MetricsSnapshot             _lastMetrics; //previous snapshot returned by metrics()
 };
 
 using TaskDispatcher = Dispatcher; //alias
@@ -17,20 +17,27 @@
 #define QUANTUM_DISPATCHER_CORE_H
 
 #include <vector>
+#include <list>
 #include <condition_variable>
 #include <mutex>
 #include <atomic>
 #include <thread>
 #include <functional>
 #include <algorithm>
+#include <map>
 #ifdef _WIN32
 #include <winbase.h>
 #else
 #include <pthread.h>
+#include <sched.h>
 #endif
 #include <quantum/quantum_configuration.h>
 #include <quantum/quantum_task_queue.h>
 #include <quantum/quantum_io_queue.h>
+#include <quantum/quantum_reactor.h>
+#include <quantum/quantum_timer_queue.h>
+#include <quantum/quantum_metrics_snapshot.h>
+#include <quantum/quantum_profile.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -59,13 +66,59 @@ public:
     
     void resetStats();
     
+    MetricsSnapshot metrics(); //queue metrics only
+    
+    Profile profile();
+    
     void post(Task::Ptr task);
     
+    void postBatch(std::vector<Task::Ptr>& tasks);
+    
     void postAsyncIo(IoTask::Ptr task);
     
+    void postAsyncIoBatch(std::vector<IoTask::Ptr>& tasks);
+    
+    void unpark(const Task::Ptr& task);
+    
+    bool scheduleNext(const Task::Ptr& task);
+    
     int getNumCoroutineThreads() const;
     
+    int getNumManualCoroutineQueues() const;
+    
+    size_t runOnce(int queueId, size_t budget);
+    
+    size_t runUntilIdle();
+    
+    void setSchedulerCounters(SchedulerCounters* counters);
+    
+    //Earliest timer of the manual queues. Must be called from the thread driving them.
+    bool getNextTimerTime(Task::TimePoint& time) const;
+    
     int getNumIoThreads() const;
+    
+    int getNumElasticIoThreads() const;
+    
+    void setMaxNumIoThreads(int num);
+    
+    Reactor& getReactor();
+    
+    TimerQueue& getTimerQueue();
+    
+    size_t getNumOutstandingTasks() const;
+    
+    TaskCounter& getTaskCounter(); //tasks posted but not yet completed
+    
+    void onDetachedError(std::exception_ptr ex); //runs on the thread of the failed task
+    
+    //Admission control. A post is admitted unless the dispatcher or all the queues it could go to are saturated.
+    bool isSaturated(IQueue::QueueType type, int queueId, bool isHighPriority);
+    
+    void admit(IQueue::QueueType type, int queueId, bool isHighPriority); //applies the admission policy
+    
+    bool tryAdmit(IQueue::QueueType type, int queueId, bool isHighPriority); //same as above but returns false instead of blocking
+    
+    void incRejectedCount(IQueue::QueueType type, int queueId);
 
 private:
     // TODO : Remove - deprecated
@@ -87,11 +140,71 @@ private:
     
     QueueStatistics ioStats(int queueId);
     
+    using QueueRange = std::pair<size_t, size_t>; //[begin, end) indexes into the coroutine queues
+    
+    size_t selectCoroQueue(const QueueRange& range);
+    
+    QueueRange getLocalCoroQueueRange() const;
+    
+    void setCoroutineCpuSets(const std::vector<Configuration::CpuSet>& cpuSets);
+    
+    template <class QUEUE>
+    static void pinToCpuSets(std::vector<QUEUE>& queues,
+                             const std::vector<Configuration::CpuSet>& cpuSets);
+    
+    static int getCurrentCpu();
+    
+    void startCoroQueue(size_t index);
+    
+    void startIoQueues(); //all of them, when posting to the shared queues
+    
+    IoQueue& getSharedIoQueue(); //the shared queue the calling thread posts to
+    
+    void updateElasticIoQueues();
+    
+    void checkStalls(); //watchdog, runs on the timer thread
+    
+    void sampleProfile(); //sampling profiler, runs on the timer thread
+    
+    void resetProfile();
+    
     //Members
+    TaskCounter             _taskCounter;    //must be constructed before the queues
     std::vector<TaskQueue>  _coroQueues;     //coroutine queues
     std::vector<IoQueue>    _sharedIoQueues; //shared IO task queues (hold tasks posted to 'Any' IO queue)
     std::vector<IoQueue>    _ioQueues;       //dedicated IO task queues
     bool                    _loadBalanceSharedIoQueues; //tasks posted to 'Any' IO queue are load balanced
+    Configuration::QueueSelectionPolicy _queueSelectionPolicy; //how coroutines posted to 'Any' queue are placed
+    std::atomic<size_t>     _nextQueueIndex; //round-robin cursor and random seed
+    size_t                  _numManualCoroQueues; //trailing coroutine queues without a thread
+    size_t                  _numAnyCoroQueues; //leading coroutine queues selected for the 'Any' queue i.e. the threaded ones
+    bool                    _isLazyThreadStart; //threads are started by the first post to their queue
+    std::atomic_bool        _areIoQueuesStarted; //only used with lazy thread start
+    std::vector<QueueRange> _nodeQueueRanges; //coroutine queues of each NUMA node
+    std::vector<int>        _cpuToNode; //NUMA node of each CPU id or -1 if not configured
+    Configuration           _ioConfig; //used to create elastic IO queues
+    std::atomic<size_t>     _maxNumElasticIoQueues; //may be changed while running
+    size_t                  _ioGrowthBacklog;
+    std::list<IoQueue>      _elasticIoQueues; //extra IO threads servicing the shared queues only
+    mutable std::mutex      _elasticIoMutex;
+    QueueStatistics         _retiredIoStats; //accumulated stats of retired elastic IO queues
+    Reactor                 _reactor; //file descriptor readiness for coroutines
+    TimerQueue              _timerQueue; //delayed and periodic posts
+    std::chrono::milliseconds _queueStallThresholdMs;
+    std::chrono::milliseconds _blockedCoroutineThresholdMs;
+    Configuration::StallCallback _stallCallback;
+    Configuration::ErrorCallback _detachedErrorCallback;
+    Configuration::AdmissionPolicy _admissionPolicy;
+    bool                    _hasQueueWatermarks;
+    size_t                  _globalHighWatermark; //0 if disabled
+    size_t                  _globalLowWatermark;
+    std::atomic_bool        _isGloballySaturated;
+    std::atomic<std::thread::id> _pumpingThreadId; //last thread which ran the manual queues
+    TimerQueue::TimePoint   _lastStallCheck; //only accessed by the watchdog
+    std::chrono::microseconds _samplingProfilerIntervalUs;
+    std::mutex              _profileMutex; //protects the samples below
+    size_t                  _numProfileSamples; //per queue
+    std::map<std::pair<int, const char*>, size_t> _profileSamples; //keyed by queue id and label
     std::atomic_flag        _terminated;
 };
 
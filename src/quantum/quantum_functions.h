@@ -38,6 +38,24 @@ struct Functions
     
     template <class KEY, class MAPPED_TYPE, class REDUCED_TYPE>
     using ReduceFunc = std::function<std::pair<KEY, REDUCED_TYPE>(std::pair<KEY, std::vector<MAPPED_TYPE>>&&)>;
+    
+    template <class T>
+    using BinaryFunc = std::function<T(const T&, const T&)>;
+    
+    template <class MAPPED_TYPE>
+    using CombineFunc = std::function<MAPPED_TYPE(MAPPED_TYPE&&, MAPPED_TYPE&&)>;
+    
+    template <class KEY, class MAPPED_TYPE, class INPUT>
+    using StreamMapFunc = MapFunc<KEY, MAPPED_TYPE, typename std::vector<INPUT>::const_iterator>;
+    
+    template <class REDUCED_TYPE, class MAPPED_TYPE>
+    using FoldFunc = std::function<void(REDUCED_TYPE&, MAPPED_TYPE&&)>;
+    
+    template <class RET, class INPUT>
+    using StageFunc = std::function<RET(INPUT&&)>;
+    
+    template <class INPUT>
+    using SinkFunc = std::function<void(INPUT&&)>;
 };
 
 }}
@@ -0,0 +1,56 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_FUTEX_H
+#define QUANTUM_FUTEX_H
+
+#include <atomic>
+#include <chrono>
+#include <quantum/quantum_spinlock.h>
+#include <quantum/quantum_thread_traits.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                 struct Futex
+//==============================================================================================
+/// @struct Futex
+/// @brief Blocks threads (not coroutines) on the value of an atomic integer, such as a waiter signal.
+/// @note For internal use only. Waits may return spuriously so callers must re-check the value in a loop.
+///       Before blocking, the thread polls the value ThreadTraits::blockingSpinCount() times. On platforms
+///       without futexes, waiting falls back to a single YieldingThread call.
+struct Futex
+{
+    /// @brief Block the calling thread while 'word' equals 'value'.
+    static void wait(std::atomic_int& word, int value);
+    
+    /// @brief Poll 'word' for a short while.
+    /// @return True if 'word' no longer equals 'value'.
+    static bool spin(const std::atomic_int& word, int value);
+
+    /// @brief Same as above but returns after 'time' at the latest.
+    static void waitFor(std::atomic_int& word, int value, std::chrono::nanoseconds time);
+
+    /// @brief Wake up the threads waiting on 'word'. Should be called after 'word' has been modified.
+    static void wakeOne(std::atomic_int& word);
+    static void wakeAll(std::atomic_int& word);
+};
+
+}}
+
+#include <quantum/impl/quantum_futex_impl.h>
+
+#endif //QUANTUM_FUTEX_H
@@ -18,6 +18,7 @@
 
 #include <exception>
 #include <quantum/quantum_shared_state.h>
+#include <quantum/quantum_future_callback.h>
 #include <quantum/interface/quantum_icontext.h>
 #include <quantum/interface/quantum_ifuture.h>
 
@@ -38,6 +39,7 @@ class Future : public IThreadFuture<T>,
 {
 public:
     template <class F> friend class Promise;
+    template <typename, typename, AllocatorTraits::size_type&(*)()> friend struct SharedAllocator;
     using Ptr = std::shared_ptr<Future<T>>;
     
     //Default constructor with empty state
@@ -45,6 +47,13 @@ public:
     
     bool valid() const final;
     
+    //IThreadFutureBase and ICoroFutureBase
+    void addCallback(IFutureCallback::Ptr callback, size_t index) const final;
+    void removeCallback(const IFutureCallback::Ptr& callback) const final;
+    
+    template <class FUNC>
+    void onReady(FUNC&& func);
+    
     //IThreadFutureBase
     void wait() const final;
     std::future_status waitFor(std::chrono::milliseconds timeMs) const final;
@@ -56,6 +65,9 @@ public:
     template <class BUF = T, class V = BufferValue<BUF>>
     V pull(bool& isBufferClosed);
     
+    template <class BUF = T, class V = BufferValue<BUF>>
+    size_t pullMany(std::vector<V>& values, size_t maxCount, bool& isBufferClosed);
+    
     //ICoroFutureBase
     void wait(ICoroSync::Ptr sync) const final;
     std::future_status waitFor(ICoroSync::Ptr sync, std::chrono::milliseconds timeMs) const final;
@@ -67,12 +79,18 @@ public:
     template <class BUF = T, class V = BufferValue<BUF>>
     V pull(ICoroSync::Ptr sync, bool& isBufferClosed);
     
+    template <class BUF = T, class V = BufferValue<BUF>>
+    size_t pullMany(ICoroSync::Ptr sync, std::vector<V>& values, size_t maxCount, bool& isBufferClosed);
+    
     //===================================
     //           NEW / DELETE
     //===================================
     static void* operator new(size_t size);
     static void operator delete(void* p);
     static void deleter(Future<T>* p);
+    /// @brief Creates an object whose reference counts share its pool block (see SharedAllocator).
+    template <class ... ARGS>
+    static Ptr create(ARGS&&... args);
     
 private:
     explicit Future(std::shared_ptr<SharedState<T>> sharedState);
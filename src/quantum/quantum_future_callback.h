@@ -0,0 +1,55 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_FUTURE_CALLBACK_H
+#define QUANTUM_FUTURE_CALLBACK_H
+
+#include <utility>
+#include <quantum/interface/quantum_ifuture_callback.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                    class FutureCallback
+//==============================================================================================
+/// @class FutureCallback
+/// @brief Adapts a callable object taking no arguments to the IFutureCallback interface.
+/// @tparam FUNC Callable object type with signature 'void f()'.
+/// @note For internal use only.
+template <class FUNC>
+class FutureCallback : public IFutureCallback
+{
+public:
+    explicit FutureCallback(FUNC&& func) :
+        _func(std::move(func))
+    {}
+    
+    explicit FutureCallback(const FUNC& func) :
+        _func(func)
+    {}
+    
+    void onReady(size_t) final
+    {
+        _func();
+    }
+    
+private:
+    FUNC    _func;
+};
+
+}}
+
+#endif //QUANTUM_FUTURE_CALLBACK_H
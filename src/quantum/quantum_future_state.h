@@ -36,7 +36,8 @@ enum class FutureState
     FutureAlreadyRetrieved,         ///< Future value has been consumed. In the case of a buffer, no pulling is allowed.
     NoState,                        ///< Shared state between Promise and Future is invalid.
     BufferingData,                  ///< Buffered future is being streamed.
-    BufferClosed                    ///< Buffer is closed for pushing data. Data can still be pulled.
+    BufferClosed,                   ///< Buffer is closed for pushing data. Data can still be pulled.
+    DeadlineExceeded                ///< Task was discarded because its deadline passed before it could run.
 };
 
 //==============================================================================================
@@ -63,7 +64,8 @@ struct FutureException : public std::exception
             {FutureState::FutureAlreadyRetrieved,   "Future already retrieved"},
             {FutureState::NoState,                  "Invalid state"},
             {FutureState::BufferingData,            "Buffering future data"},
-            {FutureState::BufferClosed,             "Buffer closed"}
+            {FutureState::BufferClosed,             "Buffer closed"},
+            {FutureState::DeadlineExceeded,         "Deadline exceeded"}
         };
         return msg[_error];
     }
@@ -126,6 +128,13 @@ struct BufferClosedException : public FutureException
     {}
 };
 
+struct DeadlineExceededException : public FutureException
+{
+    DeadlineExceededException() :
+        FutureException(FutureState::DeadlineExceeded)
+    {}
+};
+
 inline
 void ThrowFutureException(FutureState state)
 {
@@ -138,6 +147,7 @@ void ThrowFutureException(FutureState state)
         case FutureState::NoState: throw NoStateException();
         case FutureState::BufferingData: throw BufferingDataException();
         case FutureState::BufferClosed: throw BufferClosedException();
+        case FutureState::DeadlineExceeded: throw DeadlineExceededException();
         default: throw std::logic_error("Invalid future state");
     }
 }
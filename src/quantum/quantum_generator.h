@@ -0,0 +1,122 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_GENERATOR_H
+#define QUANTUM_GENERATOR_H
+
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <boost/optional.hpp>
+#include <quantum/quantum_traits.h>
+#include <quantum/quantum_allocator.h>
+#include <quantum/quantum_capture.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class Generator
+//==============================================================================================
+/// @class Generator.
+/// @brief Lazy sequence of values produced by a function running on its own coroutine stack.
+/// @details Unlike buffered futures, the producer does not run ahead of the consumer: each value is only produced
+///          when the consumer asks for it, by switching directly to the generator function on the consumer's thread
+///          and back once the value has been yielded. No value is buffered and no other queue or thread is involved.
+///          Exceptions thrown by the generator function are re-thrown to the consumer.
+/// @tparam T Type of the values produced.
+/// @note A generator can be consumed from a coroutine or from a regular thread. It belongs to its consumer and must
+///       not be shared. The generator function must not yield or block its consumer's coroutine.
+template <class T>
+class Generator
+{
+    using Source = typename boost::coroutines2::coroutine<T>::pull_type;
+public:
+    /// @brief Object used by the generator function to produce values, i.e. 'sink(value);'
+    using Sink = typename boost::coroutines2::coroutine<T>::push_type;
+    
+    //==============================================================================================
+    //                                      class Generator::Iterator
+    //==============================================================================================
+    /// @class Generator::Iterator
+    /// @brief Input iterator producing the next value each time it is incremented.
+    class Iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+        
+        Iterator() = default;
+        explicit Iterator(Generator* generator);
+        
+        Iterator& operator++();
+        void operator++(int);
+        reference operator*() const;
+        pointer operator->() const;
+        bool operator==(const Iterator& other) const;
+        bool operator!=(const Iterator& other) const;
+        
+    private:
+        Generator*  _generator{nullptr}; //null once the generator is exhausted
+    };
+    
+    /// @brief Constructor. Nothing runs until the first value is requested.
+    /// @tparam FUNC Callable object type. The signature of the callable object must strictly be
+    ///              'int f(Generator<T>::Sink&, ...)'. Each call to the sink produces one value.
+    /// @tparam ARGS Argument types passed to FUNC.
+    /// @param[in] func Callable object.
+    /// @param[in] args Variable list of arguments passed to the callable object.
+    template <class FUNC, class ... ARGS>
+    explicit Generator(FUNC&& func, ARGS&&... args);
+    
+    Generator(const Generator& other) = delete;
+    Generator(Generator&& other) = default;
+    Generator& operator=(const Generator& other) = delete;
+    Generator& operator=(Generator&& other) = default;
+    
+    /// @brief Run the generator function until it produces its next value or returns.
+    /// @return True if a value was produced, false if the generator is exhausted.
+    bool next();
+    
+    /// @brief Access the last value produced.
+    /// @return A reference to the value, valid until next() is called.
+    /// @note Throws if next() has not produced a value.
+    T& value();
+    
+    /// @brief Check if the generator function has returned.
+    /// @return True or False.
+    bool done() const;
+    
+    /// @brief Get an iterator to the current value, producing the first value if none has been requested yet.
+    /// @note Allows consuming the generator with a range-based for loop.
+    Iterator begin();
+    
+    /// @brief Get the past-the-end iterator.
+    Iterator end();
+    
+private:
+    //Members
+    boost::optional<Function<int(Sink&)>>   _func; //until the first value is requested
+    boost::optional<Source>                 _source;
+};
+
+}}
+
+#include <quantum/impl/quantum_generator_impl.h>
+
+#endif //QUANTUM_GENERATOR_H
@@ -0,0 +1,67 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_GRAIN_SIZE_H
+#define QUANTUM_GRAIN_SIZE_H
+
+#include <chrono>
+#include <cstddef>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class GrainSize
+//==============================================================================================
+/// @class GrainSize.
+/// @brief Controls how many elements of a forEach() range are processed by each coroutine.
+/// @details Posting one coroutine per element costs a stack, a context and a promise each, which
+///          dominates when the function applied is cheap. Grouping elements into chunks amortizes
+///          this cost while the output keeps one value per element, in input order.
+class GrainSize
+{
+public:
+    /// @brief Each coroutine processes (at most) 'numElements' consecutive elements.
+    /// @param[in] numElements Number of elements per chunk. A value of 0 is treated as 1.
+    static GrainSize fixed(size_t numElements);
+    
+    /// @brief The chunk size is derived from the time taken by the first elements of the range which
+    ///        are run inline by the calling coroutine. Each chunk aims at running for about 'target'.
+    /// @param[in] target Desired running time of a chunk.
+    /// @note Chunks are capped so that the range is still spread over all the coroutine threads.
+    static GrainSize adaptive(std::chrono::microseconds target = std::chrono::microseconds(100));
+    
+    /// @brief Indicates if the chunk size is measured at runtime.
+    bool isAdaptive() const;
+    
+    /// @brief Number of elements per chunk. Only meaningful for fixed grain sizes.
+    size_t numElements() const;
+    
+    /// @brief Desired running time of a chunk. Only meaningful for adaptive grain sizes.
+    std::chrono::microseconds target() const;
+    
+private:
+    GrainSize(size_t numElements, std::chrono::microseconds target);
+    
+    //Members
+    size_t                      _numElements; //0 if adaptive
+    std::chrono::microseconds   _target;
+};
+
+}}
+
+#include <quantum/impl/quantum_grain_size_impl.h>
+
+#endif //QUANTUM_GRAIN_SIZE_H
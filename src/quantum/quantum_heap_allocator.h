@@ -40,7 +40,7 @@ struct HeapAllocator : public ContiguousPoolManager<T>
     typedef value_type&             reference;
     typedef const value_type&       const_reference;
     typedef size_t                  size_type;
-    typedef uint16_t                index_type;
+    typedef uint32_t                index_type;
     typedef std::ptrdiff_t          difference_type;
     typedef std::true_type          propagate_on_container_move_assignment;
     typedef std::false_type         propagate_on_container_copy_assignment;
@@ -95,10 +95,10 @@ struct HeapAllocator : public ContiguousPoolManager<T>
     template <typename U>
     HeapAllocator& operator=(const HeapAllocator<U>&)
     {}
-    bool operator==(const this_type& other) const {
+    bool operator==(const this_type&) const {
         return true;
     }
-    bool operator!=(const this_type& other) const {
+    bool operator!=(const this_type&) const {
         return false;
     }
     index_type size() const { return _size; }
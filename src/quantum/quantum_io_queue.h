@@ -21,12 +21,17 @@
 #include <condition_variable>
 #include <iostream>
 #include <atomic>
+#include <vector>
+#include <algorithm>
+#include <pthread.h>
 #include <quantum/interface/quantum_itask.h>
 #include <quantum/interface/quantum_iterminate.h>
 #include <quantum/interface/quantum_iqueue.h>
 #include <quantum/quantum_io_task.h>
 #include <quantum/quantum_queue_statistics.h>
 #include <quantum/quantum_configuration.h>
+#include <quantum/quantum_tracer.h>
+#include <quantum/quantum_task_counter.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -46,7 +51,10 @@ public:
     IoQueue();
     
     IoQueue(const Configuration& config,
-            std::vector<IoQueue>* sharedIoQueues);
+            std::vector<IoQueue>* sharedIoQueues,
+            bool isElastic = false,
+            TaskCounter* taskCounter = nullptr,
+            bool startThread = true);
     
     IoQueue(const IoQueue& other);
     
@@ -56,6 +64,24 @@ public:
     
     void terminate() final;
     
+    /// @brief Signal the thread to exit without waiting for it.
+    /// @note Lets the dispatcher signal all of its queues before joining them via terminate().
+    void interrupt();
+    
+    /// @brief Start the thread of this queue if it was constructed without one.
+    /// @note Has no effect on the shared queues, which never have a thread, or if the queue has been terminated.
+    ///       Thread-safe.
+    void start();
+    
+    /// @brief Check if this queue has a thread of its own.
+    /// @return True if the thread is started, false otherwise.
+    bool isStarted() const;
+    
+    /// @brief Check if this queue is saturated.
+    /// @return True if the queue has reached its high watermark and not yet drained down to its low watermark.
+    /// @note Counts the times the high watermark is reached in the statistics. Can be called from any thread.
+    bool isSaturated();
+    
     void pinToCore(int coreId) final;
     
     void run() final;
@@ -64,6 +90,10 @@ public:
     
     bool tryEnqueue(ITask::Ptr task) final;
     
+    /// @brief Insert several tasks under a single lock acquisition.
+    /// @note Dedicated queues are signalled once per batch. Shared queues are signalled by the dispatcher via wakeIdleQueues().
+    void enqueueBatch(const std::vector<IoTask::Ptr>& tasks);
+    
     ITask::Ptr dequeue(std::atomic_bool& hint) final;
     
     ITask::Ptr tryDequeue(std::atomic_bool& hint) final;
@@ -80,31 +110,81 @@ public:
     
     bool isIdle() const final;
     
+    /// @brief Check if this elastic queue has retired its thread after being idle for too long.
+    /// @return True or False.
+    bool isRetired() const;
+    
+    /// @brief Wake up a single IO thread waiting for shared tasks.
+    /// @note Must be called on the first shared queue after posting to any of the shared queues.
+    void wakeIdleQueue();
+    
+    /// @brief Wake up at most 'num' IO threads waiting for shared tasks.
+    /// @note Same as above but used after posting a batch of shared tasks.
+    void wakeIdleQueues(size_t num);
+    
+    /// @brief Get the time at which the IO task currently running on this queue was started.
+    /// @return The start time or a default-constructed time point if no task is running.
+    /// @note Only tracked if the watchdog is enabled in the configuration. Can be called from any thread.
+    std::chrono::steady_clock::time_point getRunStartTime() const;
+    
 private:
     ITask::Ptr grabWorkItem();
     ITask::Ptr grabWorkItemFromAll();
     void doEnqueue(ITask::Ptr task);
+    void doEnqueueNoSignal(ITask::Ptr task);
+    void insertByDeadline(IoTask::Ptr task); //called with the spinlock held
+    void markPosted(ITask::Ptr& task);
+    void markDone(ITask::Ptr& task);
     ITask::Ptr doDequeue(std::atomic_bool& hint);
+    void notifyIfDrained(); //wakes up the blocked posters once the queue has drained down to its low watermark
     ITask::Ptr tryDequeueFromShared();
-    std::chrono::milliseconds getBackoffInterval();
-    
-    //async IO queue
+    ITask::Ptr dequeueFromShared();
+    bool spinForWork();
+    bool markEmpty();
+    void addIdleQueue(IoQueue* queue);
+    bool removeIdleQueue(IoQueue* queue);
+    void releaseTasks();
+    
+    //read-mostly: set before the thread starts
     std::vector<IoQueue>*           _sharedIoQueues;
     bool                            _loadBalanceSharedIoQueues;
-    std::chrono::milliseconds       _loadBalancePollIntervalMs;
-    Configuration::BackoffPolicy    _loadBalancePollIntervalBackoffPolicy;
-    size_t                          _loadBalancePollIntervalNumBackoffs;
-    size_t                          _loadBalanceBackoffNum;
+    Configuration::IdlePolicy       _idlePolicy;
+    std::chrono::microseconds       _idleSpinTimeUs;
+    std::chrono::milliseconds       _idleTimeoutMs; //elastic threads only, zero otherwise
+    bool                            _isLatencyTimingEnabled; //timestamp every task posted and completed
+    bool                            _isWatchdogEnabled; //publish the run start time
+    bool                            _isPerfCountingEnabled; //count hardware events of the queue thread
+    bool                            _isAbandonOnTerminate; //the thread releases its own tasks when interrupted
     std::shared_ptr<std::thread>    _thread;
-    TaskList                        _queue;
+    TaskCounter*                    _taskCounter; //shared by all the queues of the dispatcher
+    int                             _coreId; //applied when the thread starts, -1 if not pinned
+    size_t                          _highWatermark; //0 if the queue has no watermarks
+    size_t                          _lowWatermark;
+    char                            _configPadding[cacheLineSize];
+    //shared by the posting threads and the queue thread
     mutable SpinLock                _spinlock;
+    TaskList                        _queue;
     std::mutex                      _notEmptyMutex; //for accessing the condition variable
     std::condition_variable         _notEmptyCond;
     std::atomic_bool                _isEmpty;
+    std::atomic_bool                _isSleeping; //thread is blocked on _notEmptyCond
+    std::atomic_bool                _isSaturated; //reached the high watermark and not yet drained down to the low one
+    std::atomic_bool                _isStarted;
     std::atomic_bool                _isInterrupted;
-    std::atomic_bool                _isIdle;
     std::atomic_flag                _terminated;
-    QueueStatistics                 _stats;
+    std::vector<IoQueue*>           _idleQueues; //first shared queue only: workers waiting for shared tasks
+    SpinLock                        _idleLock; //protects the idle queues and their registration flags
+    std::atomic<size_t>             _numIdleQueues;
+    QueueStatistics                 _stats; //padded between its posting and queue thread counters
+    //owned by the queue thread
+    std::atomic<std::chrono::steady_clock::rep> _runStartTime; //0 between tasks
+    std::atomic_bool                _isIdle;
+    std::atomic_bool                _isRetired;
+    bool                            _isIdleRegistered; //listed in the shared queue's idle queues
+    size_t                          _sharedQueueIndex; //next shared queue to poll in load balance mode
+    bool                            _grabFromShared; //alternate between own and shared queues
+    PerfCounters                    _perfCounters;
+    char                            _threadPadding[cacheLineSize]; //keeps the next queue off the last cache line
 };
 
 }}
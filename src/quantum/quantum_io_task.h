@@ -17,10 +17,12 @@
 #define QUANTUM_IO_TASK_H
 
 #include <functional>
+#include <chrono>
 #include <quantum/interface/quantum_itask.h>
 #include <quantum/quantum_capture.h>
 #include <quantum/quantum_promise.h>
 #include <quantum/quantum_util.h>
+#include <quantum/quantum_cancellation_token.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -49,6 +51,11 @@ public:
            FUNC&& func,
            ARGS&&... args);
     
+    //Detached task without a promise. The function is bound by the caller.
+    IoTask(Function<int()> func,
+           int queueId,
+           bool isHighPriority);
+    
     IoTask(const IoTask& task) = delete;
     IoTask(IoTask&& task) = default;
     IoTask& operator=(const IoTask& task) = delete;
@@ -66,6 +73,21 @@ public:
     Type getType() const final;
     bool isBlocked() const final;
     bool isHighPriority() const final;
+    bool isCancelled() const final;
+    
+    void setCancellationToken(CancellationToken::Ptr token);
+    
+    //Tasks with a deadline run ahead of the other tasks of the same priority in earliest-deadline order
+    //and are discarded by their queue if the deadline passes before they start.
+    void setDeadline(std::chrono::steady_clock::time_point deadline);
+    bool hasDeadline() const;
+    std::chrono::steady_clock::time_point getDeadline() const;
+    //Completes the promise with a DeadlineExceededException instead of running the task.
+    void expire();
+    
+    //Latency statistics support. Set by the posting thread when enabled.
+    void setPostTime(std::chrono::steady_clock::time_point time);
+    std::chrono::steady_clock::time_point getPostTime() const;
     
     //===================================
     //           NEW / DELETE
@@ -73,12 +95,19 @@ public:
     static void* operator new(size_t size);
     static void operator delete(void* p);
     static void deleter(IoTask* p);
+    /// @brief Creates an object whose reference counts share its pool block (see SharedAllocator).
+    template <class ... ARGS>
+    static Ptr create(ARGS&&... args);
     
 private:
     Function<int()>         _func;      //the current runnable io function
     std::atomic_flag        _terminated;
     int                     _queueId;
     bool                    _isHighPriority;
+    CancellationToken::Ptr  _cancellationToken; //null if not cancellable
+    IPromiseBase::Ptr       _promise; //broken if the task is discarded before running
+    std::chrono::steady_clock::time_point _postTime;
+    std::chrono::steady_clock::time_point _deadline; //time_point::max() if none
 };
 
 using IoTaskPtr = IoTask::Ptr;
@@ -0,0 +1,84 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_JSON_H
+#define QUANTUM_JSON_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class JsonValue
+//==============================================================================================
+/// @class JsonValue.
+/// @brief Minimal JSON document model and parser used to load the Configuration.
+/// @note For internal use only.
+class JsonValue
+{
+public:
+    enum class Type : int { Null, Boolean, Number, String, Array, Object };
+    
+    using Array = std::vector<JsonValue>;
+    using Object = std::vector<std::pair<std::string, JsonValue>>; //in document order
+    
+    JsonValue();
+    
+    /// @brief Parse a complete JSON document.
+    /// @param[in] text The document.
+    /// @return The root value.
+    /// @note Throws std::runtime_error with the offset of the offending character if the document is malformed.
+    static JsonValue parse(const std::string& text);
+    
+    /// @brief Escape a string and surround it with quotes.
+    static std::string quote(const std::string& value);
+    
+    Type type() const;
+    
+    //Accessors. They throw std::runtime_error if the value is not of the requested type.
+    bool asBool() const;
+    double asNumber() const;
+    int64_t asInteger() const; //also fails if the number has a fractional part
+    const std::string& asString() const;
+    const Array& asArray() const;
+    const Object& asObject() const;
+    
+private:
+    class Parser;
+    
+    static const char* typeName(Type type);
+    void checkType(Type type) const;
+    
+    //Members
+    Type            _type;
+    bool            _bool;
+    double          _number;
+    std::string     _string;
+    Array           _array;
+    Object          _object;
+};
+
+}}
+
+#include <quantum/impl/quantum_json_impl.h>
+
+#endif //QUANTUM_JSON_H
@@ -0,0 +1,91 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_LATCH_H
+#define QUANTUM_LATCH_H
+
+#include <atomic>
+#include <list>
+#include <utility>
+#include <cstddef>
+#include <quantum/quantum_spinlock.h>
+#include <quantum/quantum_futex.h>
+#include <quantum/interface/quantum_icontext.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class Latch
+//==============================================================================================
+/// @class Latch.
+/// @brief Coroutine-compatible single-use countdown latch.
+/// @details Typically used to wait until N coroutines or threads have finished. Counting down
+///          is a single atomic decrement and the arrival which brings the count to zero wakes
+///          all the waiters directly. Waiting coroutines are parked by their queue and waiting
+///          threads sleep until then. Once the count reaches zero the latch stays open.
+class Latch
+{
+public:
+    /// @brief Constructor.
+    /// @param[in] count The number of arrivals needed to open the latch.
+    explicit Latch(ptrdiff_t count);
+
+    Latch(const Latch& other) = delete;
+    Latch& operator=(const Latch& other) = delete;
+
+    /// @brief Decrement the count, waking all the waiters when it reaches zero.
+    /// @param[in] num Number of arrivals.
+    /// @note Never blocks.
+    void countDown(ptrdiff_t num = 1);
+
+    /// @brief Determines if the count has reached zero.
+    /// @return True if the latch is open, false otherwise.
+    bool tryWait() const;
+
+    /// @brief Wait until the count reaches zero.
+    /// @note Must be called in a non-coroutine context.
+    void wait();
+
+    /// @brief Wait until the count reaches zero.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @note Must be called from a coroutine.
+    void wait(ICoroSync::Ptr sync);
+
+    /// @brief Same as countDown() followed by wait().
+    /// @note Must be called in a non-coroutine context.
+    void arriveAndWait(ptrdiff_t num = 1);
+
+    /// @brief Same as countDown() followed by wait().
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @note Must be called from a coroutine.
+    void arriveAndWait(ICoroSync::Ptr sync, ptrdiff_t num = 1);
+
+private:
+    using Waiter = std::pair<std::atomic_int*, ICoroSync::Ptr>;
+
+    void waitImpl(std::atomic_int& signal, ICoroSync::Ptr sync);
+
+    //Members
+    std::atomic<ptrdiff_t>  _count;
+    SpinLock                _spinlock; //protects the waiters
+    std::list<Waiter>       _waiters;
+};
+
+}}
+
+#include <quantum/impl/quantum_latch_impl.h>
+
+#endif //QUANTUM_LATCH_H
@@ -0,0 +1,105 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_LATENCY_HISTOGRAM_H
+#define QUANTUM_LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                     class LatencyHistogram
+//==============================================================================================
+/// @class LatencyHistogram.
+/// @brief Log-linear histogram of durations used to compute percentiles.
+/// @details Every power of two nanoseconds is divided into 'numSubBuckets' equal buckets so that
+///          a percentile is reported within 1/numSubBuckets (12.5%) of the actual value. Durations of
+///          2^40 ns (about 18 minutes) and above fall into the last bucket. Buckets are relaxed atomics
+///          so that the histogram can be read while it is being written.
+class LatencyHistogram
+{
+public:
+    /// @brief Number of buckets per power of two.
+    static constexpr size_t numSubBuckets = 8;
+    
+    /// @brief Total number of buckets.
+    static constexpr size_t numBuckets = 304;
+    
+    LatencyHistogram();
+    
+    LatencyHistogram(const LatencyHistogram& other);
+    
+    LatencyHistogram& operator=(const LatencyHistogram& other);
+    
+    /// @brief Reset all the buckets to 0.
+    void reset();
+    
+    /// @brief Record a duration.
+    /// @param[in] time The duration. Negative durations are counted as 0.
+    void add(std::chrono::nanoseconds time);
+    
+    /// @brief Number of durations recorded.
+    size_t count() const;
+    
+    /// @brief Sum of all the durations recorded.
+    std::chrono::nanoseconds total() const;
+    
+    /// @brief Longest duration recorded.
+    std::chrono::nanoseconds max() const;
+    
+    /// @brief Average of all the durations recorded.
+    /// @return The mean or 0 if the histogram is empty.
+    std::chrono::nanoseconds mean() const;
+    
+    /// @brief Get the duration below which a percentage of the recorded durations fall.
+    /// @param[in] percent Percentage in the range [0, 100], e.g. 50 for the median or 99 for the 99th percentile.
+    /// @return The upper bound of the bucket holding the percentile, capped to max(), or 0 if the histogram is empty.
+    std::chrono::nanoseconds percentile(double percent) const;
+    
+    /// @brief Count of durations falling in a bucket.
+    /// @param[in] bucket Bucket index in the range [0, numBuckets).
+    /// @return Counter value or 0 if the bucket is out of range.
+    size_t bucketCount(size_t bucket) const;
+    
+    /// @brief Smallest duration falling in a bucket.
+    static std::chrono::nanoseconds bucketLowerBound(size_t bucket);
+    
+    /// @brief Index of the bucket in which a duration falls.
+    static size_t bucketIndex(std::chrono::nanoseconds time);
+    
+    /// @brief Print the count, mean, p50, p90, p99 and max values in microseconds.
+    /// @param[in,out] out Output stream.
+    void print(std::ostream& out) const;
+    
+    LatencyHistogram& operator+=(const LatencyHistogram& rhs);
+    
+private:
+    std::array<std::atomic<size_t>, numBuckets> _buckets;
+    std::atomic<size_t>                         _count;
+    std::atomic<int64_t>                        _totalNs;
+    std::atomic<int64_t>                        _maxNs;
+};
+
+}}
+
+#include <quantum/impl/quantum_latency_histogram_impl.h>
+
+#endif //QUANTUM_LATENCY_HISTOGRAM_H
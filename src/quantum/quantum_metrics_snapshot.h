@@ -0,0 +1,102 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_METRICS_SNAPSHOT_H
+#define QUANTUM_METRICS_SNAPSHOT_H
+
+#include <chrono>
+#include <ostream>
+#include <vector>
+#include <quantum/quantum_allocator_statistics.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                    class MetricsSnapshot
+//==============================================================================================
+/// @class MetricsSnapshot.
+/// @brief Lightweight copy of the live dispatcher metrics, meant to be polled frequently by a monitoring agent.
+/// @details Unlike the QueueStatistics returned by Dispatcher::stats(), the snapshot only holds a few counters per
+///          queue, which are read with relaxed atomic loads and without taking any queue lock. Rates are computed
+///          against the previous snapshot taken by the same consumer. See Dispatcher::metrics() and
+///          Configuration::setMetricsExporter().
+class MetricsSnapshot
+{
+    friend class Dispatcher;
+    friend class DispatcherCore;
+    
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+    
+    /// @brief Metrics of a single queue.
+    struct QueueMetrics
+    {
+        int         _queueId; //IQueue::QueueId::Any for the shared IO queue
+        size_t      _depth; //tasks posted and not yet completed, including the running and the blocked ones
+        size_t      _blocked; //coroutines waiting for a signal. Always 0 for IO queues.
+        size_t      _posted; //cumulative since the last Dispatcher::resetStats()
+        size_t      _completed; //cumulative, including the tasks which ended with an error
+        size_t      _errors; //cumulative
+        double      _postedPerSec; //since the previous snapshot
+        double      _completedPerSec; //since the previous snapshot
+    };
+    
+    MetricsSnapshot();
+    
+    /// @brief Time at which this snapshot was taken.
+    TimePoint time() const;
+    
+    /// @brief Time elapsed since the previous snapshot, over which the rates are computed.
+    /// @return The interval or 0 for the first snapshot, in which case all rates are 0.
+    std::chrono::nanoseconds interval() const;
+    
+    /// @brief Metrics of each coroutine queue, indexed by queue id.
+    const std::vector<QueueMetrics>& coroQueues() const;
+    
+    /// @brief Metrics of each dedicated IO queue, indexed by queue id.
+    const std::vector<QueueMetrics>& ioQueues() const;
+    
+    /// @brief Metrics of the shared ('any') IO queue, including the tasks run by the elastic IO threads.
+    const QueueMetrics& sharedIoQueue() const;
+    
+    /// @brief Usage of the object and coroutine stack pools.
+    /// @note Each pool lock is taken briefly. The pools are shared by all the dispatchers.
+    const AllocatorStatistics& pools() const;
+    
+    void print(std::ostream& out) const;
+    
+private:
+    //Fills the rates from the counters of a previous snapshot
+    void computeRates(const MetricsSnapshot& previous);
+    static void computeRates(QueueMetrics& metrics, const QueueMetrics& previous, double seconds);
+    static void print(std::ostream& out, const QueueMetrics& metrics);
+    
+    //Members
+    TimePoint                   _time;
+    std::chrono::nanoseconds    _interval;
+    std::vector<QueueMetrics>   _coroQueues;
+    std::vector<QueueMetrics>   _ioQueues;
+    QueueMetrics                _sharedIoQueue;
+    AllocatorStatistics         _pools;
+};
+
+std::ostream& operator<<(std::ostream& out, const MetricsSnapshot& snapshot);
+
+}}
+
+#include <quantum/impl/quantum_metrics_snapshot_impl.h>
+
+#endif //QUANTUM_METRICS_SNAPSHOT_H
@@ -17,10 +17,13 @@
 #define QUANTUM_MUTEX_H
 
 #include <atomic>
+#include <list>
+#include <utility>
 #include <quantum/quantum_traits.h>
 #include <quantum/quantum_spinlock.h>
 #include <quantum/interface/quantum_icontext.h>
 #include <quantum/quantum_yielding_thread.h>
+#include <quantum/quantum_futex.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -36,9 +39,17 @@ namespace quantum {
 class Mutex
 {
 public:
+    enum class Mode : int
+    {
+        Spin,   ///< Waiters retry the lock after each yield. Cheapest when the lock is rarely contended.
+        Fifo    ///< Waiters are queued and unlock() hands ownership to the oldest one. Waiting coroutines
+                ///< are parked by their queue and waiting threads sleep on a futex, so nobody spins.
+    };
+    
     /// @brief Default constructor.
+    /// @param[in] mode The waiting strategy.
     /// @note Mutex object is in unlocked state.
-    Mutex();
+    explicit Mutex(Mode mode = Mode::Spin);
     
     Mutex(const Mutex& other) = delete;
     Mutex& operator=(const Mutex& other) = delete;
@@ -59,6 +70,7 @@ public:
     
     /// @brief Tries to lock the mutex object.
     /// @return True if succeeds, false otherwise.
+    /// @note In Fifo mode this fails if other waiters are queued.
     bool tryLock();
     
     /// @brief Unlock this mutex.
@@ -139,11 +151,20 @@ public:
     };
     
 private:
+    using Waiter = std::pair<std::atomic_int*, ICoroSync::Ptr>;
+    
     template <class YIELDING>
     void lockImpl(YIELDING&& yield);
     
+    //Fifo mode. Returns once the lock is free or has been handed over by unlock().
+    void lockFifo(std::atomic_int& signal, ICoroSync::Ptr sync);
+    static void notify(Waiter& waiter);
+    
     //Members
-    mutable SpinLock  _spinlock;
+    mutable SpinLock    _spinlock; //lock flag in Spin mode, protects the waiters in Fifo mode
+    Mode                _mode;
+    bool                _isLocked; //Fifo mode only
+    std::list<Waiter>   _waiters; //Fifo mode only
 };
 
 }}
@@ -0,0 +1,84 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_PERF_COUNTERS_H
+#define QUANTUM_PERF_COUNTERS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace Bloomberg {
+namespace quantum {
+
+/// @brief Hardware and kernel events which can be counted for a thread.
+enum class PerfEvent : int { CpuCycles,        ///< CPU cycles
+                             Instructions,     ///< Retired instructions
+                             CacheMisses,      ///< Last level cache misses
+                             BranchMisses,     ///< Mispredicted branches
+                             ContextSwitches,  ///< Voluntary and involuntary context switches
+                             Max };            ///< Number of events. Not an event.
+
+//==============================================================================================
+//                                      class PerfCounters
+//==============================================================================================
+/// @class PerfCounters.
+/// @brief Counts hardware events for a single thread via perf_event_open().
+/// @details The counters are opened by the thread which is measured and can then be read from any thread.
+///          Events which the kernel or the hardware does not support (e.g. inside a virtual machine or when
+///          restricted by /proc/sys/kernel/perf_event_paranoid) are skipped and read as 0.
+/// @note Only available on Linux. Elsewhere open() always fails.
+class PerfCounters
+{
+public:
+    static constexpr int numEvents = (int)PerfEvent::Max;
+    
+    PerfCounters();
+    
+    PerfCounters(const PerfCounters& other) = delete;
+    PerfCounters& operator=(const PerfCounters& other) = delete;
+    
+    /// @brief Destructor. Closes the counters.
+    ~PerfCounters();
+    
+    /// @brief Start counting the events of the calling thread.
+    /// @return True if at least one event could be opened, false otherwise.
+    bool open();
+    
+    /// @brief Stop counting.
+    void close();
+    
+    /// @brief Check if any counter is open.
+    bool isOpen() const;
+    
+    /// @brief Read a counter.
+    /// @param[in] event The event to read.
+    /// @return Number of events since open() or 0 if the event is not available.
+    uint64_t read(PerfEvent event) const;
+    
+    /// @brief Short name of an event, e.g. "cache-misses".
+    static const char* name(PerfEvent event);
+    
+private:
+    //Members
+    std::array<int, numEvents>  _fds;
+    std::atomic_bool            _isOpen;
+};
+
+}}
+
+#include <quantum/impl/quantum_perf_counters_impl.h>
+
+#endif //QUANTUM_PERF_COUNTERS_H
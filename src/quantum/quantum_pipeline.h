@@ -0,0 +1,237 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_PIPELINE_H
+#define QUANTUM_PIPELINE_H
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <functional>
+#include <quantum/quantum_dispatcher.h>
+#include <quantum/quantum_channel.h>
+#include <quantum/quantum_mutex.h>
+#include <quantum/quantum_condition_variable.h>
+#include <quantum/quantum_functions.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class PipelineStage
+//==============================================================================================
+/// @class PipelineStage.
+/// @brief Configuration of a single Pipeline stage.
+class PipelineStage
+{
+public:
+    enum class Execution
+    {
+        Coroutine,  ///< Workers are coroutines. Use for non-blocking stages.
+        Io          ///< Workers run on the IO thread pool. Use for blocking stages.
+    };
+    
+    enum class Order
+    {
+        InOrder,    ///< Results are passed downstream in input order.
+        Unordered   ///< Results are passed downstream as soon as they are ready.
+    };
+    
+    /// @brief Constructor.
+    /// @param[in] capacity Maximum number of elements waiting in the input ring of the stage.
+    /// @param[in] parallelism Number of workers processing elements concurrently.
+    PipelineStage(size_t capacity = 64, size_t parallelism = 1);
+    
+    /// @brief Set the capacity of the input ring. Rounded up to the next power of two.
+    /// @param[in] capacity Maximum number of elements. A value of 0 is treated as 1.
+    void setCapacity(size_t capacity);
+    
+    /// @brief Set the number of workers.
+    /// @param[in] parallelism Number of workers. A value of 0 is treated as 1.
+    void setParallelism(size_t parallelism);
+    
+    /// @brief Set the order in which results are passed downstream. Default is Order::InOrder.
+    /// @note Preserving input order makes a worker wait for the workers handling earlier elements.
+    void setOrder(Order order);
+    
+    /// @brief Set where the workers run. Default is Execution::Coroutine.
+    /// @note Each IO worker holds an IO thread for the lifetime of the pipeline.
+    void setExecution(Execution execution);
+    
+    /// @brief Get the capacity of the input ring.
+    size_t getCapacity() const;
+    
+    /// @brief Get the number of workers.
+    size_t getParallelism() const;
+    
+    /// @brief Get the order in which results are passed downstream.
+    Order getOrder() const;
+    
+    /// @brief Get where the workers run.
+    Execution getExecution() const;
+    
+private:
+    //Members
+    size_t      _capacity;
+    size_t      _parallelism;
+    Order       _order;
+    Execution   _execution;
+};
+
+//==============================================================================================
+//                                      struct PipelineErrors
+//==============================================================================================
+//Records the first exception thrown by any stage of a pipeline. Internal use only.
+struct PipelineErrors
+{
+    void set(std::exception_ptr exception);
+    
+    //Members
+    std::atomic_bool    _hasException{false};
+    std::exception_ptr  _exception;
+};
+
+//==============================================================================================
+//                                      class Pipeline
+//==============================================================================================
+/// @class Pipeline.
+/// @brief Dataflow pipeline made of bounded stages.
+/// @details Each stage owns a bounded input ring (a Channel) drained by a configurable number of workers.
+///          A worker applies the stage function to one element at a time and pushes the result into the
+///          ring of the next stage, waiting while it is full. A slow sink therefore stalls each stage in
+///          turn up to the producer, and memory is bounded by the sum of the ring capacities. Closing
+///          the pipeline lets every stage drain before the next one is closed.
+/// @tparam IN Type of the elements pushed into the pipeline. Must be default constructible.
+/// @tparam OUT Type of the elements produced by the last stage. Must be default constructible.
+/// @note The workers of a stage start once the next stage or the sink is attached since the ring they
+///       push into is sized by it. A stage function which throws drops the element and the first
+///       exception is reported by the future returned by sink().
+/// @code
+///     Pipeline<std::string, double> pipeline = Pipeline<std::string>(dispatcher)
+///                                                  .stage<Record>(decode, PipelineStage(256, 4))
+///                                                  .stage<double>(score);
+///     ThreadFuturePtr<int> done = pipeline.sink(publish);
+///     pipeline.push(std::move(line)); //...
+///     pipeline.close();
+///     done->get();
+/// @endcode
+template <class IN, class OUT = IN>
+class Pipeline
+{
+public:
+    /// @brief Constructor. Creates a pipeline without any stage.
+    /// @param[in] dispatcher The dispatcher used to run the workers. Must outlive the pipeline.
+    explicit Pipeline(Dispatcher& dispatcher);
+    
+    /// @brief Append a stage.
+    /// @tparam RET The type of the elements produced by the stage.
+    /// @param[in] func The stage function having the signature 'RET(OUT&&)'.
+    /// @param[in] config The stage configuration.
+    /// @return A pipeline ending with the new stage. This pipeline object can still be used to push
+    ///         elements but must not be extended again.
+    template <class RET>
+    Pipeline<IN, RET> stage(Functions::StageFunc<RET, OUT> func, const PipelineStage& config = PipelineStage());
+    
+    /// @brief Attach the sink which consumes the elements produced by the last stage and start the
+    ///        remaining workers. The pipeline cannot be extended afterwards.
+    /// @param[in] func The sink function having the signature 'void(OUT&&)'.
+    /// @param[in] config The stage configuration. The order setting is ignored.
+    /// @return A future which is set once the pipeline is closed and all the elements are consumed.
+    ///         It holds the first exception thrown by a stage or by the sink, if any.
+    ThreadFuturePtr<int> sink(Functions::SinkFunc<OUT> func, const PipelineStage& config = PipelineStage());
+    
+    /// @brief Push an element into the pipeline, waiting while the first stage is full.
+    /// @note Must be called in a non-coroutine context. Throws BufferClosedException if the pipeline is closed.
+    template <class V = IN>
+    void push(V&& value);
+    
+    /// @brief Push an element into the pipeline, waiting while the first stage is full.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @note Must be called from a coroutine. Throws BufferClosedException if the pipeline is closed.
+    template <class V = IN>
+    void push(ICoroSync::Ptr sync, V&& value);
+    
+    /// @brief Close the pipeline input. Elements already pushed still flow through all the stages.
+    void close();
+    
+private:
+    template <class, class> friend class Pipeline;
+    
+    //Shared by all the workers of a stage
+    template <class T, class RET>
+    struct Stage
+    {
+        Stage(std::shared_ptr<Channel<T>> input,
+              Functions::StageFunc<RET, T> func,
+              const PipelineStage& config,
+              std::shared_ptr<PipelineErrors> errors);
+        
+        //Members
+        std::shared_ptr<Channel<T>>         _input;
+        std::shared_ptr<Channel<RET>>       _output; //null for a sink
+        Functions::StageFunc<RET, T>        _func;
+        PipelineStage                       _config;
+        bool                                _isOrdered;
+        std::shared_ptr<PipelineErrors>     _errors;
+        std::atomic_size_t                  _numRunning;
+        Promise<int>::Ptr                   _done; //set by the last worker of a sink
+        Mutex                               _inputMutex; //numbers the elements when _isOrdered
+        size_t                              _nextInput{0};
+        Mutex                               _outputMutex;
+        ConditionVariable                   _turn;
+        size_t                              _nextOutput{0};
+    };
+    
+    //Starts the workers of the last stage once they know where to push their results
+    using Connector = std::function<void(std::shared_ptr<Channel<OUT>>)>;
+    
+    Pipeline(Dispatcher& dispatcher,
+             std::shared_ptr<Channel<IN>> input,
+             Connector connect,
+             std::shared_ptr<PipelineErrors> errors);
+    
+    std::shared_ptr<Channel<OUT>> connect(size_t capacity);
+    
+    //Only a pipeline without stages, where IN and OUT are the same, sets its input on connect()
+    static void setInput(std::shared_ptr<Channel<IN>>& input, std::shared_ptr<Channel<IN>> channel);
+    template <class T>
+    static void setInput(std::shared_ptr<Channel<IN>>& input, std::shared_ptr<Channel<T>> channel);
+    
+    template <class T, class RET>
+    static void start(Dispatcher& dispatcher, std::shared_ptr<Stage<T, RET>> stage, std::shared_ptr<Channel<RET>> output);
+    
+    template <class T, class RET>
+    static void run(Stage<T, RET>& stage, const ICoroSync::Ptr& sync);
+    
+    template <class T>
+    static T pullImpl(Channel<T>& channel, const ICoroSync::Ptr& sync, bool& isClosed);
+    
+    template <class T>
+    static void pushImpl(Channel<T>& channel, const ICoroSync::Ptr& sync, T&& value);
+    
+    static void lockImpl(Mutex& mutex, const ICoroSync::Ptr& sync);
+    
+    //Members
+    Dispatcher*                         _dispatcher;
+    std::shared_ptr<Channel<IN>>        _input; //null until the first stage is attached
+    Connector                           _connect; //empty if there is no stage
+    std::shared_ptr<PipelineErrors>     _errors;
+};
+
+}}
+
+#include <quantum/impl/quantum_pipeline_impl.h>
+
+#endif //QUANTUM_PIPELINE_H
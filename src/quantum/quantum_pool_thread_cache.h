@@ -0,0 +1,72 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_POOL_THREAD_CACHE_H
+#define QUANTUM_POOL_THREAD_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <quantum/quantum_allocator_traits.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================
+//                           struct PoolThreadCache
+//==============================================================================
+/// @struct PoolThreadCache.
+/// @brief Per-thread magazine of free blocks kept in front of a shared pool.
+/// @details Each thread owns one cache per pool type. The cache is attached to the
+///          first pool of that type the thread uses and serves allocations without
+///          taking the pool spinlock. An empty cache is refilled and a full cache is
+///          flushed by half its capacity at a time, in a single locked operation.
+///          On thread exit the cached blocks are returned to the pool.
+/// @tparam POOL The pool type. Must provide attachThreadCache(), detachThreadCache(),
+///         refillThreadCache() and flushThreadCache().
+/// @tparam BLOCK The type of the cached blocks.
+/// @note For internal use only.
+template <typename POOL, typename BLOCK>
+struct PoolThreadCache
+{
+    static constexpr size_t Capacity = __QUANTUM_POOL_THREAD_CACHE_SIZE;
+    static constexpr size_t BatchSize = (Capacity + 1) / 2;
+    
+    PoolThreadCache() = default;
+    PoolThreadCache(const PoolThreadCache&) = delete;
+    PoolThreadCache& operator=(const PoolThreadCache&) = delete;
+    ~PoolThreadCache();
+    
+    /// @brief Get the cache of the calling thread if it serves 'pool'.
+    /// @return The cache or nullptr if caching is disabled or the cache serves another pool.
+    static PoolThreadCache* instance(POOL* pool);
+    
+    /// @brief Take a block from the cache, refilling it from the pool if needed.
+    /// @return True if a block was returned.
+    bool pop(BLOCK& block);
+    
+    /// @brief Return a block to the cache, flushing to the pool if needed.
+    void push(BLOCK block);
+    
+    //------------------------------- Members ----------------------------------
+    std::atomic<POOL*>      _owner{nullptr}; //reset by the pool when it is destroyed
+    std::atomic_size_t      _count{0}; //read by the pool for its statistics
+    BLOCK                   _blocks[Capacity ? Capacity : 1];
+};
+
+}} //namespaces
+
+#include <quantum/impl/quantum_pool_thread_cache_impl.h>
+
+#endif //QUANTUM_POOL_THREAD_CACHE_H
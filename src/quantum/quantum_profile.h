@@ -0,0 +1,129 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_PROFILE_H
+#define QUANTUM_PROFILE_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <set>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      struct TaskLabel
+//==============================================================================================
+/// @struct TaskLabel.
+/// @brief Name under which the sampling profiler reports the time spent in a coroutine.
+/// @details Passed as the first argument of Dispatcher::post() and Dispatcher::postFirst(). Coroutines posted
+///          without a label are reported under the demangled type of their callable object.
+/// @note The name is not copied and must outlive the dispatcher, typically a string literal.
+struct TaskLabel
+{
+    explicit TaskLabel(const char* name) : _name(name) {}
+    
+    const char* _name;
+};
+
+//==============================================================================================
+//                                      class Profile
+//==============================================================================================
+/// @class Profile.
+/// @brief Aggregated samples of the sampling profiler.
+/// @details At every sampling interval the profiler records the label of the coroutine running on each
+///          coroutine queue thread. The number of samples of a label multiplied by the interval approximates
+///          the time spent in that coroutine. See Configuration::setSamplingProfilerIntervalUs() and
+///          Dispatcher::profile().
+class Profile
+{
+    friend class DispatcherCore;
+    
+public:
+    /// @brief Samples of a single label on a single queue.
+    struct Entry
+    {
+        int         _queueId;
+        std::string _label;
+        size_t      _numSamples;
+    };
+    
+    Profile();
+    
+    /// @brief Interval at which the queues were sampled.
+    std::chrono::microseconds interval() const;
+    
+    /// @brief Number of times each queue was sampled, whether it was running a coroutine or not.
+    size_t numSamples() const;
+    
+    /// @brief Samples of each label, sorted by decreasing number of samples. Idle queues are not reported.
+    const std::vector<Entry>& entries() const;
+    
+    /// @brief Print the entries along with their share of the samples.
+    void print(std::ostream& out) const;
+    
+    /// @brief Write the profile in the pprof format i.e. an uncompressed serialized perftools.profiles.Profile.
+    /// @details Each entry is a sample whose stack is made of its label under a frame naming its queue, with the
+    ///          number of samples and its estimated CPU time as values. Readable with 'pprof -top <file>'.
+    /// @note The stream must be opened in binary mode.
+    void writePprof(std::ostream& out) const;
+    
+    /// @brief Demangle a type name as returned by std::type_info::name().
+    /// @return The demangled name or the name itself if it can not be demangled.
+    static std::string demangle(const char* name);
+    
+    /// @brief Record a type name used as a default label so that it gets demangled when the profile is built.
+    /// @return The name itself.
+    /// @note Demangling is deferred since it needs more stack than a coroutine may have.
+    static const char* registerTypeName(const char* name);
+    
+private:
+    static std::mutex& typeNamesMutex();
+    static std::set<const char*>& typeNames(); //protected by the mutex above
+    static bool isTypeName(const char* label);
+    
+    //Merges the samples of the same label and queue
+    void add(int queueId, const char* label, size_t numSamples);
+    void sort();
+    
+    //Protobuf encoding
+    static void writeVarint(std::string& buf, uint64_t value);
+    static void writeVarint(std::string& buf, int field, uint64_t value);
+    static void writeBytes(std::string& buf, int field, const std::string& bytes);
+    static std::string valueType(int64_t type, int64_t unit);
+    
+    //Members
+    std::chrono::microseconds   _interval;
+    size_t                      _numSamples;
+    std::vector<Entry>          _entries;
+};
+
+std::ostream& operator<<(std::ostream& out, const Profile& profile);
+
+}}
+
+#include <quantum/impl/quantum_profile_impl.h>
+
+#endif //QUANTUM_PROFILE_H
@@ -17,6 +17,7 @@
 #define QUANTUM_PROMISE_H
 
 #include <quantum/quantum_future.h>
+#include <quantum/quantum_shared_future.h>
 #include <quantum/interface/quantum_ipromise.h>
 
 namespace Bloomberg {
@@ -34,6 +35,8 @@ class Promise : public IPromiseBase,
                 public IThreadPromise<Promise, T>,
                 public ICoroPromise<Promise, T>
 {
+    template <class RET> friend class Context; //reads the shared state of a continuation chain directly
+    
 public:
     using Ptr = std::shared_ptr<Promise<T>>;
     
@@ -48,6 +51,7 @@ public:
     ICoroFutureBase::Ptr getICoroFutureBase() const final;
     ThreadFuturePtr<T> getIThreadFuture() const;
     CoroFuturePtr<T> getICoroFuture() const;
+    SharedFuture<T> getSharedFuture() const;
     
     //ITerminate
     void terminate() final;
@@ -63,6 +67,9 @@ public:
     template <class BUF = T, class V = BufferValue<BUF>>
     void push(V &&value);
     
+    template <class BUF = T, class V = BufferValue<BUF>>
+    void pushMany(std::vector<V> values);
+    
     //ICoroPromise
     template <class V = T>
     int set(ICoroSync::Ptr sync, V&& value);
@@ -70,6 +77,9 @@ public:
     template <class BUF = T, class V = BufferValue<BUF>>
     void push(ICoroSync::Ptr sync, V &&value);
     
+    template <class BUF = T, class V = BufferValue<BUF>>
+    void pushMany(ICoroSync::Ptr sync, std::vector<V> values);
+    
     template <class BUF = T, class V = BufferValue<BUF>>
     int closeBuffer();
     
@@ -79,6 +89,9 @@ public:
     static void* operator new(size_t size);
     static void operator delete(void* p);
     static void deleter(Promise<T>* p);
+    /// @brief Creates an object whose reference counts share its pool block (see SharedAllocator).
+    template <class ... ARGS>
+    static Ptr create(ARGS&&... args);
     
 private:
     std::shared_ptr<SharedState<T>> _sharedState;
@@ -17,6 +17,9 @@
 #define QUANTUM_QUEUE_STATISTICS_H
 
 #include <quantum/interface/quantum_iqueue_statistics.h>
+#include <quantum/quantum_latency_histogram.h>
+#include <array>
+#include <atomic>
 
 namespace Bloomberg {
 namespace quantum {
@@ -26,6 +29,8 @@ namespace quantum {
 //==============================================================================================
 /// @class QueueStatistics.
 /// @brief Provides various counters related to queues and task execution.
+/// @details Counters are relaxed atomics so that they can be read while the queue is running. The counters
+///          updated by posting threads are kept on a separate cache line from the ones updated by the queue thread.
 /// @note See IQueueStatistics for detailed description.
 class QueueStatistics : public IQueueStatistics
 {
@@ -35,6 +40,10 @@ class QueueStatistics : public IQueueStatistics
 public:
     QueueStatistics();
     
+    QueueStatistics(const QueueStatistics& other);
+    
+    QueueStatistics& operator=(const QueueStatistics& other);
+    
     //===================================
     //         IQUEUESTATISTICS
     //===================================
@@ -70,21 +79,101 @@ public:
     
     void incHighPriorityCount() final;
     
+    size_t stolenCount() const final;
+    
+    void incStolenCount() final;
+    
+    size_t migratedCount() const final;
+    
+    void incMigratedCount() final;
+    
+    size_t cancelledCount() const final;
+    
+    void incCancelledCount() final;
+    
+    size_t expiredCount() const final;
+    
+    void incExpiredCount() final;
+    
+    size_t highWatermarkCount() const final;
+    
+    void incHighWatermarkCount() final;
+    
+    size_t rejectedCount() const final;
+    
+    void incRejectedCount() final;
+    
+    size_t sliceCount() const final;
+    
+    std::chrono::nanoseconds totalSliceTime() const final;
+    
+    std::chrono::nanoseconds maxSliceTime() const final;
+    
+    size_t sliceHistogram(size_t bucket) const final;
+    
+    void addSliceTime(std::chrono::nanoseconds sliceTime) final;
+    
+    size_t longSliceCount() const final;
+    
+    void incLongSliceCount() final;
+    
+    const LatencyHistogram& waitTimeHistogram() const final;
+    
+    void addWaitTime(std::chrono::nanoseconds waitTime) final;
+    
+    const LatencyHistogram& runTimeHistogram() const final;
+    
+    void addRunTime(std::chrono::nanoseconds runTime) final;
+    
+    const LatencyHistogram& endToEndTimeHistogram() const final;
+    
+    void addEndToEndTime(std::chrono::nanoseconds endToEndTime) final;
+    
+    uint64_t perfCount(PerfEvent event) const final;
+    
+    void setPerfCount(PerfEvent event, uint64_t count) final;
+    
     void print(std::ostream& out) const final;
     
     QueueStatistics& operator+=(const IQueueStatistics& rhs);
     
     friend QueueStatistics operator+(QueueStatistics lhs,
                                      const IQueueStatistics& rhs);
+    
+    /// @brief Refresh all the hardware event counts from the counters of a queue thread.
+    void updatePerfCounts(const PerfCounters& counters);
 
 private:
-    size_t      _numElements;
-    size_t      _errorCount;
-    size_t      _sharedQueueErrorCount;
-    size_t      _completedCount;
-    size_t      _sharedQueueCompletedCount;
-    size_t      _postedCount;
-    size_t      _highPriorityCount;
+    using Counter = std::atomic<size_t>;
+    static constexpr size_t cacheLineSize = 64;
+    
+    static void increment(Counter& counter);
+    
+    //updated by the posting threads
+    Counter     _numElements;
+    Counter     _postedCount;
+    Counter     _highPriorityCount;
+    Counter     _highWatermarkCount;
+    Counter     _rejectedCount;
+    char        _padding[cacheLineSize];
+    //updated by the queue thread
+    Counter     _errorCount;
+    Counter     _sharedQueueErrorCount;
+    Counter     _completedCount;
+    Counter     _sharedQueueCompletedCount;
+    Counter     _stolenCount;
+    Counter     _migratedCount;
+    Counter     _cancelledCount;
+    Counter     _expiredCount;
+    Counter     _sliceCount;
+    Counter     _longSliceCount;
+    std::atomic<int64_t> _totalSliceTimeNs;
+    std::atomic<int64_t> _maxSliceTimeNs;
+    std::array<Counter, numSliceBuckets> _sliceHistogram;
+    LatencyHistogram _waitTimeHistogram;
+    LatencyHistogram _runTimeHistogram;
+    LatencyHistogram _endToEndTimeHistogram;
+    std::array<std::atomic<uint64_t>, PerfCounters::numEvents> _perfCounts;
 };
 
 }}
@@ -0,0 +1,106 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_REACTOR_H
+#define QUANTUM_REACTOR_H
+
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <quantum/interface/quantum_iterminate.h>
+#include <quantum/interface/quantum_icoro_sync.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                 class Reactor
+//==============================================================================================
+/// @class Reactor
+/// @brief Waits for file descriptor readiness on behalf of coroutines. A coroutine registers
+///        its signal with the reactor and gets parked by its queue. Once the descriptor is ready
+///        the reactor thread sets the signal and reschedules the coroutine on its own queue.
+/// @note For internal use only. The reactor thread is only started on the first registration.
+class Reactor : public ITerminate
+{
+public:
+    enum class Event : int
+    {
+        Read,   ///< Descriptor is readable or has been closed by the peer
+        Write   ///< Descriptor is writable
+    };
+
+    Reactor();
+
+    Reactor(const Reactor&) = delete;
+
+    Reactor& operator=(const Reactor&) = delete;
+
+    ~Reactor();
+
+    void terminate() final;
+
+    /// @brief Signal the coroutine once 'fd' is ready for the specified event.
+    /// @param[in] fd The file descriptor. Must support polling (e.g. sockets, pipes or eventfds).
+    /// @param[in] event The event to wait for.
+    /// @param[in] signal Set to 1 when the descriptor is ready.
+    /// @param[in] sync The coroutine to wake up.
+    /// @note Only one coroutine can wait for a given event on a given descriptor at a time.
+    /// @throws std::runtime_error if the descriptor cannot be polled.
+    void add(int fd, Event event, std::atomic_int& signal, ICoroSync::Ptr sync);
+
+    /// @brief Cancel a registration made via add().
+    /// @return True if the registration was removed or false if the coroutine has already been signalled.
+    bool remove(int fd, Event event, std::atomic_int& signal);
+
+private:
+    struct Waiter
+    {
+        bool isSet() const { return _signal != nullptr; }
+
+        std::atomic_int*    _signal{nullptr};
+        ICoroSync::Ptr      _sync;
+    };
+    struct Registration
+    {
+        Waiter  _read;
+        Waiter  _write;
+        int     _events{0}; //events currently registered with the poller
+    };
+    using RegistrationMap = std::unordered_map<int, Registration>;
+
+    void start();
+    void run();
+    void update(RegistrationMap::iterator it);
+    static void notify(Waiter& waiter);
+
+    //Members
+    RegistrationMap                 _registrations;
+    std::mutex                      _mutex;
+    std::shared_ptr<std::thread>    _thread;
+    int                             _pollFd;
+    int                             _wakeFd; //used to interrupt the reactor thread
+    bool                            _isInterrupted;
+    std::atomic_flag                _terminated;
+};
+
+}}
+
+#include <quantum/impl/quantum_reactor_impl.h>
+
+#endif //QUANTUM_REACTOR_H
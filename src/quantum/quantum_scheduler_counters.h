@@ -0,0 +1,46 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_SCHEDULER_COUNTERS_H
+#define QUANTUM_SCHEDULER_COUNTERS_H
+
+#include <atomic>
+#include <cstddef>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                  struct SchedulerCounters
+//==============================================================================================
+/// @struct SchedulerCounters
+/// @brief Counts the scheduling operations of the coroutine queues it is attached to.
+/// @details The counts depend only on the order in which the coroutines run, unlike their duration.
+///          This makes them comparable across runs and machines when the order is deterministic.
+/// @note For internal use only. See Simulation.
+struct SchedulerCounters
+{
+    std::atomic<size_t> _numScans{0};               //run list scans for the next runnable coroutine
+    std::atomic<size_t> _numSlices{0};              //coroutines started or resumed
+    std::atomic<size_t> _numYields{0};              //slices which ended with a yield
+    std::atomic<size_t> _numBlocks{0};              //coroutines parked to wait on a signal or a timer
+    std::atomic<size_t> _numWakeUps{0};             //parked coroutines put back into a run list
+    std::atomic<size_t> _numTimerExpirations{0};    //waits ended by their timer
+    std::atomic<size_t> _numCompletions{0};         //coroutines which ran to the end
+};
+
+}}
+
+#endif //QUANTUM_SCHEDULER_COUNTERS_H
@@ -0,0 +1,139 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_SELECT_H
+#define QUANTUM_SELECT_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <stdexcept>
+#include <quantum/quantum_spinlock.h>
+#include <quantum/quantum_futex.h>
+#include <quantum/quantum_clock.h>
+#include <quantum/quantum_buffer.h>
+#include <quantum/quantum_future.h>
+#include <quantum/quantum_channel.h>
+#include <quantum/interface/quantum_icontext.h>
+#include <quantum/interface/quantum_ifuture_callback.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class Selectable
+//==============================================================================================
+/// @class Selectable
+/// @brief Type-erased source of values which can be passed to select(), i.e. a buffered future or a channel.
+/// @note Implicitly constructed from the source. A selectable holding a channel reference does not own it.
+class Selectable
+{
+public:
+    template <class T>
+    Selectable(const std::shared_ptr<Future<Buffer<T>>>& future);
+    
+    template <class T>
+    Selectable(const std::shared_ptr<ICoroFuture<Buffer<T>>>& future);
+    
+    template <class T>
+    Selectable(const std::shared_ptr<IThreadFuture<Buffer<T>>>& future);
+    
+    template <class T>
+    Selectable(const std::shared_ptr<Channel<T>>& channel);
+    
+    template <class T>
+    Selectable(Channel<T>& channel);
+    
+    void addCallback(IFutureCallback::Ptr callback, size_t index) const;
+    
+    void removeCallback(const IFutureCallback::Ptr& callback) const;
+    
+private:
+    template <class SOURCE>
+    static void addCallbackImpl(void* source, IFutureCallback::Ptr callback, size_t index);
+    template <class SOURCE>
+    static void removeCallbackImpl(void* source, const IFutureCallback::Ptr& callback);
+    
+    // ============================= MEMBERS ==============================
+    std::shared_ptr<void>   _source;
+    void (*_addCallback)(void*, IFutureCallback::Ptr, size_t);
+    void (*_removeCallback)(void*, const IFutureCallback::Ptr&);
+};
+
+//==============================================================================================
+//                                    class SelectCallback
+//==============================================================================================
+/// @class SelectCallback
+/// @brief Readiness callback registered by select() with each of its sources. Wakes up the caller
+///        the first time any of them has data.
+/// @note For internal use only.
+class SelectCallback : public IFutureCallback
+{
+public:
+    SelectCallback(std::atomic_int& signal, ICoroSync::Ptr sync, size_t numSources);
+    
+    void onReady(size_t index) final;
+    
+    /// @brief Stops any further notification.
+    /// @return The index of the ready source or the number of sources if none is ready.
+    size_t disarm();
+    
+private:
+    // ============================= MEMBERS ==============================
+    SpinLock            _spinlock;
+    bool                _isArmed;
+    size_t              _index;
+    std::atomic_int*    _signal;
+    ICoroSync::Ptr      _sync;
+};
+
+/// @brief Waits until any of the sources has a value which can be pulled without blocking.
+/// @param[in] sources Buffered futures and channels to wait on.
+/// @return The index of the ready source. The value must then be pulled from that source.
+/// @note Must be called in a non-coroutine context. A source is also ready when it is closed, when it
+///       holds an exception or when its promise is broken, so that the following pull does not block.
+///       When several sources are ready, successive calls start looking at a different source so that
+///       none of them is starved. Throws if 'sources' is empty.
+size_t select(const std::vector<Selectable>& sources);
+
+/// @brief Same as above but waits at most 'time'.
+/// @param[in] sources Buffered futures and channels to wait on.
+/// @param[in] time Maximum time to wait.
+/// @return The index of the ready source or sources.size() on timeout.
+/// @note A timer can be selected on by using this overload.
+template <class REP, class PERIOD>
+size_t select(const std::vector<Selectable>& sources, const std::chrono::duration<REP, PERIOD>& time);
+
+/// @brief Same as above but must be called from a coroutine.
+/// @param[in] sync Pointer to a coroutine synchronization object.
+/// @param[in] sources Buffered futures and channels to wait on.
+/// @return The index of the ready source.
+/// @note The coroutine is parked by its queue until a source is ready.
+size_t select(ICoroSync::Ptr sync, const std::vector<Selectable>& sources);
+
+/// @brief Same as above but waits at most 'time'.
+/// @param[in] sync Pointer to a coroutine synchronization object.
+/// @param[in] sources Buffered futures and channels to wait on.
+/// @param[in] time Maximum time to wait.
+/// @return The index of the ready source or sources.size() on timeout.
+template <class REP, class PERIOD>
+size_t select(ICoroSync::Ptr sync, const std::vector<Selectable>& sources, const std::chrono::duration<REP, PERIOD>& time);
+
+}}
+
+#include <quantum/impl/quantum_select_impl.h>
+
+#endif //QUANTUM_SELECT_H
@@ -0,0 +1,133 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_SEMAPHORE_H
+#define QUANTUM_SEMAPHORE_H
+
+#include <atomic>
+#include <list>
+#include <chrono>
+#include <quantum/quantum_spinlock.h>
+#include <quantum/quantum_futex.h>
+#include <quantum/quantum_clock.h>
+#include <quantum/interface/quantum_icontext.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class Semaphore
+//==============================================================================================
+/// @class Semaphore.
+/// @brief Coroutine-compatible counting semaphore, typically used to limit concurrency.
+/// @details Permits are granted in FIFO order. A waiter asking for several permits holds back the
+///          waiters behind it until enough permits have been released. Waiting coroutines are parked
+///          by their queue and waiting threads sleep until release() hands them their permits.
+class Semaphore
+{
+public:
+    /// @brief Constructor.
+    /// @param[in] count The initial number of permits.
+    explicit Semaphore(size_t count);
+
+    Semaphore(const Semaphore& other) = delete;
+    Semaphore& operator=(const Semaphore& other) = delete;
+
+    /// @brief Acquire permits, waiting until they are available.
+    /// @param[in] num Number of permits.
+    /// @note Must be called in a non-coroutine context.
+    void acquire(size_t num = 1);
+
+    /// @brief Acquire permits, waiting until they are available.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @param[in] num Number of permits.
+    /// @note Must be called from a coroutine.
+    void acquire(ICoroSync::Ptr sync, size_t num = 1);
+
+    /// @brief Acquire permits if they are available right away.
+    /// @return True if succeeds, false otherwise.
+    bool tryAcquire(size_t num = 1);
+
+    /// @brief Acquire permits, waiting at most 'time' for them.
+    /// @param[in] time Maximum time to wait.
+    /// @param[in] num Number of permits.
+    /// @return True if the permits were acquired, false on timeout.
+    /// @note Must be called in a non-coroutine context.
+    template <class REP, class PERIOD>
+    bool tryAcquireFor(const std::chrono::duration<REP, PERIOD>& time, size_t num = 1);
+
+    /// @brief Same as above but must be called from a coroutine.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    template <class REP, class PERIOD>
+    bool tryAcquireFor(ICoroSync::Ptr sync, const std::chrono::duration<REP, PERIOD>& time, size_t num = 1);
+
+    /// @brief Return permits and grant them to the waiters.
+    /// @param[in] num Number of permits.
+    void release(size_t num = 1);
+
+    /// @brief Number of permits currently available.
+    size_t count() const;
+
+    //==============================================================================================
+    //                                      class Semaphore::Guard
+    //==============================================================================================
+    /// @class Semaphore::Guard
+    /// @brief RAII-style mechanism which acquires permits on construction and releases them inside the destructor.
+    class Guard
+    {
+    public:
+        /// @brief Construct this object and acquire permits.
+        /// @note This constructor must be used in a non-coroutine context.
+        explicit Guard(Semaphore& semaphore, size_t num = 1);
+
+        /// @brief Same as above but must be used in a coroutine context.
+        /// @param[in] sync Pointer to a coroutine synchronization object.
+        Guard(ICoroSync::Ptr sync, Semaphore& semaphore, size_t num = 1);
+
+        /// @brief Destructor. This will release the permits.
+        ~Guard();
+
+    private:
+        //Members
+        Semaphore&  _semaphore;
+        size_t      _num;
+    };
+
+private:
+    struct Waiter
+    {
+        std::atomic_int*    _signal;
+        ICoroSync::Ptr      _sync;
+        size_t              _num;
+    };
+
+    //Returns true if the permits were acquired right away. Otherwise the caller is queued.
+    bool acquireOrWait(std::atomic_int& signal, ICoroSync::Ptr sync, size_t num);
+    void acquireImpl(std::atomic_int& signal, ICoroSync::Ptr sync, size_t num);
+    bool acquireForImpl(std::atomic_int& signal, ICoroSync::Ptr sync, std::chrono::nanoseconds time, size_t num);
+    void grant(std::list<Waiter>& granted); //called with the spinlock held
+    static void notify(Waiter& waiter);
+
+    //Members
+    mutable SpinLock    _spinlock; //protects all the members below
+    size_t              _count;
+    std::list<Waiter>   _waiters;
+};
+
+}}
+
+#include <quantum/impl/quantum_semaphore_impl.h>
+
+#endif //QUANTUM_SEMAPHORE_H
@@ -0,0 +1,92 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_SEQUENCER_H
+#define QUANTUM_SEQUENCER_H
+
+#include <unordered_map>
+#include <deque>
+#include <functional>
+#include <type_traits>
+#include <quantum/quantum_dispatcher.h>
+#include <quantum/quantum_spinlock.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                 class Sequencer
+//==============================================================================================
+/// @class Sequencer.
+/// @brief Runs coroutines in FIFO order per key while coroutines of different keys run in parallel.
+/// @details Only one coroutine per key is posted at any time. When it completes, the next pending coroutine for
+///          the same key is posted on whichever queue is the least busy at that time. Keys are therefore not
+///          tied to a specific thread, which avoids the hot spots caused by hashing keys to a fixed queue id.
+/// @tparam KEY The type of the key. Must be copyable.
+/// @tparam HASH Hash function for KEY.
+/// @tparam KEY_EQUAL Equality comparison function for KEY.
+/// @note The sequencer must outlive all the coroutines enqueued on it.
+template <class KEY, class HASH = std::hash<KEY>, class KEY_EQUAL = std::equal_to<KEY>>
+class Sequencer
+{
+public:
+    /// @brief Constructor.
+    /// @param[in] dispatcher The dispatcher used to run the coroutines.
+    explicit Sequencer(Dispatcher& dispatcher);
+
+    Sequencer(const Sequencer&) = delete;
+
+    Sequencer& operator=(const Sequencer&) = delete;
+
+    /// @brief Enqueue a coroutine which runs after all the coroutines previously enqueued for the same key.
+    /// @tparam RET Type of future returned by this coroutine.
+    /// @tparam FUNC Callable object type. The signature must strictly be 'int f(CoroContext<RET>::Ptr, ...)'.
+    /// @tparam ARGS Argument types passed to FUNC.
+    /// @param[in] key The sequencing key.
+    /// @param[in] func Callable object.
+    /// @param[in] args Variable list of arguments passed to the callable object. Arguments are copied or moved
+    ///                 since the coroutine may start after this call returns.
+    /// @return A pointer to a thread context object.
+    /// @note The returned context cannot be used to chain further coroutines. A coroutine which ends with an
+    ///       error or an exception does not prevent the next one from running.
+    template <class RET = int, class FUNC, class ... ARGS>
+    ThreadContextPtr<RET>
+    enqueue(const KEY& key, FUNC&& func, ARGS&&... args);
+
+    /// @brief Number of keys which have a running or pending coroutine.
+    size_t size() const;
+
+    /// @brief Number of coroutines waiting for their turn on 'key', excluding the running one.
+    size_t size(const KEY& key) const;
+
+private:
+    using PendingQueue = std::deque<std::function<void()>>;
+
+    template <class RET, class FUNC, class ... ARGS>
+    static int run(CoroContextPtr<RET> ctx, Sequencer* sequencer, KEY key, FUNC func, ARGS... args);
+
+    void next(const KEY& key);
+
+    //Members
+    Dispatcher&                                             _dispatcher;
+    std::unordered_map<KEY, PendingQueue, HASH, KEY_EQUAL>  _keys; //keys absent from the map are idle
+    mutable SpinLock                                        _spinlock;
+};
+
+}}
+
+#include <quantum/impl/quantum_sequencer_impl.h>
+
+#endif //QUANTUM_SEQUENCER_H
@@ -0,0 +1,94 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_SHARED_FUTURE_H
+#define QUANTUM_SHARED_FUTURE_H
+
+#include <memory>
+#include <chrono>
+#include <future>
+#include <quantum/quantum_shared_state.h>
+#include <quantum/quantum_future_callback.h>
+#include <quantum/interface/quantum_icoro_sync.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                   class SharedFuture
+//==============================================================================================
+/// @class SharedFuture
+/// @brief Copyable handle giving read-only access to a promised value to any number of consumers.
+/// @tparam T Type of value returned by the future object.
+/// @details Contrary to Future::get(), reading a shared future never moves the value out of the shared
+///          state. Every copy waits on the same state and, once the value is set, returns a const
+///          reference to the single stored value. The value lives as long as any copy of this handle.
+///          Copies can be waited on concurrently from both threads and coroutines.
+/// @note An instance of this class can only be obtained via a Promise or a context object. Calling get()
+///       on another future attached to the same promise invalidates the value for all consumers.
+template <class T>
+class SharedFuture
+{
+public:
+    template <class F> friend class Promise;
+    
+    /// @brief Default constructor with empty state.
+    SharedFuture() = default;
+    
+    /// @brief Determines if this handle is attached to a promise.
+    bool valid() const;
+    
+    /// @brief Waits for the value to be ready.
+    /// @note Must be called in a non-coroutine context.
+    void wait() const;
+    
+    /// @brief Waits for the value to be ready for a maximum of 'timeMs' milliseconds.
+    /// @return 'ready' if value was set before duration expired or 'timeout' otherwise.
+    /// @note Must be called in a non-coroutine context.
+    std::future_status waitFor(std::chrono::milliseconds timeMs) const;
+    
+    /// @brief Get a reference to the value.
+    /// @note Blocks until the value is ready or rethrows the exception set on the promise.
+    ///       Must be called in a non-coroutine context.
+    const T& get() const;
+    
+    /// @brief Same as above but must be called from a coroutine.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    void wait(ICoroSync::Ptr sync) const;
+    
+    /// @brief Same as above but must be called from a coroutine.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    std::future_status waitFor(ICoroSync::Ptr sync, std::chrono::milliseconds timeMs) const;
+    
+    /// @brief Same as above but must be called from a coroutine.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    const T& get(ICoroSync::Ptr sync) const;
+    
+    /// @brief Run 'func' once the value is ready. See IThreadFuture::onReady() for details.
+    template <class FUNC>
+    void onReady(FUNC&& func) const;
+    
+private:
+    explicit SharedFuture(std::shared_ptr<SharedState<T>> sharedState);
+    
+    //Members
+    std::shared_ptr<SharedState<T>>     _sharedState;
+};
+
+}}
+
+#include <quantum/impl/quantum_shared_future_impl.h>
+
+#endif //QUANTUM_SHARED_FUTURE_H
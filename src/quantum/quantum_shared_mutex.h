@@ -0,0 +1,170 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_SHARED_MUTEX_H
+#define QUANTUM_SHARED_MUTEX_H
+
+#include <atomic>
+#include <list>
+#include <utility>
+#include <quantum/quantum_spinlock.h>
+#include <quantum/quantum_futex.h>
+#include <quantum/interface/quantum_icontext.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class SharedMutex
+//==============================================================================================
+/// @class SharedMutex.
+/// @brief Coroutine-compatible implementation of a reader-writer lock.
+/// @details Any number of readers can hold the mutex at the same time while a writer holds it exclusively.
+///          Writers are preferred: once a writer is waiting, new readers wait behind it so that a steady
+///          stream of readers cannot starve writers. Ownership is handed over directly on unlock. Waiting
+///          coroutines are parked by their queue and waiting threads sleep until they are handed the mutex.
+class SharedMutex
+{
+public:
+    /// @brief Default constructor.
+    /// @note Mutex object is in unlocked state.
+    SharedMutex();
+
+    SharedMutex(const SharedMutex& other) = delete;
+    SharedMutex& operator=(const SharedMutex& other) = delete;
+
+    /// @brief Locks this mutex exclusively.
+    /// @note Must be called in a non-coroutine context.
+    void lock();
+
+    /// @brief Locks this mutex exclusively.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @note Must be called from a coroutine.
+    void lock(ICoroSync::Ptr sync);
+
+    /// @brief Tries to lock the mutex exclusively.
+    /// @return True if succeeds, false otherwise.
+    bool tryLock();
+
+    /// @brief Release exclusive ownership.
+    void unlock();
+
+    /// @brief Locks this mutex for reading.
+    /// @note Must be called in a non-coroutine context.
+    void lockShared();
+
+    /// @brief Locks this mutex for reading.
+    /// @param[in] sync Pointer to a coroutine synchronization object.
+    /// @note Must be called from a coroutine.
+    void lockShared(ICoroSync::Ptr sync);
+
+    /// @brief Tries to lock the mutex for reading.
+    /// @return True if succeeds, false if a writer owns the mutex or is waiting for it.
+    bool tryLockShared();
+
+    /// @brief Release shared ownership.
+    void unlockShared();
+
+    //==============================================================================================
+    //                                      class SharedMutex::Guard
+    //==============================================================================================
+    /// @class SharedMutex::Guard
+    /// @brief RAII-style mechanism for exclusive ownership.
+    class Guard
+    {
+    public:
+        /// @brief Construct this object and lock the passed-in mutex exclusively.
+        /// @param[in] mutex Mutex which protects a scope during the lifetime of the Guard.
+        /// @param[in] tryLock If set to true, tries to lock the mutex instead of unconditionally locking it.
+        /// @note This constructor must be used in a non-coroutine context.
+        explicit Guard(SharedMutex& mutex,
+                       bool tryLock = false);
+
+        /// @brief Same as above but must be used in a coroutine context.
+        /// @param[in] sync Pointer to a coroutine synchronization object.
+        Guard(ICoroSync::Ptr sync,
+              SharedMutex& mutex,
+              bool tryLock = false);
+
+        /// @brief Destructor. This will unlock the underlying mutex if owned.
+        ~Guard();
+
+        /// @brief Determines if this object owns the underlying mutex.
+        /// @return True if mutex is locked, false otherwise.
+        bool ownsLock() const;
+
+    private:
+        //Members
+        SharedMutex&    _mutex;
+        bool            _ownsLock;
+    };
+
+    //==============================================================================================
+    //                                      class SharedMutex::SharedGuard
+    //==============================================================================================
+    /// @class SharedMutex::SharedGuard
+    /// @brief RAII-style mechanism for shared ownership.
+    class SharedGuard
+    {
+    public:
+        /// @brief Construct this object and lock the passed-in mutex for reading.
+        /// @param[in] mutex Mutex which protects a scope during the lifetime of the Guard.
+        /// @param[in] tryLock If set to true, tries to lock the mutex instead of unconditionally locking it.
+        /// @note This constructor must be used in a non-coroutine context.
+        explicit SharedGuard(SharedMutex& mutex,
+                             bool tryLock = false);
+
+        /// @brief Same as above but must be used in a coroutine context.
+        /// @param[in] sync Pointer to a coroutine synchronization object.
+        SharedGuard(ICoroSync::Ptr sync,
+                    SharedMutex& mutex,
+                    bool tryLock = false);
+
+        /// @brief Destructor. This will unlock the underlying mutex if owned.
+        ~SharedGuard();
+
+        /// @brief Determines if this object owns the underlying mutex.
+        /// @return True if mutex is locked, false otherwise.
+        bool ownsLock() const;
+
+    private:
+        //Members
+        SharedMutex&    _mutex;
+        bool            _ownsLock;
+    };
+
+private:
+    using Waiter = std::pair<std::atomic_int*, ICoroSync::Ptr>;
+
+    bool tryLockImpl();
+    bool tryLockSharedImpl();
+    void lockImpl(std::atomic_int& signal, ICoroSync::Ptr sync);
+    void lockSharedImpl(std::atomic_int& signal, ICoroSync::Ptr sync);
+    static void wait(std::atomic_int& signal, const ICoroSync::Ptr& sync);
+    static void notify(Waiter& waiter);
+
+    //Members
+    SpinLock            _spinlock; //protects all the members below
+    int                 _numReaders; //readers currently holding the mutex
+    bool                _isWriting; //a writer currently holds the mutex
+    std::list<Waiter>   _readers; //waiting readers
+    std::list<Waiter>   _writers; //waiting writers
+};
+
+}}
+
+#include <quantum/impl/quantum_shared_mutex_impl.h>
+
+#endif //QUANTUM_SHARED_MUTEX_H
@@ -18,11 +18,20 @@
 
 #include <memory>
 #include <exception>
+#include <atomic>
+#include <list>
+#include <utility>
+#include <chrono>
+#include <vector>
 #include <quantum/quantum_traits.h>
 #include <quantum/quantum_future_state.h>
 #include <quantum/quantum_yielding_thread.h>
 #include <quantum/interface/quantum_icontext.h>
+#include <quantum/interface/quantum_ifuture_callback.h>
 #include <quantum/quantum_condition_variable.h>
+#include <quantum/quantum_spinlock.h>
+#include <quantum/quantum_futex.h>
+#include <quantum/quantum_clock.h>
 #include <quantum/quantum_buffer.h>
 
 namespace Bloomberg {
@@ -33,11 +42,16 @@ namespace quantum {
 //==============================================================================================
 /// @class SharedState.
 /// @brief Shared state used between a Promise and a Future to exchange values.
+/// @details The value is set once and read once, so the state is kept in a single atomic word.
+///          Setting the value takes one CAS and reading a ready value takes no lock. Waiters
+///          and completion callbacks are only registered (under a spinlock) while the value
+///          is not yet available.
 /// @note For internal use only.
 template <class T>
 class SharedState
 {
     friend class Promise<T>;
+    template <typename, typename, AllocatorTraits::size_type&(*)()> friend struct SharedAllocator;
     
 public:
     template <class V = T>
@@ -73,44 +87,162 @@ public:
     int setException(ICoroSync::Ptr sync,
                      std::exception_ptr ex);
     
+    void addCallback(IFutureCallback::Ptr callback, size_t index) const;
+    
+    void removeCallback(const IFutureCallback::Ptr& callback) const;
+    
+private:
+    using Waiter = std::pair<std::atomic_int*, ICoroSync::Ptr>;
+    using Callback = std::pair<IFutureCallback::Ptr, size_t>;
+    
+    //Values of the state word besides the FutureState ones
+    enum : int
+    {
+        Setting = 0,            //a producer is writing the value
+        StateMask = 0xFF,
+        WaitersBit = 0x100      //waiters are registered
+    };
+    
+    SharedState();
+    
+    static bool isReady(int word);
+    
+    bool beginSet();
+    
+    void endSet(FutureState state);
+    
+    void abortSet();
+    
+    //Lock-free check for a value which is set and not yet retrieved. Readers take it before anything else.
+    bool isFulfilled() const;
+    
+    //Moves the state to FutureAlreadyRetrieved if the value is fulfilled
+    bool tryRetrieve();
+    
+    T getImpl(std::atomic_int& signal, const ICoroSync::Ptr& sync);
+    
+    const T& getRefImpl(std::atomic_int& signal, const ICoroSync::Ptr& sync) const;
+    
+    void waitImpl(std::atomic_int& signal, const ICoroSync::Ptr& sync) const;
+    
+    std::future_status waitForImpl(std::atomic_int& signal,
+                                   const ICoroSync::Ptr& sync,
+                                   std::chrono::nanoseconds time) const;
+    
+    bool addWaiter(std::atomic_int& signal, const ICoroSync::Ptr& sync) const;
+    
+    void checkPromiseState() const;
+    
+    // ============================= MEMBERS ==============================
+    mutable std::atomic_int         _word;
+    mutable SpinLock                _spinlock; //protects the waiters
+    mutable std::list<Waiter>       _waiters;
+    mutable std::list<Callback>     _callbacks;
+    std::exception_ptr              _exception;
+    T                               _value;
+};
+
+//==============================================================================================
+//                                 class SharedState<Buffer>
+//==============================================================================================
+/// @class SharedState<Buffer>.
+/// @brief Shared state used between a Promise and a Future to stream buffered values.
+/// @note For internal use only.
+template <class T>
+class SharedState<Buffer<T>>
+{
+    friend class Promise<Buffer<T>>;
+    template <typename, typename, AllocatorTraits::size_type&(*)()> friend struct SharedAllocator;
+    
+public:
+    template <class V = Buffer<T>>
+    int set(V&& value);
+    
+    template <class V = Buffer<T>>
+    int set(ICoroSync::Ptr sync, V&& value);
+    
+    Buffer<T> get();
+    
+    Buffer<T> get(ICoroSync::Ptr sync);
+    
+    const Buffer<T>& getRef() const;
+    
+    const Buffer<T>& getRef(ICoroSync::Ptr sync) const;
+    
+    void breakPromise();
+    
+    void wait() const;
+    
+    void wait(ICoroSync::Ptr sync) const;
+    
+    template<class REP, class PERIOD>
+    std::future_status waitFor(const std::chrono::duration<REP, PERIOD> &time) const;
+    
+    template<class REP, class PERIOD>
+    std::future_status waitFor(ICoroSync::Ptr sync,
+                               const std::chrono::duration<REP, PERIOD> &time) const;
+    
+    int setException(std::exception_ptr ex);
+    
+    int setException(ICoroSync::Ptr sync,
+                     std::exception_ptr ex);
+    
+    void addCallback(IFutureCallback::Ptr callback, size_t index) const;
+    
+    void removeCallback(const IFutureCallback::Ptr& callback) const;
+    
     //=========================================================================
     //                         Buffered future access
     //=========================================================================
-    template <class BUF = T, class V = BufferValue<BUF>>
+    template <class BUF = Buffer<T>, class V = BufferValue<BUF>>
     void push(V&& value);
     
-    template <class BUF = T, class V = BufferValue<BUF>>
+    template <class BUF = Buffer<T>, class V = BufferValue<BUF>>
     void push(ICoroSync::Ptr sync, V&& value);
     
-    template <class BUF = T, class V = BufferValue<BUF>>
+    template <class BUF = Buffer<T>, class V = BufferValue<BUF>>
     V pull(bool& isBufferClosed);
     
-    template <class BUF = T, class V = BufferValue<BUF>>
+    template <class BUF = Buffer<T>, class V = BufferValue<BUF>>
     V pull(ICoroSync::Ptr sync, bool& isBufferClosed);
     
-    template <class BUF = T, class V = BufferValue<BUF>>
+    template <class BUF = Buffer<T>, class V = BufferValue<BUF>>
+    void pushMany(std::vector<V>&& values);
+    
+    template <class BUF = Buffer<T>, class V = BufferValue<BUF>>
+    void pushMany(ICoroSync::Ptr sync, std::vector<V>&& values);
+    
+    template <class BUF = Buffer<T>, class V = BufferValue<BUF>>
+    size_t pullMany(std::vector<V>& values, size_t maxCount, bool& isBufferClosed);
+    
+    template <class BUF = Buffer<T>, class V = BufferValue<BUF>>
+    size_t pullMany(ICoroSync::Ptr sync, std::vector<V>& values, size_t maxCount, bool& isBufferClosed);
+    
+    template <class BUF = Buffer<T>, class V = BufferValue<BUF>>
     int closeBuffer();
     
 private:
     SharedState();
     
-    void conditionWait() const;
-    
-    void conditionWait(ICoroSync::Ptr sync) const;
-    
     void checkPromiseState() const;
     
-    bool stateHasChanged() const;
-    
-    template <class BUF = T, class V = BufferValue<BUF>>
     bool bufferStateHasChanged(BufferStatus status) const;
     
+    bool isPullable() const; //called with the mutex held
+    
+    void notifyCallbacks() const; //called after each state change
+    
     // ============================= MEMBERS ==============================
+    using Callback = std::pair<IFutureCallback::Ptr, size_t>;
+    
     mutable ConditionVariable       _cond;
     mutable Mutex                   _mutex;
     FutureState                     _state;
     std::exception_ptr              _exception;
-    T                               _value;
+    Buffer<T>                       _value;
+    mutable SpinLock                _callbackLock; //protects the callbacks
+    mutable std::list<Callback>     _callbacks; //stream readiness, kept until removed
+    mutable std::atomic_size_t      _numCallbacks;
 };
 
 }}
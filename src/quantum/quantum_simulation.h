@@ -0,0 +1,131 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_SIMULATION_H
+#define QUANTUM_SIMULATION_H
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <quantum/quantum_clock.h>
+#include <quantum/quantum_dispatcher.h>
+#include <quantum/quantum_scheduler_counters.h>
+#include <quantum/quantum_spinlock.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class Simulation
+//==============================================================================================
+/// @class Simulation.
+/// @brief Deterministic single-threaded execution of the coroutines of a dispatcher, for comparing
+///        scheduling changes independently of the hardware and of the OS scheduler.
+/// @details The coroutines run on the calling thread, one time slice per step, on a queue picked by a
+///          pseudo-random generator seeded by the caller. The same seed and the same program produce the
+///          same interleaving, which is summarized by Statistics::_scheduleHash.
+///          While the coroutines run, sleep() and the timed waits of coroutines read a virtual clock. The
+///          clock only moves when every coroutine is waiting on a timer, in which case it jumps to the next
+///          deadline, so simulated sleeps take no time.
+///          The scheduling operations are counted instead of timed, see Statistics.
+/// @note The dispatcher must have all its coroutine queues manual (see Configuration::setNumManualCoroutineQueues())
+///       and must only be driven by this object while it exists. IO tasks and delayed posts still run on their
+///       own threads in real time, so interleavings involving them are only reproducible when at most one is
+///       outstanding at a time. All the calls must be made from the same thread.
+class Simulation
+{
+public:
+    /// @brief Scheduling operations counted since construction.
+    struct Statistics
+    {
+        size_t                      _numSteps;              //time slices run by step()
+        size_t                      _numScans;              //run list scans for the next runnable coroutine
+        size_t                      _numSlices;             //coroutines started or resumed
+        size_t                      _numYields;             //slices which ended with a yield
+        size_t                      _numBlocks;             //coroutines parked to wait on a signal or a timer
+        size_t                      _numWakeUps;            //parked coroutines put back into a run list
+        size_t                      _numTimerExpirations;   //waits ended by their timer
+        size_t                      _numCompletions;        //coroutines which ran to the end
+        size_t                      _numClockAdvances;      //jumps of the virtual clock to the next timer
+        size_t                      _numLockAcquisitions;   //spinlocks taken by this thread, 0 unless __QUANTUM_SPINLOCK_STATS
+        std::chrono::nanoseconds    _virtualTime;           //elapsed on the virtual clock
+        uint64_t                    _scheduleHash;          //fingerprint of the queue and outcome of every slice
+    };
+    
+    /// @brief Constructor.
+    /// @param[in] dispatcher The dispatcher to drive. Must outlive this object.
+    /// @param[in] seed Seeds the order in which the queues are served.
+    /// @note Throws if some coroutine queue of the dispatcher has a thread.
+    Simulation(Dispatcher& dispatcher, uint64_t seed);
+    
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+    
+    /// @brief Destructor. Stops counting the operations of the dispatcher.
+    ~Simulation();
+    
+    /// @brief Run one time slice.
+    /// @return False if no coroutine is runnable, none waits on a timer and no IO task is outstanding.
+    /// @note Advances the virtual clock if all the coroutines are waiting on timers. Waits for the outstanding
+    ///       IO tasks if nothing else can run.
+    bool step();
+    
+    /// @brief Run time slices until step() returns false.
+    /// @param[in] maxSteps Maximum number of slices to run.
+    /// @return The number of slices run.
+    size_t run(size_t maxSteps = std::numeric_limits<size_t>::max());
+    
+    /// @brief Get the current virtual time.
+    Clock::TimePoint now() const;
+    
+    /// @brief Move the virtual clock forward.
+    /// @param[in] time Amount to add. Waits expiring in the meantime time out on the next step.
+    void advance(std::chrono::nanoseconds time);
+    
+    /// @brief Get the seed passed to the constructor.
+    uint64_t getSeed() const;
+    
+    /// @brief Get the operations counted so far.
+    Statistics statistics() const;
+    
+    void print(std::ostream& out) const;
+    
+private:
+    void hash(uint64_t value);
+    
+    //Members
+    Dispatcher&                 _dispatcher;
+    uint64_t                    _seed;
+    std::mt19937_64             _random; //the sequence is specified by the standard, unlike the distributions
+    SchedulerCounters           _counters;
+    Clock::TimePoint            _start;
+    Clock::TimePoint            _now;
+    size_t                      _numSteps;
+    size_t                      _numClockAdvances;
+    size_t                      _firstLockAcquisitions;
+    uint64_t                    _scheduleHash;
+};
+
+std::ostream& operator<<(std::ostream& out, const Simulation& simulation);
+
+}}
+
+#include <quantum/impl/quantum_simulation_impl.h>
+
+#endif //QUANTUM_SIMULATION_H
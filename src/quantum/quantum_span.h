@@ -0,0 +1,70 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_SPAN_H
+#define QUANTUM_SPAN_H
+
+#include <cstddef>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class Span
+//==============================================================================================
+/// @class Span.
+/// @brief Non-owning view over a contiguous range of elements.
+/// @details Handed to batch kernels so that they can run plain indexed loops over raw memory, which
+///          the compiler is able to vectorize.
+/// @tparam T The element type. Use a const type for read-only views.
+template <class T>
+class Span
+{
+public:
+    using value_type = T;
+    using iterator = T*;
+    
+    /// @brief Constructor.
+    /// @param[in] data Pointer to the first element.
+    /// @param[in] size Number of elements.
+    Span(T* data, size_t size);
+    
+    /// @brief Pointer to the first element.
+    T* data() const;
+    
+    /// @brief Number of elements in the view.
+    size_t size() const;
+    
+    /// @brief Indicates if the view has no elements.
+    bool empty() const;
+    
+    /// @brief Access the i-th element. No bounds checking is performed.
+    T& operator[](size_t i) const;
+    
+    /// @brief Iterators to the range [data(), data()+size()).
+    T* begin() const;
+    T* end() const;
+    
+private:
+    //Members
+    T*      _data;
+    size_t  _size;
+};
+
+}}
+
+#include <quantum/impl/quantum_span_impl.h>
+
+#endif //QUANTUM_SPAN_H
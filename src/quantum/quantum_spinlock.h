@@ -18,16 +18,42 @@
 
 #include <atomic>
 #include <mutex>
+#include <thread>
 
 namespace Bloomberg {
 namespace quantum {
 
+//==============================================================================================
+//                                 class SpinBackoff
+//==============================================================================================
+/// @class SpinBackoff
+/// @brief Bounded exponential backoff used by the spinlocks while waiting for a lock to be released.
+/// @details Each call to backoff() issues twice as many CPU relax hints as the previous one up to
+///          a maximum, after which the thread also yields its time slice.
+class SpinBackoff
+{
+public:
+    /// @brief Issue a single CPU relax hint (i.e. 'pause' on x86).
+    static void cpuRelax();
+    
+    /// @brief Wait for an exponentially increasing amount of time.
+    void backoff();
+    
+private:
+    static constexpr int MaxSpins = 64;
+    int     _numSpins{1};
+};
+
 //==============================================================================================
 //                                 class SpinLock
 //==============================================================================================
 /// @class SpinLock
 /// @brief Coroutine-compatible spinlock. Used internally for mutexes since threads running
 ///        coroutines cannot block.
+/// @details Implemented as a test-and-test-and-set lock: waiters spin on a plain read of the lock
+///          word with exponential backoff and only retry the atomic exchange once the lock appears free.
+///          Define __QUANTUM_SPINLOCK_STATS to count how many times lock() found the lock taken and how
+///          many spinlocks each thread acquired.
 class SpinLock
 {
 public:
@@ -62,6 +88,14 @@ public:
     /// @note Never blocks.
     void unlock();
     
+    /// @brief Number of times lock() had to wait for the lock.
+    /// @return The contention count or 0 if __QUANTUM_SPINLOCK_STATS is not defined.
+    size_t contentionCount() const;
+    
+    /// @brief Number of spinlocks acquired by the calling thread since it started.
+    /// @return The acquisition count or 0 if __QUANTUM_SPINLOCK_STATS is not defined.
+    static size_t threadAcquisitionCount();
+    
     //==============================================================================================
     //                                      class SpinLock::Guard
     //==============================================================================================
@@ -122,7 +156,14 @@ public:
     };
     
 private:
-    std::atomic_flag 	_flag;
+#ifdef __QUANTUM_SPINLOCK_STATS
+    static size_t& threadAcquisitions();
+#endif
+    
+    std::atomic_bool        _locked;
+#ifdef __QUANTUM_SPINLOCK_STATS
+    std::atomic<size_t>     _contentionCount;
+#endif
 };
 
 }}
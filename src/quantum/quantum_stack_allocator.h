@@ -72,10 +72,10 @@ struct StackAllocator : public ContiguousPoolManager<T>
     template <typename U>
     StackAllocator& operator=(const StackAllocator<U,SIZE>&)
     {}
-    bool operator==(const this_type& other) const {
+    bool operator==(const this_type&) const {
         return false;
     }
-    bool operator!=(const this_type& other) const {
+    bool operator!=(const this_type&) const {
         return true;
     }
     
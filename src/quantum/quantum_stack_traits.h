@@ -21,6 +21,20 @@
 namespace Bloomberg {
 namespace quantum {
 
+//==============================================================================================
+//                                 enum StackSizeClass
+//==============================================================================================
+/// @enum StackSizeClass.
+/// @brief Size hint for the stack of a posted coroutine.
+/// @note Each class is served by its own stack pool. See StackTraits::classSize() for the sizes.
+enum class StackSizeClass : int
+{
+    Default,    ///< StackTraits::defaultSize()
+    Small,      ///< Shallow coroutines. 16kB unless modified.
+    Medium,     ///< 64kB unless modified.
+    Large       ///< Deep coroutines such as recursive parsers. 256kB unless modified.
+};
+
 //==============================================================================================
 //                                 struct StackTraits
 //==============================================================================================
@@ -51,6 +65,13 @@ struct StackTraits {
     /// @return Modifiable reference to the size in bytes.
     /// @note Only takes effect if isUnbounded() == false.
     static size_t& maximumSize();
+    
+    /// @brief Get/set the stack size of a size class.
+    /// @param[in] sizeClass The size class. StackSizeClass::Default maps to defaultSize().
+    /// @return Modifiable reference to the size in bytes.
+    /// @note Must be set before the first coroutine of that class is posted. Sizes are bounded by
+    ///       minimumSize() and maximumSize().
+    static size_t& classSize(StackSizeClass sizeClass);
 };
 
 }}
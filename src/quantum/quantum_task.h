@@ -20,13 +20,20 @@
 #include <memory>
 #include <list>
 #include <utility>
+#include <chrono>
+#include <typeinfo>
+#include <boost/optional.hpp>
 #include <quantum/interface/quantum_iterminate.h>
 #include <quantum/interface/quantum_icontext.h>
 #include <quantum/interface/quantum_iqueue.h>
 #include <quantum/interface/quantum_itask_continuation.h>
 #include <quantum/interface/quantum_itask_accessor.h>
+#include <quantum/interface/quantum_ipromise_base.h>
 #include <quantum/quantum_traits.h>
 #include <quantum/quantum_util.h>
+#include <quantum/quantum_cancellation_token.h>
+#include <quantum/quantum_coro_local.h>
+#include <quantum/quantum_profile.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -43,6 +50,7 @@ class Task : public ITaskContinuation,
 public:
     using Ptr = std::shared_ptr<Task>;
     using WeakPtr = std::weak_ptr<Task>;
+    using TimePoint = std::chrono::steady_clock::time_point;
     
     template <class RET, class FUNC, class ... ARGS>
     Task(std::shared_ptr<Context<RET>> ctx,
@@ -58,6 +66,23 @@ public:
          FUNC&& func,
          ARGS&&... args);
     
+    template <class RET, class FUNC, class ... ARGS>
+    Task(std::shared_ptr<Context<RET>> ctx,
+         int queueId,
+         bool isHighPriority,
+         ITask::Type type,
+         StackSizeClass stackSize,
+         FUNC&& func,
+         ARGS&&... args);
+    
+    //Stackless task. The function runs to completion directly on the queue thread and cannot yield.
+    template <class RET, class FUNC, class ... ARGS>
+    Task(std::shared_ptr<Promise<RET>> promise,
+         int queueId,
+         bool isHighPriority,
+         FUNC&& func,
+         ARGS&&... args);
+    
     Task(const Task& task) = delete;
     Task(Task&& task) = default;
     Task& operator=(const Task& task) = delete;
@@ -75,6 +100,7 @@ public:
     Type getType() const final;
     bool isBlocked() const final;
     bool isHighPriority() const final;
+    bool isCancelled() const final;
     
     //ITaskContinuation
     ITaskContinuation::Ptr getNextTask() final;
@@ -87,23 +113,154 @@ public:
     //the subsequent continuation tasks
     ITaskContinuation::Ptr getErrorHandlerOrFinalTask() final;
     
+    //Scheduling attributes. The priority selects the run list of the queue and tasks having a
+    //deadline run ahead of the other tasks of the same priority in earliest-deadline order.
+    void setPriority(IQueue::Priority priority);
+    IQueue::Priority getPriority() const;
+    void setDeadline(TimePoint deadline);
+    bool hasDeadline() const;
+    TimePoint getDeadline() const;
+    
+    //Returns true if this task can be moved to another coroutine queue i.e. it was
+    //posted on the 'any' queue, it is the head of a chain and it has not started running.
+    bool isStealable() const;
+    
+    //Returns true if this task can be handed over to another coroutine queue while it is not running i.e.
+    //neither it nor the head of its chain was posted on a specific queue. See Configuration::setCoroutineMigration().
+    bool isMigratable() const;
+    
+    //Continuations inherit the queue of the task they follow and must stay there if that task was pinned.
+    void inheritPinning(const Task& previous);
+    
+    //Cancellation support. The token is inherited by continuations and child coroutines.
+    void setCancellationToken(CancellationToken::Ptr token);
+    const CancellationToken::Ptr& getCancellationToken() const;
+    bool isStarted() const;
+    
+    //Coroutine-local storage. Shared along a continuation chain.
+    void setLocalStorage(CoroLocalStorage::Ptr storage);
+    const CoroLocalStorage::Ptr& getLocalStorage() const;
+    
+    //Parking support. A blocked task is moved by its queue out of the run list until
+    //it gets signalled. tryUnpark() returns true only once per park() call and is used to
+    //arbitrate between the waking thread and the queue thread.
+    void park();
+    bool tryUnpark();
+    
+    //Timer support for timed waits. The wake-up time is set by the running coroutine before it
+    //blocks and is scheduled by its queue when the task gets parked. Each new wake-up time gets a
+    //new id so that stale timers can be ignored. All these are only accessed from the queue thread, except
+    //for the id which a previous queue may still check after the task has migrated.
+    void setWakeUpTime(TimePoint time);
+    void clearWakeUpTime();
+    bool getUnscheduledTimer(TimePoint& time, size_t& timerId);
+    bool expireTimer(size_t timerId);
+    //Invalidates the timer held by the current queue before the task migrates. The new queue
+    //schedules a timer of its own if the task parks again with the same wake-up time.
+    void migrateTimer();
+    
+    //Latency statistics support. The post time is set by the posting thread before the task is
+    //published to its queue and the start time by the queue thread. Only set when enabled.
+    void setPostTime(TimePoint time);
+    TimePoint getPostTime() const;
+    void setStartTime(TimePoint time);
+    TimePoint getStartTime() const;
+    
+    //Watchdog support. Set by the queue thread when the task gets parked, under the queue lock.
+    void setParkTime(TimePoint time);
+    TimePoint getParkTime() const;
+    
+    //Profiler support. Defaults to the demangled type of the callable object. The label is not copied
+    //and is read by the profiler while the task runs.
+    void setLabel(const char* label);
+    const char* getLabel() const;
+    
+    //Queue support. The queue holding a task owns it through the reference embedded here, which is moved
+    //in when the task is posted and out when it is removed for good. In between, the queue links the task
+    //into its inbox, run lists and wait set through the pointers below, so that moving it around neither
+    //allocates nor updates its reference count. A signalled task is linked into the wake-up inbox while it
+    //is still in the wait set.
+    struct QueueHook
+    {
+        Ptr     _owner; //null while the task is not held by a queue
+        Task*   _prev; //run list or wait set
+        Task*   _next;
+        Task*   _inboxNext;
+    };
+    QueueHook& getQueueHook();
+    
     //===================================
     //           NEW / DELETE
     //===================================
     static void* operator new(size_t size);
     static void operator delete(void* p);
     static void deleter(Task* p);
+    /// @brief Creates an object whose reference counts share its pool block (see SharedAllocator).
+    template <class ... ARGS>
+    static Ptr create(ARGS&&... args);
     
 private:
+    //Returns the stack pool serving a size class
+    static CoroStackAllocator& stackAllocator(StackSizeClass stackSize);
+    
+    //Holds the coroutine function of a continuation until the continuation becomes runnable so that
+    //a chain does not hold a stack for each of its stages up front.
+    struct CoroutineFactory
+    {
+        virtual ~CoroutineFactory() = default;
+        virtual Traits::Coroutine create(CoroStackAllocator& allocator) = 0;
+    };
+    
+    template <class FUNC>
+    struct CoroutineFactoryImpl : CoroutineFactory
+    {
+        explicit CoroutineFactoryImpl(FUNC&& func) : _func(std::move(func)) {}
+        Traits::Coroutine create(CoroStackAllocator& allocator) final
+        {
+            return Traits::Coroutine(allocator, std::move(_func));
+        }
+        FUNC _func;
+    };
+    
+    //Mangled name of the callable type. Demangled by the profiler.
+    template <class FUNC>
+    static const char* typeLabel();
+    
+    template <class RET, class FUNC, class ... ARGS>
+    void initCoroutine(std::shared_ptr<Context<RET>> ctx, FUNC&& func, ARGS&&... args);
+    
+
     ITaskAccessor::Ptr          _ctx; //holds execution context
-    Traits::Coroutine           _coro; //the current runnable coroutine
+    StackSizeClass              _stackSize;
+    boost::optional<Traits::Coroutine> _coro; //the current runnable coroutine. Continuations create it on their first run.
+    std::unique_ptr<CoroutineFactory> _coroFactory; //continuation coroutine not created yet
+    boost::optional<Function<int()>> _func; //body of a stackless task. Empty for coroutines.
+    IPromiseBase::Ptr           _promise; //promise of a stackless task. Broken if the task is discarded before running.
     int                         _queueId;
     bool                        _isHighPriority;
+    IQueue::Priority            _priority;
+    TimePoint                   _deadline; //TimePoint::max() if none
     int                         _rc; //return from the co-routine
     ITaskContinuation::Ptr      _next; //Task scheduled to run after current completes.
     ITaskContinuation::WeakPtr  _prev; //Previous task in the chain
+    ITaskContinuation::WeakPtr  _first; //First task in the chain. Empty for the first task itself.
     ITask::Type                 _type;
     std::atomic_flag            _terminated;
+    bool                        _isPinned; //task was posted on a specific queue
+    bool                        _isStarted; //coroutine has been resumed at least once
+    std::atomic_bool            _isParked; //task is held in its queue's wait set
+    TimePoint                   _wakeUpTime;
+    std::atomic_size_t          _timerId; //id of the current wake-up time
+    bool                        _hasWakeUpTime;
+    bool                        _isTimerScheduled; //queue holds a timer for the current id
+    bool                        _isTimerExpired; //task may run even though it's blocked
+    TimePoint                   _postTime;
+    TimePoint                   _startTime; //first resume
+    TimePoint                   _parkTime;
+    CancellationToken::Ptr      _cancellationToken; //null if not cancellable
+    CoroLocalStorage::Ptr       _localStorage; //null until a local value is set
+    QueueHook                   _queueHook;
+    const char*                 _label; //reported by the sampling profiler
 };
 
 using TaskPtr = Task::Ptr;
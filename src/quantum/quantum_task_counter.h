@@ -0,0 +1,112 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_TASK_COUNTER_H
+#define QUANTUM_TASK_COUNTER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <vector>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class TaskCounter
+//==============================================================================================
+/// @class TaskCounter.
+/// @brief Counts the tasks which have been posted to a dispatcher but have not yet completed.
+/// @details The queues increment the count when a task is enqueued and decrement it once the task
+///          has been removed for good, so that continuations handed over between queues are always
+///          accounted for. The decrement which brings the count to zero signals quiescence to the
+///          waiting threads and to the registered callbacks. The mutex is only taken when somebody
+///          is waiting. The posters blocked by the admission policy wait here as well and are woken up
+///          when the count or one of the queues drains down to its low watermark.
+/// @note For internal use only.
+class TaskCounter
+{
+public:
+    using Callback = std::function<void()>;
+    
+    TaskCounter();
+    
+    TaskCounter(const TaskCounter& other) = delete;
+    TaskCounter& operator=(const TaskCounter& other) = delete;
+    
+    /// @brief Increment the count of outstanding tasks.
+    /// @param[in] num Number of tasks posted.
+    void increment(size_t num = 1);
+    
+    /// @brief Decrement the count of outstanding tasks and signal quiescence when it reaches zero.
+    /// @param[in] num Number of tasks completed.
+    void decrement(size_t num = 1);
+    
+    /// @brief Get the number of outstanding tasks.
+    size_t count() const;
+    
+    /// @brief Wait until there are no outstanding tasks.
+    /// @param[in] timeout Maximum time to wait. Set to 0 to wait indefinitely.
+    /// @return True if no tasks are outstanding, false on timeout.
+    bool wait(std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+    
+    /// @brief Invoke a callback the next time there are no outstanding tasks.
+    /// @param[in] callback The callback. Runs right away on this thread if nothing is outstanding,
+    ///                     otherwise on the thread which completes the last task.
+    void onQuiescence(Callback callback);
+    
+    /// @brief Same as above but returns a future which becomes ready instead of invoking a callback.
+    std::future<void> whenQuiescent();
+    
+    /// @brief Reset the count to zero and signal quiescence. Called when the dispatcher terminates
+    ///        and discards the remaining tasks.
+    void reset();
+    
+    /// @brief Set the count at which the posters blocked in waitForAdmission() are woken up.
+    /// @param[in] num The global low watermark. Default is 0.
+    void setLowWatermark(size_t num);
+    
+    /// @brief Block the calling thread until a post is admitted.
+    /// @param[in] isAdmitted Evaluated on entry and each time notifyAdmission() is called. Returns true
+    ///                       once the post is admitted.
+    void waitForAdmission(const std::function<bool()>& isAdmitted);
+    
+    /// @brief Wake up the posters blocked in waitForAdmission(). Called by the queues when they drain
+    ///        down to their low watermark.
+    void notifyAdmission();
+    
+private:
+    void notify();
+    
+    //Members
+    std::atomic<size_t>         _count;
+    std::atomic<size_t>         _numWaiters; //waiting threads and registered callbacks
+    std::mutex                  _mutex; //protects the callbacks
+    std::condition_variable     _cond;
+    std::vector<Callback>       _callbacks;
+    size_t                      _lowWatermark;
+    std::atomic<size_t>         _numAdmissionWaiters;
+    std::mutex                  _admissionMutex;
+    std::condition_variable     _admissionCond;
+};
+
+}}
+
+#include <quantum/impl/quantum_task_counter_impl.h>
+
+#endif //QUANTUM_TASK_COUNTER_H
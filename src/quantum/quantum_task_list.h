@@ -0,0 +1,104 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_TASK_LIST_H
+#define QUANTUM_TASK_LIST_H
+
+#include <cstddef>
+#include <iterator>
+#include <quantum/quantum_task.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class TaskList
+//==============================================================================================
+/// @class TaskList.
+/// @brief Doubly linked list of tasks linked through the hooks embedded in the tasks.
+/// @details Inserting, erasing and moving a task between lists neither allocates nor touches its reference
+///          count. A task can be in a single list at a time. The list does not own its tasks, see
+///          Task::QueueHook.
+/// @note For internal use only.
+class TaskList
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = Task;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Task*;
+        using reference = Task&;
+        
+        iterator();
+        iterator(const TaskList* list, Task* task);
+        
+        Task& operator*() const;
+        Task* operator->() const;
+        iterator& operator++();
+        iterator operator++(int);
+        iterator& operator--(); //end() moves to the last task
+        bool operator==(const iterator& other) const;
+        bool operator!=(const iterator& other) const;
+        
+    private:
+        friend class TaskList;
+        
+        const TaskList* _list;
+        Task*           _task; //null for end()
+    };
+    
+    TaskList();
+    
+    TaskList(const TaskList& other) = delete;
+    TaskList& operator=(const TaskList& other) = delete;
+    
+    iterator begin() const;
+    iterator end() const;
+    
+    /// @brief Get an iterator to a task in this list in constant time.
+    iterator iteratorTo(Task& task) const;
+    
+    bool empty() const;
+    size_t size() const;
+    
+    /// @brief Link a task which is not in any list ahead of 'pos'.
+    /// @return An iterator to the task.
+    iterator insert(iterator pos, Task& task);
+    
+    /// @brief Unlink a task.
+    /// @return An iterator to the next task.
+    iterator erase(iterator pos);
+    
+    /// @brief Move a task of this list ahead of 'pos'. Iterators remain valid.
+    void splice(iterator pos, iterator it);
+    
+    /// @brief Unlink all the tasks.
+    void clear();
+    
+private:
+    //Members
+    Task*   _head;
+    Task*   _tail;
+    size_t  _size;
+};
+
+}}
+
+#include <quantum/impl/quantum_task_list_impl.h>
+
+#endif //QUANTUM_TASK_LIST_H
@@ -17,6 +17,10 @@
 #define QUANTUM_TASK_QUEUE_H
 
 #include <list>
+#include <vector>
+#include <array>
+#include <queue>
+#include <chrono>
 #include <atomic>
 #include <functional>
 #include <algorithm>
@@ -32,6 +36,11 @@
 #include <quantum/quantum_yielding_thread.h>
 #include <quantum/quantum_queue_statistics.h>
 #include <quantum/quantum_configuration.h>
+#include <quantum/quantum_tracer.h>
+#include <quantum/quantum_task_counter.h>
+#include <quantum/quantum_task_list.h>
+#include <quantum/quantum_clock.h>
+#include <quantum/quantum_scheduler_counters.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -45,12 +54,16 @@ namespace quantum {
 class TaskQueue : public IQueue
 {
 public:
-    using TaskList = std::list<Task::Ptr, QueueListAllocator>;
     using TaskListIter = TaskList::iterator;
     
     TaskQueue();
     
-    explicit TaskQueue(const Configuration& config);
+    /// @brief Constructor.
+    /// @param[in] config The dispatcher configuration.
+    /// @param[in] taskCounter Counter of the tasks outstanding on the dispatcher. May be null.
+    /// @param[in] startThread If set to false, the queue has no thread until start() is called. Until then it can
+    ///                        be driven by runOnce() instead. A copy has a thread only if the original has one.
+    explicit TaskQueue(const Configuration& config, TaskCounter* taskCounter = nullptr, bool startThread = true);
     
     TaskQueue(const TaskQueue& other);
     
@@ -62,8 +75,33 @@ public:
     
     void run() final;
     
+    /// @brief Start the thread of this queue.
+    /// @note Has no effect if the thread is already started or if the queue has been terminated. Thread-safe.
+    void start();
+    
+    /// @brief Check if this queue has a thread of its own.
+    /// @return True if the thread is started, false otherwise.
+    bool isStarted() const;
+    
+    /// @brief Check if this queue is saturated.
+    /// @return True if the queue has reached its high watermark and not yet drained down to its low watermark.
+    /// @note Counts the times the high watermark is reached in the statistics. Can be called from any thread.
+    bool isSaturated();
+    
+    /// @brief Run the coroutines of a queue without a thread on the calling thread.
+    /// @param[in] budget Maximum number of time slices to run.
+    /// @return The number of time slices run. Less than 'budget' if no coroutine is runnable anymore.
+    /// @note Must only be called by one thread at a time and never from a coroutine. Parked coroutines
+    ///       are resumed by a later call once they have been signalled or their wait has timed out.
+    size_t runOnce(size_t budget);
+    
     void enqueue(ITask::Ptr task) final;
     
+    /// @brief Enqueue several tasks at once.
+    /// @param[in] tasks The tasks to enqueue, in posting order.
+    /// @note The tasks are published with a single atomic operation and the thread is notified at most once.
+    void enqueueBatch(const std::vector<Task::Ptr>& tasks);
+    
     bool tryEnqueue(ITask::Ptr task) final;
     
     ITask::Ptr dequeue(std::atomic_bool& hint) final;
@@ -76,6 +114,10 @@ public:
     
     void terminate() final;
     
+    /// @brief Signal the thread to exit without waiting for it.
+    /// @note Lets the dispatcher signal all of its queues before joining them via terminate().
+    void interrupt();
+    
     IQueueStatistics& stats() final;
     
     SpinLock& getLock() final;
@@ -83,24 +125,191 @@ public:
     void signalEmptyCondition(bool value) final;
     
     bool isIdle() const final;
+    
+    /// @brief Provide the sibling queues from which this queue can steal work when idle and to which
+    ///        it can migrate work when overloaded.
+    /// @param[in] queues The list of all coroutine queues including this one.
+    /// @note Has no effect unless work stealing or migration is enabled in the configuration.
+    void setSiblingQueues(std::vector<TaskQueue>* queues);
+    
+    /// @brief Assign this queue to a NUMA node.
+    /// @param[in] node The node index or -1 if unassigned.
+    /// @note Must be called before the sibling queues are set.
+    void setNumaNode(int node);
+    
+    /// @brief Get the NUMA node of this queue.
+    /// @return The node index or -1 if unassigned.
+    int getNumaNode() const;
+    
+    /// @brief Return a parked task to the run list.
+    /// @param[in] task The task which was signalled.
+    /// @note Can be called from any thread. The task must have been successfully unparked via Task::tryUnpark().
+    ///       The wait set keeps holding the task until it is back in a run list.
+    void unpark(Task& task);
+    
+    /// @brief Take over a runnable task migrated from an overloaded sibling queue.
+    /// @param[in] task The task, which has already been unlinked from its previous queue along with the
+    ///                 reference held by that queue.
+    /// @note Can be called from any thread. The task must not be running.
+    void adopt(Task& task);
+    
+    /// @brief Move a runnable task so that it runs right after the current one yields.
+    /// @param[in] task The task to run next.
+    /// @return True if the task was found in a run list, false if it is parked, running or gone.
+    /// @note Must be called from the coroutine running on this queue. The task runs next among the
+    ///       tasks of its priority level. Finding it is linear in the size of its run list.
+    bool scheduleNext(const Task::Ptr& task);
+    
+    /// @brief Get the time at which the coroutine currently running on this queue was resumed.
+    /// @return The resume time or a default-constructed time point if no coroutine is running.
+    /// @note Only tracked if the watchdog is enabled in the configuration. Can be called from any thread.
+    Task::TimePoint getSliceStartTime() const;
+    
+    /// @brief Get the label of the coroutine currently running on this queue.
+    /// @return The label or null if no coroutine is running.
+    /// @note Only tracked if the sampling profiler is enabled in the configuration. Can be called from any thread.
+    const char* getRunningLabel() const;
+    
+    /// @brief Get the number of parked coroutines waiting for a signal.
+    /// @note Can be called from any thread without locking.
+    size_t getNumBlocked() const;
+    
+    /// @brief Get the parked coroutines which started waiting within a time window.
+    /// @param[in] from Start of the window, excluded.
+    /// @param[in] to End of the window, included.
+    /// @param[out] blocked Receives each coroutine along with the time it was parked.
+    /// @note Only tracked if the watchdog is enabled in the configuration. Can be called from any thread.
+    void getBlockedTasks(Task::TimePoint from,
+                         Task::TimePoint to,
+                         std::vector<std::pair<const Task*, Task::TimePoint>>& blocked) const;
+    
+    /// @brief Count the scheduling operations of this queue.
+    /// @param[in] counters The counters to increment or null to stop counting. Must outlive the queue or
+    ///                     be detached first.
+    void setSchedulerCounters(SchedulerCounters* counters);
+    
+    /// @brief Get the earliest time at which the wait of a parked coroutine times out.
+    /// @param[out] time Receives the time.
+    /// @return False if no parked coroutine waits with a timeout.
+    /// @note Must be called from the thread running this queue, i.e. the one calling runOnce().
+    bool getNextTimerTime(Task::TimePoint& time) const;
 
 private:
-    TaskListIter advance();
-    void doEnqueue(ITask::Ptr task);
+    //Wake-up time of a parked task which is waiting with a timeout
+    struct Timer
+    {
+        bool operator>(const Timer& other) const { return _time > other._time; }
+        
+        Task::TimePoint _time;
+        Task::WeakPtr   _task;
+        size_t          _timerId;
+    };
+    using TimerQueue = std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>>;
+    
+    //Round-robin list of runnable tasks for a single priority level
+    struct RunList
+    {
+        RunList() :
+            _it(_tasks.end()),
+            _numSkipped(0)
+        {}
+        
+        TaskList        _tasks;
+        TaskListIter    _it; //next task to run in this list
+        size_t          _numSkipped; //consecutive slices given to other levels while this one was runnable
+    };
+    static constexpr size_t numPriorityLevels = 4; //see IQueue::Priority
+    using RunLists = std::array<RunList, numPriorityLevels>;
+    
+    //Lock-free multi-producer inboxes linked through Task::QueueHook::_inboxNext
+    static void pushInbox(std::atomic<Task*>& inbox, Task& task);
+    static Task* popInbox(std::atomic<Task*>& inbox);
+    static void clearInbox(std::atomic<Task*>& inbox); //releases and terminates the tasks
+    
+    static void hold(Task::Ptr task); //the queue takes over the reference of the caller
+    static Task::Ptr release(Task& task); //hands the reference of the queue back to the caller
+    
+    bool advance();
+    size_t selectLevel();
+    void insertTask(Task& task);
+    void drainInbox();
+    void drainWakeInbox();
+    void drainMigrationInbox();
+    bool isInboxEmpty() const;
+    void park();
+    void doUnpark(Task& task);
+    void waitForWork();
+    bool spinForWork();
+    bool hasWork() const;
+    void notifyIfSleeping();
+    void processTimers();
+    void doEnqueue(Task& task);
     ITask::Ptr doDequeue(std::atomic_bool& hint);
+    void notifyIfDrained(); //wakes up the blocked posters once the queue has drained down to its low watermark
+    bool trySteal();
+    Task* releaseStealableTask(); //the task keeps its reference, which the thief takes over
+    TaskQueue* selectMigrationTarget(size_t& load, size_t& targetLoad) const;
+    void migrate(Task& task, TaskQueue& target);
+    void recordSlice(std::chrono::nanoseconds sliceTime, int queueId);
+    void recordStart(Task& task);
+    void recordCompletion(Task& task);
+    void releaseTasks();
+    bool runSlice(); //returns false if no coroutine could run
+    void count(std::atomic<size_t> SchedulerCounters::* counter);
     
+    //read-mostly: set before the thread starts
     std::shared_ptr<std::thread>        _thread;
-    TaskList                            _queue;
-    TaskListIter                        _queueIt;
-    mutable SpinLock                    _spinlock;
+    size_t                              _starvationLimit; //max slices a runnable level can be skipped
+    bool                                _isResumeSignalledFirst; //signalled tasks run next
+    bool                                _isWorkStealingEnabled;
+    std::chrono::milliseconds           _workStealingPollIntervalMs;
+    bool                                _isMigrationEnabled; //hand tasks over to less loaded siblings
+    Configuration::IdlePolicy           _idlePolicy;
+    std::chrono::microseconds           _idleSpinTimeUs;
+    bool                                _isSliceTimingEnabled; //time every coroutine resume
+    bool                                _isLatencyTimingEnabled; //timestamp every task posted and completed
+    bool                                _isWatchdogEnabled; //publish the slice start and park times
+    bool                                _isProfilingEnabled; //publish the label of the running coroutine
+    bool                                _isPerfCountingEnabled; //count hardware events of the queue thread
+    bool                                _isAbandonOnTerminate; //the thread releases its own tasks when interrupted
+    std::chrono::microseconds           _longSliceThresholdUs;
+    Configuration::LongSliceCallback    _longSliceCallback;
+    std::atomic<std::vector<TaskQueue>*> _siblingQueues;
+    int                                 _numaNode; //work stealing prefers siblings on the same node
+    TaskCounter*                        _taskCounter; //shared by all the queues of the dispatcher
+    int                                 _coreId; //applied when the thread starts, -1 if not pinned
+    size_t                              _highWatermark; //0 if the queue has no watermarks
+    size_t                              _lowWatermark;
+    char                                _configPadding[cacheLineSize];
+    //written by the posting threads
+    std::atomic<Task*>                  _inbox; //tasks posted but not yet moved into the run lists
+    std::atomic<size_t>                 _inboxSize; //posted and migrated tasks
+    std::atomic<Task*>                  _wakeInbox; //parked tasks which have been signalled
+    std::atomic<Task*>                  _migrationInbox; //tasks handed over by overloaded siblings
     std::mutex                          _notEmptyMutex; //for accessing the condition variable
     std::condition_variable             _notEmptyCond;
     std::atomic_bool                    _isEmpty;
-    std::atomic_bool                    _isInterrupted;
+    std::atomic_bool                    _isSleeping; //thread is blocked on _notEmptyCond
     std::atomic_bool                    _isIdle;
+    std::atomic_bool                    _isSaturated; //reached the high watermark and not yet drained down to the low one
+    std::atomic_bool                    _isStarted; //has a thread of its own. Otherwise driven by runOnce().
+    std::atomic_bool                    _isInterrupted;
     std::atomic_flag                    _terminated;
-    bool                                _isAdvanced;
-    QueueStatistics                     _stats;
+    QueueStatistics                     _stats; //padded between its posting and queue thread counters
+    //owned by the queue thread, shared with stealing siblings under the spinlock
+    mutable SpinLock                    _spinlock;
+    RunLists                            _runLists; //one per priority level, highest first
+    size_t                              _level; //priority level of the current task
+    bool                                _hasCurrent; //the iterator of the current level points to the running task
+    TaskList                            _waitSet; //parked tasks which are blocked
+    std::atomic<size_t>                 _numBlocked; //size of the wait set, readable without the spinlock
+    TimerQueue                          _timers; //only accessed by the running thread
+    bool                                _isNewRound; //a run list iterator wrapped around
+    std::atomic<Task::TimePoint::rep>   _sliceStartTime; //0 between coroutines
+    std::atomic<const char*>            _runningLabel; //null between coroutines
+    PerfCounters                        _perfCounters;
+    std::atomic<SchedulerCounters*>     _schedulerCounters; //null unless simulated
+    char                                _threadPadding[cacheLineSize]; //keeps the next queue off the last cache line
 };
 
 }}
@@ -39,6 +39,17 @@ struct ThreadTraits
         static std::chrono::milliseconds value(0);
         return value;
     }
+    
+    /// @brief Dictates how many times a thread polls a wait condition (e.g. a future becoming ready)
+    ///        before blocking in the operating system.
+    /// @return The modifiable number of polling iterations.
+    /// @note: Spinning briefly saves the cost of sleeping and waking up the thread when the wait is
+    ///        expected to be very short. Each iteration issues a single CPU relax hint. Default is 0.
+    static unsigned& blockingSpinCount()
+    {
+        static unsigned value(0);
+        return value;
+    }
 };
 
 }
@@ -0,0 +1,82 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_TICKET_SPINLOCK_H
+#define QUANTUM_TICKET_SPINLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <quantum/quantum_spinlock.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                 class TicketSpinLock
+//==============================================================================================
+/// @class TicketSpinLock
+/// @brief Fair coroutine-compatible spinlock.
+/// @details Lockers take a ticket and are served in the order they arrived, so no waiter
+///          can be starved under heavy contention. The trade-off is that a waiter which is
+///          descheduled delays everyone queued behind it. Prefer SpinLock unless fairness matters.
+class TicketSpinLock
+{
+public:
+    /// @brief Constructor. The object is in the unlocked state.
+    TicketSpinLock();
+    
+    TicketSpinLock(const TicketSpinLock&) = delete;
+    TicketSpinLock& operator=(const TicketSpinLock&) = delete;
+    
+    /// @brief Locks this object.
+    /// @note Blocks the current thread until all earlier lockers have released the lock.
+    void lock();
+    
+    /// @brief Attempt to acquire the lock.
+    /// @return True if successful, false otherwise.
+    /// @note This function never blocks.
+    bool tryLock();
+    
+    /// @brief Unlocks the current object.
+    /// @note Never blocks.
+    void unlock();
+    
+    //==============================================================================================
+    //                                      class TicketSpinLock::Guard
+    //==============================================================================================
+    /// @class TicketSpinLock::Guard
+    /// @brief RAII-style mechanism which acquires the lock on construction and releases it inside the destructor.
+    class Guard
+    {
+    public:
+        /// @brief Construct this object and lock the passed-in spinlock.
+        explicit Guard(TicketSpinLock& lock);
+        
+        /// @brief Destroy this object and unlock the underlying spinlock.
+        ~Guard();
+    private:
+        TicketSpinLock&     _spinlock;
+    };
+    
+private:
+    std::atomic<uint32_t>   _next; //next ticket to hand out
+    std::atomic<uint32_t>   _serving; //ticket currently holding the lock
+};
+
+}}
+
+#include <quantum/impl/quantum_ticket_spinlock_impl.h>
+
+#endif //QUANTUM_TICKET_SPINLOCK_H
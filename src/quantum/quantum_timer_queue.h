@@ -0,0 +1,103 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_TIMER_QUEUE_H
+#define QUANTUM_TIMER_QUEUE_H
+
+#include <queue>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <quantum/interface/quantum_iterminate.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                 class TimerQueue
+//==============================================================================================
+/// @class TimerQueue
+/// @brief Runs callbacks at a given time, optionally repeating them at a fixed rate. Used to post
+///        delayed and periodic tasks without keeping a sleeping coroutine around until they are due.
+/// @note For internal use only. The timer thread is only started when the first timer is added.
+class TimerQueue : public ITerminate
+{
+public:
+    using Callback = std::function<void()>;
+    using TimePoint = std::chrono::steady_clock::time_point;
+    using Duration = std::chrono::steady_clock::duration;
+
+    TimerQueue();
+
+    TimerQueue(const TimerQueue&) = delete;
+
+    TimerQueue& operator=(const TimerQueue&) = delete;
+
+    ~TimerQueue();
+
+    void terminate() final;
+
+    /// @brief Schedule a callback.
+    /// @param[in] time Time when the callback runs first.
+    /// @param[in] period If non-zero, the callback runs again every 'period' after 'time' until cancelled.
+    /// @param[in] callback The callback. Runs on the timer thread and should return quickly.
+    /// @return A timer id which can be passed to cancel().
+    size_t add(TimePoint time, Duration period, Callback callback);
+
+    /// @brief Cancel a timer.
+    /// @return True if the timer was pending, false if it has already run or was cancelled.
+    bool cancel(size_t timerId);
+
+    /// @brief Number of pending timers.
+    size_t size() const;
+
+private:
+    struct Timer
+    {
+        bool operator>(const Timer& other) const { return _time > other._time; }
+
+        TimePoint   _time;
+        size_t      _timerId;
+    };
+    struct Entry
+    {
+        std::shared_ptr<Callback>   _callback;
+        Duration                    _period;
+    };
+
+    void run();
+
+    //Members
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> _timers; //earliest first
+    std::unordered_map<size_t, Entry>   _entries; //pending timers by id. Cancelled ones are removed from here only.
+    mutable std::mutex                  _mutex;
+    std::condition_variable             _cond;
+    std::shared_ptr<std::thread>        _thread;
+    size_t                              _nextTimerId;
+    bool                                _isInterrupted;
+    std::atomic_flag                    _terminated;
+};
+
+}}
+
+#include <quantum/impl/quantum_timer_queue_impl.h>
+
+#endif //QUANTUM_TIMER_QUEUE_H
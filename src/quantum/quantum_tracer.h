@@ -0,0 +1,132 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_TRACER_H
+#define QUANTUM_TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                      class Tracer
+//==============================================================================================
+/// @class Tracer.
+/// @brief Records the lifecycle of coroutines and IO tasks for offline inspection.
+/// @details When started, the coroutine and IO queues record an event each time a task is posted, starts
+///          or resumes running, yields, blocks, completes and each time an IO task starts and ends. Events
+///          are appended to a ring buffer owned by the recording thread without any locking, so that only
+///          the most recent events of each thread are kept. The trace can be exported in the Chrome trace
+///          event JSON format which can be opened with chrome://tracing or the Perfetto UI.
+///          When stopped, each hook costs a single relaxed atomic load. Define __QUANTUM_DISABLE_TRACING
+///          to compile the hooks out entirely.
+/// @note The tracer is shared by all the dispatchers in the process.
+class Tracer
+{
+public:
+    enum class EventType : uint8_t
+    {
+        Post,       ///< A coroutine was posted to a queue.
+        FirstRun,   ///< A coroutine runs for the first time.
+        Resume,     ///< A coroutine resumes after having yielded or blocked.
+        Yield,      ///< A coroutine yielded.
+        Block,      ///< A coroutine yielded to wait on a signal (future, mutex, etc.)
+        Complete,   ///< A coroutine completed.
+        IoPost,     ///< An IO task was posted to a queue.
+        IoStart,    ///< An IO task starts running.
+        IoEnd       ///< An IO task completed.
+    };
+    
+    struct Event
+    {
+        std::chrono::nanoseconds    _time;      //since the tracer was started
+        const void*                 _task;      //identifies the task
+        int                         _queueId;
+        uint32_t                    _threadId;  //index of the recording thread, in order of first event
+        EventType                   _type;
+    };
+    
+    /// @brief Get the process-wide tracer.
+    static Tracer& instance();
+    
+    /// @brief Start recording. Events recorded before are discarded.
+    /// @param[in] eventsPerThread Capacity of the ring buffer of each recording thread.
+    void start(size_t eventsPerThread = 65536);
+    
+    /// @brief Stop recording. The events recorded so far are kept until the next start().
+    void stop();
+    
+    /// @brief Check if the tracer is recording.
+    bool isStarted() const;
+    
+    /// @brief Record an event if the tracer is started.
+    /// @note Called by the queues. Does nothing if __QUANTUM_DISABLE_TRACING is defined.
+    static void record(EventType type, int queueId, const void* task);
+    
+    /// @brief Get a snapshot of the recorded events of all the threads, ordered by time.
+    /// @note Should be called after stop() for a consistent snapshot.
+    std::vector<Event> events() const;
+    
+    /// @brief Number of events which were overwritten because a ring buffer was full.
+    size_t numDroppedEvents() const;
+    
+    /// @brief Write the recorded events in the Chrome trace event JSON format.
+    /// @details Each recording thread appears as a track. Coroutine time slices and IO task runs are
+    ///          shown as durations and posts as instant events. The task address and queue id are
+    ///          attached as arguments.
+    /// @param[in,out] out Output stream.
+    /// @note Should be called after stop() for a consistent trace.
+    void exportChromeTrace(std::ostream& out) const;
+    
+    /// @brief Get the name of an event type.
+    static const char* toString(EventType type);
+    
+private:
+    struct Buffer
+    {
+        Buffer(size_t capacity, size_t generation, uint32_t threadId);
+        
+        std::vector<Event>  _events;
+        std::atomic<size_t> _head; //total number of events recorded
+        size_t              _generation;
+        uint32_t            _threadId;
+    };
+    using BufferPtr = std::shared_ptr<Buffer>;
+    
+    Tracer();
+    void append(EventType type, int queueId, const void* task);
+    BufferPtr addBuffer(size_t generation);
+    
+    //Members
+    std::atomic_bool                        _isStarted;
+    std::atomic<size_t>                     _generation; //incremented on start() to retire the thread buffers
+    std::atomic<int64_t>                    _epochNs; //steady clock time of start()
+    size_t                                  _capacity;
+    mutable std::mutex                      _mutex; //protects the capacity and the buffer registry
+    std::vector<BufferPtr>                  _buffers;
+};
+
+}}
+
+#include <quantum/impl/quantum_tracer_impl.h>
+
+#endif //QUANTUM_TRACER_H
@@ -61,6 +61,11 @@ struct Traits
     template <class IT>
     using IsInputIterator = std::enable_if_t<std::is_convertible<typename std::iterator_traits<IT>::iterator_category, std::input_iterator_tag>::value>;
     
+    //Selects the overloads taking a callable by its own type unless the callable is already the
+    //std::function taken by the other overloads
+    template <class FUNC, class STD_FUNC>
+    using IsNotStdFunction = std::enable_if_t<!std::is_same<std::decay_t<FUNC>, STD_FUNC>::value>;
+    
     //FUTURE BUFFER TRAIT
     template <class T>
     struct IsBuffer : std::false_type
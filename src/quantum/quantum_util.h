@@ -21,13 +21,20 @@
 #include <utility>
 #include <iostream>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <iterator>
+#include <algorithm>
+#include <chrono>
+#include <atomic>
 #include <quantum/quantum_traits.h>
 #include <quantum/interface/quantum_itask.h>
 #include <quantum/interface/quantum_icontext.h>
 #include <quantum/interface/quantum_ipromise.h>
 #include <quantum/quantum_capture.h>
+#include <quantum/quantum_grain_size.h>
+#include <quantum/quantum_latch.h>
+#include <quantum/quantum_span.h>
 
 namespace Bloomberg {
 namespace quantum {
@@ -52,6 +59,22 @@ struct Util
     static Function<int()>
     bindIoCaller(std::shared_ptr<Promise<RET>> promise, FUNC&& func0, ARGS&& ...args0);
     
+    //Binds an IO function without a promise. Its exceptions go to DISPATCHER::onDetachedError().
+    template<class DISPATCHER, class FUNC, class ...ARGS>
+    static Function<int()>
+    bindDetachedIoCaller(DISPATCHER& dispatcher, FUNC&& func0, ARGS&& ...args0);
+    
+    //Holds a copy of the user function and its arguments until the coroutine is created on a timer.
+    //Invoked with the context of the coroutine.
+    template<class FUNC, class ...ARGS>
+    using TimerCaller = decltype(std::bind(std::declval<typename std::decay<FUNC>::type>(),
+                                           std::placeholders::_1,
+                                           std::declval<typename std::decay<ARGS>::type>()...));
+    
+    template<class FUNC, class ...ARGS>
+    static std::shared_ptr<TimerCaller<FUNC, ARGS...>>
+    bindTimerCaller(FUNC&& func0, ARGS&& ...args0);
+    
     //------------------------------------------------------------------------------------------
     //                                      ForEach
     //------------------------------------------------------------------------------------------
@@ -61,13 +84,79 @@ struct Util
                            size_t num,
                            const Functions::ForEachFunc<RET, INPUT_IT>& func);
     
-    template <class RET, class INPUT_IT>
+    template <class RET, class INPUT_IT, class FUNC = Functions::ForEachFunc<RET, INPUT_IT>>
     static int forEachBatchCoro(CoroContextPtr<std::vector<std::vector<RET>>> ctx,
                                 INPUT_IT inputIt,
                                 size_t num,
-                                const Functions::ForEachFunc<RET, INPUT_IT>& func,
+                                const FUNC& func,
                                 size_t numCoroutineThreads);
     
+    template <class RET, class INPUT_IT, class FUNC = Functions::ForEachFunc<RET, INPUT_IT>>
+    static int forEachChunkCoro(CoroContextPtr<std::vector<RET>> ctx,
+                                INPUT_IT inputIt,
+                                size_t num,
+                                const FUNC& func,
+                                GrainSize grain,
+                                size_t numCoroutineThreads);
+    
+    template <class RET, class INPUT_IT, class FUNC = Functions::ForEachFunc<RET, INPUT_IT>>
+    static int forEachBatchDynamicCoro(CoroContextPtr<std::vector<std::vector<RET>>> ctx,
+                                       INPUT_IT inputIt,
+                                       size_t num,
+                                       const FUNC& func,
+                                       GrainSize grain,
+                                       size_t numCoroutineThreads);
+    
+    template <class RET, class INPUT_IT, class OUTPUT_IT, class FUNC = Functions::ForEachFunc<RET, INPUT_IT>>
+    static int forEachIntoCoro(CoroContextPtr<int> ctx,
+                               INPUT_IT inputIt,
+                               size_t num,
+                               OUTPUT_IT outputIt,
+                               const FUNC& func,
+                               size_t numCoroutineThreads);
+    
+    template <class INPUT_TYPE, class OUTPUT_TYPE, class KERNEL>
+    static int forEachKernelCoro(CoroContextPtr<int> ctx,
+                                 const INPUT_TYPE* input,
+                                 size_t num,
+                                 OUTPUT_TYPE* output,
+                                 const KERNEL& kernel,
+                                 size_t numCoroutineThreads);
+    
+    template <class INPUT_TYPE, class OUTPUT_TYPE, class KERNEL>
+    static int forEachKernelIntoVectorCoro(CoroContextPtr<std::vector<OUTPUT_TYPE>> ctx,
+                                           const INPUT_TYPE* input,
+                                           size_t num,
+                                           const KERNEL& kernel,
+                                           size_t numCoroutineThreads);
+    
+    //Runs 'kernel' on a few chunks per thread and waits for all of them. Rethrows the first exception.
+    template <class CTX, class INPUT_TYPE, class OUTPUT_TYPE, class KERNEL>
+    static void runKernelChunks(const CTX& ctx,
+                                const INPUT_TYPE* input,
+                                size_t num,
+                                OUTPUT_TYPE* output,
+                                const KERNEL& kernel,
+                                size_t numCoroutineThreads);
+    
+    //Smallest number of elements of type T spanning a multiple of KernelAlignment bytes
+    template <class T>
+    static constexpr size_t kernelStep();
+    
+    static constexpr size_t KernelAlignment = 64; //bytes. A cache line, which covers the widest vector registers.
+    
+    //Runs the first elements of the range when the grain size is adaptive and returns the chunk size.
+    //The chunk size is capped so that the remaining elements form at least 'minNumChunks' chunks.
+    template <class RET, class INPUT_IT, class FUNC>
+    static size_t probeGrainSize(std::vector<RET>& probed,
+                                 INPUT_IT& inputIt,
+                                 size_t num,
+                                 const FUNC& func,
+                                 GrainSize grain,
+                                 size_t minNumChunks);
+    
+    static constexpr size_t BatchChunksPerThread = 4;
+    
     //------------------------------------------------------------------------------------------
     //                                      MapReduce
     //------------------------------------------------------------------------------------------
@@ -84,12 +173,105 @@ struct Util
     template <class KEY,
               class MAPPED_TYPE,
               class REDUCED_TYPE,
-              class INPUT_IT>
+              class INPUT_IT,
+              class MAPPER = Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>,
+              class REDUCER = Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>>
     static int mapReduceBatchCoro(CoroContextPtr<std::map<KEY, REDUCED_TYPE>> ctx,
                                   INPUT_IT inputIt,
                                   size_t num,
-                                  const Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>& mapper,
-                                  const Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>& reducer);
+                                  const MAPPER& mapper,
+                                  const REDUCER& reducer);
+    
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class OUTPUT,
+              class INPUT_IT>
+    static int mapReducePartitionedCoro(CoroContextPtr<OUTPUT> ctx,
+                                        INPUT_IT inputIt,
+                                        size_t num,
+                                        const Functions::MapFunc<KEY, MAPPED_TYPE, INPUT_IT>& mapper,
+                                        const Functions::CombineFunc<MAPPED_TYPE>& combiner,
+                                        const Functions::ReduceFunc<KEY, MAPPED_TYPE, REDUCED_TYPE>& reducer,
+                                        size_t numPartitions);
+    
+    template <class KEY,
+              class MAPPED_TYPE,
+              class REDUCED_TYPE,
+              class OUTPUT,
+              class INPUT>
+    static int mapReduceStreamCoro(CoroContextPtr<Buffer<OUTPUT>> ctx,
+                                   CoroFuturePtr<Buffer<INPUT>> input,
+                                   const Functions::StreamMapFunc<KEY, MAPPED_TYPE, INPUT>& mapper,
+                                   const Functions::FoldFunc<REDUCED_TYPE, MAPPED_TYPE>& reducer,
+                                   size_t windowSize);
+    
+    static constexpr size_t StreamPullSize = 256;
+    
+    //------------------------------------------------------------------------------------------
+    //                                      Reduce and Scan
+    //------------------------------------------------------------------------------------------
+    struct IdentityTransform
+    {
+        template <class T>
+        const T& operator()(const T& value) const { return value; }
+    };
+    
+    template <class RET, class INPUT_IT, class TRANSFORM>
+    static int transformReduceCoro(CoroContextPtr<RET> ctx,
+                                   INPUT_IT inputIt,
+                                   size_t num,
+                                   RET init,
+                                   const Functions::BinaryFunc<RET>& reduceOp,
+                                   const TRANSFORM& transform,
+                                   size_t numCoroutineThreads);
+    
+    template <class RET, class INPUT_IT>
+    static int scanCoro(CoroContextPtr<std::vector<RET>> ctx,
+                        INPUT_IT inputIt,
+                        size_t num,
+                        bool isInclusive,
+                        RET init,
+                        const Functions::BinaryFunc<RET>& op,
+                        size_t numCoroutineThreads);
+    
+    //------------------------------------------------------------------------------------------
+    //                                      Sort
+    //------------------------------------------------------------------------------------------
+    template <class RANDOM_IT, class COMPARE>
+    static int sortCoro(CoroContextPtr<int> ctx,
+                        RANDOM_IT first,
+                        RANDOM_IT last,
+                        const COMPARE& compare,
+                        bool isStable,
+                        size_t numCoroutineThreads);
+    
+    static constexpr size_t MinSortSliceSize = 1024; //smaller ranges are not worth splitting
+    
+    //Splits [inputIt, inputIt+num) into at most 'numSlices' contiguous slices of near equal size
+    template <class INPUT_IT>
+    static std::vector<std::pair<INPUT_IT, size_t>> sliceRange(INPUT_IT inputIt, size_t num, size_t numSlices);
+    
+    //Folds a slice from left to right, starting with its first element
+    template <class RET, class INPUT_IT, class TRANSFORM>
+    static RET reduceSlice(INPUT_IT inputIt,
+                           size_t num,
+                           const Functions::BinaryFunc<RET>& reduceOp,
+                           const TRANSFORM& transform);
+    
+    //Combines adjacent values pairwise until one is left. The order of the operands is preserved.
+    template <class RET>
+    static RET treeCombine(std::vector<RET>&& values, const Functions::BinaryFunc<RET>& op);
+    
+    //------------------------------------------------------------------------------------------
+    //                                      MapReduce helpers
+    //------------------------------------------------------------------------------------------
+    //Inserts a reduced value into an associative container or appends it to a vector
+    template <class OUTPUT, class KEY, class REDUCED_TYPE>
+    static void emplaceReduced(OUTPUT& output, std::pair<KEY, REDUCED_TYPE>&& reduced);
+    
+    template <class KEY, class REDUCED_TYPE, class ALLOC>
+    static void emplaceReduced(std::vector<std::pair<KEY, REDUCED_TYPE>, ALLOC>& output, std::pair<KEY, REDUCED_TYPE>&& reduced);
     
 #ifdef __QUANTUM_PRINT_DEBUG
     //Synchronize logging
@@ -0,0 +1,84 @@
+/*
+** Copyright 2018 Bloomberg Finance L.P.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#ifndef QUANTUM_WHEN_H
+#define QUANTUM_WHEN_H
+
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <quantum/quantum_promise.h>
+#include <quantum/interface/quantum_ifuture_callback.h>
+
+namespace Bloomberg {
+namespace quantum {
+
+//==============================================================================================
+//                                    class WhenCallback
+//==============================================================================================
+/// @class WhenCallback
+/// @brief Completion callback shared by a group of futures. Sets its own promise once 'numRequired'
+///        of them are ready.
+/// @tparam RET The result type: int (all), size_t (index of the first ready future) or
+///         std::vector<size_t> (indexes of the first N ready futures, in completion order).
+/// @note For internal use only.
+template <class RET>
+class WhenCallback : public IFutureCallback
+{
+public:
+    WhenCallback(size_t numRequired, bool recordIndexes);
+    
+    FuturePtr<RET> getFuture() const;
+    
+    void onReady(size_t index) final;
+    
+private:
+    void setResult();
+    
+    // ============================= MEMBERS ==============================
+    Promise<RET>            _promise;
+    const size_t            _numRequired;
+    std::atomic_size_t      _numReady; //futures ready so far
+    std::atomic_size_t      _numRecorded; //futures ready whose index has been recorded
+    std::vector<size_t>     _indexes;
+};
+
+/// @brief Returns a future which becomes ready once all the futures are ready.
+/// @param[in] futures Futures to wait on. Can be any mix of thread and coroutine futures of a given type.
+/// @return A future holding 0. The values must be read from the original futures.
+/// @note No coroutine is posted to wait on the futures. A future is ready once it holds a value or
+///       an exception or when its promise is broken. Buffered futures are not supported.
+template <class FUTURE>
+FuturePtr<int> whenAll(const std::vector<FUTURE>& futures);
+
+/// @brief Returns a future which becomes ready once any of the futures is ready.
+/// @param[in] futures Futures to wait on.
+/// @return A future holding the index of the first ready future. The promise is broken if 'futures' is empty.
+template <class FUTURE>
+FuturePtr<size_t> whenAny(const std::vector<FUTURE>& futures);
+
+/// @brief Returns a future which becomes ready once 'num' of the futures are ready.
+/// @param[in] futures Futures to wait on.
+/// @param[in] num Number of futures to wait for. Must not exceed the number of futures.
+/// @return A future holding the indexes of the first 'num' ready futures, in completion order.
+template <class FUTURE>
+FuturePtr<std::vector<size_t>> whenN(const std::vector<FUTURE>& futures, size_t num);
+
+}}
+
+#include <quantum/impl/quantum_when_impl.h>
+
+#endif //QUANTUM_WHEN_H
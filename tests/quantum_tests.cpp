@@ -21,6 +21,10 @@
 #include <map>
 #include <unordered_map>
 #include <list>
+#include <numeric>
+#include <random>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace quantum;
 using ms = std::chrono::milliseconds;
@@ -320,6 +324,74 @@ TEST(ParamtersTest, CheckParameterPassingInCoroutines)
     EXPECT_DOUBLE_EQ(6.543, dbl);
 }
 
+TEST(ParamtersTest, ConfigurationJson)
+{
+    Configuration config = Configuration::fromJson(R"JSON(
+    {
+        "numCoroutineThreads": 3,
+        "maxNumIoThreads": 8,
+        "ioThreadIdleTimeoutMs": 250,
+        "coroutineCpuSets": [[0, 1], [2, 3]],
+        "idlePolicy": "spinThenPark",
+        "idleSpinTimeUs": 50,
+        "coroutineQueueSelectionPolicy": "powerOfTwo",
+        "resumeSignalledCoroutinesFirst": false,
+        "poolAllocSizes": { "task": 2048, "coroStack": 64 },
+        "poolWarmupCpuSet": [4],
+        "queueHighWatermark": 1000,
+        "admissionPolicy": "block"
+    })JSON");
+    EXPECT_EQ(3, config.getNumCoroutineThreads());
+    EXPECT_EQ(5, config.getNumIoThreads()); //default
+    EXPECT_EQ(8, config.getMaxNumIoThreads());
+    EXPECT_EQ(std::chrono::milliseconds(250), config.getIoThreadIdleTimeoutMs());
+    ASSERT_EQ(2u, config.getCoroutineCpuSets().size());
+    EXPECT_EQ((Configuration::CpuSet{2, 3}), config.getCoroutineCpuSets()[1]);
+    EXPECT_EQ(Configuration::IdlePolicy::SpinThenPark, config.getIdlePolicy());
+    EXPECT_EQ(std::chrono::microseconds(50), config.getIdleSpinTimeUs());
+    EXPECT_EQ(Configuration::QueueSelectionPolicy::PowerOfTwo, config.getCoroutineQueueSelectionPolicy());
+    EXPECT_FALSE(config.getResumeSignalledCoroutinesFirst());
+    EXPECT_EQ(2048u, config.getPoolAllocSize(Configuration::PoolType::Task));
+    EXPECT_EQ(64u, config.getPoolAllocSize(Configuration::PoolType::CoroStack));
+    EXPECT_EQ(0u, config.getPoolAllocSize(Configuration::PoolType::Future));
+    EXPECT_EQ((Configuration::CpuSet{4}), config.getPoolWarmupCpuSet());
+    EXPECT_EQ(1000u, config.getQueueHighWatermark());
+    EXPECT_EQ(Configuration::AdmissionPolicy::Block, config.getAdmissionPolicy());
+    
+    //round trip, and every setting written is published in the schema
+    std::string json = config.toJson();
+    EXPECT_EQ(json, Configuration::fromJson(json).toJson());
+    EXPECT_EQ(Configuration().toJson(), Configuration::fromJson("{}").toJson());
+    size_t pos = 0;
+    while ((pos = json.find("\n    \"", pos)) != std::string::npos)
+    {
+        pos += 6;
+        std::string key = json.substr(pos, json.find('"', pos) - pos);
+        EXPECT_NE(std::string::npos, Configuration::getJsonSchema().find("\"" + key + "\": {")) << key;
+    }
+    
+    //errors name the offending setting
+    auto error = [](const char* json)->std::string
+    {
+        try
+        {
+            Configuration::fromJson(json);
+        }
+        catch (const std::runtime_error& ex)
+        {
+            return ex.what();
+        }
+        return "";
+    };
+    EXPECT_NE(std::string::npos, error(R"({"numThreads": 1})").find("'numThreads'"));
+    EXPECT_NE(std::string::npos, error(R"({"idlePolicy": "sleep"})").find("\"spinThenPark\""));
+    EXPECT_NE(std::string::npos, error(R"({"numIoThreads": 1.5})").find("'numIoThreads'"));
+    EXPECT_NE(std::string::npos, error(R"({"queueHighWatermark": -1})").find("negative"));
+    EXPECT_NE(std::string::npos, error(R"({"poolAllocSizes": {"stack": 1}})").find("'stack'"));
+    EXPECT_NE(std::string::npos, error(R"({"lazyThreadStart": true,})").find("offset 25"));
+    EXPECT_NE(std::string::npos, error("[]").find("object"));
+}
+
 TEST(ExecutionTest, DrainAllTasks)
 {
     //Turn the drain on and make sure we cannot queue any tasks
@@ -417,6 +489,62 @@ TEST(ExecutionTest, ChainCoroutinesFromCoroutineContext)
     EXPECT_EQ(validation, v);
 }
 
+TEST(ExecutionTest, LongChainAllocatesStacksLazily)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    Dispatcher dispatcher(config);
+    const int numStages = 20;
+    auto stage = [](CoroContext<int>::Ptr ctx)->int
+    {
+        return ctx->set(ctx->getPrevRef<int>() + 1);
+    };
+    size_t inUse = dispatcher.allocatorStats().coroStack().inUse();
+    auto ctx = dispatcher.postFirst([](CoroContext<int>::Ptr ctx)->int { return ctx->set(0); });
+    for (int i = 1; i < numStages; ++i)
+    {
+        ctx = ctx->then(stage);
+    }
+    //only the first stage holds a stack until the chain runs
+    EXPECT_EQ(inUse + 1, dispatcher.allocatorStats().coroStack().inUse());
+    ctx->end();
+    for (int i = 0; i < numStages - 1; ++i)
+    {
+        EXPECT_EQ(i, ctx->getRefAt<int>(i));
+    }
+    EXPECT_EQ(numStages - 1, ctx->get());
+    EXPECT_THROW(ctx->getAt<int>(numStages), FutureException);
+    dispatcher.drain();
+    EXPECT_EQ(inUse, dispatcher.allocatorStats().coroStack().inUse());
+}
+
+TEST(ExecutionTest, ChainIntermediateResults)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    auto ctx = dispatcher.postFirst([](CoroContext<int>::Ptr ctx)->int {
+        return ctx->set(7);
+    })->then<std::string>([](CoroContext<std::string>::Ptr ctx)->int {
+        return ctx->set(std::to_string(ctx->getPrevRef<int>()));
+    })->then<double>([](CoroContext<double>::Ptr ctx)->int {
+        return ctx->set(ctx->getPrevRef<std::string>().size() + 0.5);
+    });
+    for (int i = 0; i < 50; ++i)
+    {
+        ctx = ctx->then<double>([](CoroContext<double>::Ptr ctx)->int {
+            return ctx->set(ctx->getPrevRef<double>() + 1);
+        });
+    }
+    ctx->end();
+    EXPECT_EQ(7, ctx->getRefAt<int>(0));
+    EXPECT_EQ("7", ctx->getRefAt<std::string>(1));
+    EXPECT_DOUBLE_EQ(1.5, ctx->getRefAt<double>(2));
+    EXPECT_DOUBLE_EQ(51.5, ctx->getRef());
+    EXPECT_DOUBLE_EQ(51.5, ctx->getRefAt<double>(-1));
+    EXPECT_THROW(ctx->getRefAt<double>(-2), FutureException);
+    EXPECT_THROW(ctx->getRefAt<double>(53), FutureException);
+}
+
 TEST(ExecutionTest, OnErrorTaskRuns)
 {
     Dispatcher& dispatcher = DispatcherSingleton::instance();
@@ -476,12 +604,12 @@ TEST(ExecutionTest, FinallyAlwaysRuns)
 TEST(ExecutionTest, CoroutineSleep)
 {
     Dispatcher& dispatcher = DispatcherSingleton::instance();
+    auto start = std::chrono::high_resolution_clock::now();
     IThreadContext<int>::Ptr ctx = dispatcher.post([](ICoroContext<int>::Ptr ctx)->int{
         ctx->sleep(ms(100));
         return 0;
     });
     
-    auto start = std::chrono::high_resolution_clock::now();
     ctx->wait(); //block until value is available
     auto end = std::chrono::high_resolution_clock::now();
     
@@ -490,6 +618,2092 @@ TEST(ExecutionTest, CoroutineSleep)
     EXPECT_GE(elapsed, (size_t)100);
 }
 
+TEST(ExecutionTest, ManySleepingCoroutines)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    std::atomic_int count{0};
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 200; ++i)
+    {
+        dispatcher.post(0, false, [&count](ICoroContext<int>::Ptr ctx)->int{
+            ctx->sleep(ms(100));
+            ++count;
+            return 0;
+        });
+    }
+    dispatcher.drain();
+    auto end = std::chrono::steady_clock::now();
+    
+    EXPECT_EQ(200, count);
+    size_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
+    EXPECT_GE(elapsed, (size_t)100);
+}
+
+TEST(ExecutionTest, CoroutineWaitForTimeout)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    Mutex m;
+    ConditionVariable cv;
+    
+    //nobody signals the condition so the wait must expire
+    IThreadContext<int>::Ptr tctx = dispatcher.post([&](ICoroContext<int>::Ptr ctx)->int{
+        Mutex::Guard guard(ctx, m);
+        auto start = std::chrono::steady_clock::now();
+        bool signalled = cv.waitFor(ctx, m, ms(50));
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-start);
+        return ctx->set(signalled ? -1 : (int)elapsed.count());
+    });
+    EXPECT_GE(tctx->get(), 50);
+    
+    //a signalled wait returns before the timeout
+    IThreadContext<int>::Ptr tctx2 = dispatcher.post([&](ICoroContext<int>::Ptr ctx)->int{
+        Mutex::Guard guard(ctx, m);
+        return ctx->set(cv.waitFor(ctx, m, ms(5000)) ? 1 : 0);
+    });
+    std::this_thread::sleep_for(ms(50));
+    cv.notifyAll();
+    EXPECT_EQ(1, tctx2->get());
+}
+
+TEST(ExecutionTest, WorkStealing)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(4);
+    config.setNumIoThreads(1);
+    config.setCoroutineWorkStealing(true);
+    config.setCoroutineWorkStealingPollIntervalMs(ms(1));
+    Dispatcher dispatcher(config);
+    
+    auto blocker = [](CoroContext<int>::Ptr, int durationMs)->int {
+        std::this_thread::sleep_for(ms(durationMs)); //block the thread without yielding
+        return 0;
+    };
+    
+    //Queue 0 stays blocked well after the other queues become idle
+    dispatcher.post(0, false, blocker, 300);
+    for (int i = 1; i < 4; ++i)
+    {
+        dispatcher.post(i, false, blocker, 50);
+    }
+    //Spread evenly across all queues, including the one which is blocked
+    for (int i = 0; i < 8; ++i)
+    {
+        dispatcher.post(DummyCoro);
+    }
+    dispatcher.drain();
+    
+    EXPECT_LE((size_t)1, dispatcher.stats(IQueue::QueueType::Coro).stolenCount());
+    EXPECT_EQ((size_t)0, dispatcher.stats(IQueue::QueueType::Coro, 0).stolenCount());
+    EXPECT_EQ((size_t)12, dispatcher.stats(IQueue::QueueType::Coro).completedCount());
+    EXPECT_EQ((size_t)0, dispatcher.size());
+}
+
+TEST(ExecutionTest, IdlePolicies)
+{
+    for (auto policy : {Configuration::IdlePolicy::Spin, Configuration::IdlePolicy::SpinThenPark})
+    {
+        Configuration config;
+        config.setNumCoroutineThreads(2);
+        config.setNumIoThreads(2);
+        config.setIdlePolicy(policy);
+        config.setIdleSpinTimeUs(std::chrono::microseconds(50));
+        Dispatcher dispatcher(config);
+
+        for (int round = 0; round < 3; ++round)
+        {
+            std::vector<ThreadContext<int>::Ptr> coroFutures;
+            std::vector<ThreadFuture<int>::Ptr> ioFutures;
+            for (int i = 0; i < 20; ++i)
+            {
+                coroFutures.push_back(dispatcher.post([](CoroContext<int>::Ptr ctx)->int {
+                    ctx->sleep(ms(1));
+                    return ctx->set(1);
+                }));
+                ioFutures.push_back(dispatcher.postAsyncIo([](ThreadPromise<int>::Ptr promise)->int {
+                    return promise->set(2);
+                }));
+            }
+            int sum = 0;
+            for (auto&& f : coroFutures) sum += f->get();
+            for (auto&& f : ioFutures) sum += f->get();
+            EXPECT_EQ(60, sum);
+            //let the threads go idle (and park, depending on policy) before the next round
+            std::this_thread::sleep_for(ms(5));
+        }
+        dispatcher.drain();
+        EXPECT_EQ((size_t)0, dispatcher.size());
+    }
+}
+
+TEST(ExecutionTest, QueueSelectionPolicies)
+{
+    for (auto policy : {Configuration::QueueSelectionPolicy::RoundRobin,
+                        Configuration::QueueSelectionPolicy::PowerOfTwo,
+                        Configuration::QueueSelectionPolicy::Shortest})
+    {
+        Configuration config;
+        config.setNumCoroutineThreads(4);
+        config.setNumIoThreads(1);
+        config.setCoroutineQueueSelectionPolicy(policy);
+        Dispatcher dispatcher(config);
+        
+        for (int i = 0; i < 40; ++i)
+        {
+            dispatcher.post(DummyCoro);
+        }
+        dispatcher.drain();
+        
+        EXPECT_EQ((size_t)40, dispatcher.stats(IQueue::QueueType::Coro).completedCount());
+        if (policy == Configuration::QueueSelectionPolicy::RoundRobin)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                EXPECT_EQ((size_t)10, dispatcher.stats(IQueue::QueueType::Coro, i).postedCount());
+            }
+        }
+    }
+}
+
+TEST(ExecutionTest, PostBatch)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(4);
+    config.setNumIoThreads(1);
+    Dispatcher dispatcher(config);
+    
+    using Func = std::function<int(CoroContext<int>::Ptr)>;
+    std::vector<Func> funcs;
+    for (int i = 0; i < 100; ++i)
+    {
+        funcs.emplace_back([i](CoroContext<int>::Ptr ctx)->int { return ctx->set(i); });
+    }
+    std::vector<ThreadContext<int>::Ptr> contexts = dispatcher.postBatch(funcs.begin(), funcs.end());
+    ASSERT_EQ(funcs.size(), contexts.size());
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(i, contexts[i]->get()); //same order as the input
+    }
+    dispatcher.drain();
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_EQ((size_t)25, dispatcher.stats(IQueue::QueueType::Coro, i).postedCount()); //evenly spread
+    }
+    
+    //Post from within a coroutine onto the same queue
+    int sum = dispatcher.post([&funcs](CoroContext<int>::Ptr ctx)->int {
+        std::vector<CoroContext<int>::Ptr> children = ctx->postBatch((int)IQueue::QueueId::Same, false, funcs.begin(), funcs.end());
+        int total = 0;
+        for (auto&& child : children)
+        {
+            total += child->get(ctx);
+        }
+        return ctx->set(total);
+    })->get();
+    EXPECT_EQ(4950, sum);
+}
+
+TEST(ExecutionTest, PostAsyncIoBatch)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(4);
+    Dispatcher dispatcher(config);
+    
+    using Func = std::function<int(ThreadPromise<int>::Ptr)>;
+    std::vector<Func> funcs;
+    for (int i = 0; i < 100; ++i)
+    {
+        funcs.emplace_back([i](ThreadPromise<int>::Ptr promise)->int { return promise->set(i); });
+    }
+    std::vector<ThreadFuture<int>::Ptr> futures = dispatcher.postAsyncIoBatch(funcs.begin(), funcs.end());
+    ASSERT_EQ(funcs.size(), futures.size());
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(i, futures[i]->get()); //same order as the input
+    }
+    
+    //Target a single IO queue. The futures are read from this thread rather than joined on an IO
+    //thread, which could be the very thread that has to run the batch.
+    futures = dispatcher.postAsyncIoBatch(2, false, funcs.begin(), funcs.end());
+    ASSERT_EQ(funcs.size(), futures.size());
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(i, futures[i]->get()); //same order as the input
+    }
+    dispatcher.drain();
+    EXPECT_EQ((size_t)100, dispatcher.stats(IQueue::QueueType::IO, 2).postedCount());
+    
+    //Post from within a coroutine
+    int sum = dispatcher.post([&funcs](CoroContext<int>::Ptr ctx)->int {
+        std::vector<CoroFuture<int>::Ptr> children = ctx->postAsyncIoBatch(funcs.begin(), funcs.end());
+        int total = 0;
+        for (auto&& child : children)
+        {
+            total += child->get(ctx);
+        }
+        return ctx->set(total);
+    })->get();
+    EXPECT_EQ(4950, sum);
+}
+
+TEST(ExecutionTest, ResumeSignalledCoroutinesFirst)
+{
+    //Count the slices run by other coroutines between the IO completion and the resumption of the waiter
+    auto measure = [](bool resumeFirst)->int {
+        Configuration config;
+        config.setNumCoroutineThreads(1);
+        config.setNumIoThreads(1);
+        config.setResumeSignalledCoroutinesFirst(resumeFirst);
+        Dispatcher dispatcher(config);
+        
+        std::atomic_int numSlices{0};
+        std::atomic_bool done{false};
+        for (int i = 0; i < 20; ++i)
+        {
+            dispatcher.post([&numSlices, &done](CoroContext<int>::Ptr ctx)->int {
+                while (!done)
+                {
+                    std::this_thread::sleep_for(ms(1)); //busy slice
+                    ++numSlices;
+                    ctx->yield();
+                }
+                return 0;
+            });
+        }
+        int delta = dispatcher.post([&numSlices, &done](CoroContext<int>::Ptr ctx)->int {
+            int slicesAtCompletion = ctx->postAsyncIo([&numSlices](ThreadPromise<int>::Ptr promise)->int {
+                std::this_thread::sleep_for(ms(5));
+                return promise->set(numSlices.load());
+            })->get(ctx);
+            int result = numSlices - slicesAtCompletion;
+            done = true;
+            return ctx->set(result);
+        })->get();
+        dispatcher.drain();
+        return delta;
+    };
+    EXPECT_LE(measure(true), 2); //runs as soon as the current slice ends
+    EXPECT_GE(measure(false), 10); //waits for the end of the round
+}
+
+TEST(ExecutionTest, YieldTo)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    Dispatcher dispatcher(config);
+    enum { Yield, Partner, Other, Resumed };
+    std::vector<int> order; //only accessed from the single coroutine thread
+    dispatcher.post([&order](CoroContext<int>::Ptr ctx)->int {
+        auto spawn = [&](int id) {
+            return ctx->post<int>(0, false, [&order, id](CoroContext<int>::Ptr ctx)->int {
+                order.push_back(id);
+                return ctx->set(0);
+            });
+        };
+        for (int i = 0; i < 5; ++i)
+        {
+            spawn(Other);
+        }
+        auto partner = spawn(Partner);
+        order.push_back(Yield);
+        ctx->yieldTo(partner); //runs ahead of the coroutines posted before it
+        order.push_back(Resumed);
+        
+        //handing over to a coroutine which has completed is a plain yield
+        ctx->yieldTo(partner);
+        EXPECT_THROW(ctx->yieldTo(ctx), std::runtime_error);
+        return ctx->set(0);
+    });
+    dispatcher.drain();
+    ASSERT_EQ(8u, order.size());
+    EXPECT_EQ(Yield, order[0]);
+    EXPECT_EQ(Partner, order[1]);
+    EXPECT_EQ(Other, order[2]);
+    EXPECT_EQ(Resumed, order.back());
+}
+
+TEST(ExecutionTest, PriorityLevels)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    config.setPriorityStarvationLimit(0); //strict priorities
+    Dispatcher dispatcher(config);
+    
+    std::vector<std::string> order;
+    auto func = [&order](CoroContext<int>::Ptr, const char* name)->int {
+        order.push_back(name); //all coroutines run on the same thread
+        return 0;
+    };
+    //Block the queue while the other coroutines are being posted
+    dispatcher.post([](CoroContext<int>::Ptr)->int {
+        std::this_thread::sleep_for(ms(100));
+        return 0;
+    });
+    std::this_thread::sleep_for(ms(20));
+    auto now = std::chrono::steady_clock::now();
+    dispatcher.post(0, IQueue::Priority::Low, func, "L1");
+    dispatcher.post(0, IQueue::Priority::Normal, func, "N1");
+    dispatcher.post(0, IQueue::Priority::Normal, now + ms(200), func, "D2");
+    dispatcher.post(0, true, func, "H1");
+    dispatcher.post(0, IQueue::Priority::Low, func, "L2");
+    dispatcher.post(0, IQueue::Priority::Critical, func, "C1");
+    dispatcher.post(0, IQueue::Priority::Normal, now + ms(100), func, "D1");
+    dispatcher.post(0, IQueue::Priority::High, func, "H2");
+    dispatcher.post(0, IQueue::Priority::Low, func, "L3");
+    dispatcher.drain();
+    
+    std::vector<std::string> expected{"C1", "H1", "H2", "D1", "D2", "N1", "L1", "L2", "L3"};
+    EXPECT_EQ(expected, order);
+}
+
+TEST(ExecutionTest, PriorityStarvationProtection)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    config.setPriorityStarvationLimit(2);
+    Dispatcher dispatcher(config);
+    
+    std::vector<std::string> order;
+    auto func = [&order](CoroContext<int>::Ptr, const char* name)->int {
+        order.push_back(name);
+        return 0;
+    };
+    dispatcher.post([](CoroContext<int>::Ptr)->int {
+        std::this_thread::sleep_for(ms(100));
+        return 0;
+    });
+    std::this_thread::sleep_for(ms(20));
+    dispatcher.post(0, IQueue::Priority::Low, func, "L");
+    for (int i = 0; i < 6; ++i)
+    {
+        dispatcher.post(0, IQueue::Priority::High, func, "H");
+    }
+    dispatcher.drain();
+    
+    ASSERT_EQ((size_t)7, order.size());
+    EXPECT_EQ("L", order[2]); //skipped twice then served
+}
+
+TEST(ExecutionTest, LongSliceDetection)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    config.setLongSliceThresholdUs(std::chrono::microseconds(10000));
+    std::atomic_int numCallbacks{0};
+    std::atomic<long long> longestUs{0};
+    config.setLongSliceCallback([&](int queueId, std::chrono::microseconds sliceTime) {
+        EXPECT_EQ(0, queueId);
+        longestUs = sliceTime.count();
+        ++numCallbacks;
+    });
+    Dispatcher dispatcher(config);
+    
+    //well-behaved coroutine yielding often
+    dispatcher.post([](CoroContext<int>::Ptr ctx)->int {
+        for (int i = 0; i < 5; ++i)
+        {
+            ctx->yield();
+        }
+        return 0;
+    });
+    //coroutine hogging the thread without yielding
+    dispatcher.post([](CoroContext<int>::Ptr)->int {
+        std::this_thread::sleep_for(ms(30));
+        return 0;
+    });
+    dispatcher.drain();
+    
+    EXPECT_EQ(1, numCallbacks);
+    EXPECT_GE(longestUs, 30000);
+    QueueStatistics stats = dispatcher.stats(IQueue::QueueType::Coro, 0);
+    EXPECT_EQ((size_t)1, stats.longSliceCount());
+    EXPECT_GE(stats.sliceCount(), (size_t)7);
+    EXPECT_GE(stats.maxSliceTime(), ms(30));
+    size_t histogramTotal = 0;
+    for (size_t i = 0; i < IQueueStatistics::numSliceBuckets; ++i)
+    {
+        histogramTotal += stats.sliceHistogram(i);
+    }
+    EXPECT_EQ(stats.sliceCount(), histogramTotal);
+}
+
+TEST(ExecutionTest, LatencyStatistics)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    config.setLatencyStatistics(true);
+    Dispatcher dispatcher(config);
+    
+    //The first coroutine holds the thread so the others wait behind it
+    for (int i = 0; i < 10; ++i)
+    {
+        dispatcher.post([](CoroContext<int>::Ptr ctx)->int {
+            std::this_thread::sleep_for(ms(5));
+            return ctx->set(0);
+        });
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        dispatcher.postAsyncIo([](ThreadPromise<int>::Ptr promise)->int {
+            std::this_thread::sleep_for(ms(2));
+            return promise->set(0);
+        });
+    }
+    dispatcher.drain();
+    
+    QueueStatistics coroStats = dispatcher.stats(IQueue::QueueType::Coro);
+    EXPECT_EQ((size_t)10, coroStats.waitTimeHistogram().count());
+    EXPECT_EQ((size_t)10, coroStats.runTimeHistogram().count());
+    EXPECT_EQ((size_t)10, coroStats.endToEndTimeHistogram().count());
+    EXPECT_GE(coroStats.runTimeHistogram().percentile(50), ms(5));
+    EXPECT_GE(coroStats.waitTimeHistogram().max(), ms(40)); //the last coroutine waited for the 9 others
+    EXPECT_LE(coroStats.waitTimeHistogram().percentile(50), coroStats.waitTimeHistogram().percentile(99));
+    EXPECT_GE(coroStats.endToEndTimeHistogram().max(), ms(50));
+    
+    QueueStatistics ioStats = dispatcher.stats(IQueue::QueueType::IO);
+    EXPECT_EQ((size_t)10, ioStats.runTimeHistogram().count());
+    EXPECT_GE(ioStats.runTimeHistogram().percentile(1), ms(2));
+    EXPECT_GE(ioStats.endToEndTimeHistogram().percentile(99), ms(18));
+    
+    //Percentiles are reported within the resolution of a bucket
+    LatencyHistogram histogram;
+    for (int i = 1; i <= 1000; ++i)
+    {
+        histogram.add(std::chrono::microseconds(i));
+    }
+    auto p50 = std::chrono::duration_cast<std::chrono::microseconds>(histogram.percentile(50)).count();
+    auto p99 = std::chrono::duration_cast<std::chrono::microseconds>(histogram.percentile(99)).count();
+    EXPECT_GE(p50, 500);
+    EXPECT_LE(p50, 500*9/8);
+    EXPECT_GE(p99, 990);
+    EXPECT_LE(p99, 1000);
+    EXPECT_EQ(std::chrono::microseconds(1000), histogram.max());
+    
+    dispatcher.resetStats();
+    EXPECT_EQ((size_t)0, dispatcher.stats().waitTimeHistogram().count());
+}
+
+TEST(ExecutionTest, Tracing)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    Dispatcher dispatcher(config);
+    
+    Tracer& tracer = Tracer::instance();
+    tracer.start();
+    dispatcher.post([](CoroContext<int>::Ptr ctx)->int {
+        ctx->yield();
+        ctx->postAsyncIo([](ThreadPromise<int>::Ptr promise)->int {
+            std::this_thread::sleep_for(ms(10));
+            return promise->set(0);
+        })->get(ctx);
+        return ctx->set(0);
+    })->get();
+    dispatcher.drain();
+    tracer.stop();
+    
+    std::vector<Tracer::EventType> coroEvents;
+    std::vector<Tracer::EventType> ioEvents;
+    for (auto&& event : tracer.events())
+    {
+        switch (event._type)
+        {
+            case Tracer::EventType::IoPost:
+            case Tracer::EventType::IoStart:
+            case Tracer::EventType::IoEnd: ioEvents.push_back(event._type); break;
+            default: coroEvents.push_back(event._type); break;
+        }
+    }
+    std::vector<Tracer::EventType> expectedCoroEvents{Tracer::EventType::Post,
+                                                      Tracer::EventType::FirstRun,
+                                                      Tracer::EventType::Yield,
+                                                      Tracer::EventType::Resume,
+                                                      Tracer::EventType::Block,
+                                                      Tracer::EventType::Resume,
+                                                      Tracer::EventType::Complete};
+    std::vector<Tracer::EventType> expectedIoEvents{Tracer::EventType::IoPost,
+                                                    Tracer::EventType::IoStart,
+                                                    Tracer::EventType::IoEnd};
+    EXPECT_EQ(expectedCoroEvents, coroEvents);
+    EXPECT_EQ(expectedIoEvents, ioEvents);
+    EXPECT_EQ((size_t)0, tracer.numDroppedEvents());
+    
+    std::ostringstream trace;
+    tracer.exportChromeTrace(trace);
+    EXPECT_EQ(0u, trace.str().find("{\"traceEvents\":["));
+    EXPECT_NE(std::string::npos, trace.str().find("\"name\":\"coroutine\",\"ph\":\"B\""));
+    EXPECT_NE(std::string::npos, trace.str().find("\"name\":\"io task\",\"ph\":\"E\""));
+    EXPECT_NE(std::string::npos, trace.str().find("\"event\":\"block\""));
+    
+    //Nothing is recorded once stopped
+    dispatcher.post([](CoroContext<int>::Ptr ctx)->int { return ctx->set(0); })->get();
+    EXPECT_EQ(expectedCoroEvents.size() + expectedIoEvents.size(), tracer.events().size());
+}
+
+TEST(ExecutionTest, StallWatchdog)
+{
+    using StallType = Configuration::StallType;
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    config.setWatchdogIntervalMs(ms(10));
+    config.setQueueStallThresholdMs(ms(50));
+    config.setBlockedCoroutineThresholdMs(ms(50));
+    std::mutex mutex;
+    std::vector<Configuration::StallInfo> stalls;
+    config.setStallCallback([&](const Configuration::StallInfo& info) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stalls.push_back(info);
+    });
+    EXPECT_TRUE(config.isWatchdogEnabled());
+    Dispatcher dispatcher(config);
+    
+    //coroutine making a blocking call, IO task running long and coroutine waiting for a promise
+    Promise<int> promise;
+    dispatcher.post(0, false, [](CoroContext<int>::Ptr)->int {
+        std::this_thread::sleep_for(ms(200));
+        return 0;
+    });
+    dispatcher.postAsyncIo(0, false, [](ThreadPromise<int>::Ptr promise)->int {
+        std::this_thread::sleep_for(ms(200));
+        return promise->set(0);
+    });
+    dispatcher.post(1, false, [&](CoroContext<int>::Ptr ctx)->int {
+        return ctx->set(promise.getICoroFuture()->get(ctx));
+    });
+    //well-behaved coroutine yielding often
+    dispatcher.post(1, false, [](CoroContext<int>::Ptr ctx)->int {
+        for (int i = 0; i < 100; ++i)
+        {
+            ctx->sleep(ms(1));
+        }
+        return 0;
+    });
+    std::this_thread::sleep_for(ms(300));
+    promise.set(1);
+    dispatcher.drain();
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<StallType, int> numStalls;
+    for (auto&& stall : stalls)
+    {
+        ++numStalls[stall._type];
+        EXPECT_GE(stall._stallTime, ms(50));
+        EXPECT_LT(stall._stallTime, ms(200));
+        EXPECT_EQ(stall._type == StallType::BlockedCoroutine ? 1 : 0, stall._queueId);
+        EXPECT_EQ(stall._type == StallType::BlockedCoroutine, stall._task != nullptr);
+    }
+    //each stall is reported once
+    EXPECT_EQ(3u, stalls.size());
+    EXPECT_EQ(1, numStalls[StallType::CoroutineQueue]);
+    EXPECT_EQ(1, numStalls[StallType::IoQueue]);
+    EXPECT_EQ(1, numStalls[StallType::BlockedCoroutine]);
+}
+
+TEST(ExecutionTest, MetricsSnapshot)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(2);
+    config.setMetricsExportIntervalMs(ms(20));
+    std::mutex mutex;
+    std::vector<MetricsSnapshot> exported;
+    config.setMetricsExporter([&](const MetricsSnapshot& snapshot) {
+        std::lock_guard<std::mutex> lock(mutex);
+        exported.push_back(snapshot);
+    });
+    Dispatcher dispatcher(config);
+    MetricsSnapshot first = dispatcher.metrics();
+    EXPECT_EQ(2u, first.coroQueues().size());
+    EXPECT_EQ(2u, first.ioQueues().size());
+    EXPECT_EQ(0, first.interval().count());
+    
+    //blocked coroutines and queued tasks are visible while running
+    Promise<int> promise;
+    for (int i = 0; i < 3; ++i)
+    {
+        dispatcher.post(1, false, [&](CoroContext<int>::Ptr ctx)->int {
+            return ctx->set(promise.getICoroFuture()->get(ctx));
+        });
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        dispatcher.post(0, false, [](CoroContext<int>::Ptr)->int { return 0; });
+        dispatcher.postAsyncIo(1, false, [](ThreadPromise<int>::Ptr promise)->int { return promise->set(0); });
+        dispatcher.postAsyncIo([](ThreadPromise<int>::Ptr promise)->int { return promise->set(0); });
+    }
+    dispatcher.postAsyncIo([](ThreadPromise<int>::Ptr)->int { return -1; });
+    std::this_thread::sleep_for(ms(50));
+    MetricsSnapshot running = dispatcher.metrics();
+    EXPECT_EQ(3u, running.coroQueues()[1]._blocked);
+    EXPECT_EQ(3u, running.coroQueues()[1]._depth);
+    EXPECT_EQ(10u, running.coroQueues()[0]._completed);
+    EXPECT_EQ(0u, running.coroQueues()[0]._depth);
+    EXPECT_GT(running.interval(), ms(0));
+    EXPECT_GT(running.coroQueues()[0]._postedPerSec, 0);
+    promise.set(1);
+    dispatcher.drain();
+    
+    MetricsSnapshot done = dispatcher.metrics();
+    EXPECT_EQ(0u, done.coroQueues()[1]._blocked);
+    EXPECT_EQ(3u, done.coroQueues()[1]._completed);
+    EXPECT_EQ(10u, done.ioQueues()[1]._posted);
+    EXPECT_EQ(10u, done.ioQueues()[1]._completed);
+    EXPECT_EQ(0u, done.ioQueues()[1]._depth);
+    EXPECT_EQ(11u, done.sharedIoQueue()._posted);
+    EXPECT_EQ(11u, done.sharedIoQueue()._completed);
+    EXPECT_EQ(1u, done.sharedIoQueue()._errors);
+    EXPECT_EQ(0u, done.coroQueues()[0]._postedPerSec); //nothing posted since the previous call
+    EXPECT_LE(AllocatorTraits::taskAllocSize(), done.pools().task().capacity());
+    std::ostringstream out;
+    out << done;
+    EXPECT_NE(std::string::npos, out.str().find("Shared IO queue"));
+    
+    //the exporter keeps its own rates
+    auto numExported = [&]()->size_t {
+        std::lock_guard<std::mutex> lock(mutex);
+        return exported.size();
+    };
+    for (int i = 0; (i < 100) && (numExported() < 2); ++i)
+    {
+        std::this_thread::sleep_for(ms(10));
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_LE(2u, exported.size());
+    EXPECT_EQ(0, exported.front().interval().count());
+    for (size_t i = 1; i < exported.size(); ++i)
+    {
+        EXPECT_GE(exported[i].interval(), ms(15));
+        EXPECT_GT(exported[i].time(), exported[i-1].time());
+    }
+}
+
+TEST(ExecutionTest, HardwareCounters)
+{
+    //counters are not available in every environment, e.g. when perf events are disabled
+    PerfCounters probe;
+    bool isAvailable = probe.open();
+    probe.close();
+    EXPECT_FALSE(probe.isOpen());
+    EXPECT_EQ(0u, probe.read(PerfEvent::CpuCycles));
+    
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    config.setHardwareCounterStatistics(true);
+    Dispatcher dispatcher(config);
+    for (int i = 0; i < 10; ++i)
+    {
+        dispatcher.postAsyncIo([](ThreadPromise<int>::Ptr promise)->int {
+            std::this_thread::sleep_for(ms(1)); //forces a context switch
+            return promise->set(0);
+        });
+        dispatcher.post([](CoroContext<int>::Ptr ctx)->int { return ctx->set(0); });
+    }
+    dispatcher.drain();
+    QueueStatistics ioStats = dispatcher.stats(IQueue::QueueType::IO, 0);
+    QueueStatistics coroStats = dispatcher.stats(IQueue::QueueType::Coro, 0);
+    if (isAvailable)
+    {
+        EXPECT_GE(ioStats.perfCount(PerfEvent::ContextSwitches), 10u);
+        //counts are cumulative
+        EXPECT_GE(dispatcher.stats(IQueue::QueueType::IO, 0).perfCount(PerfEvent::ContextSwitches),
+                  ioStats.perfCount(PerfEvent::ContextSwitches));
+    }
+    std::ostringstream out;
+    out << coroStats;
+    EXPECT_NE(std::string::npos, out.str().find("context-switches:"));
+    
+    //nothing is counted unless enabled
+    config.setHardwareCounterStatistics(false);
+    Dispatcher disabled(config);
+    disabled.postAsyncIo([](ThreadPromise<int>::Ptr promise)->int {
+        std::this_thread::sleep_for(ms(1));
+        return promise->set(0);
+    });
+    disabled.drain();
+    EXPECT_EQ(0u, disabled.stats(IQueue::QueueType::IO, 0).perfCount(PerfEvent::ContextSwitches));
+}
+
+TEST(ExecutionTest, Quiescence)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(2);
+    Dispatcher dispatcher(config);
+    
+    //nothing outstanding so the callback runs right away
+    bool isQuiescent = false;
+    dispatcher.onQuiescence([&isQuiescent]() { isQuiescent = true; });
+    EXPECT_TRUE(isQuiescent);
+    
+    std::atomic_bool release{false};
+    std::atomic_int numCompleted{0};
+    dispatcher.postFirst([&release](CoroContext<int>::Ptr ctx)->int {
+        while (!release)
+        {
+            ctx->sleep(ms(1));
+        }
+        return ctx->set(0);
+    })->then([&numCompleted](CoroContext<int>::Ptr ctx)->int {
+        ++numCompleted;
+        return ctx->postAsyncIo([&numCompleted](ThreadPromise<int>::Ptr promise)->int {
+            ++numCompleted;
+            return promise->set(0);
+        })->get(ctx);
+    })->end();
+    std::atomic_bool isCalled{false};
+    dispatcher.onQuiescence([&isCalled]() { isCalled = true; });
+    std::future<void> quiescent = dispatcher.whenQuiescent();
+    EXPECT_EQ(std::future_status::timeout, quiescent.wait_for(ms(20)));
+    EXPECT_FALSE(isCalled);
+    EXPECT_GE(dispatcher.getNumOutstandingTasks(), 1u);
+    
+    //drain gives up after the timeout
+    auto start = std::chrono::steady_clock::now();
+    dispatcher.drain(ms(20));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, ms(20));
+    EXPECT_FALSE(dispatcher.empty());
+    
+    //the continuation and its IO task are accounted for until the very end
+    release = true;
+    dispatcher.drain();
+    EXPECT_EQ(2, numCompleted);
+    EXPECT_EQ(0u, dispatcher.getNumOutstandingTasks());
+    EXPECT_TRUE(dispatcher.empty());
+    //callbacks run on the worker which completed the last task, possibly after drain() returns
+    EXPECT_EQ(std::future_status::ready, quiescent.wait_for(ms(1000)));
+    EXPECT_TRUE(isCalled); //called ahead of the future's callback
+}
+
+TEST(ExecutionTest, TerminatePolicy)
+{
+    for (auto policy : {Configuration::TerminatePolicy::Discard, Configuration::TerminatePolicy::Abandon})
+    {
+        Configuration config;
+        config.setNumCoroutineThreads(4);
+        config.setNumIoThreads(2);
+        config.setTerminatePolicy(policy);
+        EXPECT_EQ(policy, config.getTerminatePolicy());
+        Dispatcher dispatcher(config);
+        
+        //parked, runnable and not yet started coroutines along with queued IO tasks
+        std::atomic_int numStarted{0};
+        std::atomic_int numCompleted{0};
+        std::vector<IThreadContext<int>::Ptr> contexts;
+        for (int i = 0; i < 200; ++i)
+        {
+            contexts.push_back(dispatcher.post([&numStarted, &numCompleted, i](CoroContext<int>::Ptr ctx)->int {
+                ++numStarted;
+                if (i % 2)
+                {
+                    ctx->sleep(std::chrono::seconds(10));
+                }
+                else
+                {
+                    for (int j = 0; j < 1000000; ++j)
+                    {
+                        ctx->yield();
+                    }
+                }
+                ++numCompleted;
+                return ctx->set(i);
+            }));
+        }
+        std::vector<ThreadFuture<int>::Ptr> futures;
+        for (int i = 0; i < 50; ++i)
+        {
+            futures.push_back(dispatcher.postAsyncIo([&numCompleted](ThreadPromise<int>::Ptr promise)->int {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                ++numCompleted;
+                return promise->set(0);
+            }));
+        }
+        while (numStarted == 0)
+        {
+            std::this_thread::yield();
+        }
+        auto start = std::chrono::steady_clock::now();
+        dispatcher.terminate();
+        EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(250));
+        
+        //no coroutine has completed and the IO tasks left in the queues were dropped
+        EXPECT_LT(numCompleted, 10);
+        for (auto&& ctx : contexts)
+        {
+            EXPECT_THROW(ctx->get(), BrokenPromiseException);
+        }
+        size_t numBroken = 0;
+        for (auto&& future : futures)
+        {
+            try
+            {
+                future->get();
+            }
+            catch (BrokenPromiseException&)
+            {
+                ++numBroken;
+            }
+        }
+        EXPECT_GE(numBroken, futures.size() - 10);
+        EXPECT_EQ(0u, dispatcher.getNumOutstandingTasks());
+    }
+}
+
+TEST(ExecutionTest, ManualQueues)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    config.setNumManualCoroutineQueues(1);
+    Dispatcher dispatcher(config);
+    EXPECT_EQ(1, dispatcher.getNumManualCoroutineQueues());
+    EXPECT_THROW(dispatcher.runOnce(0, 1), std::runtime_error);
+    
+    //coroutines of the manual queue only run when driven by this thread
+    std::thread::id runThread;
+    std::atomic_int numSlices{0};
+    IThreadContext<int>::Ptr ctx = dispatcher.post(1, false, [&runThread, &numSlices](CoroContext<int>::Ptr ctx)->int {
+        runThread = std::this_thread::get_id();
+        for (int i = 0; i < 3; ++i)
+        {
+            ++numSlices;
+            ctx->yield();
+        }
+        ++numSlices;
+        return ctx->set(7);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(0, numSlices);
+    EXPECT_EQ(1u, dispatcher.runOnce(1, 1));
+    EXPECT_EQ(1, numSlices);
+    EXPECT_EQ(3u, dispatcher.runUntilIdle());
+    EXPECT_EQ(0u, dispatcher.runUntilIdle());
+    EXPECT_EQ(7, ctx->get());
+    EXPECT_EQ(std::this_thread::get_id(), runThread);
+    
+    //tasks posted on the 'Any' queue are placed on the threaded queue
+    std::vector<IThreadContext<int>::Ptr> contexts;
+    for (int i = 0; i < 20; ++i)
+    {
+        contexts.push_back(dispatcher.post([](CoroContext<int>::Ptr ctx)->int {
+            return ctx->set(0);
+        }));
+    }
+    for (auto&& ctx : contexts)
+    {
+        ctx->wait();
+    }
+    EXPECT_EQ(20u, dispatcher.stats(IQueue::QueueType::Coro, 0).postedCount());
+    
+    //a coroutine waiting on an IO task is resumed by drain() once the IO thread has completed it
+    ctx = dispatcher.post(1, false, [](CoroContext<int>::Ptr ctx)->int {
+        int value = ctx->postAsyncIo([](ThreadPromise<int>::Ptr promise)->int {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            return promise->set(5);
+        })->get(ctx);
+        return ctx->set(value + 1);
+    });
+    EXPECT_EQ(1u, dispatcher.runUntilIdle()); //parked
+    dispatcher.drain();
+    EXPECT_EQ(6, ctx->get());
+    EXPECT_EQ(0u, dispatcher.getNumOutstandingTasks());
+}
+
+TEST(ExecutionTest, LazyThreadStart)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(4);
+    config.setNumIoThreads(3);
+    config.setPinCoroutineThreadsToCores(true); //applied once each thread starts
+    config.setLazyThreadStart(true);
+    {
+        //queues which never receive work are torn down without a thread
+        Dispatcher dispatcher(config);
+    }
+    Dispatcher dispatcher(config);
+    
+    //only the queue posted to gets a thread
+    std::thread::id threadId;
+    IThreadContext<int>::Ptr ctx = dispatcher.post(2, false, [&threadId](CoroContext<int>::Ptr ctx)->int {
+        threadId = std::this_thread::get_id();
+        return ctx->set(2);
+    });
+    EXPECT_EQ(2, ctx->get());
+    EXPECT_NE(std::this_thread::get_id(), threadId);
+    EXPECT_EQ(1u, dispatcher.stats(IQueue::QueueType::Coro, 2).postedCount());
+    
+    //'Any' coroutine and IO posts start the queues on demand
+    std::vector<IThreadContext<int>::Ptr> contexts;
+    for (int i = 0; i < 20; ++i)
+    {
+        contexts.push_back(dispatcher.post([](CoroContext<int>::Ptr ctx)->int {
+            int value = ctx->postAsyncIo([](ThreadPromise<int>::Ptr promise)->int {
+                return promise->set(1);
+            })->get(ctx);
+            return ctx->set(value);
+        }));
+    }
+    int sum = 0;
+    for (auto&& ctx : contexts)
+    {
+        sum += ctx->get();
+    }
+    EXPECT_EQ(20, sum);
+    
+    //dedicated IO queue
+    ThreadFuture<int>::Ptr future = dispatcher.postAsyncIo(1, false, [](ThreadPromise<int>::Ptr promise)->int {
+        return promise->set(3);
+    });
+    EXPECT_EQ(3, future->get());
+    dispatcher.drain();
+    EXPECT_EQ(0u, dispatcher.getNumOutstandingTasks());
+}
+
+TEST(ExecutionTest, StacklessTasks)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    Dispatcher dispatcher(config);
+    
+    //tasks run on the coroutine threads and can be joined like any other thread future
+    std::vector<ThreadFuture<int>::Ptr> futures;
+    for (int i = 0; i < 100; ++i)
+    {
+        futures.push_back(dispatcher.postTask([i](ThreadPromise<int>::Ptr promise)->int {
+            return promise->set(i * 2);
+        }));
+    }
+    std::vector<int> output = FutureJoiner<int>()(dispatcher, std::move(futures))->get();
+    ASSERT_EQ(100u, output.size());
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(i * 2, output[i]);
+    }
+    
+    //specific queue
+    std::thread::id threadId;
+    ThreadFuture<int>::Ptr future = dispatcher.postTask(1, true, [&threadId](ThreadPromise<int>::Ptr promise)->int {
+        threadId = std::this_thread::get_id();
+        return promise->set(5);
+    });
+    EXPECT_EQ(5, future->get());
+    EXPECT_NE(std::this_thread::get_id(), threadId);
+    EXPECT_THROW(dispatcher.postTask(5, false, [](ThreadPromise<int>::Ptr promise)->int {
+        return promise->set(0);
+    }), std::runtime_error);
+    
+    //exceptions are forwarded to the future
+    future = dispatcher.postTask([](ThreadPromise<int>::Ptr)->int {
+        throw std::runtime_error("stackless");
+    });
+    EXPECT_THROW(future->get(), std::runtime_error);
+    dispatcher.drain();
+    EXPECT_EQ(0u, dispatcher.getNumOutstandingTasks());
+}
+
+TEST(ExecutionTest, DetachedPosts)
+{
+    std::atomic_int numErrors{0};
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(2);
+    config.setDetachedErrorCallback([&numErrors](std::exception_ptr ex) {
+        try
+        {
+            std::rethrow_exception(ex);
+        }
+        catch (const std::runtime_error&)
+        {
+            ++numErrors;
+        }
+    });
+    Dispatcher dispatcher(config);
+    
+    std::atomic_int sum{0};
+    for (int i = 0; i < 50; ++i)
+    {
+        dispatcher.postDetached([&sum, i](CoroContext<int>::Ptr ctx)->int {
+            ctx->yield();
+            sum += i;
+            return ctx->set(i); //dropped
+        });
+        dispatcher.postAsyncIoDetached([&sum, i]()->int {
+            sum += i;
+            return 0;
+        });
+    }
+    dispatcher.postDetached<std::string>(1, true, [&sum](CoroContext<std::string>::Ptr ctx)->int {
+        EXPECT_THROW(ctx->get(ctx), std::exception); //no result to read
+        sum += 1000;
+        return 0;
+    });
+    dispatcher.drain();
+    EXPECT_EQ(2 * 1225 + 1000, sum);
+    EXPECT_EQ(0, numErrors);
+    
+    //exceptions go to the error callback
+    dispatcher.postDetached([](CoroContext<int>::Ptr)->int {
+        throw std::runtime_error("detached");
+    });
+    dispatcher.postAsyncIoDetached(0, false, []()->int {
+        throw std::runtime_error("detached");
+    });
+    dispatcher.drain();
+    EXPECT_EQ(2, numErrors);
+    EXPECT_EQ(0u, dispatcher.getNumOutstandingTasks());
+}
+
+TEST(ExecutionTest, PendingInboxReleasedOnTerminate)
+{
+    //tasks still linked in the inbox of a queue are released with their dispatcher
+    std::vector<ThreadContext<int>::Ptr> contexts;
+    std::vector<ThreadFuture<int>::Ptr> futures;
+    {
+        Configuration config;
+        config.setNumCoroutineThreads(1);
+        config.setNumIoThreads(1);
+        config.setNumManualCoroutineQueues(1); //never driven
+        Dispatcher dispatcher(config);
+        for (int i = 0; i < 10; ++i)
+        {
+            contexts.push_back(dispatcher.post(0, false, [](CoroContext<int>::Ptr ctx)->int {
+                return ctx->set(1);
+            }));
+            futures.push_back(dispatcher.postTask(0, false, [](ThreadPromise<int>::Ptr promise)->int {
+                return promise->set(1);
+            }));
+        }
+        dispatcher.terminate(); //without draining
+    }
+    for (size_t i = 0; i < contexts.size(); ++i)
+    {
+        EXPECT_THROW(contexts[i]->get(), std::exception);
+        EXPECT_THROW(futures[i]->get(), std::exception);
+    }
+}
+
+TEST(ExecutionTest, RunListDoesNotAllocate)
+{
+    //tasks are linked into the run lists through their embedded hook rather than pooled list nodes
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    config.setNumManualCoroutineQueues(1);
+    Dispatcher dispatcher(config);
+    size_t inUse = dispatcher.metrics().pools().queueList().inUse();
+    std::vector<ThreadContext<int>::Ptr> contexts;
+    for (int i = 0; i < 20; ++i)
+    {
+        contexts.push_back(dispatcher.post(1, false, [](CoroContext<int>::Ptr ctx)->int {
+            ctx->yield();
+            return ctx->set(1);
+        }));
+    }
+    EXPECT_EQ(1u, dispatcher.runOnce(1, 1)); //drains the inbox into the run list
+    EXPECT_EQ(inUse, dispatcher.metrics().pools().queueList().inUse());
+    dispatcher.runUntilIdle();
+    for (auto&& ctx : contexts)
+    {
+        EXPECT_EQ(1, ctx->get());
+    }
+}
+
+TEST(ExecutionTest, AdmissionControl)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    config.setNumManualCoroutineQueues(1); //queue 1 only drains when driven
+    config.setQueueHighWatermark(5);
+    config.setAdmissionPolicy(Configuration::AdmissionPolicy::Reject);
+    Dispatcher dispatcher(config);
+    auto func = [](CoroContext<int>::Ptr ctx)->int { return ctx->set(1); };
+    
+    std::vector<ThreadContext<int>::Ptr> contexts;
+    for (int i = 0; i < 5; ++i)
+    {
+        contexts.push_back(dispatcher.post(1, false, func));
+    }
+    EXPECT_THROW(dispatcher.post(1, false, func), std::runtime_error);
+    EXPECT_EQ(nullptr, dispatcher.tryPost(1, false, func));
+    
+    //high priority posts are never shed
+    contexts.push_back(dispatcher.post(1, true, func));
+    ASSERT_NE(nullptr, dispatcher.tryPost(1, true, func));
+    
+    QueueStatistics stats = dispatcher.stats(IQueue::QueueType::Coro, 1);
+    EXPECT_EQ(2u, stats.rejectedCount());
+    EXPECT_EQ(1u, stats.highWatermarkCount());
+    
+    //other queues are not affected
+    EXPECT_EQ(1, dispatcher.post(0, false, func)->get());
+    
+    //admission resumes once the queue has drained below its low watermark
+    dispatcher.runUntilIdle();
+    for (auto&& ctx : contexts)
+    {
+        EXPECT_EQ(1, ctx->get());
+    }
+    ThreadContext<int>::Ptr ctx = dispatcher.tryPost(1, false, func);
+    ASSERT_NE(nullptr, ctx);
+    dispatcher.runUntilIdle();
+    EXPECT_EQ(1, ctx->get());
+}
+
+TEST(ExecutionTest, AdmissionBlocking)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    config.setNumManualCoroutineQueues(1); //queue 1 only drains when driven
+    config.setQueueHighWatermark(4);
+    config.setAdmissionPolicy(Configuration::AdmissionPolicy::Block);
+    Dispatcher dispatcher(config);
+    std::atomic_bool isStarted{false};
+    std::atomic_bool isReleased{false};
+    auto ioFunc = [](ThreadPromise<int>::Ptr promise)->int { return promise->set(1); };
+    auto func = [](CoroContext<int>::Ptr ctx)->int { return ctx->set(1); };
+    
+    //a blocked thread is woken up once the IO queue drains
+    ThreadFuture<int>::Ptr blocker = dispatcher.postAsyncIo(0, false, [&isStarted, &isReleased](ThreadPromise<int>::Ptr promise)->int {
+        isStarted = true;
+        while (!isReleased)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return promise->set(0);
+    });
+    while (!isStarted)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::vector<ThreadFuture<int>::Ptr> futures;
+    for (ThreadFuture<int>::Ptr future; (future = dispatcher.tryPostAsyncIo(0, false, ioFunc)) != nullptr;)
+    {
+        futures.push_back(future);
+    }
+    EXPECT_FALSE(futures.empty());
+    std::atomic_bool isAdmitted{false};
+    ThreadFuture<int>::Ptr blocked;
+    std::thread poster([&]() {
+        blocked = dispatcher.postAsyncIo(0, false, ioFunc);
+        isAdmitted = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(isAdmitted);
+    isReleased = true;
+    poster.join();
+    EXPECT_EQ(0, blocker->get());
+    EXPECT_EQ(1, blocked->get());
+    for (auto&& future : futures)
+    {
+        EXPECT_EQ(1, future->get());
+    }
+    
+    //the thread driving the manual queue is rejected instead of waiting on it
+    dispatcher.runUntilIdle();
+    std::vector<ThreadContext<int>::Ptr> contexts;
+    for (int i = 0; i < 4; ++i)
+    {
+        contexts.push_back(dispatcher.post(1, false, func));
+    }
+    EXPECT_THROW(dispatcher.post(1, false, func), std::runtime_error);
+    EXPECT_EQ(1u, dispatcher.stats(IQueue::QueueType::Coro, 1).rejectedCount());
+    
+    //a coroutine yields until the queue is drained without holding up its own queue
+    ThreadContext<int>::Ptr yielding = dispatcher.post(0, false, [func](CoroContext<int>::Ptr ctx)->int {
+        return ctx->set(ctx->post(1, false, func)->get(ctx) + 1);
+    });
+    EXPECT_EQ(1, dispatcher.post(0, false, func)->get());
+    EXPECT_EQ(std::future_status::timeout, yielding->waitFor(std::chrono::milliseconds(50)));
+    while (yielding->waitFor(std::chrono::milliseconds(1)) != std::future_status::ready)
+    {
+        dispatcher.runUntilIdle();
+    }
+    EXPECT_EQ(2, yielding->get());
+    for (auto&& ctx : contexts)
+    {
+        EXPECT_EQ(1, ctx->get());
+    }
+}
+
+TEST(ExecutionTest, IoDeadlines)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    Dispatcher dispatcher(config);
+    std::atomic_bool isStarted{false};
+    std::atomic_bool isReleased{false};
+    std::vector<int> order;
+    auto now = std::chrono::steady_clock::now();
+    auto record = [&order](ThreadPromise<int>::Ptr promise, int value)->int {
+        order.push_back(value);
+        return promise->set(value);
+    };
+    
+    //hold the IO thread while the other tasks are queued
+    ThreadFuture<int>::Ptr blocker = dispatcher.postAsyncIo(0, false, [&isStarted, &isReleased](ThreadPromise<int>::Ptr promise)->int {
+        isStarted = true;
+        while (!isReleased)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return promise->set(0);
+    });
+    while (!isStarted)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ThreadFuture<int>::Ptr noDeadline = dispatcher.postAsyncIo(0, false, record, 1);
+    ThreadFuture<int>::Ptr late = dispatcher.postAsyncIo(0, false, now + std::chrono::seconds(20), record, 2);
+    ThreadFuture<int>::Ptr early = dispatcher.postAsyncIo(0, false, now + std::chrono::seconds(10), record, 3);
+    ThreadFuture<int>::Ptr expired = dispatcher.postAsyncIo(0, false, now + std::chrono::milliseconds(10), record, 4);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    isReleased = true;
+    
+    EXPECT_EQ(0, blocker->get());
+    EXPECT_EQ(3, early->get());
+    EXPECT_EQ(2, late->get());
+    EXPECT_EQ(1, noDeadline->get());
+    EXPECT_THROW(expired->get(), DeadlineExceededException);
+    EXPECT_EQ(std::vector<int>({3, 2, 1}), order);
+    EXPECT_EQ(1u, dispatcher.stats(IQueue::QueueType::IO, 0).expiredCount());
+}
+
+TEST(ExecutionTest, Generators)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    int numProduced = 0;
+    auto countTo = [&numProduced](Generator<int>::Sink& sink, int num)->int {
+        for (int i = 1; i <= num; ++i)
+        {
+            ++numProduced;
+            sink(i);
+        }
+        return 0;
+    };
+    
+    //values are only produced on demand
+    Generator<int> generator(countTo, 5);
+    EXPECT_EQ(0, numProduced);
+    ASSERT_TRUE(generator.next());
+    EXPECT_EQ(1, generator.value());
+    EXPECT_EQ(1, numProduced);
+    
+    //consumed with a range-based for loop inside a coroutine
+    auto sum = dispatcher.post([countTo](CoroContext<int>::Ptr ctx)->int {
+        int total = 0;
+        for (int value : Generator<int>(countTo, 100))
+        {
+            total += value;
+        }
+        return ctx->set(total);
+    })->get();
+    EXPECT_EQ(5050, sum);
+    
+    //the rest of the first generator, then an exception
+    std::vector<int> values;
+    for (int value : generator)
+    {
+        values.push_back(value);
+    }
+    EXPECT_EQ(std::vector<int>({1, 2, 3, 4, 5}), values);
+    EXPECT_TRUE(generator.done());
+    EXPECT_FALSE(generator.next());
+    Generator<std::string> failing([](Generator<std::string>::Sink& sink)->int {
+        sink("first");
+        throw std::runtime_error("parse error");
+    });
+    ASSERT_TRUE(failing.next());
+    EXPECT_EQ("first", failing.value());
+    EXPECT_THROW(failing.next(), std::runtime_error);
+}
+
+TEST(ExecutionTest, Select)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    Promise<Buffer<int>> first, second;
+    auto channel = std::make_shared<Channel<int>>(4);
+    std::vector<Selectable> sources{first.getICoroFuture(), second.getIThreadFuture(), channel};
+    
+    //nothing to pull yet
+    EXPECT_EQ(sources.size(), select(sources, std::chrono::milliseconds(10)));
+    
+    //a coroutine waits on all the sources and is woken up by the channel
+    std::atomic_bool isWaiting{false};
+    auto selected = dispatcher.post([&sources, &isWaiting](CoroContext<int>::Ptr ctx)->int {
+        isWaiting = true;
+        size_t index = select(ctx, sources);
+        return ctx->set((int)index);
+    });
+    while (!isWaiting)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    channel->push(5);
+    EXPECT_EQ(2, selected->get());
+    
+    //no source is starved while several are ready
+    second.push(7);
+    std::set<size_t> indexes;
+    for (int i = 0; i < 3; ++i)
+    {
+        indexes.insert(select(sources));
+    }
+    EXPECT_EQ(std::set<size_t>({1, 2}), indexes);
+    
+    //a closed source is ready since pulling from it does not block
+    bool isClosed = false;
+    EXPECT_EQ(5, channel->pull(isClosed));
+    EXPECT_EQ(7, second.getIThreadFuture()->pull(isClosed));
+    first.closeBuffer();
+    EXPECT_EQ(0u, dispatcher.post([&sources](CoroContext<int>::Ptr ctx)->int {
+        return ctx->set((int)select(ctx, sources, std::chrono::milliseconds(100)));
+    })->get());
+    EXPECT_EQ(1u, select(std::vector<Selectable>{second.getIThreadFuture()}, std::chrono::milliseconds(10)));
+}
+
+TEST(ExecutionTest, CoroutineMigration)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    config.setCoroutineQueueSelectionPolicy(Configuration::QueueSelectionPolicy::RoundRobin);
+    config.setCoroutineMigration(true);
+    Dispatcher dispatcher(config);
+    Semaphore wakeUp(0), gate(0);
+    std::atomic_int numWaiting{0};
+    auto waitFor = [&numWaiting](int num) {
+        while (numWaiting < num)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10)); //let the coroutines park
+    };
+    
+    //an unpinned coroutine parks on queue 0 which then gets overloaded with pinned coroutines
+    std::thread::id parkedOn, resumedOn;
+    auto migrated = dispatcher.post([&parkedOn, &resumedOn, &numWaiting, &wakeUp](CoroContext<int>::Ptr ctx)->int {
+        parkedOn = std::this_thread::get_id();
+        ++numWaiting;
+        wakeUp.acquire(ctx);
+        resumedOn = std::this_thread::get_id();
+        return ctx->set(0);
+    });
+    waitFor(1);
+    std::vector<std::thread::id> pinnedOn(3);
+    std::vector<ThreadContextPtr<int>> pinned;
+    for (size_t i = 0; i < pinnedOn.size(); ++i)
+    {
+        pinned.push_back(dispatcher.post(0, false, [&pinnedOn, &numWaiting, &gate, i](CoroContext<int>::Ptr ctx)->int {
+            ++numWaiting;
+            gate.acquire(ctx);
+            pinnedOn[i] = std::this_thread::get_id();
+            return ctx->set(0);
+        }));
+    }
+    waitFor(4);
+    
+    //the unpinned coroutine resumes on the idle queue
+    wakeUp.release();
+    migrated->get();
+    EXPECT_NE(parkedOn, resumedOn);
+    EXPECT_EQ(1u, dispatcher.stats(IQueue::QueueType::Coro, 1).migratedCount());
+    
+    //a coroutine posted to the overloaded queue is handed over before its first run
+    dispatcher.post([](CoroContext<int>::Ptr ctx)->int { return ctx->set(0); })->get(); //round robin to queue 1
+    std::thread::id startedOn;
+    dispatcher.post([&startedOn](CoroContext<int>::Ptr ctx)->int {
+        startedOn = std::this_thread::get_id();
+        return ctx->set(0);
+    })->get();
+    EXPECT_EQ(resumedOn, startedOn);
+    EXPECT_EQ(2u, dispatcher.stats(IQueue::QueueType::Coro, 1).migratedCount());
+    
+    //pinned coroutines stay on their queue
+    gate.release(pinnedOn.size());
+    for (size_t i = 0; i < pinned.size(); ++i)
+    {
+        pinned[i]->get();
+        EXPECT_EQ(parkedOn, pinnedOn[i]);
+    }
+    EXPECT_EQ(0u, dispatcher.stats(IQueue::QueueType::Coro, 0).migratedCount());
+}
+
+TEST(ExecutionTest, SamplingProfiler)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    config.setSamplingProfilerIntervalUs(std::chrono::microseconds(200));
+    Dispatcher dispatcher(config);
+    auto spin = []() {
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(30);
+        while (std::chrono::steady_clock::now() < end);
+    };
+    struct BusyLoop
+    {
+        std::function<void()> _spin;
+        int operator()(CoroContext<int>::Ptr ctx) { _spin(); return ctx->set(0); }
+    };
+    
+    //labelled coroutines are reported under their label and the others under their type
+    dispatcher.post(TaskLabel("parse"), [spin](CoroContext<int>::Ptr ctx)->int {
+        spin();
+        return ctx->set(0);
+    })->get();
+    dispatcher.post(BusyLoop{spin})->get();
+    Profile profile = dispatcher.profile();
+    EXPECT_EQ(std::chrono::microseconds(200), profile.interval());
+    EXPECT_GT(profile.numSamples(), 0u);
+    size_t parseSamples = 0, busyLoopSamples = 0;
+    for (auto&& entry : profile.entries())
+    {
+        EXPECT_EQ(0, entry._queueId);
+        if (entry._label == "parse")
+        {
+            parseSamples += entry._numSamples;
+        }
+        else if (entry._label.find("BusyLoop") != std::string::npos)
+        {
+            busyLoopSamples += entry._numSamples;
+        }
+    }
+    EXPECT_GT(parseSamples, 0u);
+    EXPECT_GT(busyLoopSamples, 0u);
+    
+    std::ostringstream pprof;
+    profile.writePprof(pprof);
+    EXPECT_NE(std::string::npos, pprof.str().find("parse"));
+    EXPECT_NE(std::string::npos, pprof.str().find("coroutine queue 0"));
+    
+    dispatcher.resetStats();
+    EXPECT_TRUE(dispatcher.profile().entries().empty());
+}
+
+TEST(ExecutionTest, Advisor)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    config.setIoThreadGrowthBacklog(2);
+    config.setIoThreadIdleTimeoutMs(ms(50));
+    Dispatcher dispatcher(config);
+    Advisor advisor(dispatcher, config);
+    advisor.sample();
+    EXPECT_EQ(1u, advisor.numSamples());
+    EXPECT_TRUE(advisor.recommendations().empty()); //idle dispatcher
+    
+    //a single IO thread cannot keep up with a backlog of slow tasks
+    std::mutex m;
+    std::set<std::thread::id> threadIds;
+    auto slowIo = [&](ThreadPromise<int>::Ptr promise)->int {
+        std::this_thread::sleep_for(ms(10));
+        {
+            std::lock_guard<std::mutex> lock(m);
+            threadIds.insert(std::this_thread::get_id());
+        }
+        return promise->set(0);
+    };
+    advisor.reset();
+    for (int i = 0; i < 20; ++i)
+    {
+        dispatcher.postAsyncIo(slowIo);
+    }
+    advisor.sample();
+    dispatcher.drain();
+    auto recommendations = advisor.recommendations();
+    ASSERT_EQ(1u, recommendations.size());
+    EXPECT_EQ("maxNumIoThreads", recommendations[0]._setting);
+    EXPECT_EQ(0u, recommendations[0]._current);
+    EXPECT_LT(1u, recommendations[0]._recommended);
+    EXPECT_TRUE(recommendations[0]._isLive);
+    EXPECT_EQ((int)recommendations[0]._recommended, advisor.recommendedConfiguration().getMaxNumIoThreads());
+    std::ostringstream out;
+    out << advisor;
+    EXPECT_NE(std::string::npos, out.str().find("maxNumIoThreads: 0 -> "));
+    
+    //the IO pool becomes elastic without restarting the dispatcher
+    EXPECT_EQ(1u, advisor.apply());
+    threadIds.clear();
+    for (int i = 0; i < 20; ++i)
+    {
+        dispatcher.postAsyncIo(slowIo);
+    }
+    dispatcher.drain();
+    EXPECT_LT(1u, threadIds.size());
+}
+
+TEST(ExecutionTest, AdvisorIoThreadGrowth)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    config.setMaxNumIoThreads(4);
+    config.setLatencyStatistics(true);
+    Dispatcher dispatcher(config);
+    Advisor advisor(dispatcher, config);
+    
+    //the backlog stays below the default growth threshold so the IO tasks queue up behind a single thread
+    for (int i = 0; i < 6; ++i)
+    {
+        dispatcher.postAsyncIo([](ThreadPromise<int>::Ptr promise)->int {
+            std::this_thread::sleep_for(ms(10));
+            return promise->set(0);
+        });
+    }
+    advisor.sample();
+    dispatcher.drain();
+    advisor.sample();
+    auto recommendations = advisor.recommendations();
+    ASSERT_EQ(1u, recommendations.size());
+    EXPECT_EQ("ioThreadGrowthBacklog", recommendations[0]._setting);
+    EXPECT_EQ(16u, recommendations[0]._current);
+    EXPECT_GT(16u, recommendations[0]._recommended);
+    EXPECT_FALSE(recommendations[0]._isLive);
+    EXPECT_EQ(recommendations[0]._recommended, advisor.recommendedConfiguration().getIoThreadGrowthBacklog());
+    EXPECT_EQ(0u, advisor.apply());
+}
+
+TEST(ExecutionTest, DeterministicSimulation)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(3);
+    config.setNumManualCoroutineQueues(3);
+    config.setNumIoThreads(1);
+    
+    //coroutines yielding, sleeping and waiting on each other. Records the order in which they run.
+    auto simulate = [&config](uint64_t seed, std::vector<int>& order)->Simulation::Statistics
+    {
+        Dispatcher dispatcher(config);
+        Simulation simulation(dispatcher, seed);
+        Promise<int> promise;
+        for (int i = 0; i < 6; ++i)
+        {
+            dispatcher.post(i % 3, false, [i, &order](CoroContext<int>::Ptr ctx)->int {
+                for (int j = 0; j < 5; ++j)
+                {
+                    order.push_back(i);
+                    if (j == 2)
+                    {
+                        ctx->sleep(ms(100 * (i + 1)));
+                    }
+                    else
+                    {
+                        ctx->yield();
+                    }
+                }
+                return ctx->set(i);
+            });
+        }
+        dispatcher.post(0, false, [&promise, &order](CoroContext<int>::Ptr ctx)->int {
+            order.push_back(-1);
+            return ctx->set(promise.getICoroFuture()->get(ctx));
+        });
+        dispatcher.post(1, false, [&promise](CoroContext<int>::Ptr ctx)->int {
+            ctx->sleep(ms(50));
+            return ctx->set(promise.set(5));
+        });
+        size_t numSteps = simulation.run();
+        EXPECT_EQ(numSteps, simulation.statistics()._numSteps);
+        EXPECT_FALSE(simulation.step());
+        EXPECT_EQ(0u, dispatcher.getNumOutstandingTasks());
+        return simulation.statistics();
+    };
+    
+    auto start = std::chrono::steady_clock::now();
+    std::vector<int> order1, order2, order3;
+    Simulation::Statistics stats1 = simulate(7, order1);
+    Simulation::Statistics stats2 = simulate(7, order2);
+    Simulation::Statistics stats3 = simulate(8, order3);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    
+    //the same seed reproduces the same interleaving and the same counts
+    EXPECT_EQ(31u, order1.size());
+    EXPECT_EQ(order1, order2);
+    EXPECT_EQ(stats1._scheduleHash, stats2._scheduleHash);
+    EXPECT_EQ(stats1._numScans, stats2._numScans);
+    EXPECT_EQ(stats1._numWakeUps, stats2._numWakeUps);
+    EXPECT_NE(stats1._scheduleHash, stats3._scheduleHash);
+    
+    EXPECT_EQ(stats1._numSteps, stats1._numSlices);
+    EXPECT_EQ(8u, stats1._numCompletions);
+    EXPECT_EQ(7u, stats1._numTimerExpirations); //one per sleep
+    EXPECT_EQ(8u, stats1._numWakeUps); //the sleepers and the promise waiter
+    EXPECT_EQ(24u, stats1._numYields);
+    EXPECT_LE(stats1._numSlices, stats1._numScans);
+    
+    //sleeping takes virtual time only
+    EXPECT_EQ(ms(600), stats1._virtualTime);
+    EXPECT_EQ(7u, stats1._numClockAdvances);
+    EXPECT_LT(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed), stats1._virtualTime);
+    
+    //coroutine queues with a thread cannot be simulated
+    Configuration threaded;
+    threaded.setNumCoroutineThreads(1);
+    threaded.setNumIoThreads(1);
+    Dispatcher dispatcher(threaded);
+    EXPECT_THROW(Simulation(dispatcher, 0), std::runtime_error);
+}
+
+TEST(ExecutionTest, NumaCpuSets)
+{
+    //Node 0 holds the CPU this test runs on, node 1 a CPU which may not exist
+    int cpu = sched_getcpu();
+    ASSERT_GE(cpu, 0);
+    Configuration config;
+    config.setNumCoroutineThreads(4);
+    config.setNumIoThreads(2);
+    config.setCoroutineCpuSets({{cpu}, {cpu+1}});
+    config.setIoCpuSets({{cpu}});
+    Dispatcher dispatcher(config);
+    
+    //Posting to 'any' from queue 0 must select a queue of the same node
+    dispatcher.post(0, false, [](CoroContext<int>::Ptr ctx)->int {
+        for (int i = 0; i < 20; ++i)
+        {
+            ctx->post([](CoroContext<int>::Ptr)->int { return 0; });
+        }
+        return 0;
+    });
+    dispatcher.postAsyncIo([](ThreadPromise<int>::Ptr promise)->int {
+        return promise->set(0);
+    });
+    dispatcher.drain();
+    
+    EXPECT_EQ((size_t)21, dispatcher.stats(IQueue::QueueType::Coro, 0).postedCount() +
+                          dispatcher.stats(IQueue::QueueType::Coro, 1).postedCount());
+    EXPECT_EQ((size_t)0, dispatcher.stats(IQueue::QueueType::Coro, 2).postedCount());
+    EXPECT_EQ((size_t)0, dispatcher.stats(IQueue::QueueType::Coro, 3).postedCount());
+}
+
+TEST(ExecutionTest, ElasticIoThreads)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    config.setMaxNumIoThreads(4);
+    config.setIoThreadGrowthBacklog(2);
+    config.setIoThreadIdleTimeoutMs(ms(50));
+    Dispatcher dispatcher(config);
+    
+    std::mutex m;
+    std::set<std::thread::id> threadIds;
+    for (int i = 0; i < 12; ++i)
+    {
+        dispatcher.postAsyncIo([&](ThreadPromise<int>::Ptr promise)->int {
+            std::this_thread::sleep_for(ms(20));
+            {
+                std::lock_guard<std::mutex> lock(m);
+                threadIds.insert(std::this_thread::get_id());
+            }
+            return promise->set(0);
+        });
+    }
+    dispatcher.drain();
+    EXPECT_GT(threadIds.size(), (size_t)1); //extra threads were added
+    EXPECT_EQ((size_t)12, dispatcher.stats(IQueue::QueueType::IO).sharedQueueCompletedCount());
+    
+    //extra threads retire once idle
+    std::this_thread::sleep_for(ms(200));
+    EXPECT_EQ(0, dispatcher.getNumElasticIoThreads());
+    EXPECT_EQ(1, dispatcher.getNumIoThreads());
+}
+
+TEST(ExecutionTest, SharedIoWakesIdleThread)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(8);
+    Dispatcher dispatcher(config);
+    
+    //each post finds all the IO threads parked and must wake one of them
+    for (int i = 0; i < 20; ++i)
+    {
+        std::this_thread::sleep_for(ms(2));
+        ThreadFuture<int>::Ptr future = dispatcher.postAsyncIo([i](ThreadPromise<int>::Ptr promise)->int {
+            return promise->set(i);
+        });
+        EXPECT_EQ(i, future->get());
+    }
+    dispatcher.drain();
+    EXPECT_EQ((size_t)20, dispatcher.stats(IQueue::QueueType::IO).sharedQueueCompletedCount());
+}
+
+TEST(ExecutionTest, LoadBalancedSharedIoQueues)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(4);
+    config.setLoadBalanceSharedIoQueues(true);
+    config.setLoadBalancePollIntervalMs(ms(1000));
+    Dispatcher dispatcher(config);
+    
+    //idle threads are signalled instead of polling
+    std::this_thread::sleep_for(ms(10));
+    auto start = std::chrono::steady_clock::now();
+    ThreadFuture<int>::Ptr future = dispatcher.postAsyncIo([](ThreadPromise<int>::Ptr promise)->int {
+        return promise->set(7);
+    });
+    EXPECT_EQ(7, future->get());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, ms(500));
+    
+    //concurrent posters
+    std::atomic_int count{0};
+    std::vector<std::thread> posters;
+    for (int t = 0; t < 4; ++t)
+    {
+        posters.emplace_back([&dispatcher, &count]() {
+            for (int i = 0; i < 500; ++i)
+            {
+                dispatcher.postAsyncIo([&count](ThreadPromise<int>::Ptr promise)->int {
+                    ++count;
+                    return promise->set(0);
+                });
+            }
+        });
+    }
+    for (auto&& poster : posters)
+    {
+        poster.join();
+    }
+    dispatcher.drain();
+    EXPECT_EQ(2000, count);
+}
+
+TEST(ExecutionTest, AwaitFileDescriptor)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    Dispatcher dispatcher(config);
+    int fds[2];
+    ASSERT_EQ(0, pipe2(fds, O_NONBLOCK));
+    
+    //nothing is written so the wait times out
+    IThreadContext<int>::Ptr timeoutCtx = dispatcher.post([fds](CoroContext<int>::Ptr ctx)->int {
+        return ctx->set(ctx->awaitReadable(fds[0], ms(20)) ? 1 : 0);
+    });
+    EXPECT_EQ(0, timeoutCtx->get());
+    
+    //reading coroutines are parked and don't hold an IO thread
+    IThreadContext<int>::Ptr readCtx = dispatcher.post([fds](CoroContext<int>::Ptr ctx)->int {
+        char buffer[16] = {};
+        ssize_t rc = ctx->read(fds[0], buffer, sizeof(buffer));
+        return ctx->set(((rc == 7) && (strncmp(buffer, "quantum", 7) == 0)) ? 1 : 0);
+    });
+    std::this_thread::sleep_for(ms(20));
+    EXPECT_EQ(1, dispatcher.postAsyncIo([](ThreadPromise<int>::Ptr promise)->int {
+        return promise->set(1);
+    })->get());
+    IThreadContext<int>::Ptr writeCtx = dispatcher.post([fds](CoroContext<int>::Ptr ctx)->int {
+        return ctx->set((int)ctx->write(fds[1], "quantum", 7));
+    });
+    EXPECT_EQ(7, writeCtx->get());
+    EXPECT_EQ(1, readCtx->get());
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(ExecutionTest, DelayedAndPeriodicPosts)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    Dispatcher dispatcher(config);
+    
+    //delayed posts don't run before they are due
+    auto start = std::chrono::steady_clock::now();
+    IThreadContext<int>::Ptr ctx = dispatcher.postAfter(ms(50), [](CoroContext<int>::Ptr ctx, int value)->int {
+        return ctx->set(value);
+    }, 5);
+    EXPECT_EQ(0u, dispatcher.size(IQueue::QueueType::Coro));
+    EXPECT_EQ(5, ctx->get());
+    EXPECT_GE(std::chrono::steady_clock::now() - start, ms(50));
+    
+    //a coroutine can post a delayed coroutine as well
+    IThreadContext<int>::Ptr outer = dispatcher.post([](CoroContext<int>::Ptr ctx)->int {
+        CoroContext<int>::Ptr inner = ctx->postAt<int>(std::chrono::steady_clock::now() + ms(10), (int)IQueue::QueueId::Same, false,
+                                                        [](CoroContext<int>::Ptr ctx)->int {
+            return ctx->set(6);
+        });
+        return ctx->set(inner->get(ctx) + 1);
+    });
+    EXPECT_EQ(7, outer->get());
+    
+    //periodic posts run until cancelled
+    std::atomic_int count{0};
+    size_t timerId = dispatcher.postEvery(ms(10), [&count](CoroContext<int>::Ptr)->int {
+        ++count;
+        return 0;
+    });
+    while (count < 3)
+    {
+        std::this_thread::sleep_for(ms(5));
+    }
+    EXPECT_TRUE(dispatcher.cancelTimer(timerId));
+    EXPECT_FALSE(dispatcher.cancelTimer(timerId));
+    dispatcher.drain();
+    int finalCount = count;
+    std::this_thread::sleep_for(ms(30));
+    EXPECT_EQ(finalCount, count);
+}
+
+TEST(ExecutionTest, CancellationToken)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(1);
+    config.setNumIoThreads(1);
+    Dispatcher dispatcher(config);
+
+    //queued coroutines are discarded without running
+    std::atomic_bool isReleased{false};
+    std::atomic_int count{0};
+    dispatcher.post(0, false, [&isReleased](CoroContext<int>::Ptr)->int {
+        while (!isReleased) {} //hold the only coroutine thread
+        return 0;
+    });
+    CancellationToken::Ptr token = std::make_shared<CancellationToken>();
+    std::vector<IThreadContext<int>::Ptr> contexts;
+    for (int i = 0; i < 5; ++i)
+    {
+        contexts.push_back(dispatcher.post(token, 0, false, [&count](CoroContext<int>::Ptr ctx)->int {
+            ++count;
+            return ctx->set(1);
+        }));
+    }
+    token->cancel();
+    isReleased = true;
+    for (auto&& ctx : contexts)
+    {
+        EXPECT_THROW(ctx->get(), BrokenPromiseException);
+    }
+    EXPECT_EQ(0, count);
+    EXPECT_EQ(5u, dispatcher.stats(IQueue::QueueType::Coro).cancelledCount());
+
+    //remaining stages of a chain are skipped and children inherit the token
+    token = std::make_shared<CancellationToken>();
+    IThreadContext<int>::Ptr chain = dispatcher.postFirst(token, [token](CoroContext<int>::Ptr ctx)->int {
+        std::atomic_bool isStarted{false};
+        CoroContext<int>::Ptr child = ctx->post([&isStarted](CoroContext<int>::Ptr ctx)->int {
+            isStarted = true;
+            while (!ctx->isCancelled())
+            {
+                ctx->yield();
+            }
+            return ctx->set(2);
+        });
+        while (!isStarted)
+        {
+            ctx->yield();
+        }
+        token->cancel();
+        EXPECT_TRUE(ctx->isCancelled());
+        EXPECT_EQ(2, child->get(ctx));
+        return ctx->set(1);
+    })->then([&count](CoroContext<int>::Ptr ctx)->int {
+        ++count;
+        return ctx->set(3);
+    })->end();
+    EXPECT_EQ(1, chain->getAt<int>(0));
+    EXPECT_THROW(chain->getAt<int>(1), BrokenPromiseException);
+    EXPECT_EQ(0, count);
+
+    //IO tasks
+    token = std::make_shared<CancellationToken>();
+    token->cancel();
+    ThreadFuture<int>::Ptr future = dispatcher.postAsyncIo(token, [&count](ThreadPromise<int>::Ptr promise)->int {
+        ++count;
+        return promise->set(1);
+    });
+    EXPECT_THROW(future->get(), BrokenPromiseException);
+    EXPECT_EQ(0, count);
+    EXPECT_EQ(1u, dispatcher.stats(IQueue::QueueType::IO).cancelledCount());
+}
+
+TEST(ExecutionTest, SequencerKeepsOrderPerKey)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(4);
+    config.setNumIoThreads(1);
+    Dispatcher dispatcher(config);
+    Sequencer<int> sequencer(dispatcher);
+
+    const int numKeys = 5;
+    const int numItems = 50;
+    std::vector<std::vector<int>> output(numKeys);
+    std::vector<std::atomic_int> running(numKeys);
+    std::atomic_bool isOverlapping{false};
+    std::vector<IThreadContext<int>::Ptr> contexts;
+    for (int i = 0; i < numItems; ++i)
+    {
+        for (int key = 0; key < numKeys; ++key)
+        {
+            contexts.push_back(sequencer.enqueue(key, [&](CoroContext<int>::Ptr ctx, int key, int value)->int {
+                if (running[key]++ != 0)
+                {
+                    isOverlapping = true;
+                }
+                ctx->yield(); //let other coroutines run in between
+                output[key].push_back(value);
+                --running[key];
+                return ctx->set(value);
+            }, key, i));
+        }
+    }
+    for (auto&& ctx : contexts)
+    {
+        ctx->wait();
+    }
+    EXPECT_FALSE(isOverlapping);
+    EXPECT_EQ(0u, sequencer.size());
+    std::vector<int> expected(numItems);
+    std::iota(expected.begin(), expected.end(), 0);
+    for (int key = 0; key < numKeys; ++key)
+    {
+        EXPECT_EQ(expected, output[key]);
+    }
+    EXPECT_EQ(numItems - 1, contexts.back()->get());
+}
+
+TEST(ExecutionTest, CoroutineLocalStorage)
+{
+    static CoroLocal<int> traceId(true); //inherited by children
+    static CoroLocal<int> scratch;
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+
+    IThreadContext<int>::Ptr chain = dispatcher.postFirst([](CoroContext<int>::Ptr ctx)->int {
+        EXPECT_EQ(nullptr, ctx->getLocal(traceId));
+        ctx->setLocal(traceId, std::make_shared<int>(7));
+        ctx->setLocal(scratch, std::make_shared<int>(8));
+        CoroContext<int>::Ptr child = ctx->post([](CoroContext<int>::Ptr ctx)->int {
+            EXPECT_EQ(nullptr, ctx->getLocal(scratch)); //not inherited
+            return ctx->set(*ctx->getLocal(traceId));
+        });
+        return ctx->set(child->get(ctx));
+    })->then([](CoroContext<int>::Ptr ctx)->int {
+        //values are shared along the chain
+        ++*ctx->getLocal(scratch);
+        return ctx->set(*ctx->getLocal(traceId) + *ctx->getLocal(scratch));
+    })->end();
+    EXPECT_EQ(7, chain->getAt<int>(0));
+    EXPECT_EQ(16, chain->getAt<int>(1));
+
+    //unrelated coroutines don't see the values
+    IThreadContext<int>::Ptr ctx = dispatcher.post([](CoroContext<int>::Ptr ctx)->int {
+        return ctx->set(ctx->getLocal(traceId) ? 1 : 0);
+    });
+    EXPECT_EQ(0, ctx->get());
+}
+
+TEST(ExecutionTest, FifoMutexHandoff)
+{
+    Configuration config;
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    Dispatcher dispatcher(config);
+    Mutex mutex(Mutex::Mode::Fifo);
+
+    //waiters acquire the mutex in arrival order
+    std::vector<int> order;
+    std::vector<IThreadContext<int>::Ptr> contexts;
+    mutex.lock();
+    for (int i = 0; i < 5; ++i)
+    {
+        contexts.push_back(dispatcher.post(0, false, [&mutex, &order, i](CoroContext<int>::Ptr ctx)->int {
+            Mutex::Guard guard(ctx, mutex);
+            order.push_back(i);
+            return 0;
+        }));
+    }
+    //runs once all the coroutines above are waiting
+    dispatcher.post(0, false, [](CoroContext<int>::Ptr)->int { return 0; })->wait();
+    EXPECT_FALSE(mutex.tryLock());
+    mutex.unlock();
+    for (auto&& ctx : contexts)
+    {
+        ctx->wait();
+    }
+    EXPECT_EQ(std::vector<int>({0,1,2,3,4}), order);
+
+    //mutual exclusion between coroutines and threads
+    int value = 0;
+    contexts.clear();
+    for (int i = 0; i < 20; ++i)
+    {
+        contexts.push_back(dispatcher.post([&mutex, &value](CoroContext<int>::Ptr ctx)->int {
+            for (int j = 0; j < 100; ++j)
+            {
+                Mutex::Guard guard(ctx, mutex);
+                int tmp = value;
+                ctx->yield();
+                value = tmp + 1;
+            }
+            return 0;
+        }));
+    }
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 2; ++i)
+    {
+        threads.emplace_back([&mutex, &value]() {
+            for (int j = 0; j < 1000; ++j)
+            {
+                Mutex::Guard guard(mutex);
+                ++value;
+            }
+        });
+    }
+    for (auto&& thread : threads)
+    {
+        thread.join();
+    }
+    for (auto&& ctx : contexts)
+    {
+        ctx->wait();
+    }
+    EXPECT_EQ(4000, value);
+    EXPECT_TRUE(mutex.tryLock());
+    mutex.unlock();
+}
+
+TEST(ExecutionTest, StackSizeClasses)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    auto deepFunc = [](CoroContext<int>::Ptr ctx)->int {
+        //needs more than the small stack class
+        volatile char buffer[128*1024];
+        for (size_t i = 0; i < sizeof(buffer); i += 4096)
+        {
+            buffer[i] = (char)i;
+        }
+        return ctx->set((int)sizeof(buffer));
+    };
+    EXPECT_LT(StackTraits::classSize(StackSizeClass::Small), StackTraits::classSize(StackSizeClass::Large));
+    
+    IThreadContext<int>::Ptr small = dispatcher.post(StackSizeClass::Small, [](CoroContext<int>::Ptr ctx)->int {
+        return ctx->set(1);
+    });
+    IThreadContext<int>::Ptr large = dispatcher.post(StackSizeClass::Large, 0, false, deepFunc);
+    EXPECT_EQ(1, small->get());
+    EXPECT_EQ(128*1024, large->get());
+    
+    IThreadContext<int>::Ptr chain = dispatcher.postFirst(StackSizeClass::Small, [](CoroContext<int>::Ptr ctx)->int {
+        return ctx->set(2);
+    })->then(StackSizeClass::Large, deepFunc)->end();
+    EXPECT_EQ(2, chain->getAt<int>(0));
+    EXPECT_EQ(128*1024, chain->get());
+}
+
 TEST(PromiseTest, GetFutureFromCoroutine)
 {
     Dispatcher& dispatcher = DispatcherSingleton::instance();
@@ -539,6 +2753,34 @@ TEST(PromiseTest, BufferedFuture)
     EXPECT_EQ(validate, v);
 }
 
+TEST(PromiseTest, BufferedFutureBulkAccess)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    IThreadContext<Buffer<int>>::Ptr ctx = dispatcher.post<Buffer<int>>([](ICoroContext<Buffer<int>>::Ptr ctx)->int{
+        for (int i = 0; i < 10; ++i)
+        {
+            std::vector<int> batch(10);
+            std::iota(batch.begin(), batch.end(), i * 10);
+            ctx->pushMany(std::move(batch));
+            ctx->yield();
+        }
+        return ctx->closeBuffer();
+    });
+    std::vector<int> values;
+    bool isBufferClosed = false;
+    size_t maxBatch = 0;
+    while (!isBufferClosed)
+    {
+        size_t num = ctx->pullMany(values, 25, isBufferClosed);
+        EXPECT_LE(num, 25u);
+        maxBatch = std::max(maxBatch, num);
+    }
+    EXPECT_GT(maxBatch, 1u);
+    std::vector<int> expected(100);
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT_EQ(expected, values);
+}
+
 TEST(PromiseTest, GetFutureReference)
 {
     Dispatcher& dispatcher = DispatcherSingleton::instance();
@@ -595,6 +2837,43 @@ TEST(PromiseTest, GetPreviousFutures)
     EXPECT_STREQ("future", ctx->getAt<std::string>(2).c_str());
 }
 
+TEST(PromiseTest, ReadyFutureFastPath)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    
+    //values which are already set are read without waiting
+    Promise<std::string> promise;
+    promise.set(std::string("ready"));
+    ThreadFuture<std::string>::Ptr future = promise.getIThreadFuture();
+    EXPECT_STREQ("ready", future->getRef().c_str());
+    EXPECT_STREQ("ready", future->get().c_str());
+    EXPECT_THROW(future->get(), FutureAlreadyRetrievedException);
+    EXPECT_THROW(future->getRef(), FutureAlreadyRetrievedException);
+    
+    //exceptions are still rethrown on every read
+    Promise<int> failed;
+    failed.setException(std::make_exception_ptr(std::runtime_error("failed")));
+    EXPECT_THROW(failed.getIThreadFuture()->getRef(), std::runtime_error);
+    EXPECT_THROW(failed.getIThreadFuture()->get(), std::runtime_error);
+    EXPECT_THROW(failed.getIThreadFuture()->get(), std::runtime_error);
+    
+    //coroutines reading the completed links of a chain
+    IThreadContext<int>::Ptr ctx = dispatcher.post([](ICoroContext<int>::Ptr ctx)->int {
+        ICoroContext<double>::Ptr chain = ctx->postFirst([](ICoroContext<int>::Ptr ctx)->int {
+            return ctx->set(55);
+        })->then<double>([](ICoroContext<double>::Ptr ctx)->int {
+            return ctx->set(ctx->getPrevRef<int>() + 0.5);
+        })->end();
+        chain->wait(ctx);
+        EXPECT_EQ(55, chain->getRefAt<int>(0, ctx));
+        EXPECT_EQ(55, chain->getAt<int>(0, ctx));
+        EXPECT_THROW(chain->getAt<int>(0, ctx), FutureAlreadyRetrievedException);
+        EXPECT_DOUBLE_EQ(55.5, chain->getRef(ctx));
+        return ctx->set((int)chain->get(ctx));
+    });
+    EXPECT_EQ(55, ctx->get());
+}
+
 TEST(PromiseTest, BrokenPromiseInAsyncIo)
 {
     Dispatcher& dispatcher = DispatcherSingleton::instance();
@@ -690,12 +2969,12 @@ TEST(PromiseTest, FutureTimeout)
 TEST(PromiseTest, FutureWithoutTimeout)
 {
     Dispatcher& dispatcher = DispatcherSingleton::instance();
+    auto start = std::chrono::high_resolution_clock::now();
     IThreadContext<int>::Ptr ctx = dispatcher.post([](ICoroContext<int>::Ptr ctx)->int{
         ctx->sleep(ms(100));
         return 0;
     });
     
-    auto start = std::chrono::high_resolution_clock::now();
     std::future_status status = ctx->waitFor(ms(300)); //block until value is available or 300ms have expired
     auto end = std::chrono::high_resolution_clock::now();
     
@@ -706,6 +2985,295 @@ TEST(PromiseTest, FutureWithoutTimeout)
     EXPECT_EQ(status, std::future_status::ready);
 }
 
+TEST(PromiseTest, SingleShotPromiseWithManyWaiters)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    Promise<int> promise;
+    ThreadFuturePtr<int> future = promise.getIThreadFuture();
+    EXPECT_EQ(std::future_status::timeout, future->waitFor(ms(10)));
+    
+    //threads and coroutines wait on the same promise
+    std::vector<std::thread> threads;
+    std::atomic_int sum{0};
+    for (int i = 0; i < 3; ++i)
+    {
+        threads.emplace_back([&]() { sum += future->getRef(); });
+    }
+    IThreadContext<int>::Ptr ctx = dispatcher.post([&](ICoroContext<int>::Ptr ctx)->int{
+        return ctx->set(promise.getICoroFuture()->getRef(ctx));
+    });
+    std::this_thread::sleep_for(ms(10));
+    promise.set(7);
+    for (auto&& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(21, sum);
+    EXPECT_EQ(7, ctx->get());
+    EXPECT_EQ(std::future_status::ready, future->waitFor(ms(0)));
+    EXPECT_THROW(promise.set(8), PromiseAlreadySatisfiedException);
+    EXPECT_EQ(7, future->get());
+    EXPECT_THROW(future->get(), FutureAlreadyRetrievedException);
+}
+
+TEST(PromiseTest, BoundedChannel)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    
+    //producers park while the channel is full and consumers while it is empty
+    Channel<int> channel(3);
+    EXPECT_EQ(4u, channel.capacity());
+    std::vector<IThreadContext<int>::Ptr> producers;
+    for (int i = 0; i < 4; ++i)
+    {
+        producers.push_back(dispatcher.post([&channel, i](ICoroContext<int>::Ptr ctx)->int{
+            for (int j = 1; j <= 100; ++j)
+            {
+                channel.push(ctx, j);
+                EXPECT_LE(channel.size(), channel.capacity());
+            }
+            return 0;
+        }));
+    }
+    std::atomic_int sum{0};
+    std::vector<IThreadContext<int>::Ptr> consumers;
+    for (int i = 0; i < 2; ++i)
+    {
+        consumers.push_back(dispatcher.post([&](ICoroContext<int>::Ptr ctx)->int{
+            bool isClosed = false;
+            while (true)
+            {
+                int value = channel.pull(ctx, isClosed);
+                if (isClosed)
+                {
+                    break;
+                }
+                sum += value;
+            }
+            return 0;
+        }));
+    }
+    for (auto&& ctx : producers)
+    {
+        ctx->wait();
+    }
+    channel.close();
+    for (auto&& ctx : consumers)
+    {
+        ctx->wait();
+    }
+    EXPECT_EQ(4 * 5050, sum);
+    EXPECT_THROW(channel.push(1), BufferClosedException);
+    
+    //a thread producer is woken up by a coroutine consumer
+    Channel<std::string> spsc(2, Channel<std::string>::Mode::Spsc);
+    EXPECT_TRUE(spsc.tryPush("a"));
+    EXPECT_TRUE(spsc.tryPush("b"));
+    EXPECT_FALSE(spsc.tryPush("c"));
+    IThreadContext<std::string>::Ptr consumer = dispatcher.post<std::string>([&](ICoroContext<std::string>::Ptr ctx)->int{
+        std::string out;
+        bool isClosed = false;
+        for (std::string value = spsc.pull(ctx, isClosed); !isClosed; value = spsc.pull(ctx, isClosed))
+        {
+            out += value;
+        }
+        return ctx->set(std::move(out));
+    });
+    spsc.push("c");
+    spsc.push("d");
+    spsc.close();
+    EXPECT_EQ("abcd", consumer->get());
+}
+
+TEST(PromiseTest, Pipeline)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    
+    //parallel in-order stage followed by an unordered IO stage
+    PipelineStage parse(4, 4);
+    PipelineStage square(2, 2);
+    square.setOrder(PipelineStage::Order::Unordered);
+    square.setExecution(PipelineStage::Execution::Io);
+    Pipeline<std::string, int> pipeline = Pipeline<std::string>(dispatcher)
+        .stage<int>([](std::string&& str)->int { return std::stoi(str); }, parse)
+        .stage<int>([](int&& value)->int { return value * value; }, square);
+    std::mutex m;
+    std::vector<int> squares;
+    ThreadFuturePtr<int> done = pipeline.sink([&](int&& value) {
+        std::lock_guard<std::mutex> lock(m);
+        squares.push_back(value);
+    });
+    for (int i = 0; i < 200; ++i) {
+        pipeline.push(std::to_string(i));
+    }
+    pipeline.close();
+    EXPECT_EQ(0, done->get());
+    ASSERT_EQ(200u, squares.size());
+    std::sort(squares.begin(), squares.end());
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_EQ(i * i, squares[i]);
+    }
+    EXPECT_THROW(pipeline.push(std::string("1")), BufferClosedException);
+    
+    //results of a parallel stage keep the input order and a failing element is dropped
+    Pipeline<int> ordered(dispatcher);
+    std::vector<int> output;
+    ThreadFuturePtr<int> orderedDone = ordered
+        .stage<int>([](int&& value)->int {
+            if (value == 13) throw std::runtime_error("bad value");
+            return value;
+        }, PipelineStage(8, 4))
+        .sink([&output](int&& value) { output.push_back(value); }, PipelineStage(1)); //single consumer
+    dispatcher.post([&ordered](ICoroContext<int>::Ptr ctx)->int {
+        for (int i = 0; i < 100; ++i) {
+            ordered.push(ctx, i);
+        }
+        ordered.close();
+        return ctx->set(0);
+    });
+    EXPECT_THROW(orderedDone->get(), std::runtime_error);
+    std::vector<int> expected(100);
+    std::iota(expected.begin(), expected.end(), 0);
+    expected.erase(expected.begin() + 13);
+    EXPECT_EQ(expected, output);
+}
+
+TEST(PromiseTest, WhenAllAnyAndN)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    std::vector<Promise<int>> promises(4);
+    std::vector<ThreadFuturePtr<int>> futures;
+    for (auto&& promise : promises)
+    {
+        futures.push_back(promise.getIThreadFuture());
+    }
+    FuturePtr<int> all = whenAll(futures);
+    FuturePtr<size_t> any = whenAny(futures);
+    FuturePtr<std::vector<size_t>> two = whenN(futures, 2);
+    EXPECT_EQ(std::future_status::timeout, any->waitFor(ms(10)));
+    
+    //a coroutine waits for the first replica to answer
+    IThreadContext<int>::Ptr ctx = dispatcher.post([&](ICoroContext<int>::Ptr ctx)->int{
+        return ctx->set((int)any->get(ctx));
+    });
+    promises[2].set(20);
+    EXPECT_EQ(2, ctx->get());
+    EXPECT_EQ(std::future_status::timeout, two->waitFor(ms(10)));
+    promises[0].set(0);
+    EXPECT_EQ(std::vector<size_t>({2, 0}), two->get());
+    EXPECT_EQ(std::future_status::timeout, all->waitFor(ms(10)));
+    promises[3].set(30);
+    promises[1].terminate(); //broken promises count as ready
+    EXPECT_EQ(0, all->get());
+    EXPECT_EQ(20, futures[2]->get());
+    
+    //futures which are already ready complete the combinator right away
+    EXPECT_EQ(0u, whenAny(futures)->get());
+    EXPECT_EQ(0, whenAll(std::vector<ThreadFuturePtr<int>>())->get());
+    EXPECT_THROW(whenAny(std::vector<ThreadFuturePtr<int>>())->get(), BrokenPromiseException);
+}
+
+TEST(PromiseTest, OnReadyCallbacks)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    
+    //inline callbacks run in the producer
+    Promise<int> promise;
+    ThreadFuturePtr<int> future = promise.getIThreadFuture();
+    std::atomic_int numCalled{0};
+    future->onReady([&]() { ++numCalled; });
+    promise.getICoroFuture()->onReady([&]() { ++numCalled; });
+    EXPECT_EQ(0, numCalled);
+    promise.set(3);
+    EXPECT_EQ(2, numCalled);
+    future->onReady([&]() { ++numCalled; }); //already ready
+    EXPECT_EQ(3, numCalled);
+    
+    //callbacks posted to an IO queue
+    Promise<int> latch;
+    ThreadFuturePtr<int> done = latch.getIThreadFuture();
+    ThreadFuturePtr<int> io = dispatcher.postAsyncIo([](ThreadPromise<int>::Ptr promise)->int {
+        std::this_thread::sleep_for(ms(10));
+        return promise->set(5);
+    });
+    std::thread::id callbackThread;
+    dispatcher.postOnReady(io, 0, false, [&]() {
+        callbackThread = std::this_thread::get_id();
+        latch.set(io->getRef());
+    });
+    EXPECT_EQ(5, done->get());
+    EXPECT_NE(std::this_thread::get_id(), callbackThread);
+}
+
+TEST(PromiseTest, ThreadWaitersBlockOnFutures)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    auto threadCpuTime = []()->ms {
+        struct timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ms(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+    };
+    
+    //both with and without a spin phase, waiting threads sleep instead of polling
+    for (unsigned spinCount : {0u, 1000u})
+    {
+        ThreadTraits::blockingSpinCount() = spinCount;
+        ThreadContextPtr<int> ctx = dispatcher.post([](CoroContextPtr<int> ctx)->int {
+            ctx->sleep(ms(200));
+            return ctx->set(7);
+        });
+        ms start = threadCpuTime();
+        EXPECT_EQ(7, ctx->get());
+        EXPECT_LT((threadCpuTime() - start).count(), 50);
+        
+        Promise<int> promise;
+        ThreadFuturePtr<int> future = promise.getIThreadFuture();
+        EXPECT_EQ(std::future_status::timeout, future->waitFor(ms(100)));
+        promise.set(1);
+        EXPECT_EQ(std::future_status::ready, future->waitFor(ms(100)));
+    }
+    ThreadTraits::blockingSpinCount() = 0;
+}
+
+TEST(PromiseTest, SharedFutureManyConsumers)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    ThreadContextPtr<std::vector<int>> producer = dispatcher.post<std::vector<int>>([](CoroContextPtr<std::vector<int>> ctx)->int {
+        ctx->sleep(ms(50));
+        return ctx->set(std::vector<int>(1000, 3));
+    });
+    SharedFuture<std::vector<int>> shared = producer->getSharedFuture();
+    EXPECT_TRUE(shared.valid());
+    
+    //all the consumers see the single stored value
+    std::vector<ThreadContextPtr<const std::vector<int>*>> consumers;
+    for (int i = 0; i < 10; ++i)
+    {
+        consumers.push_back(dispatcher.post<const std::vector<int>*>([shared](CoroContextPtr<const std::vector<int>*> ctx)->int {
+            return ctx->set(&shared.get(ctx));
+        }));
+    }
+    const std::vector<int>* value = nullptr;
+    std::thread reader([&]() { value = &shared.get(); });
+    reader.join();
+    EXPECT_EQ(1000u, value->size());
+    for (auto&& consumer : consumers)
+    {
+        EXPECT_EQ(value, consumer->get());
+    }
+    EXPECT_EQ(value, &producer->getRef());
+    
+    //exceptions are rethrown to every consumer
+    Promise<int> promise;
+    SharedFuture<int> failed = promise.getSharedFuture();
+    SharedFuture<int> copy = failed;
+    EXPECT_EQ(std::future_status::timeout, copy.waitFor(ms(10)));
+    promise.setException(std::make_exception_ptr(std::runtime_error("failed")));
+    EXPECT_THROW(failed.get(), std::runtime_error);
+    EXPECT_THROW(copy.get(), std::runtime_error);
+    EXPECT_FALSE(SharedFuture<int>().valid());
+}
+
 TEST(PromiseTest, WaitForAllFutures)
 {
     Dispatcher& dispatcher = DispatcherSingleton::instance();
@@ -714,8 +3282,8 @@ TEST(PromiseTest, WaitForAllFutures)
         return 0;
     };
     
-    auto ctx = dispatcher.postFirst(func)->then(func)->then(func)->then(func)->end();
     auto start = std::chrono::high_resolution_clock::now();
+    auto ctx = dispatcher.postFirst(func)->then(func)->then(func)->then(func)->end();
     ctx->waitAll(); //block until value is available or 4x50ms has expired
     auto end = std::chrono::high_resolution_clock::now();
     
@@ -798,6 +3366,330 @@ TEST(MutexTest, SignalWithConditionVariable)
     EXPECT_TRUE((6 == v[1] || 7 == v[1]) && (6 == v[2] || 7 == v[2]));
 }
 
+TEST(MutexTest, ParkedCoroutinesDoNotStallQueue)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    Mutex m;
+    ConditionVariable cv;
+    bool ready = false;
+    std::atomic_int numWoken{0};
+    
+    //park a large number of coroutines on the same queue
+    for (int i = 0; i < 500; ++i)
+    {
+        dispatcher.post(0, false, [&](ICoroContext<int>::Ptr ctx)->int{
+            Mutex::Guard guard(ctx, m);
+            cv.wait(ctx, m, [&]()->bool{ return ready; });
+            ++numWoken;
+            return 0;
+        });
+    }
+    
+    //a runnable coroutine on the same queue must still make progress
+    int numYields = 0;
+    dispatcher.post(0, false, [&](ICoroContext<int>::Ptr ctx)->int{
+        for (; numYields < 1000; ++numYields)
+        {
+            ctx->yield();
+        }
+        return ctx->set(0);
+    })->get();
+    EXPECT_EQ(1000, numYields);
+    EXPECT_EQ(0, numWoken);
+    
+    {
+        Mutex::Guard guard(m);
+        ready = true;
+    }
+    cv.notifyAll();
+    dispatcher.drain();
+    
+    EXPECT_EQ(500, numWoken);
+    EXPECT_EQ((size_t)0, dispatcher.size());
+}
+
+TEST(MutexTest, ThreadWaitersBlockOnConditionVariable)
+{
+    Mutex m;
+    ConditionVariable cv;
+    bool ready = false;
+    auto threadCpuTime = []()->ms {
+        struct timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ms(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+    };
+
+    //timed waits sleep for the whole duration
+    ms waitCpuTime;
+    std::thread timedWaiter([&]() {
+        ms start = threadCpuTime();
+        Mutex::Guard guard(m);
+        EXPECT_FALSE(cv.waitFor(m, ms(200), [&]()->bool{ return ready; }));
+        waitCpuTime = threadCpuTime() - start;
+    });
+    timedWaiter.join();
+    EXPECT_LT(waitCpuTime.count(), 50);
+
+    //notifications wake up sleeping threads
+    std::atomic_int numWoken{0};
+    std::vector<std::thread> waiters;
+    for (int i = 0; i < 3; ++i)
+    {
+        waiters.emplace_back([&]() {
+            Mutex::Guard guard(m);
+            cv.wait(m, [&]()->bool{ return ready; });
+            ++numWoken;
+        });
+    }
+    std::this_thread::sleep_for(ms(50));
+    EXPECT_EQ(0, numWoken);
+    {
+        Mutex::Guard guard(m);
+        ready = true;
+    }
+    cv.notifyAll();
+    for (auto&& waiter : waiters)
+    {
+        waiter.join();
+    }
+    EXPECT_EQ(3, numWoken);
+}
+
+TEST(MutexTest, SharedMutexReadersAndWriters)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    SharedMutex m;
+
+    //readers share the mutex
+    std::atomic_int numReaders{0};
+    std::atomic_int maxReaders{0};
+    std::vector<IThreadContext<int>::Ptr> contexts;
+    for (int i = 0; i < 10; ++i)
+    {
+        contexts.push_back(dispatcher.post(0, false, [&](ICoroContext<int>::Ptr ctx)->int{
+            SharedMutex::SharedGuard guard(ctx, m);
+            ++numReaders;
+            for (int j = 0; (j < 10000) && (numReaders < 10); ++j)
+            {
+                ctx->yield(); //wait for the other readers
+            }
+            int num = numReaders;
+            for (int cur = maxReaders; num > cur && !maxReaders.compare_exchange_weak(cur, num);) {}
+            return 0;
+        }));
+    }
+    for (auto&& ctx : contexts)
+    {
+        ctx->wait();
+    }
+    EXPECT_EQ(10, maxReaders);
+
+    //a waiting writer blocks new readers
+    m.lockShared();
+    IThreadContext<int>::Ptr writer = dispatcher.post([&](ICoroContext<int>::Ptr ctx)->int{
+        SharedMutex::Guard guard(ctx, m);
+        return ctx->set(1);
+    });
+    while (m.tryLockShared())
+    {
+        m.unlockShared(); //writer is not queued yet
+        std::this_thread::sleep_for(ms(1));
+    }
+    EXPECT_FALSE(m.tryLock());
+    m.unlockShared();
+    EXPECT_EQ(1, writer->get());
+
+    //writers are exclusive between coroutines and threads
+    int value = 0;
+    contexts.clear();
+    for (int i = 0; i < 20; ++i)
+    {
+        contexts.push_back(dispatcher.post([&](ICoroContext<int>::Ptr ctx)->int{
+            for (int j = 0; j < 50; ++j)
+            {
+                if (j % 5 == 0)
+                {
+                    SharedMutex::Guard guard(ctx, m);
+                    int tmp = value;
+                    ctx->yield();
+                    value = tmp + 1;
+                }
+                else
+                {
+                    SharedMutex::SharedGuard guard(ctx, m);
+                    ctx->yield();
+                }
+            }
+            return 0;
+        }));
+    }
+    std::thread thread([&]() {
+        for (int j = 0; j < 100; ++j)
+        {
+            SharedMutex::Guard guard(m);
+            ++value;
+        }
+    });
+    thread.join();
+    for (auto&& ctx : contexts)
+    {
+        ctx->wait();
+    }
+    EXPECT_EQ(300, value);
+    SharedMutex::Guard guard(m, true);
+    EXPECT_TRUE(guard.ownsLock());
+}
+
+TEST(MutexTest, SemaphoreLimitsConcurrency)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    Semaphore sem(3);
+
+    //no more than 3 coroutines run the guarded section at once
+    std::atomic_int numRunning{0};
+    std::atomic_int maxRunning{0};
+    std::vector<IThreadContext<int>::Ptr> contexts;
+    for (int i = 0; i < 20; ++i)
+    {
+        contexts.push_back(dispatcher.post([&](ICoroContext<int>::Ptr ctx)->int{
+            Semaphore::Guard guard(ctx, sem);
+            int num = ++numRunning;
+            for (int cur = maxRunning; num > cur && !maxRunning.compare_exchange_weak(cur, num);) {}
+            for (int j = 0; j < 10; ++j)
+            {
+                ctx->yield();
+            }
+            --numRunning;
+            return 0;
+        }));
+    }
+    for (auto&& ctx : contexts)
+    {
+        ctx->wait();
+    }
+    EXPECT_LE(maxRunning, 3);
+    EXPECT_EQ(3u, sem.count());
+
+    //timed acquire gives up when no permits are released
+    sem.acquire(3);
+    EXPECT_FALSE(sem.tryAcquire());
+    EXPECT_FALSE(sem.tryAcquireFor(ms(20)));
+    IThreadContext<int>::Ptr timedOut = dispatcher.post([&](ICoroContext<int>::Ptr ctx)->int{
+        return ctx->set(sem.tryAcquireFor(ctx, ms(20)) ? 1 : 0);
+    });
+    EXPECT_EQ(0, timedOut->get());
+
+    //waiters are granted the released permits
+    IThreadContext<int>::Ptr coro = dispatcher.post([&](ICoroContext<int>::Ptr ctx)->int{
+        sem.acquire(ctx, 2);
+        return ctx->set(1);
+    });
+    std::thread thread([&]() {
+        EXPECT_TRUE(sem.tryAcquireFor(std::chrono::seconds(10)));
+    });
+    std::this_thread::sleep_for(ms(10));
+    sem.release(3);
+    EXPECT_EQ(1, coro->get());
+    thread.join();
+    EXPECT_EQ(0u, sem.count());
+    sem.release(3);
+    EXPECT_EQ(3u, sem.count());
+}
+
+TEST(MutexTest, SpinLocksUnderContention)
+{
+    SpinLock spinlock;
+    TicketSpinLock ticketlock;
+    int value = 0;
+    int ticketValue = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([&]() {
+            for (int j = 0; j < 10000; ++j)
+            {
+                {
+                    SpinLock::Guard guard(spinlock);
+                    ++value;
+                }
+                TicketSpinLock::Guard guard(ticketlock);
+                ++ticketValue;
+            }
+        });
+    }
+    for (auto&& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(40000, value);
+    EXPECT_EQ(40000, ticketValue);
+    EXPECT_TRUE(spinlock.tryLock());
+    EXPECT_FALSE(spinlock.tryLock());
+    spinlock.unlock();
+    EXPECT_TRUE(ticketlock.tryLock());
+    EXPECT_FALSE(ticketlock.tryLock());
+    ticketlock.unlock();
+}
+
+TEST(MutexTest, LatchAndBarrier)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+
+    //the latch opens once every coroutine has counted down
+    Latch latch(10);
+    std::atomic_int numDone{0};
+    for (int i = 0; i < 10; ++i)
+    {
+        dispatcher.post([&](ICoroContext<int>::Ptr ctx)->int{
+            ctx->yield();
+            ++numDone;
+            latch.countDown();
+            return 0;
+        });
+    }
+    IThreadContext<int>::Ptr waiter = dispatcher.post([&](ICoroContext<int>::Ptr ctx)->int{
+        latch.wait(ctx);
+        return ctx->set((int)numDone);
+    });
+    latch.wait();
+    EXPECT_TRUE(latch.tryWait());
+    EXPECT_EQ(10, numDone);
+    EXPECT_EQ(10, waiter->get());
+
+    //no participant starts a phase before all have finished the previous one
+    Barrier barrier(6);
+    std::atomic_int arrivals{0};
+    std::atomic_bool isOutOfPhase{false};
+    std::vector<IThreadContext<int>::Ptr> contexts;
+    for (int i = 0; i < 5; ++i)
+    {
+        contexts.push_back(dispatcher.post([&](ICoroContext<int>::Ptr ctx)->int{
+            for (int phase = 0; phase < 20; ++phase)
+            {
+                ++arrivals;
+                barrier.arriveAndWait(ctx);
+                if (arrivals < (phase + 1) * 6)
+                {
+                    isOutOfPhase = true;
+                }
+            }
+            return 0;
+        }));
+    }
+    for (int phase = 0; phase < 20; ++phase)
+    {
+        ++arrivals;
+        barrier.arriveAndWait();
+    }
+    for (auto&& ctx : contexts)
+    {
+        ctx->wait();
+    }
+    EXPECT_FALSE(isOutOfPhase);
+    EXPECT_EQ(120, arrivals);
+    EXPECT_EQ(20u, barrier.phase());
+}
+
 TEST(StressTest, ParallelFibonacciSerie)
 {
     Dispatcher& dispatcher = DispatcherSingleton::instance();
@@ -824,6 +3716,40 @@ TEST(StressTest, RecursiveFibonacciSerie)
     EXPECT_EQ((size_t)fibValues[fibInput], tctx->get());
 }
 
+TEST(StressTest, ConcurrentPosting)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    dispatcher.drain(); //the previous test may still be unwinding its coroutines
+    dispatcher.resetStats();
+    std::atomic_int count{0};
+    auto func = [](CoroContext<int>::Ptr, std::atomic_int& c)->int {
+        ++c;
+        return 0;
+    };
+    
+    //Several threads posting to the same queues at once
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; ++t)
+    {
+        producers.emplace_back([&, t]() {
+            for (int i = 0; i < 500; ++i)
+            {
+                dispatcher.post((i % 2) ? t : (int)IQueue::QueueId::Any, (i % 10) == 0, func, count);
+            }
+        });
+    }
+    for (auto&& producer : producers)
+    {
+        producer.join();
+    }
+    dispatcher.drain();
+    
+    EXPECT_EQ(2000, count);
+    EXPECT_EQ((size_t)2000, dispatcher.stats(IQueue::QueueType::Coro).postedCount());
+    EXPECT_EQ((size_t)2000, dispatcher.stats(IQueue::QueueType::Coro).completedCount());
+    EXPECT_EQ((size_t)0, dispatcher.size());
+}
+
 TEST(StressTest, AsyncIo)
 {
     std::mutex m;
@@ -846,6 +3772,78 @@ TEST(StressTest, AsyncIo)
     EXPECT_EQ(10000, s.size()); //all elements unique
 }
 
+TEST(StressTest, TimedWaitsRacingSet)
+{
+    //Waiters give up on each promise at about the time it gets set, then move on to the next one.
+    //A waiter which timed out must never receive the signal later, during its next wait, since that
+    //wait would return before its own promise is set.
+    const int numRounds = 300;
+    const int numWaiters = 8;
+    std::vector<Promise<int>> promises(numRounds);
+    auto setAll = [&promises, numRounds]()
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < numRounds; ++i)
+        {
+            auto time = start + std::chrono::microseconds(1000 * i + (i % 7) * 100);
+            while (std::chrono::steady_clock::now() < time);
+            promises[i].set(i + 1);
+        }
+    };
+    
+    //thread waiters
+    std::atomic_int numErrors{0};
+    std::vector<std::thread> waiters;
+    for (int w = 0; w < numWaiters; ++w)
+    {
+        waiters.emplace_back([&promises, &numErrors, numRounds]()
+        {
+            for (int i = 0; i < numRounds; ++i)
+            {
+                ThreadFuture<int>::Ptr future = promises[i].getIThreadFuture();
+                future->waitFor(ms(1));
+                if (future->getRef() != i + 1)
+                {
+                    ++numErrors;
+                }
+            }
+        });
+    }
+    std::thread setter(setAll);
+    setter.join();
+    for (auto&& waiter : waiters)
+    {
+        waiter.join();
+    }
+    EXPECT_EQ(0, numErrors);
+    
+    //coroutine waiters
+    Configuration config;
+    config.setNumCoroutineThreads(numWaiters);
+    config.setNumIoThreads(1);
+    Dispatcher dispatcher(config);
+    std::vector<Promise<int>> coroPromises(numRounds);
+    promises.swap(coroPromises);
+    for (int w = 0; w < numWaiters; ++w)
+    {
+        dispatcher.post(w, false, [&promises, &numErrors, numRounds](CoroContext<int>::Ptr ctx)->int {
+            for (int i = 0; i < numRounds; ++i)
+            {
+                CoroFuture<int>::Ptr future = promises[i].getICoroFuture();
+                future->waitFor(ctx, ms(1));
+                if (future->getRef(ctx) != i + 1)
+                {
+                    ++numErrors;
+                }
+            }
+            return ctx->set(0);
+        });
+    }
+    setAll();
+    dispatcher.drain();
+    EXPECT_EQ(0, numErrors);
+}
+
 TEST(StressTest, AsyncIoAnyQueue)
 {
     std::mutex m;
@@ -977,6 +3975,283 @@ TEST(ForEachTest, LargeBatchFromCoroutine)
     })->get();
 }
 
+TEST(ForEachTest, GrainSize)
+{
+    size_t num = 1003;
+    std::vector<int> start(num);
+    for (size_t i = 0; i < num; ++i) {
+        start[i] = (int)i;
+    }
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    
+    //fixed chunks, with a partial last chunk
+    std::vector<int> results = dispatcher.forEach<int>(start.begin(), start.end(), [](int val)->int {
+        return val*2;
+    }, GrainSize::fixed(100))->get();
+    ASSERT_EQ(num, results.size());
+    for (size_t i = 0; i < num; ++i) {
+        EXPECT_EQ(start[i]*2, results[i]);
+    }
+    
+    //adaptive chunks from a coroutine
+    results = dispatcher.post<std::vector<int>>([&start, num](CoroContext<std::vector<int>>::Ptr ctx)->int {
+        return ctx->set(ctx->forEach<int>(start.begin(), num, [](int val)->int {
+            return val+1;
+        }, GrainSize::adaptive(std::chrono::microseconds(50)))->get(ctx));
+    })->get();
+    ASSERT_EQ(num, results.size());
+    for (size_t i = 0; i < num; ++i) {
+        EXPECT_EQ(start[i]+1, results[i]);
+    }
+    
+    //empty range
+    EXPECT_TRUE(dispatcher.forEach<int>(start.begin(), (size_t)0, [](int val)->int {
+        return val;
+    }, GrainSize::adaptive())->get().empty());
+}
+
+TEST(ForEachTest, DynamicBatch)
+{
+    size_t num = 1003;
+    std::vector<int> start(num);
+    for (size_t i = 0; i < num; ++i) {
+        start[i] = (int)i;
+    }
+    auto merge = [](const std::vector<std::vector<int>>& chunks)->std::vector<int> {
+        std::vector<int> merged;
+        for (auto&& v : chunks) {
+            merged.insert(merged.end(), v.begin(), v.end());
+        }
+        return merged;
+    };
+    
+    //fixed chunks with skewed costs
+    std::vector<std::vector<int>> results = DispatcherSingleton::instance().forEachBatch<int>(start.begin(), start.end(),
+        [](int val)->int {
+        if (val < 10) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1)); //expensive head of the range
+        }
+        return val*2;
+    }, GrainSize::fixed(7))->get();
+    EXPECT_EQ((num+6)/7, results.size());
+    std::vector<int> merged = merge(results);
+    ASSERT_EQ(num, merged.size());
+    for (size_t i = 0; i < num; ++i) {
+        EXPECT_EQ(start[i]*2, merged[i]);
+    }
+    
+    //adaptive chunks from a coroutine
+    results = DispatcherSingleton::instance().post<std::vector<std::vector<int>>>([&start, num](CoroContext<std::vector<std::vector<int>>>::Ptr ctx)->int {
+        return ctx->set(ctx->forEachBatch<int>(start.begin(), num, [](int val)->int {
+            return val+1;
+        }, GrainSize::adaptive())->get(ctx));
+    })->get();
+    EXPECT_LE(DispatcherSingleton::instance().getNumCoroutineThreads(), results.size());
+    merged = merge(results);
+    ASSERT_EQ(num, merged.size());
+    for (size_t i = 0; i < num; ++i) {
+        EXPECT_EQ(start[i]+1, merged[i]);
+    }
+}
+
+TEST(ForEachTest, BatchWithCallableTypes)
+{
+    size_t num = 1001;
+    std::vector<int> start(num);
+    for (size_t i = 0; i < num; ++i) {
+        start[i] = (int)i;
+    }
+    //a plain functor is carried by type down to the batch loop
+    struct Scale
+    {
+        int operator()(const int& val) const { return val*_factor; }
+        int _factor;
+    };
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    std::vector<std::vector<int>> results = dispatcher.forEachBatch<int>(start.begin(), start.end(), Scale{3})->get();
+    size_t i = 0;
+    for (auto&& chunk : results) {
+        for (auto&& val : chunk) {
+            EXPECT_EQ(start[i++]*3, val);
+        }
+    }
+    EXPECT_EQ(num, i);
+    results = dispatcher.forEachBatch<int>(start.begin(), num, Scale{2}, GrainSize::fixed(10))->get();
+    EXPECT_EQ((num+9)/10, results.size());
+    EXPECT_EQ(start[num-1]*2, results.back().back());
+    
+    //both callables deduced
+    std::map<int, int> parity = dispatcher.mapReduceBatch<int, int, int>(start.begin(), num,
+        [](const int& val)->std::vector<std::pair<int, int>> { return {{val % 2, 1}}; },
+        [](std::pair<int, std::vector<int>>&& input)->std::pair<int, int> {
+            return {input.first, (int)input.second.size()};
+        })->get();
+    ASSERT_EQ(2u, parity.size());
+    EXPECT_EQ(501, parity[0]);
+    EXPECT_EQ(500, parity[1]);
+    
+    //small functors are held inline and larger ones spill over to the heap
+    std::array<int, 16> big{};
+    big[15] = 7;
+    Function<int(), 16> small([]()->int { return 1; });
+    Function<int(), 16> spilled([big]()->int { return big[15]; });
+    EXPECT_EQ(1, small());
+    EXPECT_EQ(7, spilled());
+    Function<int(), 16> moved(std::move(spilled));
+    EXPECT_EQ(7, moved());
+}
+
+TEST(ForEachTest, Kernel)
+{
+    size_t num = 1003;
+    std::vector<float> input(num);
+    for (size_t i = 0; i < num; ++i) {
+        input[i] = (float)i;
+    }
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    
+    //outputs are written in place and every chunk but the last spans whole 64-byte vectors
+    std::vector<float> output(num);
+    std::mutex mutex;
+    std::vector<std::pair<size_t, size_t>> chunks;
+    dispatcher.forEachKernel(input.data(), num, output.data(), [&](Span<const float> in, Span<float> out) {
+        ASSERT_EQ(in.size(), out.size());
+        for (size_t i = 0; i < in.size(); ++i) {
+            out[i] = in[i] * 2.0f + 1.0f;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        chunks.emplace_back(in.data() - input.data(), in.size());
+    })->get();
+    for (size_t i = 0; i < num; ++i) {
+        EXPECT_EQ(input[i] * 2.0f + 1.0f, output[i]);
+    }
+    std::sort(chunks.begin(), chunks.end());
+    EXPECT_LT(1u, chunks.size());
+    size_t next = 0;
+    for (auto&& chunk : chunks) {
+        EXPECT_EQ(next, chunk.first);
+        EXPECT_EQ(0u, (chunk.first * sizeof(float)) % 64);
+        next += chunk.second;
+    }
+    EXPECT_EQ(num, next);
+    
+    //the output vector is preallocated when called from a coroutine
+    std::vector<double> widened = dispatcher.post<std::vector<double>>([&input, num](CoroContext<std::vector<double>>::Ptr ctx)->int {
+        return ctx->set(ctx->forEachKernel<double>(input.data(), num, [](Span<const float> in, Span<double> out) {
+            for (size_t i = 0; i < in.size(); ++i) {
+                out[i] = in[i];
+            }
+        })->get(ctx));
+    })->get();
+    ASSERT_EQ(num, widened.size());
+    EXPECT_EQ(1002.0, widened.back());
+    
+    //empty ranges complete right away and exceptions surface in get()
+    EXPECT_TRUE(dispatcher.forEachKernel<double>(input.data(), 0, [](Span<const float>, Span<double>) {})->get().empty());
+    EXPECT_THROW(dispatcher.forEachKernel(input.data(), num, output.data(), [](Span<const float> in, Span<float>) {
+        if (in[0] == 0.0f) throw std::runtime_error("bad chunk");
+    })->get(), std::runtime_error);
+}
+
+TEST(ForEachTest, ReduceAndScan)
+{
+    size_t num = 1003;
+    std::vector<int> start(num);
+    for (size_t i = 0; i < num; ++i) {
+        start[i] = (int)i + 1;
+    }
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    auto plus = [](const long& a, const long& b)->long { return a + b; };
+    
+    EXPECT_EQ(10 + 503506L, dispatcher.reduce<long>(start.begin(), start.end(), 10, plus)->get());
+    EXPECT_EQ(10L, dispatcher.reduce<long>(start.begin(), (size_t)0, 10, plus)->get());
+    EXPECT_EQ(2*503506L, dispatcher.transformReduce<long>(start.begin(), start.size(), 0, plus,
+        [](int val)->long {
+        return 2*val;
+    })->get());
+    
+    //non-commutative operation keeps the range order
+    std::vector<std::string> words{"a","b","c","d","e","f","g"};
+    EXPECT_EQ("0abcdefg", dispatcher.reduce<std::string>(words.begin(), words.end(), "0",
+        [](const std::string& a, const std::string& b)->std::string {
+        return a + b;
+    })->get());
+    
+    std::vector<long> inclusive = dispatcher.inclusiveScan<long>(start.begin(), start.end(), plus)->get();
+    std::vector<long> exclusive = dispatcher.post<std::vector<long>>([&](CoroContext<std::vector<long>>::Ptr ctx)->int {
+        return ctx->set(ctx->exclusiveScan<long>(start.begin(), start.size(), 5, plus)->get(ctx));
+    })->get();
+    ASSERT_EQ(num, inclusive.size());
+    ASSERT_EQ(num, exclusive.size());
+    long sum = 0;
+    for (size_t i = 0; i < num; ++i) {
+        EXPECT_EQ(5 + sum, exclusive[i]);
+        sum += start[i];
+        EXPECT_EQ(sum, inclusive[i]);
+    }
+}
+
+TEST(ForEachTest, ParallelSort)
+{
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> dist(0, 999);
+    std::vector<int> values(100003);
+    for (auto&& v : values) {
+        v = dist(gen);
+    }
+    std::vector<int> expected = values;
+    std::sort(expected.begin(), expected.end(), std::greater<int>());
+    DispatcherSingleton::instance().sort(values.begin(), values.end(), std::greater<int>())->get();
+    EXPECT_EQ(expected, values);
+    
+    //equal keys keep their original order
+    std::vector<std::pair<int, size_t>> records(50000);
+    for (size_t i = 0; i < records.size(); ++i) {
+        records[i] = {dist(gen) % 10, i};
+    }
+    auto byKey = [](const std::pair<int, size_t>& a, const std::pair<int, size_t>& b)->bool {
+        return a.first < b.first;
+    };
+    DispatcherSingleton::instance().post([&](CoroContext<int>::Ptr ctx)->int {
+        ctx->stableSort(records.begin(), records.end(), byKey)->get(ctx);
+        return ctx->set(0);
+    })->get();
+    for (size_t i = 1; i < records.size(); ++i) {
+        ASSERT_TRUE((records[i-1].first < records[i].first) ||
+                    ((records[i-1].first == records[i].first) && (records[i-1].second < records[i].second)));
+    }
+}
+
+TEST(ForEachTest, OutputIterator)
+{
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    std::vector<int> input(10000);
+    std::iota(input.begin(), input.end(), 0);
+    std::vector<double> output(input.size());
+    auto func = [](const int& value)->double
+    {
+        return value * 0.5;
+    };
+    EXPECT_EQ(0, dispatcher.forEach<double>(input.cbegin(), input.cend(), output.begin(), func)->get());
+    for (size_t i = 0; i < input.size(); ++i) {
+        EXPECT_EQ(i * 0.5, output[i]);
+    }
+    
+    //write through a raw pointer from within a coroutine
+    std::vector<double> raw(input.size());
+    dispatcher.post([&](ICoroContext<int>::Ptr ctx)->int {
+        return ctx->set(ctx->forEach<double>(input.cbegin(), input.size(), raw.data(), func)->get(ctx));
+    })->get();
+    EXPECT_EQ(output, raw);
+    
+    //the first exception is reported once all slices are done
+    EXPECT_THROW(dispatcher.forEach<double>(input.cbegin(), input.cend(), output.begin(), [](const int& value)->double
+    {
+        if (value == 5000) throw std::runtime_error("bad value");
+        return value;
+    })->get(), std::runtime_error);
+}
+
 TEST(MapReduce, OccuranceCount)
 {
     //count the number of times a word of a specific length occurs
@@ -1095,6 +4370,141 @@ TEST(MapReduce, WordLengthFromCoroutine)
     })->get();
 }
 
+TEST(MapReduce, Partitioned)
+{
+    //count the number of times each string occurs
+    std::vector<std::vector<std::string>> input = {
+        {"a", "b", "aa", "aaa", "cccc" },
+        {"bb", "bbb", "bbbb", "a", "bb"},
+        {"aaa", "bb", "eee", "cccc", "d", "ddddd"},
+        {"eee", "d", "a" }
+    };
+    auto mapper = [](const std::vector<std::string>& input)->std::vector<std::pair<std::string, size_t>>
+    {
+        std::vector<std::pair<std::string, size_t>> out;
+        for (auto&& i : input) {
+            out.push_back({i, 1});
+        }
+        return out;
+    };
+    auto reducer = [](std::pair<std::string, std::vector<size_t>>&& input)->std::pair<std::string, size_t>
+    {
+        size_t sum = 0;
+        for (auto&& i : input.second) {
+            sum += i;
+        }
+        return {std::move(input.first), sum};
+    };
+    std::map<std::string, size_t> expected{{"a",3},{"aa",1},{"aaa",2},{"b",1},{"bb",3},{"bbb",1},
+                                           {"bbbb",1},{"cccc",2},{"d",2},{"ddddd",1},{"eee",2}};
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    
+    std::unordered_map<std::string, size_t> unordered = dispatcher.mapReducePartitioned<std::string, size_t, size_t>
+        (input.begin(), input.end(), mapper, reducer)->get();
+    std::map<std::string, size_t> sorted(unordered.begin(), unordered.end());
+    EXPECT_EQ(expected, sorted);
+    
+    std::map<std::string, size_t> ordered = dispatcher.mapReducePartitioned<std::string, size_t, size_t, std::map<std::string, size_t>>
+        (input.begin(), input.size(), mapper, reducer)->get();
+    EXPECT_EQ(expected, ordered);
+    
+    using Flat = std::vector<std::pair<std::string, size_t>>;
+    Flat flat = dispatcher.post<Flat>([&](CoroContext<Flat>::Ptr ctx)->int
+    {
+        return ctx->set(ctx->mapReducePartitioned<std::string, size_t, size_t, Flat>
+            (input.begin(), input.size(), mapper, reducer)->get(ctx));
+    })->get();
+    std::sort(flat.begin(), flat.end());
+    EXPECT_EQ(Flat(expected.begin(), expected.end()), flat);
+}
+
+TEST(MapReduce, PartitionedWithCombiner)
+{
+    //count words with the counts pre-aggregated inside each mapper
+    std::vector<std::string> input;
+    for (int i = 0; i < 1000; ++i) {
+        input.push_back((i % 3) ? "odd" : "even");
+    }
+    size_t numMappers = DispatcherSingleton::instance().getNumCoroutineThreads();
+    size_t maxValues = 0;
+    std::mutex m;
+    std::map<std::string, size_t> result = DispatcherSingleton::instance().mapReducePartitioned<std::string, size_t, size_t, std::map<std::string, size_t>>
+        (input.begin(), input.end(),
+        //mapper
+        [](const std::string& word)->std::vector<std::pair<std::string, size_t>>
+        {
+            return {{word, 1}};
+        },
+        //combiner
+        [](size_t&& lhs, size_t&& rhs)->size_t
+        {
+            return lhs + rhs;
+        },
+        //reducer
+        [&maxValues, &m](std::pair<std::string, std::vector<size_t>>&& input)->std::pair<std::string, size_t>
+        {
+            {
+                std::lock_guard<std::mutex> lock(m); //reducers run in parallel
+                maxValues = std::max(maxValues, input.second.size());
+            }
+            size_t sum = 0;
+            for (auto&& i : input.second) {
+                sum += i;
+            }
+            return {std::move(input.first), sum};
+        })->get();
+    
+    ASSERT_EQ(2u, result.size());
+    EXPECT_EQ(334u, result["even"]);
+    EXPECT_EQ(666u, result["odd"]);
+    EXPECT_LE(maxValues, numMappers); //at most one value per mapper and key
+}
+
+TEST(MapReduce, Stream)
+{
+    //count words as they are pushed, over the whole stream and in windows of 300 words
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    auto mapper = [](const std::string& word)->std::vector<std::pair<std::string, size_t>>
+    {
+        return {{word, 1}};
+    };
+    auto reducer = [](size_t& count, size_t&& value)
+    {
+        count += value;
+    };
+    Promise<Buffer<std::string>> wholePromise, windowedPromise;
+    ThreadContextPtr<Buffer<std::map<std::string, size_t>>> whole = dispatcher.mapReduceStream<std::string, size_t, size_t, std::map<std::string, size_t>>
+        (wholePromise.getICoroFuture(), mapper, reducer);
+    ThreadContextPtr<Buffer<std::map<std::string, size_t>>> windowed = dispatcher.mapReduceStream<std::string, size_t, size_t, std::map<std::string, size_t>>
+        (windowedPromise.getICoroFuture(), mapper, reducer, 300);
+    for (int i = 0; i < 1000; ++i) {
+        std::string word = (i % 3) ? "odd" : "even";
+        wholePromise.push(std::string(word));
+        windowedPromise.push(std::move(word));
+    }
+    wholePromise.closeBuffer();
+    windowedPromise.closeBuffer();
+    
+    bool isBufferClosed = false;
+    std::map<std::string, size_t> result = whole->pull(isBufferClosed);
+    ASSERT_FALSE(isBufferClosed);
+    EXPECT_EQ(334u, result["even"]);
+    EXPECT_EQ(666u, result["odd"]);
+    whole->pull(isBufferClosed);
+    EXPECT_TRUE(isBufferClosed);
+    
+    std::vector<size_t> windowSizes;
+    size_t numEven = 0;
+    while (true) {
+        std::map<std::string, size_t> window = windowed->pull(isBufferClosed);
+        if (isBufferClosed) break;
+        windowSizes.push_back(window["even"] + window["odd"]);
+        numEven += window["even"];
+    }
+    EXPECT_EQ(std::vector<size_t>({300, 300, 300, 100}), windowSizes);
+    EXPECT_EQ(334u, numEven);
+}
+
 TEST(FutureJoiner, JoinThreadFutures)
 {
     std::vector<ThreadContext<int>::Ptr> futures;
@@ -1129,6 +4539,341 @@ TEST(FutureJoiner, JoinCoroFutures)
     EXPECT_EQ(output, std::vector<int>({0,1,2,3,4,5,6,7,8,9}));
 }
 
+TEST(AllocatorTest, PoolsGrowBySlabs)
+{
+    //object pools
+    StackAllocator<int, 4> pool;
+    std::vector<int*> blocks;
+    for (int i = 0; i < 100; ++i)
+    {
+        blocks.push_back(pool.allocate());
+    }
+    EXPECT_EQ(100u, pool.allocatedBlocks());
+    EXPECT_EQ(0u, pool.allocatedHeapBlocks());
+    EXPECT_EQ(5u, pool.numSlabs()); //slabs of 4, 8, 16, 32 and 64 blocks
+    for (int* block : blocks)
+    {
+        pool.deallocate(block);
+    }
+    EXPECT_TRUE(pool.isFull());
+    EXPECT_EQ(AllocatorTraits::poolSpareSlabs(), pool.numSlabs());
+    pool.releaseUnusedSlabs();
+    EXPECT_EQ(0u, pool.numSlabs());
+    
+    //growth limit
+    size_t maxSlabs = AllocatorTraits::maxPoolSlabs();
+    AllocatorTraits::maxPoolSlabs() = 1;
+    blocks.clear();
+    for (int i = 0; i < 10; ++i)
+    {
+        blocks.push_back(pool.allocate());
+    }
+    EXPECT_EQ(1u, pool.numSlabs());
+    EXPECT_EQ(2u, pool.allocatedHeapBlocks());
+    for (int* block : blocks)
+    {
+        pool.deallocate(block);
+    }
+    EXPECT_EQ(0u, pool.allocatedHeapBlocks());
+    AllocatorTraits::maxPoolSlabs() = maxSlabs;
+    
+    //coroutine stack pools
+    CoroutinePoolAllocator<StackTraitsProxy> stacks(2);
+    std::vector<boost::context::stack_context> contexts;
+    for (int i = 0; i < 10; ++i)
+    {
+        contexts.push_back(stacks.allocate());
+        memset(static_cast<char*>(contexts.back().sp) - contexts.back().size, 0, contexts.back().size);
+    }
+    EXPECT_EQ(10u, stacks.allocatedBlocks());
+    EXPECT_EQ(0u, stacks.allocatedHeapBlocks());
+    EXPECT_EQ(3u, stacks.numSlabs()); //slabs of 2, 4 and 8 stacks
+    for (auto&& ctx : contexts)
+    {
+        stacks.deallocate(ctx);
+    }
+    EXPECT_TRUE(stacks.isFull());
+    stacks.releaseUnusedSlabs();
+    EXPECT_EQ(0u, stacks.numSlabs());
+}
+
+TEST(AllocatorTest, ThreadCachesInFrontOfPools)
+{
+    StackAllocator<int, 1000> pool;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&pool]() {
+            std::vector<int*> blocks;
+            for (int i = 0; i < 10000; ++i)
+            {
+                blocks.push_back(pool.allocate());
+                *blocks.back() = i;
+                if (blocks.size() == 100)
+                {
+                    for (int* block : blocks)
+                    {
+                        pool.deallocate(block);
+                    }
+                    blocks.clear();
+                }
+            }
+            //keep some blocks in this thread's cache
+            int* block = pool.allocate();
+            pool.deallocate(block);
+        });
+    }
+    for (auto&& thread : threads)
+    {
+        thread.join();
+    }
+    //exiting threads hand their cached blocks back to the pool
+    EXPECT_EQ(0u, pool.allocatedBlocks());
+    EXPECT_EQ(0u, pool.allocatedHeapBlocks());
+    EXPECT_TRUE(pool.isFull());
+    
+    //blocks freed on another thread are reused
+    int* block = pool.allocate();
+    EXPECT_EQ(1u, pool.allocatedBlocks());
+    std::thread([&]() { pool.deallocate(block); }).join();
+    EXPECT_TRUE(pool.isFull());
+}
+
+TEST(AllocatorTest, MappedCoroutineStacks)
+{
+    size_t pageSize = StackTraitsProxy::page_size();
+    bool useMmap = AllocatorTraits::useMmapCoroStacks();
+    size_t residentSize = AllocatorTraits::coroStackResidentSize();
+    AllocatorTraits::useMmapCoroStacks() = true;
+    AllocatorTraits::coroStackResidentSize() = pageSize;
+    CoroutinePoolAllocator<StackTraitsProxy> stacks(2);
+    AllocatorTraits::useMmapCoroStacks() = useMmap;
+    AllocatorTraits::coroStackResidentSize() = residentSize;
+    
+    auto numResidentPages = [pageSize](char* bottom, size_t size)->size_t {
+        std::vector<unsigned char> pages((size + pageSize - 1) / pageSize);
+        EXPECT_EQ(0, mincore(bottom, size, pages.data()));
+        return std::count_if(pages.begin(), pages.end(), [](unsigned char page) { return page & 1; });
+    };
+    boost::context::stack_context ctx = stacks.allocate();
+    char* bottom = static_cast<char*>(ctx.sp) - ctx.size;
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(bottom) % pageSize);
+    
+    //memory is committed lazily and given back when the stack returns to the pool
+    size_t numPages = (ctx.size + pageSize - 1) / pageSize;
+    EXPECT_LT(numResidentPages(bottom, ctx.size), numPages);
+    memset(bottom, 1, ctx.size);
+    EXPECT_EQ(numPages, numResidentPages(bottom, ctx.size));
+    stacks.deallocate(ctx);
+    EXPECT_EQ(1u, numResidentPages(bottom, ctx.size)); //the top page holds the stack header
+    
+    //overflowing the stack hits the guard page
+    ctx = stacks.allocate();
+    bottom = static_cast<char*>(ctx.sp) - ctx.size;
+    EXPECT_DEATH(*(volatile char*)(bottom - 1) = 0, "");
+    stacks.deallocate(ctx);
+}
+
+TEST(AllocatorTest, PoolStatistics)
+{
+    //peak usage and growth
+    StackAllocator<long, 8> pool;
+    std::vector<long*> blocks;
+    for (int i = 0; i < 20; ++i)
+    {
+        blocks.push_back(pool.allocate());
+    }
+    PoolStatistics stats = pool.stats();
+    EXPECT_EQ(32u, stats.capacity()); //8 blocks plus slabs of 8 and 16 blocks
+    EXPECT_EQ(2u, stats.numSlabs());
+    EXPECT_EQ(20u, stats.inUse());
+    EXPECT_EQ(20u, stats.peakInUse());
+    EXPECT_EQ(0u, stats.heapFallbackCount());
+    for (long* block : blocks)
+    {
+        pool.deallocate(block);
+    }
+    stats = pool.stats();
+    EXPECT_EQ(0u, stats.inUse());
+    EXPECT_EQ(20u, stats.peakInUse());
+    
+    //heap fallbacks
+    size_t maxSlabs = AllocatorTraits::maxPoolSlabs();
+    AllocatorTraits::maxPoolSlabs() = 0;
+    HeapAllocator<char> heapPool(4);
+    std::vector<char*> chars;
+    for (int i = 0; i < 6; ++i)
+    {
+        chars.push_back(heapPool.allocate());
+    }
+    EXPECT_EQ(4u, heapPool.stats().capacity());
+    EXPECT_EQ(6u, heapPool.stats().inUse());
+    EXPECT_EQ(2u, heapPool.stats().heapFallbackCount());
+    for (char* c : chars)
+    {
+        heapPool.deallocate(c);
+    }
+    EXPECT_EQ(0u, heapPool.stats().inUse());
+    EXPECT_EQ(6u, heapPool.stats().peakInUse());
+    EXPECT_EQ(2u, heapPool.stats().heapFallbackCount()); //cumulative
+    AllocatorTraits::maxPoolSlabs() = maxSlabs;
+    
+    //dispatcher snapshot taken while the coroutines are running
+    Dispatcher& dispatcher = DispatcherSingleton::instance();
+    Latch latch(1);
+    std::vector<ThreadContextPtr<int>> contexts;
+    for (int i = 0; i < 10; ++i)
+    {
+        contexts.push_back(dispatcher.post([&latch](CoroContext<int>::Ptr ctx)->int {
+            latch.wait(ctx);
+            return ctx->set(1);
+        }));
+    }
+    AllocatorStatistics allocStats = dispatcher.allocatorStats();
+    latch.countDown();
+    for (auto&& ctx : contexts)
+    {
+        EXPECT_EQ(1, ctx->get());
+    }
+    EXPECT_LE(AllocatorTraits::taskAllocSize(), allocStats.task().capacity());
+    EXPECT_LE(10u, allocStats.task().inUse());
+    EXPECT_LE(10u, allocStats.task().peakInUse());
+    EXPECT_LE(AllocatorTraits::defaultCoroPoolAllocSize(), allocStats.coroStack().capacity());
+    EXPECT_LE(10u, allocStats.context().inUse());
+    std::ostringstream out;
+    out << allocStats;
+    EXPECT_NE(std::string::npos, out.str().find("Coroutine stack pool"));
+}
+
+TEST(AllocatorTest, StackHighWaterMark)
+{
+    bool paintStacks = AllocatorTraits::paintCoroStacks();
+    AllocatorTraits::paintCoroStacks() = true;
+    CoroutinePoolAllocatorProxy<StackTraitsProxy> stacks(2);
+    AllocatorTraits::paintCoroStacks() = paintStacks;
+    
+    //the deepest write below the stack pointer is measured when the stack is returned
+    boost::context::stack_context ctx = stacks.allocate();
+    memset(static_cast<char*>(ctx.sp) - 1000, 1, 1000);
+    stacks.deallocate(ctx);
+    PoolStatistics stats = stacks.stats();
+    EXPECT_EQ(1u, stats.stackUsage().count());
+    EXPECT_EQ(1000u, stats.stackUsage().max());
+    
+    //the stack is repainted so a shallower coroutine reports its own usage
+    ctx = stacks.allocate();
+    memset(static_cast<char*>(ctx.sp) - 96, 1, 96);
+    stacks.deallocate(ctx);
+    stats = stacks.stats();
+    EXPECT_EQ(2u, stats.stackUsage().count());
+    EXPECT_EQ(1u, stats.stackUsage().bucketCount(StackUsageHistogram::bucketIndex(96)));
+    EXPECT_EQ(127u, stats.stackUsage().percentile(50));
+    EXPECT_EQ(1000u, stats.stackUsage().percentile(100));
+    
+    //stacks used by real coroutines
+    for (int i = 0; i < 10; ++i)
+    {
+        Traits::Coroutine coro(stacks, [](Traits::Yield& yield) {
+            volatile char buffer[8192];
+            for (auto&& c : buffer)
+            {
+                c = 0;
+            }
+            yield.get();
+        });
+        int rc = 0;
+        coro(rc);
+    }
+    stats = stacks.stats();
+    EXPECT_EQ(12u, stats.stackUsage().count());
+    EXPECT_LE(8192u, stats.stackUsage().max());
+    EXPECT_LE(8192u, stats.stackUsage().percentile(90));
+    std::ostringstream out;
+    out << stats;
+    EXPECT_NE(std::string::npos, out.str().find("stack usage"));
+}
+
+TEST(AllocatorTest, PoolWarmup)
+{
+    //free stacks are pre-faulted down to the resident size
+    size_t pageSize = StackTraitsProxy::page_size();
+    bool useMmap = AllocatorTraits::useMmapCoroStacks();
+    size_t residentSize = AllocatorTraits::coroStackResidentSize();
+    AllocatorTraits::useMmapCoroStacks() = true;
+    AllocatorTraits::coroStackResidentSize() = 2*pageSize;
+    CoroutinePoolAllocator<StackTraitsProxy> stacks(1);
+    AllocatorTraits::useMmapCoroStacks() = useMmap;
+    AllocatorTraits::coroStackResidentSize() = residentSize;
+    
+    auto numResidentPages = [pageSize](char* bottom, size_t size)->size_t {
+        std::vector<unsigned char> pages((size + pageSize - 1) / pageSize);
+        EXPECT_EQ(0, mincore(bottom, size, pages.data()));
+        return std::count_if(pages.begin(), pages.end(), [](unsigned char page) { return page & 1; });
+    };
+    boost::context::stack_context ctx;
+    std::thread([&]() {
+        //exiting thread hands its cached stack back to the pool
+        ctx = stacks.allocate();
+        stacks.deallocate(ctx);
+    }).join();
+    char* bottom = static_cast<char*>(ctx.sp) - ctx.size;
+    EXPECT_EQ(1u, numResidentPages(bottom, ctx.size)); //header page only
+    stacks.warmUp();
+    EXPECT_EQ(2u, numResidentPages(bottom, ctx.size));
+    
+    //dispatcher settings
+    Configuration config;
+    EXPECT_EQ(0u, config.getPoolAllocSize(Configuration::PoolType::Promise));
+    EXPECT_FALSE(config.getPoolWarmup());
+    AllocatorTraits::size_type promiseAllocSize = AllocatorTraits::promiseAllocSize();
+    config.setNumCoroutineThreads(2);
+    config.setNumIoThreads(1);
+    config.setPoolAllocSize(Configuration::PoolType::Promise, 1234);
+    config.setPoolWarmup(true);
+    config.setPoolWarmupCpuSet({0});
+    {
+        Dispatcher dispatcher(config);
+        EXPECT_EQ(1234u, AllocatorTraits::promiseAllocSize());
+        EXPECT_EQ(5, dispatcher.post([](CoroContext<int>::Ptr ctx)->int {
+            return ctx->set(5);
+        })->get());
+    }
+    AllocatorTraits::promiseAllocSize() = promiseAllocSize;
+}
+
+struct CountingBlockPool
+{
+    using value_type = SharedBlock<std::string>;
+    using default_constructor = std::true_type;
+    value_type* allocate(size_t) { ++_allocs; return new value_type; }
+    void deallocate(value_type* p, size_t) { ++_deallocs; delete p; }
+    int _allocs{0};
+    int _deallocs{0};
+};
+
+TEST(AllocatorTest, SharedBlocks)
+{
+    CountingBlockPool& pool = Allocator<CountingBlockPool>::instance();
+    {
+        auto str = std::allocate_shared<std::string>(SharedAllocator<std::string, CountingBlockPool, &AllocatorTraits::defaultPoolAllocSize>(),
+                                                     "fused");
+        std::weak_ptr<std::string> weak = str;
+        EXPECT_EQ("fused", *str);
+        EXPECT_EQ(1, pool._allocs); //object and reference counts share one block
+        str.reset();
+        EXPECT_TRUE(weak.expired());
+        EXPECT_EQ(0, pool._deallocs); //the block lives until the last weak reference is gone
+    }
+    EXPECT_EQ(1, pool._deallocs);
+    
+    //library objects are created the same way
+    Promise<int>::Ptr promise = Promise<int>::create();
+    ThreadFuture<int>::Ptr future = promise->getIThreadFuture();
+    promise->set(5);
+    EXPECT_EQ(5, future->get());
+    EXPECT_EQ(1, promise.use_count());
+}
+
 TEST(SerializeExecution, Basic)
 {
     std::unordered_map<int, CoroContextPtr<int>> entryMap;